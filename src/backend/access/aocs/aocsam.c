@@ -256,6 +256,7 @@ aocs_initscan(AOCSScanDesc scan)
 
 	ItemPointerSet(&scan->cdb_fake_ctid, 0, 0);
 	scan->cur_seg_row = 0;
+	scan->need_next_seg = false;
 
 	open_ds_read(scan->aos_rel, scan->ds, scan->relationTupleDesc,
 				 scan->proj_atts, scan->num_proj_atts,
@@ -264,6 +265,165 @@ aocs_initscan(AOCSScanDesc scan)
 	pgstat_count_heap_scan(scan->aos_rel);
 }
 
+static int
+compare_row_ranges(const void *a, const void *b)
+{
+	const AOCSRowRange *ra = (const AOCSRowRange *) a;
+	const AOCSRowRange *rb = (const AOCSRowRange *) b;
+
+	if (ra->first < rb->first)
+		return -1;
+	if (ra->first > rb->first)
+		return 1;
+	return 0;
+}
+
+/*
+ * Compute the ranges of rows of the current segment file that cannot pass
+ * the zone map predicates, from the zone maps of the blocks of each column
+ * with predicates.
+ *
+ * Row numbers are not dense; the rows between two blocks of a column do not
+ * exist, so an excluded range also covers those before its first block.
+ */
+static void
+load_zone_maps(AOCSScanDesc scan)
+{
+	AOCSFileSegInfo *curSegInfo = scan->seginfo[scan->cur_seg];
+	int			maxranges = 0;
+	int			nranges = 0;
+	int			i;
+	int			j;
+	int			k;
+
+	scan->zonemap_ranges = NULL;
+	scan->zonemap_nranges = 0;
+	scan->zonemap_next = 0;
+	scan->zonemap_next_row = 1;
+
+	for (i = 0; i < scan->num_proj_atts; i++)
+	{
+		int			attno = scan->proj_atts[i];
+		AppendOnlyBlockDirectorySummary *summaries;
+		int			nsummaries;
+		int64		prevLast = 0;
+
+		if (scan->zonemap_npreds[attno] == 0)
+			continue;
+
+		nsummaries = AppendOnlyBlockDirectory_GetSummaries(scan->aos_rel,
+														   scan->appendOnlyMetaDataSnapshot,
+														   curSegInfo->segno,
+														   attno,
+														   getAOCSVPEntry(curSegInfo, attno)->eof,
+														   &summaries);
+
+		for (j = 0; j < nsummaries; j++)
+		{
+			MinipageEntry *entry = &summaries[j].entry;
+			MinipageEntrySummary *summary = &summaries[j].summary;
+			int64		last = entry->firstRowNum + entry->rowCount - 1;
+			bool		excluded = false;
+
+			if ((summary->flags & MINIPAGE_SUMMARY_VALID) != 0)
+			{
+				if ((summary->flags & MINIPAGE_SUMMARY_HASVALUES) == 0)
+					excluded = true;	/* all nulls never pass */
+				else
+				{
+					for (k = 0; k < scan->zonemap_npreds[attno]; k++)
+					{
+						if (!datumstream_predicate_range_match(&scan->zonemap_preds[attno][k],
+															   summary->minKey,
+															   summary->maxKey))
+						{
+							excluded = true;
+							break;
+						}
+					}
+				}
+			}
+
+			if (excluded)
+			{
+				if (nranges == maxranges)
+				{
+					maxranges = (maxranges == 0 ? 16 : maxranges * 2);
+					if (scan->zonemap_ranges == NULL)
+						scan->zonemap_ranges = (AOCSRowRange *)
+							palloc(sizeof(AOCSRowRange) * maxranges);
+					else
+						scan->zonemap_ranges = (AOCSRowRange *)
+							repalloc(scan->zonemap_ranges,
+									 sizeof(AOCSRowRange) * maxranges);
+				}
+				scan->zonemap_ranges[nranges].first = prevLast + 1;
+				scan->zonemap_ranges[nranges].last = last;
+				nranges++;
+			}
+
+			prevLast = last;
+		}
+
+		if (summaries)
+			pfree(summaries);
+	}
+
+	if (nranges == 0)
+		return;
+
+	/* Sort the ranges, and merge those that overlap or touch */
+	qsort(scan->zonemap_ranges, nranges, sizeof(AOCSRowRange), compare_row_ranges);
+
+	j = 0;
+	for (i = 1; i < nranges; i++)
+	{
+		if (scan->zonemap_ranges[i].first <= scan->zonemap_ranges[j].last + 1)
+			scan->zonemap_ranges[j].last = Max(scan->zonemap_ranges[j].last,
+											   scan->zonemap_ranges[i].last);
+		else
+			scan->zonemap_ranges[++j] = scan->zonemap_ranges[i];
+	}
+	scan->zonemap_nranges = j + 1;
+}
+
+/*
+ * If the next row falls in a range excluded by the zone maps, move the
+ * first 'natts' projected columns past the range. Returns false if the
+ * segment file ends before.
+ */
+static bool
+skip_zone_map_range(AOCSScanDesc scan, int natts)
+{
+	AOCSRowRange *range;
+	int			i;
+
+	while (scan->zonemap_next < scan->zonemap_nranges &&
+		   scan->zonemap_ranges[scan->zonemap_next].last < scan->zonemap_next_row)
+		scan->zonemap_next++;
+
+	if (scan->zonemap_next == scan->zonemap_nranges)
+		return true;
+
+	range = &scan->zonemap_ranges[scan->zonemap_next];
+	if (scan->zonemap_next_row < range->first)
+		return true;
+
+	for (i = 0; i < natts; i++)
+	{
+		int			attno = scan->proj_atts[i];
+
+		if (!datumstreamread_skip_to_row(scan->ds[attno], range->last + 1,
+										 &scan->zonemap_skipped_blocks))
+			return false;
+	}
+
+	scan->zonemap_next_row = range->last + 1;
+	scan->zonemap_next++;
+
+	return true;
+}
+
 static int
 open_next_scan_seg(AOCSScanDesc scan)
 {
@@ -340,6 +500,13 @@ open_next_scan_seg(AOCSScanDesc scan)
 												  scan->num_proj_atts,
 												  scan->blockDirectory);
 
+				/*
+				 * Zone maps are read from the block directory, so not while
+				 * building it.
+				 */
+				if (scan->zonemap_npreds && scan->blockDirectory == NULL)
+					load_zone_maps(scan);
+
 				return scan->cur_seg;
 			}
 		}
@@ -365,6 +532,13 @@ close_cur_scan_seg(AOCSScanDesc scan)
 
 	if (scan->blockDirectory)
 		AppendOnlyBlockDirectory_End_forInsert(scan->blockDirectory);
+
+	if (scan->zonemap_ranges)
+	{
+		pfree(scan->zonemap_ranges);
+		scan->zonemap_ranges = NULL;
+	}
+	scan->zonemap_nranges = 0;
 }
 
 /*
@@ -545,8 +719,10 @@ aocs_getnext(AOCSScanDesc scan, ScanDirection direction, TupleTableSlot *slot)
 	int			err = 0;
 	int			i;
 	bool		isSnapshotAny = (scan->snapshot == SnapshotAny);
+	int			num_early_atts = scan->num_proj_atts - scan->num_late_atts;
 
 	Assert(ScanDirectionIsForward(direction));
+	Assert(num_early_atts > 0);
 
 	ncol = slot->tts_tupleDescriptor->natts;
 	Assert(ncol <= scan->relationTupleDesc->natts);
@@ -570,8 +746,16 @@ ReadNext:
 
 		Assert(scan->cur_seg >= 0);
 
-		/* Read from cur_seg */
-		for (i = 0; i < scan->num_proj_atts; i++)
+		if (scan->zonemap_next < scan->zonemap_nranges &&
+			!skip_zone_map_range(scan, num_early_atts))
+		{
+			close_cur_scan_seg(scan);
+			err = -1;
+			goto ReadNext;
+		}
+
+		/* Read from cur_seg, except for the late columns */
+		for (i = 0; i < num_early_atts; i++)
 		{
 			int			attno = scan->proj_atts[i];
 
@@ -621,12 +805,14 @@ ReadNext:
 		{
 			AOTupleIdInit_rowNum(&aoTupleId, rowNum);
 		}
+		scan->zonemap_next_row = AOTupleIdGet_rowNum(&aoTupleId) + 1;
 
 		if (!isSnapshotAny && !AppendOnlyVisimap_IsVisible(&scan->visibilityMap, &aoTupleId))
 		{
 			rowNum = INT64CONST(-1);
 			goto ReadNext;
 		}
+		scan->cur_row_num = AOTupleIdGet_rowNum(&aoTupleId);
 		scan->cdb_fake_ctid = *((ItemPointer) &aoTupleId);
 
 		TupSetVirtualTupleNValid(slot, ncol);
@@ -639,6 +825,378 @@ ReadNext:
 }
 
 
+/*
+ * Make aocs_getnext() skip the projected columns whose 'late' entry is set.
+ * The caller reads them with aocs_fetch_late_columns(), for the rows it
+ * wants, typically those passing quals over the other columns. Late columns
+ * are only positioned on the rows fetched; entire blocks of them that have
+ * none of those rows are never decompressed.
+ *
+ * Must be called before the first aocs_getnext(), and leave at least one
+ * projected column that is not late.
+ */
+void
+aocs_set_late_columns(AOCSScanDesc scan, bool *late)
+{
+	int		   *late_atts;
+	int			num_early_atts = 0;
+	int			i;
+
+	late_atts = palloc(sizeof(int) * scan->num_proj_atts);
+	scan->num_late_atts = 0;
+
+	/* Move the late columns to the end of proj_atts, keeping their order */
+	for (i = 0; i < scan->num_proj_atts; i++)
+	{
+		int			attno = scan->proj_atts[i];
+
+		if (late[attno])
+			late_atts[scan->num_late_atts++] = attno;
+		else
+			scan->proj_atts[num_early_atts++] = attno;
+	}
+	Assert(num_early_atts > 0);
+
+	memcpy(&scan->proj_atts[num_early_atts], late_atts,
+		   sizeof(int) * scan->num_late_atts);
+	pfree(late_atts);
+}
+
+/*
+ * Read the late columns of the row last returned by aocs_getnext() into the
+ * slot.
+ */
+void
+aocs_fetch_late_columns(AOCSScanDesc scan, TupleTableSlot *slot)
+{
+	Datum	   *d = slot_get_values(slot);
+	bool	   *null = slot_get_isnull(slot);
+	int			i;
+
+	Assert(scan->cur_seg >= 0);
+
+	for (i = scan->num_proj_atts - scan->num_late_atts; i < scan->num_proj_atts; i++)
+	{
+		int			attno = scan->proj_atts[i];
+
+		if (!datumstreamread_seek_row(scan->ds[attno], scan->blockDirectory,
+									  attno, scan->cur_row_num))
+			elog(ERROR, "could not find row " INT64_FORMAT " in column %d of "
+				 "append-only column-oriented relation \"%s\", segment file %d",
+				 scan->cur_row_num, attno + 1,
+				 RelationGetRelationName(scan->aos_rel),
+				 scan->seginfo[scan->cur_seg]->segno);
+
+		datumstreamread_get(scan->ds[attno], &d[attno], &null[attno]);
+	}
+}
+
+/*
+ * Set predicates on the projected columns that rows must pass to be of any
+ * use to the caller: npreds[attno] predicates of preds[attno] for column
+ * attno. Blocks whose zone maps show that none of their rows can pass them
+ * are skipped. Rows that do not pass may still be returned.
+ *
+ * The arrays stay owned by the caller, and must outlive the scan. Must be
+ * called before the first row is read.
+ */
+void
+aocs_set_zone_map_predicates(AOCSScanDesc scan, int *npreds,
+							 DatumStreamPredicate **preds)
+{
+	Assert(scan->cur_seg < 0);
+
+	scan->zonemap_npreds = npreds;
+	scan->zonemap_preds = preds;
+}
+
+/*
+ * Allocate a batch to be filled by aocs_getnext_batch(). Vectors are only
+ * allocated for the projected columns that are fixed-width and passed by
+ * value; the other projected columns are read and thrown away.
+ */
+AOCSBatch
+aocs_batch_create(AOCSScanDesc scan)
+{
+	TupleDesc	tupdesc = scan->relationTupleDesc;
+	AOCSBatch	batch;
+	int			i;
+
+	batch = (AOCSBatch) palloc0(sizeof(AOCSBatchData));
+	batch->ncol = tupdesc->natts;
+	batch->values = (Datum **) palloc0(sizeof(Datum *) * batch->ncol);
+	batch->isnull = (bool **) palloc0(sizeof(bool *) * batch->ncol);
+	batch->npreds = (int *) palloc0(sizeof(int) * batch->ncol);
+	batch->preds = (DatumStreamPredicate **) palloc0(sizeof(DatumStreamPredicate *) * batch->ncol);
+
+	for (i = 0; i < scan->num_proj_atts; i++)
+	{
+		int			attno = scan->proj_atts[i];
+		Form_pg_attribute attr = tupdesc->attrs[attno];
+
+		if (attr->attbyval && attr->attlen > 0)
+		{
+			batch->values[attno] = (Datum *) palloc(sizeof(Datum) * AOCS_BATCH_SIZE);
+			batch->isnull[attno] = (bool *) palloc(sizeof(bool) * AOCS_BATCH_SIZE);
+		}
+	}
+
+	batch->tids = (AOTupleId *) palloc(sizeof(AOTupleId) * AOCS_BATCH_SIZE);
+	batch->sel = (int *) palloc(sizeof(int) * AOCS_BATCH_SIZE);
+	batch->match = (bool *) palloc(sizeof(bool) * AOCS_BATCH_SIZE);
+	batch->rownums = (int64 *) palloc(sizeof(int64) * AOCS_BATCH_SIZE);
+
+	return batch;
+}
+
+void
+aocs_batch_free(AOCSBatch batch)
+{
+	int			i;
+	int			j;
+
+	for (i = 0; i < batch->ncol; i++)
+	{
+		if (batch->values[i])
+		{
+			pfree(batch->values[i]);
+			pfree(batch->isnull[i]);
+		}
+
+		for (j = 0; j < batch->npreds[i]; j++)
+		{
+			if (batch->preds[i][j].inValues)
+				pfree(batch->preds[i][j].inValues);
+		}
+		if (batch->preds[i])
+			pfree(batch->preds[i]);
+	}
+
+	pfree(batch->values);
+	pfree(batch->isnull);
+	pfree(batch->npreds);
+	pfree(batch->preds);
+	pfree(batch->tids);
+	pfree(batch->sel);
+	pfree(batch->match);
+	pfree(batch->rownums);
+	pfree(batch);
+}
+
+/*
+ * Add a predicate on a projected column that has a vector. Rows that do not
+ * pass it are never selected. The batch takes ownership of pred->inValues.
+ */
+void
+aocs_batch_add_predicate(AOCSBatch batch, int attno, DatumStreamPredicate *pred)
+{
+	Assert(attno >= 0 && attno < batch->ncol);
+	Assert(batch->values[attno] != NULL);
+
+	if (batch->preds[attno] == NULL)
+		batch->preds[attno] = (DatumStreamPredicate *) palloc(sizeof(DatumStreamPredicate));
+	else
+		batch->preds[attno] = (DatumStreamPredicate *)
+			repalloc(batch->preds[attno],
+					 sizeof(DatumStreamPredicate) * (batch->npreds[attno] + 1));
+
+	batch->preds[attno][batch->npreds[attno]++] = *pred;
+}
+
+/*
+ * Read up to maxRows values of one column of the current segment file, and
+ * evaluate the predicates of the column, if any, into batch->match. Columns
+ * without predicates are only materialized for the rows still matching. If
+ * wantTids, the tids of the rows are also stored.
+ *
+ * Returns the number of rows read, which is less than maxRows only at the
+ * end of the segment file.
+ */
+static int
+aocs_read_column_batch(AOCSScanDesc scan, AOCSBatch batch, int attno,
+					   int maxRows, bool wantTids)
+{
+	DatumStreamRead *ds = scan->ds[attno];
+	int			segno = scan->seginfo[scan->cur_seg]->segno;
+	int64	   *rownums = wantTids ? batch->rownums : NULL;
+	int			n;
+	int			i;
+
+	if (batch->npreds[attno] > 0)
+		n = datumstreamread_batch_filter(ds, scan->blockDirectory, attno,
+										 maxRows,
+										 batch->preds[attno],
+										 batch->npreds[attno],
+										 batch->match,
+										 batch->values[attno],
+										 batch->isnull[attno],
+										 rownums);
+	else
+		n = datumstreamread_batch(ds, scan->blockDirectory, attno,
+								  maxRows,
+								  batch->match,
+								  batch->values[attno],
+								  batch->isnull[attno],
+								  rownums);
+
+	if (wantTids)
+	{
+		for (i = 0; i < n; i++)
+		{
+			AOTupleIdInit_Init(&batch->tids[i]);
+			AOTupleIdInit_segmentFileNum(&batch->tids[i], segno);
+
+			if (rownums[i] != INT64CONST(-1))
+			{
+				Assert(rownums[i] > 0);
+				AOTupleIdInit_rowNum(&batch->tids[i], rownums[i]);
+			}
+			else
+				AOTupleIdInit_rowNum(&batch->tids[i], scan->cur_seg_row + i + 1);
+		}
+	}
+
+	return n;
+}
+
+/*
+ * Batch counterpart of aocs_getnext().
+ *
+ * Reads the next rows of the scan, column by column, into 'batch', and
+ * selects the visible ones that pass the predicates of the batch. The
+ * columns with predicates are read first; the other columns are then only
+ * materialized for the rows that are still selected. Returns false at the
+ * end of the scan; otherwise at least one row is selected.
+ */
+bool
+aocs_getnext_batch(AOCSScanDesc scan, ScanDirection direction, AOCSBatch batch)
+{
+	bool		isSnapshotAny = (scan->snapshot == SnapshotAny);
+	bool		hasPreds = false;
+	int			nrows = 0;
+	int			pass;
+	int			i;
+
+	Assert(ScanDirectionIsForward(direction));
+	Assert(scan->num_proj_atts > 0);
+	Assert(scan->num_late_atts == 0);
+
+	batch->nrows = 0;
+	batch->nsel = 0;
+
+	for (i = 0; i < scan->num_proj_atts; i++)
+	{
+		if (batch->npreds[scan->proj_atts[i]] > 0)
+			hasPreds = true;
+	}
+
+	while (batch->nsel == 0)
+	{
+		bool		first = true;
+		int			maxRows = AOCS_BATCH_SIZE;
+
+		/* If necessary, open next seg */
+		if (scan->cur_seg < 0 || scan->need_next_seg)
+		{
+			close_cur_scan_seg(scan);
+			scan->need_next_seg = false;
+
+			if (open_next_scan_seg(scan) < 0)
+			{
+				/* No more seg, we are at the end */
+				scan->cur_seg = -1;
+				return false;
+			}
+			scan->cur_seg_row = 0;
+		}
+
+		Assert(scan->cur_seg >= 0);
+
+		/* Stop the batch at the next range excluded by the zone maps */
+		if (scan->zonemap_next < scan->zonemap_nranges)
+		{
+			if (!skip_zone_map_range(scan, scan->num_proj_atts))
+			{
+				scan->need_next_seg = true;
+				continue;
+			}
+
+			if (scan->zonemap_next < scan->zonemap_nranges &&
+				scan->zonemap_ranges[scan->zonemap_next].first - scan->zonemap_next_row < maxRows)
+				maxRows = (int) (scan->zonemap_ranges[scan->zonemap_next].first -
+								 scan->zonemap_next_row);
+		}
+
+		memset(batch->match, true, sizeof(bool) * AOCS_BATCH_SIZE);
+
+		/*
+		 * Read the batch a column at a time: the columns with predicates in
+		 * the first pass, all the others in the second one, once visibility
+		 * has been checked. All the columns of a segment file have the same
+		 * number of rows, so the first one read decides how many rows are
+		 * left.
+		 */
+		for (pass = 0; pass < 2; pass++)
+		{
+			if (pass == 1 && hasPreds && !isSnapshotAny)
+			{
+				for (i = 0; i < nrows; i++)
+				{
+					if (batch->match[i] &&
+						!AppendOnlyVisimap_IsVisible(&scan->visibilityMap, &batch->tids[i]))
+						batch->match[i] = false;
+				}
+			}
+
+			for (i = 0; i < scan->num_proj_atts; i++)
+			{
+				int			attno = scan->proj_atts[i];
+				int			n;
+
+				if ((batch->npreds[attno] > 0) != (pass == 0))
+					continue;
+
+				n = aocs_read_column_batch(scan, batch, attno, maxRows, first);
+				if (first)
+					nrows = n;
+				else if (n != nrows)
+					elog(ERROR, "column %d of append-only column-oriented relation \"%s\" "
+						 "has %d rows left in segment file %d, expected %d",
+						 attno + 1, RelationGetRelationName(scan->aos_rel), n,
+						 scan->seginfo[scan->cur_seg]->segno, nrows);
+				first = false;
+			}
+		}
+
+		/*
+		 * Without predicates, nothing was read in the first pass, so the
+		 * visibility of the rows is only checked now.
+		 */
+		if (!hasPreds && !isSnapshotAny)
+		{
+			for (i = 0; i < nrows; i++)
+				batch->match[i] =
+					AppendOnlyVisimap_IsVisible(&scan->visibilityMap, &batch->tids[i]);
+		}
+
+		batch->nrows = nrows;
+		scan->cur_seg_row += nrows;
+		if (nrows < maxRows)
+			scan->need_next_seg = true;
+		else
+			scan->zonemap_next_row = AOTupleIdGet_rowNum(&batch->tids[nrows - 1]) + 1;
+
+		for (i = 0; i < nrows; i++)
+		{
+			batch->sel[batch->nsel] = i;
+			batch->nsel += batch->match[i];
+		}
+	}
+
+	return true;
+}
+
+
 /* Open next file segment for write.  See SetCurrentFileSegForWrite */
 /* XXX Right now, we put each column to different files */
 static void
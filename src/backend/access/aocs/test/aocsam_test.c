@@ -110,6 +110,33 @@ test__aocs_addcol_init(void **state)
 	assert_int_equal(desc->cur_segno, -1);
 }
 
+/*
+ * aocs_set_late_columns()
+ *
+ * Verify that the late columns are moved to the end of proj_atts, and
+ * that both the other columns and the late ones keep their order.
+ */
+void
+test__aocs_set_late_columns(void **state)
+{
+	AOCSScanDescData scan;
+	int proj_atts[5] = {0, 2, 3, 5, 7};
+	bool late[8] = {false, false, true, false, false, true, false, false};
+
+	memset(&scan, 0, sizeof(scan));
+	scan.proj_atts = proj_atts;
+	scan.num_proj_atts = 5;
+
+	aocs_set_late_columns(&scan, late);
+
+	assert_int_equal(scan.num_late_atts, 2);
+	assert_int_equal(proj_atts[0], 0);
+	assert_int_equal(proj_atts[1], 3);
+	assert_int_equal(proj_atts[2], 7);
+	assert_int_equal(proj_atts[3], 2);
+	assert_int_equal(proj_atts[4], 5);
+}
+
 int 
 main(int argc, char* argv[]) 
 {
@@ -117,7 +144,8 @@ main(int argc, char* argv[])
 
 	const UnitTest tests[] = {
 			unit_test(test__aocs_begin_headerscan),
-			unit_test(test__aocs_addcol_init)
+			unit_test(test__aocs_addcol_init),
+			unit_test(test__aocs_set_late_columns)
 	};
 
 	MemoryContextInit();
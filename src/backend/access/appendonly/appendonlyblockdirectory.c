@@ -30,6 +30,13 @@ static inline uint32 minipage_size(uint32 nEntry)
 		sizeof(MinipageEntry) * nEntry;
 }
 
+/* Size of a MINIPAGE_VERSION_SUMMARY minipage */
+static inline uint32 minipage_summary_size(uint32 nEntry)
+{
+	return minipage_size(nEntry) +
+		sizeof(MinipageEntrySummary) * nEntry;
+}
+
 static void load_last_minipage(
 	AppendOnlyBlockDirectory *blockDirectory,
 	int64 lastSequence,
@@ -56,7 +63,8 @@ insert_new_entry(AppendOnlyBlockDirectory *blockDirectory,
 				 int64 firstRowNum,
 				 int64 fileOffset,
 				 int64 rowCount,
-				 bool addColAction);
+				 bool addColAction,
+				 MinipageEntrySummary *summary);
 
 void 
 AppendOnlyBlockDirectoryEntry_GetBeginRange(
@@ -144,7 +152,9 @@ init_internal(AppendOnlyBlockDirectory *blockDirectory)
 		MinipagePerColumnGroup *minipageInfo =
 			&blockDirectory->minipages[groupNo];
 		minipageInfo->minipage =
-			palloc0(minipage_size(NUM_MINIPAGE_ENTRIES));
+			palloc0(minipage_summary_size(NUM_MINIPAGE_ENTRIES));
+		minipageInfo->summary =
+			palloc0(sizeof(MinipageEntrySummary) * NUM_MINIPAGE_ENTRIES);
 		minipageInfo->numMinipageEntries = 0;
 	}
 
@@ -664,7 +674,57 @@ AppendOnlyBlockDirectory_InsertEntry(
 	bool addColAction)
 {
 	return insert_new_entry(blockDirectory, columnGroupNo, firstRowNum,
-							fileOffset, rowCount, addColAction);
+							fileOffset, rowCount, addColAction, NULL);
+}
+
+/*
+ * AppendOnlyBlockDirectory_InsertEntryWithSummary
+ *
+ * Same as AppendOnlyBlockDirectory_InsertEntry, also recording the zone map
+ * of the rows of the new entry. When the new entry is ignored because of
+ * gp_blockdirectory_entry_min_range, its zone map is merged into the one of
+ * the latest existing entry.
+ */
+bool
+AppendOnlyBlockDirectory_InsertEntryWithSummary(
+	AppendOnlyBlockDirectory *blockDirectory,
+	int columnGroupNo,
+	int64 firstRowNum,
+	int64 fileOffset,
+	int64 rowCount,
+	bool addColAction,
+	MinipageEntrySummary *summary)
+{
+	return insert_new_entry(blockDirectory, columnGroupNo, firstRowNum,
+							fileOffset, rowCount, addColAction, summary);
+}
+
+/*
+ * Merge the zone map of a new block into the zone map of an entry. A NULL
+ * summary means the block was not summarized.
+ */
+static void
+merge_summary(MinipageEntrySummary *entrySummary,
+			  MinipageEntrySummary *summary)
+{
+	if (summary == NULL || (summary->flags & MINIPAGE_SUMMARY_VALID) == 0)
+	{
+		entrySummary->flags = 0;
+		return;
+	}
+
+	if ((entrySummary->flags & MINIPAGE_SUMMARY_VALID) == 0 ||
+		(summary->flags & MINIPAGE_SUMMARY_HASVALUES) == 0)
+		return;
+
+	if ((entrySummary->flags & MINIPAGE_SUMMARY_HASVALUES) == 0)
+	{
+		*entrySummary = *summary;
+		return;
+	}
+
+	entrySummary->minKey = Min(entrySummary->minKey, summary->minKey);
+	entrySummary->maxKey = Max(entrySummary->maxKey, summary->maxKey);
 }
 
 /*
@@ -679,7 +739,8 @@ insert_new_entry(
 		int64 firstRowNum,
 		int64 fileOffset,
 		int64 rowCount,
-		bool addColAction)
+		bool addColAction,
+		MinipageEntrySummary *summary)
 {
 	MinipageEntry *entry = NULL;
 	MinipagePerColumnGroup *minipageInfo;
@@ -724,7 +785,10 @@ insert_new_entry(
 		
 		if (gp_blockdirectory_entry_min_range > 0 &&
 			fileOffset - entry->fileOffset < gp_blockdirectory_entry_min_range)
+		{
+			merge_summary(&minipageInfo->summary[lastEntryNo], summary);
 			return true;
+		}
 		
 		/* Update the rowCount in the latest entry */
 		Assert(entry->rowCount <= firstRowNum - entry->firstRowNum);
@@ -755,6 +819,8 @@ insert_new_entry(
 		 */
 		MemSet(minipageInfo->minipage->entry, 0,
 			   minipageInfo->numMinipageEntries * sizeof(MinipageEntry));
+		MemSet(minipageInfo->summary, 0,
+			   minipageInfo->numMinipageEntries * sizeof(MinipageEntrySummary));
 		minipageInfo->numMinipageEntries = 0;
 	}
 	
@@ -764,6 +830,12 @@ insert_new_entry(
 	entry->firstRowNum = firstRowNum;
 	entry->fileOffset = fileOffset;
 	entry->rowCount = rowCount;
+
+	if (summary != NULL)
+		minipageInfo->summary[minipageInfo->numMinipageEntries] = *summary;
+	else
+		MemSet(&minipageInfo->summary[minipageInfo->numMinipageEntries], 0,
+			   sizeof(MinipageEntrySummary));
 	
 	minipageInfo->numMinipageEntries++;
 	
@@ -822,6 +894,119 @@ AppendOnlyBlockDirectory_DeleteSegmentFile(Relation aoRel,
 
 }
 
+/*
+ * AppendOnlyBlockDirectory_GetSummaries
+ *
+ * Return the entries of the block directory for the given segment file and
+ * column group, in row number order, with their zone maps. Entries at or
+ * after 'eof', left over by aborted inserts, are not returned.
+ *
+ * The result is palloc'd in the current memory context; the number of
+ * entries is returned. If the relation has no block directory, there are
+ * none.
+ */
+int
+AppendOnlyBlockDirectory_GetSummaries(Relation aoRel,
+		Snapshot appendOnlyMetaDataSnapshot,
+		int segno,
+		int columnGroupNo,
+		int64 eof,
+		AppendOnlyBlockDirectorySummary **summaries)
+{
+	Relation blkdirRel;
+	Relation blkdirIdx;
+	TupleDesc heapTupleDesc;
+	ScanKeyData scanKeys[2];
+	IndexScanDesc indexScan;
+	HeapTuple tuple;
+	int nSummaries = 0;
+	int maxSummaries = 0;
+
+	*summaries = NULL;
+
+	if (!OidIsValid(aoRel->rd_appendonly->blkdirrelid))
+		return 0;
+
+	Assert(OidIsValid(aoRel->rd_appendonly->blkdiridxid));
+
+	blkdirRel = heap_open(aoRel->rd_appendonly->blkdirrelid, AccessShareLock);
+	blkdirIdx = index_open(aoRel->rd_appendonly->blkdiridxid, AccessShareLock);
+	heapTupleDesc = RelationGetDescr(blkdirRel);
+
+	ScanKeyInit(&scanKeys[0],
+			1, /* segno */
+			BTEqualStrategyNumber,
+			F_INT4EQ,
+			Int32GetDatum(segno));
+	ScanKeyInit(&scanKeys[1],
+			2, /* columngroupno */
+			BTEqualStrategyNumber,
+			F_INT4EQ,
+			Int32GetDatum(columnGroupNo));
+
+	indexScan = index_beginscan(blkdirRel, blkdirIdx,
+								appendOnlyMetaDataSnapshot,
+								2, scanKeys);
+
+	while ((tuple = index_getnext(indexScan, ForwardScanDirection)) != NULL)
+	{
+		Datum minipage_value;
+		bool minipage_isnull;
+		Minipage *minipage;
+		MinipageEntrySummary *entrySummary = NULL;
+		uint32 entryNo;
+
+		minipage_value = heap_getattr(tuple, Anum_pg_aoblkdir_minipage,
+									  heapTupleDesc, &minipage_isnull);
+		Assert(!minipage_isnull);
+		minipage = (Minipage *) pg_detoast_datum((struct varlena *)
+												 DatumGetPointer(minipage_value));
+
+		if (minipage->version >= MINIPAGE_VERSION_SUMMARY)
+			entrySummary = (MinipageEntrySummary *)
+				((char *) minipage + minipage_size(minipage->nEntry));
+
+		for (entryNo = 0; entryNo < minipage->nEntry; entryNo++)
+		{
+			AppendOnlyBlockDirectorySummary *summary;
+
+			if (nSummaries == maxSummaries)
+			{
+				maxSummaries = Max(maxSummaries * 2, NUM_MINIPAGE_ENTRIES);
+				if (*summaries == NULL)
+					*summaries = palloc(sizeof(AppendOnlyBlockDirectorySummary) * maxSummaries);
+				else
+					*summaries = repalloc(*summaries,
+										  sizeof(AppendOnlyBlockDirectorySummary) * maxSummaries);
+			}
+
+			summary = &(*summaries)[nSummaries++];
+			memcpy(&summary->entry, &minipage->entry[entryNo],
+				   sizeof(MinipageEntry));
+			if (entrySummary != NULL)
+				memcpy(&summary->summary, &entrySummary[entryNo],
+					   sizeof(MinipageEntrySummary));
+			else
+				MemSet(&summary->summary, 0, sizeof(MinipageEntrySummary));
+
+			if (summary->entry.fileOffset >= eof)
+			{
+				nSummaries--;
+				break;
+			}
+		}
+
+		if ((Pointer) minipage != DatumGetPointer(minipage_value))
+			pfree(minipage);
+	}
+
+	index_endscan(indexScan);
+	index_close(blkdirIdx, AccessShareLock);
+	heap_close(blkdirRel, AccessShareLock);
+
+	return nSummaries;
+}
+
 /*
  * init_scankeys
  *
@@ -896,7 +1081,7 @@ copy_out_minipage(MinipagePerColumnGroup *minipageInfo,
 	value = (struct varlena *)
 		DatumGetPointer(minipage_value);
 	detoast_value = pg_detoast_datum(value);
-	Assert( VARSIZE(detoast_value) <= minipage_size(NUM_MINIPAGE_ENTRIES));
+	Assert( VARSIZE(detoast_value) <= minipage_summary_size(NUM_MINIPAGE_ENTRIES));
 
 	memcpy(minipageInfo->minipage, detoast_value, VARSIZE(detoast_value));
 	if (detoast_value != value)
@@ -905,6 +1090,16 @@ copy_out_minipage(MinipagePerColumnGroup *minipageInfo,
 	Assert(minipageInfo->minipage->nEntry <= NUM_MINIPAGE_ENTRIES);
 	
 	minipageInfo->numMinipageEntries = minipageInfo->minipage->nEntry;
+
+	/* Minipages written before zone maps have none */
+	if (minipageInfo->minipage->version >= MINIPAGE_VERSION_SUMMARY)
+		memcpy(minipageInfo->summary,
+			   (char *) minipageInfo->minipage +
+			   minipage_size(minipageInfo->numMinipageEntries),
+			   sizeof(MinipageEntrySummary) * minipageInfo->numMinipageEntries);
+	else
+		MemSet(minipageInfo->summary, 0,
+			   sizeof(MinipageEntrySummary) * minipageInfo->numMinipageEntries);
 }
 
 
@@ -1117,6 +1312,8 @@ write_minipage(AppendOnlyBlockDirectory *blockDirectory,
 	bool *nulls = blockDirectory->nulls;
 	Relation blkdirRel = blockDirectory->blkdirRel;
 	TupleDesc heapTupleDesc = RelationGetDescr(blkdirRel);
+	bool hasSummary = false;
+	uint32 entryNo;
 	
 	Assert(minipageInfo->numMinipageEntries > 0);
 
@@ -1136,8 +1333,35 @@ write_minipage(AppendOnlyBlockDirectory *blockDirectory,
 		Int64GetDatum(minipageInfo->minipage->entry[0].firstRowNum);
 	nulls[Anum_pg_aoblkdir_firstrownum - 1] = false;
 
-	SET_VARSIZE(minipageInfo->minipage,
-				minipage_size(minipageInfo->numMinipageEntries));
+	/*
+	 * Only write the zone maps if some entry has one, so that the minipages
+	 * of row-oriented tables keep their original format.
+	 */
+	for (entryNo = 0; entryNo < minipageInfo->numMinipageEntries; entryNo++)
+	{
+		if (minipageInfo->summary[entryNo].flags & MINIPAGE_SUMMARY_VALID)
+		{
+			hasSummary = true;
+			break;
+		}
+	}
+
+	if (hasSummary)
+	{
+		memcpy((char *) minipageInfo->minipage +
+			   minipage_size(minipageInfo->numMinipageEntries),
+			   minipageInfo->summary,
+			   sizeof(MinipageEntrySummary) * minipageInfo->numMinipageEntries);
+		SET_VARSIZE(minipageInfo->minipage,
+					minipage_summary_size(minipageInfo->numMinipageEntries));
+		minipageInfo->minipage->version = MINIPAGE_VERSION_SUMMARY;
+	}
+	else
+	{
+		SET_VARSIZE(minipageInfo->minipage,
+					minipage_size(minipageInfo->numMinipageEntries));
+		minipageInfo->minipage->version = MINIPAGE_VERSION_ORIGINAL;
+	}
 	minipageInfo->minipage->nEntry = minipageInfo->numMinipageEntries;
 	values[Anum_pg_aoblkdir_minipage - 1] =
 		PointerGetDatum(minipageInfo->minipage);
@@ -1212,6 +1436,7 @@ AppendOnlyBlockDirectory_End_forInsert(
 		}
 		
 		pfree(minipageInfo->minipage);
+		pfree(minipageInfo->summary);
 	}
 
 	ereportif(Debug_appendonly_print_blockdirectory, LOG,
@@ -1247,7 +1472,10 @@ AppendOnlyBlockDirectory_End_forSearch(
 	for (groupNo = 0; groupNo < blockDirectory->numColumnGroups; groupNo++)
 	{
 		if (blockDirectory->minipages[groupNo].minipage != NULL)
+		{
 			pfree(blockDirectory->minipages[groupNo].minipage);
+			pfree(blockDirectory->minipages[groupNo].summary);
+		}
 	}
 
 	ereportif(Debug_appendonly_print_blockdirectory, LOG,
@@ -1297,6 +1525,7 @@ AppendOnlyBlockDirectory_End_addCol(
 							  groupNo, minipageInfo->numMinipageEntries)));
 		}
 		pfree(minipageInfo->minipage);
+		pfree(minipageInfo->summary);
 	}
 
 	ereportif(Debug_appendonly_print_blockdirectory, LOG,
@@ -218,6 +218,12 @@ bool		gp_interconnect_log_stats = false;	/* emit stats at log-level */
 
 bool		gp_interconnect_cache_future_packets = true;
 
+bool		gp_interconnect_batch_io = false;	/* sendmmsg()/recvmmsg() in UDP-IC */
+
+bool		gp_interconnect_compression = false;	/* compress motion tuples */
+
+bool		gp_interconnect_batch_tuples = false;	/* batch redistributed tuples */
+
 int			Gp_udp_bufsize_k;	/* UPD recv buf size, in KB */
 
 #ifdef USE_ASSERT_CHECKING
@@ -902,6 +908,8 @@ gpvars_assign_gp_interconnect_type(const char *newval, bool doit, GucSource sour
 		newtype = INTERCONNECT_TYPE_UDPIFC;
 	else if (!pg_strcasecmp("tcp", newval))
 		newtype = INTERCONNECT_TYPE_TCP;
+	else if (!pg_strcasecmp("shm", newval))
+		newtype = INTERCONNECT_TYPE_SHM;
 	else
 		elog(ERROR, "Unknown interconnect type. (current type is '%s')", gpvars_show_gp_interconnect_type());
 
@@ -920,6 +928,8 @@ gpvars_show_gp_interconnect_type(void)
 	{
 		case INTERCONNECT_TYPE_TCP:
 			return "TCP";
+		case INTERCONNECT_TYPE_SHM:
+			return "SHM";
 		case INTERCONNECT_TYPE_UDPIFC:
 		default:
 			return "UDPIFC";
@@ -940,6 +950,8 @@ gpvars_assign_gp_interconnect_fc_method(const char *newval, bool doit, GucSource
 		newmethod = INTERCONNECT_FC_METHOD_CAPACITY;
 	else if (!pg_strcasecmp("loss", newval))
 		newmethod = INTERCONNECT_FC_METHOD_LOSS;
+	else if (!pg_strcasecmp("delay", newval))
+		newmethod = INTERCONNECT_FC_METHOD_DELAY;
 	else
 		elog(ERROR, "Unknown interconnect flow control method. (current method is '%s')", gpvars_show_gp_interconnect_fc_method());
 
@@ -960,6 +972,8 @@ gpvars_show_gp_interconnect_fc_method(void)
 			return "CAPACITY";
 		case INTERCONNECT_FC_METHOD_LOSS:
 			return "LOSS";
+		case INTERCONNECT_FC_METHOD_DELAY:
+			return "DELAY";
 		default:
 			return "CAPACITY";
 	}
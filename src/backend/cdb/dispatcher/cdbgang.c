@@ -959,7 +959,7 @@ static CdbProcess *makeCdbProcess(SegmentDatabaseDescriptor *segdbDesc)
 
 	process->listenerAddr = pstrdup(qeinfo->hostip);
 
-	if (Gp_interconnect_type == INTERCONNECT_TYPE_UDPIFC)
+	if (INTERCONNECT_IS_UDPIFC())
 		process->listenerPort = (segdbDesc->motionListener >> 16) & 0x0ffff;
 	else if (Gp_interconnect_type == INTERCONNECT_TYPE_TCP)
 		process->listenerPort = (segdbDesc->motionListener & 0x0ffff);
@@ -1063,7 +1063,7 @@ getCdbProcessesForQD(int isPrimary)
 	 */
 	proc->listenerAddr = NULL;
 
-	if (Gp_interconnect_type == INTERCONNECT_TYPE_UDPIFC)
+	if (INTERCONNECT_IS_UDPIFC())
 		proc->listenerPort = (Gp_listener_port >> 16) & 0x0ffff;
 	else if (Gp_interconnect_type == INTERCONNECT_TYPE_TCP)
 		proc->listenerPort = (Gp_listener_port & 0x0ffff);
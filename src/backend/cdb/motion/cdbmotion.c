@@ -12,6 +12,7 @@
 #include "postgres.h"
 
 #include "access/htup.h"
+#include "access/memtup.h"
 #include "gp-libpq-fe.h"
 #include "gp-libpq-int.h"
 #include "cdb/cdbconn.h"
@@ -29,6 +30,16 @@
  */
 int			Gp_max_tuple_chunk_size;
 
+/*
+ * gp_interconnect_compression: tuples smaller than this are sent as they
+ * are.  The first MOTION_COMPRESS_PROBE_BYTES of tuple data given to the
+ * compressor decide whether it pays off for the motion node; if it doesn't
+ * get them down to MOTION_COMPRESS_MAX_RATIO, compression is switched off.
+ */
+#define MOTION_COMPRESS_MIN_TUPLE_SIZE	256
+#define MOTION_COMPRESS_PROBE_BYTES		(1024 * 1024)
+#define MOTION_COMPRESS_MAX_RATIO		0.8
+
 /*
  * STATIC STATE VARS
  *
@@ -60,6 +71,11 @@ static void processIncomingChunks(MotionLayerState *mlStates,
 								  int16 srcRoute);
 
 static inline void reconstructTuple(MotionNodeEntry * pMNEntry, ChunkSorterEntry * pCSEntry, TupleRemapper *remapper);
+static void reconstructTupleBatch(MotionNodeEntry * pMNEntry, ChunkSorterEntry * pCSEntry,
+								  TupleChunkListItem tcItem);
+static bool nextBatchedTuple(MotionNodeEntry *pMNEntry, TupleTableSlot *slot);
+static bool flushTupleBatch(MotionLayerState *mlStates, ChunkTransportState *transportStates,
+							MotionNodeEntry *pMNEntry, int16 motNodeID, int16 targetRoute);
 
 /* Stats-function declarations. */
 static void statSendTuple(MotionLayerState *mlStates, MotionNodeEntry * pMNEntry, TupleChunkList tcList);
@@ -70,6 +86,8 @@ static void statRecvTuple(MotionNodeEntry * pMNEntry,
 						  ChunkSorterEntry * pCSEntry,
 						  ReceiveReturnCode recvRC);
 static bool ShouldSendRecordCache(MotionConn *conn, SerTupInfo *pSerInfo);
+static bool shouldCompressTuple(MotionNodeEntry *pMNEntry, HeapTuple tuple);
+static void compressTuple(MotionNodeEntry *pMNEntry, TupleChunkList tcList);
 static void UpdateSentRecordCache(MotionConn *conn);
 
 
@@ -102,6 +120,84 @@ reconstructTuple(MotionNodeEntry * pMNEntry, ChunkSorterEntry * pCSEntry, TupleR
 	statNewTupleArrived(pMNEntry, pCSEntry);
 }
 
+/*
+ * Like reconstructTuple(), for all the tuples of a TC_BATCH chunk.
+ *
+ * An unordered receiver keeps the decoded batch, and RecvTupleSlot() hands
+ * its tuples out as virtual tuples.  An order-preserving receiver works on
+ * HeapTuples, so the tuples are formed here.  Batches are only sent for
+ * tuple descriptions without record types, so no remapping is needed.
+ */
+static void
+reconstructTupleBatch(MotionNodeEntry * pMNEntry, ChunkSorterEntry * pCSEntry,
+					  TupleChunkListItem tcItem)
+{
+	RecvTupleBatch *batch;
+	int			natts = pMNEntry->ser_tup_info.tupdesc->natts;
+	int			i;
+
+	batch = DeserializeTupleBatch(&pMNEntry->ser_tup_info, tcItem);
+
+	for (i = 0; i < batch->ntuples; i++)
+	{
+		if (pMNEntry->preserve_order)
+			htfifo_addtuple(pCSEntry->ready_tuples,
+							heap_form_tuple(pMNEntry->ser_tup_info.tupdesc,
+											batch->values + i * natts,
+											batch->nulls + i * natts));
+
+		/* Stats */
+		statNewTupleArrived(pMNEntry, pCSEntry);
+	}
+
+	if (pMNEntry->preserve_order)
+	{
+		FreeRecvTupleBatch(batch);
+		return;
+	}
+
+	if (pMNEntry->recv_batches_tail)
+		pMNEntry->recv_batches_tail->next_batch = batch;
+	else
+		pMNEntry->recv_batches = batch;
+	pMNEntry->recv_batches_tail = batch;
+}
+
+/*
+ * Store the next tuple of the received batches into a slot, as a virtual
+ * tuple.  The values stay valid until the next call, which frees the batch
+ * once all its tuples have been handed out.
+ */
+static bool
+nextBatchedTuple(MotionNodeEntry *pMNEntry, TupleTableSlot *slot)
+{
+	RecvTupleBatch *batch = pMNEntry->recv_batches;
+	int			natts = pMNEntry->ser_tup_info.tupdesc->natts;
+
+	while (batch != NULL && batch->next >= batch->ntuples)
+	{
+		/* The slot may still point into the batch. */
+		ExecClearTuple(slot);
+
+		pMNEntry->recv_batches = batch->next_batch;
+		if (pMNEntry->recv_batches == NULL)
+			pMNEntry->recv_batches_tail = NULL;
+		FreeRecvTupleBatch(batch);
+		batch = pMNEntry->recv_batches;
+	}
+
+	if (batch == NULL)
+		return false;
+
+	ExecClearTuple(slot);
+	memcpy(slot_get_values(slot), batch->values + batch->next * natts, natts * sizeof(Datum));
+	memcpy(slot_get_isnull(slot), batch->nulls + batch->next * natts, natts * sizeof(bool));
+	ExecStoreVirtualTuple(slot);
+	batch->next++;
+
+	return true;
+}
+
 /*
  * FUNCTION DEFINITIONS
  */
@@ -161,7 +257,7 @@ initMotionLayerStructs(MotionLayerState **mlStates)
 	if (Gp_role == GP_ROLE_UTILITY)
 		return;
 
-	if (Gp_interconnect_type == INTERCONNECT_TYPE_UDPIFC)
+	if (INTERCONNECT_IS_UDPIFC())
 		Gp_max_tuple_chunk_size = Gp_max_packet_size - sizeof(struct icpkthdr) - TUPLE_CHUNK_HEADER_SIZE;
 	else if (Gp_interconnect_type == INTERCONNECT_TYPE_TCP)
 		Gp_max_tuple_chunk_size = Gp_max_packet_size - PACKET_HEADER_SIZE - TUPLE_CHUNK_HEADER_SIZE;		
@@ -368,6 +464,15 @@ UpdateMotionLayerNode(MotionLayerState *mlStates, int16 motNodeID, bool preserve
 	pEntry->stopped = false;
 	pEntry->moreNetWork = true;
 
+	pEntry->compress_tuples = gp_interconnect_compression;
+	pEntry->batch_tuples = TupleBatchSupported(&pEntry->ser_tup_info);
+	pEntry->num_send_batches = 0;
+	pEntry->send_batches = NULL;
+	pEntry->recv_batches = NULL;
+	pEntry->recv_batches_tail = NULL;
+	pEntry->stat_compress_raw_bytes = 0;
+	pEntry->stat_compress_bytes = 0;
+
 
 	/* All done!  Go back to caller memory-context. */
 	MemoryContextSwitchTo(oldCtxt);
@@ -484,6 +589,7 @@ SendTuple(MotionLayerState *mlStates,
 	TupleChunkListData tcList;
 	MemoryContext oldCtxt;
 	SendReturnCode rc;
+	bool		compress;
 
 	AssertArg(tuple != NULL);
 		
@@ -504,7 +610,10 @@ SendTuple(MotionLayerState *mlStates,
 	elog(DEBUG5, "Serializing HeapTuple for sending.");
 #endif
 
-	if (targetRoute != BROADCAST_SEGIDX)
+	/* A tuple to be compressed can't be serialized into the transport buffer. */
+	compress = shouldCompressTuple(pMNEntry, tuple);
+
+	if (targetRoute != BROADCAST_SEGIDX && !compress)
 	{
 		struct directTransportBuffer b;
 
@@ -537,6 +646,9 @@ SendTuple(MotionLayerState *mlStates,
 
 	SerializeTupleIntoChunks(tuple, &pMNEntry->ser_tup_info, &tcList);
 
+	if (compress)
+		compressTuple(pMNEntry, &tcList);
+
 	MemoryContextSwitchTo(oldCtxt);
 
 #ifdef AMS_VERBOSE_LOGGING
@@ -569,6 +681,143 @@ SendTuple(MotionLayerState *mlStates,
 	return rc;
 }
 
+/*
+ * Function:  SendTupleBatched - Adds a tuple to the batch for its route,
+ * sending the batch when it is full.
+ */
+SendReturnCode
+SendTupleBatched(MotionLayerState *mlStates,
+				 ChunkTransportState *transportStates,
+				 int16 motNodeID,
+				 TupleTableSlot *slot,
+				 int16 targetRoute)
+{
+	MotionNodeEntry *pMNEntry;
+	SerTupInfo *pSerInfo;
+	TupleBatch *batch;
+	MemoryContext oldCtxt;
+	bool		added;
+
+	AssertArg(slot != NULL);
+	AssertArg(targetRoute != BROADCAST_SEGIDX);
+
+	pMNEntry = getMotionNodeEntry(mlStates, motNodeID, "SendTupleBatched");
+	pSerInfo = &pMNEntry->ser_tup_info;
+
+	if (!pMNEntry->batch_tuples ||
+		(gp_motion_slice_noop != 0 && (gp_motion_slice_noop & (1 << currentSliceId)) != 0))
+		return SendTuple(mlStates, transportStates, motNodeID,
+						 ExecFetchSlotGenericTuple(slot, true), targetRoute);
+
+	oldCtxt = MemoryContextSwitchTo(mlStates->motion_layer_mctx);
+
+	if (pMNEntry->send_batches == NULL)
+	{
+		ChunkTransportStateEntry *pEntry = NULL;
+		int			i;
+
+		getChunkTransportState(transportStates, motNodeID, &pEntry);
+
+		pMNEntry->num_send_batches = pEntry->numConns;
+		pMNEntry->send_batches = palloc(pEntry->numConns * sizeof(TupleBatch));
+		for (i = 0; i < pEntry->numConns; i++)
+			InitTupleBatch(pSerInfo, &pMNEntry->send_batches[i], mlStates->motion_layer_mctx);
+	}
+
+	Assert(targetRoute >= 0 && targetRoute < pMNEntry->num_send_batches);
+	batch = &pMNEntry->send_batches[targetRoute];
+
+	slot_getallattrs(slot);
+	added = AddTupleToBatch(pSerInfo, batch, slot_get_values(slot), slot_get_isnull(slot));
+
+	MemoryContextSwitchTo(oldCtxt);
+
+	if (!added)
+	{
+		/* Full, or a tuple that can't be batched: send what we have first. */
+		if (!flushTupleBatch(mlStates, transportStates, pMNEntry, motNodeID, targetRoute))
+			return STOP_SENDING;
+
+		oldCtxt = MemoryContextSwitchTo(mlStates->motion_layer_mctx);
+		added = AddTupleToBatch(pSerInfo, batch, slot_get_values(slot), slot_get_isnull(slot));
+		MemoryContextSwitchTo(oldCtxt);
+
+		if (!added)
+			return SendTuple(mlStates, transportStates, motNodeID,
+							 ExecFetchSlotGenericTuple(slot, true), targetRoute);
+	}
+
+	if (batch->ntuples >= TUPLE_BATCH_MAX_TUPLES)
+	{
+		if (!flushTupleBatch(mlStates, transportStates, pMNEntry, motNodeID, targetRoute))
+			return STOP_SENDING;
+	}
+
+	return SEND_COMPLETE;
+}
+
+/*
+ * Send the tuples batched for a route in one TC_BATCH chunk.
+ *
+ * Returns false if the receiver doesn't want any more tuples.
+ */
+static bool
+flushTupleBatch(MotionLayerState *mlStates, ChunkTransportState *transportStates,
+				MotionNodeEntry *pMNEntry, int16 motNodeID, int16 targetRoute)
+{
+	SerTupInfo *pSerInfo = &pMNEntry->ser_tup_info;
+	TupleBatch *batch = &pMNEntry->send_batches[targetRoute];
+	TupleChunkListData tcList;
+	TupleChunkListItem tcItem;
+	MemoryContext oldCtxt;
+	int			ntuples = batch->ntuples;
+	int			len;
+	bool		sent;
+
+	if (ntuples == 0)
+		return true;
+
+	oldCtxt = MemoryContextSwitchTo(mlStates->motion_layer_mctx);
+
+	tcList.p_first = NULL;
+	tcList.p_last = NULL;
+	tcList.num_chunks = 0;
+	tcList.serialized_data_length = 0;
+	tcList.max_chunk_length = Gp_max_tuple_chunk_size;
+
+	tcItem = getChunkFromCache(&pSerInfo->chunkCache);
+	if (tcItem == NULL)
+	{
+		ereport(FATAL, (errcode(ERRCODE_OUT_OF_MEMORY),
+						errmsg("Could not allocate space for tuple batch chunk.")));
+	}
+
+	len = SerializeTupleBatch(pSerInfo, batch, (char *) tcItem->chunk_data + TUPLE_CHUNK_HEADER_SIZE);
+	SetChunkType(tcItem->chunk_data, TC_BATCH);
+	SetChunkDataSize(tcItem->chunk_data, len);
+	tcItem->chunk_length = TUPLE_CHUNK_HEADER_SIZE + len;
+	appendChunkToTCList(&tcList, tcItem);
+	tcList.serialized_data_length = len;
+
+	ResetTupleBatch(pSerInfo, batch);
+
+	MemoryContextSwitchTo(oldCtxt);
+
+	sent = SendTupleChunkToAMS(mlStates, transportStates, motNodeID, targetRoute, tcList.p_first);
+	if (!sent)
+		pMNEntry->stopped = true;
+	else
+	{
+		/* update stats; every tuple of the batch counts as a send */
+		statSendTuple(mlStates, pMNEntry, &tcList);
+		pMNEntry->stat_total_sends += ntuples - 1;
+	}
+
+	clearTCList(&pSerInfo->chunkCache, &tcList);
+
+	return sent;
+}
+
 TupleChunkListItem
 get_eos_tuplechunklist(void)
 {
@@ -593,6 +842,15 @@ SendEndOfStream(MotionLayerState       *mlStates,
 	 */
 	pMNEntry = getMotionNodeEntry(mlStates, motNodeID, "SendEndOfStream");
 
+	/* Send the tuples still waiting in batches. */
+	if (pMNEntry->send_batches != NULL)
+	{
+		int			i;
+
+		for (i = 0; i < pMNEntry->num_send_batches; i++)
+			(void) flushTupleBatch(mlStates, transportStates, pMNEntry, motNodeID, i);
+	}
+
 	transportStates->SendEos(mlStates, transportStates, motNodeID, s_eos_chunk_data);
 
 	/*
@@ -715,6 +973,56 @@ RecvTupleFrom(MotionLayerState *mlStates,
 }
 
 
+/*
+ * Like RecvTupleFrom() for an unordered receiver, but stores the tuple in a
+ * slot.  Tuples that came in batches are stored as virtual tuples, without
+ * forming a HeapTuple for each.
+ */
+ReceiveReturnCode
+RecvTupleSlot(MotionLayerState *mlStates,
+			  ChunkTransportState *transportStates,
+			  int16 motNodeID,
+			  TupleTableSlot *slot)
+{
+	MotionNodeEntry *pMNEntry;
+	HeapTuple	tuple;
+	ReceiveReturnCode recvRC;
+
+	pMNEntry = getMotionNodeEntry(mlStates, motNodeID, "RecvTupleSlot");
+	Assert(pMNEntry->preserve_order == 0);
+
+	for (;;)
+	{
+		if (nextBatchedTuple(pMNEntry, slot))
+		{
+			recvRC = GOT_TUPLE;
+			break;
+		}
+
+		tuple = htfifo_gettuple(pMNEntry->ready_tuples);
+		if (tuple != NULL)
+		{
+			ExecStoreGenericTuple(tuple, slot, true /* shouldFree */);
+			recvRC = GOT_TUPLE;
+			break;
+		}
+
+		if (!pMNEntry->moreNetWork)
+		{
+			recvRC = END_OF_STREAM;
+			break;
+		}
+
+		processIncomingChunks(mlStates, transportStates, pMNEntry, motNodeID, ANY_ROUTE);
+	}
+
+	/* Stats */
+	statRecvTuple(pMNEntry, NULL, recvRC);
+
+	return recvRC;
+}
+
+
 /*
  * This helper function is the receive-tuple workhorse.  It pulls
  * tuple chunks from the AMS, and pushes them to the chunk-sorter
@@ -784,7 +1092,7 @@ processIncomingChunks(MotionLayerState *mlStates,
 	}
 
 	/* The chunk list we just processed freed-up our rx-buffer space. */
-	if (Gp_interconnect_type == INTERCONNECT_TYPE_UDPIFC)
+	if (INTERCONNECT_IS_UDPIFC())
 		MlPutRxBufferIFC(transportStates, motNodeID, srcRoute);
 
 	/* Stats */
@@ -897,6 +1205,17 @@ EndMotionLayerNode(MotionLayerState *mlStates, int16 motNodeID, bool flushCommLa
 		         pMNEntry->sel_wr_wait
 		        );
         }
+        if (pMNEntry->stat_compress_raw_bytes > 0)
+        {
+            elog(LOG, "Interconnect seg%d slice%d compressed " UINT64_FORMAT " tuple bytes into "
+                 UINT64_FORMAT " bytes%s.",
+                 Gp_segment,
+                 currentSliceId,
+                 pMNEntry->stat_compress_raw_bytes,
+                 pMNEntry->stat_compress_bytes,
+                 pMNEntry->compress_tuples ? "" : "; switched off for poor ratio"
+                );
+        }
         if (pMNEntry->stat_total_bytes_recvd > 0 ||
             pMNEntry->sel_rd_wait > 0)
         {
@@ -915,6 +1234,15 @@ EndMotionLayerNode(MotionLayerState *mlStates, int16 motNodeID, bool flushCommLa
         }
     }
 
+	while (pMNEntry->recv_batches != NULL)
+	{
+		RecvTupleBatch *batch = pMNEntry->recv_batches;
+
+		pMNEntry->recv_batches = batch->next_batch;
+		FreeRecvTupleBatch(batch);
+	}
+	pMNEntry->recv_batches_tail = NULL;
+
 	CleanupSerTupInfo(&pMNEntry->ser_tup_info);
 	FreeTupleDesc(pMNEntry->tuple_desc);
 	if (!pMNEntry->preserve_order)
@@ -1119,6 +1447,21 @@ addChunkToSorter(MotionLayerState *mlStates,
 
 			break;
 
+		case TC_BATCH:
+			/* There shouldn't be any partial tuple data in the list! */
+			if (chunkSorterEntry->chunk_list.num_chunks != 0)
+			{
+				ereport(ERROR, (errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+				   errmsg("Received TC_BATCH chunk from [src=%d,mn=%d] after"
+						  " partial tuple data.", srcRoute, motNodeID)));
+			}
+
+			/* Decode the whole batch. */
+			reconstructTupleBatch(pMNEntry, chunkSorterEntry, tcItem);
+			pfree(tcItem);
+
+			break;
+
 		case TC_PARTIAL_START:
 
 			/* There shouldn't be any partial tuple data in the list! */
@@ -1365,3 +1708,50 @@ UpdateSentRecordCache(MotionConn *conn)
 	conn->sent_record_typmod = NextRecordTypmod;
 }
 
+
+/*
+ * Return true if the tuple should be compressed before it is sent
+ */
+static bool
+shouldCompressTuple(MotionNodeEntry *pMNEntry, HeapTuple tuple)
+{
+	uint32		len;
+
+	if (!pMNEntry->compress_tuples)
+		return false;
+
+	if (is_heaptuple_memtuple(tuple))
+		len = memtuple_get_size((MemTuple) tuple);
+	else
+		len = tuple->t_len;
+
+	return len >= MOTION_COMPRESS_MIN_TUPLE_SIZE;
+}
+
+/*
+ * Compress a serialized tuple, and switch compression off for the motion
+ * node if the data doesn't shrink enough.
+ */
+static void
+compressTuple(MotionNodeEntry *pMNEntry, TupleChunkList tcList)
+{
+	int			rawlen = tcList->serialized_data_length;
+
+	CompressTupleChunks(&pMNEntry->ser_tup_info, tcList);
+
+	pMNEntry->stat_compress_raw_bytes += rawlen;
+	pMNEntry->stat_compress_bytes += tcList->serialized_data_length;
+
+	if (pMNEntry->stat_compress_raw_bytes >= MOTION_COMPRESS_PROBE_BYTES &&
+		pMNEntry->stat_compress_bytes > pMNEntry->stat_compress_raw_bytes * MOTION_COMPRESS_MAX_RATIO)
+	{
+		pMNEntry->compress_tuples = false;
+
+		if (gp_log_interconnect >= GPVARS_VERBOSITY_DEBUG)
+			elog(DEBUG1, "Motion node %d: compressed " UINT64_FORMAT " tuple bytes into "
+				 UINT64_FORMAT " bytes, switching compression off",
+				 pMNEntry->motion_node_id,
+				 pMNEntry->stat_compress_raw_bytes,
+				 pMNEntry->stat_compress_bytes);
+	}
+}
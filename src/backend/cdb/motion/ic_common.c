@@ -227,7 +227,7 @@ InitMotionLayerIPC(void)
 
 	if (Gp_interconnect_type == INTERCONNECT_TYPE_TCP)
 		InitMotionTCP(&TCP_listenerFd, &tcp_listener);
-	else if (Gp_interconnect_type == INTERCONNECT_TYPE_UDPIFC)
+	else if (INTERCONNECT_IS_UDPIFC())
 		InitMotionUDPIFC(&UDP_listenerFd, &udp_listener);
 
 	Gp_listener_port = (udp_listener<<16) | tcp_listener;
@@ -244,7 +244,7 @@ CleanUpMotionLayerIPC(void)
 
 	if (Gp_interconnect_type == INTERCONNECT_TYPE_TCP)
 		CleanupMotionTCP();
-	else if (Gp_interconnect_type == INTERCONNECT_TYPE_UDPIFC)
+	else if (INTERCONNECT_IS_UDPIFC())
 		CleanupMotionUDPIFC();
 
 	/* close down the Interconnect listener socket. */
@@ -474,7 +474,7 @@ DeregisterReadInterest(ChunkTransportState *transportStates,
              reason);
     }
 
-	if (Gp_interconnect_type == INTERCONNECT_TYPE_UDPIFC)
+	if (INTERCONNECT_IS_UDPIFC())
 	{
 #ifdef AMS_VERBOSE_LOGGING
 		elog(LOG, "deregisterReadInterest set stillactive = false for node %d route %d (%s)", motNodeID, srcRoute, reason);
@@ -646,7 +646,7 @@ setupSeqServerConnection(char *seqServerHost, uint16 seqServerPort)
 void
 SetupInterconnect(EState *estate)
 {
-	if (Gp_interconnect_type == INTERCONNECT_TYPE_UDPIFC)
+	if (INTERCONNECT_IS_UDPIFC())
 		SetupUDPIFCInterconnect(estate);
 	else if (Gp_interconnect_type == INTERCONNECT_TYPE_TCP)
 		SetupTCPInterconnect(estate);
@@ -683,7 +683,7 @@ TeardownInterconnect(ChunkTransportState *transportStates,
 					 MotionLayerState *mlStates,
 					 bool forceEOS, bool hasError)
 {
-	if (Gp_interconnect_type == INTERCONNECT_TYPE_UDPIFC)
+	if (INTERCONNECT_IS_UDPIFC())
 	{
 		TeardownUDPIFCInterconnect(transportStates, mlStates, forceEOS);
 	}
@@ -759,6 +759,7 @@ createChunkTransportState(ChunkTransportState *transportStates,
     pEntry->numConns = numPrimaryConns;
 	pEntry->numPrimaryConns = numPrimaryConns;
     pEntry->scanStart = 0;
+	pEntry->numShmConns = 0;
     pEntry->sendSlice = sendSlice;
     pEntry->recvSlice = recvSlice;
 
@@ -906,7 +907,7 @@ checkForCancelFromQD(ChunkTransportState *pTransportStates)
 void
 WaitInterconnectQuit(void)
 {
-	if (Gp_interconnect_type == INTERCONNECT_TYPE_UDPIFC)
+	if (INTERCONNECT_IS_UDPIFC())
 	{
 		WaitInterconnectQuitUDPIFC();
 	}
@@ -46,6 +46,10 @@
 #include <fcntl.h>
 #include <limits.h>
 #include <unistd.h>
+#include <dirent.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <arpa/inet.h>
 #include "pgtime.h"
 #include <netinet/in.h>
@@ -126,6 +130,16 @@ timeoutArray[] =
 /* 1/4 sec in msec */
 #define RX_THREAD_POLL_TIMEOUT (250)
 
+/*
+ * Batched I/O (gp_interconnect_batch_io) uses sendmmsg() and recvmmsg(),
+ * which are Linux specific. UDP_IO_BATCH_SIZE is the most packets moved
+ * by one call.
+ */
+#if defined(__linux__)
+#define UDPIFC_BATCH_IO
+#endif
+#define UDP_IO_BATCH_SIZE (32)
+
 /*
  * Flags definitions for flag-field of UDP-messages
  *
@@ -139,6 +153,7 @@ timeoutArray[] =
 #define UDPIC_FLAGS_DISORDER    		(32)
 #define UDPIC_FLAGS_DUPLICATE   		(64)
 #define UDPIC_FLAGS_CAPACITY    		(128)
+#define UDPIC_FLAGS_SHM_WAKEUP			(256)
 
 /*
  * ConnHtabBin
@@ -505,6 +520,17 @@ static ICGlobalControlInfo ic_control_info;
 #define MAX_DEV MAX_RTT
 #define DEV_SHIFT_COEFFICIENT (2) /* DEV_COEFFICIENT 1/4 (0.25) */
 
+/*
+ * Delay-based flow control keeps the estimated number of packets a
+ * connection has queued in the network between DELAY_FC_ALPHA and
+ * DELAY_FC_BETA, see updateDelayWindow().
+ */
+#define DELAY_FC_ALPHA (2)
+#define DELAY_FC_BETA (4)
+#define DELAY_FC_INIT_CWND (2)
+#define DELAY_FC_MIN_CWND (1)
+#define DELAY_FC_MAX_CWND (Gp_interconnect_queue_depth)
+
 #define MAX_EXPIRATION_PERIOD (1000 * 1000) /* 1s */
 #define MIN_EXPIRATION_PERIOD (Gp_interconnect_min_rto * 1000) /* default: 20ms */
 
@@ -596,6 +622,12 @@ typedef struct AckSendParam
  * duplicatedPktNum          - duplicate packet number.
  * recvAckNum                - the number of Acks received.
  * statusQueryMsgNum         - the number of status query messages sent.
+ * sndBatchCallNum           - the number of sendmmsg() calls for data packets.
+ * sndBatchPktNum            - the number of data packets sent by those calls.
+ * recvBatchCallNum          - the number of recvmmsg() calls that got packets.
+ * recvBatchPktNum           - the number of packets received by those calls.
+ * ackBatchCallNum           - the number of sendmmsg() calls for acks.
+ * ackBatchPktNum            - the number of acks sent by those calls.
  *
  */
 typedef struct ICStatistics
@@ -617,11 +649,97 @@ typedef struct ICStatistics
 	int32   duplicatedPktNum;
 	int32	recvAckNum;
 	int32	statusQueryMsgNum;
+	int32	sndBatchCallNum;
+	int32	sndBatchPktNum;
+	int32	recvBatchCallNum;
+	int32	recvBatchPktNum;
+	int32	ackBatchCallNum;
+	int32	ackBatchPktNum;
+	int32	shmSndPktNum;
+	int32	shmRecvPktNum;
+	int32	shmWakeupNum;
 } ICStatistics;
 
 /* Statistics for UDP interconnect. */
 static ICStatistics ic_statistics;
 
+#ifdef UDPIFC_BATCH_IO
+/*
+ * RxBatch
+ *
+ * The receive buffers and message headers the rx thread hands to
+ * recvmmsg(), and the acks it collects for one sendmmsg() call.
+ * Only the rx thread touches it.
+ */
+typedef struct RxBatch
+{
+	icpkthdr   *pkts[UDP_IO_BATCH_SIZE];
+	struct mmsghdr msgs[UDP_IO_BATCH_SIZE];
+	struct iovec iovs[UDP_IO_BATCH_SIZE];
+	struct sockaddr_storage peers[UDP_IO_BATCH_SIZE];
+	AckSendParam params[UDP_IO_BATCH_SIZE];
+} RxBatch;
+
+static RxBatch rx_batch;
+#endif
+
+/*
+ * ICShmRing
+ *
+ * With gp_interconnect_type "shm", a connection whose peer runs on the same
+ * host passes its packets through a ring of packet slots in a POSIX shared
+ * memory segment instead of the UDP socket.
+ *
+ * The sender copies a packet into the slot at head and advances head.  The
+ * receiver reads the packet at tail in place, and advances tail when the
+ * motion layer releases it.  A full ring holds the sender back just like
+ * the receive queue capacity does for UDP.  The memory is reliable, so
+ * these packets need no CRC, acks or retransmits.
+ *
+ * The receiver creates the segment (O_EXCL) while it sets up its incoming
+ * connections, which every process does before it sets up its outgoing
+ * ones, and marks it SHM_RING_READY.  The sender opens the existing
+ * segment, waiting for it to show up if need be, and unlinks the name as
+ * soon as it has the segment mapped; the memory then goes away with the
+ * last mapping, however the processes exit.  Only a crash between the two
+ * steps can leave a name behind, and RemoveStaleInterconnectShm() removes
+ * those at postmaster start.
+ *
+ * A side that finds the ring empty (receiver) or full (sender) sets its
+ * waiting flag and sleeps on ic_control_info.cond like the UDP code does.
+ * The other side sends it a UDPIC_FLAGS_SHM_WAKEUP packet when it moves
+ * the ring past a set flag, and the rx thread signals the condition.  The
+ * receiver asks the sender to stop by setting SHM_RING_STOP.
+ */
+#define SHM_RING_STOP			(1 << 0)
+#define SHM_RING_READY			(1 << 1)
+#define SHM_RING_ATTACHED		(1 << 2)
+
+#define SHM_RING_CACHE_LINE		(64)
+#define SHM_RING_NAME_LEN		(64)
+#define SHM_RING_NAME_PREFIX	"gpic."
+
+/* The longest sleep, in usec, while waiting for the receiver to create a ring. */
+#define SHM_RING_MAX_SETUP_WAIT	(100000)
+
+typedef struct ICShmRing
+{
+	pg_atomic_uint32 geometry;	/* (slots << 16) | slot size, set by the
+								 * receiver */
+	pg_atomic_uint32 flags;		/* SHM_RING_* */
+	char		pad1[SHM_RING_CACHE_LINE - 2 * sizeof(pg_atomic_uint32)];
+
+	pg_atomic_uint32 head;		/* advanced by the sender only */
+	pg_atomic_uint32 rxWaiting;	/* the receiver sleeps until head moves */
+	char		pad2[SHM_RING_CACHE_LINE - 2 * sizeof(pg_atomic_uint32)];
+
+	pg_atomic_uint32 tail;		/* advanced by the receiver only */
+	pg_atomic_uint32 txWaiting;	/* the sender sleeps until tail moves */
+	char		pad3[SHM_RING_CACHE_LINE - 2 * sizeof(pg_atomic_uint32)];
+
+	/* the packet slots follow */
+} ICShmRing;
+
 /*=========================================================================
  * STATIC FUNCTIONS declarations
  */
@@ -665,6 +783,9 @@ static void sendAck(MotionConn *conn, int32 flags, uint32 seq, uint32 extraSeq);
 static void sendDisorderAck(MotionConn *conn, uint32 seq, uint32 extraSeq, uint32 lostPktCnt);
 static void sendStatusQueryMessage(MotionConn *conn, int fd, uint32 seq);
 static inline void sendControlMessage(icpkthdr *pkt, int fd, struct sockaddr *addr, socklen_t peerLen);
+#ifdef UDPIFC_BATCH_IO
+static void sendAckBatch(AckSendParam *params, int nparams);
+#endif
 
 static void putRxBufferAndSendAck(MotionConn *conn, AckSendParam *param);
 static inline void putRxBufferToFreeList(RxBufferPool *p, icpkthdr *buf);
@@ -723,6 +844,14 @@ static void checkQDConnectionAlive(void);
 
 
 static void *rxThreadFunc(void *arg);
+static bool checkRxPacket(icpkthdr *pkt, int read_count);
+static bool dispatchRxPacket(icpkthdr *pkt, struct sockaddr_storage *peer, socklen_t *peerlen, AckSendParam *param);
+#ifdef UDPIFC_BATCH_IO
+static inline bool useBatchIO(void);
+static int getRxBatchBuffers(RxBatch *batch);
+static void handleRxBatch(RxBatch *batch, int nread);
+static void freeRxBatchBuffers(RxBatch *batch);
+#endif
 
 static bool handleMismatch(icpkthdr *pkt, struct sockaddr_storage *peer, int peer_len);
 static void handleAckedPacket(MotionConn *ackConn, ICBuffer *buf, uint64 now);
@@ -738,11 +867,29 @@ static inline void addCRC(icpkthdr *pkt);
 static inline bool checkCRC(icpkthdr *pkt);
 static void sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn);
 static void sendOnce(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, ICBuffer *buf, MotionConn * conn);
+#ifdef UDPIFC_BATCH_IO
+static void sendBatch(ChunkTransportStateEntry *pEntry, ICBuffer **bufs, int nbufs, MotionConn *conn);
+#endif
 static inline uint64 computeExpirationPeriod(MotionConn *conn, uint32 retry);
 
 static ICBuffer *getSndBuffer(MotionConn *conn);
 static void initSndBufferPool();
 
+/* Shared-memory ring functions. */
+static bool useShmRing(Slice *mySlice, CdbProcess *peer);
+static void shmRingName(MotionConn *conn, char *name, int len);
+static void createShmRing(MotionConn *conn);
+static void attachShmRing(MotionConn *conn);
+static void detachShmRing(MotionConn *conn, bool isSender);
+static inline bool shmRingHasPacket(MotionConn *conn);
+static void wakeShmPeer(MotionConn *conn, pg_atomic_uint32 *waiting);
+static void releaseShmPacket(MotionConn *conn);
+static MotionConn *pollShmConns(ChunkTransportStateEntry *pEntry, MotionConn *conn);
+static bool prepareShmWait(ChunkTransportStateEntry *pEntry, MotionConn *conn);
+static bool sendShmPacket(ChunkTransportState *transportStates, MotionConn *conn);
+static void finishShmConn(MotionConn *conn);
+static void checkShmWait(ChunkTransportState *transportStates, int retry);
+
 static void putIntoUnackQueueRing(UnackQueueRing *uqr, ICBuffer *buf, uint64 expTime, uint64 now);
 static void initUnackQueueRing(UnackQueueRing *uqr);
 
@@ -759,6 +906,7 @@ static bool waitOnCondition(int timeout_us, pthread_cond_t *cond, pthread_mutex_
 
 static inline void logPkt(char *prefix, icpkthdr *pkt);
 static void aggregateStatistics(ChunkTransportStateEntry *pEntry);
+static void updateDelayWindow(MotionConn *conn, uint64 ackTime);
 
 static inline bool pollAcks(ChunkTransportState *transportStates, int fd, int timeout);
 
@@ -1379,6 +1527,10 @@ InitMotionUDPIFC(int *listenerSocketFd, uint16 *listenerPort)
 	/* Initialize receive buffer pool */
 	rx_buffer_pool.count = 0;
 	rx_buffer_pool.maxCount = 1;
+#ifdef UDPIFC_BATCH_IO
+	/* the rx thread may hold a full batch of buffers for recvmmsg() */
+	rx_buffer_pool.maxCount += UDP_IO_BATCH_SIZE;
+#endif
 	rx_buffer_pool.freeList = NULL;
 
 	/* Initialize send control data */
@@ -1782,6 +1934,59 @@ sendControlMessage(icpkthdr *pkt, int fd, struct sockaddr *addr, socklen_t peerL
 		write_log("sendcontrolmessage: got error %d errno %d seq %d", n, errno, pkt->seq);
 }
 
+#ifdef UDPIFC_BATCH_IO
+/*
+ * sendAckBatch
+ * 		Send the acks collected by the rx thread with sendmmsg().
+ *
+ * Like sendControlMessage, a failed send is left to the retransmit logic.
+ */
+static void
+sendAckBatch(AckSendParam *params, int nparams)
+{
+	struct mmsghdr msgs[UDP_IO_BATCH_SIZE];
+	struct iovec iovs[UDP_IO_BATCH_SIZE];
+	int			sent = 0;
+	int			i;
+
+	Assert(nparams <= UDP_IO_BATCH_SIZE);
+
+	for (i = 0; i < nparams; i++)
+	{
+		if (gp_interconnect_full_crc)
+			addCRC(&params[i].msg);
+
+		iovs[i].iov_base = &params[i].msg;
+		iovs[i].iov_len = params[i].msg.len;
+
+		memset(&msgs[i], 0, sizeof(struct mmsghdr));
+		msgs[i].msg_hdr.msg_name = &params[i].peer;
+		msgs[i].msg_hdr.msg_namelen = params[i].peer_len;
+		msgs[i].msg_hdr.msg_iov = &iovs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	while (sent < nparams)
+	{
+		int			n;
+
+		n = sendmmsg(UDP_listenerFd, msgs + sent, nparams - sent, 0);
+		if (n < 0)
+		{
+			if (errno == EINTR)
+				continue;
+
+			write_log("sendAckBatch: got error %d errno %d seq %d", n, errno, params[sent].msg.seq);
+			break;
+		}
+
+		pg_atomic_add_fetch_u32((pg_atomic_uint32 *)&ic_statistics.ackBatchCallNum, 1);
+		pg_atomic_add_fetch_u32((pg_atomic_uint32 *)&ic_statistics.ackBatchPktNum, n);
+		sent += n;
+	}
+}
+#endif
+
 /*
  * setAckSendParam
  * 		Set the ack sending parameters.
@@ -1958,6 +2163,16 @@ MlPutRxBufferIFC(ChunkTransportState *transportStates, int motNodeID, int route)
 
 	conn = pEntry->conns + route;
 
+	if (conn->shmRing != NULL)
+	{
+		if (conn->pBuff == NULL)
+			elog(FATAL, "Interconnect error: tried to release a NULL buffer");
+
+		/* no ack: the free slot is all the sender needs */
+		releaseShmPacket(conn);
+		return;
+	}
+
 	memset(&param, 0, sizeof(AckSendParam));
 
 	pthread_mutex_lock(&ic_control_info.lock);
@@ -2580,191 +2795,766 @@ getSndBuffer(MotionConn *conn)
 
 
 /*
- * startOutgoingUDPConnections
- * 		Used to initially kick-off any outgoing connections for mySlice.
- *
- * This should not be called for root slices (i.e. QD ones) since they don't
- * ever have outgoing connections.
- *
- * PARAMETERS
- *
- *	 sendSlice	- Slice that this process is a member of.
+ * useShmRing
+ * 		Should the connection with this peer go through a shared-memory ring?
  *
- * RETURNS
- *	 Initialized ChunkTransportState for the Sending Motion Node Id.
+ * Both ends come to the same answer: the peer is a segment QE that has the
+ * same interconnect address as we have.  The QD and entry db always use UDP.
  */
-static ChunkTransportStateEntry *
-startOutgoingUDPConnections(ChunkTransportState *transportStates,
-							Slice		*sendSlice,
-							int			*pOutgoingCount)
+static bool
+useShmRing(Slice *mySlice, CdbProcess *peer)
 {
-	ChunkTransportStateEntry *pEntry;
-	MotionConn *conn;
 	ListCell   *cell;
-	Slice	   *recvSlice;
-	CdbProcess *cdbProc;
-	int					i;
-
-	*pOutgoingCount = 0;
-
-	recvSlice = (Slice *) list_nth(transportStates->sliceTable->slices, sendSlice->parentIndex);
-
-	/*
-	 * Potentially introduce a Bug (MPP-17186).
-	 * The workaround is to turn off log_hostname guc.
-	 */
-	adjustMasterRouting(recvSlice);
-
-	if (gp_log_interconnect >= GPVARS_VERBOSITY_DEBUG)
-		elog(DEBUG1, "Interconnect seg%d slice%d setting up sending motion node",
-			 Gp_segment, sendSlice->sliceIndex);
 
-	pEntry = createChunkTransportState(transportStates,
-									   sendSlice,
-									   recvSlice,
-									   list_length(recvSlice->primaryProcesses));
+	if (Gp_interconnect_type != INTERCONNECT_TYPE_SHM)
+		return false;
 
-	Assert(pEntry && pEntry->valid);
-	/*
-	 * Setup a MotionConn entry for each of our outbound connections.
-	 * Request a connection to each receiving backend's listening port.
-	 * NB: Some mirrors could be down & have no CdbProcess entry.
-	 */
-	conn = pEntry->conns;
+	if (Gp_segment < 0 || peer->contentid < 0 || peer->listenerAddr == NULL)
+		return false;
 
-	i = 0;
-	foreach(cell, recvSlice->primaryProcesses)
+	foreach(cell, mySlice->primaryProcesses)
 	{
-		cdbProc = (CdbProcess *)lfirst(cell);
-		if (cdbProc)
-		{
-			conn->cdbProc = cdbProc;
-			icBufferListInit(&conn->sndQueue, ICBufferListType_Primary);
-			icBufferListInit(&conn->unackQueue, ICBufferListType_Primary);
-			conn->capacity = Gp_interconnect_queue_depth;
-
-			/* send buffer pool must be initialized before this. */
-			snd_buffer_pool.maxCount += Gp_interconnect_snd_queue_depth;
-			snd_control_info.cwnd += 1;
-			conn->curBuff = getSndBuffer(conn);
+		CdbProcess *self = (CdbProcess *) lfirst(cell);
 
-			/* should have at least one buffer for each connection */
-			Assert(conn->curBuff != NULL);
+		if (self != NULL && self->pid == MyProcPid)
+			return (self->listenerAddr != NULL &&
+					strcmp(self->listenerAddr, peer->listenerAddr) == 0);
+	}
 
-			conn->rtt = DEFAULT_RTT;
-			conn->dev = DEFAULT_DEV;
-			conn->deadlockCheckBeginTime = 0;
-			conn->tupleCount = 0;
-			conn->msgSize = sizeof(conn->conn_info);
-			conn->sentSeq = 0;
-			conn->receivedAckSeq = 0;
-			conn->consumedSeq = 0;
-			conn->pBuff = (uint8 *)conn->curBuff->pkt;
-			conn->state = mcsSetupOutgoingConnection;
-			conn->route = i++;
+	return false;
+}
 
-			(*pOutgoingCount)++;
-		}
+/*
+ * shmRingName
+ * 		The name of the shared memory segment of a connection.
+ */
+static void
+shmRingName(MotionConn *conn, char *name, int len)
+{
+	snprintf(name, len, "/" SHM_RING_NAME_PREFIX "%d.%u.%d.%d.%d",
+			 conn->conn_info.sessionId, conn->conn_info.icId,
+			 conn->conn_info.motNodeId, conn->conn_info.srcPid,
+			 conn->conn_info.dstPid);
+}
 
-		conn++;
-	}
+/*
+ * mapShmRing
+ * 		Map an open shared-memory ring segment for a connection.
+ */
+static void
+mapShmRing(MotionConn *conn, int fd, const char *name, uint32 numSlots, uint32 slotSize)
+{
+	void	   *addr;
 
-	pEntry->txfd = ICSenderSocket;
-	pEntry->txport = ICSenderPort;
-	pEntry->txfd_family = ICSenderFamily;
+	addr = mmap(NULL, sizeof(ICShmRing) + (Size) numSlots * slotSize,
+				PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (addr == MAP_FAILED)
+	{
+		int			save_errno = errno;
 
-	return pEntry;
+		close(fd);
+		errno = save_errno;
+		ereport(ERROR, (errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+						errmsg("Interconnect error: could not map shared memory segment \"%s\"", name),
+						errdetail("%m")));
+	}
+	close(fd);
 
+	conn->shmRing = (ICShmRing *) addr;
+	conn->shmNumSlots = numSlots;
+	conn->shmSlotSize = slotSize;
 }
 
-
 /*
- * getSockAddr
- * 		Convert IP addr and port to sockaddr
+ * createShmRing
+ * 		Create the shared-memory ring of an incoming connection, and map it.
+ *
+ * conn_info must have been filled in already.  The sender's listener
+ * address is looked up too, for the wakeup packets.
  */
 static void
-getSockAddr(struct sockaddr_storage *peer, socklen_t *peer_len, const char *listenerAddr, int listenerPort)
+createShmRing(MotionConn *conn)
 {
-	int			ret;
-	char		portNumberStr[32];
-	char	   *service;
-	struct addrinfo *addrs = NULL;
-	struct addrinfo hint;
+	char		name[SHM_RING_NAME_LEN];
+	uint32		slotSize = MAXALIGN(Gp_max_packet_size);
+	uint32		numSlots = Gp_interconnect_queue_depth;
+	int			fd;
 
-	/*
-	 * Get socketaddr to connect to.
-	 */
+	Assert(conn->shmRing == NULL);
 
-	/* Initialize hint structure */
-	MemSet(&hint, 0, sizeof(hint));
-	hint.ai_socktype = SOCK_DGRAM; /* UDP */
-	hint.ai_family = AF_UNSPEC; /* Allow for any family (v4, v6, even unix in the future)  */
-#ifdef AI_NUMERICSERV
-	hint.ai_flags = AI_NUMERICHOST | AI_NUMERICSERV;  /* Never do name resolution */
-#else
-	hint.ai_flags = AI_NUMERICHOST;  /* Never do name resolution */
-#endif
+	getSockAddr(&conn->peer, &conn->peer_len, conn->cdbProc->listenerAddr, conn->cdbProc->listenerPort);
 
-	snprintf(portNumberStr, sizeof(portNumberStr), "%d", listenerPort);
-	service = portNumberStr;
+	shmRingName(conn, name, sizeof(name));
 
-	ret = pg_getaddrinfo_all(listenerAddr, service, &hint, &addrs);
-	if (ret || !addrs)
+	/*
+	 * The name is unique to this connection of this process, so it can only
+	 * exist if something is badly wrong; don't guess whose it is.
+	 */
+	fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+	if (fd < 0)
+		ereport(ERROR, (errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+						errmsg("Interconnect error: could not create shared memory segment \"%s\"", name),
+						errdetail("%m")));
+
+	if (ftruncate(fd, sizeof(ICShmRing) + (off_t) numSlots * slotSize) < 0)
 	{
-		if (addrs)
-			pg_freeaddrinfo_all(hint.ai_family, addrs);
+		int			save_errno = errno;
 
+		close(fd);
+		shm_unlink(name);
+		errno = save_errno;
 		ereport(ERROR, (errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
-			errmsg("Interconnect Error: Could not parse remote listener"
-				   "address: '%s' port '%d': %s", listenerAddr,listenerPort,gai_strerror(ret)),
-			errdetail("getaddrinfo() unable to parse address: '%s'",
-					  listenerAddr)));
-		return;
+						errmsg("Interconnect error: could not size shared memory segment \"%s\"", name),
+						errdetail("%m")));
 	}
-	/* Since we aren't using name resolution, getaddrinfo will return only 1 entry */
 
-	elog(DEBUG1,"GetSockAddr socket ai_family %d ai_socktype %d ai_protocol %d for %s ",addrs->ai_family, addrs->ai_socktype, addrs->ai_protocol, listenerAddr);
-	memset(peer, 0, sizeof(struct sockaddr_storage));
-	memcpy(peer, addrs->ai_addr, addrs->ai_addrlen);
-	*peer_len = addrs->ai_addrlen;
+	PG_TRY();
+	{
+		mapShmRing(conn, fd, name, numSlots, slotSize);
+	}
+	PG_CATCH();
+	{
+		shm_unlink(name);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
 
-	pg_freeaddrinfo_all(addrs->ai_family, addrs);
+	/* the geometry must be visible before the sender sees the ring ready */
+	pg_atomic_write_u32(&conn->shmRing->geometry, (numSlots << 16) | slotSize);
+	pg_write_barrier();
+	pg_atomic_write_u32(&conn->shmRing->flags, SHM_RING_READY);
 }
 
 /*
- * setupOutgoingUDPConnection
- *		Setup outgoing UDP connection.
+ * attachShmRing
+ * 		Open and map the shared-memory ring of an outgoing connection.
+ *
+ * The receiver may not have created it yet, so wait for it, for up to
+ * interconnect_setup_timeout.  Must be called without ic_control_info.lock,
+ * as it may wait and error out.
  */
-void
-setupOutgoingUDPConnection(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn)
-{
-	CdbProcess		   *cdbProc = conn->cdbProc;
+static void
+attachShmRing(MotionConn *conn)
+{
+	char		name[SHM_RING_NAME_LEN];
+	uint32		slotSize = MAXALIGN(Gp_max_packet_size);
+	uint32		numSlots = Gp_interconnect_queue_depth;
+	uint32		geometry = (numSlots << 16) | slotSize;
+	uint32		found;
+	uint64		startTime = getCurrentTime();
+	struct stat	st;
+	int			retry = 0;
+	int			fd;
 
-	Assert(conn->state == mcsSetupOutgoingConnection);
-	Assert(conn->cdbProc);
+	Assert(conn->shmRing == NULL);
 
-	conn->wakeup_ms = 0;
-	conn->remoteContentId = cdbProc->contentid;
-	conn->stat_min_ack_time = ~((uint64)0);
+	shmRingName(conn, name, sizeof(name));
 
-	/* Save the information for the error message if getaddrinfo fails */
-	if (strchr(cdbProc->listenerAddr,':') != 0)
-		snprintf(conn->remoteHostAndPort, sizeof(conn->remoteHostAndPort),
-					 "[%s]:%d", cdbProc->listenerAddr, cdbProc->listenerPort);
-	else
-		snprintf(conn->remoteHostAndPort, sizeof(conn->remoteHostAndPort),
-			 "%s:%d", cdbProc->listenerAddr, cdbProc->listenerPort);
+	for (;;)
+	{
+		fd = shm_open(name, O_RDWR, 0);
+		if (fd >= 0)
+		{
+			if (fstat(fd, &st) < 0)
+			{
+				int			save_errno = errno;
 
-	/*
-	 * Get socketaddr to connect to.
-	 */
-	getSockAddr(&conn->peer, &conn->peer_len, cdbProc->listenerAddr, cdbProc->listenerPort);
+				close(fd);
+				errno = save_errno;
+				ereport(ERROR, (errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+								errmsg("Interconnect error: could not stat shared memory segment \"%s\"", name),
+								errdetail("%m")));
+			}
 
-	/* Save the destination IP address */
-	formatSockAddr((struct sockaddr *)&conn->peer, conn->remoteHostAndPort,
-					sizeof(conn->remoteHostAndPort));
+			/* sized, but not necessarily initialized yet */
+			if (st.st_size == sizeof(ICShmRing) + (off_t) numSlots * slotSize)
+				break;
 
-	Assert(conn->peer.ss_family == AF_INET || conn->peer.ss_family == AF_INET6 );
+			close(fd);
+			if (st.st_size != 0)
+				ereport(ERROR, (errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+								errmsg("Interconnect error: shared memory ring \"%s\" does not have %u slots of %u bytes",
+									   name, numSlots, slotSize),
+								errhint("gp_interconnect_queue_depth and gp_max_packet_size must be the same on all segments.")));
+		}
+		else if (errno != ENOENT)
+			ereport(ERROR, (errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+							errmsg("Interconnect error: could not open shared memory segment \"%s\"", name),
+							errdetail("%m")));
+
+		if (getCurrentTime() - startTime > (uint64) interconnect_setup_timeout * 1000 * 1000)
+			ereport(ERROR, (errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+							errmsg("Interconnect error: timed out waiting for shared memory segment \"%s\"", name)));
+
+		CHECK_FOR_INTERRUPTS();
+		pg_usleep(Min(1000L << Min(retry, 10), SHM_RING_MAX_SETUP_WAIT));
+		retry++;
+	}
+
+	mapShmRing(conn, fd, name, numSlots, slotSize);
+
+	/* nobody needs the name any more, once we have the memory */
+	if (shm_unlink(name) < 0 && errno != ENOENT)
+		elog(LOG, "could not unlink shared memory segment \"%s\": %m", name);
+
+	/* the receiver maps the segment before it marks it ready, so this is short */
+	while ((pg_atomic_read_u32(&conn->shmRing->flags) & SHM_RING_READY) == 0)
+	{
+		CHECK_FOR_INTERRUPTS();
+		pg_usleep(1000L);
+	}
+	pg_read_barrier();
+
+	found = pg_atomic_read_u32(&conn->shmRing->geometry);
+	if (found != geometry)
+		ereport(ERROR, (errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+						errmsg("Interconnect error: shared memory ring \"%s\" has %u slots of %u bytes, expected %u slots of %u bytes",
+							   name, found >> 16, found & 0xffff, numSlots, slotSize),
+						errhint("gp_interconnect_queue_depth and gp_max_packet_size must be the same on all segments.")));
+
+	pg_atomic_fetch_or_u32(&conn->shmRing->flags, SHM_RING_ATTACHED);
+}
+
+/*
+ * detachShmRing
+ * 		Unmap the shared-memory ring of a connection at teardown.
+ *
+ * A receiver whose sender never attached unlinks the name itself.
+ */
+static void
+detachShmRing(MotionConn *conn, bool isSender)
+{
+	ICShmRing  *ring = conn->shmRing;
+	uint32		oldFlags = 0;
+
+	if (ring == NULL)
+		return;
+
+	if (!isSender)
+	{
+		/* a receiver that goes away wants no more data */
+		oldFlags = pg_atomic_fetch_or_u32(&ring->flags, SHM_RING_STOP);
+		wakeShmPeer(conn, &ring->txWaiting);
+	}
+
+	munmap(ring, sizeof(ICShmRing) + (Size) conn->shmNumSlots * conn->shmSlotSize);
+	conn->shmRing = NULL;
+	conn->pBuff = NULL;
+
+	if (!isSender && (oldFlags & SHM_RING_ATTACHED) == 0)
+	{
+		char		name[SHM_RING_NAME_LEN];
+
+		shmRingName(conn, name, sizeof(name));
+		if (shm_unlink(name) < 0 && errno != ENOENT)
+			elog(LOG, "could not unlink shared memory segment \"%s\": %m", name);
+	}
+}
+
+/*
+ * RemoveStaleInterconnectShm
+ * 		Remove the shared-memory ring segments left behind by crashed
+ * 		receivers.
+ *
+ * The segment names are shared by all the instances on the host, so only
+ * those whose creating process is gone are removed.  Only Linux keeps them
+ * in a directory we can list; elsewhere this does nothing.
+ */
+void
+RemoveStaleInterconnectShm(void)
+{
+	DIR		   *dir;
+	struct dirent *de;
+
+	dir = opendir("/dev/shm");
+	if (dir == NULL)
+		return;
+
+	while ((de = readdir(dir)) != NULL)
+	{
+		char		name[MAXPGPATH];
+		int			sessionId;
+		unsigned int icId;
+		int			motNodeId;
+		int			srcPid;
+		int			dstPid;
+
+		if (strncmp(de->d_name, SHM_RING_NAME_PREFIX, strlen(SHM_RING_NAME_PREFIX)) != 0)
+			continue;
+
+		if (sscanf(de->d_name, SHM_RING_NAME_PREFIX "%d.%u.%d.%d.%d",
+				   &sessionId, &icId, &motNodeId, &srcPid, &dstPid) != 5 ||
+			dstPid <= 0)
+			continue;
+
+		/* the receiver, who created it, is still around */
+		if (kill(dstPid, 0) == 0 || errno != ESRCH)
+			continue;
+
+		snprintf(name, sizeof(name), "/%s", de->d_name);
+		if (shm_unlink(name) == 0)
+			elog(LOG, "removed stale interconnect shared memory segment \"%s\"", name);
+	}
+
+	closedir(dir);
+}
+
+/*
+ * shmRingSlot
+ * 		The address of the slot that holds packet number pos of a ring.
+ */
+static inline uint8 *
+shmRingSlot(MotionConn *conn, uint32 pos)
+{
+	return (uint8 *) conn->shmRing + sizeof(ICShmRing) +
+		(Size) (pos % conn->shmNumSlots) * conn->shmSlotSize;
+}
+
+/*
+ * shmRingHasPacket
+ * 		Has the sender put a packet into the ring that we haven't read yet?
+ */
+static inline bool
+shmRingHasPacket(MotionConn *conn)
+{
+	return (pg_atomic_read_u32(&conn->shmRing->head) !=
+			pg_atomic_read_u32(&conn->shmRing->tail));
+}
+
+/*
+ * wakeShmPeer
+ * 		Wake up the peer of a shared-memory connection if it is waiting for
+ * 		us, after we moved the ring.
+ *
+ * The barrier pairs with the one in prepareShmWait() and sendShmPacket():
+ * either the peer sees what we did when it looks again after setting its
+ * flag, or we see the flag here.
+ */
+static void
+wakeShmPeer(MotionConn *conn, pg_atomic_uint32 *waiting)
+{
+	icpkthdr	msg;
+
+	pg_memory_barrier();
+	if (pg_atomic_read_u32(waiting) == 0 || pg_atomic_exchange_u32(waiting, 0) == 0)
+		return;
+
+	memcpy(&msg, &conn->conn_info, sizeof(msg));
+	msg.flags = UDPIC_FLAGS_SHM_WAKEUP;
+	msg.seq = 0;
+	msg.extraSeq = 0;
+	msg.len = sizeof(icpkthdr);
+
+	sendControlMessage(&msg, UDP_listenerFd, (struct sockaddr *) &conn->peer, conn->peer_len);
+	ic_statistics.shmWakeupNum++;
+}
+
+/*
+ * releaseShmPacket
+ * 		Give the slot of the packet that the receiver is done with back to
+ * 		the sender; the shared-memory counterpart of putRxBufferAndSendAck().
+ */
+static void
+releaseShmPacket(MotionConn *conn)
+{
+	ICShmRing  *ring = conn->shmRing;
+
+	conn->pBuff = NULL;
+
+	/* we must be done reading the slot before the sender may reuse it */
+	pg_memory_barrier();
+	pg_atomic_write_u32(&ring->tail, pg_atomic_read_u32(&ring->tail) + 1);
+
+	wakeShmPeer(conn, &ring->txWaiting);
+}
+
+/*
+ * pollShmConns
+ * 		Find a shared-memory connection with a packet to read, and prepare
+ * 		it for reading.
+ *
+ * Only conn is looked at if it is given, else all active connections of the
+ * motion node.  Returns NULL if there is no packet.
+ */
+static MotionConn *
+pollShmConns(ChunkTransportStateEntry *pEntry, MotionConn *conn)
+{
+	int			i;
+	int			index;
+
+	if (conn != NULL)
+	{
+		if (conn->shmRing == NULL || !shmRingHasPacket(conn))
+			return NULL;
+
+		prepareRxConnForRead(conn);
+		return conn;
+	}
+
+	index = pEntry->scanStart;
+	for (i = 0; i < pEntry->numConns; i++, index++)
+	{
+		MotionConn *rxconn;
+
+		if (index >= pEntry->numConns)
+			index = 0;
+
+		rxconn = pEntry->conns + index;
+		if (rxconn->shmRing != NULL && rxconn->stillActive && shmRingHasPacket(rxconn))
+		{
+			prepareRxConnForRead(rxconn);
+			return rxconn;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * prepareShmWait
+ * 		Tell the senders of the shared-memory connections we are about to
+ * 		wait on that we need a wakeup.
+ *
+ * Only conn is looked at if it is given, else all active connections of the
+ * motion node.  Returns false if a packet arrived meanwhile, so that we
+ * must not wait.
+ *
+ * MUST BE CALLED WITH ic_control_info.lock LOCKED, and kept locked until
+ * the wait, so that the rx thread can't signal the wakeup too early.
+ */
+static bool
+prepareShmWait(ChunkTransportStateEntry *pEntry, MotionConn *conn)
+{
+	int			i;
+
+	for (i = 0; i < pEntry->numConns; i++)
+	{
+		MotionConn *rxconn = pEntry->conns + i;
+
+		if (rxconn->shmRing == NULL || !rxconn->stillActive ||
+			(conn != NULL && rxconn != conn))
+			continue;
+
+		pg_atomic_write_u32(&rxconn->shmRing->rxWaiting, 1);
+	}
+
+	pg_memory_barrier();
+
+	for (i = 0; i < pEntry->numConns; i++)
+	{
+		MotionConn *rxconn = pEntry->conns + i;
+
+		if (rxconn->shmRing == NULL || !rxconn->stillActive ||
+			(conn != NULL && rxconn != conn))
+			continue;
+
+		if (shmRingHasPacket(rxconn))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * sendShmPacket
+ * 		Copy the packet in the connection's buffer into its shared-memory
+ * 		ring, waiting for a free slot if the ring is full.
+ *
+ * Returns false, without sending, if the receiver asked us to stop.
+ */
+static bool
+sendShmPacket(ChunkTransportState *transportStates, MotionConn *conn)
+{
+	ICShmRing  *ring = conn->shmRing;
+	icpkthdr   *pkt = (icpkthdr *) conn->pBuff;
+	uint32		head = pg_atomic_read_u32(&ring->head);
+	int			retry = 0;
+
+	Assert(pkt->len <= conn->shmSlotSize);
+
+	for (;;)
+	{
+		bool		woken = true;
+
+		if (pg_atomic_read_u32(&ring->flags) & SHM_RING_STOP)
+			return false;
+
+		if (head - pg_atomic_read_u32(&ring->tail) < conn->shmNumSlots)
+			break;
+
+		/*
+		 * The ring is full.  Sleep until the receiver frees a slot, see
+		 * wakeShmPeer().
+		 */
+		pthread_mutex_lock(&ic_control_info.lock);
+
+		pg_atomic_write_u32(&ring->txWaiting, 1);
+		pg_memory_barrier();
+
+		if ((pg_atomic_read_u32(&ring->flags) & SHM_RING_STOP) == 0 &&
+			head - pg_atomic_read_u32(&ring->tail) >= conn->shmNumSlots)
+			woken = waitOnCondition(MAIN_THREAD_COND_TIMEOUT,
+									&ic_control_info.cond, &ic_control_info.lock);
+
+		pthread_mutex_unlock(&ic_control_info.lock);
+
+		if (!woken)
+			checkShmWait(transportStates, ++retry);
+	}
+
+	/* the receiver must be done with the slot before we overwrite it */
+	pg_memory_barrier();
+	memcpy(shmRingSlot(conn, head), pkt, pkt->len);
+
+	/* ... and must see the whole packet once it sees the new head */
+	pg_write_barrier();
+	pg_atomic_write_u32(&ring->head, head + 1);
+
+	conn->sentSeq = pkt->seq;
+	ic_statistics.shmSndPktNum++;
+
+	wakeShmPeer(conn, &ring->rxWaiting);
+
+	return true;
+}
+
+/*
+ * finishShmConn
+ * 		Done sending on a shared-memory connection, after the EOS or a stop.
+ */
+static void
+finishShmConn(MotionConn *conn)
+{
+	/* the buffer goes back to the pool, like the ones sent through UDP */
+	if (conn->curBuff != NULL)
+	{
+		icBufferListAppend(&conn->sndQueue, conn->curBuff);
+		icBufferListReturn(&conn->sndQueue, false);
+	}
+
+	conn->tupleCount = 0;
+	conn->msgSize = sizeof(conn->conn_info);
+
+	conn->state = mcsEosSent;
+	conn->curBuff = NULL;
+	conn->pBuff = NULL;
+	conn->stillActive = false;
+	conn->stopRequested = false;
+}
+
+/*
+ * checkShmWait
+ * 		Check for the errors and interrupts that checkExceptions() checks
+ * 		for, after a sender waiting for room in a shared-memory ring timed
+ * 		out.
+ */
+static void
+checkShmWait(ChunkTransportState *transportStates, int retry)
+{
+	checkRxThreadError();
+	ML_CHECK_FOR_INTERRUPTS(transportStates->teardownActive);
+
+	if ((retry & 0x3f) == 0)
+	{
+		checkQDConnectionAlive();
+
+		if (!PostmasterIsAlive(true))
+			ereport(ERROR, (errcode(ERRCODE_CDB_INTERNAL_ERROR),
+						errmsg("Interconnect failed to send chunks"),
+						errdetail("Postmaster is not alive\n")));
+	}
+}
+
+/*
+ * startOutgoingUDPConnections
+ * 		Used to initially kick-off any outgoing connections for mySlice.
+ *
+ * This should not be called for root slices (i.e. QD ones) since they don't
+ * ever have outgoing connections.
+ *
+ * PARAMETERS
+ *
+ *	 sendSlice	- Slice that this process is a member of.
+ *
+ * RETURNS
+ *	 Initialized ChunkTransportState for the Sending Motion Node Id.
+ */
+static ChunkTransportStateEntry *
+startOutgoingUDPConnections(ChunkTransportState *transportStates,
+							Slice		*sendSlice,
+							int			*pOutgoingCount)
+{
+	ChunkTransportStateEntry *pEntry;
+	MotionConn *conn;
+	ListCell   *cell;
+	Slice	   *recvSlice;
+	CdbProcess *cdbProc;
+	int					i;
+
+	*pOutgoingCount = 0;
+
+	recvSlice = (Slice *) list_nth(transportStates->sliceTable->slices, sendSlice->parentIndex);
+
+	/*
+	 * Potentially introduce a Bug (MPP-17186).
+	 * The workaround is to turn off log_hostname guc.
+	 */
+	adjustMasterRouting(recvSlice);
+
+	if (gp_log_interconnect >= GPVARS_VERBOSITY_DEBUG)
+		elog(DEBUG1, "Interconnect seg%d slice%d setting up sending motion node",
+			 Gp_segment, sendSlice->sliceIndex);
+
+	pEntry = createChunkTransportState(transportStates,
+									   sendSlice,
+									   recvSlice,
+									   list_length(recvSlice->primaryProcesses));
+
+	Assert(pEntry && pEntry->valid);
+	/*
+	 * Setup a MotionConn entry for each of our outbound connections.
+	 * Request a connection to each receiving backend's listening port.
+	 * NB: Some mirrors could be down & have no CdbProcess entry.
+	 */
+	conn = pEntry->conns;
+
+	i = 0;
+	foreach(cell, recvSlice->primaryProcesses)
+	{
+		cdbProc = (CdbProcess *)lfirst(cell);
+		if (cdbProc)
+		{
+			conn->cdbProc = cdbProc;
+			icBufferListInit(&conn->sndQueue, ICBufferListType_Primary);
+			icBufferListInit(&conn->unackQueue, ICBufferListType_Primary);
+			conn->capacity = Gp_interconnect_queue_depth;
+
+			/* send buffer pool must be initialized before this. */
+			snd_buffer_pool.maxCount += Gp_interconnect_snd_queue_depth;
+			snd_control_info.cwnd += 1;
+			conn->curBuff = getSndBuffer(conn);
+
+			/* should have at least one buffer for each connection */
+			Assert(conn->curBuff != NULL);
+
+			conn->rtt = DEFAULT_RTT;
+			conn->dev = DEFAULT_DEV;
+			conn->cwnd = DELAY_FC_INIT_CWND;
+			conn->ssthresh = DELAY_FC_MAX_CWND;
+			conn->minRtt = MAX_RTT;
+			conn->nextSendTime = 0;
+			conn->deadlockCheckBeginTime = 0;
+			conn->tupleCount = 0;
+			conn->msgSize = sizeof(conn->conn_info);
+			conn->sentSeq = 0;
+			conn->receivedAckSeq = 0;
+			conn->consumedSeq = 0;
+			conn->pBuff = (uint8 *)conn->curBuff->pkt;
+			conn->state = mcsSetupOutgoingConnection;
+			conn->route = i++;
+
+			(*pOutgoingCount)++;
+		}
+
+		conn++;
+	}
+
+	pEntry->txfd = ICSenderSocket;
+	pEntry->txport = ICSenderPort;
+	pEntry->txfd_family = ICSenderFamily;
+
+	return pEntry;
+
+}
+
+
+/*
+ * getSockAddr
+ * 		Convert IP addr and port to sockaddr
+ */
+static void
+getSockAddr(struct sockaddr_storage *peer, socklen_t *peer_len, const char *listenerAddr, int listenerPort)
+{
+	int			ret;
+	char		portNumberStr[32];
+	char	   *service;
+	struct addrinfo *addrs = NULL;
+	struct addrinfo hint;
+
+	/*
+	 * Get socketaddr to connect to.
+	 */
+
+	/* Initialize hint structure */
+	MemSet(&hint, 0, sizeof(hint));
+	hint.ai_socktype = SOCK_DGRAM; /* UDP */
+	hint.ai_family = AF_UNSPEC; /* Allow for any family (v4, v6, even unix in the future)  */
+#ifdef AI_NUMERICSERV
+	hint.ai_flags = AI_NUMERICHOST | AI_NUMERICSERV;  /* Never do name resolution */
+#else
+	hint.ai_flags = AI_NUMERICHOST;  /* Never do name resolution */
+#endif
+
+	snprintf(portNumberStr, sizeof(portNumberStr), "%d", listenerPort);
+	service = portNumberStr;
+
+	ret = pg_getaddrinfo_all(listenerAddr, service, &hint, &addrs);
+	if (ret || !addrs)
+	{
+		if (addrs)
+			pg_freeaddrinfo_all(hint.ai_family, addrs);
+
+		ereport(ERROR, (errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+			errmsg("Interconnect Error: Could not parse remote listener"
+				   "address: '%s' port '%d': %s", listenerAddr,listenerPort,gai_strerror(ret)),
+			errdetail("getaddrinfo() unable to parse address: '%s'",
+					  listenerAddr)));
+		return;
+	}
+	/* Since we aren't using name resolution, getaddrinfo will return only 1 entry */
+
+	elog(DEBUG1,"GetSockAddr socket ai_family %d ai_socktype %d ai_protocol %d for %s ",addrs->ai_family, addrs->ai_socktype, addrs->ai_protocol, listenerAddr);
+	memset(peer, 0, sizeof(struct sockaddr_storage));
+	memcpy(peer, addrs->ai_addr, addrs->ai_addrlen);
+	*peer_len = addrs->ai_addrlen;
+
+	pg_freeaddrinfo_all(addrs->ai_family, addrs);
+}
+
+/*
+ * setupOutgoingUDPConnection
+ *		Setup outgoing UDP connection.
+ */
+void
+setupOutgoingUDPConnection(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn)
+{
+	CdbProcess		   *cdbProc = conn->cdbProc;
+
+	Assert(conn->state == mcsSetupOutgoingConnection);
+	Assert(conn->cdbProc);
+
+	conn->wakeup_ms = 0;
+	conn->remoteContentId = cdbProc->contentid;
+	conn->stat_min_ack_time = ~((uint64)0);
+
+	/* Save the information for the error message if getaddrinfo fails */
+	if (strchr(cdbProc->listenerAddr,':') != 0)
+		snprintf(conn->remoteHostAndPort, sizeof(conn->remoteHostAndPort),
+					 "[%s]:%d", cdbProc->listenerAddr, cdbProc->listenerPort);
+	else
+		snprintf(conn->remoteHostAndPort, sizeof(conn->remoteHostAndPort),
+			 "%s:%d", cdbProc->listenerAddr, cdbProc->listenerPort);
+
+	/*
+	 * Get socketaddr to connect to.
+	 */
+	getSockAddr(&conn->peer, &conn->peer_len, cdbProc->listenerAddr, cdbProc->listenerPort);
+
+	/* Save the destination IP address */
+	formatSockAddr((struct sockaddr *)&conn->peer, conn->remoteHostAndPort,
+					sizeof(conn->remoteHostAndPort));
+
+	Assert(conn->peer.ss_family == AF_INET || conn->peer.ss_family == AF_INET6 );
 
 	{
 #ifdef USE_ASSERT_CHECKING
@@ -3102,6 +3892,12 @@ SetupUDPIFCInterconnect_Internal(EState *estate)
 				conn->conn_info.flags = UDPIC_FLAGS_RECEIVER_TO_SENDER;
 
 				connAddHash(&ic_control_info.connHtab, conn);
+
+				if (useShmRing(mySlice, conn->cdbProc))
+				{
+					createShmRing(conn);
+					pEntry->numShmConns++;
+				}
 			}
 		}
 
@@ -3136,6 +3932,16 @@ SetupUDPIFCInterconnect_Internal(EState *estate)
 			{
 				setupOutgoingUDPConnection(estate->interconnect_context, sendingChunkTransportState, conn);
 				outgoing_count++;
+
+				/*
+				 * There is no connection handshake through shared memory;
+				 * the ring is mapped below, once the lock is released.
+				 */
+				if (useShmRing(mySlice, conn->cdbProc))
+				{
+					conn->state = mcsStarted;
+					sendingChunkTransportState->numShmConns++;
+				}
 			}
 		}
 		snd_control_info.minCwnd = snd_control_info.cwnd;
@@ -3166,6 +3972,18 @@ SetupUDPIFCInterconnect_Internal(EState *estate)
 	estate->interconnect_context->activated = true;
 
 	pthread_mutex_unlock(&ic_control_info.lock);
+
+	/* Map the rings of the outgoing shared-memory connections. */
+	if (sendingChunkTransportState != NULL && sendingChunkTransportState->numShmConns > 0)
+	{
+		for (i = 0; i < sendingChunkTransportState->numConns; i++)
+		{
+			conn = &sendingChunkTransportState->conns[i];
+
+			if (conn->cdbProc && useShmRing(mySlice, conn->cdbProc))
+				attachShmRing(conn);
+		}
+	}
 }
 
 /*
@@ -3386,9 +4204,18 @@ TeardownUDPIFCInterconnect_Internal(ChunkTransportState *transportStates,
 					computeNetworkStatistics(conn->rtt, &minRtt, &maxRtt, &avgRtt);
 					computeNetworkStatistics(conn->dev, &minDev, &maxDev, &avgDev);
 
+					elog((gp_interconnect_log_stats ? LOG : DEBUG1), "Interconnect connection to seg%d (route %d): "
+						 "rtt/dev/min_rtt " UINT64_FORMAT "/" UINT64_FORMAT "/" UINT64_FORMAT
+						 " cwnd %f ssthresh %f retransmits " UINT64_FORMAT " acks " UINT64_FORMAT,
+						 conn->remoteContentId, conn->route,
+						 conn->rtt, conn->dev, conn->minRtt,
+						 conn->cwnd, conn->ssthresh, conn->stat_count_resent, conn->stat_count_acks);
+
 					icBufferListReturn(&conn->sndQueue, false);
 					icBufferListReturn(&conn->unackQueue, Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_CAPACITY ? false : true);
 
+					detachShmRing(conn, true);
+
 					connDelHash(&ic_control_info.connHtab, conn);
 				}
 				avgRtt = avgRtt / pEntry->numConns;
@@ -3459,6 +4286,8 @@ TeardownUDPIFCInterconnect_Internal(ChunkTransportState *transportStates,
 
 					connDelHash(&ic_control_info.connHtab, conn);
 
+					detachShmRing(conn, false);
+
 					/* putRxBufferAndSendAck() dequeues messages and moves them to pBuff */
 					while (conn->pkt_q_size > 0)
 					{
@@ -3523,7 +4352,10 @@ TeardownUDPIFCInterconnect_Internal(ChunkTransportState *transportStates,
 			" freebuf_avg %f "
 			"mismatch_pkt_num %d disordered_pkt_num %d duplicated_pkt_num %d"
 			" rtt/dev [" UINT64_FORMAT "/" UINT64_FORMAT ", %f/%f, " UINT64_FORMAT "/" UINT64_FORMAT "] "
-			" cwnd %f status_query_msg_num %d",
+			" cwnd %f status_query_msg_num %d"
+			" snd_batch_num %d snd_batch_avg %f recv_batch_num %d recv_batch_avg %f"
+			" ack_batch_num %d ack_batch_avg %f"
+			" shm_snd_pkt_count %d shm_recv_pkt_count %d shm_wakeup_count %d",
 			ic_control_info.isSender, isReceiver,
 			Gp_interconnect_snd_queue_depth, Gp_interconnect_queue_depth, Gp_max_packet_size,
 			UNACK_QUEUE_RING_SLOTS_NUM, TIMER_SPAN, DEFAULT_RTT,
@@ -3536,7 +4368,14 @@ TeardownUDPIFCInterconnect_Internal(ChunkTransportState *transportStates,
 			(double)((double)ic_statistics.totalBuffers)/((double)ic_statistics.bufferCountingTime),
 			ic_statistics.mismatchNum, ic_statistics.disorderedPktNum, ic_statistics.duplicatedPktNum,
 			(minRtt == ~((uint64)0) ? 0 : minRtt), (minDev == ~((uint64)0) ? 0 : minDev), avgRtt, avgDev, maxRtt, maxDev,
-			snd_control_info.cwnd, ic_statistics.statusQueryMsgNum);
+			snd_control_info.cwnd, ic_statistics.statusQueryMsgNum,
+			ic_statistics.sndBatchCallNum,
+			(ic_statistics.sndBatchCallNum == 0 ? 0.0 : (double)ic_statistics.sndBatchPktNum/(double)ic_statistics.sndBatchCallNum),
+			ic_statistics.recvBatchCallNum,
+			(ic_statistics.recvBatchCallNum == 0 ? 0.0 : (double)ic_statistics.recvBatchPktNum/(double)ic_statistics.recvBatchCallNum),
+			ic_statistics.ackBatchCallNum,
+			(ic_statistics.ackBatchCallNum == 0 ? 0.0 : (double)ic_statistics.ackBatchPktNum/(double)ic_statistics.ackBatchCallNum),
+			ic_statistics.shmSndPktNum, ic_statistics.shmRecvPktNum, ic_statistics.shmWakeupNum);
 
 	ic_control_info.isSender = false;
 	memset(&ic_statistics, 0, sizeof(ICStatistics));
@@ -3600,6 +4439,25 @@ TeardownUDPIFCInterconnect(ChunkTransportState *transportStates,
 static void
 prepareRxConnForRead(MotionConn *conn)
 {
+	if (conn->shmRing != NULL)
+	{
+		/* the packet is read in place, in its slot of the ring */
+		pg_read_barrier();
+		conn->pBuff = shmRingSlot(conn, pg_atomic_read_u32(&conn->shmRing->tail));
+
+		if (((icpkthdr *) conn->pBuff)->len < sizeof(icpkthdr) ||
+			((icpkthdr *) conn->pBuff)->len > conn->shmSlotSize)
+			ereport(ERROR, (errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+							errmsg("Interconnect error: invalid packet length %d in shared memory ring",
+								   ((icpkthdr *) conn->pBuff)->len)));
+
+		conn->msgPos = conn->pBuff;
+		conn->msgSize = ((icpkthdr *) conn->pBuff)->len;
+		conn->recvBytes = conn->msgSize;
+		ic_statistics.shmRecvPktNum++;
+		return;
+	}
+
 	elog(DEBUG3, "In prepareRxConnForRead: conn %p, q_head %d q_tail %d q_size %d", conn, conn->pkt_q_head, conn->pkt_q_tail, conn->pkt_q_size);
 
 	Assert(conn->pkt_q[conn->pkt_q_head] != NULL);
@@ -3658,6 +4516,13 @@ receiveChunksUDPIFC(ChunkTransportState *pTransportStates, ChunkTransportStateEn
 			elog(DEBUG2, "receiveChunksUDPIFC: non-directed rx woke on route %d", rx_control_info.mainWaitingState.reachRoute);
 			resetMainThreadWaiting(&rx_control_info.mainWaitingState);
 		}
+		else if (pEntry->numShmConns > 0)
+		{
+			/* nobody wakes us up for these, we have to look */
+			rxconn = pollShmConns(pEntry, conn);
+			if (rxconn != NULL)
+				resetMainThreadWaiting(&rx_control_info.mainWaitingState);
+		}
 
 		aggregateStatistics(pEntry);
 
@@ -3679,7 +4544,13 @@ receiveChunksUDPIFC(ChunkTransportState *pTransportStates, ChunkTransportStateEn
 
 		retries++;
 
-		/* 2. Wait for data to become ready */
+		/*
+		 * 2. Wait for data to become ready.  The senders through shared
+		 * memory wake us up through the rx thread, see wakeShmPeer().
+		 */
+		if (pEntry->numShmConns > 0 && !prepareShmWait(pEntry, conn))
+			continue; /* a packet arrived meanwhile */
+
 		if (waitOnCondition(MAIN_THREAD_COND_TIMEOUT, &ic_control_info.cond, &ic_control_info.lock))
 		{
 			continue; /* success ! */
@@ -3767,7 +4638,8 @@ RecvTupleChunkFromAnyUDPIFC_Internal(MotionLayerState *mlStates,
 		ic_statistics.totalRecvQueueSize += conn->pkt_q_size;
 		ic_statistics.recvQueueSizeCountingTime++;
 
-		if (conn->pkt_q_size > 0)
+		if (conn->pkt_q_size > 0 ||
+			(conn->shmRing != NULL && conn->stillActive && shmRingHasPacket(conn)))
 		{
 			found = true;
 			prepareRxConnForRead(conn);
@@ -3889,7 +4761,8 @@ RecvTupleChunkFromUDPIFC_Internal(ChunkTransportState *transportStates,
 	ic_statistics.totalRecvQueueSize += conn->pkt_q_size;
 	ic_statistics.recvQueueSizeCountingTime++;
 
-	if (conn->pkt_q[conn->pkt_q_head] != NULL)
+	if (conn->pkt_q[conn->pkt_q_head] != NULL ||
+		(conn->shmRing != NULL && shmRingHasPacket(conn)))
 	{
 		prepareRxConnForRead(conn);
 
@@ -4048,7 +4921,7 @@ handleAckedPacket(MotionConn *ackConn, ICBuffer *buf, uint64 now)
 
 	buf = icBufferListDelete(&ackConn->unackQueue, buf);
 
-	if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+	if (Gp_interconnect_fc_method != INTERCONNECT_FC_METHOD_CAPACITY)
 	{
 		buf = icBufferListDelete(&unack_queue_ring.slots[buf->unackQueueRingSlot], buf);
 		unack_queue_ring.numOutStanding--;
@@ -4079,11 +4952,16 @@ handleAckedPacket(MotionConn *ackConn, ICBuffer *buf, uint64 now)
 	        	buf->conn->dev = newDEV;
 
 				/* adjust the congestion control window. */
-	        	if (snd_control_info.cwnd < snd_control_info.ssthresh)
-	        		snd_control_info.cwnd += 1;
-	        	else
-	        		snd_control_info.cwnd += 1/snd_control_info.cwnd;
-	        	snd_control_info.cwnd = Min(snd_control_info.cwnd, snd_buffer_pool.maxCount);
+				if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_DELAY)
+					updateDelayWindow(buf->conn, ackTime);
+				else
+				{
+					if (snd_control_info.cwnd < snd_control_info.ssthresh)
+						snd_control_info.cwnd += 1;
+					else
+						snd_control_info.cwnd += 1/snd_control_info.cwnd;
+					snd_control_info.cwnd = Min(snd_control_info.cwnd, snd_buffer_pool.maxCount);
+				}
 	        }
 		}
 	}
@@ -4114,6 +4992,45 @@ handleAckedPacket(MotionConn *ackConn, ICBuffer *buf, uint64 now)
 #endif
 }
 
+/*
+ * updateDelayWindow
+ * 		Adjust the send window of a connection for delay-based flow control.
+ *
+ * This follows TCP Vegas. The smallest ack time seen on the connection is
+ * taken as the base RTT, and the part of SRTT above it is the time our
+ * packets spent waiting in switch and socket queues. The number of packets
+ * we have sitting in those queues is estimated by:
+ *	    DIFF = cwnd x (SRTT - BASE_RTT) / SRTT
+ * The window grows while DIFF is below DELAY_FC_ALPHA, and shrinks while it
+ * is above DELAY_FC_BETA. So it stops growing when the queues start to build
+ * up rather than when they overflow and drop packets.
+ */
+static void
+updateDelayWindow(MotionConn *conn, uint64 ackTime)
+{
+	float diff;
+
+	conn->minRtt = Min(conn->minRtt, Max(ackTime, MIN_RTT));
+	diff = conn->cwnd * (float) (conn->rtt - Min(conn->rtt, conn->minRtt)) / (float) conn->rtt;
+
+	if (diff < DELAY_FC_ALPHA)
+	{
+		if (conn->cwnd < conn->ssthresh)
+			conn->cwnd += 1;
+		else
+			conn->cwnd += 1/conn->cwnd;
+	}
+	else
+	{
+		/* queues are building up, leave slow start */
+		if (diff > DELAY_FC_BETA)
+			conn->cwnd -= 1/conn->cwnd;
+		conn->ssthresh = Min(conn->ssthresh, conn->cwnd);
+	}
+
+	conn->cwnd = Min(Max(conn->cwnd, DELAY_FC_MIN_CWND), DELAY_FC_MAX_CWND);
+}
+
 /*
  * handleAck
  * 		handle acks incoming from our upstream peers.
@@ -4392,7 +5309,7 @@ prepareXmit(MotionConn *conn)
 	/* increase the sequence no */
 	conn->conn_info.seq++;
 
-	if (gp_interconnect_full_crc)
+	if (gp_interconnect_full_crc && conn->shmRing == NULL)
 	{
 		icpkthdr *pkt = (icpkthdr *)conn->pBuff;
 		addCRC(pkt);
@@ -4468,6 +5385,88 @@ xmit_retry:
 	return;
 }
 
+#ifdef UDPIFC_BATCH_IO
+/*
+ * sendBatch
+ * 		Send packets of a connection with sendmmsg().
+ *
+ * The errors are handled as in sendOnce: a full socket buffer or a packet
+ * dropped by the firewall is left to the retransmit logic, anything else
+ * is an error.
+ */
+static void
+sendBatch(ChunkTransportStateEntry *pEntry, ICBuffer **bufs, int nbufs, MotionConn *conn)
+{
+	struct mmsghdr msgs[UDP_IO_BATCH_SIZE];
+	struct iovec iovs[UDP_IO_BATCH_SIZE];
+	int			sent = 0;
+	int			i;
+
+	Assert(nbufs <= UDP_IO_BATCH_SIZE);
+
+	for (i = 0; i < nbufs; i++)
+	{
+		iovs[i].iov_base = bufs[i]->pkt;
+		iovs[i].iov_len = bufs[i]->pkt->len;
+
+		memset(&msgs[i], 0, sizeof(struct mmsghdr));
+		msgs[i].msg_hdr.msg_name = &conn->peer;
+		msgs[i].msg_hdr.msg_namelen = conn->peer_len;
+		msgs[i].msg_hdr.msg_iov = &iovs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	while (sent < nbufs)
+	{
+		int			n;
+
+		n = sendmmsg(pEntry->txfd, msgs + sent, nbufs - sent, 0);
+		if (n < 0)
+		{
+			if (errno == EINTR)
+				continue;
+
+			if (errno == EAGAIN) /* no space ? not an error. */
+				return;
+
+			/* See sendOnce; skip the dropped packet and go on with the rest. */
+			if (errno == EPERM)
+			{
+				ereport(LOG,
+						(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+						 errmsg("Interconnect error writing an outgoing packet: %m"),
+						 errdetail("error during sendmmsg() for Remote Connection: contentId=%d at %s",
+								   conn->remoteContentId, conn->remoteHostAndPort)));
+				sent++;
+				continue;
+			}
+
+			ereport(ERROR, (errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+							errmsg("Interconnect error writing an outgoing packet: %m"),
+							errdetail("error during sendmmsg() call (error:%d).\n"
+									  "For Remote Connection: contentId=%d at %s",
+									  errno, conn->remoteContentId,
+									  conn->remoteHostAndPort)));
+			/* not reached */
+		}
+
+		ic_statistics.sndBatchCallNum++;
+		ic_statistics.sndBatchPktNum += n;
+
+		for (i = sent; i < sent + n; i++)
+		{
+			if (msgs[i].msg_len != bufs[i]->pkt->len && DEBUG1 >= log_min_messages)
+				write_log("Interconnect error writing an outgoing packet [seq %d]: short transmit (given %d sent %d) during sendmmsg() call."
+						  "For Remote Connection: contentId=%d at %s", bufs[i]->pkt->seq, bufs[i]->pkt->len, msgs[i].msg_len,
+						  conn->remoteContentId,
+						  conn->remoteHostAndPort);
+		}
+
+		sent += n;
+	}
+}
+#endif
+
 
 /*
  * handleStopMsgs
@@ -4577,21 +5576,36 @@ handleStopMsgs(ChunkTransportState *transportStates, ChunkTransportStateEntry *p
 static void
 sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn)
 {
+#ifdef UDPIFC_BATCH_IO
+	ICBuffer   *batch[UDP_IO_BATCH_SIZE];
+	int			nbatch = 0;
+	bool		batchIO = useBatchIO();
+#endif
+
 	while (conn->capacity > 0 && icBufferListLength(&conn->sndQueue) > 0)
 	{
 		ICBuffer *buf = NULL;
 
+		uint64 now = getCurrentTime();
+
 		if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS && (icBufferListLength(&conn->unackQueue) > 0
 				&& unack_queue_ring.numSharedOutStanding >= (snd_control_info.cwnd - snd_control_info.minCwnd)))
 			break;
 
+		/*
+		 * Delay-based flow control limits each connection to its own window,
+		 * and spreads the window over one RTT instead of sending it in a burst.
+		 */
+		if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_DELAY && (icBufferListLength(&conn->unackQueue) > 0
+				&& (icBufferListLength(&conn->unackQueue) >= conn->cwnd || now < conn->nextSendTime)))
+			break;
+
 		/* for connection setup, we only allow one outstanding packet. */
 		if (conn->state == mcsSetupOutgoingConnection && icBufferListLength(&conn->unackQueue) >= 1)
 			break;
 
 		buf = icBufferListPop(&conn->sndQueue);
 
-		uint64 now = getCurrentTime();
 		buf->sentTime = now;
 		buf->unackQueueRingSlot = -1;
 		buf->nRetry = 0;
@@ -4599,8 +5613,9 @@ sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEnt
 		conn->capacity--;
 
 		icBufferListAppend(&conn->unackQueue, buf);
+		conn->nextSendTime = now + (uint64) (conn->rtt / conn->cwnd);
 
-		if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+		if (Gp_interconnect_fc_method != INTERCONNECT_FC_METHOD_CAPACITY)
 		{
 			unack_queue_ring.numOutStanding++;
 			if (icBufferListLength(&conn->unackQueue) > 1)
@@ -4622,7 +5637,20 @@ sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEnt
 		updateStats(TPE_DATA_PKT_SEND, conn, buf->pkt);
 #endif
 
-		sendOnce(transportStates, pEntry, buf, conn);
+#ifdef UDPIFC_BATCH_IO
+		if (batchIO)
+		{
+			/* The packets leave in one sendmmsg() when the batch is full or the loop ends. */
+			batch[nbatch++] = buf;
+			if (nbatch == UDP_IO_BATCH_SIZE)
+			{
+				sendBatch(pEntry, batch, nbatch, conn);
+				nbatch = 0;
+			}
+		}
+		else
+#endif
+			sendOnce(transportStates, pEntry, buf, conn);
 		ic_statistics.sndPktNum++;
 
 #ifdef AMS_VERBOSE_LOGGING
@@ -4631,6 +5659,11 @@ sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEnt
 
 		buf->conn->sentSeq = buf->pkt->seq;
 	}
+
+#ifdef UDPIFC_BATCH_IO
+	if (nbatch > 0)
+		sendBatch(pEntry, batch, nbatch, conn);
+#endif
 }
 
 /*
@@ -4768,7 +5801,7 @@ handleAckForDisorderPkt(ChunkTransportState *transportStates, ChunkTransportStat
 			/* this is a lost packet, retransmit */
 
 			buf->nRetry++;
-			if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+			if (Gp_interconnect_fc_method != INTERCONNECT_FC_METHOD_CAPACITY)
 			{
 				buf = icBufferListDelete(&unack_queue_ring.slots[buf->unackQueueRingSlot], buf);
 				putIntoUnackQueueRing(&unack_queue_ring, buf,
@@ -4786,6 +5819,7 @@ handleAckForDisorderPkt(ChunkTransportState *transportStates, ChunkTransportStat
 #endif
 
 			ic_statistics.retransmits++;
+			conn->stat_count_resent++;
 			curLostPktSeq++;
 			lostPktCnt--;
 
@@ -4818,6 +5852,11 @@ handleAckForDisorderPkt(ChunkTransportState *transportStates, ChunkTransportStat
 		snd_control_info.ssthresh = Max(snd_control_info.cwnd/2, snd_control_info.minCwnd);
 		snd_control_info.cwnd = snd_control_info.ssthresh;
 	}
+	else if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_DELAY)
+	{
+		conn->ssthresh = Max(conn->cwnd/2, DELAY_FC_MIN_CWND);
+		conn->cwnd = conn->ssthresh;
+	}
 #ifdef AMS_VERBOSE_LOGGING
 	write_log("After DISORDER: sndQ %d unackQ %d", icBufferListLength(&conn->sndQueue), icBufferListLength(&conn->unackQueue));
 	if (gp_log_interconnect >= GPVARS_VERBOSITY_DEBUG)
@@ -4948,6 +5987,14 @@ checkExpiration(ChunkTransportState *transportStates, ChunkTransportStateEntry *
 			curBuf->conn->stat_count_resent++;
 			curBuf->conn->stat_max_resent = Max(curBuf->conn->stat_max_resent, curBuf->conn->stat_count_resent);
 
+			/* a timeout closes the window of this connection only */
+			if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_DELAY &&
+				curBuf->conn->cwnd > DELAY_FC_MIN_CWND)
+			{
+				curBuf->conn->ssthresh = Max(curBuf->conn->cwnd/2, DELAY_FC_MIN_CWND);
+				curBuf->conn->cwnd = DELAY_FC_MIN_CWND;
+			}
+
 			checkNetworkTimeout(curBuf, now);
 
 		#ifdef AMS_VERBOSE_LOGGING
@@ -5125,7 +6172,7 @@ checkExceptions(ChunkTransportState *transportStates, ChunkTransportStateEntry *
 		checkExpirationCapacityFC(transportStates, pEntry, conn, timeout);
 	}
 
-	if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+	if (Gp_interconnect_fc_method != INTERCONNECT_FC_METHOD_CAPACITY)
 	{
 		uint64 now = getCurrentTime();
 		if(now - ic_control_info.lastExpirationCheckTime > TIMER_CHECKING_PERIOD)
@@ -5176,7 +6223,7 @@ computeTimeout(MotionConn *conn, int retry)
     if (buf->nRetry == 0 && retry == 0)
     	return 0;
 
-    if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+    if (Gp_interconnect_fc_method != INTERCONNECT_FC_METHOD_CAPACITY)
         return TIMER_CHECKING_PERIOD;
 
     /* for capacity based flow control */
@@ -5224,6 +6271,32 @@ SendChunkUDPIFC(MotionLayerState *mlStates,
 
 	/* prepare this for transmit */
 
+	if (conn->shmRing != NULL)
+	{
+		prepareXmit(conn);
+
+		if (!sendShmPacket(transportStates, conn))
+		{
+			/* the receiver needs no more data, see handleStopMsgs() */
+			if (gp_log_interconnect >= GPVARS_VERBOSITY_DEBUG)
+				elog(DEBUG1, "SendChunkUDPIFC: node %d route %d stopped by receiver", motionId, conn->route);
+
+			finishShmConn(conn);
+			return true;
+		}
+
+		/* the buffer has been copied out, reuse it */
+		conn->tupleCount = 0;
+		conn->msgSize = sizeof(conn->conn_info);
+
+		memcpy(conn->pBuff + conn->msgSize, tcItem->chunk_data, tcItem->chunk_length);
+		conn->msgSize += length;
+
+		conn->tupleCount++;
+
+		return true;
+	}
+
 	ic_statistics.totalCapacity += conn->capacity;
 	ic_statistics.capacityCountingTime++;
 
@@ -5361,6 +6434,17 @@ SendEosUDPIFC(MotionLayerState *mlStates,
 
 			prepareXmit(conn);
 
+			/*
+			 * The ring is as good as an ack: the receiver will get the
+			 * packet even if we are gone by then.
+			 */
+			if (conn->shmRing != NULL)
+			{
+				(void) sendShmPacket(transportStates, conn);
+				finishShmConn(conn);
+				continue;
+			}
+
 			/* place it into the send queue */
 			icBufferListAppend(&conn->sndQueue, conn->curBuff);
 			sendBuffers(transportStates, pEntry, conn);
@@ -5477,6 +6561,17 @@ doSendStopMessageUDPIFC(ChunkTransportState *transportStates, int16 motNodeID)
 					putRxBufferAndSendAck(conn, NULL);
 				}
 			}
+			else if (conn->shmRing != NULL)
+			{
+				/* the sender checks the flag before each packet */
+				conn->stopRequested = true;
+				conn->conn_info.flags |= UDPIC_FLAGS_STOP;
+				pg_atomic_fetch_or_u32(&conn->shmRing->flags, SHM_RING_STOP);
+				wakeShmPeer(conn, &conn->shmRing->txWaiting);
+
+				if (gp_log_interconnect >= GPVARS_VERBOSITY_DEBUG)
+					elog(DEBUG1, "sent stop message through shared memory. node %d route %d", motNodeID, i);
+			}
 			else
 			{
 				conn->stopRequested = true;
@@ -5957,6 +7052,266 @@ handleDataPacket(MotionConn *conn, icpkthdr *pkt, struct sockaddr_storage *peer,
 	return true;
 }
 
+/*
+ * checkRxPacket
+ * 		Sanity check a packet read by the rx thread.
+ *
+ * Returns false if the packet is to be dropped.
+ *
+ * Called by the rx thread, so no elog/ereport here.
+ */
+static bool
+checkRxPacket(icpkthdr *pkt, int read_count)
+{
+	/* length must be >= 0 */
+	if (pkt->len < 0)
+	{
+		if (DEBUG3 >= log_min_messages)
+			write_log("received inbound with negative length");
+		return false;
+	}
+
+	if (pkt->len != read_count)
+	{
+		if (DEBUG3 >= log_min_messages)
+			write_log("received inbound packet [%d], short: read %d bytes, pkt->len %d", pkt->seq, read_count, pkt->len);
+		return false;
+	}
+
+	/*
+	 * check the CRC of the payload.
+	 */
+	if (gp_interconnect_full_crc)
+	{
+		if (!checkCRC(pkt))
+		{
+			pg_atomic_add_fetch_u32((pg_atomic_uint32 *)&ic_statistics.crcErrors, 1);
+			if (DEBUG2 >= log_min_messages)
+				write_log("received network data error, dropping bad packet, user data unaffected.");
+			return false;
+		}
+	}
+
+	#ifdef AMS_VERBOSE_LOGGING
+		logPkt("GOT MESSAGE", pkt);
+	#endif
+
+	return true;
+}
+
+/*
+ * dispatchRxPacket
+ * 		Hand a packet read by the rx thread to its connection.
+ *
+ * Returns true if the packet buffer was taken over, in which case the caller
+ * needs a new one. The ack to send, if any, is left in param.
+ *
+ * The connection hash table should be locked until finishing the processing
+ * of the packet to avoid the connection addition/removal from the hash table
+ * during the mean time.
+ *
+ * SHOULD BE CALLED WITH ic_control_info.lock *LOCKED*
+ */
+static bool
+dispatchRxPacket(icpkthdr *pkt, struct sockaddr_storage *peer, socklen_t *peerlen, AckSendParam *param)
+{
+	MotionConn *conn = NULL;
+	bool		taken = false;
+
+	/* A shared-memory peer moved a ring that the main thread may wait on. */
+	if (pkt->flags & UDPIC_FLAGS_SHM_WAKEUP)
+	{
+		if (pkt->sessionId == gp_session_id)
+			pthread_cond_signal(&ic_control_info.cond);
+		return false;
+	}
+
+	conn = findConnByHeader(&ic_control_info.connHtab, pkt);
+
+	if (conn != NULL)
+	{
+		/* Handling a regular packet */
+		taken = handleDataPacket(conn, pkt, peer, peerlen, param);
+		ic_statistics.recvPktNum++;
+	}
+	else
+	{
+		/*
+		 * There may have two kinds of Mismatched packets:
+		 *    a) Past packets from previous command after I was torn down
+		 *    b) Future packets from current command before my connections are built.
+		 *
+		 * The handling logic is to "Ack the past and Nak the future".
+		 */
+		if ((pkt->flags & UDPIC_FLAGS_RECEIVER_TO_SENDER) == 0)
+		{
+			if (DEBUG1 >= log_min_messages)
+				write_log("mismatched packet received, seq %d, srcpid %d, dstpid %d, icid %d, sid %d", pkt->seq, pkt->srcPid, pkt->dstPid, pkt->icId, pkt->sessionId);
+
+		#ifdef AMS_VERBOSE_LOGGING
+			logPkt("Got a Mismatched Packet", pkt);
+		#endif
+
+			taken = handleMismatch(pkt, peer, *peerlen);
+			ic_statistics.mismatchNum++;
+		}
+	}
+
+	return taken;
+}
+
+#ifdef UDPIFC_BATCH_IO
+/*
+ * useBatchIO
+ * 		Whether to move packets with sendmmsg() and recvmmsg().
+ *
+ * The fault injection of the test mode hooks sendto() and recvfrom(), so
+ * the batched calls are not used while it is on.
+ */
+static inline bool
+useBatchIO(void)
+{
+#ifdef USE_ASSERT_CHECKING
+	if (udp_testmode)
+		return false;
+#endif
+	return gp_interconnect_batch_io;
+}
+
+/*
+ * getRxBatchBuffers
+ * 		Fill up the receive buffers of the rx thread for recvmmsg().
+ *
+ * Returns the number of buffers at the start of batch->pkts, which may be
+ * fewer than UDP_IO_BATCH_SIZE, or none, if the pool is running low.
+ */
+static int
+getRxBatchBuffers(RxBatch *batch)
+{
+	int			nbufs;
+	int			i;
+
+	pthread_mutex_lock(&ic_control_info.lock);
+	for (nbufs = 0; nbufs < UDP_IO_BATCH_SIZE; nbufs++)
+	{
+		if (batch->pkts[nbufs] == NULL)
+		{
+			batch->pkts[nbufs] = getRxBuffer(&rx_buffer_pool);
+			if (batch->pkts[nbufs] == NULL)
+				break;
+		}
+	}
+	pthread_mutex_unlock(&ic_control_info.lock);
+
+	for (i = 0; i < nbufs; i++)
+	{
+		batch->iovs[i].iov_base = batch->pkts[i];
+		batch->iovs[i].iov_len = Gp_max_packet_size;
+
+		memset(&batch->msgs[i], 0, sizeof(struct mmsghdr));
+		batch->msgs[i].msg_hdr.msg_name = &batch->peers[i];
+		batch->msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+		batch->msgs[i].msg_hdr.msg_iov = &batch->iovs[i];
+		batch->msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	return nbufs;
+}
+
+/*
+ * handleRxBatch
+ * 		Dispatch the packets read by one recvmmsg() call.
+ *
+ * The packets are dispatched under one acquisition of the lock, and their
+ * acks are sent with one sendmmsg() call after it is released. Buffers taken
+ * over by connections are removed from the batch, and the rest moved to the
+ * front for the next call.
+ */
+static void
+handleRxBatch(RxBatch *batch, int nread)
+{
+	bool		valid[UDP_IO_BATCH_SIZE];
+	int			nacks = 0;
+	int			nkept = 0;
+	int			i;
+
+	pg_atomic_add_fetch_u32((pg_atomic_uint32 *)&ic_statistics.recvBatchCallNum, 1);
+	pg_atomic_add_fetch_u32((pg_atomic_uint32 *)&ic_statistics.recvBatchPktNum, nread);
+
+	for (i = 0; i < nread; i++)
+	{
+		int			read_count = batch->msgs[i].msg_len;
+
+		if (DEBUG5 >= log_min_messages)
+			write_log("received inbound len %d", read_count);
+
+		if (read_count < sizeof(icpkthdr))
+		{
+			if (DEBUG1 >= log_min_messages)
+				write_log("Interconnect error: short conn receive (%d)", read_count);
+			valid[i] = false;
+			continue;
+		}
+
+		valid[i] = checkRxPacket(batch->pkts[i], read_count);
+	}
+
+	pthread_mutex_lock(&ic_control_info.lock);
+	for (i = 0; i < nread; i++)
+	{
+		AckSendParam *param = &batch->params[nacks];
+		socklen_t	peerlen = batch->msgs[i].msg_hdr.msg_namelen;
+
+		if (!valid[i])
+			continue;
+
+		memset(param, 0, sizeof(AckSendParam));
+		if (dispatchRxPacket(batch->pkts[i], &batch->peers[i], &peerlen, param))
+			batch->pkts[i] = NULL;
+
+		if (param->msg.len != 0)
+			nacks++;
+	}
+	pthread_mutex_unlock(&ic_control_info.lock);
+
+	/* real ack sending is after lock release to decrease the lock holding time. */
+	if (nacks > 0)
+		sendAckBatch(batch->params, nacks);
+
+	for (i = 0; i < UDP_IO_BATCH_SIZE; i++)
+	{
+		if (batch->pkts[i] != NULL)
+		{
+			icpkthdr   *pkt = batch->pkts[i];
+
+			batch->pkts[i] = NULL;
+			batch->pkts[nkept++] = pkt;
+		}
+	}
+}
+
+/*
+ * freeRxBatchBuffers
+ * 		Release the receive buffers of the rx thread.
+ */
+static void
+freeRxBatchBuffers(RxBatch *batch)
+{
+	int			i;
+
+	pthread_mutex_lock(&ic_control_info.lock);
+	for (i = 0; i < UDP_IO_BATCH_SIZE; i++)
+	{
+		if (batch->pkts[i] != NULL)
+		{
+			freeRxBuffer(&rx_buffer_pool, batch->pkts[i]);
+			batch->pkts[i] = NULL;
+		}
+	}
+	pthread_mutex_unlock(&ic_control_info.lock);
+}
+#endif
+
 /*
  * rxThreadFunc
  * 		Main function of the receive background thread.
@@ -6051,12 +7406,54 @@ rxThreadFunc(void *arg)
 			/* we've got something interesting to read */
 			/* handle incoming */
 			/* ready to read on our socket */
-			MotionConn *conn = NULL;
 			int read_count = 0;
 
 			struct sockaddr_storage peer;
 			socklen_t peerlen;
 
+#ifdef UDPIFC_BATCH_IO
+			/*
+			 * In batched mode, read as many packets as we have buffers for
+			 * with one recvmmsg().  If the pool is short of buffers, read
+			 * a single packet into pkt as usual.
+			 */
+			if (useBatchIO())
+			{
+				int		nbufs = getRxBatchBuffers(&rx_batch);
+
+				if (nbufs > 0)
+				{
+					read_count = recvmmsg(UDP_listenerFd, rx_batch.msgs, nbufs, 0, NULL);
+
+					expected = 1;
+					if (pg_atomic_compare_exchange_u32((pg_atomic_uint32 *)&ic_control_info.shutdown, &expected, 0))
+					{
+						if (DEBUG1 >= log_min_messages)
+						{
+							write_log("udp-ic: rx-thread shutting down");
+						}
+						break;
+					}
+
+					if (read_count < 0)
+					{
+						skip_poll = false;
+
+						if (errno == EWOULDBLOCK || errno == EINTR)
+							continue;
+
+						write_log("Interconnect error: recvmmsg (%d)", errno);
+						setRxThreadError(errno);
+						continue;
+					}
+
+					skip_poll = true;
+					handleRxBatch(&rx_batch, read_count);
+					continue;
+				}
+			}
+#endif
+
 			peerlen = sizeof(peer);
 			read_count = recvfrom(UDP_listenerFd, (char *)pkt, Gp_max_packet_size, 0,
 								  (struct sockaddr *)&peer, &peerlen);
@@ -6103,84 +7500,15 @@ rxThreadFunc(void *arg)
 			/* when we get a "good" recvfrom() result, we can skip poll() until we get a bad one. */
 			skip_poll = true;
 
-			/* length must be >= 0 */
-			if (pkt->len < 0)
-			{
-				if (DEBUG3 >= log_min_messages)
-					write_log("received inbound with negative length");
-				continue;
-			}
-
-			if (pkt->len != read_count)
-			{
-				if (DEBUG3 >= log_min_messages)
-					write_log("received inbound packet [%d], short: read %d bytes, pkt->len %d", pkt->seq, read_count, pkt->len);
+			if (!checkRxPacket(pkt, read_count))
 				continue;
-			}
-
-			/*
-			 * check the CRC of the payload.
-			 */
-			if (gp_interconnect_full_crc)
-			{
-				if (!checkCRC(pkt))
-				{
-					pg_atomic_add_fetch_u32((pg_atomic_uint32 *)&ic_statistics.crcErrors, 1);
-					if (DEBUG2 >= log_min_messages)
-						write_log("received network data error, dropping bad packet, user data unaffected.");
-					continue;
-				}
-			}
-
-			#ifdef AMS_VERBOSE_LOGGING
-				logPkt("GOT MESSAGE", pkt);
-			#endif
 
 			AckSendParam param;
 			memset(&param, 0, sizeof(AckSendParam));
 
-			/*
-			 * Get the connection for the pkt.
-			 *
-			 * 	The connection hash table should be locked until
-			 * 	finishing the processing of the packet to avoid
-			 *  the connection addition/removal from the hash table
-			 *  during the mean time.
-			 */
-
 			pthread_mutex_lock(&ic_control_info.lock);
-			conn = findConnByHeader(&ic_control_info.connHtab, pkt);
-
-			if (conn != NULL)
-			{
-				/* Handling a regular packet */
-				if (handleDataPacket(conn, pkt, &peer, &peerlen, &param))
-					pkt = NULL;
-				ic_statistics.recvPktNum++;
-			}
-			else
-			{
-				/*
-				 * There may have two kinds of Mismatched packets:
-				 *    a) Past packets from previous command after I was torn down
-				 *    b) Future packets from current command before my connections are built.
-				 *
-				 * The handling logic is to "Ack the past and Nak the future".
-				 */
-				if ((pkt->flags & UDPIC_FLAGS_RECEIVER_TO_SENDER) == 0)
-				{
-					if (DEBUG1 >= log_min_messages)
-						write_log("mismatched packet received, seq %d, srcpid %d, dstpid %d, icid %d, sid %d", pkt->seq, pkt->srcPid, pkt->dstPid, pkt->icId, pkt->sessionId);
-
-				#ifdef AMS_VERBOSE_LOGGING
-					logPkt("Got a Mismatched Packet", pkt);
-				#endif
-
-					if (handleMismatch(pkt, &peer, peerlen))
-						pkt = NULL;
-					ic_statistics.mismatchNum++;
-				}
-			}
+			if (dispatchRxPacket(pkt, &peer, &peerlen, &param))
+				pkt = NULL;
 			pthread_mutex_unlock(&ic_control_info.lock);
 
 			/* real ack sending is after lock release to decrease the lock holding time. */
@@ -6200,6 +7528,10 @@ rxThreadFunc(void *arg)
 		pthread_mutex_unlock(&ic_control_info.lock);
 	}
 
+#ifdef UDPIFC_BATCH_IO
+	freeRxBatchBuffers(&rx_batch);
+#endif
+
 	/* nothing to return */
 	return NULL;
 }
@@ -6597,7 +7929,8 @@ dumpConnections(ChunkTransportStateEntry *pEntry, const char *fname)
 
 		fprintf(ofile, "conns[%d] motNodeId=%d: remoteContentId=%d pid=%d sockfd=%d remote=%s local=%s "
 				"capacity=%d sentSeq=%d receivedAckSeq=%d consumedSeq=%d rtt=" UINT64_FORMAT
-				" dev=" UINT64_FORMAT " deadlockCheckBeginTime=" UINT64_FORMAT " route=%d msgSize=%d msgPos=%p"
+				" dev=" UINT64_FORMAT " minRtt=" UINT64_FORMAT " cwnd=%f ssthresh=%f resent=" UINT64_FORMAT
+				" deadlockCheckBeginTime=" UINT64_FORMAT " route=%d msgSize=%d msgPos=%p"
 				" recvBytes=%d tupleCount=%d stillActive=%d stopRequested=%d "
 				"state=%d\n",
 				 i, pEntry->motNodeId,
@@ -6607,7 +7940,8 @@ dumpConnections(ChunkTransportStateEntry *pEntry, const char *fname)
 				 conn->remoteHostAndPort,
 				 conn->localHostAndPort,
 				 conn->capacity, conn->sentSeq, conn->receivedAckSeq, conn->consumedSeq,
-				 conn->rtt, conn->dev, conn->deadlockCheckBeginTime, conn->route, conn->msgSize, conn->msgPos,
+				 conn->rtt, conn->dev, conn->minRtt, conn->cwnd, conn->ssthresh, conn->stat_count_resent,
+				 conn->deadlockCheckBeginTime, conn->route, conn->msgSize, conn->msgPos,
 				 conn->recvBytes, conn->tupleCount, conn->stillActive, conn->stopRequested,
 				 conn->state);
 		fprintf(ofile, "conn_info [%s: seq %d extraSeq %d]: motNodeId %d, crc %d len %d "
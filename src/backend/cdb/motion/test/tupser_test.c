@@ -0,0 +1,341 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include "cmockery.h"
+
+#include "c.h"
+#include "postgres.h"
+
+#include "../tupser.c"
+
+#define TEST_CHUNK_SIZE 8192
+
+/*
+ * Serializer state for rows of (int2, int4, name, text): fixed-width
+ * columns by value and by reference, and a varlena column.
+ */
+static SerTupInfo *
+make_test_serinfo(int natts)
+{
+	SerTupInfo *pSerInfo = (SerTupInfo *) palloc0(sizeof(SerTupInfo));
+	TupleDesc	tupdesc = CreateTemplateTupleDesc(natts, false);
+	static const struct
+	{
+		Oid			typid;
+		int16		len;
+		bool		byval;
+		char		align;
+	}			types[] = {
+		{INT2OID, sizeof(int16), true, 's'},
+		{INT4OID, sizeof(int32), true, 'i'},
+		{NAMEOID, NAMEDATALEN, false, 'c'},
+		{TEXTOID, -1, false, 'i'}
+	};
+	int			i;
+
+	for (i = 0; i < natts; i++)
+	{
+		tupdesc->attrs[i]->atttypid = types[i].typid;
+		tupdesc->attrs[i]->attlen = types[i].len;
+		tupdesc->attrs[i]->attbyval = types[i].byval;
+		tupdesc->attrs[i]->attalign = types[i].align;
+	}
+	pSerInfo->tupdesc = tupdesc;
+
+	Gp_max_tuple_chunk_size = TEST_CHUNK_SIZE;
+
+	return pSerInfo;
+}
+
+/*
+ * Values of the test row number row. Every column has some nulls, at
+ * different rows, and the text values vary in length; every fifth one has
+ * a short varlena header, as it would coming out of a heap tuple.
+ */
+static void
+make_test_row(int row, Datum *values, bool *nulls)
+{
+	Name		name = (Name) palloc0(NAMEDATALEN);
+	char		buf[64];
+	int			len;
+
+	snprintf(buf, sizeof(buf), "name %d", row);
+	namestrcpy(name, buf);
+
+	values[0] = Int16GetDatum((int16) row);
+	values[1] = Int32GetDatum(row * 1000);
+	values[2] = NameGetDatum(name);
+
+	len = row % 20;
+	memset(buf, 'a' + row % 26, len);
+	buf[len] = '\0';
+	if (row % 5 == 0)
+	{
+		char	   *shortval = palloc(VARHDRSZ_SHORT + len);
+
+		SET_VARSIZE_SHORT(shortval, VARHDRSZ_SHORT + len);
+		memcpy(shortval + VARHDRSZ_SHORT, buf, len);
+		values[3] = PointerGetDatum(shortval);
+	}
+	else
+		values[3] = CStringGetTextDatum(buf);
+
+	nulls[0] = (row % 7 == 0);
+	nulls[1] = (row % 11 == 3);
+	nulls[2] = (row % 13 == 5);
+	nulls[3] = (row % 3 == 1);
+}
+
+/*
+ * Serialize a batch into a TC_BATCH chunk, as the sender does.
+ */
+static TupleChunkListItem
+make_test_chunk(SerTupInfo *pSerInfo, TupleBatch *batch)
+{
+	TupleChunkListItem tcItem;
+	int			len;
+
+	tcItem = (TupleChunkListItem) palloc0(sizeof(TupleChunkListItemData) + Gp_max_tuple_chunk_size);
+	len = SerializeTupleBatch(pSerInfo, batch, (char *) tcItem->chunk_data + TUPLE_CHUNK_HEADER_SIZE);
+	assert_true(len <= TUPLE_BATCH_MAX_DATA_SIZE);
+
+	SetChunkDataSize(tcItem->chunk_data, len);
+	SetChunkType(tcItem->chunk_data, TC_BATCH);
+	tcItem->chunk_length = TUPLE_CHUNK_HEADER_SIZE + len;
+
+	return tcItem;
+}
+
+/*
+ * Check the decoded values of the given row of a received batch against
+ * those it was made from.
+ */
+static void
+check_test_row(RecvTupleBatch *recv, int natts, int i, int row)
+{
+	Datum		values[4];
+	bool		nulls[4];
+	Datum	   *got = &recv->values[i * natts];
+	bool	   *gotnull = &recv->nulls[i * natts];
+	int			j;
+
+	make_test_row(row, values, nulls);
+
+	for (j = 0; j < natts; j++)
+		assert_int_equal(gotnull[j], nulls[j]);
+
+	if (!nulls[0])
+		assert_int_equal(DatumGetInt16(got[0]), DatumGetInt16(values[0]));
+	if (natts > 1 && !nulls[1])
+		assert_int_equal(DatumGetInt32(got[1]), DatumGetInt32(values[1]));
+	if (natts > 2 && !nulls[2])
+		assert_string_equal(NameStr(*DatumGetName(got[2])), NameStr(*DatumGetName(values[2])));
+	if (natts > 3 && !nulls[3])
+	{
+		Pointer		gotval = DatumGetPointer(got[3]);
+		Pointer		val = DatumGetPointer(values[3]);
+
+		assert_int_equal(VARSIZE_ANY(gotval), VARSIZE_ANY(val));
+		assert_memory_equal(gotval, val, VARSIZE_ANY(val));
+	}
+}
+
+/* ==================== AddTupleToBatch ==================== */
+/*
+ * Test that a batch of narrow tuples stops at TUPLE_BATCH_MAX_TUPLES, and
+ * that a reset batch takes tuples again.
+ */
+void
+test__AddTupleToBatch__max_tuples(void **state)
+{
+	SerTupInfo *pSerInfo = make_test_serinfo(1);
+	TupleBatch	batch;
+	Datum		values[4];
+	bool		nulls[4];
+	int			row;
+
+	InitTupleBatch(pSerInfo, &batch, CurrentMemoryContext);
+	for (row = 0; row < TUPLE_BATCH_MAX_TUPLES; row++)
+	{
+		make_test_row(row, values, nulls);
+		assert_true(AddTupleToBatch(pSerInfo, &batch, values, nulls));
+	}
+
+	make_test_row(row, values, nulls);
+	assert_false(AddTupleToBatch(pSerInfo, &batch, values, nulls));
+	assert_int_equal(batch.ntuples, TUPLE_BATCH_MAX_TUPLES);
+
+	ResetTupleBatch(pSerInfo, &batch);
+	assert_int_equal(batch.ntuples, 0);
+	assert_true(AddTupleToBatch(pSerInfo, &batch, values, nulls));
+}
+
+/*
+ * Test that wider tuples stop going into a batch before it outgrows a
+ * chunk, and that what is in it still fits one.
+ */
+void
+test__AddTupleToBatch__chunk_full(void **state)
+{
+	SerTupInfo *pSerInfo = make_test_serinfo(4);
+	TupleBatch	batch;
+	Datum		values[4];
+	bool		nulls[4];
+	int			row;
+
+	InitTupleBatch(pSerInfo, &batch, CurrentMemoryContext);
+	for (row = 0; row < TUPLE_BATCH_MAX_TUPLES; row++)
+	{
+		make_test_row(row, values, nulls);
+		if (!AddTupleToBatch(pSerInfo, &batch, values, nulls))
+			break;
+	}
+
+	assert_true(row > 0 && row < TUPLE_BATCH_MAX_TUPLES);
+	assert_int_equal(batch.ntuples, row);
+	make_test_chunk(pSerInfo, &batch);
+}
+
+/* ==================== DeserializeTupleBatch ==================== */
+/*
+ * Test that batches of every size up to a full chunk come back as the
+ * values they were made of, nulls included, the next batch picking up
+ * where the previous one filled up.
+ */
+void
+test__DeserializeTupleBatch__round_trip(void **state)
+{
+	SerTupInfo *pSerInfo = make_test_serinfo(4);
+	TupleBatch	batch;
+	Datum		values[4];
+	bool		nulls[4];
+	int			row = 0;
+	int			nbatches = 0;
+
+	InitTupleBatch(pSerInfo, &batch, CurrentMemoryContext);
+	while (row < 3 * TUPLE_BATCH_MAX_TUPLES)
+	{
+		int			first = row;
+		RecvTupleBatch *recv;
+		int			i;
+
+		ResetTupleBatch(pSerInfo, &batch);
+		for (;;)
+		{
+			make_test_row(row, values, nulls);
+			if (!AddTupleToBatch(pSerInfo, &batch, values, nulls))
+				break;
+			row++;
+		}
+
+		recv = DeserializeTupleBatch(pSerInfo, make_test_chunk(pSerInfo, &batch));
+		assert_int_equal(recv->ntuples, row - first);
+		for (i = 0; i < recv->ntuples; i++)
+			check_test_row(recv, 4, i, first + i);
+		FreeRecvTupleBatch(recv);
+		nbatches++;
+	}
+	assert_true(nbatches > 1);
+
+	/* and a batch of a single tuple */
+	ResetTupleBatch(pSerInfo, &batch);
+	make_test_row(7, values, nulls);
+	assert_true(AddTupleToBatch(pSerInfo, &batch, values, nulls));
+	check_test_row(DeserializeTupleBatch(pSerInfo, make_test_chunk(pSerInfo, &batch)), 4, 0, 7);
+}
+
+/*
+ * Return true if decoding the chunk fails.
+ */
+static bool
+deserialize_fails(SerTupInfo *pSerInfo, TupleChunkListItem tcItem)
+{
+	bool		failed = false;
+
+	PG_TRY();
+	{
+		DeserializeTupleBatch(pSerInfo, tcItem);
+	}
+	PG_CATCH();
+	{
+		FlushErrorState();
+		failed = true;
+	}
+	PG_END_TRY();
+
+	return failed;
+}
+
+/*
+ * Test that chunks that don't hold what their header says are rejected,
+ * rather than read past their end.
+ */
+void
+test__DeserializeTupleBatch__malformed(void **state)
+{
+	SerTupInfo *pSerInfo = make_test_serinfo(4);
+	TupleBatch	batch;
+	TupleChunkListItem tcItem;
+	Datum		values[4];
+	bool		nulls[4];
+	uint16		len;
+	uint16		val;
+	int			row;
+
+	InitTupleBatch(pSerInfo, &batch, CurrentMemoryContext);
+	for (row = 1; row <= 100; row++)
+	{
+		make_test_row(row, values, nulls);
+		assert_true(AddTupleToBatch(pSerInfo, &batch, values, nulls));
+	}
+	tcItem = make_test_chunk(pSerInfo, &batch);
+	GetChunkDataSize(tcItem, &len);
+	assert_false(deserialize_fails(pSerInfo, tcItem));
+
+	/* shorter than its header */
+	SetChunkDataSize(tcItem->chunk_data, 2);
+	assert_true(deserialize_fails(pSerInfo, tcItem));
+
+	/* cut off in the middle of the values */
+	SetChunkDataSize(tcItem->chunk_data, len / 2);
+	assert_true(deserialize_fails(pSerInfo, tcItem));
+	SetChunkDataSize(tcItem->chunk_data, len);
+
+	/* more tuples than there is data for */
+	val = 1000;
+	memcpy(tcItem->chunk_data + TUPLE_CHUNK_HEADER_SIZE, &val, sizeof(uint16));
+	assert_true(deserialize_fails(pSerInfo, tcItem));
+
+	/* no tuples */
+	val = 0;
+	memcpy(tcItem->chunk_data + TUPLE_CHUNK_HEADER_SIZE, &val, sizeof(uint16));
+	assert_true(deserialize_fails(pSerInfo, tcItem));
+	val = 100;
+	memcpy(tcItem->chunk_data + TUPLE_CHUNK_HEADER_SIZE, &val, sizeof(uint16));
+
+	/* a different number of attributes than the receiver's */
+	assert_true(deserialize_fails(make_test_serinfo(3), tcItem));
+
+	/* a varlena that runs past the end */
+	tcItem = make_test_chunk(pSerInfo, &batch);
+	SetChunkDataSize(tcItem->chunk_data, len - 4);
+	assert_true(deserialize_fails(pSerInfo, tcItem));
+}
+
+/* ==================== main ==================== */
+int
+main(int argc, char* argv[])
+{
+	cmockery_parse_arguments(argc, argv);
+
+	const UnitTest tests[] = {
+		unit_test(test__AddTupleToBatch__max_tuples),
+		unit_test(test__AddTupleToBatch__chunk_full),
+		unit_test(test__DeserializeTupleBatch__round_trip),
+		unit_test(test__DeserializeTupleBatch__malformed)
+	};
+
+	MemoryContextInit();
+
+	return run_tests(tests);
+}
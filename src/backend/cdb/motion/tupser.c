@@ -22,6 +22,7 @@
 #include "utils/date.h"
 #include "utils/numeric.h"
 #include "utils/memutils.h"
+#include "utils/pg_lzcompress.h"
 #include "utils/builtins.h"
 #include "utils/syscache.h"
 #include "utils/typcache.h"
@@ -783,6 +784,84 @@ SerializeTupleIntoChunks(HeapTuple tuple, SerTupInfo * pSerInfo, TupleChunkList
 	return;
 }
 
+/*
+ * Compress the serialized tuple in a chunk list built by
+ * SerializeTupleIntoChunks().
+ *
+ * If pglz manages to shrink the tuple data, the list is rebuilt to hold the
+ * compressed form, with TC_COMPRESSED_FLAG set on its first chunk, and true
+ * is returned.  Otherwise the list is left alone.
+ */
+bool
+CompressTupleChunks(SerTupInfo *pSerInfo, TupleChunkList tcList)
+{
+	TupleChunkListItem tcItem;
+	TupleChunkType tcType;
+	MemoryContext oldCtxt;
+	PGLZ_Header *compressed;
+	char	   *raw;
+	char	   *pos;
+	int			rawlen;
+	bool		result = false;
+
+	AssertArg(tcList != NULL);
+	AssertArg(tcList->p_first != NULL);
+	AssertArg(pSerInfo != NULL);
+
+	GetChunkType(tcList->p_first, &tcType);
+	if (tcType == TC_EMPTY)
+		return false;
+
+	oldCtxt = MemoryContextSwitchTo(s_tupSerMemCtxt);
+
+	/* Flatten the tuple data, leaving out the chunk headers. */
+	rawlen = tcList->serialized_data_length;
+	raw = palloc(rawlen);
+	pos = raw;
+	for (tcItem = tcList->p_first; tcItem != NULL; tcItem = tcItem->p_next)
+	{
+		int			len = tcItem->chunk_length - TUPLE_CHUNK_HEADER_SIZE;
+
+		memcpy(pos, tcItem->chunk_data + TUPLE_CHUNK_HEADER_SIZE, len);
+		pos += len;
+	}
+	Assert(pos - raw == rawlen);
+
+	compressed = (PGLZ_Header *) palloc(PGLZ_MAX_OUTPUT(rawlen));
+	if (pglz_compress(raw, rawlen, compressed, PGLZ_strategy_default) &&
+		VARSIZE(compressed) < rawlen)
+	{
+		clearTCList(&pSerInfo->chunkCache, tcList);
+
+		tcItem = getChunkFromCache(&pSerInfo->chunkCache);
+		if (tcItem == NULL)
+		{
+			ereport(FATAL, (errcode(ERRCODE_OUT_OF_MEMORY),
+							errmsg("Could not allocate space for first chunk item in new chunk list.")));
+		}
+
+		SetChunkType(tcItem->chunk_data, TC_WHOLE);
+		tcItem->chunk_length = TUPLE_CHUNK_HEADER_SIZE;
+		appendChunkToTCList(tcList, tcItem);
+
+		addByteStringToChunkList(tcList, (char *) compressed, VARSIZE(compressed), &pSerInfo->chunkCache);
+
+		if (tcList->num_chunks > 1)
+		{
+			SetChunkType(tcList->p_first->chunk_data, TC_PARTIAL_START);
+			SetChunkType(tcList->p_last->chunk_data, TC_PARTIAL_END);
+		}
+		SetChunkCompressed(tcList->p_first->chunk_data);
+
+		result = true;
+	}
+
+	MemoryContextSwitchTo(oldCtxt);
+	MemoryContextReset(s_tupSerMemCtxt);
+
+	return result;
+}
+
 /*
  * Serialize a tuple directly into a buffer.
  *
@@ -1141,12 +1220,14 @@ CvtChunksToHeapTup(TupleChunkList tcList, SerTupInfo * pSerInfo, TupleRemapper *
 	int			i;
 	HeapTuple	htup;
 	TupleChunkType tcType;
+	bool		compressed;
 
 	AssertArg(tcList != NULL);
 	AssertArg(tcList->p_first != NULL);
 	AssertArg(pSerInfo != NULL);
 
 	tcItem = tcList->p_first;
+	GetChunkCompressed(tcItem, &compressed);
 
 	if (tcList->num_chunks == 1)
 	{
@@ -1241,6 +1322,31 @@ CvtChunksToHeapTup(TupleChunkList tcList, SerTupInfo * pSerInfo, TupleRemapper *
 	/* we've finished with the TCList, free it now. */
 	clearTCList(NULL, tcList);
 
+	/* expand a tuple compressed by CompressTupleChunks() */
+	if (compressed)
+	{
+		PGLZ_Header *lzhdr = (PGLZ_Header *) serData.data;
+		StringInfoData rawData;
+
+		if (serData.len < sizeof(PGLZ_Header) ||
+			VARSIZE(lzhdr) != serData.len ||
+			PGLZ_RAW_SIZE(lzhdr) <= 0 ||
+			!AllocSizeIsValid(PGLZ_RAW_SIZE(lzhdr)))
+			ereport(ERROR, (errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+							errmsg("Interconnect error: cannot decompress tuple chunks."),
+							errdetail("compressed len %d, header len %d, raw len %d",
+									  serData.len, (int) VARSIZE(lzhdr),
+									  (int) PGLZ_RAW_SIZE(lzhdr))));
+
+		initStringInfoOfSize(&rawData, PGLZ_RAW_SIZE(lzhdr) + 1);
+		pglz_decompress(lzhdr, rawData.data);
+		rawData.len = PGLZ_RAW_SIZE(lzhdr);
+		rawData.data[rawData.len] = '\0';
+
+		pfree(serData.data);
+		serData = rawData;
+	}
+
 	{
 		TupSerHeader *tshp;
 		unsigned int	datalen;
@@ -1357,3 +1463,372 @@ CvtChunksToHeapTup(TupleChunkList tcList, SerTupInfo * pSerInfo, TupleRemapper *
 
 	return htup;
 }
+
+/*
+ * Tuple batches
+ *
+ * With gp_interconnect_batch_tuples, a Redistribute Motion collects the
+ * tuples for each route into a TupleBatch, and sends them in one TC_BATCH
+ * chunk instead of a chunk list per tuple.  The data of the chunk is laid
+ * out column-major:
+ *
+ *	  uint16	number of tuples, n
+ *	  uint16	number of attributes
+ *	  uint8		for each attribute, whether it has nulls
+ *
+ * followed, for each attribute, by its null bitmap (BITMAPLEN(n) bytes, only
+ * if it has nulls), and then, starting MAXALIGNed, its values: n slots of
+ * the aligned attribute length for fixed-width attributes, or the non-null
+ * varlenas one after another, each INTALIGNed, for varlena attributes.
+ *
+ * The receiver decodes the columns into values/nulls arrays, pointing into
+ * a copy of the chunk data.  An unordered receiver returns the tuples from
+ * those as virtual tuples; only an order-preserving receiver, which has to
+ * keep a tuple from each sender at hand, forms HeapTuples out of them.
+ */
+
+#define TUPLE_BATCH_HEADER_SIZE		(2 * sizeof(uint16))
+#define TUPLE_BATCH_BITMAP_SIZE		BITMAPLEN(TUPLE_BATCH_MAX_TUPLES)
+#define TUPLE_BATCH_MAX_DATA_SIZE	(Gp_max_tuple_chunk_size - TUPLE_CHUNK_HEADER_SIZE)
+
+/*
+ * Upper bound of the serialized size of a batch of ntuples tuples, with
+ * datalen bytes of values.
+ */
+static int
+tupleBatchSizeBound(int natts, int ntuples, int datalen)
+{
+	return TUPLE_BATCH_HEADER_SIZE + natts +
+		natts * (BITMAPLEN(ntuples) + MAXIMUM_ALIGNOF - 1) +
+		datalen + TUPLE_CHUNK_ALIGN - 1;
+}
+
+bool
+TupleBatchSupported(SerTupInfo *pSerInfo)
+{
+	TupleDesc	tupdesc = pSerInfo->tupdesc;
+	int			i;
+
+	if (tupdesc->natts == 0 || tupdesc->tdhasoid || pSerInfo->has_record_types)
+		return false;
+
+	/* no cstrings */
+	for (i = 0; i < tupdesc->natts; i++)
+	{
+		if (tupdesc->attrs[i]->attlen < 0 && tupdesc->attrs[i]->attlen != -1)
+			return false;
+	}
+
+	/* even one narrow tuple has to fit */
+	return tupleBatchSizeBound(tupdesc->natts, 1, 0) < TUPLE_BATCH_MAX_DATA_SIZE / 2;
+}
+
+/*
+ * The buffers of a batch are only allocated, in mcxt, when the first tuple
+ * is added to it, so that routes that never get a tuple cost nothing.
+ */
+void
+InitTupleBatch(SerTupInfo *pSerInfo, TupleBatch *batch, MemoryContext mcxt)
+{
+	batch->mcxt = mcxt;
+	batch->ntuples = 0;
+	batch->datalen = 0;
+	batch->cols = NULL;
+	batch->nullbits = NULL;
+	batch->hasnulls = NULL;
+}
+
+static void
+allocTupleBatch(SerTupInfo *pSerInfo, TupleBatch *batch)
+{
+	int			natts = pSerInfo->tupdesc->natts;
+
+	batch->cols = (StringInfoData *)
+		MemoryContextAllocZero(batch->mcxt, natts * sizeof(StringInfoData));
+	batch->nullbits = (bits8 *)
+		MemoryContextAllocZero(batch->mcxt, natts * TUPLE_BATCH_BITMAP_SIZE);
+	batch->hasnulls = (bool *)
+		MemoryContextAllocZero(batch->mcxt, natts * sizeof(bool));
+}
+
+void
+ResetTupleBatch(SerTupInfo *pSerInfo, TupleBatch *batch)
+{
+	int			natts = pSerInfo->tupdesc->natts;
+	int			i;
+
+	batch->ntuples = 0;
+	batch->datalen = 0;
+	if (batch->cols == NULL)
+		return;
+	for (i = 0; i < natts; i++)
+		batch->cols[i].len = 0;
+	MemSet(batch->nullbits, 0, natts * TUPLE_BATCH_BITMAP_SIZE);
+	MemSet(batch->hasnulls, 0, natts * sizeof(bool));
+}
+
+/*
+ * Make room for len more bytes in a column of a batch, allocating the
+ * column buffer on first use.
+ */
+static void
+enlargeBatchColumn(TupleBatch *batch, StringInfo col, int len)
+{
+	if (col->data == NULL)
+	{
+		MemoryContext oldcxt = MemoryContextSwitchTo(batch->mcxt);
+
+		initStringInfo(col);
+		MemoryContextSwitchTo(oldcxt);
+	}
+	enlargeStringInfo(col, len);
+}
+
+/*
+ * Add a tuple, given as values/nulls arrays, to a batch.
+ *
+ * Returns false, leaving the batch alone, if the batch is full, or if the
+ * tuple has an external toasted value and has to be sent the regular way.
+ */
+bool
+AddTupleToBatch(SerTupInfo *pSerInfo, TupleBatch *batch, Datum *values, bool *nulls)
+{
+	TupleDesc	tupdesc = pSerInfo->tupdesc;
+	int			natts = tupdesc->natts;
+	int			row = batch->ntuples;
+	int			needed = 0;
+	int			i;
+
+	if (batch->ntuples >= TUPLE_BATCH_MAX_TUPLES)
+		return false;
+
+	if (batch->cols == NULL)
+		allocTupleBatch(pSerInfo, batch);
+
+	/* First see how much space the tuple takes */
+	for (i = 0; i < natts; i++)
+	{
+		Form_pg_attribute attr = tupdesc->attrs[i];
+
+		if (attr->attlen > 0)
+			needed += att_align_nominal(attr->attlen, attr->attalign);
+		else if (!nulls[i])
+		{
+			Pointer		val = DatumGetPointer(values[i]);
+
+			if (VARATT_IS_EXTERNAL(val))
+				return false;
+
+			needed += INTALIGN(batch->cols[i].len) - batch->cols[i].len + VARSIZE_ANY(val);
+		}
+	}
+
+	if (tupleBatchSizeBound(natts, row + 1, batch->datalen + needed) > TUPLE_BATCH_MAX_DATA_SIZE)
+		return false;
+
+	for (i = 0; i < natts; i++)
+	{
+		Form_pg_attribute attr = tupdesc->attrs[i];
+		StringInfo	col = &batch->cols[i];
+
+		if (nulls[i])
+			batch->hasnulls[i] = true;
+		else
+			batch->nullbits[i * TUPLE_BATCH_BITMAP_SIZE + (row >> 3)] |= (1 << (row & 7));
+
+		if (attr->attlen > 0)
+		{
+			int			stride = att_align_nominal(attr->attlen, attr->attalign);
+
+			enlargeBatchColumn(batch, col, stride);
+			MemSet(col->data + col->len, 0, stride);
+			if (!nulls[i])
+			{
+				if (attr->attbyval)
+					store_att_byval(col->data + col->len, values[i], attr->attlen);
+				else
+					memcpy(col->data + col->len, DatumGetPointer(values[i]), attr->attlen);
+			}
+			col->len += stride;
+		}
+		else if (!nulls[i])
+		{
+			Pointer		val = DatumGetPointer(values[i]);
+			int			pad = INTALIGN(col->len) - col->len;
+
+			enlargeBatchColumn(batch, col, pad + VARSIZE_ANY(val));
+			MemSet(col->data + col->len, 0, pad);
+			memcpy(col->data + col->len + pad, val, VARSIZE_ANY(val));
+			col->len += pad + VARSIZE_ANY(val);
+			col->data[col->len] = '\0';
+		}
+	}
+
+	batch->datalen += needed;
+	batch->ntuples++;
+
+	return true;
+}
+
+int
+SerializeTupleBatch(SerTupInfo *pSerInfo, TupleBatch *batch, char *dest)
+{
+	int			natts = pSerInfo->tupdesc->natts;
+	uint16		val;
+	int			off;
+	int			i;
+
+	Assert(batch->ntuples > 0);
+	Assert(tupleBatchSizeBound(natts, batch->ntuples, batch->datalen) <= TUPLE_BATCH_MAX_DATA_SIZE);
+
+	val = batch->ntuples;
+	memcpy(dest, &val, sizeof(uint16));
+	val = natts;
+	memcpy(dest + sizeof(uint16), &val, sizeof(uint16));
+	off = TUPLE_BATCH_HEADER_SIZE;
+
+	for (i = 0; i < natts; i++)
+		dest[off++] = batch->hasnulls[i] ? 1 : 0;
+
+	for (i = 0; i < natts; i++)
+	{
+		if (batch->hasnulls[i])
+		{
+			memcpy(dest + off, batch->nullbits + i * TUPLE_BATCH_BITMAP_SIZE, BITMAPLEN(batch->ntuples));
+			off += BITMAPLEN(batch->ntuples);
+		}
+
+		MemSet(dest + off, 0, MAXALIGN(off) - off);
+		off = MAXALIGN(off);
+
+		if (batch->cols[i].len > 0)
+		{
+			memcpy(dest + off, batch->cols[i].data, batch->cols[i].len);
+			off += batch->cols[i].len;
+		}
+	}
+
+	/* keep the chunks that follow aligned, like addPadding() does */
+	MemSet(dest + off, 0, TYPEALIGN(TUPLE_CHUNK_ALIGN, off) - off);
+	off = TYPEALIGN(TUPLE_CHUNK_ALIGN, off);
+
+	return off;
+}
+
+RecvTupleBatch *
+DeserializeTupleBatch(SerTupInfo *pSerInfo, TupleChunkListItem tcItem)
+{
+	TupleDesc	tupdesc = pSerInfo->tupdesc;
+	int			natts = tupdesc->natts;
+	RecvTupleBatch *batch;
+	Datum	   *values;
+	bool	   *nulls;
+	char	   *buf;
+	uint8	   *hasnulls;
+	uint16		datalen;
+	uint16		n;
+	uint16		nattsin;
+	int			off;
+	int			i,
+				j;
+
+	GetChunkDataSize(tcItem, &datalen);
+
+	/* Copy the data out of the receive buffer, to have it aligned */
+	buf = palloc(datalen + 1);
+	memcpy(buf, GetChunkDataPtr(tcItem) + TUPLE_CHUNK_HEADER_SIZE, datalen);
+
+	if (datalen < TUPLE_BATCH_HEADER_SIZE)
+		goto bad_batch;
+
+	memcpy(&n, buf, sizeof(uint16));
+	memcpy(&nattsin, buf + sizeof(uint16), sizeof(uint16));
+	if (nattsin != natts || n == 0 || TUPLE_BATCH_HEADER_SIZE + natts > datalen)
+		goto bad_batch;
+
+	hasnulls = (uint8 *) buf + TUPLE_BATCH_HEADER_SIZE;
+	off = TUPLE_BATCH_HEADER_SIZE + natts;
+
+	values = (Datum *) palloc(n * natts * sizeof(Datum));
+	nulls = (bool *) palloc(n * natts * sizeof(bool));
+
+	/* Decode column by column */
+	for (j = 0; j < natts; j++)
+	{
+		Form_pg_attribute attr = tupdesc->attrs[j];
+		bits8	   *bits = NULL;
+
+		if (hasnulls[j])
+		{
+			bits = (bits8 *) buf + off;
+			off += BITMAPLEN(n);
+		}
+		off = MAXALIGN(off);
+		if (off > datalen)
+			goto bad_batch;
+
+		if (attr->attlen > 0)
+		{
+			int			stride = att_align_nominal(attr->attlen, attr->attalign);
+
+			if (off + n * stride > datalen)
+				goto bad_batch;
+
+			for (i = 0; i < n; i++)
+			{
+				bool		isnull = (bits != NULL && (bits[i >> 3] & (1 << (i & 7))) == 0);
+
+				nulls[i * natts + j] = isnull;
+				values[i * natts + j] = isnull ? (Datum) 0 :
+					fetch_att(buf + off + i * stride, attr->attbyval, attr->attlen);
+			}
+			off += n * stride;
+		}
+		else
+		{
+			for (i = 0; i < n; i++)
+			{
+				bool		isnull = (bits != NULL && (bits[i >> 3] & (1 << (i & 7))) == 0);
+
+				nulls[i * natts + j] = isnull;
+				values[i * natts + j] = (Datum) 0;
+				if (isnull)
+					continue;
+
+				off = INTALIGN(off);
+				if (off >= datalen ||
+					(!VARATT_IS_1B(buf + off) && off + VARHDRSZ > datalen) ||
+					off + VARSIZE_ANY(buf + off) > datalen)
+					goto bad_batch;
+
+				values[i * natts + j] = PointerGetDatum(buf + off);
+				off += VARSIZE_ANY(buf + off);
+			}
+		}
+	}
+
+	batch = (RecvTupleBatch *) palloc(sizeof(RecvTupleBatch));
+	batch->ntuples = n;
+	batch->next = 0;
+	batch->buf = buf;
+	batch->values = values;
+	batch->nulls = nulls;
+	batch->next_batch = NULL;
+
+	return batch;
+
+bad_batch:
+	ereport(ERROR, (errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+					errmsg("Interconnect error: malformed tuple batch chunk."),
+					errdetail("chunk data length %d", (int) datalen)));
+	return NULL;			/* keep compiler quiet */
+}
+
+void
+FreeRecvTupleBatch(RecvTupleBatch *batch)
+{
+	pfree(batch->values);
+	pfree(batch->nulls);
+	pfree(batch->buf);
+	pfree(batch);
+}
@@ -66,7 +66,7 @@ bool AdvanceAggregatesCodegen::GenerateAdvanceTransitionFunction(
                                                    "datumCopyWithMemManager");
 
   // Generation-time constants
-  llvm::Value *llvm_tuplecontext = codegen_utils->GetConstant<MemoryContext>(
+  llvm::Value *llvm_tuplecontext = codegen_utils->GetRebindableConstant(
       aggstate_->tmpcontext->ecxt_per_tuple_memory);
 
   // Retrieve pergroup's useful members
@@ -310,6 +310,30 @@ bool AdvanceAggregatesCodegen::GenerateAdvanceTransitionFunction(
   return true;
 }
 
+bool AdvanceAggregatesCodegen::AppendFingerprint(
+    std::string* fingerprint) const {
+  if (nullptr == aggstate_) {
+    return false;
+  }
+  fingerprint->append(std::to_string(aggstate_->numaggs));
+  for (int aggno = 0; aggno < aggstate_->numaggs; aggno++) {
+    AggStatePerAgg peraggstate = &aggstate_->peragg[aggno];
+    fingerprint->append(",");
+    if (peraggstate->numSortCols > 0 || nullptr == peraggstate->aggref) {
+      // Not supported; see GenerateAdvanceAggregates()
+      fingerprint->append("unsupported");
+      return true;
+    }
+    fingerprint->append(std::to_string(peraggstate->transfn.fn_oid));
+    fingerprint->append(peraggstate->transfn.fn_strict ? "s" : "n");
+    fingerprint->append(std::to_string(peraggstate->transfn.fn_nargs));
+    fingerprint->append(peraggstate->transtypeByVal ? "v" : "r");
+    fingerprint->append(std::to_string(peraggstate->transtypeLen));
+    fingerprint->append(peraggstate->evalproj->pi_isVarList ? "l" : "t");
+  }
+  return true;
+}
+
 bool AdvanceAggregatesCodegen::GenerateAdvanceAggregates(
     gpcodegen::GpCodegenUtils* codegen_utils) {
 
@@ -350,7 +374,7 @@ bool AdvanceAggregatesCodegen::GenerateAdvanceAggregates(
       advance_aggregates_func, 2);
 
   // Generation-time constants
-  llvm::Value* llvm_aggstate = codegen_utils->GetConstant(aggstate_);
+  llvm::Value* llvm_aggstate = codegen_utils->GetRebindableConstant(aggstate_);
 
   // entry block
   // ----------
@@ -426,16 +450,19 @@ bool AdvanceAggregatesCodegen::GenerateAdvanceAggregates(
     if (nargs > 0) {
       if (peraggstate->evalproj->pi_isVarList) {
         irb->CreateCall(llvm_ExecVariableList, {
-            codegen_utils->GetConstant<ProjectionInfo *>(peraggstate->evalproj),
+            codegen_utils->GetRebindableConstant(peraggstate->evalproj),
             llvm_in_args_ptr,
             llvm_in_isnulls_ptr});
       } else {
         irb->CreateCall(llvm_ExecTargetList, {
-            codegen_utils->GetConstant(peraggstate->evalproj->pi_targetlist),
-            codegen_utils->GetConstant(peraggstate->evalproj->pi_exprContext),
+            codegen_utils->GetRebindableConstant(
+                peraggstate->evalproj->pi_targetlist),
+            codegen_utils->GetRebindableConstant(
+                peraggstate->evalproj->pi_exprContext),
             llvm_in_args_ptr,
             llvm_in_isnulls_ptr,
-            codegen_utils->GetConstant(peraggstate->evalproj->pi_itemIsDone),
+            codegen_utils->GetRebindableConstant(
+                peraggstate->evalproj->pi_itemIsDone),
             codegen_utils->GetConstant<ExprDoneCond *>(nullptr)});
       }
     }
@@ -0,0 +1,799 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    codegen_microbench.cc
+//
+//  @doc:
+//    Microbenchmarks of the regular and the generated versions of
+//    slot_getattr, ExecVariableList, ExecEvalExpr and advance_aggregates
+//    over synthetic tuples, for measuring codegen without a cluster.
+//
+//    Usage: codegen_microbench.t [--rows N] [--repeat N] [--filter STRING]
+//
+//---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#undef newNode  // undef newNode so it doesn't have name collision with llvm
+#include "access/heapam.h"
+#include "access/htup.h"
+#include "access/memtup.h"
+#include "access/tupdesc.h"
+#include "catalog/pg_authid.h"
+#include "catalog/pg_type.h"
+#include "executor/executor.h"
+#include "executor/nodeAgg.h"
+#include "executor/tuptable.h"
+#include "miscadmin.h"
+#include "nodes/execnodes.h"
+#include "nodes/makefuncs.h"
+#include "nodes/pg_list.h"
+#include "nodes/primnodes.h"
+#include "optimizer/clauses.h"
+#include "utils/builtins.h"
+#include "utils/date.h"
+#include "utils/fmgroids.h"
+#include "utils/guc.h"
+#include "utils/memutils.h"
+}
+
+#include "llvm/IR/Function.h"
+#include "llvm/IR/IRBuilder.h"
+
+#include "codegen/base_codegen.h"
+#include "codegen/codegen_manager.h"
+#include "codegen/codegen_wrapper.h"
+#include "codegen/slot_getattr_codegen.h"
+#include "codegen/utils/gp_codegen_utils.h"
+#include "codegen/utils/utility.h"
+
+extern bool codegen;
+extern bool codegen_validate_functions;
+extern bool codegen_exec_variable_list;
+extern bool codegen_slot_getattr;
+extern bool codegen_exec_eval_expr;
+extern bool codegen_advance_aggregate;
+extern bool codegen_background_compile;
+extern int codegen_optimization_level;
+extern int codegen_cache_size;
+extern double codegen_saving_per_row;
+
+namespace gpcodegen {
+namespace {
+
+// Oids of the operators and aggregates used by the benchmarked expressions
+constexpr Oid kInt4PlusOperator = 551;
+constexpr Oid kInt4LessEqualOperator = 523;
+constexpr Oid kSumInt4Aggregate = 2108;
+constexpr Oid kCountStarAggregate = 2803;
+
+template <typename NodeType>
+NodeType* MakeNode(NodeTag tag) {
+  NodeType* node = static_cast<NodeType*>(palloc0(sizeof(NodeType)));
+  reinterpret_cast<Node*>(node)->type = tag;
+  return node;
+}
+
+struct ColumnType {
+  Oid type_oid;
+  int16 len;
+  bool byval;
+  char align;
+};
+
+const ColumnType kInt4Column = {INT4OID, 4, true, 'i'};
+const ColumnType kInt8Column = {INT8OID, 8, true, 'd'};
+const ColumnType kFloat8Column = {FLOAT8OID, 8, true, 'd'};
+const ColumnType kDateColumn = {DATEOID, 4, true, 'i'};
+const ColumnType kTextColumn = {TEXTOID, -1, false, 'i'};
+
+// Mix of column types of the synthetic tables. Columns cycle over the types.
+struct TypeMix {
+  const char* name;
+  std::vector<ColumnType> cycle;
+  // One in null_period values is null; zero for no nulls
+  int null_period;
+};
+
+struct Options {
+  int rows = 100000;
+  int repeat = 5;
+  std::string filter;
+};
+
+struct Timings {
+  double regular_ns_per_row = 0;
+  double generated_ns_per_row = 0;
+  double generation_ms = 0;
+  double compilation_ms = 0;
+  bool generated = false;
+  bool matches = true;
+};
+
+double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Best time per row in ns of running body over all rows, out of
+ *        repeat runs.
+ **/
+template <typename Body>
+double NsPerRow(const Options& options, Body body) {
+  double best = -1;
+  for (int run = 0; run < options.repeat; ++run) {
+    auto start = std::chrono::steady_clock::now();
+    for (int row = 0; row < options.rows; ++row) {
+      body(row);
+    }
+    double ns = MillisecondsSince(start) * 1e6 / options.rows;
+    if (best < 0 || ns < best) {
+      best = ns;
+    }
+  }
+  return best;
+}
+
+/**
+ * @brief A synthetic table of the given width and type mix, stored both as
+ *        heap tuples and as memtuples, and a scan slot to read it through.
+ **/
+class Table {
+ public:
+  Table(const TypeMix& mix, int width, int rows)
+      : mix_(mix), width_(width) {
+    desc_ = CreateTemplateTupleDesc(width, false);
+    for (int i = 0; i < width; ++i) {
+      const ColumnType& type = mix.cycle[i % mix.cycle.size()];
+      Form_pg_attribute attr = desc_->attrs[i];
+      attr->attnum = i + 1;
+      attr->atttypid = type.type_oid;
+      attr->attlen = type.len;
+      attr->attbyval = type.byval;
+      attr->attalign = type.align;
+      attr->attstorage = type.byval ? 'p' : 'x';
+      attr->atttypmod = -1;
+      attr->attcacheoff = -1;
+      attr->attndims = 0;
+      attr->attnotnull = false;
+      attr->attisdropped = false;
+    }
+    slot_ = MakeSingleTupleTableSlot(desc_);
+
+    std::vector<Datum> values(width);
+    std::unique_ptr<bool[]> isnull(new bool[width]);
+    heap_tuples_.reserve(rows);
+    memtuples_.reserve(rows);
+    for (int row = 0; row < rows; ++row) {
+      for (int i = 0; i < width; ++i) {
+        // Keep the first column non-null so that every row has a key
+        isnull[i] = i > 0 && mix.null_period > 0 &&
+            (row * 31 + i) % mix.null_period == 0;
+        values[i] = isnull[i] ? 0 : MakeValue(desc_->attrs[i], row, i);
+      }
+      heap_tuples_.push_back(
+          heap_form_tuple(desc_, values.data(), isnull.get()));
+      memtuples_.push_back(
+          memtuple_form_to(slot_->tts_mt_bind, values.data(), isnull.get(),
+                           nullptr, nullptr, false));
+    }
+  }
+
+  TupleDesc desc() const { return desc_; }
+  TupleTableSlot* slot() const { return slot_; }
+  int width() const { return width_; }
+  const char* mix_name() const { return mix_.name; }
+
+  /**
+   * @brief Store the given row in the scan slot as a heap tuple or memtuple.
+   **/
+  void StoreRow(int row, bool memtuple) const {
+    if (memtuple) {
+      ExecStoreMinimalTuple(memtuples_[row], slot_, false);
+    } else {
+      ExecStoreHeapTuple(heap_tuples_[row], slot_, InvalidBuffer, false);
+    }
+  }
+
+  /**
+   * @brief Attribute numbers of the first and the last int4 column.
+   **/
+  void Int4Columns(AttrNumber* first, AttrNumber* last) const {
+    *first = *last = InvalidAttrNumber;
+    for (int i = 0; i < width_; ++i) {
+      if (INT4OID == desc_->attrs[i]->atttypid) {
+        if (InvalidAttrNumber == *first) {
+          *first = i + 1;
+        }
+        *last = i + 1;
+      }
+    }
+  }
+
+ private:
+  static Datum MakeValue(Form_pg_attribute attr, int row, int col) {
+    int value = (row * 7 + col * 13) % 1000;
+    switch (attr->atttypid) {
+      case INT4OID:
+        return Int32GetDatum(value);
+      case INT8OID:
+        return Int64GetDatum(static_cast<int64>(value) << 20);
+      case FLOAT8OID:
+        return Float8GetDatum(value / 8.0);
+      case DATEOID:
+        return DateADTGetDatum(value);
+      case TEXTOID: {
+        char str[32];
+        int len = snprintf(str, sizeof(str), "value %d of row %d", col, row);
+        text* t = static_cast<text*>(palloc(len + VARHDRSZ));
+        SET_VARSIZE(t, len + VARHDRSZ);
+        memcpy(VARDATA(t), str, len);
+        return PointerGetDatum(t);
+      }
+      default:
+        return 0;
+    }
+  }
+
+  const TypeMix& mix_;
+  int width_;
+  TupleDesc desc_;
+  TupleTableSlot* slot_;
+  std::vector<HeapTuple> heap_tuples_;
+  std::vector<MemTuple> memtuples_;
+};
+
+/**
+ * @brief Creates a CodegenManager and makes it the active one for the
+ *        lifetime of the object, so that the generators built in its scope
+ *        are enrolled with it.
+ *
+ * @note Destroying the manager swaps the regular functions back in.
+ **/
+class CodegenSession {
+ public:
+  CodegenSession()
+      : manager_(CodeGeneratorManagerCreate("codegen_microbench")) {
+    SetActiveCodeGeneratorManager(manager_);
+  }
+
+  ~CodegenSession() {
+    SetActiveCodeGeneratorManager(nullptr);
+    CodeGeneratorManagerDestroy(manager_);
+  }
+
+  CodegenManager* manager() const {
+    return static_cast<CodegenManager*>(manager_);
+  }
+
+  /**
+   * @brief Generate and compile code for all the enrolled generators.
+   *
+   * @return true if at least one generator produced code.
+   **/
+  bool Compile(Timings* timings) {
+    auto start = std::chrono::steady_clock::now();
+    unsigned int generated = CodeGeneratorManagerGenerateCode(manager_);
+    timings->generation_ms = MillisecondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    unsigned int prepared =
+        CodeGeneratorManagerPrepareGeneratedFunctions(manager_);
+    timings->compilation_ms = MillisecondsSince(start);
+
+    return generated > 0 && prepared > 0;
+  }
+
+ private:
+  void* manager_;
+};
+
+/**
+ * @brief Exposes the slot deformation generated by SlotGetAttrCodegen
+ *        through a SlotGetAttrFn, so that it can be called on its own.
+ *
+ * SlotGetAttrCodegen only generates code as a dependency of other generators,
+ * so this wrapper plays the part of such a generator.
+ **/
+class SlotGetAttrBenchCodegen : public BaseCodegen<SlotGetAttrFn> {
+ public:
+  SlotGetAttrBenchCodegen(CodegenManager* manager,
+                          SlotGetAttrFn regular_func_ptr,
+                          SlotGetAttrFn* ptr_to_chosen_func_ptr,
+                          TupleTableSlot* slot,
+                          int max_attr)
+      : BaseCodegen(manager,
+                    kSlotGetAttrBenchPrefix,
+                    regular_func_ptr,
+                    ptr_to_chosen_func_ptr),
+        slot_(slot),
+        max_attr_(max_attr),
+        slot_getattr_codegen_(nullptr) {
+  }
+
+  bool InitDependencies() override {
+    slot_getattr_codegen_ =
+        SlotGetAttrCodegen::GetCodegenInstance(manager(), slot_, max_attr_);
+    return true;
+  }
+
+ protected:
+  bool GenerateCodeInternal(gpcodegen::GpCodegenUtils* codegen_utils) final {
+    if (nullptr == slot_getattr_codegen_ ||
+        !slot_getattr_codegen_->GenerateCode(codegen_utils)) {
+      return false;
+    }
+    llvm::Function* llvm_function =
+        CreateFunction<SlotGetAttrFn>(codegen_utils, GetUniqueFuncName());
+    auto irb = codegen_utils->ir_builder();
+    irb->SetInsertPoint(
+        codegen_utils->CreateBasicBlock("entry", llvm_function));
+    irb->CreateRet(irb->CreateCall(
+        slot_getattr_codegen_->GetGeneratedFunction(), {
+            ArgumentByPosition(llvm_function, 0),
+            ArgumentByPosition(llvm_function, 1),
+            ArgumentByPosition(llvm_function, 2)}));
+    return true;
+  }
+
+ private:
+  TupleTableSlot* slot_;
+  int max_attr_;
+  SlotGetAttrCodegen* slot_getattr_codegen_;
+
+  static constexpr char kSlotGetAttrBenchPrefix[] = "slot_getattr_bench";
+};
+
+constexpr char SlotGetAttrBenchCodegen::kSlotGetAttrBenchPrefix[];
+
+/**
+ * @brief Build the scan state that generated expressions read their
+ *        variables from.
+ **/
+TableScanState* MakeScanState(const Table& table, ExprContext* econtext) {
+  TableScanState* scanstate = MakeNode<TableScanState>(T_TableScanState);
+  scanstate->ss.ss_ScanTupleSlot = table.slot();
+  scanstate->ss.ps.ps_ExprContext = econtext;
+  return scanstate;
+}
+
+/**
+ * @brief Build a projection of all the columns of the table.
+ **/
+ProjectionInfo* MakeVariableList(const Table& table, ExprContext* econtext,
+                                 PlanState* parent) {
+  List* tlist = NIL;
+  for (int i = 0; i < table.width(); ++i) {
+    Form_pg_attribute attr = table.desc()->attrs[i];
+    tlist = lappend(tlist, makeTargetEntry(
+        reinterpret_cast<Expr*>(makeVar(1, i + 1, attr->atttypid, -1, 0)),
+        i + 1, nullptr, false));
+  }
+  TupleTableSlot* result_slot = MakeSingleTupleTableSlot(table.desc());
+  return ExecBuildProjectionInfo(
+      reinterpret_cast<List*>(ExecInitExpr(
+          reinterpret_cast<Expr*>(tlist), parent)),
+      econtext, result_slot, table.desc());
+}
+
+Timings BenchSlotGetAttr(const Options& options, const Table& table,
+                         bool memtuple) {
+  Timings timings;
+  TupleTableSlot* slot = table.slot();
+  int width = table.width();
+  std::vector<Datum> expected(width);
+  std::unique_ptr<bool[]> expected_isnull(new bool[width]);
+
+  auto fetch_all = [&](SlotGetAttrFn fn, int row) {
+    table.StoreRow(row, memtuple);
+    bool isnull;
+    for (int attnum = 1; attnum <= width; ++attnum) {
+      fn(slot, attnum, &isnull);
+    }
+  };
+  timings.regular_ns_per_row = NsPerRow(options, [&](int row) {
+    fetch_all(slot_getattr_regular, row);
+  });
+
+  CodegenSession session;
+  SlotGetAttrFn fn = slot_getattr_regular;
+  SlotGetAttrBenchCodegen* generator = new SlotGetAttrBenchCodegen(
+      session.manager(), slot_getattr_regular, &fn, slot, width);
+  session.manager()->EnrollCodeGenerator(
+      CodegenFuncLifespan_Parameter_Invariant, generator);
+  if (!session.Compile(&timings) || fn == slot_getattr_regular) {
+    return timings;
+  }
+  timings.generated = true;
+
+  for (int row = 0; row < options.rows && timings.matches; ++row) {
+    table.StoreRow(row, memtuple);
+    for (int attnum = 1; attnum <= width; ++attnum) {
+      bool isnull;
+      expected[attnum - 1] = slot_getattr_regular(slot, attnum, &isnull);
+      expected_isnull[attnum - 1] = isnull;
+    }
+    table.StoreRow(row, memtuple);
+    for (int attnum = 1; attnum <= width; ++attnum) {
+      bool isnull;
+      Datum value = fn(slot, attnum, &isnull);
+      if (isnull != expected_isnull[attnum - 1] ||
+          (!isnull && value != expected[attnum - 1])) {
+        timings.matches = false;
+      }
+    }
+  }
+
+  timings.generated_ns_per_row = NsPerRow(options, [&](int row) {
+    fetch_all(fn, row);
+  });
+  return timings;
+}
+
+Timings BenchExecVariableList(const Options& options, const Table& table,
+                              bool memtuple) {
+  Timings timings;
+  int width = table.width();
+  ExprContext* econtext = CreateStandaloneExprContext();
+  econtext->ecxt_scantuple = table.slot();
+  TableScanState* scanstate = MakeScanState(table, econtext);
+  ProjectionInfo* proj_info =
+      MakeVariableList(table, econtext, &scanstate->ss.ps);
+  std::vector<Datum> values(width);
+  std::unique_ptr<bool[]> isnull(new bool[width]);
+  std::vector<Datum> expected(width);
+  std::unique_ptr<bool[]> expected_isnull(new bool[width]);
+
+  timings.regular_ns_per_row = NsPerRow(options, [&](int row) {
+    table.StoreRow(row, memtuple);
+    ExecVariableList(proj_info, values.data(), isnull.get());
+  });
+
+  CodegenSession session;
+  ExecVariableListFn fn = ExecVariableList;
+  ExecVariableListCodegenEnroll(ExecVariableList, &fn, proj_info,
+                                table.slot());
+  if (!session.Compile(&timings) || fn == ExecVariableList) {
+    return timings;
+  }
+  timings.generated = true;
+
+  for (int row = 0; row < options.rows && timings.matches; ++row) {
+    table.StoreRow(row, memtuple);
+    ExecVariableList(proj_info, expected.data(), expected_isnull.get());
+    table.StoreRow(row, memtuple);
+    fn(proj_info, values.data(), isnull.get());
+    for (int i = 0; i < width; ++i) {
+      if (isnull[i] != expected_isnull[i] ||
+          (!isnull[i] && values[i] != expected[i])) {
+        timings.matches = false;
+      }
+    }
+  }
+
+  timings.generated_ns_per_row = NsPerRow(options, [&](int row) {
+    table.StoreRow(row, memtuple);
+    fn(proj_info, values.data(), isnull.get());
+  });
+  return timings;
+}
+
+Timings BenchExecEvalExpr(const Options& options, const Table& table,
+                          bool memtuple) {
+  Timings timings;
+  AttrNumber first, last;
+  table.Int4Columns(&first, &last);
+
+  // (first_int4 + last_int4) <= 1000
+  Expr* plus = make_opclause(
+      kInt4PlusOperator, INT4OID, false,
+      reinterpret_cast<Expr*>(makeVar(1, first, INT4OID, -1, 0)),
+      reinterpret_cast<Expr*>(makeVar(1, last, INT4OID, -1, 0)));
+  reinterpret_cast<OpExpr*>(plus)->opfuncid = F_INT4PL;
+  Expr* less_equal = make_opclause(
+      kInt4LessEqualOperator, BOOLOID, false, plus,
+      reinterpret_cast<Expr*>(makeConst(INT4OID, -1, 4, Int32GetDatum(1000),
+                                        false, true)));
+  reinterpret_cast<OpExpr*>(less_equal)->opfuncid = F_INT4LE;
+
+  ExprContext* econtext = CreateStandaloneExprContext();
+  econtext->ecxt_scantuple = table.slot();
+  TableScanState* scanstate = MakeScanState(table, econtext);
+  ExprState* exprstate = ExecInitExpr(less_equal, &scanstate->ss.ps);
+
+  bool isnull;
+  // The first evaluation initializes the function caches and swaps in the
+  // evaluation function used from then on
+  table.StoreRow(0, memtuple);
+  ExecEvalExpr(exprstate, econtext, &isnull, nullptr);
+
+  timings.regular_ns_per_row = NsPerRow(options, [&](int row) {
+    table.StoreRow(row, memtuple);
+    ExecEvalExpr(exprstate, econtext, &isnull, nullptr);
+  });
+
+  CodegenSession session;
+  // ExprState declares evalfunc with ExprDoneCond, which the codegen wrapper
+  // only knows as tmp_enum
+  ExecEvalExprFn* evalfunc =
+      reinterpret_cast<ExecEvalExprFn*>(&exprstate->evalfunc);
+  ExecEvalExprFn regular = *evalfunc;
+  ExecEvalExprCodegenEnroll(regular, evalfunc, exprstate, econtext,
+                            &scanstate->ss.ps);
+  if (!session.Compile(&timings) || *evalfunc == regular) {
+    return timings;
+  }
+  timings.generated = true;
+  ExecEvalExprFn fn = *evalfunc;
+
+  for (int row = 0; row < options.rows && timings.matches; ++row) {
+    bool expected_isnull;
+    table.StoreRow(row, memtuple);
+    Datum expected = regular(exprstate, econtext, &expected_isnull, nullptr);
+    table.StoreRow(row, memtuple);
+    Datum value = fn(exprstate, econtext, &isnull, nullptr);
+    if (isnull != expected_isnull ||
+        (!isnull && DatumGetBool(value) != DatumGetBool(expected))) {
+      timings.matches = false;
+    }
+  }
+
+  timings.generated_ns_per_row = NsPerRow(options, [&](int row) {
+    table.StoreRow(row, memtuple);
+    fn(exprstate, econtext, &isnull, nullptr);
+  });
+  return timings;
+}
+
+/**
+ * @brief Set up a transition state as ExecInitAgg() would for the given
+ *        aggregate, whose arguments are read from the scan tuple.
+ **/
+void InitPerAgg(AggStatePerAgg peragg, ExprContext* econtext, Oid aggfnoid,
+                Oid transfn_oid, Datum init_value, bool init_value_is_null,
+                List* args) {
+  Aggref* aggref = MakeNode<Aggref>(T_Aggref);
+  aggref->aggfnoid = aggfnoid;
+  aggref->aggtype = INT8OID;
+  aggref->args = args;
+  aggref->aggstar = NIL == args;
+  aggref->location = -1;
+
+  peragg->aggref = aggref;
+  peragg->numArguments = peragg->numInputs = list_length(args);
+  peragg->transfn_oid = transfn_oid;
+  fmgr_info(transfn_oid, &peragg->transfn);
+  peragg->initValue = init_value;
+  peragg->initValueIsNull = init_value_is_null;
+  peragg->transtypeLen = sizeof(int64);
+  peragg->transtypeByVal = true;
+
+  List* tlist = NIL;
+  peragg->evaldesc = CreateTemplateTupleDesc(list_length(args), false);
+  int resno = 1;
+  ListCell* lc;
+  foreach(lc, args) {
+    Form_pg_attribute attr = peragg->evaldesc->attrs[resno - 1];
+    attr->attnum = resno;
+    attr->atttypid = INT4OID;
+    attr->attlen = 4;
+    attr->attbyval = true;
+    attr->attalign = 'i';
+    attr->atttypmod = -1;
+    attr->attcacheoff = -1;
+    tlist = lappend(tlist, makeTargetEntry(
+        static_cast<Expr*>(lfirst(lc)), resno++, nullptr, false));
+  }
+  peragg->evalslot = MakeSingleTupleTableSlot(peragg->evaldesc);
+  peragg->evalproj = ExecBuildProjectionInfo(
+      reinterpret_cast<List*>(ExecInitExpr(
+          reinterpret_cast<Expr*>(tlist), nullptr)),
+      econtext, peragg->evalslot, nullptr);
+}
+
+void InitPerGroup(AggState* aggstate, AggStatePerGroup pergroup) {
+  for (int aggno = 0; aggno < aggstate->numaggs; ++aggno) {
+    pergroup[aggno].transValue = aggstate->peragg[aggno].initValue;
+    pergroup[aggno].transValueIsNull =
+        aggstate->peragg[aggno].initValueIsNull;
+    pergroup[aggno].noTransValue = aggstate->peragg[aggno].initValueIsNull;
+  }
+}
+
+Timings BenchAdvanceAggregates(const Options& options, const Table& table,
+                               bool memtuple) {
+  Timings timings;
+  AttrNumber first, last;
+  table.Int4Columns(&first, &last);
+
+  ExprContext* econtext = CreateStandaloneExprContext();
+  econtext->ecxt_scantuple = table.slot();
+
+  // sum(first_int4), count(*)
+  AggState* aggstate = MakeNode<AggState>(T_AggState);
+  aggstate->numaggs = 2;
+  aggstate->peragg =
+      static_cast<AggStatePerAgg>(palloc0(2 * sizeof(AggStatePerAggData)));
+  aggstate->tmpcontext = econtext;
+  InitPerAgg(&aggstate->peragg[0], econtext, kSumInt4Aggregate, F_INT4_SUM,
+             0, true, list_make1(makeVar(1, first, INT4OID, -1, 0)));
+  InitPerAgg(&aggstate->peragg[1], econtext, kCountStarAggregate, F_INT8INC,
+             Int64GetDatum(0), false, NIL);
+
+  AggStatePerGroupData pergroup[2];
+  AggStatePerGroupData expected[2];
+  auto advance = [&](AdvanceAggregatesFn fn, AggStatePerGroup groups,
+                     int row) {
+    table.StoreRow(row, memtuple);
+    fn(aggstate, groups, &aggstate->mem_manager);
+    ResetExprContext(econtext);
+  };
+
+  InitPerGroup(aggstate, pergroup);
+  timings.regular_ns_per_row = NsPerRow(options, [&](int row) {
+    advance(advance_aggregates, pergroup, row);
+  });
+
+  CodegenSession session;
+  AdvanceAggregatesFn fn = advance_aggregates;
+  AdvanceAggregatesCodegenEnroll(advance_aggregates, &fn, aggstate);
+  if (!session.Compile(&timings) || fn == advance_aggregates) {
+    return timings;
+  }
+  timings.generated = true;
+
+  InitPerGroup(aggstate, expected);
+  InitPerGroup(aggstate, pergroup);
+  for (int row = 0; row < options.rows; ++row) {
+    advance(advance_aggregates, expected, row);
+    advance(fn, pergroup, row);
+  }
+  for (int aggno = 0; aggno < aggstate->numaggs; ++aggno) {
+    if (pergroup[aggno].transValueIsNull !=
+            expected[aggno].transValueIsNull ||
+        pergroup[aggno].transValue != expected[aggno].transValue) {
+      timings.matches = false;
+    }
+  }
+
+  InitPerGroup(aggstate, pergroup);
+  timings.generated_ns_per_row = NsPerRow(options, [&](int row) {
+    advance(fn, pergroup, row);
+  });
+  return timings;
+}
+
+typedef Timings (*BenchFn)(const Options& options, const Table& table,
+                           bool memtuple);
+
+struct Benchmark {
+  const char* name;
+  BenchFn fn;
+};
+
+void Report(const Benchmark& benchmark, const Table& table, bool memtuple,
+            const Timings& timings) {
+  printf("%-20s %-9s %-6s %5d %12.1f ", benchmark.name,
+         memtuple ? "memtuple" : "heap", table.mix_name(), table.width(),
+         timings.regular_ns_per_row);
+  if (timings.generated) {
+    printf("%12.1f %8.2fx %10.2f %10.2f%s\n",
+           timings.generated_ns_per_row,
+           timings.regular_ns_per_row / timings.generated_ns_per_row,
+           timings.generation_ms, timings.compilation_ms,
+           timings.matches ? "" : "  MISMATCH");
+  } else {
+    printf("%12s %9s %10.2f %10.2f\n", "n/a", "-",
+           timings.generation_ms, timings.compilation_ms);
+  }
+  fflush(stdout);
+}
+
+bool ParseOptions(int argc, char** argv, Options* options) {
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (i + 1 < argc && "--rows" == arg) {
+      options->rows = atoi(argv[++i]);
+    } else if (i + 1 < argc && "--repeat" == arg) {
+      options->repeat = atoi(argv[++i]);
+    } else if (i + 1 < argc && "--filter" == arg) {
+      options->filter = argv[++i];
+    } else {
+      return false;
+    }
+  }
+  return options->rows > 0 && options->repeat > 0;
+}
+
+void InitBackend() {
+  MemoryContextInit();
+  // Allows function lookups to pass permission checks without a catalog
+  SetUserIdAndSecContext(BOOTSTRAP_SUPERUSERID, 0);
+
+  codegen = true;
+  codegen_validate_functions = false;
+  codegen_exec_variable_list = true;
+  codegen_slot_getattr = true;
+  codegen_exec_eval_expr = true;
+  codegen_advance_aggregate = true;
+  codegen_background_compile = false;
+  codegen_optimization_level = CODEGEN_OPTIMIZATION_LEVEL_DEFAULT;
+  // Measure compilation every time instead of reusing cached modules
+  codegen_cache_size = 0;
+  codegen_saving_per_row = 0;
+  InitCodegen();
+}
+
+}  // namespace
+}  // namespace gpcodegen
+
+int main(int argc, char** argv) {
+  using gpcodegen::Benchmark;
+
+  gpcodegen::Options options;
+  if (!gpcodegen::ParseOptions(argc, argv, &options)) {
+    fprintf(stderr,
+            "usage: %s [--rows N] [--repeat N] [--filter STRING]\n", argv[0]);
+    return 1;
+  }
+  gpcodegen::InitBackend();
+
+  const gpcodegen::TypeMix mixes[] = {
+    {"int4", {gpcodegen::kInt4Column}, 0},
+    {"mixed", {gpcodegen::kInt4Column, gpcodegen::kInt8Column,
+               gpcodegen::kFloat8Column, gpcodegen::kDateColumn,
+               gpcodegen::kTextColumn}, 11},
+  };
+  const int widths[] = {5, 20, 100};
+  const Benchmark benchmarks[] = {
+    {"slot_getattr", gpcodegen::BenchSlotGetAttr},
+    {"ExecVariableList", gpcodegen::BenchExecVariableList},
+    {"ExecEvalExpr", gpcodegen::BenchExecEvalExpr},
+    {"advance_aggregates", gpcodegen::BenchAdvanceAggregates},
+  };
+
+  printf("%d rows, best of %d runs\n", options.rows, options.repeat);
+  printf("%-20s %-9s %-6s %5s %12s %12s %9s %10s %10s\n", "benchmark",
+         "storage", "mix", "width", "regular ns", "generated ns", "speedup",
+         "gen ms", "compile ms");
+
+  int mismatches = 0;
+  for (const gpcodegen::TypeMix& mix : mixes) {
+    for (int width : widths) {
+      MemoryContext table_context = AllocSetContextCreate(
+          TopMemoryContext, "codegen_microbench",
+          ALLOCSET_DEFAULT_MINSIZE,
+          ALLOCSET_DEFAULT_INITSIZE,
+          ALLOCSET_DEFAULT_MAXSIZE);
+      MemoryContext old_context = MemoryContextSwitchTo(table_context);
+      gpcodegen::Table table(mix, width, options.rows);
+      for (const Benchmark& benchmark : benchmarks) {
+        std::string name = std::string(benchmark.name) + "/" + mix.name +
+            "/" + std::to_string(width);
+        if (name.find(options.filter) == std::string::npos) {
+          continue;
+        }
+        for (bool memtuple : {false, true}) {
+          gpcodegen::Timings timings = benchmark.fn(options, table, memtuple);
+          gpcodegen::Report(benchmark, table, memtuple, timings);
+          mismatches += timings.matches ? 0 : 1;
+        }
+      }
+      MemoryContextSwitchTo(old_context);
+      MemoryContextDelete(table_context);
+    }
+  }
+  return 0 == mismatches ? 0 : 1;
+}
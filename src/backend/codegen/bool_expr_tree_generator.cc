@@ -0,0 +1,202 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    bool_expr_tree_generator.cc
+//
+//  @doc:
+//    Object that generate code for AND, OR and NOT expression.
+//
+//---------------------------------------------------------------------------
+
+#include <assert.h>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "codegen/bool_expr_tree_generator.h"
+#include "codegen/expr_tree_generator.h"
+#include "codegen/utils/gp_codegen_utils.h"
+
+#include "llvm/IR/IRBuilder.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#include "nodes/execnodes.h"
+#include "nodes/nodes.h"
+#include "nodes/pg_list.h"
+#include "nodes/primnodes.h"
+#include "utils/elog.h"
+}
+
+using gpcodegen::BoolExprTreeGenerator;
+using gpcodegen::ExprTreeGenerator;
+using gpcodegen::GpCodegenUtils;
+
+BoolExprTreeGenerator::BoolExprTreeGenerator(
+    const ExprState* expr_state,
+    std::vector<
+        std::unique_ptr<ExprTreeGenerator>>&& arguments)  // NOLINT(build/c++11)
+    : ExprTreeGenerator(expr_state, ExprTreeNodeType::kBool),
+      arguments_(std::move(arguments)) {
+}
+
+bool BoolExprTreeGenerator::VerifyAndCreateExprTree(
+    const ExprState* expr_state,
+    ExprTreeGeneratorInfo* gen_info,
+    std::unique_ptr<ExprTreeGenerator>* expr_tree) {
+  assert(nullptr != expr_state &&
+         nullptr != expr_state->expr &&
+         T_BoolExpr == nodeTag(expr_state->expr) &&
+         nullptr != expr_tree);
+
+  expr_tree->reset(nullptr);
+  BoolExpr* bool_expr = reinterpret_cast<BoolExpr*>(expr_state->expr);
+  List* arguments = reinterpret_cast<const BoolExprState*>(expr_state)->args;
+  if (NOT_EXPR == bool_expr->boolop && 1 != list_length(arguments)) {
+    elog(DEBUG1, "NOT expression expects one argument.");
+    return false;
+  }
+
+  ListCell* arg = nullptr;
+  std::vector<std::unique_ptr<ExprTreeGenerator>> expr_tree_arguments;
+  foreach(arg, arguments) {
+    // retrieve argument's ExprState
+    ExprState* argstate = reinterpret_cast<ExprState*>(lfirst(arg));
+    assert(nullptr != argstate);
+    std::unique_ptr<ExprTreeGenerator> arg_tree(nullptr);
+    if (!ExprTreeGenerator::VerifyAndCreateExprTree(argstate,
+                                                    gen_info,
+                                                    &arg_tree)) {
+      return false;
+    }
+    assert(nullptr != arg_tree);
+    expr_tree_arguments.push_back(std::move(arg_tree));
+  }
+  expr_tree->reset(new BoolExprTreeGenerator(expr_state,
+                                             std::move(expr_tree_arguments)));
+  return true;
+}
+
+bool BoolExprTreeGenerator::AppendFingerprint(std::string* fingerprint) const {
+  BoolExpr* bool_expr = reinterpret_cast<BoolExpr*>(expr_state()->expr);
+  fingerprint->append("B");
+  fingerprint->append(std::to_string(bool_expr->boolop));
+  fingerprint->append("(");
+  for (const std::unique_ptr<ExprTreeGenerator>& arg : arguments_) {
+    if (!arg->AppendFingerprint(fingerprint)) {
+      return false;
+    }
+    fingerprint->append(",");
+  }
+  fingerprint->append(")");
+  return true;
+}
+
+bool BoolExprTreeGenerator::GenerateCode(GpCodegenUtils* codegen_utils,
+                                         const ExprTreeGeneratorInfo& gen_info,
+                                         llvm::Value** llvm_out_value,
+                                         llvm::Value* const llvm_isnull_ptr) {
+  assert(nullptr != llvm_out_value);
+  assert(nullptr != llvm_isnull_ptr);
+  *llvm_out_value = nullptr;
+  BoolExpr* bool_expr = reinterpret_cast<BoolExpr*>(expr_state()->expr);
+
+  switch (bool_expr->boolop) {
+    case AND_EXPR:
+      return GenerateAndOrCode(codegen_utils, gen_info, true,
+                               llvm_out_value, llvm_isnull_ptr);
+    case OR_EXPR:
+      return GenerateAndOrCode(codegen_utils, gen_info, false,
+                               llvm_out_value, llvm_isnull_ptr);
+    case NOT_EXPR: {
+      assert(1 == arguments_.size());
+      auto irb = codegen_utils->ir_builder();
+      llvm::Value* llvm_arg = nullptr;
+      // NOT of NULL is NULL, so the nullity of the argument is the result's
+      if (!arguments_[0]->GenerateCode(codegen_utils, gen_info,
+                                       &llvm_arg, llvm_isnull_ptr)) {
+        return false;
+      }
+      *llvm_out_value = codegen_utils->CreateCppTypeToDatumCast(
+          irb->CreateNot(
+              codegen_utils->CreateDatumToCppTypeCast<bool>(llvm_arg)));
+      return true;
+    }
+    default:
+      elog(DEBUG1, "Unsupported boolean expression %d.", bool_expr->boolop);
+      return false;
+  }
+}
+
+bool BoolExprTreeGenerator::GenerateAndOrCode(
+    GpCodegenUtils* codegen_utils,
+    const ExprTreeGeneratorInfo& gen_info,
+    bool is_and,
+    llvm::Value** llvm_out_value,
+    llvm::Value* const llvm_isnull_ptr) {
+  auto irb = codegen_utils->ir_builder();
+
+  // Block reached as soon as an argument decides the result, i.e. it is
+  // false for AND or true for OR
+  llvm::BasicBlock* llvm_short_circuit_block = codegen_utils->CreateBasicBlock(
+      "bool_short_circuit_block", gen_info.llvm_main_func);
+  llvm::BasicBlock* llvm_done_block = codegen_utils->CreateBasicBlock(
+      "bool_done_block", gen_info.llvm_main_func);
+
+  llvm::Value* llvm_any_null_ptr = codegen_utils->CreateEntryBlockAlloca(
+      codegen_utils->GetType<bool>(), "anyNull");
+  irb->CreateStore(codegen_utils->GetConstant<bool>(false),
+                   llvm_any_null_ptr);
+  llvm::Value* llvm_arg_isnull_ptr = codegen_utils->CreateEntryBlockAlloca(
+      codegen_utils->GetType<bool>(), "isNull");
+
+  for (std::unique_ptr<ExprTreeGenerator>& arg : arguments_) {
+    irb->CreateStore(codegen_utils->GetConstant<bool>(false),
+                     llvm_arg_isnull_ptr);
+    llvm::Value* llvm_arg = nullptr;
+    if (!arg->GenerateCode(codegen_utils, gen_info,
+                           &llvm_arg, llvm_arg_isnull_ptr)) {
+      return false;
+    }
+    llvm::Value* llvm_arg_isnull = irb->CreateLoad(llvm_arg_isnull_ptr);
+    irb->CreateStore(
+        irb->CreateOr(irb->CreateLoad(llvm_any_null_ptr), llvm_arg_isnull),
+        llvm_any_null_ptr);
+
+    llvm::Value* llvm_arg_value =
+        codegen_utils->CreateDatumToCppTypeCast<bool>(llvm_arg);
+    if (is_and) {
+      llvm_arg_value = irb->CreateNot(llvm_arg_value);
+    }
+    llvm::BasicBlock* llvm_next_arg_block = codegen_utils->CreateBasicBlock(
+        "bool_next_arg_block", gen_info.llvm_main_func);
+    irb->CreateCondBr(
+        irb->CreateAnd(irb->CreateNot(llvm_arg_isnull), llvm_arg_value),
+        llvm_short_circuit_block /* true */,
+        llvm_next_arg_block /* false */);
+    irb->SetInsertPoint(llvm_next_arg_block);
+  }
+
+  // No argument decided the result: it is NULL if any argument was NULL, and
+  // true for AND or false for OR otherwise.
+  irb->CreateStore(irb->CreateLoad(llvm_any_null_ptr), llvm_isnull_ptr);
+  llvm::BasicBlock* llvm_all_args_block = irb->GetInsertBlock();
+  irb->CreateBr(llvm_done_block);
+
+  irb->SetInsertPoint(llvm_short_circuit_block);
+  irb->CreateStore(codegen_utils->GetConstant<bool>(false), llvm_isnull_ptr);
+  irb->CreateBr(llvm_done_block);
+
+  irb->SetInsertPoint(llvm_done_block);
+  llvm::PHINode* llvm_result = irb->CreatePHI(
+      codegen_utils->GetType<bool>(), 2);
+  llvm_result->addIncoming(codegen_utils->GetConstant<bool>(is_and),
+                           llvm_all_args_block);
+  llvm_result->addIncoming(codegen_utils->GetConstant<bool>(!is_and),
+                           llvm_short_circuit_block);
+  *llvm_out_value = codegen_utils->CreateCppTypeToDatumCast(llvm_result);
+  return true;
+}
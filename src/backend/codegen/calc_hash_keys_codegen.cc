@@ -0,0 +1,169 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    calc_hash_keys_codegen.cc
+//
+//  @doc:
+//    Generates code for calc_hash_keys function.
+//
+//---------------------------------------------------------------------------
+#include <assert.h>
+#include <cstdint>
+#include <string>
+
+#include "codegen/calc_hash_keys_codegen.h"
+#include "codegen/pg_hash_func_generator.h"
+#include "codegen/utils/gp_codegen_utils.h"
+#include "codegen/utils/utility.h"
+
+#include "llvm/IR/IRBuilder.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#include "executor/execHHashagg.h"
+#include "nodes/execnodes.h"
+#include "nodes/plannodes.h"
+#include "utils/elog.h"
+}
+
+namespace llvm {
+class BasicBlock;
+class Function;
+class Value;
+}  // namespace llvm
+
+using gpcodegen::CalcHashKeysCodegen;
+using gpcodegen::PGHashFuncGenerator;
+
+constexpr char CalcHashKeysCodegen::kCalcHashKeysPrefix[];
+
+CalcHashKeysCodegen::CalcHashKeysCodegen(
+    CodegenManager* manager,
+    CalcHashKeysFn regular_func_ptr,
+    CalcHashKeysFn* ptr_to_regular_func_ptr,
+    AggState* aggstate)
+    : BaseCodegen(manager,
+                  kCalcHashKeysPrefix,
+                  regular_func_ptr, ptr_to_regular_func_ptr),
+      aggstate_(aggstate) {
+}
+
+bool CalcHashKeysCodegen::AppendFingerprint(std::string* fingerprint) const {
+  if (nullptr == aggstate_ || nullptr == aggstate_->hashfunctions) {
+    return false;
+  }
+  Agg* agg = reinterpret_cast<Agg*>(aggstate_->ss.ps.plan);
+  fingerprint->append(std::to_string(agg->numCols));
+  for (int i = 0; i < agg->numCols; i++) {
+    fingerprint->append(",");
+    fingerprint->append(std::to_string(agg->grpColIdx[i]));
+    fingerprint->append(":");
+    fingerprint->append(std::to_string(aggstate_->hashfunctions[i].fn_oid));
+  }
+  return true;
+}
+
+bool CalcHashKeysCodegen::GenerateCalcHashKeys(
+    gpcodegen::GpCodegenUtils* codegen_utils) {
+  assert(nullptr != codegen_utils);
+  if (nullptr == aggstate_ || nullptr == aggstate_->hashfunctions) {
+    return false;
+  }
+  Agg* agg = reinterpret_cast<Agg*>(aggstate_->ss.ps.plan);
+
+  auto irb = codegen_utils->ir_builder();
+
+  llvm::Function* calc_hash_keys_func = CreateFunction<CalcHashKeysFn>(
+      codegen_utils, GetUniqueFuncName());
+
+  // External functions
+  llvm::Function* llvm_slot_getattr =
+      codegen_utils->GetOrRegisterExternalFunction(slot_getattr_regular,
+                                                   "slot_getattr_regular");
+
+  // Function arguments to calc_hash_keys
+  llvm::Value* llvm_aggstate_arg = ArgumentByPosition(calc_hash_keys_func, 0);
+  llvm::Value* llvm_inputslot_arg = ArgumentByPosition(calc_hash_keys_func, 1);
+
+  llvm::BasicBlock* entry_block = codegen_utils->CreateBasicBlock(
+      "entry_block", calc_hash_keys_func);
+
+  // entry block
+  // ----------
+  irb->SetInsertPoint(entry_block);
+
+#ifdef CODEGEN_DEBUG
+  EXPAND_CREATE_ELOG(codegen_utils, DEBUG1,
+                     "Codegen'ed calc_hash_keys called!");
+#endif
+
+  // The hash table is created after code generation, so we read it from the
+  // aggstate at run time
+  llvm::Value* llvm_hashtable = irb->CreateLoad(
+      codegen_utils->GetPointerToMember(llvm_aggstate_arg,
+                                        &AggState::hhashtable));
+  llvm::Value* llvm_hashkey_buf = irb->CreateLoad(
+      codegen_utils->GetPointerToMember(llvm_hashtable,
+                                        &HashAggTable::hashkey_buf));
+  llvm::Value* llvm_isnull_ptr = irb->CreateAlloca(
+      codegen_utils->GetType<bool>(), nullptr, "isnull");
+
+  for (int i = 0; i < agg->numCols; i++) {
+    llvm::BasicBlock* hash_block = codegen_utils->CreateBasicBlock(
+        "hash_block_" + std::to_string(i), calc_hash_keys_func);
+    llvm::BasicBlock* hash_null_block = codegen_utils->CreateBasicBlock(
+        "hash_null_block_" + std::to_string(i), calc_hash_keys_func);
+    llvm::BasicBlock* next_col_block = codegen_utils->CreateBasicBlock(
+        "next_col_block_" + std::to_string(i), calc_hash_keys_func);
+
+    llvm::Value* llvm_hashkey_ptr = irb->CreateInBoundsGEP(
+        llvm_hashkey_buf, codegen_utils->GetConstant<int32_t>(i));
+
+    // Datum value = slot_getattr(inputslot, att, &isnull);
+    irb->CreateStore(codegen_utils->GetConstant<bool>(false), llvm_isnull_ptr);
+    llvm::Value* llvm_value = irb->CreateCall(llvm_slot_getattr, {
+        llvm_inputslot_arg,
+        codegen_utils->GetConstant<int>(agg->grpColIdx[i]),
+        llvm_isnull_ptr});
+    irb->CreateCondBr(irb->CreateLoad(llvm_isnull_ptr),
+                      hash_null_block /* true */,
+                      hash_block /* false */);
+
+    // hashtable->hashkey_buf[i] = DatumGetUInt32(FunctionCall1(info, value));
+    irb->SetInsertPoint(hash_block);
+    llvm::Value* llvm_hashkey = nullptr;
+    if (!PGHashFuncGenerator::GenerateHashFunction(
+        codegen_utils, aggstate_->hashfunctions[i].fn_oid,
+        llvm_value, &llvm_hashkey)) {
+      return false;
+    }
+    irb->CreateStore(llvm_hashkey, llvm_hashkey_ptr);
+    irb->CreateBr(next_col_block);
+
+    // Treat nulls as having hash key 0xdeadbeef
+    irb->SetInsertPoint(hash_null_block);
+    irb->CreateStore(codegen_utils->GetConstant<HashKey>(0xdeadbeef),
+                     llvm_hashkey_ptr);
+    irb->CreateBr(next_col_block);
+
+    irb->SetInsertPoint(next_col_block);
+  }
+  irb->CreateRetVoid();
+
+  return true;
+}
+
+bool CalcHashKeysCodegen::GenerateCodeInternal(
+    GpCodegenUtils* codegen_utils) {
+  bool isGenerated = GenerateCalcHashKeys(codegen_utils);
+
+  if (isGenerated) {
+    elog(DEBUG1, "calc_hash_keys was generated successfully!");
+    return true;
+  } else {
+    elog(DEBUG1, "calc_hash_keys generation failed!");
+    return false;
+  }
+}
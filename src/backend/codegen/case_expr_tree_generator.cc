@@ -0,0 +1,192 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    case_expr_tree_generator.cc
+//
+//  @doc:
+//    Object that generate code for CASE expression.
+//
+//---------------------------------------------------------------------------
+
+#include <assert.h>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "codegen/case_expr_tree_generator.h"
+#include "codegen/expr_tree_generator.h"
+#include "codegen/utils/gp_codegen_utils.h"
+
+#include "llvm/IR/IRBuilder.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#include "nodes/execnodes.h"
+#include "nodes/nodes.h"
+#include "nodes/pg_list.h"
+#include "nodes/primnodes.h"
+#include "utils/elog.h"
+}
+
+using gpcodegen::CaseExprTreeGenerator;
+using gpcodegen::ExprTreeGenerator;
+using gpcodegen::GpCodegenUtils;
+
+CaseExprTreeGenerator::CaseExprTreeGenerator(
+    const ExprState* expr_state,
+    std::vector<WhenClause>&& when_clauses,  // NOLINT(build/c++11)
+    std::unique_ptr<ExprTreeGenerator> default_result)
+    : ExprTreeGenerator(expr_state, ExprTreeNodeType::kCase),
+      when_clauses_(std::move(when_clauses)),
+      default_result_(std::move(default_result)) {
+}
+
+bool CaseExprTreeGenerator::VerifyAndCreateExprTree(
+    const ExprState* expr_state,
+    ExprTreeGeneratorInfo* gen_info,
+    std::unique_ptr<ExprTreeGenerator>* expr_tree) {
+  assert(nullptr != expr_state &&
+         nullptr != expr_state->expr &&
+         T_CaseExpr == nodeTag(expr_state->expr) &&
+         nullptr != expr_tree);
+
+  expr_tree->reset(nullptr);
+  const CaseExprState* case_state =
+      reinterpret_cast<const CaseExprState*>(expr_state);
+  if (nullptr != case_state->arg) {
+    // The WHEN values are compared against the argument through a
+    // CaseTestExpr, which reads the argument from the ExprContext.
+    elog(DEBUG1, "CASE expression with an argument is not supported.");
+    return false;
+  }
+
+  ListCell* cell = nullptr;
+  std::vector<WhenClause> when_clauses;
+  foreach(cell, case_state->args) {
+    CaseWhenState* when_state = reinterpret_cast<CaseWhenState*>(lfirst(cell));
+    assert(nullptr != when_state &&
+           nullptr != when_state->expr &&
+           nullptr != when_state->result);
+    WhenClause when_clause;
+    if (!ExprTreeGenerator::VerifyAndCreateExprTree(when_state->expr,
+                                                    gen_info,
+                                                    &when_clause.first) ||
+        !ExprTreeGenerator::VerifyAndCreateExprTree(when_state->result,
+                                                    gen_info,
+                                                    &when_clause.second)) {
+      return false;
+    }
+    when_clauses.push_back(std::move(when_clause));
+  }
+
+  std::unique_ptr<ExprTreeGenerator> default_result(nullptr);
+  if (nullptr != case_state->defresult &&
+      !ExprTreeGenerator::VerifyAndCreateExprTree(case_state->defresult,
+                                                  gen_info,
+                                                  &default_result)) {
+    return false;
+  }
+  expr_tree->reset(new CaseExprTreeGenerator(expr_state,
+                                             std::move(when_clauses),
+                                             std::move(default_result)));
+  return true;
+}
+
+bool CaseExprTreeGenerator::AppendFingerprint(std::string* fingerprint) const {
+  fingerprint->append("W(");
+  for (const WhenClause& when_clause : when_clauses_) {
+    if (!when_clause.first->AppendFingerprint(fingerprint)) {
+      return false;
+    }
+    fingerprint->append(":");
+    if (!when_clause.second->AppendFingerprint(fingerprint)) {
+      return false;
+    }
+    fingerprint->append(",");
+  }
+  fingerprint->append("E:");
+  if (nullptr != default_result_ &&
+      !default_result_->AppendFingerprint(fingerprint)) {
+    return false;
+  }
+  fingerprint->append(")");
+  return true;
+}
+
+bool CaseExprTreeGenerator::GenerateCode(GpCodegenUtils* codegen_utils,
+                                         const ExprTreeGeneratorInfo& gen_info,
+                                         llvm::Value** llvm_out_value,
+                                         llvm::Value* const llvm_isnull_ptr) {
+  assert(nullptr != llvm_out_value);
+  assert(nullptr != llvm_isnull_ptr);
+  *llvm_out_value = nullptr;
+  auto irb = codegen_utils->ir_builder();
+
+  llvm::BasicBlock* llvm_done_block = codegen_utils->CreateBasicBlock(
+      "case_done_block", gen_info.llvm_main_func);
+  // Result of each branch along with the last block of the branch
+  std::vector<std::pair<llvm::Value*, llvm::BasicBlock*>> llvm_results;
+
+  llvm::Value* llvm_cond_isnull_ptr = codegen_utils->CreateEntryBlockAlloca(
+      codegen_utils->GetType<bool>(), "isNull");
+  for (WhenClause& when_clause : when_clauses_) {
+    irb->CreateStore(codegen_utils->GetConstant<bool>(false),
+                     llvm_cond_isnull_ptr);
+    llvm::Value* llvm_cond = nullptr;
+    if (!when_clause.first->GenerateCode(codegen_utils, gen_info,
+                                         &llvm_cond, llvm_cond_isnull_ptr)) {
+      return false;
+    }
+    // A NULL condition is treated as false, like in ExecEvalCase()
+    llvm::Value* llvm_cond_is_true = irb->CreateAnd(
+        irb->CreateNot(irb->CreateLoad(llvm_cond_isnull_ptr)),
+        codegen_utils->CreateDatumToCppTypeCast<bool>(llvm_cond));
+
+    llvm::BasicBlock* llvm_then_block = codegen_utils->CreateBasicBlock(
+        "case_then_block", gen_info.llvm_main_func);
+    llvm::BasicBlock* llvm_next_when_block = codegen_utils->CreateBasicBlock(
+        "case_next_when_block", gen_info.llvm_main_func);
+    irb->CreateCondBr(llvm_cond_is_true,
+                      llvm_then_block /* true */,
+                      llvm_next_when_block /* false */);
+
+    irb->SetInsertPoint(llvm_then_block);
+    llvm::Value* llvm_result = nullptr;
+    if (!when_clause.second->GenerateCode(codegen_utils, gen_info,
+                                          &llvm_result, llvm_isnull_ptr)) {
+      return false;
+    }
+    llvm_results.push_back(std::make_pair(llvm_result, irb->GetInsertBlock()));
+    irb->CreateBr(llvm_done_block);
+
+    irb->SetInsertPoint(llvm_next_when_block);
+  }
+
+  // No WHEN clause matched
+  llvm::Value* llvm_default_result = nullptr;
+  if (nullptr == default_result_) {
+    irb->CreateStore(codegen_utils->GetConstant<bool>(true), llvm_isnull_ptr);
+    llvm_default_result = codegen_utils->GetConstant<Datum>(0);
+  } else if (!default_result_->GenerateCode(codegen_utils, gen_info,
+                                            &llvm_default_result,
+                                            llvm_isnull_ptr)) {
+    return false;
+  }
+  llvm_results.push_back(std::make_pair(llvm_default_result,
+                                        irb->GetInsertBlock()));
+  irb->CreateBr(llvm_done_block);
+
+  irb->SetInsertPoint(llvm_done_block);
+  llvm::PHINode* llvm_out_value_phinode = irb->CreatePHI(
+      codegen_utils->GetType<Datum>(), llvm_results.size());
+  for (const std::pair<llvm::Value*, llvm::BasicBlock*>& llvm_result :
+      llvm_results) {
+    llvm_out_value_phinode->addIncoming(llvm_result.first,
+                                        llvm_result.second);
+  }
+  *llvm_out_value = llvm_out_value_phinode;
+  return true;
+}
@@ -0,0 +1,125 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    codegen_cache.cc
+//
+//  @doc:
+//    Implementation of the backend-local cache of compiled modules
+//
+//---------------------------------------------------------------------------
+#include <assert.h>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "codegen/codegen_cache.h"
+#include "codegen/codegen_config.h"
+#include "codegen/utils/gp_codegen_utils.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#include "utils/elog.h"
+}
+
+using gpcodegen::CodegenCache;
+
+CodegenCache::CodegenCache()
+    : hits_(0),
+      misses_(0),
+      evictions_(0),
+      size_(0) {
+}
+
+CodegenCache* CodegenCache::GetInstance() {
+  // Intentionally never destroyed: LLVM may already be torn down by the time
+  // static destructors run at backend exit.
+  static CodegenCache* instance = new CodegenCache();
+  return instance;
+}
+
+size_t CodegenCache::MaxSize() {
+  return static_cast<size_t>(codegen_cache_size) * 1024L;
+}
+
+CodegenCache::Entry* CodegenCache::Acquire(const std::string& key,
+                                           const GpCodegenUtils& source) {
+  auto it = index_.find(key);
+  if (it == index_.end() || it->second->in_use ||
+      !it->second->codegen_utils->RebindConstants(source)) {
+    misses_++;
+    return nullptr;
+  }
+  hits_++;
+  // Move to the front of the LRU list
+  entries_.splice(entries_.begin(), entries_, it->second);
+  Entry* entry = &entries_.front();
+  entry->in_use = true;
+  return entry;
+}
+
+CodegenCache::Entry* CodegenCache::Insert(
+    const std::string& key,
+    const std::vector<std::string>& func_names,
+    std::unique_ptr<GpCodegenUtils>* codegen_utils) {
+  assert(nullptr != codegen_utils && nullptr != codegen_utils->get());
+  size_t entry_size = (*codegen_utils)->GetCompiledCodeSize();
+  size_t max_size = MaxSize();
+
+  if (index_.find(key) != index_.end() || entry_size > max_size) {
+    return nullptr;
+  }
+  // Make room for the new entry; entries in use cannot be evicted, in which
+  // case the cache temporarily exceeds its budget.
+  EvictTo(max_size - entry_size);
+
+  entries_.push_front(Entry());
+  Entry* entry = &entries_.front();
+  entry->key = key;
+  entry->codegen_utils = std::move(*codegen_utils);
+  entry->func_names = func_names;
+  entry->size = entry_size;
+  entry->in_use = true;
+  index_.insert(std::make_pair(key, entries_.begin()));
+  size_ += entry_size;
+  elog(DEBUG2, "codegen cache: admitted module of %lu bytes (%lu entries, "
+       "%lu bytes)",
+       static_cast<unsigned long>(entry_size),  // NOLINT(runtime/int)
+       static_cast<unsigned long>(entries_.size()),  // NOLINT(runtime/int)
+       static_cast<unsigned long>(size_));  // NOLINT(runtime/int)
+  return entry;
+}
+
+void CodegenCache::Release(Entry* entry) {
+  assert(nullptr != entry && entry->in_use);
+  entry->in_use = false;
+  EvictTo(MaxSize());
+}
+
+size_t CodegenCache::ReleaseAll() {
+  size_t released = 0;
+  for (Entry& entry : entries_) {
+    if (entry.in_use) {
+      entry.in_use = false;
+      released++;
+    }
+  }
+  EvictTo(MaxSize());
+  return released;
+}
+
+void CodegenCache::EvictTo(size_t max_size) {
+  auto it = entries_.end();
+  while (size_ > max_size && it != entries_.begin()) {
+    --it;
+    if (it->in_use) {
+      continue;
+    }
+    size_ -= it->size;
+    evictions_++;
+    index_.erase(it->key);
+    it = entries_.erase(it);
+  }
+}
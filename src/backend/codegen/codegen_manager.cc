@@ -10,13 +10,21 @@
 //
 //---------------------------------------------------------------------------
 #include <assert.h>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdio>
 #include <iosfwd>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
 #include <string>
+#include <system_error>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "llvm/Support/raw_ostream.h"
 
+#include "codegen/codegen_cache.h"
 #include "codegen/codegen_interface.h"
 #include "codegen/codegen_manager.h"
 #include "codegen/codegen_wrapper.h"
@@ -26,15 +34,111 @@
 extern "C" {
 #include "postgres.h"  // NOLINT(build/include)
 #include "utils/guc.h"
+
+extern void gp_set_thread_sigmasks(void);
 }
 
 using gpcodegen::CodegenManager;
 
-CodegenManager::CodegenManager(const std::string& module_name) {
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// Weight of the latest measurement in the learned compilation costs
+constexpr double kCompileCostLearningRate = 0.25;
+
+double ElapsedMs(const Clock::time_point& start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+// Learned cost in milliseconds of generating and compiling each kind of
+// function, keyed by original function name. Like the CodegenCache, it lives
+// in the backend only.
+std::unordered_map<std::string, double>* LearnedCompileCosts() {
+  static std::unordered_map<std::string, double>* costs =
+      new std::unordered_map<std::string, double>();
+  return costs;
+}
+
+}  // namespace
+
+struct CodegenManager::BackgroundCompilation {
+  // Joined by the manager before it tears down the generators and module
+  std::thread thread;
+  // Protects everything below once the thread is started
+  std::mutex mutex;
+  // Set by the manager when it no longer wants the generated functions
+  bool cancelled;
+  // Set by the thread when it is done with the module
+  bool finished;
+  unsigned int success_count;
+  std::unique_ptr<gpcodegen::GpCodegenUtils> codegen_utils;
+  // Enrolled generators, owned by the manager
+  std::vector<CodegenInterface*> generators;
+  std::vector<std::string> func_names;
+  std::string fingerprint;
+  // Set if the manager already optimized the module
+  bool optimized;
+  // Times measured by the thread; see CodegenManager::GeneratorStatistics
+  double optimization_ms;
+  double compilation_ms;
+  std::vector<double> generator_compilation_ms;
+};
+
+CodegenManager::CodegenManager(const std::string& module_name)
+    : estimated_rows_(-1),
+      optimization_ms_(0),
+      compilation_ms_(0),
+      module_optimized_(false),
+      cache_entry_(nullptr) {
   module_name_ = module_name;
   codegen_utils_.reset(new gpcodegen::GpCodegenUtils(module_name));
 }
 
+CodegenManager::~CodegenManager() {
+  // Stop a background compilation from touching the generators, and wait
+  // for the thread so that it never outlives the module it compiles. If it
+  // got to the end, the compiled module may still be useful to later queries.
+  std::unique_ptr<gpcodegen::GpCodegenUtils> compiled_utils;
+  if (nullptr != background_compilation_) {
+    {
+      std::lock_guard<std::mutex> lock(background_compilation_->mutex);
+      background_compilation_->cancelled = true;
+    }
+    if (background_compilation_->thread.joinable()) {
+      background_compilation_->thread.join();
+    }
+    if (CollectBackgroundStatistics()) {
+      LearnCompileCosts();
+    }
+    std::lock_guard<std::mutex> lock(background_compilation_->mutex);
+    if (background_compilation_->finished &&
+        background_compilation_->success_count > 0 &&
+        !background_compilation_->fingerprint.empty()) {
+      compiled_utils = std::move(background_compilation_->codegen_utils);
+    }
+  }
+
+  // Revert callers to the regular functions before giving up the lease on
+  // the cached module, which may then be evicted.
+  enrolled_code_generators_.clear();
+  if (nullptr != cache_entry_) {
+    CodegenCache::GetInstance()->Release(cache_entry_);
+  }
+
+  if (nullptr != compiled_utils) {
+    CodegenCache* cache = CodegenCache::GetInstance();
+    CodegenCache::Entry* entry = cache->Insert(
+        background_compilation_->fingerprint,
+        background_compilation_->func_names,
+        &compiled_utils);
+    if (nullptr != entry) {
+      cache->Release(entry);
+    }
+  }
+}
+
 bool CodegenManager::EnrollCodeGenerator(
     CodegenFuncLifespan funcLifespan, CodegenInterface* generator) {
   // Only CodegenFuncLifespan_Parameter_Invariant is supported as of now
@@ -51,11 +155,28 @@ unsigned int CodegenManager::GenerateCode() {
     // enrolled as we iterate to initialize dependencies.
     enrolled_code_generators_[i]->InitDependencies();
   }
-  // Then ask them to generate code
+  // Then ask the ones expected to pay off their compilation to generate code
+  generator_statistics_.assign(enrolled_code_generators_.size(),
+                               GeneratorStatistics());
+  bool check_cost = codegen_saving_per_row > 0 && estimated_rows_ >= 0;
+  double saving_ms = estimated_rows_ * codegen_saving_per_row / 1000;
   unsigned int success_count = 0;
-  for (std::unique_ptr<CodegenInterface>& generator :
-      enrolled_code_generators_) {
+  for (size_t i = 0; i < enrolled_code_generators_.size(); ++i) {
+    CodegenInterface* generator = enrolled_code_generators_[i].get();
+    GeneratorStatistics& statistics = generator_statistics_[i];
+    statistics.estimated_cost_ms = GetCompileCost(*generator);
+    statistics.admitted =
+        !check_cost || saving_ms >= statistics.estimated_cost_ms;
+    if (!statistics.admitted) {
+      elog(DEBUG1, "Skipping codegen for %s: estimated cost %.3f ms, "
+           "estimated saving %.3f ms",
+           generator->GetOrigFuncName().c_str(),
+           statistics.estimated_cost_ms, saving_ms);
+      continue;
+    }
+    Clock::time_point start = Clock::now();
     success_count += generator->GenerateCode(codegen_utils_.get());
+    statistics.generation_ms = ElapsedMs(start);
   }
   return success_count;
 }
@@ -77,23 +198,239 @@ unsigned int CodegenManager::PrepareGeneratedFunctions() {
   STATIC_ASSERT_OPTIMIZATION_LEVEL(kAggressive,
                                    CODEGEN_OPTIMIZATION_LEVEL_AGGRESSIVE);
 
-  // Call GpCodegenUtils to compile entire module
+  // Generators enrolled after GenerateCode() did not generate code
+  generator_statistics_.resize(enrolled_code_generators_.size());
+
+  std::string fingerprint;
+  bool use_cache = codegen_cache_size > 0 && ComputeFingerprint(&fingerprint);
+  if (use_cache) {
+    cache_entry_ = CodegenCache::GetInstance()->Acquire(fingerprint,
+                                                       *codegen_utils_);
+    if (nullptr != cache_entry_) {
+      assert(cache_entry_->func_names.size() ==
+             enrolled_code_generators_.size());
+      for (size_t i = 0; i < enrolled_code_generators_.size(); ++i) {
+        success_count += enrolled_code_generators_[i]->SetToGenerated(
+            cache_entry_->codegen_utils.get(), cache_entry_->func_names[i]);
+      }
+      return success_count;
+    }
+  }
+
+  if (codegen_background_compile &&
+      StartBackgroundCompilation(use_cache ? fingerprint : "")) {
+    return success_count;
+  }
+
+  // Optimize the IR as shown by EXPLAIN CODEGEN, then call GpCodegenUtils to
+  // compile entire module
+  OptimizeModule();
+
+  Clock::time_point start = Clock::now();
   bool compilation_status = codegen_utils_->PrepareForExecution(
       gpcodegen::GpCodegenUtils::OptimizationLevel(codegen_optimization_level),
       true);
+  compilation_ms_ = ElapsedMs(start);
 
   if (!compilation_status) {
     return success_count;
   }
 
   // On successful compilation, go through all generator and swap
-  // the pointer so compiled function get called
+  // the pointer so compiled function get called. MCJIT compiles the module
+  // when the first function pointer is requested.
   gpcodegen::GpCodegenUtils* codegen_utils = codegen_utils_.get();
+  for (size_t i = 0; i < enrolled_code_generators_.size(); ++i) {
+    start = Clock::now();
+    success_count +=
+        enrolled_code_generators_[i]->SetToGenerated(codegen_utils);
+    generator_statistics_[i].compilation_ms = ElapsedMs(start);
+    compilation_ms_ += generator_statistics_[i].compilation_ms;
+  }
+  if (success_count > 0) {
+    LearnCompileCosts();
+  }
+
+  // Functions are compiled lazily by SetToGenerated() above, so only now is
+  // the size of the module known.
+  if (use_cache) {
+    std::vector<std::string> func_names;
+    for (std::unique_ptr<CodegenInterface>& generator :
+        enrolled_code_generators_) {
+      func_names.push_back(
+          generator->IsGenerated() ? generator->GetUniqueFuncName() : "");
+    }
+    cache_entry_ = CodegenCache::GetInstance()->Insert(
+        fingerprint, func_names, &codegen_utils_);
+  }
+  return success_count;
+}
+
+bool CodegenManager::StartBackgroundCompilation(
+    const std::string& fingerprint) {
+  std::shared_ptr<BackgroundCompilation> state(new BackgroundCompilation());
+  state->cancelled = false;
+  state->finished = false;
+  state->success_count = 0;
+  state->fingerprint = fingerprint;
+  state->optimized = module_optimized_;
+  state->optimization_ms = optimization_ms_;
+  state->compilation_ms = 0;
+  state->generator_compilation_ms.assign(enrolled_code_generators_.size(), 0);
   for (std::unique_ptr<CodegenInterface>& generator :
       enrolled_code_generators_) {
-    success_count += generator->SetToGenerated(codegen_utils);
+    state->generators.push_back(generator.get());
+    state->func_names.push_back(
+        generator->IsGenerated() ? generator->GetUniqueFuncName() : "");
   }
-  return success_count;
+  state->codegen_utils = std::move(codegen_utils_);
+
+  try {
+    // The thread gets a plain pointer; the manager keeps the state alive
+    // until it has joined the thread.
+    state->thread = std::thread(CompileInBackground, state.get(),
+                                codegen_optimization_level);
+  } catch (const std::system_error& e) {
+    elog(DEBUG1, "Could not start background compilation: %s", e.what());
+    codegen_utils_ = std::move(state->codegen_utils);
+    return false;
+  }
+  background_compilation_ = state;
+  return true;
+}
+
+void CodegenManager::CompileInBackground(
+    BackgroundCompilation* state,
+    int optimization_level) {
+  // Signals are handled by the main thread only
+  gp_set_thread_sigmasks();
+
+  {
+    // Nothing to do if the query has already finished without us
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (state->cancelled) {
+      state->finished = true;
+      return;
+    }
+  }
+
+  // The module is private to this thread until finished is set, so compile
+  // it without holding the lock; the manager joins us before tearing down.
+  Clock::time_point start = Clock::now();
+  if (!state->optimized) {
+    state->codegen_utils->Optimize(
+        gpcodegen::GpCodegenUtils::OptimizationLevel(optimization_level),
+        gpcodegen::GpCodegenUtils::SizeLevel::kNormal,
+        false);
+  }
+  double optimization_ms = ElapsedMs(start);
+
+  start = Clock::now();
+  bool compiled = state->codegen_utils->PrepareForExecution(
+      gpcodegen::GpCodegenUtils::OptimizationLevel(optimization_level), true);
+  if (compiled) {
+    state->codegen_utils->FinalizeCompilation();
+  }
+  double compilation_ms = ElapsedMs(start);
+
+  std::lock_guard<std::mutex> lock(state->mutex);
+  state->finished = true;
+  if (!state->optimized) {
+    state->optimization_ms = optimization_ms;
+  }
+  state->compilation_ms = compilation_ms;
+  if (!compiled || state->cancelled) {
+    return;
+  }
+  for (size_t i = 0; i < state->generators.size(); ++i) {
+    start = Clock::now();
+    state->success_count +=
+        state->generators[i]->SetToGenerated(state->codegen_utils.get());
+    state->generator_compilation_ms[i] = ElapsedMs(start);
+    state->compilation_ms += state->generator_compilation_ms[i];
+  }
+}
+
+bool CodegenManager::CollectBackgroundStatistics() {
+  assert(nullptr != background_compilation_);
+  std::lock_guard<std::mutex> lock(background_compilation_->mutex);
+  if (!background_compilation_->finished) {
+    return false;
+  }
+  optimization_ms_ = background_compilation_->optimization_ms;
+  compilation_ms_ = background_compilation_->compilation_ms;
+  for (size_t i = 0; i < generator_statistics_.size() &&
+       i < background_compilation_->generator_compilation_ms.size(); ++i) {
+    generator_statistics_[i].compilation_ms =
+        background_compilation_->generator_compilation_ms[i];
+  }
+  return background_compilation_->success_count > 0;
+}
+
+double CodegenManager::GetCompileCost(const CodegenInterface& generator) {
+  std::unordered_map<std::string, double>* costs = LearnedCompileCosts();
+  auto it = costs->find(generator.GetOrigFuncName());
+  if (it == costs->end()) {
+    return codegen_compile_cost;
+  }
+  return it->second;
+}
+
+void CodegenManager::LearnCompileCosts() const {
+  size_t generated_count = 0;
+  for (const std::unique_ptr<CodegenInterface>& generator :
+      enrolled_code_generators_) {
+    generated_count += generator->IsGenerated();
+  }
+  if (0 == generated_count) {
+    return;
+  }
+  double module_share_ms =
+      (optimization_ms_ + compilation_ms_) / generated_count;
+
+  std::unordered_map<std::string, double>* costs = LearnedCompileCosts();
+  for (size_t i = 0; i < enrolled_code_generators_.size(); ++i) {
+    const CodegenInterface& generator = *enrolled_code_generators_[i];
+    if (!generator.IsGenerated()) {
+      continue;
+    }
+    double measured_ms =
+        generator_statistics_[i].generation_ms + module_share_ms;
+    auto it = costs->find(generator.GetOrigFuncName());
+    if (it == costs->end()) {
+      costs->insert(std::make_pair(generator.GetOrigFuncName(), measured_ms));
+    } else {
+      it->second += kCompileCostLearningRate * (measured_ms - it->second);
+    }
+  }
+}
+
+void CodegenManager::OptimizeModule() {
+  if (module_optimized_) {
+    return;
+  }
+  Clock::time_point start = Clock::now();
+  codegen_utils_->Optimize(
+      gpcodegen::GpCodegenUtils::OptimizationLevel(codegen_optimization_level),
+      gpcodegen::GpCodegenUtils::SizeLevel::kNormal,
+      false);
+  optimization_ms_ = ElapsedMs(start);
+  module_optimized_ = true;
+}
+
+bool CodegenManager::ComputeFingerprint(std::string* fingerprint) const {
+  assert(nullptr != fingerprint);
+  fingerprint->append(std::to_string(codegen_optimization_level));
+  for (const std::unique_ptr<CodegenInterface>& generator :
+      enrolled_code_generators_) {
+    fingerprint->append(";");
+    fingerprint->append(generator->GetOrigFuncName());
+    fingerprint->append(generator->IsGenerated() ? "+" : "-");
+    if (!generator->AppendFingerprint(fingerprint)) {
+      return false;
+    }
+  }
+  return true;
 }
 
 void CodegenManager::NotifyParameterChange() {
@@ -111,14 +448,57 @@ const std::string& CodegenManager::GetExplainString() {
   return explain_string_;
 }
 
+std::string CodegenManager::GetStatisticsString() {
+  const char* source = "compiled";
+  if (nullptr != cache_entry_ && nullptr != codegen_utils_) {
+    // On a cache hit the module generated by this manager is left unused,
+    // whereas a freshly compiled module is handed over to the cache.
+    source = "reused from cache";
+  } else if (nullptr != background_compilation_) {
+    // Times are left at zero until the helper thread is done
+    CollectBackgroundStatistics();
+    source = "compiled in background";
+  }
+
+  char buffer[256];
+  std::string statistics;
+  std::snprintf(buffer, sizeof(buffer),
+                "%s: estimated rows %.0f, %s, optimization %.3f ms, "
+                "MCJIT %.3f ms",
+                module_name_.c_str(), estimated_rows_, source,
+                optimization_ms_, compilation_ms_);
+  statistics.append(buffer);
+
+  for (size_t i = 0; i < enrolled_code_generators_.size() &&
+       i < generator_statistics_.size(); ++i) {
+    const CodegenInterface& generator = *enrolled_code_generators_[i];
+    const GeneratorStatistics& generator_statistics = generator_statistics_[i];
+    if (!generator_statistics.admitted && !generator.IsGenerated()) {
+      std::snprintf(buffer, sizeof(buffer),
+                    "\n  %s: skipped, estimated cost %.3f ms",
+                    generator.GetOrigFuncName().c_str(),
+                    generator_statistics.estimated_cost_ms);
+    } else {
+      std::snprintf(buffer, sizeof(buffer),
+                    "\n  %s: %s, IR generation %.3f ms, MCJIT %.3f ms, %s",
+                    generator.GetOrigFuncName().c_str(),
+                    generator.IsGenerated() ? "generated" : "not generated",
+                    generator_statistics.generation_ms,
+                    generator_statistics.compilation_ms,
+                    generator.IsUsingGenerated() ? "used" : "not used");
+    }
+    statistics.append(buffer);
+  }
+  return statistics;
+}
+
 void CodegenManager::AccumulateExplainString() {
   explain_string_.clear();
   // This is called only when EXPLAIN CODEGEN. Because we don't want to compile
   // at this time, we need to call CodegenUtils::Optimize to "optimize" LLVM IR.
-  codegen_utils_->Optimize(gpcodegen::CodegenUtils::OptimizationLevel(
-                               codegen_optimization_level),
-                           gpcodegen::CodegenUtils::SizeLevel::kNormal,
-                           false);
+  // With EXPLAIN ANALYZE CODEGEN, PrepareGeneratedFunctions() compiles the
+  // module optimized here without running the passes again.
+  OptimizeModule();
   llvm::raw_string_ostream out(explain_string_);
   codegen_utils_->PrintUnderlyingModules(out);
 }
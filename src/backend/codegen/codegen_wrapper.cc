@@ -15,41 +15,119 @@
 #include <assert.h>
 #include <string>
 #include <type_traits>
+#include <unordered_map>
+#include <vector>
 
 #include "codegen/codegen_config.h"
 #include "codegen/base_codegen.h"
+#include "codegen/codegen_cache.h"
 #include "codegen/codegen_manager.h"
 #include "codegen/exec_eval_expr_codegen.h"
 #include "codegen/exec_variable_list_codegen.h"
 #include "codegen/expr_tree_generator.h"
 #include "codegen/utils/gp_codegen_utils.h"
 #include "codegen/advance_aggregates_codegen.h"
+#include "codegen/calc_hash_keys_codegen.h"
+#include "codegen/exec_hash_get_hash_keys_codegen.h"
+#include "codegen/hash_motion_keys_codegen.h"
+#include "codegen/mk_compare_codegen.h"
 
 extern "C" {
 #include "lib/stringinfo.h"
 #include "postgres.h"  // NOLINT(build/include)
+#include "utils/resowner.h"
 }
 
+using gpcodegen::CodegenCache;
 using gpcodegen::CodegenManager;
 using gpcodegen::BaseCodegen;
 using gpcodegen::ExecVariableListCodegen;
 using gpcodegen::ExecEvalExprCodegen;
 using gpcodegen::AdvanceAggregatesCodegen;
+using gpcodegen::HashMotionKeysCodegen;
+using gpcodegen::CalcHashKeysCodegen;
+using gpcodegen::ExecHashGetHashKeysCodegen;
+using gpcodegen::MKCompareCodegen;
 
 // Current code generator manager that oversees all code generators
 static void* ActiveCodeGeneratorManager = nullptr;
 
+// Managers not destroyed yet, with the resource owner that was current when
+// each was created. A query that errors out or is cancelled never reaches
+// CodeGeneratorManagerDestroy() from ExecEndNode(), so its managers are
+// destroyed when its resource owner is released at abort: that stops their
+// background compilations before the plan state they write to is freed, and
+// gives back their leases on the CodegenCache.
+static std::unordered_map<CodegenManager*, ResourceOwner>* LiveManagers() {
+  static std::unordered_map<CodegenManager*, ResourceOwner>* managers =
+      new std::unordered_map<CodegenManager*, ResourceOwner>();
+  return managers;
+}
+
+static void CodegenResourceRelease(ResourceReleasePhase phase,
+                                   bool isCommit,
+                                   bool isTopLevel,
+                                   void* arg) {
+  // No query outlives its top-level transaction, so no lease on the cache
+  // should either. Return those that some missed cleanup left behind, so
+  // that they do not pin their entries for the life of the backend.
+  if (phase == RESOURCE_RELEASE_AFTER_LOCKS && isTopLevel &&
+      CurrentResourceOwner == TopTransactionResourceOwner) {
+    size_t released = CodegenCache::GetInstance()->ReleaseAll();
+    if (released > 0) {
+      elog(DEBUG1, "codegen cache: returned %lu leases at end of transaction",
+           static_cast<unsigned long>(released));  // NOLINT(runtime/int)
+    }
+    return;
+  }
+
+  if (isCommit || phase != RESOURCE_RELEASE_BEFORE_LOCKS) {
+    return;
+  }
+
+  std::unordered_map<CodegenManager*, ResourceOwner>* managers =
+      LiveManagers();
+  std::vector<CodegenManager*> aborted;
+  for (const auto& live : *managers) {
+    if (live.second == CurrentResourceOwner) {
+      aborted.push_back(live.first);
+    }
+  }
+  for (CodegenManager* manager : aborted) {
+    managers->erase(manager);
+    if (ActiveCodeGeneratorManager == manager) {
+      ActiveCodeGeneratorManager = nullptr;
+    }
+    delete manager;
+  }
+}
+
 // Perform global set-up tasks for code generation. Returns 0 on
 // success, nonzero on error.
 unsigned int InitCodegen() {
-  return gpcodegen::GpCodegenUtils::InitializeGlobal();
+  if (!gpcodegen::GpCodegenUtils::InitializeGlobal()) {
+    return 0;
+  }
+  RegisterResourceReleaseCallback(CodegenResourceRelease, nullptr);
+  return 1;
 }
 
 void* CodeGeneratorManagerCreate(const char* module_name) {
   if (!codegen) {
     return nullptr;
   }
-  return new CodegenManager(module_name);
+  CodegenManager* manager = new CodegenManager(module_name);
+  (*LiveManagers())[manager] = CurrentResourceOwner;
+  return manager;
+}
+
+void CodeGeneratorManagerSetEstimatedRows(void* manager,
+                                          double estimated_rows) {
+  if (!codegen) {
+    return;
+  }
+  assert(nullptr != manager);
+  static_cast<CodegenManager*>(manager)->SetEstimatedRows(estimated_rows);
 }
 
 unsigned int CodeGeneratorManagerGenerateCode(void* manager) {
@@ -91,7 +169,34 @@ char* CodeGeneratorManagerGetExplainString(void* manager) {
   return return_string->data;
 }
 
+char* CodeGeneratorManagerGetStatisticsString(void* manager) {
+  if (!codegen) {
+    return nullptr;
+  }
+  StringInfo return_string = makeStringInfo();
+  appendStringInfoString(
+      return_string,
+      static_cast<CodegenManager*>(manager)->GetStatisticsString().c_str());
+  return return_string->data;
+}
+
+char* CodeGeneratorCacheGetExplainString() {
+  CodegenCache* cache = CodegenCache::GetInstance();
+  StringInfo return_string = makeStringInfo();
+  appendStringInfo(
+      return_string,
+      "Codegen cache: %lu hits, %lu misses, %lu evictions, %lu entries (%luK)",
+      static_cast<unsigned long>(cache->hits()),  // NOLINT(runtime/int)
+      static_cast<unsigned long>(cache->misses()),  // NOLINT(runtime/int)
+      static_cast<unsigned long>(cache->evictions()),  // NOLINT(runtime/int)
+      static_cast<unsigned long>(cache->entry_count()),  // NOLINT(runtime/int)
+      static_cast<unsigned long>(  // NOLINT(runtime/int)
+          (cache->size() + 1023) / 1024));
+  return return_string->data;
+}
+
 void CodeGeneratorManagerDestroy(void* manager) {
+  LiveManagers()->erase(static_cast<CodegenManager*>(manager));
   delete (static_cast<CodegenManager*>(manager));
 }
 
@@ -173,3 +278,66 @@ void* AdvanceAggregatesCodegenEnroll(
   return generator;
 }
 
+void* HashMotionKeysCodegenEnroll(
+    HashMotionKeysFn regular_func_ptr,
+    HashMotionKeysFn* ptr_to_chosen_func_ptr,
+    MotionState *motionstate) {
+  CodegenManager* manager = static_cast<CodegenManager*>(
+      GetActiveCodeGeneratorManager());
+  HashMotionKeysCodegen* generator =
+      CodegenManager::CreateAndEnrollGenerator<HashMotionKeysCodegen>(
+          manager,
+          regular_func_ptr,
+          ptr_to_chosen_func_ptr,
+          motionstate);
+  return generator;
+}
+
+void* CalcHashKeysCodegenEnroll(
+    CalcHashKeysFn regular_func_ptr,
+    CalcHashKeysFn* ptr_to_chosen_func_ptr,
+    AggState *aggstate) {
+  CodegenManager* manager = static_cast<CodegenManager*>(
+      GetActiveCodeGeneratorManager());
+  CalcHashKeysCodegen* generator =
+      CodegenManager::CreateAndEnrollGenerator<CalcHashKeysCodegen>(
+          manager,
+          regular_func_ptr,
+          ptr_to_chosen_func_ptr,
+          aggstate);
+  return generator;
+}
+
+void* ExecHashGetHashKeysCodegenEnroll(
+    ExecHashGetHashKeysFn regular_func_ptr,
+    ExecHashGetHashKeysFn* ptr_to_chosen_func_ptr,
+    HashJoinState *hjstate,
+    bool outer_tuple) {
+  CodegenManager* manager = static_cast<CodegenManager*>(
+      GetActiveCodeGeneratorManager());
+  ExecHashGetHashKeysCodegen* generator =
+      CodegenManager::CreateAndEnrollGenerator<ExecHashGetHashKeysCodegen>(
+          manager,
+          regular_func_ptr,
+          ptr_to_chosen_func_ptr,
+          hjstate,
+          outer_tuple);
+  return generator;
+}
+
+void* MKCompareCodegenEnroll(
+    MKCompareFn regular_func_ptr,
+    MKCompareFn* ptr_to_chosen_func_ptr,
+    int num_keys,
+    Oid *sort_operators) {
+  CodegenManager* manager = static_cast<CodegenManager*>(
+      GetActiveCodeGeneratorManager());
+  MKCompareCodegen* generator =
+      CodegenManager::CreateAndEnrollGenerator<MKCompareCodegen>(
+          manager,
+          regular_func_ptr,
+          ptr_to_chosen_func_ptr,
+          num_keys,
+          sort_operators);
+  return generator;
+}
@@ -12,6 +12,7 @@
 
 #include <assert.h>
 #include <memory>
+#include <string>
 
 #include "codegen/const_expr_tree_generator.h"
 #include "codegen/expr_tree_generator.h"
@@ -50,6 +51,18 @@ ConstExprTreeGenerator::ConstExprTreeGenerator(const ExprState* expr_state) :
     ExprTreeGenerator(expr_state, ExprTreeNodeType::kConst) {
 }
 
+bool ConstExprTreeGenerator::AppendFingerprint(
+    std::string* fingerprint) const {
+  Const* const_expr = reinterpret_cast<Const*>(expr_state()->expr);
+  // The datum of a by-reference constant points into plan memory
+  if (!const_expr->constbyval) {
+    return false;
+  }
+  fingerprint->append(const_expr->constisnull ? "Cn" : "C");
+  fingerprint->append(std::to_string(const_expr->constvalue));
+  return true;
+}
+
 bool ConstExprTreeGenerator::GenerateCode(GpCodegenUtils* codegen_utils,
                                           const ExprTreeGeneratorInfo& gen_info,
                                           llvm::Value** llvm_out_value,
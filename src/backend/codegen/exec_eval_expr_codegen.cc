@@ -104,6 +104,19 @@ void ExecEvalExprCodegen::PrepareSlotGetAttr() {
   }
 }
 
+bool ExecEvalExprCodegen::AppendFingerprint(std::string* fingerprint) const {
+  assert(nullptr != plan_state_);
+  // The operator decides which slot_getattr() is generated, see
+  // PrepareSlotGetAttr()
+  fingerprint->append(std::to_string(nodeTag(plan_state_)));
+  fingerprint->append(":");
+  if (nullptr == expr_tree_generator_.get()) {
+    fingerprint->append("unsupported");
+    return true;
+  }
+  return expr_tree_generator_->AppendFingerprint(fingerprint);
+}
+
 bool ExecEvalExprCodegen::GenerateExecEvalExpr(
     gpcodegen::GpCodegenUtils* codegen_utils) {
 
@@ -0,0 +1,295 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    exec_hash_get_hash_keys_codegen.cc
+//
+//  @doc:
+//    Generates code for ExecHashGetHashKeys function.
+//
+//---------------------------------------------------------------------------
+#include <assert.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "codegen/exec_hash_get_hash_keys_codegen.h"
+#include "codegen/op_expr_tree_generator.h"
+#include "codegen/pg_hash_func_generator.h"
+#include "codegen/utils/gp_codegen_utils.h"
+#include "codegen/utils/utility.h"
+
+#include "llvm/IR/IRBuilder.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#include "nodes/execnodes.h"
+#include "nodes/pg_list.h"
+#include "utils/elog.h"
+#include "utils/lsyscache.h"
+}
+
+namespace llvm {
+class BasicBlock;
+class Function;
+class Value;
+}  // namespace llvm
+
+using gpcodegen::ExecHashGetHashKeysCodegen;
+using gpcodegen::PGHashFuncGenerator;
+
+constexpr char ExecHashGetHashKeysCodegen::kExecHashGetHashKeysPrefix[];
+
+namespace {
+
+// The outer keys are evaluated in the econtext of the hash join, the inner
+// keys in the econtext of its Hash node (see ExecHashGetHashValue callers).
+ExprContext* GetHashKeysExprContext(HashJoinState* hjstate,
+                                    bool outer_tuple) {
+  return outer_tuple ? hjstate->js.ps.ps_ExprContext :
+      innerPlanState(hjstate)->ps_ExprContext;
+}
+
+}  // namespace
+
+ExecHashGetHashKeysCodegen::ExecHashGetHashKeysCodegen(
+    CodegenManager* manager,
+    ExecHashGetHashKeysFn regular_func_ptr,
+    ExecHashGetHashKeysFn* ptr_to_regular_func_ptr,
+    HashJoinState* hjstate,
+    bool outer_tuple)
+    : BaseCodegen(manager,
+                  kExecHashGetHashKeysPrefix,
+                  regular_func_ptr, ptr_to_regular_func_ptr),
+      outer_tuple_(outer_tuple),
+      hashkeys_(outer_tuple ? hjstate->hj_OuterHashKeys :
+          reinterpret_cast<HashState*>(innerPlanState(hjstate))->hashkeys),
+      gen_info_(GetHashKeysExprContext(hjstate, outer_tuple),
+                nullptr, nullptr, nullptr, 0) {
+  ListCell* cell = nullptr;
+  foreach(cell, hjstate->hj_HashOperators) {
+    Oid hashop = lfirst_oid(cell);
+    Oid left_hashfn = InvalidOid;
+    Oid right_hashfn = InvalidOid;
+    if (!get_op_hash_functions(hashop, &left_hashfn, &right_hashfn)) {
+      // ExecHashTableCreate() will complain; leave the keys unsupported
+      hash_func_oids_.clear();
+      hash_strict_.clear();
+      break;
+    }
+    hash_func_oids_.push_back(outer_tuple ? left_hashfn : right_hashfn);
+    hash_strict_.push_back(op_strict(hashop));
+  }
+}
+
+bool ExecHashGetHashKeysCodegen::InitDependencies() {
+  OpExprTreeGenerator::InitializeSupportedFunction();
+  ListCell* cell = nullptr;
+  foreach(cell, hashkeys_) {
+    std::unique_ptr<ExprTreeGenerator> hash_key_tree(nullptr);
+    if (!ExprTreeGenerator::VerifyAndCreateExprTree(
+        reinterpret_cast<ExprState*>(lfirst(cell)),
+        &gen_info_,
+        &hash_key_tree)) {
+      hash_key_trees_.clear();
+      break;
+    }
+    hash_key_trees_.push_back(std::move(hash_key_tree));
+  }
+  return true;
+}
+
+bool ExecHashGetHashKeysCodegen::AppendFingerprint(
+    std::string* fingerprint) const {
+  if (hash_key_trees_.empty() ||
+      hash_key_trees_.size() != hash_func_oids_.size()) {
+    fingerprint->append("unsupported");
+    return true;
+  }
+  fingerprint->append(outer_tuple_ ? "outer;" : "inner;");
+  for (size_t i = 0; i < hash_key_trees_.size(); ++i) {
+    fingerprint->append(std::to_string(hash_func_oids_[i]));
+    fingerprint->append(hash_strict_[i] ? ",s," : ",n,");
+    if (!hash_key_trees_[i]->AppendFingerprint(fingerprint)) {
+      return false;
+    }
+    fingerprint->append(";");
+  }
+  return true;
+}
+
+bool ExecHashGetHashKeysCodegen::GenerateExecHashGetHashKeys(
+    gpcodegen::GpCodegenUtils* codegen_utils) {
+  assert(nullptr != codegen_utils);
+  if (hash_key_trees_.empty() ||
+      hash_key_trees_.size() != hash_func_oids_.size() ||
+      nullptr == gen_info_.econtext) {
+    return false;
+  }
+
+  auto irb = codegen_utils->ir_builder();
+
+  gen_info_.llvm_slot_getattr_func =
+      codegen_utils->GetOrRegisterExternalFunction(slot_getattr_regular,
+                                                   "slot_getattr_regular");
+
+  llvm::Function* exec_hash_get_hash_keys_func =
+      CreateFunction<ExecHashGetHashKeysFn>(codegen_utils,
+                                            GetUniqueFuncName());
+
+  // Function arguments to ExecHashGetHashKeys
+  llvm::Value* llvm_econtext_arg = ArgumentByPosition(
+      exec_hash_get_hash_keys_func, 1);
+  llvm::Value* llvm_keep_nulls_arg = ArgumentByPosition(
+      exec_hash_get_hash_keys_func, 4);
+  llvm::Value* llvm_hashvalue_arg = ArgumentByPosition(
+      exec_hash_get_hash_keys_func, 5);
+  llvm::Value* llvm_hashkeys_null_arg = ArgumentByPosition(
+      exec_hash_get_hash_keys_func, 6);
+
+  llvm::BasicBlock* entry_block = codegen_utils->CreateBasicBlock(
+      "entry_block", exec_hash_get_hash_keys_func);
+  llvm::BasicBlock* implementation_block = codegen_utils->CreateBasicBlock(
+      "implementation_block", exec_hash_get_hash_keys_func);
+  llvm::BasicBlock* error_econtext_block = codegen_utils->CreateBasicBlock(
+      "error_econtext_block", exec_hash_get_hash_keys_func);
+  llvm::BasicBlock* error_block = codegen_utils->CreateBasicBlock(
+      "error_block", exec_hash_get_hash_keys_func);
+
+  gen_info_.llvm_main_func = exec_hash_get_hash_keys_func;
+  gen_info_.llvm_error_block = error_block;
+
+  // Generation-time constants
+  llvm::Value* llvm_econtext =
+      codegen_utils->GetRebindableConstant(gen_info_.econtext);
+
+  // entry block
+  // ----------
+  irb->SetInsertPoint(entry_block);
+
+#ifdef CODEGEN_DEBUG
+  EXPAND_CREATE_ELOG(codegen_utils, DEBUG1,
+                     "Codegen'ed ExecHashGetHashKeys called!");
+#endif
+
+  // The hash key expressions read the tuple from the econtext given during
+  // code generation
+  irb->CreateCondBr(
+      irb->CreateICmpEQ(llvm_econtext, llvm_econtext_arg),
+      implementation_block /* true */,
+      error_econtext_block /* false */);
+
+  // implementation block
+  // ----------
+  irb->SetInsertPoint(implementation_block);
+
+  llvm::Value* llvm_isnull_ptr = irb->CreateAlloca(
+      codegen_utils->GetType<bool>(), nullptr, "isNull");
+  llvm::Value* llvm_hashkey_ptr = irb->CreateAlloca(
+      codegen_utils->GetType<uint32_t>(), nullptr, "hashkey");
+  llvm::Value* llvm_result_ptr = irb->CreateAlloca(
+      codegen_utils->GetType<bool>(), nullptr, "result");
+
+  // (*hashkeys_null) = true;
+  irb->CreateStore(codegen_utils->GetConstant<bool>(true),
+                   llvm_hashkeys_null_arg);
+  irb->CreateStore(codegen_utils->GetConstant<uint32_t>(0), llvm_hashkey_ptr);
+  irb->CreateStore(codegen_utils->GetConstant<bool>(true), llvm_result_ptr);
+
+  for (size_t i = 0; i < hash_key_trees_.size(); ++i) {
+    llvm::BasicBlock* not_null_block = codegen_utils->CreateBasicBlock(
+        "not_null_block_" + std::to_string(i), exec_hash_get_hash_keys_func);
+    llvm::BasicBlock* hash_block = codegen_utils->CreateBasicBlock(
+        "hash_block_" + std::to_string(i), exec_hash_get_hash_keys_func);
+    llvm::BasicBlock* null_block = codegen_utils->CreateBasicBlock(
+        "null_block_" + std::to_string(i), exec_hash_get_hash_keys_func);
+    llvm::BasicBlock* next_key_block = codegen_utils->CreateBasicBlock(
+        "next_key_block_" + std::to_string(i), exec_hash_get_hash_keys_func);
+
+    // hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
+    llvm::Value* llvm_hashkey = irb->CreateLoad(llvm_hashkey_ptr);
+    irb->CreateStore(
+        irb->CreateOr(
+            irb->CreateShl(llvm_hashkey, 1),
+            irb->CreateLShr(llvm_hashkey, 31)),
+        llvm_hashkey_ptr);
+
+    // keyval = ExecEvalExpr(keyexpr, econtext, &isNull, NULL);
+    irb->CreateStore(codegen_utils->GetConstant<bool>(false), llvm_isnull_ptr);
+    llvm::Value* llvm_keyval = nullptr;
+    if (!hash_key_trees_[i]->GenerateCode(codegen_utils, gen_info_,
+                                          &llvm_keyval, llvm_isnull_ptr)) {
+      return false;
+    }
+    llvm_keyval = codegen_utils->CreateCppTypeToDatumCast(llvm_keyval);
+    irb->CreateCondBr(irb->CreateLoad(llvm_isnull_ptr),
+                      null_block /* true */,
+                      not_null_block /* false */);
+
+    // *hashkeys_null = false; and hash only if the tuple is not rejected yet
+    irb->SetInsertPoint(not_null_block);
+    irb->CreateStore(codegen_utils->GetConstant<bool>(false),
+                     llvm_hashkeys_null_arg);
+    irb->CreateCondBr(irb->CreateLoad(llvm_result_ptr),
+                      hash_block /* true */,
+                      next_key_block /* false */);
+
+    // hashkey ^= DatumGetUInt32(FunctionCall1(&hashfunctions[i], keyval));
+    irb->SetInsertPoint(hash_block);
+    llvm::Value* llvm_hkey = nullptr;
+    if (!PGHashFuncGenerator::GenerateHashFunction(
+        codegen_utils, hash_func_oids_[i], llvm_keyval, &llvm_hkey)) {
+      return false;
+    }
+    irb->CreateStore(
+        irb->CreateXor(irb->CreateLoad(llvm_hashkey_ptr), llvm_hkey),
+        llvm_hashkey_ptr);
+    irb->CreateBr(next_key_block);
+
+    // if (hashtable->hashStrict[i] && !keep_nulls) result = false;
+    irb->SetInsertPoint(null_block);
+    if (hash_strict_[i]) {
+      irb->CreateStore(
+          irb->CreateAnd(irb->CreateLoad(llvm_result_ptr),
+                         llvm_keep_nulls_arg),
+          llvm_result_ptr);
+    }
+    irb->CreateBr(next_key_block);
+
+    irb->SetInsertPoint(next_key_block);
+  }
+
+  // *hashvalue = hashkey;
+  irb->CreateStore(irb->CreateLoad(llvm_hashkey_ptr), llvm_hashvalue_arg);
+  irb->CreateRet(irb->CreateLoad(llvm_result_ptr));
+
+  // Error econtext block
+  // ---------------
+  irb->SetInsertPoint(error_econtext_block);
+  EXPAND_CREATE_ELOG(codegen_utils, ERROR, "Codegened ExecHashGetHashKeys: "
+                     "use of different econtext.");
+  irb->CreateRet(codegen_utils->GetConstant<bool>(false));
+
+  // Error block
+  // ---------------
+  irb->SetInsertPoint(error_block);
+  // We error out during the evaluation of the expressions.
+  irb->CreateRet(codegen_utils->GetConstant<bool>(false));
+
+  return true;
+}
+
+bool ExecHashGetHashKeysCodegen::GenerateCodeInternal(
+    GpCodegenUtils* codegen_utils) {
+  bool isGenerated = GenerateExecHashGetHashKeys(codegen_utils);
+
+  if (isGenerated) {
+    elog(DEBUG1, "ExecHashGetHashKeys was generated successfully!");
+    return true;
+  } else {
+    elog(DEBUG1, "ExecHashGetHashKeys generation failed!");
+    return false;
+  }
+}
@@ -80,6 +80,24 @@ bool ExecVariableListCodegen::InitDependencies() {
   return true;
 }
 
+bool ExecVariableListCodegen::AppendFingerprint(
+    std::string* fingerprint) const {
+  int length = list_length(proj_info_->pi_targetlist);
+  fingerprint->append(std::to_string(max_attr_));
+  fingerprint->append("/");
+  fingerprint->append(std::to_string(slot_->tts_tupleDescriptor->natts));
+  fingerprint->append(nullptr == proj_info_->pi_varSlotOffsets ? "/-" : "/+");
+  for (int i = 0; i < length; i++) {
+    fingerprint->append(",");
+    fingerprint->append(std::to_string(proj_info_->pi_varNumbers[i]));
+    if (nullptr != proj_info_->pi_varSlotOffsets) {
+      fingerprint->append("@");
+      fingerprint->append(std::to_string(proj_info_->pi_varSlotOffsets[i]));
+    }
+  }
+  return true;
+}
+
 bool ExecVariableListCodegen::GenerateExecVariableList(
     gpcodegen::GpCodegenUtils* codegen_utils) {
   assert(nullptr != codegen_utils);
@@ -137,7 +155,7 @@ bool ExecVariableListCodegen::GenerateExecVariableList(
 
   // Generation-time constants
   llvm::Value* llvm_max_attr = codegen_utils->GetConstant(max_attr_);
-  llvm::Value* llvm_slot = codegen_utils->GetConstant(slot_);
+  llvm::Value* llvm_slot = codegen_utils->GetRebindableConstant(slot_);
 
   // Function arguments to ExecVariableList
   llvm::Value* llvm_projInfo_arg = ArgumentByPosition(exec_variable_list_func,
@@ -148,12 +166,15 @@ bool ExecVariableListCodegen::GenerateExecVariableList(
 
   // Generate slot_getattr for attributes all the way to max_attr
   llvm::Function* slot_getattr_func = nullptr;
+  // Whether slot_getattr() leaves memtuples in the slot undeformed
+  bool slot_getattr_is_regular = false;
   // If slot_getattr_codegen_ is not set or generation fails
   // we revert to use the external slot_getattr()
   if (nullptr == slot_getattr_codegen_ ||
       false == slot_getattr_codegen_->GenerateCode(codegen_utils)) {
     slot_getattr_func = codegen_utils->GetOrRegisterExternalFunction(
         slot_getattr_regular, "slot_getattr_regular");
+    slot_getattr_is_regular = true;
   } else {
     slot_getattr_func = slot_getattr_codegen_->GetGeneratedFunction();
     assert(nullptr != slot_getattr_func);
@@ -193,8 +214,19 @@ bool ExecVariableListCodegen::GenerateExecVariableList(
       irb->CreateLoad(codegen_utils->GetPointerToMember(
           llvm_econtext, &ExprContext::ecxt_scantuple));
 
+  llvm::Value* llvm_slot_check = irb->CreateICmpEQ(llvm_slot, llvm_slot_arg);
+  if (slot_getattr_is_regular) {
+    // The regular slot_getattr() does not deform memtuples into the slot, so
+    // leave those to ExecVariableList
+    llvm_slot_check = irb->CreateAnd(
+        llvm_slot_check,
+        irb->CreateICmpEQ(
+            irb->CreateLoad(codegen_utils->GetPointerToMember(
+                llvm_slot, &TupleTableSlot::PRIVATE_tts_memtuple)),
+            codegen_utils->GetConstant((MemTuple) NULL)));
+  }
   irb->CreateCondBr(
-      irb->CreateICmpEQ(llvm_slot, llvm_slot_arg),
+      llvm_slot_check,
       main_block /* true */,
       fallback_block /* false */);
 
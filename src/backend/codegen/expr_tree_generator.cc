@@ -12,8 +12,11 @@
 #include <cassert>
 #include <memory>
 
+#include "codegen/bool_expr_tree_generator.h"
+#include "codegen/case_expr_tree_generator.h"
 #include "codegen/const_expr_tree_generator.h"
 #include "codegen/expr_tree_generator.h"
+#include "codegen/null_test_expr_tree_generator.h"
 #include "codegen/op_expr_tree_generator.h"
 #include "codegen/var_expr_tree_generator.h"
 
@@ -35,6 +38,10 @@ bool ExprTreeGenerator::VerifyAndCreateExprTree(
          nullptr != expr_tree);
 
   if (!(IsA(expr_state, FuncExprState) ||
+      IsA(expr_state, BoolExprState) ||
+      IsA(expr_state, NullTestState) ||
+      IsA(expr_state, CaseExprState) ||
+      IsA(expr_state, GenericExprState) ||
       IsA(expr_state, ExprState))) {
     elog(DEBUG1, "Input expression state type (%d) is not supported",
          expr_state->type);
@@ -43,11 +50,35 @@ bool ExprTreeGenerator::VerifyAndCreateExprTree(
   expr_tree->reset(nullptr);
   bool supported_expr_tree = false;
   switch (nodeTag(expr_state->expr)) {
-    case T_OpExpr: {
+    case T_OpExpr:
+    case T_FuncExpr: {
       supported_expr_tree = OpExprTreeGenerator::VerifyAndCreateExprTree(
           expr_state, gen_info, expr_tree);
       break;
     }
+    case T_BoolExpr: {
+      supported_expr_tree = BoolExprTreeGenerator::VerifyAndCreateExprTree(
+          expr_state, gen_info, expr_tree);
+      break;
+    }
+    case T_NullTest: {
+      supported_expr_tree = NullTestExprTreeGenerator::VerifyAndCreateExprTree(
+          expr_state, gen_info, expr_tree);
+      break;
+    }
+    case T_CaseExpr: {
+      supported_expr_tree = CaseExprTreeGenerator::VerifyAndCreateExprTree(
+          expr_state, gen_info, expr_tree);
+      break;
+    }
+    case T_RelabelType: {
+      // Binary compatible coercion, e.g. of varchar to text, leaves the datum
+      // untouched; just generate code for its argument.
+      supported_expr_tree = ExprTreeGenerator::VerifyAndCreateExprTree(
+          reinterpret_cast<const GenericExprState*>(expr_state)->arg,
+          gen_info, expr_tree);
+      break;
+    }
     case T_Var: {
       supported_expr_tree = VarExprTreeGenerator::VerifyAndCreateExprTree(
           expr_state, gen_info, expr_tree);
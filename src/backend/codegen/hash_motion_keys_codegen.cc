@@ -0,0 +1,225 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    hash_motion_keys_codegen.cc
+//
+//  @doc:
+//    Generates code for hashMotionKeys function.
+//
+//---------------------------------------------------------------------------
+#include <assert.h>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "codegen/hash_motion_keys_codegen.h"
+#include "codegen/op_expr_tree_generator.h"
+#include "codegen/pg_hash_func_generator.h"
+#include "codegen/utils/gp_codegen_utils.h"
+#include "codegen/utils/utility.h"
+
+#include "llvm/IR/IRBuilder.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#include "nodes/execnodes.h"
+#include "nodes/pg_list.h"
+#include "nodes/plannodes.h"
+#include "utils/elog.h"
+}
+
+namespace llvm {
+class BasicBlock;
+class Function;
+class Value;
+}  // namespace llvm
+
+using gpcodegen::HashMotionKeysCodegen;
+using gpcodegen::PGHashFuncGenerator;
+
+constexpr char HashMotionKeysCodegen::kHashMotionKeysPrefix[];
+
+HashMotionKeysCodegen::HashMotionKeysCodegen(
+    CodegenManager* manager,
+    HashMotionKeysFn regular_func_ptr,
+    HashMotionKeysFn* ptr_to_regular_func_ptr,
+    MotionState* motionstate)
+    : BaseCodegen(manager,
+                  kHashMotionKeysPrefix,
+                  regular_func_ptr, ptr_to_regular_func_ptr),
+      motionstate_(motionstate),
+      gen_info_(motionstate->ps.ps_ExprContext, nullptr, nullptr, nullptr, 0) {
+}
+
+bool HashMotionKeysCodegen::InitDependencies() {
+  OpExprTreeGenerator::InitializeSupportedFunction();
+  ListCell* cell = nullptr;
+  foreach(cell, motionstate_->hashExpr) {
+    std::unique_ptr<ExprTreeGenerator> hash_key_tree(nullptr);
+    if (!ExprTreeGenerator::VerifyAndCreateExprTree(
+        reinterpret_cast<ExprState*>(lfirst(cell)),
+        &gen_info_,
+        &hash_key_tree)) {
+      hash_key_trees_.clear();
+      break;
+    }
+    hash_key_trees_.push_back(std::move(hash_key_tree));
+  }
+  return true;
+}
+
+bool HashMotionKeysCodegen::AppendFingerprint(
+    std::string* fingerprint) const {
+  if (hash_key_trees_.empty()) {
+    fingerprint->append("unsupported");
+    return true;
+  }
+  Motion* motion = reinterpret_cast<Motion*>(motionstate_->ps.plan);
+  ListCell* cell = nullptr;
+  foreach(cell, motion->hashDataTypes) {
+    fingerprint->append(std::to_string(lfirst_oid(cell)));
+    fingerprint->append(",");
+  }
+  for (const std::unique_ptr<ExprTreeGenerator>& tree : hash_key_trees_) {
+    if (!tree->AppendFingerprint(fingerprint)) {
+      return false;
+    }
+    fingerprint->append(";");
+  }
+  return true;
+}
+
+bool HashMotionKeysCodegen::GenerateHashMotionKeys(
+    gpcodegen::GpCodegenUtils* codegen_utils) {
+  assert(nullptr != codegen_utils);
+  Motion* motion = reinterpret_cast<Motion*>(motionstate_->ps.plan);
+  if (hash_key_trees_.empty() ||
+      hash_key_trees_.size() !=
+          static_cast<size_t>(list_length(motion->hashDataTypes)) ||
+      nullptr == gen_info_.econtext) {
+    return false;
+  }
+
+  auto irb = codegen_utils->ir_builder();
+
+  gen_info_.llvm_slot_getattr_func =
+      codegen_utils->GetOrRegisterExternalFunction(slot_getattr_regular,
+                                                   "slot_getattr_regular");
+
+  llvm::Function* hash_motion_keys_func = CreateFunction<HashMotionKeysFn>(
+      codegen_utils, GetUniqueFuncName());
+
+  // Function arguments to hashMotionKeys
+  llvm::Value* llvm_econtext_arg = ArgumentByPosition(
+      hash_motion_keys_func, 0);
+  llvm::Value* llvm_cdbhash_arg = ArgumentByPosition(
+      hash_motion_keys_func, 3);
+
+  llvm::BasicBlock* entry_block = codegen_utils->CreateBasicBlock(
+      "entry_block", hash_motion_keys_func);
+  llvm::BasicBlock* implementation_block = codegen_utils->CreateBasicBlock(
+      "implementation_block", hash_motion_keys_func);
+  llvm::BasicBlock* error_econtext_block = codegen_utils->CreateBasicBlock(
+      "error_econtext_block", hash_motion_keys_func);
+  llvm::BasicBlock* error_block = codegen_utils->CreateBasicBlock(
+      "error_block", hash_motion_keys_func);
+
+  gen_info_.llvm_main_func = hash_motion_keys_func;
+  gen_info_.llvm_error_block = error_block;
+
+  // Generation-time constants
+  llvm::Value* llvm_econtext =
+      codegen_utils->GetRebindableConstant(gen_info_.econtext);
+
+  // entry block
+  // ----------
+  irb->SetInsertPoint(entry_block);
+
+#ifdef CODEGEN_DEBUG
+  EXPAND_CREATE_ELOG(codegen_utils, DEBUG1,
+                     "Codegen'ed hashMotionKeys called!");
+#endif
+
+  // The hash key expressions read the tuple from the econtext given during
+  // code generation
+  irb->CreateCondBr(
+      irb->CreateICmpEQ(llvm_econtext, llvm_econtext_arg),
+      implementation_block /* true */,
+      error_econtext_block /* false */);
+
+  // implementation block
+  // ----------
+  irb->SetInsertPoint(implementation_block);
+
+  llvm::Value* llvm_isnull_ptr = irb->CreateAlloca(
+      codegen_utils->GetType<bool>(), nullptr, "isNull");
+
+  ListCell* type_cell = list_head(motion->hashDataTypes);
+  for (size_t i = 0; i < hash_key_trees_.size(); ++i) {
+    llvm::BasicBlock* hash_block = codegen_utils->CreateBasicBlock(
+        "hash_block_" + std::to_string(i), hash_motion_keys_func);
+    llvm::BasicBlock* hash_null_block = codegen_utils->CreateBasicBlock(
+        "hash_null_block_" + std::to_string(i), hash_motion_keys_func);
+    llvm::BasicBlock* next_key_block = codegen_utils->CreateBasicBlock(
+        "next_key_block_" + std::to_string(i), hash_motion_keys_func);
+
+    // keyval = ExecEvalExpr(keyexpr, econtext, &isNull, NULL);
+    irb->CreateStore(codegen_utils->GetConstant<bool>(false), llvm_isnull_ptr);
+    llvm::Value* llvm_keyval = nullptr;
+    if (!hash_key_trees_[i]->GenerateCode(codegen_utils, gen_info_,
+                                          &llvm_keyval, llvm_isnull_ptr)) {
+      return false;
+    }
+    llvm_keyval = codegen_utils->CreateCppTypeToDatumCast(llvm_keyval);
+    irb->CreateCondBr(irb->CreateLoad(llvm_isnull_ptr),
+                      hash_null_block /* true */,
+                      hash_block /* false */);
+
+    // cdbhash(h, keyval, lfirst_oid(ht));
+    irb->SetInsertPoint(hash_block);
+    PGHashFuncGenerator::GenerateCdbHash(codegen_utils,
+                                         lfirst_oid(type_cell),
+                                         llvm_keyval,
+                                         llvm_cdbhash_arg);
+    irb->CreateBr(next_key_block);
+
+    // cdbhashnull(h);
+    irb->SetInsertPoint(hash_null_block);
+    PGHashFuncGenerator::GenerateCdbHashNull(codegen_utils, llvm_cdbhash_arg);
+    irb->CreateBr(next_key_block);
+
+    irb->SetInsertPoint(next_key_block);
+    type_cell = lnext(type_cell);
+  }
+  irb->CreateRetVoid();
+
+  // Error econtext block
+  // ---------------
+  irb->SetInsertPoint(error_econtext_block);
+  EXPAND_CREATE_ELOG(codegen_utils, ERROR, "Codegened hashMotionKeys: "
+                     "use of different econtext.");
+  irb->CreateRetVoid();
+
+  // Error block
+  // ---------------
+  irb->SetInsertPoint(error_block);
+  // We error out during the evaluation of the expressions.
+  irb->CreateRetVoid();
+
+  return true;
+}
+
+bool HashMotionKeysCodegen::GenerateCodeInternal(
+    GpCodegenUtils* codegen_utils) {
+  bool isGenerated = GenerateHashMotionKeys(codegen_utils);
+
+  if (isGenerated) {
+    elog(DEBUG1, "hashMotionKeys was generated successfully!");
+    return true;
+  } else {
+    elog(DEBUG1, "hashMotionKeys generation failed!");
+    return false;
+  }
+}
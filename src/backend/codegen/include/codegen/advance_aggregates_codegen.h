@@ -45,6 +45,8 @@ class AdvanceAggregatesCodegen: public BaseCodegen<AdvanceAggregatesFn> {
 
   virtual ~AdvanceAggregatesCodegen() = default;
 
+  bool AppendFingerprint(std::string* fingerprint) const override;
+
  protected:
   /**
    * @brief Generate code for advance_aggregates.
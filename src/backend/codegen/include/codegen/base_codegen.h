@@ -100,21 +100,38 @@ class BaseCodegen: public CodegenInterface {
   }
 
   bool SetToGenerated(gpcodegen::GpCodegenUtils* codegen_utils) final {
+    return SetToGenerated(codegen_utils, GetUniqueFuncName());
+  }
+
+  bool SetToGenerated(gpcodegen::GpCodegenUtils* codegen_utils,
+                      const std::string& func_name) final {
     if (false == IsGenerated()) {
       assert(*ptr_to_chosen_func_ptr_ == regular_func_ptr_);
       return false;
     }
 
     FuncPtrType compiled_func_ptr = codegen_utils->GetFunctionPointer<
-        FuncPtrType>(GetUniqueFuncName());
+        FuncPtrType>(func_name);
 
     if (nullptr != compiled_func_ptr) {
-      *ptr_to_chosen_func_ptr_ = compiled_func_ptr;
+      // The caller may be using the regular function concurrently when this
+      // is called from a background compilation thread.
+      __atomic_store_n(ptr_to_chosen_func_ptr_, compiled_func_ptr,
+                       __ATOMIC_RELEASE);
       return true;
     }
     return false;
   }
 
+  /**
+   * @note By default generated code is assumed to depend on plan specific
+   *       state and is not cached. Generators override this after replacing
+   *       any plan specific pointers with rebindable constants.
+   **/
+  bool AppendFingerprint(std::string* fingerprint) const override {
+    return false;
+  }
+
   void Reset() final {
     SetToRegular();
   }
@@ -131,6 +148,11 @@ class BaseCodegen: public CodegenInterface {
     return is_generated_;
   }
 
+  bool IsUsingGenerated() const final {
+    return __atomic_load_n(ptr_to_chosen_func_ptr_, __ATOMIC_ACQUIRE) !=
+        regular_func_ptr_;
+  }
+
   /**
    * @return Regular version of the target function.
    *
@@ -152,7 +174,9 @@ class BaseCodegen: public CodegenInterface {
                            FuncPtrType* ptr_to_chosen_func_ptr) {
     assert(nullptr != ptr_to_chosen_func_ptr);
     assert(nullptr != regular_func_ptr);
-    *ptr_to_chosen_func_ptr = regular_func_ptr;
+    // Paired with the release store in SetToGenerated()
+    __atomic_store_n(ptr_to_chosen_func_ptr, regular_func_ptr,
+                     __ATOMIC_RELEASE);
     return true;
   }
 
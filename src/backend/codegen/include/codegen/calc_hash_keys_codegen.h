@@ -0,0 +1,83 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    calc_hash_keys_codegen.h
+//
+//  @doc:
+//    Headers for calc_hash_keys codegen.
+//
+//---------------------------------------------------------------------------
+
+#ifndef GPCODEGEN_CALC_HASH_KEYS_CODEGEN_H_  // NOLINT(build/header_guard)
+#define GPCODEGEN_CALC_HASH_KEYS_CODEGEN_H_
+
+#include <string>
+
+#include "codegen/base_codegen.h"
+#include "codegen/codegen_wrapper.h"
+
+namespace gpcodegen {
+
+/** \addtogroup gpcodegen
+ *  @{
+ */
+
+class CalcHashKeysCodegen: public BaseCodegen<CalcHashKeysFn> {
+ public:
+  /**
+   * @brief Constructor
+   *
+   * @param regular_func_ptr        Regular version of the target function.
+   * @param ptr_to_chosen_func_ptr  Reference to the function pointer that the
+   *                                caller will call.
+   * @param aggstate                The AggState of a hash aggregate to use for
+   *                                generating code.
+   *
+   * @note 	The ptr_to_chosen_func_ptr can refer to either the generated
+   *        function or the corresponding regular version.
+   *
+   **/
+  explicit CalcHashKeysCodegen(CodegenManager* manager,
+                               CalcHashKeysFn regular_func_ptr,
+                               CalcHashKeysFn* ptr_to_regular_func_ptr,
+                               AggState* aggstate);
+
+  virtual ~CalcHashKeysCodegen() = default;
+
+  bool AppendFingerprint(std::string* fingerprint) const override;
+
+ protected:
+  /**
+   * @brief Generate code for calc_hash_keys.
+   *
+   * @param codegen_utils
+   *
+   * @return true on successful generation; false otherwise.
+   *
+   * @note Extraction of the grouping columns and their hash functions are
+   *       fused in a single function. Generation fails if any of the hash
+   *       functions is not supported by
+   *       PGHashFuncGenerator::GenerateHashFunction().
+   */
+  bool GenerateCodeInternal(gpcodegen::GpCodegenUtils* codegen_utils) final;
+
+ private:
+  AggState* aggstate_;
+
+  static constexpr char kCalcHashKeysPrefix[] = "CalcHashKeys";
+
+  /**
+   * @brief Generates runtime code that implements calc_hash_keys.
+   *
+   * @param codegen_utils Utility to ease the code generation process.
+   * @return true on successful generation.
+   **/
+  bool GenerateCalcHashKeys(gpcodegen::GpCodegenUtils* codegen_utils);
+};
+
+/** @} */
+
+}  // namespace gpcodegen
+#endif  // GPCODEGEN_CALC_HASH_KEYS_CODEGEN_H_
@@ -0,0 +1,76 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    case_expr_tree_generator.h
+//
+//  @doc:
+//    Object that generate code for CASE expression.
+//
+//---------------------------------------------------------------------------
+#ifndef GPCODEGEN_CASE_EXPR_TREE_GENERATOR_H_  // NOLINT(build/header_guard)
+#define GPCODEGEN_CASE_EXPR_TREE_GENERATOR_H_
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "codegen/expr_tree_generator.h"
+
+#include "llvm/IR/Value.h"
+
+namespace gpcodegen {
+
+/** \addtogroup gpcodegen
+ *  @{
+ */
+
+/**
+ * @brief Object that generate code for CASE WHEN cond THEN result ... ELSE
+ *        default END expression.
+ *
+ * @note The form comparing an argument against each WHEN value (CASE arg WHEN
+ *       value THEN ...) is not supported.
+ **/
+class CaseExprTreeGenerator : public ExprTreeGenerator {
+ public:
+  // Condition and result of a WHEN clause
+  using WhenClause = std::pair<std::unique_ptr<ExprTreeGenerator>,
+                               std::unique_ptr<ExprTreeGenerator>>;
+
+  static bool VerifyAndCreateExprTree(
+      const ExprState* expr_state,
+      ExprTreeGeneratorInfo* gen_info,
+      std::unique_ptr<ExprTreeGenerator>* expr_tree);
+
+  bool GenerateCode(gpcodegen::GpCodegenUtils* codegen_utils,
+                    const ExprTreeGeneratorInfo& gen_info,
+                    llvm::Value** llvm_out_value,
+                    llvm::Value* const llvm_isnull_ptr) final;
+
+  bool AppendFingerprint(std::string* fingerprint) const final;
+
+ protected:
+  /**
+   * @brief Constructor.
+   *
+   * @param expr_state Expression state
+   * @param when_clauses WHEN clauses in order of evaluation
+   * @param default_result ELSE expression; nullptr for NULL
+   **/
+  CaseExprTreeGenerator(
+      const ExprState* expr_state,
+      std::vector<WhenClause>&& when_clauses,  // NOLINT(build/c++11)
+      std::unique_ptr<ExprTreeGenerator> default_result);
+
+ private:
+  std::vector<WhenClause> when_clauses_;
+  std::unique_ptr<ExprTreeGenerator> default_result_;
+};
+
+/** @} */
+}  // namespace gpcodegen
+
+#endif  // GPCODEGEN_CASE_EXPR_TREE_GENERATOR_H_
@@ -0,0 +1,159 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    codegen_cache.h
+//
+//  @doc:
+//    Backend-local cache of compiled modules shared across queries
+//
+//---------------------------------------------------------------------------
+
+#ifndef GPCODEGEN_CODEGEN_CACHE_H_  // NOLINT(build/header_guard)
+#define GPCODEGEN_CODEGEN_CACHE_H_
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "codegen/utils/macros.h"
+
+namespace gpcodegen {
+/** \addtogroup gpcodegen
+ *  @{
+ */
+
+// Forward declaration
+class GpCodegenUtils;
+
+/**
+ * @brief Cache of compiled modules, keyed by the fingerprint of the code
+ *        generators that produced them.
+ *
+ * A CodegenManager whose generators all support fingerprinting looks up its
+ * fingerprint here before compiling. On a hit, the plan specific pointers of
+ * the cached module are rebound to the ones of the new plan (see
+ * GpCodegenUtils::GetRebindableConstant()) and the already compiled functions
+ * are used, skipping optimization and machine code generation.
+ *
+ * @note Generated code reads the addresses of backend-local structures, so the
+ *       cache lives in the backend only and is never shared across processes.
+ *       An entry is leased to at most one manager at a time, since its
+ *       rebindable constants can hold only one set of values. Entries not
+ *       leased are evicted in least recently used order whenever the compiled
+ *       code held by the cache exceeds codegen_cache_size.
+ **/
+class CodegenCache {
+ public:
+  /**
+   * @brief Compiled module along with the names of the generated functions.
+   **/
+  struct Entry {
+    std::string key;
+    std::unique_ptr<GpCodegenUtils> codegen_utils;
+    // Name of the function generated by each enrolled generator, in order of
+    // enrollment; empty if the generator did not generate code.
+    std::vector<std::string> func_names;
+    // Number of bytes of compiled code and data.
+    size_t size;
+    bool in_use;
+  };
+
+  /**
+   * @return The cache of the current backend.
+   **/
+  static CodegenCache* GetInstance();
+
+  /**
+   * @brief Look up a compiled module and lease it to the caller.
+   *
+   * @param key Fingerprint of the requesting generators.
+   * @param source GpCodegenUtils holding the rebindable constants of the
+   *        requesting plan.
+   *
+   * @return Leased entry on a hit; nullptr otherwise.
+   **/
+  Entry* Acquire(const std::string& key, const GpCodegenUtils& source);
+
+  /**
+   * @brief Add a freshly compiled module to the cache and lease it to the
+   *        caller.
+   *
+   * @note Ownership of *codegen_utils is taken only if the module is
+   *       admitted, i.e. no entry with the same key exists and it fits in
+   *       codegen_cache_size.
+   *
+   * @param key Fingerprint of the generators that produced the module.
+   * @param func_names Names of the generated functions.
+   * @param codegen_utils GpCodegenUtils holding the compiled module.
+   *
+   * @return Leased entry if admitted; nullptr otherwise.
+   **/
+  Entry* Insert(const std::string& key,
+                const std::vector<std::string>& func_names,
+                std::unique_ptr<GpCodegenUtils>* codegen_utils);
+
+  /**
+   * @brief Return an entry leased by Acquire() or Insert().
+   **/
+  void Release(Entry* entry);
+
+  /**
+   * @brief Return the leases still held, by managers that were never
+   *        destroyed. Only called when no query runs, at the end of a
+   *        top-level transaction.
+   *
+   * @return Number of leases returned.
+   **/
+  size_t ReleaseAll();
+
+  /**
+   * @brief Evict entries not in use until the cache fits in max_size bytes.
+   **/
+  void EvictTo(size_t max_size);
+
+  size_t hits() const {
+    return hits_;
+  }
+
+  size_t misses() const {
+    return misses_;
+  }
+
+  size_t evictions() const {
+    return evictions_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  size_t entry_count() const {
+    return entries_.size();
+  }
+
+ private:
+  CodegenCache();
+
+  // Budget in bytes derived from codegen_cache_size.
+  static size_t MaxSize();
+
+  // Entries in least recently used order; most recently used at the front.
+  std::list<Entry> entries_;
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+
+  size_t hits_;
+  size_t misses_;
+  size_t evictions_;
+  size_t size_;
+
+  DISALLOW_COPY_AND_ASSIGN(CodegenCache);
+};
+
+/** @} */
+
+}  // namespace gpcodegen
+#endif  // GPCODEGEN_CODEGEN_CACHE_H_
@@ -21,11 +21,12 @@ extern bool codegen_exec_variable_list;
 extern bool codegen_slot_getattr;
 extern bool codegen_exec_eval_expr;
 extern bool codegen_advance_aggregate;
-// TODO(shardikar): Retire this GUC after performing experiments to find the
-// tradeoff of codegen-ing slot_getattr() (potentially by measuring the
-// difference in the number of instructions) when one of the first few
-// attributes is varlen.
-extern int codegen_varlen_tolerance;
+extern bool codegen_hash_keys;
+extern bool codegen_sort_compare;
+extern bool codegen_background_compile;
+extern int codegen_cache_size;
+extern double codegen_saving_per_row;
+extern double codegen_compile_cost;
 }
 
 namespace gpcodegen {
@@ -39,6 +40,10 @@ class ExecVariableListCodegen;
 class SlotGetAttrCodegen;
 class ExecEvalExprCodegen;
 class AdvanceAggregatesCodegen;
+class HashMotionKeysCodegen;
+class CalcHashKeysCodegen;
+class ExecHashGetHashKeysCodegen;
+class MKCompareCodegen;
 
 class CodegenConfig {
  public:
@@ -73,6 +78,26 @@ inline bool CodegenConfig::IsGeneratorEnabled<AdvanceAggregatesCodegen>() {
   return codegen_advance_aggregate;
 }
 
+template<>
+inline bool CodegenConfig::IsGeneratorEnabled<HashMotionKeysCodegen>() {
+  return codegen_hash_keys;
+}
+
+template<>
+inline bool CodegenConfig::IsGeneratorEnabled<CalcHashKeysCodegen>() {
+  return codegen_hash_keys;
+}
+
+template<>
+inline bool CodegenConfig::IsGeneratorEnabled<ExecHashGetHashKeysCodegen>() {
+  return codegen_hash_keys;
+}
+
+template<>
+inline bool CodegenConfig::IsGeneratorEnabled<MKCompareCodegen>() {
+  return codegen_sort_compare;
+}
+
 
 /** @} */
 
@@ -66,6 +66,30 @@ class CodegenInterface {
    **/
   virtual bool SetToGenerated(gpcodegen::GpCodegenUtils* codegen_utils) = 0;
 
+  /**
+   * @brief Sets up the caller to use a generated function with the given name,
+   *        which may have been compiled for a different (but identical) plan.
+   *
+   * @param codegen_utils Facilitates in obtaining the function pointer from
+   *        the compiled module.
+   * @param func_name Name of the compiled function.
+   * @return true on successfully setting to generated functions
+   **/
+  virtual bool SetToGenerated(gpcodegen::GpCodegenUtils* codegen_utils,
+                              const std::string& func_name) = 0;
+
+  /**
+   * @brief Appends to fingerprint everything the generated code depends on,
+   *        other than values created with GetRebindableConstant().
+   *
+   * @note Two generators producing the same fingerprint must generate
+   *       identical code, so that it can be shared through the CodegenCache.
+   *
+   * @param fingerprint String to append to.
+   * @return true if the generated code can be cached; false otherwise.
+   **/
+  virtual bool AppendFingerprint(std::string* fingerprint) const = 0;
+
   /**
    * @brief Resets the state of the generator, including reverting back to
    *        the regular version of the function.
@@ -92,6 +116,12 @@ class CodegenInterface {
    **/
   virtual bool IsGenerated() const = 0;
 
+  /**
+   * @return true if the caller currently calls the generated function.
+   *
+   **/
+  virtual bool IsUsingGenerated() const = 0;
+
  protected:
   /**
    * @brief	Utility function to construct a unique function name from the
@@ -18,6 +18,7 @@
 #include <string>
 
 #include "codegen/utils/macros.h"
+#include "codegen/codegen_cache.h"
 #include "codegen/codegen_config.h"
 #include "codegen/codegen_interface.h"
 #include "codegen/base_codegen.h"
@@ -46,7 +47,7 @@ class CodegenManager {
    **/
   explicit CodegenManager(const std::string& module_name);
 
-  ~CodegenManager() = default;
+  ~CodegenManager();
 
   /**
    * @brief Template function to facilitate enroll for any type of
@@ -122,7 +123,20 @@ class CodegenManager {
                            CodegenInterface* generator);
 
   /**
-   * @brief Request all enrolled generators to generate code.
+   * @brief Set the number of rows the plan node is expected to process.
+   *
+   * @note Unless codegen_saving_per_row is zero, GenerateCode() skips any
+   *       generator whose learned compilation cost is more than the time
+   *       expected to be saved over these rows. A negative value (the
+   *       default) means unknown, in which case every generator is admitted.
+   **/
+  void SetEstimatedRows(double estimated_rows) {
+    estimated_rows_ = estimated_rows;
+  }
+
+  /**
+   * @brief Request all enrolled generators that pay off their compilation
+   *        (see SetEstimatedRows()) to generate code.
    *
    * @return The number of enrolled codegen that successfully generated code.
    **/
@@ -132,6 +146,14 @@ class CodegenManager {
    * @brief Compile all the generated functions. On success,
    *        a pointer to the generated method becomes available to the caller.
    *
+   * @note If all enrolled generators support fingerprinting and
+   *       codegen_cache_size is non-zero, an identical module compiled for an
+   *       earlier plan is reused from the CodegenCache instead.
+   *
+   * @note If codegen_background_compile is set, the module is compiled by a
+   *       helper thread and this returns 0 immediately. Callers keep using
+   *       the regular functions until the thread swaps in the generated ones.
+   *
    * @return The number of enrolled codegen that successully generated code
    *         and 0 on failure
    **/
@@ -172,7 +194,82 @@ class CodegenManager {
    */
   const std::string& GetExplainString();
 
+  /*
+   * @brief Return the time spent generating and compiling code, and whether
+   *        each enrolled generator was admitted and its generated function
+   *        used, for EXPLAIN ANALYZE CODEGEN
+   */
+  std::string GetStatisticsString();
+
  private:
+  // Time spent on an enrolled generator
+  struct GeneratorStatistics {
+    bool admitted;
+    // Learned cost of the generator when it was considered for admission
+    double estimated_cost_ms;
+    // Time to generate IR
+    double generation_ms;
+    // Time to obtain the compiled function, including the MCJIT compilation
+    // of the whole module for the first generator of the module
+    double compilation_ms;
+  };
+
+  /**
+   * @return Estimated time in milliseconds to generate and compile a function
+   *         like the one of generator, learned from earlier compilations.
+   **/
+  static double GetCompileCost(const CodegenInterface& generator);
+
+  /**
+   * @brief Refine the learned compilation costs with the times measured for
+   *        the module compiled by this manager.
+   *
+   * @note The time spent on the whole module is split evenly between the
+   *       generators that generated code.
+   **/
+  void LearnCompileCosts() const;
+
+  /**
+   * @brief Copy the times measured by a finished background compilation.
+   *
+   * @return true if the background compilation set any generator to its
+   *         generated function.
+   **/
+  bool CollectBackgroundStatistics();
+
+  /**
+   * @brief Run the IR optimization passes over the module, unless that was
+   *        already done for EXPLAIN CODEGEN.
+   **/
+  void OptimizeModule();
+
+  /**
+   * @brief Compute the key identifying the generated module in the
+   *        CodegenCache.
+   *
+   * @return true if every enrolled generator supports fingerprinting.
+   **/
+  bool ComputeFingerprint(std::string* fingerprint) const;
+
+  /**
+   * @brief Hand over the module to a helper thread that compiles it and then
+   *        sets the enrolled generators to the generated functions.
+   *
+   * @param fingerprint Key to cache the module with; empty if not cacheable.
+   *
+   * @return true if the thread was started; false otherwise, in which case
+   *         the module is still owned by this manager.
+   **/
+  bool StartBackgroundCompilation(const std::string& fingerprint);
+
+  // State shared with the thread started by StartBackgroundCompilation()
+  struct BackgroundCompilation;
+
+  // Body of the thread started by StartBackgroundCompilation()
+  static void CompileInBackground(
+      BackgroundCompilation* state,
+      int optimization_level);
+
   // GpCodegenUtils provides a facade to LLVM subsystem.
   std::unique_ptr<gpcodegen::GpCodegenUtils> codegen_utils_;
 
@@ -184,6 +281,25 @@ class CodegenManager {
   // Holds the dumped IR of all underlying modules for EXPLAIN CODEGEN queries
   std::string explain_string_;
 
+  // Number of rows the plan node is expected to process; negative if unknown
+  double estimated_rows_;
+
+  // Statistics of each enrolled generator, in order of enrollment
+  std::vector<GeneratorStatistics> generator_statistics_;
+
+  // Time spent optimizing and compiling the module with MCJIT
+  double optimization_ms_;
+  double compilation_ms_;
+
+  // Set once the optimization passes have run over codegen_utils_'s module
+  bool module_optimized_;
+
+  // Cache entry leased by this manager, whose compiled functions are in use.
+  CodegenCache::Entry* cache_entry_;
+
+  // Set while (or after) the module is compiled by a helper thread
+  std::shared_ptr<BackgroundCompilation> background_compilation_;
+
   DISALLOW_COPY_AND_ASSIGN(CodegenManager);
 };
 
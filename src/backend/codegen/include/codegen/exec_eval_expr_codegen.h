@@ -51,6 +51,8 @@ class ExecEvalExprCodegen: public BaseCodegen<ExecEvalExprFn> {
 
   bool InitDependencies() override;
 
+  bool AppendFingerprint(std::string* fingerprint) const override;
+
  protected:
   /**
    * @brief Generate code for expression evaluation.
@@ -0,0 +1,103 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    exec_hash_get_hash_keys_codegen.h
+//
+//  @doc:
+//    Headers for ExecHashGetHashKeys codegen.
+//
+//---------------------------------------------------------------------------
+
+#ifndef GPCODEGEN_EXEC_HASH_GET_HASH_KEYS_CODEGEN_H_  // NOLINT(build/header_guard)
+#define GPCODEGEN_EXEC_HASH_GET_HASH_KEYS_CODEGEN_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "codegen/base_codegen.h"
+#include "codegen/codegen_wrapper.h"
+#include "codegen/expr_tree_generator.h"
+
+namespace gpcodegen {
+
+/** \addtogroup gpcodegen
+ *  @{
+ */
+
+class ExecHashGetHashKeysCodegen: public BaseCodegen<ExecHashGetHashKeysFn> {
+ public:
+  /**
+   * @brief Constructor
+   *
+   * @param regular_func_ptr        Regular version of the target function.
+   * @param ptr_to_chosen_func_ptr  Reference to the function pointer that the
+   *                                caller will call.
+   * @param hjstate                 The HashJoinState to use for generating
+   *                                code.
+   * @param outer_tuple             Generate code for the outer hash keys if
+   *                                true, for the inner hash keys otherwise.
+   *
+   * @note 	The ptr_to_chosen_func_ptr can refer to either the generated
+   *        function or the corresponding regular version.
+   *
+   **/
+  explicit ExecHashGetHashKeysCodegen(
+      CodegenManager* manager,
+      ExecHashGetHashKeysFn regular_func_ptr,
+      ExecHashGetHashKeysFn* ptr_to_regular_func_ptr,
+      HashJoinState* hjstate,
+      bool outer_tuple);
+
+  virtual ~ExecHashGetHashKeysCodegen() = default;
+
+  bool InitDependencies() override;
+
+  bool AppendFingerprint(std::string* fingerprint) const override;
+
+ protected:
+  /**
+   * @brief Generate code for ExecHashGetHashKeys.
+   *
+   * @param codegen_utils
+   *
+   * @return true on successful generation; false otherwise.
+   *
+   * @note Evaluation of the hash key expressions and their hash functions are
+   *       fused in a single function. Generation fails if any of the
+   *       expressions is not supported by ExprTreeGenerator, or any of the
+   *       hash functions is not supported by
+   *       PGHashFuncGenerator::GenerateHashFunction().
+   */
+  bool GenerateCodeInternal(gpcodegen::GpCodegenUtils* codegen_utils) final;
+
+ private:
+  bool outer_tuple_;
+  List* hashkeys_;
+
+  // Hash function and strictness of the join operator of each hash key, as
+  // ExecHashTableCreate() would look them up
+  std::vector<unsigned int> hash_func_oids_;
+  std::vector<bool> hash_strict_;
+
+  ExprTreeGeneratorInfo gen_info_;
+  // One tree per hash key; empty if any of the keys is not supported
+  std::vector<std::unique_ptr<ExprTreeGenerator>> hash_key_trees_;
+
+  static constexpr char kExecHashGetHashKeysPrefix[] = "ExecHashGetHashKeys";
+
+  /**
+   * @brief Generates runtime code that implements ExecHashGetHashKeys.
+   *
+   * @param codegen_utils Utility to ease the code generation process.
+   * @return true on successful generation.
+   **/
+  bool GenerateExecHashGetHashKeys(gpcodegen::GpCodegenUtils* codegen_utils);
+};
+
+/** @} */
+
+}  // namespace gpcodegen
+#endif  // GPCODEGEN_EXEC_HASH_GET_HASH_KEYS_CODEGEN_H_
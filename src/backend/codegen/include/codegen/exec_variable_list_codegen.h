@@ -46,6 +46,8 @@ class ExecVariableListCodegen: public BaseCodegen<ExecVariableListFn> {
 
   bool InitDependencies() override;
 
+  bool AppendFingerprint(std::string* fingerprint) const override;
+
  protected:
   /**
    * @brief Generate code for the code path ExecVariableList > slot_getattr >
@@ -72,13 +74,9 @@ class ExecVariableListCodegen: public BaseCodegen<ExecVariableListFn> {
    * use different slots), then the function returns false and the codegen manager
    * will manage the clean up.
    *
-   * This implementation does not support:
-   *  (1) Null attributes
-   *  (2) Variable length attributes
-   *  (3) Attributes passed by reference
-   *
-   * If at execution time, we see any of the above types of attributes,
-   * we fall backs to the regular function.
+   * Tuples are deformed by the code generated for slot_getattr (see
+   * SlotGetAttrCodegen), which handles null, variable length and by
+   * reference attributes.
    */
   bool GenerateCodeInternal(gpcodegen::GpCodegenUtils* codegen_utils) final;
 
@@ -27,6 +27,10 @@ typedef struct ExprContext ExprContext;
 typedef struct ExprState ExprState;
 typedef struct Expr Expr;
 typedef struct OpExpr OpExpr;
+typedef struct FuncExpr FuncExpr;
+typedef struct BoolExpr BoolExpr;
+typedef struct NullTest NullTest;
+typedef struct CaseExpr CaseExpr;
 typedef struct Var Var;
 typedef struct Const Const;
 
@@ -39,7 +43,10 @@ namespace gpcodegen {
 enum class ExprTreeNodeType {
   kConst = 0,
   kVar = 1,
-  kOperator = 2
+  kOperator = 2,
+  kBool = 3,
+  kNullTest = 4,
+  kCase = 5
 };
 
 /**
@@ -122,11 +129,21 @@ class ExprTreeGenerator {
                             llvm::Value** value,
                             llvm::Value* const llvm_isnull_ptr) = 0;
 
+  /**
+   * @brief Append to fingerprint everything the code generated for this
+   *        expression tree depends on.
+   *
+   * @param fingerprint String to append to.
+   *
+   * @return true if the generated code can be shared with another plan
+   *         producing the same fingerprint; false otherwise.
+   **/
+  virtual bool AppendFingerprint(std::string* fingerprint) const = 0;
 
   /**
    * @return Expression state
    **/
-  const ExprState* expr_state() { return expr_state_; }
+  const ExprState* expr_state() const { return expr_state_; }
 
  protected:
   /**
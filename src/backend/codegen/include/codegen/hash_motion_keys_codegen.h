@@ -0,0 +1,92 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    hash_motion_keys_codegen.h
+//
+//  @doc:
+//    Headers for hashMotionKeys codegen.
+//
+//---------------------------------------------------------------------------
+
+#ifndef GPCODEGEN_HASH_MOTION_KEYS_CODEGEN_H_  // NOLINT(build/header_guard)
+#define GPCODEGEN_HASH_MOTION_KEYS_CODEGEN_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "codegen/base_codegen.h"
+#include "codegen/codegen_wrapper.h"
+#include "codegen/expr_tree_generator.h"
+
+namespace gpcodegen {
+
+/** \addtogroup gpcodegen
+ *  @{
+ */
+
+class HashMotionKeysCodegen: public BaseCodegen<HashMotionKeysFn> {
+ public:
+  /**
+   * @brief Constructor
+   *
+   * @param regular_func_ptr        Regular version of the target function.
+   * @param ptr_to_chosen_func_ptr  Reference to the function pointer that the
+   *                                caller will call.
+   * @param motionstate             The sending MotionState of a redistribute
+   *                                motion to use for generating code.
+   *
+   * @note 	The ptr_to_chosen_func_ptr can refer to either the generated
+   *        function or the corresponding regular version.
+   *
+   **/
+  explicit HashMotionKeysCodegen(CodegenManager* manager,
+                                 HashMotionKeysFn regular_func_ptr,
+                                 HashMotionKeysFn* ptr_to_regular_func_ptr,
+                                 MotionState* motionstate);
+
+  virtual ~HashMotionKeysCodegen() = default;
+
+  bool InitDependencies() override;
+
+  bool AppendFingerprint(std::string* fingerprint) const override;
+
+ protected:
+  /**
+   * @brief Generate code for hashMotionKeys.
+   *
+   * @param codegen_utils
+   *
+   * @return true on successful generation; false otherwise.
+   *
+   * @note Evaluation of the hash key expressions and cdbhash() are fused in a
+   *       single function; see PGHashFuncGenerator::GenerateCdbHash() for the
+   *       types whose hashing is inlined. Generation fails if any of the
+   *       expressions is not supported by ExprTreeGenerator.
+   */
+  bool GenerateCodeInternal(gpcodegen::GpCodegenUtils* codegen_utils) final;
+
+ private:
+  MotionState* motionstate_;
+
+  ExprTreeGeneratorInfo gen_info_;
+  // One tree per hash key; empty if any of the keys is not supported
+  std::vector<std::unique_ptr<ExprTreeGenerator>> hash_key_trees_;
+
+  static constexpr char kHashMotionKeysPrefix[] = "HashMotionKeys";
+
+  /**
+   * @brief Generates runtime code that implements hashMotionKeys.
+   *
+   * @param codegen_utils Utility to ease the code generation process.
+   * @return true on successful generation.
+   **/
+  bool GenerateHashMotionKeys(gpcodegen::GpCodegenUtils* codegen_utils);
+};
+
+/** @} */
+
+}  // namespace gpcodegen
+#endif  // GPCODEGEN_HASH_MOTION_KEYS_CODEGEN_H_
@@ -0,0 +1,123 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    mk_compare_codegen.h
+//
+//  @doc:
+//    Headers for tupsort_compare_datum codegen.
+//
+//---------------------------------------------------------------------------
+
+#ifndef GPCODEGEN_MK_COMPARE_CODEGEN_H_  // NOLINT(build/header_guard)
+#define GPCODEGEN_MK_COMPARE_CODEGEN_H_
+
+#include <string>
+#include <vector>
+
+#include "codegen/base_codegen.h"
+#include "codegen/codegen_wrapper.h"
+
+namespace llvm {
+class BasicBlock;
+class Value;
+}  // namespace llvm
+
+namespace gpcodegen {
+
+/** \addtogroup gpcodegen
+ *  @{
+ */
+
+class MKCompareCodegen: public BaseCodegen<MKCompareFn> {
+ public:
+  /**
+   * @brief Constructor
+   *
+   * @param regular_func_ptr        Regular version of the target function.
+   * @param ptr_to_chosen_func_ptr  Reference to the function pointer that the
+   *                                caller will call.
+   * @param num_keys                Number of sort keys, i.e. of levels of the
+   *                                multi-key sort.
+   * @param sort_operators          Ordering operator of each sort key.
+   *
+   * @note 	The ptr_to_chosen_func_ptr can refer to either the generated
+   *        function or the corresponding regular version.
+   *
+   **/
+  explicit MKCompareCodegen(CodegenManager* manager,
+                            MKCompareFn regular_func_ptr,
+                            MKCompareFn* ptr_to_regular_func_ptr,
+                            int num_keys,
+                            unsigned int* sort_operators);
+
+  virtual ~MKCompareCodegen() = default;
+
+  bool AppendFingerprint(std::string* fingerprint) const override;
+
+ protected:
+  /**
+   * @brief Generate code for tupsort_compare_datum.
+   *
+   * @param codegen_utils
+   *
+   * @return true on successful generation; false otherwise.
+   *
+   * @note The generated function finds the level from the MKLvContext it is
+   *       given, and compares the prepared datums with the comparison
+   *       function of that sort key inlined, negating the result for
+   *       descending keys. Levels whose comparison function is not supported
+   *       fall back to tupsort_compare_datum(). Nulls never reach the
+   *       comparator; they are ordered by the compflags of MKEntry.
+   */
+  bool GenerateCodeInternal(gpcodegen::GpCodegenUtils* codegen_utils) final;
+
+ private:
+  // Comparison function and direction of each sort key, as
+  // create_mksort_context() would look them up
+  std::vector<unsigned int> sort_func_oids_;
+  std::vector<bool> reverse_;
+
+  static constexpr char kMKComparePrefix[] = "MKCompare";
+
+  /**
+   * @brief Generates runtime code that implements tupsort_compare_datum.
+   *
+   * @param codegen_utils Utility to ease the code generation process.
+   * @return true on successful generation.
+   **/
+  bool GenerateMKCompare(gpcodegen::GpCodegenUtils* codegen_utils);
+
+  /**
+   * @brief Check if the comparison of a level can be generated.
+   **/
+  static bool IsSupportedSortFunction(unsigned int sort_func_oid);
+
+  /**
+   * @brief Generate code that compares two non-null datums with the given
+   *        btree comparison function, returning an int32 less than, equal to
+   *        or greater than zero.
+   *
+   * @param codegen_utils     Utility to ease the code generation process.
+   * @param sort_func_oid     Oid of the comparison function
+   * @param llvm_datum1       First datum
+   * @param llvm_datum2       Second datum
+   * @param llvm_fallback_block Block to jump to if the datums cannot be
+   *                          compared by the generated code, i.e. when a
+   *                          text value needs to be detoasted.
+   *
+   * @return the comparison result
+   **/
+  static llvm::Value* GenerateSortFunction(
+      gpcodegen::GpCodegenUtils* codegen_utils,
+      unsigned int sort_func_oid,
+      llvm::Value* llvm_datum1,
+      llvm::Value* llvm_datum2,
+      llvm::BasicBlock* llvm_fallback_block);
+};
+
+/** @} */
+
+}  // namespace gpcodegen
+#endif  // GPCODEGEN_MK_COMPARE_CODEGEN_H_
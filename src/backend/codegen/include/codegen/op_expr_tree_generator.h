@@ -6,7 +6,7 @@
 //    op_expr_tree_generator.h
 //
 //  @doc:
-//    Object that generate code for operator expression.
+//    Object that generate code for operator and function expression.
 //
 //---------------------------------------------------------------------------
 #ifndef GPCODEGEN_OP_EXPR_TREE_GENERATOR_H_  // NOLINT(build/header_guard)
@@ -31,7 +31,8 @@ using CodeGenFuncMap = std::unordered_map<unsigned int,
     std::unique_ptr<gpcodegen::PGFuncGeneratorInterface>>;
 
 /**
- * @brief Object that generate code for operator expression.
+ * @brief Object that generate code for operator expression, or for function
+ *        expression calling one of the supported built-in functions.
  **/
 class OpExprTreeGenerator : public ExprTreeGenerator {
  public:
@@ -55,11 +56,18 @@ class OpExprTreeGenerator : public ExprTreeGenerator {
   static gpcodegen::PGFuncGeneratorInterface* GetPGFuncGenerator(
       unsigned int oid);
 
+  /**
+   * @return The oid of the function called by the given OpExpr or FuncExpr.
+   **/
+  static unsigned int GetFuncOid(const Expr* expr);
+
   bool GenerateCode(gpcodegen::GpCodegenUtils* codegen_utils,
                     const ExprTreeGeneratorInfo& gen_info,
                     llvm::Value** llvm_out_value,
                     llvm::Value* const llvm_isnull_ptr) final;
 
+  bool AppendFingerprint(std::string* fingerprint) const final;
+
  protected:
   /**
    * @brief Constructor.
@@ -347,6 +347,29 @@ class PGArithUnaryFuncGenerator {
         llvm_out_value);
   }
 
+  /**
+   * @brief Convert a value to a type that can represent all values of its own
+   *        type, e.g. int4 to int8, as done by casting functions.
+   *
+   * @param codegen_utils     Utility for easy code generation.
+   * @param pg_func_info      Details for pgfunc generation
+   * @param llvm_out_value    Store location for the result
+   *
+   * @return true if generation was successful otherwise return false
+   **/
+  static bool WideningCast(gpcodegen::GpCodegenUtils* codegen_utils,
+                           const PGFuncGeneratorInfo& pg_func_info,
+                           llvm::Value** llvm_out_value) {
+    assert(nullptr != codegen_utils);
+    assert(nullptr != llvm_out_value);
+    assert(1 == pg_func_info.llvm_args.size());
+    static_assert(sizeof(rtype) >= sizeof(Arg),
+                  "Only widening casts never overflow");
+    *llvm_out_value = codegen_utils->CreateCast<rtype, Arg>(
+        pg_func_info.llvm_args[0]);
+    return true;
+  }
+
   static bool ArithOpWithOverflow(gpcodegen::GpCodegenUtils* codegen_utils,
                                    CGArithOpFunc codegen_mem_funcptr,
                                    const char* error_msg,
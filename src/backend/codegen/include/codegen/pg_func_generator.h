@@ -149,9 +149,8 @@ static inline bool GenerateStrictLogic(gpcodegen::GpCodegenUtils* codegen_utils,
 
   irb->SetInsertPoint(entry_block);
   // Stores if there is a NULL argument
-  llvm::Value* llvm_there_is_null_arg_ptr = irb->CreateAlloca(
-      codegen_utils->GetType<bool>(),
-      nullptr, "llvm_there_is_null_arg_ptr");
+  llvm::Value* llvm_there_is_null_arg_ptr = codegen_utils->CreateEntryBlockAlloca(
+      codegen_utils->GetType<bool>(), "llvm_there_is_null_arg_ptr");
   irb->CreateStore(codegen_utils->GetConstant<bool>(false),
                    llvm_there_is_null_arg_ptr);
   for (int i = first_arg_index; i < pg_func_info.llvm_args_isNull.size(); ++i) {
@@ -423,14 +422,14 @@ class PGGenericFuncGenerator : public  PGFuncGeneratorInterface {
         irb->SetInsertPoint(non_strict_logic_entry_block);
         // This variable will tell us if we set the llvm_out_value during
         // the check for NULL attributes.
-        llvm::Value* llvm_is_set_ptr = irb->CreateAlloca(
-            codegen_utils->GetType<bool>(), nullptr, "llvm_is_set_ptr");
+        llvm::Value* llvm_is_set_ptr = codegen_utils->CreateEntryBlockAlloca(
+            codegen_utils->GetType<bool>(), "llvm_is_set_ptr");
         // Initially, set it to false
         irb->CreateStore(codegen_utils->GetConstant<bool>(false),
                          llvm_is_set_ptr);
         // Pointer to temporary value of llvm_out_value after check for NULLs
-        llvm::Value* llvm_check_null_value_ptr = irb->CreateAlloca(
-            codegen_utils->GetType<Datum>(), nullptr,
+        llvm::Value* llvm_check_null_value_ptr = codegen_utils->CreateEntryBlockAlloca(
+            codegen_utils->GetType<Datum>(),
             "llvm_check_null_value_ptr");
         // Invoke CheckNulls function
         this->check_null_func_ptr_(codegen_utils,
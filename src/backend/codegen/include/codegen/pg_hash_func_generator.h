@@ -0,0 +1,126 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    pg_hash_func_generator.h
+//
+//  @doc:
+//    Base class to generate code for hash functions and cdbhash
+//
+//---------------------------------------------------------------------------
+
+#ifndef GPCODEGEN_PG_HASH_FUNC_GENERATOR_H_  // NOLINT(build/header_guard)
+#define GPCODEGEN_PG_HASH_FUNC_GENERATOR_H_
+
+#include "codegen/utils/gp_codegen_utils.h"
+
+#include "llvm/IR/Value.h"
+
+namespace llvm {
+class Value;
+}  // namespace llvm
+
+namespace gpcodegen {
+
+/** \addtogroup gpcodegen
+ *  @{
+ */
+
+class GpCodegenUtils;
+
+/**
+ * @brief Class with Static member functions to generate code for the hash
+ *        support functions used by hash aggregation and hash join, and for
+ *        the cdbhash() family used by redistribute motions.
+ **/
+class PGHashFuncGenerator {
+ public:
+  /**
+   * @brief Create instructions that compute the hash function with the given
+   *        oid for a datum, as FunctionCall1() would do.
+   *
+   * @param codegen_utils     Utility to easy code generation.
+   * @param hash_func_oid     Oid of the hash support function
+   * @param llvm_datum        Non-null datum to hash
+   * @param llvm_out_value    Store the 32-bit hash value
+   *
+   * @return true if generation was successful otherwise return false
+   *
+   * @note  Only hashint2, hashint4, hashint8, hashoid, hashchar, hashtext
+   *        and hashbpchar are supported.
+   **/
+  static bool GenerateHashFunction(gpcodegen::GpCodegenUtils* codegen_utils,
+                                   unsigned int hash_func_oid,
+                                   llvm::Value* llvm_datum,
+                                   llvm::Value** llvm_out_value);
+
+  /**
+   * @brief Create instructions that add a datum of the given type to a
+   *        CdbHash, as cdbhash() does.
+   *
+   * @param codegen_utils     Utility to easy code generation.
+   * @param type              Oid of the (base) type of the datum
+   * @param llvm_datum        Non-null datum to hash
+   * @param llvm_cdbhash      Pointer to the CdbHash to update
+   *
+   * @note  FNV-1 hashing of int2, int4, int8, date, text, varchar and bpchar
+   *        values is inlined; any other type calls cdbhash().
+   **/
+  static void GenerateCdbHash(gpcodegen::GpCodegenUtils* codegen_utils,
+                              unsigned int type,
+                              llvm::Value* llvm_datum,
+                              llvm::Value* llvm_cdbhash);
+
+  /**
+   * @brief Create instructions that add a NULL value to a CdbHash, as
+   *        cdbhashnull() does.
+   **/
+  static void GenerateCdbHashNull(gpcodegen::GpCodegenUtils* codegen_utils,
+                                  llvm::Value* llvm_cdbhash);
+
+ private:
+  /**
+   * @brief Generate code that folds the octets of an integer into an FNV-1
+   *        hash value, in the order they are laid out in memory.
+   *
+   * @param codegen_utils     Utility to easy code generation.
+   * @param llvm_value        Integer value to hash
+   * @param num_bytes         Number of octets of llvm_value
+   * @param llvm_hval         Previous hash value
+   *
+   * @return the new 32-bit hash value
+   **/
+  static llvm::Value* GenerateFnv1Int(gpcodegen::GpCodegenUtils* codegen_utils,
+                                      llvm::Value* llvm_value,
+                                      int num_bytes,
+                                      llvm::Value* llvm_hval);
+
+  /**
+   * @brief Generate a loop that folds a buffer into an FNV-1 hash value
+   *        (see fnv1_32_buf).
+   *
+   * @return the new 32-bit hash value
+   **/
+  static llvm::Value* GenerateFnv1Buf(gpcodegen::GpCodegenUtils* codegen_utils,
+                                      llvm::Value* llvm_data,
+                                      llvm::Value* llvm_len,
+                                      llvm::Value* llvm_hval);
+
+  /**
+   * @brief Generate code that drops trailing blanks from a string, keeping
+   *        at least one character (see ignoreblanks in cdbhash.c).
+   *
+   * @return the new length, as int32
+   **/
+  static llvm::Value* GenerateIgnoreBlanks(
+      gpcodegen::GpCodegenUtils* codegen_utils,
+      llvm::Value* llvm_data,
+      llvm::Value* llvm_len);
+};
+
+/** @} */
+
+}  // namespace gpcodegen
+
+#endif  // GPCODEGEN_PG_HASH_FUNC_GENERATOR_H_
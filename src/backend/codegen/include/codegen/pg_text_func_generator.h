@@ -0,0 +1,223 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    pg_text_func_generator.h
+//
+//  @doc:
+//    Base class for text, bpchar and numeric comparison functions to generate
+//    code
+//
+//---------------------------------------------------------------------------
+
+#ifndef GPCODEGEN_PG_TEXT_FUNC_GENERATOR_H_  // NOLINT(build/header_guard)
+#define GPCODEGEN_PG_TEXT_FUNC_GENERATOR_H_
+
+#include "codegen/pg_func_generator_interface.h"
+#include "codegen/utils/gp_codegen_utils.h"
+
+#include "llvm/IR/InstrTypes.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Value.h"
+
+namespace llvm {
+class Value;
+}  // namespace llvm
+
+namespace gpcodegen {
+
+/** \addtogroup gpcodegen
+ *  @{
+ */
+
+class GpCodegenUtils;
+struct PGFuncGeneratorInfo;
+
+/**
+ * @brief Class with Static member function to generate code for comparison
+ *        operators of varlena types, i.e. text (and varchar, which uses the
+ *        text operators), bpchar and numeric.
+ *
+ * @note  Arguments that are neither compressed nor toasted are read in place,
+ *        without a call to pg_detoast_datum(). Ordering of text and bpchar is
+ *        inlined only if LC_COLLATE is C at generation time; otherwise the
+ *        generated code calls varstr_cmp().
+ **/
+class PGTextFuncGenerator {
+ public:
+  /**
+   * @brief Create instructions for texteq and textne functions
+   *
+   * @param codegen_utils     Utility to easy code generation.
+   * @param pg_func_info      Details for pgfunc generation
+   * @param llvm_out_value    Store the results of function
+   *
+   * @return true if generation was successful otherwise return false
+   **/
+  template <llvm::CmpInst::Predicate kPredicate>
+  static bool TextEq(gpcodegen::GpCodegenUtils* codegen_utils,
+                     const PGFuncGeneratorInfo& pg_func_info,
+                     llvm::Value** llvm_out_value) {
+    return GenerateEq(codegen_utils, pg_func_info, false,
+                      kPredicate == llvm::CmpInst::ICMP_NE, llvm_out_value);
+  }
+
+  /**
+   * @brief Create instructions for text_lt, text_le, text_gt and text_ge
+   *        functions
+   *
+   * @param codegen_utils     Utility to easy code generation.
+   * @param pg_func_info      Details for pgfunc generation
+   * @param llvm_out_value    Store the results of function
+   *
+   * @return true if generation was successful otherwise return false
+   **/
+  template <llvm::CmpInst::Predicate kPredicate>
+  static bool TextCmp(gpcodegen::GpCodegenUtils* codegen_utils,
+                      const PGFuncGeneratorInfo& pg_func_info,
+                      llvm::Value** llvm_out_value) {
+    llvm::Value* llvm_cmp = nullptr;
+    if (!GenerateVarstrCmp(codegen_utils, pg_func_info, false, &llvm_cmp)) {
+      return false;
+    }
+    *llvm_out_value = codegen_utils->ir_builder()->CreateICmp(
+        kPredicate, llvm_cmp, codegen_utils->GetConstant<int32_t>(0));
+    return true;
+  }
+
+  /**
+   * @brief Create instructions for bpchareq and bpcharne functions, that
+   *        ignore trailing spaces
+   *
+   * @param codegen_utils     Utility to easy code generation.
+   * @param pg_func_info      Details for pgfunc generation
+   * @param llvm_out_value    Store the results of function
+   *
+   * @return true if generation was successful otherwise return false
+   **/
+  template <llvm::CmpInst::Predicate kPredicate>
+  static bool BpcharEq(gpcodegen::GpCodegenUtils* codegen_utils,
+                       const PGFuncGeneratorInfo& pg_func_info,
+                       llvm::Value** llvm_out_value) {
+    return GenerateEq(codegen_utils, pg_func_info, true,
+                      kPredicate == llvm::CmpInst::ICMP_NE, llvm_out_value);
+  }
+
+  /**
+   * @brief Create instructions for bpcharlt, bpcharle, bpchargt and bpcharge
+   *        functions, that ignore trailing spaces
+   *
+   * @param codegen_utils     Utility to easy code generation.
+   * @param pg_func_info      Details for pgfunc generation
+   * @param llvm_out_value    Store the results of function
+   *
+   * @return true if generation was successful otherwise return false
+   **/
+  template <llvm::CmpInst::Predicate kPredicate>
+  static bool BpcharCmp(gpcodegen::GpCodegenUtils* codegen_utils,
+                        const PGFuncGeneratorInfo& pg_func_info,
+                        llvm::Value** llvm_out_value) {
+    llvm::Value* llvm_cmp = nullptr;
+    if (!GenerateVarstrCmp(codegen_utils, pg_func_info, true, &llvm_cmp)) {
+      return false;
+    }
+    *llvm_out_value = codegen_utils->ir_builder()->CreateICmp(
+        kPredicate, llvm_cmp, codegen_utils->GetConstant<int32_t>(0));
+    return true;
+  }
+
+  /**
+   * @brief Create instructions for numeric_eq, numeric_ne, numeric_lt,
+   *        numeric_le, numeric_gt and numeric_ge functions
+   *
+   * @param codegen_utils     Utility to easy code generation.
+   * @param pg_func_info      Details for pgfunc generation
+   * @param llvm_out_value    Store the results of function
+   *
+   * @return true if generation was successful otherwise return false
+   **/
+  template <llvm::CmpInst::Predicate kPredicate>
+  static bool NumericCmp(gpcodegen::GpCodegenUtils* codegen_utils,
+                         const PGFuncGeneratorInfo& pg_func_info,
+                         llvm::Value** llvm_out_value) {
+    llvm::Value* llvm_cmp = nullptr;
+    if (!GenerateNumericCmp(codegen_utils, pg_func_info, &llvm_cmp)) {
+      return false;
+    }
+    *llvm_out_value = codegen_utils->ir_builder()->CreateICmp(
+        kPredicate, llvm_cmp, codegen_utils->GetConstant<int32_t>(0));
+    return true;
+  }
+
+  /**
+   * @brief Generate code that returns the pointer to the data of a varlena
+   *        and its data length, detoasting it if needed (see
+   *        pg_detoast_datum_packed, VARDATA_ANY and VARSIZE_ANY_EXHDR).
+   *
+   * @param codegen_utils     Utility to easy code generation.
+   * @param llvm_varlena      Pointer to the possibly toasted varlena
+   * @param llvm_out_data     Pointer to the first byte of data
+   * @param llvm_out_len      Length of data in bytes, as int32
+   *
+   * @note  Short values, i.e. with a 1-byte header, are read in place.
+   **/
+  static void GenerateDetoastPacked(gpcodegen::GpCodegenUtils* codegen_utils,
+                                    llvm::Value* llvm_varlena,
+                                    llvm::Value** llvm_out_data,
+                                    llvm::Value** llvm_out_len);
+
+  /**
+   * @brief Generate code that returns the length of a bpchar value without
+   *        its trailing spaces (see bcTruelen).
+   **/
+  static llvm::Value* GenerateBpcharTrueLen(
+      gpcodegen::GpCodegenUtils* codegen_utils,
+      llvm::Value* llvm_data,
+      llvm::Value* llvm_len);
+
+  /**
+   * @brief Generate code that compares two text or bpchar values as
+   *        varstr_cmp() does, returning an int32 less than, equal to or
+   *        greater than zero.
+   **/
+  static bool GenerateVarstrCmp(gpcodegen::GpCodegenUtils* codegen_utils,
+                                const PGFuncGeneratorInfo& pg_func_info,
+                                bool is_bpchar,
+                                llvm::Value** llvm_out_value);
+
+ private:
+  /**
+   * @brief Generate code that returns a pointer to the detoasted value of a
+   *        varlena, with a 4-byte header (see pg_detoast_datum).
+   *
+   * @note  Values with an uncompressed 4-byte header are returned as is;
+   *        any other value is detoasted by calling pg_detoast_datum().
+   **/
+  static llvm::Value* GenerateDetoast(gpcodegen::GpCodegenUtils* codegen_utils,
+                                      llvm::Value* llvm_varlena);
+
+  /**
+   * @brief Generate equality check of two text or bpchar values. Unequal
+   *        lengths are decided without looking at the data.
+   **/
+  static bool GenerateEq(gpcodegen::GpCodegenUtils* codegen_utils,
+                         const PGFuncGeneratorInfo& pg_func_info,
+                         bool is_bpchar,
+                         bool negate,
+                         llvm::Value** llvm_out_value);
+
+  /**
+   * @brief Generate code that compares two numeric values as cmp_numerics()
+   *        does, returning an int32 less than, equal to or greater than zero.
+   **/
+  static bool GenerateNumericCmp(gpcodegen::GpCodegenUtils* codegen_utils,
+                                 const PGFuncGeneratorInfo& pg_func_info,
+                                 llvm::Value** llvm_out_value);
+};
+
+/** @} */
+
+}  // namespace gpcodegen
+
+#endif  // GPCODEGEN_PG_TEXT_FUNC_GENERATOR_H_
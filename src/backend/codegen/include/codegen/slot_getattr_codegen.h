@@ -91,6 +91,13 @@ class SlotGetAttrCodegen : public BaseCodegen<SlotGetAttrFn> {
     return llvm_function_;
   }
 
+  /**
+   * @brief Append the shape of the slot's tuple descriptor up to max_attr.
+   *
+   * @note The slot itself is read through a rebindable constant.
+   **/
+  bool AppendFingerprint(std::string* fingerprint) const override;
+
  private:
   /**
    * @brief Constructor for SlotGetAttrCodegen
@@ -127,11 +134,14 @@ class SlotGetAttrCodegen : public BaseCodegen<SlotGetAttrFn> {
    * (through _slot_getsomeattrs), which fetches all yet unread attributes of
    * the slot until the given attribute.
    *
-   * This implementation does not support:
-   *  (1) Attributes passed by reference
+   * Attributes passed by reference, including varlena (with either a 1-byte
+   * or a 4-byte header) and cstring attributes, point into the tuple as in
+   * slot_deform_tuple. Generation fails for attributes passed by value whose
+   * length is not that of char, int16, int32 or Datum.
    *
-   * If at execution time, we see any of the above types of attributes,
-   * we fall backs to the regular function.
+   * Memtuples, as stored by append-only scans, are deformed up to max_attr
+   * into the slot like slot_getsomeattrs() does, with the layout of the
+   * slot's MemTupleBinding inlined.
    **/
   bool GenerateSlotGetAttr(
       gpcodegen::GpCodegenUtils* codegen_utils,
@@ -139,6 +149,42 @@ class SlotGetAttrCodegen : public BaseCodegen<SlotGetAttrFn> {
       int max_attr,
       llvm::Function* out_func);
 
+  /**
+   * @brief Generate code that deforms a memtuple into the values and isnull
+   * arrays of the slot, up to max_attr, for one layout of its binding.
+   *
+   * @param codegen_utils   Utilities for easy code generation
+   * @param tupdesc         Tuple descriptor of the binding
+   * @param colbind         Layout of the memtuple, either the small or the
+   *                        large one of the binding
+   * @param max_attr        Deform up to this many attributes
+   * @param llvm_start      Start of the memtuple, past the null bitmap
+   *                        extra size if the tuple has nulls
+   * @param llvm_nullp      Null bitmap of the tuple, or nullptr if the tuple
+   *                        is known not to have nulls
+   * @param llvm_null_saves null_saves_aligned of the layout; only used if
+   *                        llvm_nullp is set
+   * @param llvm_values     Values array of the slot
+   * @param llvm_isnull     Isnull array of the slot
+   *
+   * @return true on successful generation; false otherwise
+   *
+   * @note This is memtuple_getattr() with the offsets, the null bitmap
+   * positions and the binding flags of each attribute known at generation
+   * time. Only the space saved by preceding null attributes is looked up at
+   * run time. Code is emitted at the current insertion point.
+   **/
+  static bool GenerateMemTupleDeform(
+      gpcodegen::GpCodegenUtils* codegen_utils,
+      TupleDesc tupdesc,
+      MemTupleBindingCols* colbind,
+      int max_attr,
+      llvm::Value* llvm_start,
+      llvm::Value* llvm_nullp,
+      llvm::Value* llvm_null_saves,
+      llvm::Value* llvm_values,
+      llvm::Value* llvm_isnull);
+
   /**
    * @brief Removes the entry of this SlotGetAttrCodegen from the static cache.
    */
@@ -346,6 +346,21 @@ class CodegenUtils {
   template <typename DestType, typename SrcType>
   llvm::Value* CreateCast(llvm::Value* value);
 
+  /**
+   * @brief Allocate a variable on the stack of the function being generated.
+   *
+   * @note The alloca is placed at the top of the function's entry block,
+   *       wherever the IRBuilder currently is, so that mem2reg can promote it
+   *       to a register.
+   *
+   * @param type Type of the variable
+   * @param name Optional name of the returned variable in IR
+   *
+   * @return Pointer to the variable.
+   **/
+  llvm::AllocaInst* CreateEntryBlockAlloca(llvm::Type* type,
+                                           const std::string& name = "");
+
   /**
    * @brief Similar to tuple in C++, this helps to create fixed-size collection
    *        of hetrogeneous values.
@@ -486,6 +501,29 @@ class CodegenUtils {
   template <typename FunctionType>
   FunctionType GetFunctionPointer(const std::string& function_name);
 
+  /**
+   * @brief Generate machine code for all functions in the module at once,
+   *        instead of on the first call to GetFunctionPointer().
+   *
+   * @note PrepareForExecution() should be called before calling this method.
+   **/
+  void FinalizeCompilation() {
+    if (engine_) {
+      engine_->finalizeObject();
+    }
+  }
+
+  /**
+   * @return Number of bytes of code and data sections emitted so far by the
+   *         ExecutionEngine set up in PrepareForExecution().
+   *
+   * @note Since compilation may be deferred, this only accounts for functions
+   *       that were already retrieved with GetFunctionPointer().
+   **/
+  std::size_t GetCompiledCodeSize() const {
+    return compiled_code_size_;
+  }
+
 
   /**
     * @brief Generate the commonly used "fallback case" that generates a call to
@@ -665,6 +703,9 @@ class CodegenUtils {
   unsigned external_variable_counter_;
   unsigned external_function_counter_;
 
+  // Bytes allocated for sections by the memory manager of '*engine_'.
+  std::size_t compiled_code_size_;
+
   DISALLOW_COPY_AND_ASSIGN(CodegenUtils);
 };
 
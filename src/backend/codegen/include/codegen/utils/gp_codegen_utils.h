@@ -18,6 +18,8 @@
 #ifndef GPCODEGEN_GP_CODEGEN_UTILS_H_  // NOLINT(build/header_guard)
 #define GPCODEGEN_GP_CODEGEN_UTILS_H_
 
+#include <deque>
+
 #include "codegen/utils/codegen_utils.h"
 #include "codegen/codegen_wrapper.h"
 
@@ -324,6 +326,15 @@ class GpCodegenUtils : public CodegenUtils {
                             const char *func,
                             int line);
 
+  /**
+   * @brief Create instructions that compute the size of a varlena, including
+   *        its header, whatever the kind of its header (see VARSIZE_ANY).
+   *
+   * @param llvm_varlena  LLVM Value of the pointer to the varlena.
+   * @return LLVM Value of the size as int32.
+   */
+  llvm::Value* CreateVarSizeAny(llvm::Value* llvm_varlena);
+
   /**
    * @brief Create a Cast instruction to convert given llvm::Value of any type
    *        to Datum
@@ -338,6 +349,62 @@ class GpCodegenUtils : public CodegenUtils {
    **/
   llvm::Value* CreateCppTypeToDatumCast(llvm::Value* value,
                                         bool is_src_unsigned = false);
+
+  /**
+   * @brief Create instructions that load a plan-specific pointer from a cell
+   *        owned by this GpCodegenUtils instead of embedding it as a constant.
+   *
+   * @note Generated code that only refers to plan state (slots, expression
+   *       contexts, aggregate states, ...) through rebindable constants can be
+   *       reused by a structurally identical plan after calling
+   *       RebindConstants(). See CodegenCache.
+   *
+   * @tparam PointedType Type of the object pointed to by constant_value.
+   * @param constant_value Pointer value the cell initially holds.
+   *
+   * @return LLVM Value of type PointedType* loaded from the cell.
+   **/
+  template <typename PointedType>
+  llvm::Value* GetRebindableConstant(PointedType* constant_value) {
+    // std::deque never relocates existing elements on push_back, so the
+    // address we hand to the JIT stays valid for the lifetime of this object.
+    rebindable_constants_.push_back(
+        reinterpret_cast<const void*>(constant_value));
+    llvm::Value* llvm_cell = GetConstant<const void**>(
+        &rebindable_constants_.back());
+    return ir_builder()->CreateBitCast(
+        ir_builder()->CreateLoad(llvm_cell),
+        GetType<PointedType*>());
+  }
+
+  /**
+   * @return Number of rebindable constants created by GetRebindableConstant.
+   **/
+  size_t GetRebindableConstantCount() const {
+    return rebindable_constants_.size();
+  }
+
+  /**
+   * @brief Overwrite the values of all rebindable constants with the ones
+   *        recorded by source, in creation order.
+   *
+   * @param source GpCodegenUtils that generated the same code for another plan.
+   *
+   * @return true on success; false if the number of constants does not match.
+   **/
+  bool RebindConstants(const GpCodegenUtils& source) {
+    if (source.rebindable_constants_.size() != rebindable_constants_.size()) {
+      return false;
+    }
+    std::copy(source.rebindable_constants_.begin(),
+              source.rebindable_constants_.end(),
+              rebindable_constants_.begin());
+    return true;
+  }
+
+ private:
+  // Storage for the values read by code created with GetRebindableConstant.
+  std::deque<const void*> rebindable_constants_;
 };
 }  // namespace gpcodegen
 
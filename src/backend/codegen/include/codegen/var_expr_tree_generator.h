@@ -37,6 +37,8 @@ class VarExprTreeGenerator : public ExprTreeGenerator {
                     const ExprTreeGeneratorInfo& gen_info,
                     llvm::Value** llvm_out_value,
                     llvm::Value* const llvm_isnull_ptr) final;
+
+  bool AppendFingerprint(std::string* fingerprint) const final;
  protected:
   /**
    * @brief Constructor.
@@ -0,0 +1,319 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    mk_compare_codegen.cc
+//
+//  @doc:
+//    Generates code for tupsort_compare_datum function.
+//
+//---------------------------------------------------------------------------
+#include <assert.h>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include "codegen/mk_compare_codegen.h"
+#include "codegen/pg_func_generator_interface.h"
+#include "codegen/pg_text_func_generator.h"
+#include "codegen/utils/gp_codegen_utils.h"
+#include "codegen/utils/utility.h"
+
+#include "llvm/IR/IRBuilder.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#include "utils/elog.h"
+#include "utils/lsyscache.h"
+#include "utils/pg_locale.h"
+#include "utils/tuplesort_mk_details.h"
+}
+
+namespace llvm {
+class BasicBlock;
+class Function;
+class Value;
+}  // namespace llvm
+
+using gpcodegen::MKCompareCodegen;
+using gpcodegen::PGFuncGeneratorInfo;
+using gpcodegen::PGTextFuncGenerator;
+
+constexpr char MKCompareCodegen::kMKComparePrefix[];
+
+namespace {
+
+// Oids of the btree comparison functions we generate code for
+constexpr unsigned int kBtInt2CmpOid = 350;
+constexpr unsigned int kBtInt4CmpOid = 351;
+constexpr unsigned int kBtOidCmpOid = 356;
+constexpr unsigned int kBtTextCmpOid = 360;
+constexpr unsigned int kBtInt8CmpOid = 842;
+constexpr unsigned int kBpcharCmpOid = 1078;
+constexpr unsigned int kDateCmpOid = 1092;
+constexpr unsigned int kTimestamptzCmpOid = 1314;
+constexpr unsigned int kTimestampCmpOid = 2045;
+
+// (a < b) ? -1 : ((a == b) ? 0 : 1)
+llvm::Value* GenerateThreeWayCmp(gpcodegen::GpCodegenUtils* codegen_utils,
+                                 llvm::Value* llvm_lt,
+                                 llvm::Value* llvm_ne) {
+  auto irb = codegen_utils->ir_builder();
+  return irb->CreateSelect(
+      llvm_lt,
+      codegen_utils->GetConstant<int32_t>(-1),
+      irb->CreateZExt(llvm_ne, codegen_utils->GetType<int32_t>()));
+}
+
+template <typename IntType>
+llvm::Value* GenerateIntCmp(gpcodegen::GpCodegenUtils* codegen_utils,
+                            llvm::Value* llvm_datum1,
+                            llvm::Value* llvm_datum2) {
+  auto irb = codegen_utils->ir_builder();
+  llvm::Value* llvm_val1 =
+      codegen_utils->CreateDatumToCppTypeCast<IntType>(llvm_datum1);
+  llvm::Value* llvm_val2 =
+      codegen_utils->CreateDatumToCppTypeCast<IntType>(llvm_datum2);
+  return GenerateThreeWayCmp(
+      codegen_utils,
+      std::is_signed<IntType>::value ?
+          irb->CreateICmpSLT(llvm_val1, llvm_val2) :
+          irb->CreateICmpULT(llvm_val1, llvm_val2),
+      irb->CreateICmpNE(llvm_val1, llvm_val2));
+}
+
+// True if the varlena can be read in place, i.e. it has a short header or an
+// uncompressed 4-byte header (see GenerateDetoastPacked)
+llvm::Value* GenerateIsPlainVarlena(gpcodegen::GpCodegenUtils* codegen_utils,
+                                    llvm::Value* llvm_varlena) {
+  auto irb = codegen_utils->ir_builder();
+  llvm::Value* llvm_header = irb->CreateLoad(llvm_varlena);
+  llvm::Value* llvm_is_4b_u = irb->CreateICmpEQ(
+      irb->CreateAnd(llvm_header, codegen_utils->GetConstant<uint8>(0xC0)),
+      codegen_utils->GetConstant<uint8>(0x00));
+  llvm::Value* llvm_is_1b_not_e = irb->CreateAnd(
+      irb->CreateICmpEQ(
+          irb->CreateAnd(llvm_header, codegen_utils->GetConstant<uint8>(0x80)),
+          codegen_utils->GetConstant<uint8>(0x80)),
+      irb->CreateICmpNE(llvm_header, codegen_utils->GetConstant<uint8>(0x80)));
+  return irb->CreateOr(llvm_is_4b_u, llvm_is_1b_not_e);
+}
+
+}  // namespace
+
+MKCompareCodegen::MKCompareCodegen(
+    CodegenManager* manager,
+    MKCompareFn regular_func_ptr,
+    MKCompareFn* ptr_to_regular_func_ptr,
+    int num_keys,
+    unsigned int* sort_operators)
+    : BaseCodegen(manager,
+                  kMKComparePrefix,
+                  regular_func_ptr, ptr_to_regular_func_ptr) {
+  for (int i = 0; i < num_keys; ++i) {
+    Oid sort_function = InvalidOid;
+    bool reverse = false;
+    if (!get_compare_function_for_ordering_op(sort_operators[i],
+                                              &sort_function, &reverse)) {
+      // create_mksort_context() will complain; leave the keys unsupported
+      sort_func_oids_.clear();
+      reverse_.clear();
+      break;
+    }
+    sort_func_oids_.push_back(sort_function);
+    reverse_.push_back(reverse);
+  }
+}
+
+bool MKCompareCodegen::IsSupportedSortFunction(unsigned int sort_func_oid) {
+  switch (sort_func_oid) {
+    case kBtInt2CmpOid:
+    case kBtInt4CmpOid:
+    case kBtOidCmpOid:
+    case kBtInt8CmpOid:
+    case kDateCmpOid:
+      return true;
+#ifdef HAVE_INT64_TIMESTAMP
+    case kTimestamptzCmpOid:
+    case kTimestampCmpOid:
+      return true;
+#endif
+    case kBtTextCmpOid:
+    case kBpcharCmpOid:
+      // Otherwise the level holds a strxfrm'ed value (see tupsort_prepare)
+      return lc_collate_is_c();
+    default:
+      return false;
+  }
+}
+
+bool MKCompareCodegen::AppendFingerprint(std::string* fingerprint) const {
+  for (size_t i = 0; i < sort_func_oids_.size(); ++i) {
+    fingerprint->append(std::to_string(sort_func_oids_[i]));
+    fingerprint->append(reverse_[i] ? "d," : "a,");
+  }
+  return true;
+}
+
+llvm::Value* MKCompareCodegen::GenerateSortFunction(
+    gpcodegen::GpCodegenUtils* codegen_utils,
+    unsigned int sort_func_oid,
+    llvm::Value* llvm_datum1,
+    llvm::Value* llvm_datum2,
+    llvm::BasicBlock* llvm_fallback_block) {
+  auto irb = codegen_utils->ir_builder();
+  switch (sort_func_oid) {
+    case kBtInt2CmpOid:
+      return GenerateIntCmp<int16_t>(codegen_utils, llvm_datum1, llvm_datum2);
+    case kBtInt4CmpOid:
+    case kDateCmpOid:
+      return GenerateIntCmp<int32_t>(codegen_utils, llvm_datum1, llvm_datum2);
+    case kBtOidCmpOid:
+      return GenerateIntCmp<uint32_t>(codegen_utils, llvm_datum1, llvm_datum2);
+    case kBtInt8CmpOid:
+    case kTimestamptzCmpOid:
+    case kTimestampCmpOid:
+      return GenerateIntCmp<int64_t>(codegen_utils, llvm_datum1, llvm_datum2);
+    case kBtTextCmpOid:
+    case kBpcharCmpOid: {
+      llvm::Function* current_function = irb->GetInsertBlock()->getParent();
+      llvm::BasicBlock* plain_block = codegen_utils->CreateBasicBlock(
+          "plain_varlena_block", current_function);
+
+      // Values that need detoasting are left to tupsort_compare_datum(),
+      // which frees the detoasted copies; the sort never resets its memory.
+      llvm::Value* llvm_varlena1 =
+          codegen_utils->CreateDatumToCppTypeCast<void*>(llvm_datum1);
+      llvm::Value* llvm_varlena2 =
+          codegen_utils->CreateDatumToCppTypeCast<void*>(llvm_datum2);
+      irb->CreateCondBr(
+          irb->CreateAnd(GenerateIsPlainVarlena(codegen_utils, llvm_varlena1),
+                         GenerateIsPlainVarlena(codegen_utils, llvm_varlena2)),
+          plain_block /* true */,
+          llvm_fallback_block /* false */);
+
+      irb->SetInsertPoint(plain_block);
+      PGFuncGeneratorInfo pg_func_info(current_function, llvm_fallback_block,
+                                       {llvm_varlena1, llvm_varlena2}, {});
+      llvm::Value* llvm_cmp = nullptr;
+      if (!PGTextFuncGenerator::GenerateVarstrCmp(
+          codegen_utils, pg_func_info,
+          kBpcharCmpOid == sort_func_oid, &llvm_cmp)) {
+        return nullptr;
+      }
+      return llvm_cmp;
+    }
+    default:
+      assert(false);
+      return nullptr;
+  }
+}
+
+bool MKCompareCodegen::GenerateMKCompare(
+    gpcodegen::GpCodegenUtils* codegen_utils) {
+  assert(nullptr != codegen_utils);
+  bool any_supported = false;
+  for (unsigned int sort_func_oid : sort_func_oids_) {
+    any_supported |= IsSupportedSortFunction(sort_func_oid);
+  }
+  if (!any_supported) {
+    return false;
+  }
+
+  auto irb = codegen_utils->ir_builder();
+
+  llvm::Function* mk_compare_func = CreateFunction<MKCompareFn>(
+      codegen_utils, GetUniqueFuncName());
+
+  // External functions
+  llvm::Function* llvm_tupsort_compare_datum =
+      codegen_utils->GetOrRegisterExternalFunction(tupsort_compare_datum,
+                                                   "tupsort_compare_datum");
+
+  // Function arguments to tupsort_compare_datum
+  llvm::Value* llvm_v1_arg = ArgumentByPosition(mk_compare_func, 0);
+  llvm::Value* llvm_v2_arg = ArgumentByPosition(mk_compare_func, 1);
+  llvm::Value* llvm_lvctxt_arg = ArgumentByPosition(mk_compare_func, 2);
+  llvm::Value* llvm_mkctxt_arg = ArgumentByPosition(mk_compare_func, 3);
+
+  llvm::BasicBlock* entry_block = codegen_utils->CreateBasicBlock(
+      "entry_block", mk_compare_func);
+  llvm::BasicBlock* fallback_block = codegen_utils->CreateBasicBlock(
+      "fallback_block", mk_compare_func);
+
+  // entry block
+  // ----------
+  irb->SetInsertPoint(entry_block);
+
+#ifdef CODEGEN_DEBUG
+  EXPAND_CREATE_ELOG(codegen_utils, DEBUG1,
+                     "Codegen'ed tupsort_compare_datum called!");
+#endif
+
+  // lv = lvctxt - mkctxt->lvctxt;
+  llvm::Value* llvm_lvctxt_base = irb->CreateLoad(
+      codegen_utils->GetPointerToMember(llvm_mkctxt_arg, &MKContext::lvctxt));
+  llvm::Value* llvm_lv = irb->CreateExactSDiv(
+      irb->CreateSub(
+          irb->CreatePtrToInt(llvm_lvctxt_arg,
+                              codegen_utils->GetType<int64_t>()),
+          irb->CreatePtrToInt(llvm_lvctxt_base,
+                              codegen_utils->GetType<int64_t>())),
+      codegen_utils->GetConstant<int64_t>(sizeof(MKLvContext)));
+
+  // Datums prepared for the level
+  llvm::Value* llvm_datum1 = irb->CreateLoad(
+      codegen_utils->GetPointerToMember(llvm_v1_arg, &MKEntry::d));
+  llvm::Value* llvm_datum2 = irb->CreateLoad(
+      codegen_utils->GetPointerToMember(llvm_v2_arg, &MKEntry::d));
+
+  llvm::SwitchInst* llvm_switch = irb->CreateSwitch(
+      llvm_lv, fallback_block, sort_func_oids_.size());
+  for (size_t i = 0; i < sort_func_oids_.size(); ++i) {
+    if (!IsSupportedSortFunction(sort_func_oids_[i])) {
+      continue;
+    }
+    llvm::BasicBlock* level_block = codegen_utils->CreateBasicBlock(
+        "level_block_" + std::to_string(i), mk_compare_func);
+    llvm_switch->addCase(
+        llvm::cast<llvm::ConstantInt>(
+            codegen_utils->GetConstant<int64_t>(static_cast<int64_t>(i))),
+        level_block);
+
+    irb->SetInsertPoint(level_block);
+    llvm::Value* llvm_cmp = GenerateSortFunction(
+        codegen_utils, sort_func_oids_[i],
+        llvm_datum1, llvm_datum2, fallback_block);
+    if (nullptr == llvm_cmp) {
+      return false;
+    }
+    // Descending keys use btree's convention of negating the result
+    if (reverse_[i]) {
+      llvm_cmp = irb->CreateNeg(llvm_cmp);
+    }
+    irb->CreateRet(llvm_cmp);
+  }
+
+  // fallback block
+  // ----------
+  // Levels we do not support, and values we cannot compare in place
+  irb->SetInsertPoint(fallback_block);
+  irb->CreateRet(irb->CreateCall(llvm_tupsort_compare_datum, {
+      llvm_v1_arg, llvm_v2_arg, llvm_lvctxt_arg, llvm_mkctxt_arg}));
+
+  return true;
+}
+
+bool MKCompareCodegen::GenerateCodeInternal(
+    GpCodegenUtils* codegen_utils) {
+  bool isGenerated = GenerateMKCompare(codegen_utils);
+
+  if (isGenerated) {
+    elog(DEBUG1, "tupsort_compare_datum was generated successfully!");
+    return true;
+  } else {
+    elog(DEBUG1, "tupsort_compare_datum generation failed!");
+    return false;
+  }
+}
@@ -0,0 +1,119 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    null_test_expr_tree_generator.cc
+//
+//  @doc:
+//    Object that generate code for IS NULL and IS NOT NULL expression.
+//
+//---------------------------------------------------------------------------
+
+#include <assert.h>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "codegen/expr_tree_generator.h"
+#include "codegen/null_test_expr_tree_generator.h"
+#include "codegen/utils/gp_codegen_utils.h"
+
+#include "llvm/IR/IRBuilder.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#include "nodes/execnodes.h"
+#include "nodes/nodes.h"
+#include "nodes/primnodes.h"
+#include "utils/elog.h"
+}
+
+using gpcodegen::NullTestExprTreeGenerator;
+using gpcodegen::ExprTreeGenerator;
+using gpcodegen::GpCodegenUtils;
+
+NullTestExprTreeGenerator::NullTestExprTreeGenerator(
+    const ExprState* expr_state,
+    std::unique_ptr<ExprTreeGenerator> arg)
+    : ExprTreeGenerator(expr_state, ExprTreeNodeType::kNullTest),
+      arg_(std::move(arg)) {
+}
+
+bool NullTestExprTreeGenerator::VerifyAndCreateExprTree(
+    const ExprState* expr_state,
+    ExprTreeGeneratorInfo* gen_info,
+    std::unique_ptr<ExprTreeGenerator>* expr_tree) {
+  assert(nullptr != expr_state &&
+         nullptr != expr_state->expr &&
+         T_NullTest == nodeTag(expr_state->expr) &&
+         nullptr != expr_tree);
+
+  expr_tree->reset(nullptr);
+  const NullTestState* null_test_state =
+      reinterpret_cast<const NullTestState*>(expr_state);
+  if (null_test_state->argisrow) {
+    elog(DEBUG1, "NULL test on composite value is not supported.");
+    return false;
+  }
+
+  assert(nullptr != null_test_state->arg);
+  std::unique_ptr<ExprTreeGenerator> arg(nullptr);
+  if (!ExprTreeGenerator::VerifyAndCreateExprTree(null_test_state->arg,
+                                                  gen_info,
+                                                  &arg)) {
+    return false;
+  }
+  expr_tree->reset(new NullTestExprTreeGenerator(expr_state, std::move(arg)));
+  return true;
+}
+
+bool NullTestExprTreeGenerator::AppendFingerprint(
+    std::string* fingerprint) const {
+  NullTest* null_test = reinterpret_cast<NullTest*>(expr_state()->expr);
+  fingerprint->append(IS_NULL == null_test->nulltesttype ? "N(" : "NN(");
+  if (!arg_->AppendFingerprint(fingerprint)) {
+    return false;
+  }
+  fingerprint->append(")");
+  return true;
+}
+
+bool NullTestExprTreeGenerator::GenerateCode(
+    GpCodegenUtils* codegen_utils,
+    const ExprTreeGeneratorInfo& gen_info,
+    llvm::Value** llvm_out_value,
+    llvm::Value* const llvm_isnull_ptr) {
+  assert(nullptr != llvm_out_value);
+  assert(nullptr != llvm_isnull_ptr);
+  *llvm_out_value = nullptr;
+  NullTest* null_test = reinterpret_cast<NullTest*>(expr_state()->expr);
+  auto irb = codegen_utils->ir_builder();
+
+  llvm::Value* llvm_arg_isnull_ptr = codegen_utils->CreateEntryBlockAlloca(
+      codegen_utils->GetType<bool>(), "isNull");
+  irb->CreateStore(codegen_utils->GetConstant<bool>(false),
+                   llvm_arg_isnull_ptr);
+  llvm::Value* llvm_arg = nullptr;
+  if (!arg_->GenerateCode(codegen_utils, gen_info,
+                          &llvm_arg, llvm_arg_isnull_ptr)) {
+    return false;
+  }
+
+  llvm::Value* llvm_result = irb->CreateLoad(llvm_arg_isnull_ptr);
+  switch (null_test->nulltesttype) {
+    case IS_NULL:
+      break;
+    case IS_NOT_NULL:
+      llvm_result = irb->CreateNot(llvm_result);
+      break;
+    default:
+      elog(DEBUG1, "Unsupported NULL test type %d.",
+           null_test->nulltesttype);
+      return false;
+  }
+  // The result of a NULL test is never NULL
+  irb->CreateStore(codegen_utils->GetConstant<bool>(false), llvm_isnull_ptr);
+  *llvm_out_value = codegen_utils->CreateCppTypeToDatumCast(llvm_result);
+  return true;
+}
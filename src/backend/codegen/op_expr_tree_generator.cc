@@ -3,16 +3,17 @@
 //  Copyright (C) 2016 Pivotal Software, Inc.
 //
 //  @filename:
-//    op_expr_tree_generator.h
+//    op_expr_tree_generator.cc
 //
 //  @doc:
-//    Object that generate code for operator expression.
+//    Object that generate code for operator and function expression.
 //
 //---------------------------------------------------------------------------
 
 #include <assert.h>
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
@@ -26,6 +27,7 @@
 #include "codegen/pg_arith_func_generator.h"
 #include "codegen/pg_date_func_generator.h"
 #include "codegen/pg_numeric_func_generator.h"
+#include "codegen/pg_text_func_generator.h"
 
 #include "llvm/IR/IRBuilder.h"
 
@@ -149,6 +151,39 @@ void OpExprTreeGenerator::InitializeSupportedFunction() {
           nullptr,
           true));
 
+  // Casts found as FuncExpr, e.g. in TPC-H arithmetic over mixed types
+  supported_function_[311] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<float8, float>(
+          311,
+          "ftod",
+          &PGArithUnaryFuncGenerator<float8, float>::WideningCast,
+          nullptr,
+          true));
+
+  supported_function_[316] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<float8, int32_t>(
+          316,
+          "i4tod",
+          &PGArithUnaryFuncGenerator<float8, int32_t>::WideningCast,
+          nullptr,
+          true));
+
+  supported_function_[481] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<int64_t, int32_t>(
+          481,
+          "int48",
+          &PGArithUnaryFuncGenerator<int64_t, int32_t>::WideningCast,
+          nullptr,
+          true));
+
+  supported_function_[482] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<float8, int64_t>(
+          482,
+          "i8tod",
+          &PGArithUnaryFuncGenerator<float8, int64_t>::WideningCast,
+          nullptr,
+          true));
+
   supported_function_[1088] = std::unique_ptr<PGFuncGeneratorInterface>(
       new PGIRBuilderFuncGenerator<bool, int32_t, int32_t>(
           1088, "date_le", &IRBuilder<>::CreateICmpSLE,
@@ -193,6 +228,152 @@ void OpExprTreeGenerator::InitializeSupportedFunction() {
           &PGNumericFuncGenerator::GenerateIntFloatAvgAmalg,
           nullptr,
           true));
+
+  // Comparison of varlena types. varchar has no operators of its own and
+  // uses the ones of text.
+  supported_function_[67] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          67,
+          "texteq",
+          &PGTextFuncGenerator::TextEq<llvm::CmpInst::ICMP_EQ>,
+          nullptr,
+          true));
+
+  supported_function_[157] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          157,
+          "textne",
+          &PGTextFuncGenerator::TextEq<llvm::CmpInst::ICMP_NE>,
+          nullptr,
+          true));
+
+  supported_function_[740] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          740,
+          "text_lt",
+          &PGTextFuncGenerator::TextCmp<llvm::CmpInst::ICMP_SLT>,
+          nullptr,
+          true));
+
+  supported_function_[741] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          741,
+          "text_le",
+          &PGTextFuncGenerator::TextCmp<llvm::CmpInst::ICMP_SLE>,
+          nullptr,
+          true));
+
+  supported_function_[742] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          742,
+          "text_gt",
+          &PGTextFuncGenerator::TextCmp<llvm::CmpInst::ICMP_SGT>,
+          nullptr,
+          true));
+
+  supported_function_[743] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          743,
+          "text_ge",
+          &PGTextFuncGenerator::TextCmp<llvm::CmpInst::ICMP_SGE>,
+          nullptr,
+          true));
+
+  supported_function_[1048] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          1048,
+          "bpchareq",
+          &PGTextFuncGenerator::BpcharEq<llvm::CmpInst::ICMP_EQ>,
+          nullptr,
+          true));
+
+  supported_function_[1053] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          1053,
+          "bpcharne",
+          &PGTextFuncGenerator::BpcharEq<llvm::CmpInst::ICMP_NE>,
+          nullptr,
+          true));
+
+  supported_function_[1049] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          1049,
+          "bpcharlt",
+          &PGTextFuncGenerator::BpcharCmp<llvm::CmpInst::ICMP_SLT>,
+          nullptr,
+          true));
+
+  supported_function_[1050] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          1050,
+          "bpcharle",
+          &PGTextFuncGenerator::BpcharCmp<llvm::CmpInst::ICMP_SLE>,
+          nullptr,
+          true));
+
+  supported_function_[1051] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          1051,
+          "bpchargt",
+          &PGTextFuncGenerator::BpcharCmp<llvm::CmpInst::ICMP_SGT>,
+          nullptr,
+          true));
+
+  supported_function_[1052] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          1052,
+          "bpcharge",
+          &PGTextFuncGenerator::BpcharCmp<llvm::CmpInst::ICMP_SGE>,
+          nullptr,
+          true));
+
+  supported_function_[1718] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          1718,
+          "numeric_eq",
+          &PGTextFuncGenerator::NumericCmp<llvm::CmpInst::ICMP_EQ>,
+          nullptr,
+          true));
+
+  supported_function_[1719] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          1719,
+          "numeric_ne",
+          &PGTextFuncGenerator::NumericCmp<llvm::CmpInst::ICMP_NE>,
+          nullptr,
+          true));
+
+  supported_function_[1722] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          1722,
+          "numeric_lt",
+          &PGTextFuncGenerator::NumericCmp<llvm::CmpInst::ICMP_SLT>,
+          nullptr,
+          true));
+
+  supported_function_[1723] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          1723,
+          "numeric_le",
+          &PGTextFuncGenerator::NumericCmp<llvm::CmpInst::ICMP_SLE>,
+          nullptr,
+          true));
+
+  supported_function_[1720] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          1720,
+          "numeric_gt",
+          &PGTextFuncGenerator::NumericCmp<llvm::CmpInst::ICMP_SGT>,
+          nullptr,
+          true));
+
+  supported_function_[1721] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          1721,
+          "numeric_ge",
+          &PGTextFuncGenerator::NumericCmp<llvm::CmpInst::ICMP_SGE>,
+          nullptr,
+          true));
 }
 
 PGFuncGeneratorInterface* OpExprTreeGenerator::GetPGFuncGenerator(
@@ -205,6 +386,15 @@ PGFuncGeneratorInterface* OpExprTreeGenerator::GetPGFuncGenerator(
   return itr->second.get();
 }
 
+unsigned int OpExprTreeGenerator::GetFuncOid(const Expr* expr) {
+  assert(nullptr != expr);
+  if (T_FuncExpr == nodeTag(expr)) {
+    return reinterpret_cast<const FuncExpr*>(expr)->funcid;
+  }
+  assert(T_OpExpr == nodeTag(expr));
+  return reinterpret_cast<const OpExpr*>(expr)->opfuncid;
+}
+
 OpExprTreeGenerator::OpExprTreeGenerator(
     const ExprState* expr_state,
     std::vector<
@@ -219,14 +409,20 @@ bool OpExprTreeGenerator::VerifyAndCreateExprTree(
     std::unique_ptr<ExprTreeGenerator>* expr_tree) {
   assert(nullptr != expr_state &&
          nullptr != expr_state->expr &&
-         T_OpExpr == nodeTag(expr_state->expr) &&
+         (T_OpExpr == nodeTag(expr_state->expr) ||
+          T_FuncExpr == nodeTag(expr_state->expr)) &&
          nullptr != expr_tree);
 
-  OpExpr* op_expr = reinterpret_cast<OpExpr*>(expr_state->expr);
   expr_tree->reset(nullptr);
-  PGFuncGeneratorInterface* pg_func_gen = GetPGFuncGenerator(op_expr->opfuncid);
+  if (T_FuncExpr == nodeTag(expr_state->expr) &&
+      reinterpret_cast<FuncExpr*>(expr_state->expr)->funcretset) {
+    elog(DEBUG1, "Set returning functions are not supported.");
+    return false;
+  }
+  unsigned int func_oid = GetFuncOid(expr_state->expr);
+  PGFuncGeneratorInterface* pg_func_gen = GetPGFuncGenerator(func_oid);
   if (nullptr == pg_func_gen) {
-    elog(DEBUG1, "Unsupported operator %d.", op_expr->opfuncid);
+    elog(DEBUG1, "Unsupported operator %d.", func_oid);
     return false;
   }
 
@@ -261,20 +457,34 @@ bool OpExprTreeGenerator::VerifyAndCreateExprTree(
   return true;
 }
 
+bool OpExprTreeGenerator::AppendFingerprint(std::string* fingerprint) const {
+  fingerprint->append("O");
+  fingerprint->append(std::to_string(GetFuncOid(expr_state()->expr)));
+  fingerprint->append("(");
+  for (const std::unique_ptr<ExprTreeGenerator>& arg : arguments_) {
+    if (!arg->AppendFingerprint(fingerprint)) {
+      return false;
+    }
+    fingerprint->append(",");
+  }
+  fingerprint->append(")");
+  return true;
+}
+
 bool OpExprTreeGenerator::GenerateCode(GpCodegenUtils* codegen_utils,
                                        const ExprTreeGeneratorInfo& gen_info,
                                        llvm::Value** llvm_out_value,
                                        llvm::Value* const llvm_isnull_ptr) {
   assert(nullptr != llvm_out_value);
   *llvm_out_value = nullptr;
-  OpExpr* op_expr = reinterpret_cast<OpExpr*>(expr_state()->expr);
-  CodeGenFuncMap::iterator itr =  supported_function_.find(op_expr->opfuncid);
+  unsigned int func_oid = GetFuncOid(expr_state()->expr);
+  CodeGenFuncMap::iterator itr =  supported_function_.find(func_oid);
   auto irb = codegen_utils->ir_builder();
 
   if (itr == supported_function_.end()) {
     // Operators are stored in pg_proc table.
     // See postgres.bki for more details.
-    elog(WARNING, "Unsupported operator %d.", op_expr->opfuncid);
+    elog(WARNING, "Unsupported operator %d.", func_oid);
     return false;
   }
 
@@ -291,8 +501,8 @@ bool OpExprTreeGenerator::GenerateCode(GpCodegenUtils* codegen_utils,
   std::vector<llvm::Value*> llvm_arguments;
   std::vector<llvm::Value*> llvm_arguments_isNull;
   for (auto& arg : arguments_) {
-    llvm::Value* llvm_arg_isnull_ptr = irb->CreateAlloca(
-        codegen_utils->GetType<bool>(), nullptr, "isNull");
+    llvm::Value* llvm_arg_isnull_ptr = codegen_utils->CreateEntryBlockAlloca(
+        codegen_utils->GetType<bool>(), "isNull");
     irb->CreateStore(codegen_utils->GetConstant<bool>(false),
                      llvm_arg_isnull_ptr);
 
@@ -0,0 +1,339 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    pg_hash_func_generator.cc
+//
+//  @doc:
+//    Base class to generate code for hash functions and cdbhash
+//
+//---------------------------------------------------------------------------
+
+#include <assert.h>
+#include <cstdint>
+#include <type_traits>
+
+#include "codegen/pg_hash_func_generator.h"
+#include "codegen/pg_text_func_generator.h"
+#include "codegen/utils/gp_codegen_utils.h"
+
+#include "llvm/IR/Constant.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Value.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#include "access/hash.h"
+#include "catalog/pg_type.h"
+#include "cdb/cdbhash.h"
+#include "utils/date.h"
+#include "utils/elog.h"
+}
+
+using gpcodegen::GpCodegenUtils;
+using gpcodegen::PGHashFuncGenerator;
+using gpcodegen::PGTextFuncGenerator;
+
+namespace {
+
+// FNV-1 32 bit prime and the value hashed for NULLs, see cdbhash.c
+constexpr uint32_t kFnv32Prime = 0x01000193;
+constexpr uint32_t kCdbHashNullValue = 0xF0F0F0F1;
+
+}  // namespace
+
+bool PGHashFuncGenerator::GenerateHashFunction(
+    gpcodegen::GpCodegenUtils* codegen_utils,
+    unsigned int hash_func_oid,
+    llvm::Value* llvm_datum,
+    llvm::Value** llvm_out_value) {
+  assert(nullptr != llvm_datum);
+  assert(nullptr != llvm_out_value);
+  auto irb = codegen_utils->ir_builder();
+  llvm::Function* llvm_hash_uint32 = codegen_utils->
+      GetOrRegisterExternalFunction(hash_uint32, "hash_uint32");
+
+  llvm::Value* llvm_key = nullptr;
+  switch (hash_func_oid) {
+    case 449: {  // hashint2
+      llvm_key = irb->CreateSExt(
+          codegen_utils->CreateDatumToCppTypeCast<int16_t>(llvm_datum),
+          codegen_utils->GetType<uint32_t>());
+      break;
+    }
+    case 450:  // hashint4
+    case 453: {  // hashoid
+      llvm_key = codegen_utils->CreateDatumToCppTypeCast<uint32_t>(llvm_datum);
+      break;
+    }
+    case 454: {  // hashchar
+      llvm::Value* llvm_char =
+          codegen_utils->CreateDatumToCppTypeCast<char>(llvm_datum);
+      llvm_key = std::is_signed<char>::value ?
+          irb->CreateSExt(llvm_char, codegen_utils->GetType<uint32_t>()) :
+          irb->CreateZExt(llvm_char, codegen_utils->GetType<uint32_t>());
+      break;
+    }
+    case 949: {  // hashint8
+      // Xor the high half into the low half, or its complement for negative
+      // values, so that the result matches hashint4 for equal values.
+      llvm::Value* llvm_val =
+          codegen_utils->CreateDatumToCppTypeCast<int64_t>(llvm_datum);
+      llvm::Value* llvm_lohalf = irb->CreateTrunc(
+          llvm_val, codegen_utils->GetType<uint32_t>());
+      llvm::Value* llvm_hihalf = irb->CreateTrunc(
+          irb->CreateLShr(llvm_val, 32), codegen_utils->GetType<uint32_t>());
+      llvm_hihalf = irb->CreateSelect(
+          irb->CreateICmpSGE(llvm_val, codegen_utils->GetConstant<int64_t>(0)),
+          llvm_hihalf,
+          irb->CreateNot(llvm_hihalf));
+      llvm_key = irb->CreateXor(llvm_lohalf, llvm_hihalf);
+      break;
+    }
+    case 400:  // hashtext
+    case 1080: {  // hashbpchar
+      llvm::Function* llvm_hash_any = codegen_utils->
+          GetOrRegisterExternalFunction(hash_any, "hash_any");
+      llvm::Value* llvm_data = nullptr;
+      llvm::Value* llvm_len = nullptr;
+      PGTextFuncGenerator::GenerateDetoastPacked(
+          codegen_utils,
+          codegen_utils->CreateDatumToCppTypeCast<void*>(llvm_datum),
+          &llvm_data, &llvm_len);
+      if (1080 == hash_func_oid) {
+        llvm_len = PGTextFuncGenerator::GenerateBpcharTrueLen(
+            codegen_utils, llvm_data, llvm_len);
+      }
+      *llvm_out_value = irb->CreateTrunc(
+          irb->CreateCall(llvm_hash_any, {llvm_data, llvm_len}),
+          codegen_utils->GetType<uint32_t>());
+      return true;
+    }
+    default:
+      elog(DEBUG1, "Unsupported hash function with oid = %d", hash_func_oid);
+      return false;
+  }
+
+  *llvm_out_value = irb->CreateTrunc(
+      irb->CreateCall(llvm_hash_uint32, {llvm_key}),
+      codegen_utils->GetType<uint32_t>());
+  return true;
+}
+
+void PGHashFuncGenerator::GenerateCdbHash(
+    gpcodegen::GpCodegenUtils* codegen_utils,
+    unsigned int type,
+    llvm::Value* llvm_datum,
+    llvm::Value* llvm_cdbhash) {
+  assert(nullptr != llvm_datum);
+  assert(nullptr != llvm_cdbhash);
+  auto irb = codegen_utils->ir_builder();
+
+  llvm::Value* llvm_hash_ptr = codegen_utils->GetPointerToMember(
+      llvm_cdbhash, &CdbHash::hash);
+  llvm::Value* llvm_hval = irb->CreateLoad(llvm_hash_ptr);
+
+  switch (type) {
+    // All integers are widened to 8 bytes before hashing
+    case INT2OID: {
+      llvm_hval = GenerateFnv1Int(
+          codegen_utils,
+          irb->CreateSExt(
+              codegen_utils->CreateDatumToCppTypeCast<int16_t>(llvm_datum),
+              codegen_utils->GetType<int64_t>()),
+          sizeof(int64), llvm_hval);
+      break;
+    }
+    case INT4OID: {
+      llvm_hval = GenerateFnv1Int(
+          codegen_utils,
+          irb->CreateSExt(
+              codegen_utils->CreateDatumToCppTypeCast<int32_t>(llvm_datum),
+              codegen_utils->GetType<int64_t>()),
+          sizeof(int64), llvm_hval);
+      break;
+    }
+    case INT8OID: {
+      llvm_hval = GenerateFnv1Int(
+          codegen_utils,
+          codegen_utils->CreateDatumToCppTypeCast<int64_t>(llvm_datum),
+          sizeof(int64), llvm_hval);
+      break;
+    }
+    case DATEOID: {
+      llvm_hval = GenerateFnv1Int(
+          codegen_utils,
+          codegen_utils->CreateDatumToCppTypeCast<int32_t>(llvm_datum),
+          sizeof(DateADT), llvm_hval);
+      break;
+    }
+    case BPCHAROID:
+    case TEXTOID:
+    case VARCHAROID: {
+      llvm::Value* llvm_data = nullptr;
+      llvm::Value* llvm_len = nullptr;
+      PGTextFuncGenerator::GenerateDetoastPacked(
+          codegen_utils,
+          codegen_utils->CreateDatumToCppTypeCast<void*>(llvm_datum),
+          &llvm_data, &llvm_len);
+      llvm_len = GenerateIgnoreBlanks(codegen_utils, llvm_data, llvm_len);
+      llvm_hval = GenerateFnv1Buf(codegen_utils, llvm_data, llvm_len,
+                                  llvm_hval);
+      break;
+    }
+    default: {
+      llvm::Function* llvm_cdbhash_func = codegen_utils->
+          GetOrRegisterExternalFunction(cdbhash, "cdbhash");
+      irb->CreateCall(llvm_cdbhash_func, {
+          llvm_cdbhash,
+          llvm_datum,
+          codegen_utils->GetConstant<Oid>(type)});
+      return;
+    }
+  }
+
+  irb->CreateStore(llvm_hval, llvm_hash_ptr);
+}
+
+void PGHashFuncGenerator::GenerateCdbHashNull(
+    gpcodegen::GpCodegenUtils* codegen_utils,
+    llvm::Value* llvm_cdbhash) {
+  assert(nullptr != llvm_cdbhash);
+  auto irb = codegen_utils->ir_builder();
+
+  llvm::Value* llvm_hash_ptr = codegen_utils->GetPointerToMember(
+      llvm_cdbhash, &CdbHash::hash);
+  irb->CreateStore(
+      GenerateFnv1Int(codegen_utils,
+                      codegen_utils->GetConstant<uint32_t>(kCdbHashNullValue),
+                      sizeof(uint32), irb->CreateLoad(llvm_hash_ptr)),
+      llvm_hash_ptr);
+}
+
+llvm::Value* PGHashFuncGenerator::GenerateFnv1Int(
+    gpcodegen::GpCodegenUtils* codegen_utils,
+    llvm::Value* llvm_value,
+    int num_bytes,
+    llvm::Value* llvm_hval) {
+  auto irb = codegen_utils->ir_builder();
+  for (int i = 0; i < num_bytes; ++i) {
+#ifdef WORDS_BIGENDIAN
+    int shift = 8 * (num_bytes - 1 - i);
+#else
+    int shift = 8 * i;
+#endif
+    llvm::Value* llvm_byte = irb->CreateAnd(
+        irb->CreateTrunc(irb->CreateLShr(llvm_value, shift),
+                         codegen_utils->GetType<uint32_t>()),
+        codegen_utils->GetConstant<uint32_t>(0xFF));
+    // hval *= FNV_32_PRIME; hval ^= octet;
+    llvm_hval = irb->CreateXor(
+        irb->CreateMul(llvm_hval,
+                       codegen_utils->GetConstant<uint32_t>(kFnv32Prime)),
+        llvm_byte);
+  }
+  return llvm_hval;
+}
+
+llvm::Value* PGHashFuncGenerator::GenerateFnv1Buf(
+    gpcodegen::GpCodegenUtils* codegen_utils,
+    llvm::Value* llvm_data,
+    llvm::Value* llvm_len,
+    llvm::Value* llvm_hval) {
+  auto irb = codegen_utils->ir_builder();
+  llvm::BasicBlock* entry_block = irb->GetInsertBlock();
+  llvm::Function* current_function = entry_block->getParent();
+
+  llvm::BasicBlock* loop_block = codegen_utils->CreateBasicBlock(
+      "fnv1_loop_block", current_function);
+  llvm::BasicBlock* body_block = codegen_utils->CreateBasicBlock(
+      "fnv1_body_block", current_function);
+  llvm::BasicBlock* end_block = codegen_utils->CreateBasicBlock(
+      "fnv1_end_block", current_function);
+  irb->CreateBr(loop_block);
+
+  // while (bp < be) { hval *= FNV_32_PRIME; hval ^= *bp++; } {{
+  irb->SetInsertPoint(loop_block);
+  llvm::PHINode* llvm_index = irb->CreatePHI(
+      codegen_utils->GetType<int32_t>(), 2);
+  llvm_index->addIncoming(codegen_utils->GetConstant<int32_t>(0), entry_block);
+  llvm::PHINode* llvm_loop_hval = irb->CreatePHI(
+      codegen_utils->GetType<uint32_t>(), 2);
+  llvm_loop_hval->addIncoming(llvm_hval, entry_block);
+  irb->CreateCondBr(irb->CreateICmpSLT(llvm_index, llvm_len),
+                    body_block /* true */,
+                    end_block /* false */);
+
+  irb->SetInsertPoint(body_block);
+  llvm::Value* llvm_byte = irb->CreateZExt(
+      irb->CreateLoad(irb->CreateInBoundsGEP(llvm_data, llvm_index)),
+      codegen_utils->GetType<uint32_t>());
+  llvm_loop_hval->addIncoming(
+      irb->CreateXor(
+          irb->CreateMul(llvm_loop_hval,
+                         codegen_utils->GetConstant<uint32_t>(kFnv32Prime)),
+          llvm_byte),
+      body_block);
+  llvm_index->addIncoming(
+      irb->CreateAdd(llvm_index, codegen_utils->GetConstant<int32_t>(1)),
+      body_block);
+  irb->CreateBr(loop_block);
+  // }}
+
+  irb->SetInsertPoint(end_block);
+  return llvm_loop_hval;
+}
+
+llvm::Value* PGHashFuncGenerator::GenerateIgnoreBlanks(
+    gpcodegen::GpCodegenUtils* codegen_utils,
+    llvm::Value* llvm_data,
+    llvm::Value* llvm_len) {
+  auto irb = codegen_utils->ir_builder();
+  llvm::BasicBlock* entry_block = irb->GetInsertBlock();
+  llvm::Function* current_function = entry_block->getParent();
+
+  llvm::BasicBlock* check_space_block = codegen_utils->CreateBasicBlock(
+      "ignoreblanks_check_space_block", current_function);
+  llvm::BasicBlock* skip_space_block = codegen_utils->CreateBasicBlock(
+      "ignoreblanks_skip_space_block", current_function);
+  llvm::BasicBlock* end_block = codegen_utils->CreateBasicBlock(
+      "ignoreblanks_end_block", current_function);
+
+  // if (len > 1) {{
+  irb->CreateCondBr(
+      irb->CreateICmpSGT(llvm_len, codegen_utils->GetConstant<int32_t>(1)),
+      check_space_block /* true */,
+      end_block /* false */);
+
+  // while (data[len - 1] == ' ') { len--; if (len == 1) break; } {{
+  irb->SetInsertPoint(check_space_block);
+  llvm::PHINode* llvm_loop_len = irb->CreatePHI(
+      codegen_utils->GetType<int32_t>(), 2);
+  llvm_loop_len->addIncoming(llvm_len, entry_block);
+  llvm::Value* llvm_last = irb->CreateSub(
+      llvm_loop_len, codegen_utils->GetConstant<int32_t>(1));
+  llvm::Value* llvm_last_char = irb->CreateLoad(
+      irb->CreateInBoundsGEP(llvm_data, llvm_last));
+  irb->CreateCondBr(
+      irb->CreateICmpEQ(llvm_last_char, codegen_utils->GetConstant<char>(' ')),
+      skip_space_block /* true */,
+      end_block /* false */);
+
+  irb->SetInsertPoint(skip_space_block);
+  llvm_loop_len->addIncoming(llvm_last, skip_space_block);
+  irb->CreateCondBr(
+      irb->CreateICmpEQ(llvm_last, codegen_utils->GetConstant<int32_t>(1)),
+      end_block /* true */,
+      check_space_block /* false */);
+  // }}
+  // }}
+
+  irb->SetInsertPoint(end_block);
+  llvm::PHINode* llvm_result = irb->CreatePHI(
+      codegen_utils->GetType<int32_t>(), 3);
+  llvm_result->addIncoming(llvm_len, entry_block);
+  llvm_result->addIncoming(llvm_loop_len, check_space_block);
+  llvm_result->addIncoming(llvm_last, skip_space_block);
+  return llvm_result;
+}
@@ -0,0 +1,320 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    pg_text_func_generator.cc
+//
+//  @doc:
+//    Base class for text, bpchar and numeric comparison functions to generate
+//    code
+//
+//---------------------------------------------------------------------------
+
+#include <assert.h>
+#include <cstdint>
+#include <cstring>
+
+#include "codegen/pg_func_generator_interface.h"
+#include "codegen/pg_text_func_generator.h"
+#include "codegen/utils/gp_codegen_utils.h"
+
+#include "llvm/IR/Constant.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Value.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#include "fmgr.h"
+#include "utils/builtins.h"
+#include "utils/numeric.h"
+#include "utils/pg_locale.h"
+}
+
+using gpcodegen::GpCodegenUtils;
+using gpcodegen::PGTextFuncGenerator;
+using gpcodegen::PGFuncGeneratorInfo;
+
+llvm::Value* PGTextFuncGenerator::GenerateDetoast(
+    gpcodegen::GpCodegenUtils* codegen_utils,
+    llvm::Value* llvm_varlena) {
+  assert(nullptr != llvm_varlena);
+  auto irb = codegen_utils->ir_builder();
+  llvm::Function* llvm_pg_detoast_datum = codegen_utils->
+      GetOrRegisterExternalFunction(pg_detoast_datum, "pg_detoast_datum");
+  llvm::Function* current_function = irb->GetInsertBlock()->getParent();
+
+  llvm::BasicBlock* detoast_block = codegen_utils->CreateBasicBlock(
+      "detoast_block", current_function);
+  llvm::BasicBlock* end_detoast_block = codegen_utils->CreateBasicBlock(
+      "end_detoast_block", current_function);
+
+  // if (!VARATT_IS_4B_U(datum)) datum = pg_detoast_datum(datum); {{
+  llvm::Value* llvm_header = irb->CreateLoad(llvm_varlena);
+  llvm::BasicBlock* entry_block = irb->GetInsertBlock();
+  irb->CreateCondBr(
+      irb->CreateICmpEQ(
+          irb->CreateAnd(llvm_header, codegen_utils->GetConstant<uint8>(0xC0)),
+          codegen_utils->GetConstant<uint8>(0x00)),
+      end_detoast_block /* true */,
+      detoast_block /* false */);
+
+  irb->SetInsertPoint(detoast_block);
+  llvm::Value* llvm_detoasted =
+      irb->CreateCall(llvm_pg_detoast_datum, {llvm_varlena});
+  irb->CreateBr(end_detoast_block);
+  // }}
+
+  irb->SetInsertPoint(end_detoast_block);
+  llvm::PHINode* llvm_result = irb->CreatePHI(llvm_varlena->getType(), 2);
+  llvm_result->addIncoming(llvm_varlena, entry_block);
+  llvm_result->addIncoming(llvm_detoasted, detoast_block);
+  return llvm_result;
+}
+
+void PGTextFuncGenerator::GenerateDetoastPacked(
+    gpcodegen::GpCodegenUtils* codegen_utils,
+    llvm::Value* llvm_varlena,
+    llvm::Value** llvm_out_data,
+    llvm::Value** llvm_out_len) {
+  assert(nullptr != llvm_out_data);
+  assert(nullptr != llvm_out_len);
+  auto irb = codegen_utils->ir_builder();
+  llvm::Function* current_function = irb->GetInsertBlock()->getParent();
+
+  llvm::BasicBlock* short_block = codegen_utils->CreateBasicBlock(
+      "short_varlena_block", current_function);
+  llvm::BasicBlock* long_block = codegen_utils->CreateBasicBlock(
+      "long_varlena_block", current_function);
+  llvm::BasicBlock* end_block = codegen_utils->CreateBasicBlock(
+      "end_varlena_block", current_function);
+
+  // if (VARATT_IS_1B(datum) && !VARATT_IS_1B_E(datum)) {{
+  llvm::Value* llvm_header = irb->CreateLoad(llvm_varlena);
+  irb->CreateCondBr(
+      irb->CreateAnd(
+          irb->CreateICmpEQ(
+              irb->CreateAnd(llvm_header,
+                             codegen_utils->GetConstant<uint8>(0x80)),
+              codegen_utils->GetConstant<uint8>(0x80)),
+          irb->CreateICmpNE(llvm_header,
+                            codegen_utils->GetConstant<uint8>(0x80))),
+      short_block /* true */,
+      long_block /* false */);
+
+  // VARSIZE_1B(datum) - VARHDRSZ_SHORT
+  irb->SetInsertPoint(short_block);
+  llvm::Value* llvm_short_data = irb->CreateInBoundsGEP(
+      llvm_varlena, codegen_utils->GetConstant<int32_t>(VARHDRSZ_SHORT));
+  llvm::Value* llvm_short_len = irb->CreateSub(
+      irb->CreateZExt(
+          irb->CreateAnd(llvm_header,
+                         codegen_utils->GetConstant<uint8>(0x7F)),
+          codegen_utils->GetType<int32_t>()),
+      codegen_utils->GetConstant<int32_t>(VARHDRSZ_SHORT));
+  irb->CreateBr(end_block);
+  // }}
+
+  // else VARSIZE_4B(datum) - VARHDRSZ {{
+  // The length word is stored in network byte order (see VARSIZE_4B).
+  irb->SetInsertPoint(long_block);
+  llvm::Value* llvm_detoasted = GenerateDetoast(codegen_utils, llvm_varlena);
+  llvm::Value* llvm_long_size = nullptr;
+  for (int i = 0; i < 4; ++i) {
+    llvm::Value* llvm_byte = irb->CreateZExt(
+        irb->CreateLoad(irb->CreateInBoundsGEP(
+            llvm_detoasted, codegen_utils->GetConstant<int32_t>(i))),
+        codegen_utils->GetType<int32_t>());
+    llvm_long_size = (0 == i) ?
+        irb->CreateAnd(llvm_byte, codegen_utils->GetConstant<int32_t>(0x3F)) :
+        irb->CreateOr(
+            irb->CreateShl(llvm_long_size, 8), llvm_byte);
+  }
+  llvm::Value* llvm_long_data = irb->CreateInBoundsGEP(
+      llvm_detoasted, codegen_utils->GetConstant<int32_t>(VARHDRSZ));
+  llvm::Value* llvm_long_len = irb->CreateSub(
+      llvm_long_size, codegen_utils->GetConstant<int32_t>(VARHDRSZ));
+  // GenerateDetoast() leaves us in a different block
+  llvm::BasicBlock* long_end_block = irb->GetInsertBlock();
+  irb->CreateBr(end_block);
+  // }}
+
+  irb->SetInsertPoint(end_block);
+  llvm::PHINode* llvm_data = irb->CreatePHI(llvm_varlena->getType(), 2);
+  llvm_data->addIncoming(llvm_short_data, short_block);
+  llvm_data->addIncoming(llvm_long_data, long_end_block);
+  llvm::PHINode* llvm_len = irb->CreatePHI(
+      codegen_utils->GetType<int32_t>(), 2);
+  llvm_len->addIncoming(llvm_short_len, short_block);
+  llvm_len->addIncoming(llvm_long_len, long_end_block);
+
+  *llvm_out_data = llvm_data;
+  *llvm_out_len = llvm_len;
+}
+
+llvm::Value* PGTextFuncGenerator::GenerateBpcharTrueLen(
+    gpcodegen::GpCodegenUtils* codegen_utils,
+    llvm::Value* llvm_data,
+    llvm::Value* llvm_len) {
+  auto irb = codegen_utils->ir_builder();
+  llvm::BasicBlock* entry_block = irb->GetInsertBlock();
+  llvm::Function* current_function = entry_block->getParent();
+
+  llvm::BasicBlock* loop_block = codegen_utils->CreateBasicBlock(
+      "bpchar_truelen_loop_block", current_function);
+  llvm::BasicBlock* check_space_block = codegen_utils->CreateBasicBlock(
+      "bpchar_truelen_check_space_block", current_function);
+  llvm::BasicBlock* end_block = codegen_utils->CreateBasicBlock(
+      "bpchar_truelen_end_block", current_function);
+  irb->CreateBr(loop_block);
+
+  // for (i = len - 1; i >= 0; i--) { if (s[i] != ' ') break; } {{
+  irb->SetInsertPoint(loop_block);
+  llvm::PHINode* llvm_true_len = irb->CreatePHI(
+      codegen_utils->GetType<int32_t>(), 2);
+  llvm_true_len->addIncoming(llvm_len, entry_block);
+  irb->CreateCondBr(
+      irb->CreateICmpSGT(llvm_true_len, codegen_utils->GetConstant<int32_t>(0)),
+      check_space_block /* true */,
+      end_block /* false */);
+
+  irb->SetInsertPoint(check_space_block);
+  llvm::Value* llvm_last = irb->CreateSub(
+      llvm_true_len, codegen_utils->GetConstant<int32_t>(1));
+  llvm::Value* llvm_last_char = irb->CreateLoad(
+      irb->CreateInBoundsGEP(llvm_data, llvm_last));
+  llvm_true_len->addIncoming(llvm_last, check_space_block);
+  irb->CreateCondBr(
+      irb->CreateICmpEQ(llvm_last_char, codegen_utils->GetConstant<char>(' ')),
+      loop_block /* true */,
+      end_block /* false */);
+  // }}
+
+  irb->SetInsertPoint(end_block);
+  return llvm_true_len;
+}
+
+bool PGTextFuncGenerator::GenerateEq(
+    gpcodegen::GpCodegenUtils* codegen_utils,
+    const PGFuncGeneratorInfo& pg_func_info,
+    bool is_bpchar,
+    bool negate,
+    llvm::Value** llvm_out_value) {
+  assert(pg_func_info.llvm_args.size() == 2);
+  auto irb = codegen_utils->ir_builder();
+  llvm::Function* llvm_memcmp = codegen_utils->
+      GetOrRegisterExternalFunction(memcmp, "memcmp");
+
+  llvm::Value* llvm_data[2];
+  llvm::Value* llvm_len[2];
+  for (int i = 0; i < 2; ++i) {
+    GenerateDetoastPacked(codegen_utils, pg_func_info.llvm_args[i],
+                          &llvm_data[i], &llvm_len[i]);
+    if (is_bpchar) {
+      llvm_len[i] = GenerateBpcharTrueLen(codegen_utils,
+                                          llvm_data[i], llvm_len[i]);
+    }
+  }
+
+  llvm::Function* current_function = irb->GetInsertBlock()->getParent();
+  llvm::BasicBlock* compare_data_block = codegen_utils->CreateBasicBlock(
+      "compare_data_block", current_function);
+  llvm::BasicBlock* end_block = codegen_utils->CreateBasicBlock(
+      "end_compare_block", current_function);
+
+  // Values of different length are never equal, so we can skip memcmp()
+  llvm::BasicBlock* compare_len_block = irb->GetInsertBlock();
+  irb->CreateCondBr(irb->CreateICmpEQ(llvm_len[0], llvm_len[1]),
+                    compare_data_block /* true */,
+                    end_block /* false */);
+
+  irb->SetInsertPoint(compare_data_block);
+  llvm::Value* llvm_data_eq = irb->CreateICmpEQ(
+      irb->CreateCall(llvm_memcmp, {
+          llvm_data[0],
+          llvm_data[1],
+          irb->CreateZExt(llvm_len[0], codegen_utils->GetType<size_t>())}),
+      codegen_utils->GetConstant<int>(0));
+  irb->CreateBr(end_block);
+
+  irb->SetInsertPoint(end_block);
+  llvm::PHINode* llvm_eq = irb->CreatePHI(codegen_utils->GetType<bool>(), 2);
+  llvm_eq->addIncoming(codegen_utils->GetConstant<bool>(false),
+                       compare_len_block);
+  llvm_eq->addIncoming(llvm_data_eq, compare_data_block);
+
+  *llvm_out_value = negate ? irb->CreateNot(llvm_eq) : llvm_eq;
+  return true;
+}
+
+bool PGTextFuncGenerator::GenerateVarstrCmp(
+    gpcodegen::GpCodegenUtils* codegen_utils,
+    const PGFuncGeneratorInfo& pg_func_info,
+    bool is_bpchar,
+    llvm::Value** llvm_out_value) {
+  assert(pg_func_info.llvm_args.size() == 2);
+  auto irb = codegen_utils->ir_builder();
+
+  llvm::Value* llvm_data[2];
+  llvm::Value* llvm_len[2];
+  for (int i = 0; i < 2; ++i) {
+    GenerateDetoastPacked(codegen_utils, pg_func_info.llvm_args[i],
+                          &llvm_data[i], &llvm_len[i]);
+    if (is_bpchar) {
+      llvm_len[i] = GenerateBpcharTrueLen(codegen_utils,
+                                          llvm_data[i], llvm_len[i]);
+    }
+  }
+
+  // LC_COLLATE cannot change once the database is created, so it is safe to
+  // decide on the comparison at generation time.
+  if (!lc_collate_is_c()) {
+    llvm::Function* llvm_varstr_cmp = codegen_utils->
+        GetOrRegisterExternalFunction(varstr_cmp, "varstr_cmp");
+    *llvm_out_value = irb->CreateCall(llvm_varstr_cmp, {
+        llvm_data[0], llvm_len[0], llvm_data[1], llvm_len[1]});
+    return true;
+  }
+
+  // result = memcmp(arg1, arg2, Min(len1, len2));
+  // if ((result == 0) && (len1 != len2))
+  //   result = (len1 < len2) ? -1 : 1; {{
+  llvm::Function* llvm_memcmp = codegen_utils->
+      GetOrRegisterExternalFunction(memcmp, "memcmp");
+  llvm::Value* llvm_len_lt = irb->CreateICmpSLT(llvm_len[0], llvm_len[1]);
+  llvm::Value* llvm_min_len = irb->CreateSelect(llvm_len_lt,
+                                                llvm_len[0], llvm_len[1]);
+  llvm::Value* llvm_memcmp_result = irb->CreateCall(llvm_memcmp, {
+      llvm_data[0],
+      llvm_data[1],
+      irb->CreateZExt(llvm_min_len, codegen_utils->GetType<size_t>())});
+  llvm::Value* llvm_len_result = irb->CreateSelect(
+      llvm_len_lt,
+      codegen_utils->GetConstant<int32_t>(-1),
+      irb->CreateZExt(irb->CreateICmpNE(llvm_len[0], llvm_len[1]),
+                      codegen_utils->GetType<int32_t>()));
+  *llvm_out_value = irb->CreateSelect(
+      irb->CreateICmpEQ(llvm_memcmp_result, codegen_utils->GetConstant<int>(0)),
+      llvm_len_result,
+      llvm_memcmp_result);
+  // }}
+  return true;
+}
+
+bool PGTextFuncGenerator::GenerateNumericCmp(
+    gpcodegen::GpCodegenUtils* codegen_utils,
+    const PGFuncGeneratorInfo& pg_func_info,
+    llvm::Value** llvm_out_value) {
+  assert(pg_func_info.llvm_args.size() == 2);
+  auto irb = codegen_utils->ir_builder();
+  llvm::Function* llvm_cmp_numerics = codegen_utils->
+      GetOrRegisterExternalFunction(cmp_numerics, "cmp_numerics");
+
+  // Numeric needs an aligned 4-byte header, so short values are detoasted too
+  llvm::Value* llvm_num1 = GenerateDetoast(codegen_utils,
+                                           pg_func_info.llvm_args[0]);
+  llvm::Value* llvm_num2 = GenerateDetoast(codegen_utils,
+                                           pg_func_info.llvm_args[1]);
+  *llvm_out_value = irb->CreateCall(llvm_cmp_numerics, {llvm_num1, llvm_num2});
+  return true;
+}
@@ -38,8 +38,6 @@ extern "C" {
 #include "access/tupdesc.h"
 #include "access/tupmacs.h"
 #include "catalog/pg_attribute.h"
-
-extern void slot_deform_tuple(TupleTableSlot* slot, int nattr);
 }
 
 namespace llvm {
@@ -146,6 +144,47 @@ bool SlotGetAttrCodegen::GenerateCodeInternal(
   }
 }
 
+bool SlotGetAttrCodegen::AppendFingerprint(std::string* fingerprint) const {
+  TupleDesc tupleDesc = slot_->tts_tupleDescriptor;
+  fingerprint->append(std::to_string(max_attr_));
+  fingerprint->append("/");
+  fingerprint->append(std::to_string(tupleDesc->natts));
+  for (int attnum = 0; attnum < max_attr_ && attnum < tupleDesc->natts;
+      ++attnum) {
+    Form_pg_attribute thisatt = tupleDesc->attrs[attnum];
+    fingerprint->append(",");
+    fingerprint->append(std::to_string(thisatt->attlen));
+    fingerprint->push_back(thisatt->attbyval ? 'v' : 'r');
+    fingerprint->push_back(thisatt->attalign);
+    fingerprint->push_back(thisatt->attnotnull ? 'n' : 'z');
+  }
+  // The memtuple layout is inlined too, see GenerateMemTupleDeform()
+  MemTupleBinding* mt_bind = slot_->tts_mt_bind;
+  if (nullptr != mt_bind) {
+    fingerprint->append("/");
+    fingerprint->append(std::to_string(mt_bind->null_bitmap_extra_size));
+    fingerprint->push_back(mt_bind->tupdesc->tdhasoid ? 'o' : 'x');
+    for (const MemTupleBindingCols* colbind :
+         {&mt_bind->bind, &mt_bind->large_bind}) {
+      for (int attnum = 0; attnum < max_attr_ && attnum < tupleDesc->natts;
+          ++attnum) {
+        const MemTupleAttrBinding& attrbind = colbind->bindings[attnum];
+        fingerprint->append(",");
+        fingerprint->append(std::to_string(attrbind.offset));
+        fingerprint->append(":");
+        fingerprint->append(std::to_string(attrbind.len));
+        fingerprint->append(":");
+        fingerprint->append(std::to_string(attrbind.flag));
+        fingerprint->append(":");
+        fingerprint->append(std::to_string(attrbind.null_byte));
+        fingerprint->append(":");
+        fingerprint->append(std::to_string(attrbind.null_mask));
+      }
+    }
+  }
+  return true;
+}
+
 bool SlotGetAttrCodegen::GenerateSlotGetAttr(
     gpcodegen::GpCodegenUtils* codegen_utils,
     TupleTableSlot *slot,
@@ -192,15 +231,14 @@ bool SlotGetAttrCodegen::GenerateSlotGetAttr(
   llvm::Function* llvm_memtuple_getattr =
       codegen_utils->GetOrRegisterExternalFunction(memtuple_getattr,
                                                    "memtuple_getattr");
-  llvm::Function* llvm_slot_deform_tuple =
-      codegen_utils->GetOrRegisterExternalFunction(slot_deform_tuple,
-                                                   "slot_deform_tuple");
+  llvm::Function* llvm_strlen =
+      codegen_utils->GetOrRegisterExternalFunction(strlen, "strlen");
   llvm::Function* llvm_att_align_nominal =
       codegen_utils->GetOrRegisterExternalFunction(att_align_nominal_regular,
                                                    "att_align_nominal");
 
   // Generation-time constants
-  llvm::Value* llvm_slot = codegen_utils->GetConstant(slot);
+  llvm::Value* llvm_slot = codegen_utils->GetRebindableConstant(slot);
   llvm::Value* llvm_max_attr = codegen_utils->GetConstant(max_attr);
 
   // Function arguments to slot_getattr
@@ -295,6 +333,123 @@ bool SlotGetAttrCodegen::GenerateSlotGetAttr(
   // --------------
 
   irb->SetInsertPoint(memtuple_block);
+  MemTupleBinding* mt_bind = slot->tts_mt_bind;
+  if (nullptr != mt_bind && max_attr <= mt_bind->tupdesc->natts) {
+    // Deform the memtuple up to max_attr into the slot, like
+    // slot_getsomeattrs() does, with the layout of the binding inlined.
+    // There are four layouts, depending on whether the tuple has nulls and
+    // on whether it is large, i.e. uses 4 byte offsets for varlen attributes.
+    llvm::BasicBlock* memtuple_getattr_block = codegen_utils->CreateBasicBlock(
+        "memtuple_getattr", slot_getattr_func);
+    llvm::BasicBlock* memtuple_deform_block = codegen_utils->CreateBasicBlock(
+        "memtuple_deform", slot_getattr_func);
+    llvm::BasicBlock* memtuple_final_block = codegen_utils->CreateBasicBlock(
+        "memtuple_final", slot_getattr_func);
+
+    // Attributes we did not generate code for are read directly
+    irb->CreateCondBr(
+        irb->CreateICmpSGT(llvm_attnum_arg, llvm_max_attr),
+        memtuple_getattr_block /* true */,
+        memtuple_deform_block /* false */);
+
+    irb->SetInsertPoint(memtuple_deform_block);
+    // mtup->PRIVATE_mt_len
+    llvm::Value* llvm_mt_len = irb->CreateLoad(
+        codegen_utils->GetPointerToMember(
+            llvm_slot_PRIVATE_tts_memtuple, &MemTupleData::PRIVATE_mt_len));
+    // memtuple_get_hasnull(mtup)
+    llvm::Value* llvm_hasnull = irb->CreateICmpNE(
+        irb->CreateAnd(llvm_mt_len,
+                       codegen_utils->GetConstant<uint32>(MEMTUP_HASNULL)),
+        codegen_utils->GetConstant<uint32>(0));
+    // memtuple_get_islarge(mtup)
+    llvm::Value* llvm_islarge = irb->CreateICmpNE(
+        irb->CreateAnd(llvm_mt_len,
+                       codegen_utils->GetConstant<uint32>(MEMTUP_LARGETUP)),
+        codegen_utils->GetConstant<uint32>(0));
+    llvm::Value* llvm_mtup_ptr = irb->CreateBitCast(
+        llvm_slot_PRIVATE_tts_memtuple, codegen_utils->GetType<char*>());
+    // memtuple_get_nullp(mtup, pbind)
+    llvm::Value* llvm_nullp = irb->CreateInBoundsGEP(
+        irb->CreateBitCast(
+            codegen_utils->GetPointerToMember(
+                llvm_slot_PRIVATE_tts_memtuple, &MemTupleData::PRIVATE_mt_bits),
+            codegen_utils->GetType<char*>()),
+        {codegen_utils->GetConstant<int>(
+            mt_bind->tupdesc->tdhasoid ? sizeof(Oid) : 0)});
+
+    struct {
+      const char* name;
+      bool has_nulls;
+      bool large;
+    } layouts[] = {
+        {"small", false, false},
+        {"small_nulls", true, false},
+        {"large", false, true},
+        {"large_nulls", true, true},
+    };
+    llvm::BasicBlock* layout_blocks[4];
+    for (int i = 0; i < 4; ++i) {
+      layout_blocks[i] = codegen_utils->CreateBasicBlock(
+          std::string("memtuple_deform_") + layouts[i].name,
+          slot_getattr_func);
+    }
+    llvm::BasicBlock* small_block = codegen_utils->CreateBasicBlock(
+        "memtuple_small", slot_getattr_func);
+    llvm::BasicBlock* large_block = codegen_utils->CreateBasicBlock(
+        "memtuple_large", slot_getattr_func);
+    irb->CreateCondBr(llvm_islarge, large_block, small_block);
+    irb->SetInsertPoint(small_block);
+    irb->CreateCondBr(llvm_hasnull, layout_blocks[1], layout_blocks[0]);
+    irb->SetInsertPoint(large_block);
+    irb->CreateCondBr(llvm_hasnull, layout_blocks[3], layout_blocks[2]);
+
+    for (int i = 0; i < 4; ++i) {
+      irb->SetInsertPoint(layout_blocks[i]);
+      MemTupleBindingCols* colbind = layouts[i].large ?
+          &mt_bind->large_bind : &mt_bind->bind;
+      // char *start = (char *) mtup +
+      //     (hasnull ? pbind->null_bitmap_extra_size : 0);
+      llvm::Value* llvm_start = irb->CreateInBoundsGEP(
+          llvm_mtup_ptr,
+          {codegen_utils->GetConstant<int>(
+              layouts[i].has_nulls ? mt_bind->null_bitmap_extra_size : 0)});
+      // colbind->null_saves_aligned, read from the slot's binding
+      llvm::Value* llvm_null_saves = nullptr;
+      if (layouts[i].has_nulls) {
+        llvm_null_saves = irb->CreateLoad(layouts[i].large ?
+            codegen_utils->GetPointerToMember(
+                llvm_slot_tts_mt_bind, &MemTupleBinding::large_bind,
+                &MemTupleBindingCols::null_saves_aligned) :
+            codegen_utils->GetPointerToMember(
+                llvm_slot_tts_mt_bind, &MemTupleBinding::bind,
+                &MemTupleBindingCols::null_saves_aligned));
+      }
+      if (!GenerateMemTupleDeform(codegen_utils, mt_bind->tupdesc, colbind,
+                                  max_attr, llvm_start,
+                                  layouts[i].has_nulls ? llvm_nullp : nullptr,
+                                  llvm_null_saves,
+                                  llvm_slot_PRIVATE_tts_values,
+                                  llvm_slot_PRIVATE_tts_isnull)) {
+        return false;
+      }
+      irb->CreateBr(memtuple_final_block);
+    }
+
+    // TupSetVirtualTuple(slot);
+    // slot->PRIVATE_tts_nvalid = max_attr;
+    irb->SetInsertPoint(memtuple_final_block);
+    llvm::Value* llvm_flags_ptr = codegen_utils->GetPointerToMember(
+        llvm_slot, &TupleTableSlot::PRIVATE_tts_flags);
+    irb->CreateStore(
+        irb->CreateOr(irb->CreateLoad(llvm_flags_ptr),
+                      codegen_utils->GetConstant<int>(TTS_VIRTUAL)),
+        llvm_flags_ptr);
+    irb->CreateStore(llvm_max_attr, llvm_slot_PRIVATE_tts_nvalid_ptr);
+    irb->CreateBr(return_block);
+
+    irb->SetInsertPoint(memtuple_getattr_block);
+  }
   // return memtuple_getattr(slot->PRIVATE_tts_memtuple,
   //    slot->tts_mt_bind, attnum, isnull);
   llvm::Value* llvm_memtuple_ret = irb->CreateCall(llvm_memtuple_getattr, {
@@ -397,24 +552,23 @@ bool SlotGetAttrCodegen::GenerateSlotGetAttr(
 
   irb->CreateBr(attribute_block);
 
-  bool varlen_attrs_found = false;
+  // Whether the offsets of the attributes after the deformed ones may depend
+  // on the tuple, i.e. whether slot_deform_tuple() can no longer use
+  // attcacheoff when it resumes from where we stopped.
+  bool slow = false;
   int attnum = 0;
   for (; attnum < max_attr; ++attnum) {
     Form_pg_attribute thisatt = att[attnum];
 
-    // If any thisatt is varlen
-    if (thisatt->attlen < 0) {
-      // When we have variable length attributes, we can no longer benefit
-      // from codegen, since the next offset needs to be computed after the
-      // tuple is read into memory.
-      if (attnum < codegen_varlen_tolerance) {
-        // Also, if one of the first few attributes is varlen, might as well
-        // call slot_deform_tuple directly, instead of going through a codegen'd
-        // wrapper function.
-        return false;
-      }
-      varlen_attrs_found = true;
-      break;
+    if (thisatt->attbyval &&
+        thisatt->attlen != sizeof(char) &&
+        thisatt->attlen != sizeof(int16) &&
+        thisatt->attlen != sizeof(int32) &&
+        thisatt->attlen != sizeof(Datum)) {
+      // We do not support other data type length, passed by value
+      elog(DEBUG1,
+           "We do not support other data type length, passed by value");
+      return false;
     }
 
     // ith attribute's block
@@ -428,6 +582,17 @@ bool SlotGetAttrCodegen::GenerateSlotGetAttr(
     next_attribute_block = codegen_utils->CreateBasicBlock(
         "attribute_block_" + std::to_string(attnum+1), slot_getattr_func);
 
+    // Stop at the last attribute stored in the tuple, i.e. for (; attnum <
+    // attno; attnum++). Otherwise we would walk past the end of the tuple,
+    // following lengths read from garbage.
+    llvm::BasicBlock* attribute_body_block = codegen_utils->CreateBasicBlock(
+        "attribute_body_block_" + std::to_string(attnum), slot_getattr_func);
+    irb->CreateCondBr(
+        irb->CreateICmpSLT(codegen_utils->GetConstant(attnum), llvm_attno),
+        attribute_body_block /* true */,
+        final_block /* false */);
+    irb->SetInsertPoint(attribute_body_block);
+
     llvm::Value* llvm_next_values_ptr =
         irb->CreateInBoundsGEP(llvm_slot_PRIVATE_tts_values,
                                {codegen_utils->GetConstant(attnum)});
@@ -513,11 +678,34 @@ bool SlotGetAttrCodegen::GenerateSlotGetAttr(
       irb->SetInsertPoint(is_not_null_block);
     }  // End of if ( !thisatt->attnotnull )
 
-    // off = att_align_nominal(off, thisatt->attalign);
-    irb->CreateStore(irb->CreateCall(
-        llvm_att_align_nominal, {irb->CreateLoad(llvm_off_ptr),
-            codegen_utils->GetConstant<char>(thisatt->attalign)}),
-                     llvm_off_ptr);
+    if (!thisatt->attnotnull || thisatt->attlen <= 0) {
+      slow = true;
+    }
+
+    if (thisatt->attlen == -1 && thisatt->attalign != 'c') {
+      // off = att_align_pointer(off, thisatt->attalign, -1, tp + off); {{{
+      // A varlena with a short header is not aligned, which we can tell by
+      // its first byte not being a pad byte.
+      llvm::Value* llvm_off = irb->CreateLoad(llvm_off_ptr);
+      llvm::Value* llvm_not_pad_byte = irb->CreateICmpNE(
+          irb->CreateLoad(irb->CreateInBoundsGEP(llvm_tuple_data_ptr,
+                                                 {llvm_off})),
+          codegen_utils->GetConstant<char>(0));
+      irb->CreateStore(irb->CreateSelect(
+          llvm_not_pad_byte,
+          llvm_off,
+          irb->CreateCall(llvm_att_align_nominal, {
+              llvm_off,
+              codegen_utils->GetConstant<char>(thisatt->attalign)})),
+                       llvm_off_ptr);
+      // }}}
+    } else {
+      // off = att_align_nominal(off, thisatt->attalign);
+      irb->CreateStore(irb->CreateCall(
+          llvm_att_align_nominal, {irb->CreateLoad(llvm_off_ptr),
+              codegen_utils->GetConstant<char>(thisatt->attalign)}),
+                       llvm_off_ptr);
+    }
 
     // values[attnum] = fetchatt(thisatt, tp + off) {{{
     llvm::Value* llvm_next_t_data_ptr =
@@ -550,21 +738,20 @@ bool SlotGetAttrCodegen::GenerateSlotGetAttr(
                                          codegen_utils->GetType<int64*>()));
         break;
         default:
-          // We do not support other data type length, passed by value
-          elog(DEBUG1,
-               "We do not support other data type length, passed by value");
+          // Already checked above
+          assert(false);
           return false;
       }
+      llvm_colVal = irb->CreateZExt(llvm_colVal,
+                                    codegen_utils->GetType<Datum>());
     } else {
-      // We do not support attributes by reference
-      elog(DEBUG1, "We do not support attributes by reference");
-      return false;
+      // Attributes by reference point into the tuple
+      llvm_colVal = irb->CreatePtrToInt(llvm_next_t_data_ptr,
+                                        codegen_utils->GetType<Datum>());
     }
 
     // store colVal into out_values[attnum]
-    irb->CreateStore(
-        irb->CreateZExt(llvm_colVal, codegen_utils->GetType<Datum>()),
-        llvm_next_values_ptr);
+    irb->CreateStore(llvm_colVal, llvm_next_values_ptr);
 
     // }}} End of values[attnum] = fetchatt(thisatt, tp + off)
 
@@ -577,11 +764,24 @@ bool SlotGetAttrCodegen::GenerateSlotGetAttr(
         llvm_next_isnull_ptr);
     // }}} End of isnull[attnum] = false;
 
-    // off += thisatt->attlen;
-    irb->CreateStore(irb->CreateAdd(
-        irb->CreateLoad(llvm_off_ptr),
-        codegen_utils->GetConstant<int>(thisatt->attlen)),
+    // off = att_addlength_pointer(off, thisatt->attlen, tp + off); {{{
+    llvm::Value* llvm_attlen = nullptr;
+    if (thisatt->attlen > 0) {
+      llvm_attlen = codegen_utils->GetConstant<int>(thisatt->attlen);
+    } else if (thisatt->attlen == -1) {
+      // VARSIZE_ANY(tp + off)
+      llvm_attlen = codegen_utils->CreateVarSizeAny(llvm_next_t_data_ptr);
+    } else {
+      // strlen((char *) (tp + off)) + 1
+      assert(thisatt->attlen == -2);
+      llvm_attlen = irb->CreateAdd(
+          irb->CreateTrunc(irb->CreateCall(llvm_strlen, {llvm_next_t_data_ptr}),
+                           codegen_utils->GetType<int>()),
+          codegen_utils->GetConstant<int>(1));
+    }
+    irb->CreateStore(irb->CreateAdd(irb->CreateLoad(llvm_off_ptr), llvm_attlen),
                      llvm_off_ptr);
+    // }}}
 
     // Jump to next attribute
     irb->CreateBr(next_attribute_block);
@@ -613,19 +813,15 @@ bool SlotGetAttrCodegen::GenerateSlotGetAttr(
       codegen_utils->CreateCast<long, int>(  // NOLINT(runtime/int)
           irb->CreateLoad(llvm_off_ptr)), llvm_slot_PRIVATE_tts_off_ptr);
 
+  // slot->PRIVATE_tts_slow = slow;
+  irb->CreateStore(codegen_utils->GetConstant<bool>(slow),
+                   codegen_utils->GetPointerToMember(
+                       llvm_slot, &TupleTableSlot::PRIVATE_tts_slow));
+
   // slot->PRIVATE_tts_nvalid = attnum;
   irb->CreateStore(codegen_utils->GetConstant(attnum),
                    llvm_slot_PRIVATE_tts_nvalid_ptr);
 
-  if (varlen_attrs_found) {
-    // If we encountered any varlen attribute, we stop codegen from that
-    // attribute onwards and call slot_deform_tuple() directly to deform the
-    // rest of the tuple.
-    irb->CreateCall(llvm_slot_deform_tuple, {
-        llvm_slot_arg,
-        llvm_max_attr});
-  }
-
   // End of slot_deform_tuple
 
   // _slot_getsomeattrs() after calling slot_deform_tuple {{{
@@ -712,3 +908,162 @@ bool SlotGetAttrCodegen::GenerateSlotGetAttr(
       slot_getattr_func);
   return true;
 }
+
+bool SlotGetAttrCodegen::GenerateMemTupleDeform(
+    gpcodegen::GpCodegenUtils* codegen_utils,
+    TupleDesc tupdesc,
+    MemTupleBindingCols* colbind,
+    int max_attr,
+    llvm::Value* llvm_start,
+    llvm::Value* llvm_nullp,
+    llvm::Value* llvm_null_saves,
+    llvm::Value* llvm_values,
+    llvm::Value* llvm_isnull) {
+  auto irb = codegen_utils->ir_builder();
+  llvm::Function* function = irb->GetInsertBlock()->getParent();
+
+  for (int attnum = 0; attnum < max_attr; ++attnum) {
+    Form_pg_attribute thisatt = tupdesc->attrs[attnum];
+    MemTupleAttrBinding* attrbind = &colbind->bindings[attnum];
+
+    llvm::Value* llvm_values_ptr = irb->CreateInBoundsGEP(
+        llvm_values, {codegen_utils->GetConstant(attnum)});
+    llvm::Value* llvm_isnull_ptr = irb->CreateInBoundsGEP(
+        llvm_isnull, {codegen_utils->GetConstant(attnum)});
+    llvm::BasicBlock* next_attribute_block = nullptr;
+
+    // if (hasnull && (nullp[attrbind->null_byte] & attrbind->null_mask)) {{{
+    // Dropped attributes are stored as nulls even if declared not null.
+    if (nullptr != llvm_nullp &&
+        (!thisatt->attnotnull || thisatt->attisdropped)) {
+      llvm::BasicBlock* is_null_block = codegen_utils->CreateBasicBlock(
+          "memtuple_is_null_block_" + std::to_string(attnum), function);
+      llvm::BasicBlock* is_not_null_block = codegen_utils->CreateBasicBlock(
+          "memtuple_is_not_null_block_" + std::to_string(attnum), function);
+      next_attribute_block = codegen_utils->CreateBasicBlock(
+          "memtuple_attribute_block_" + std::to_string(attnum + 1), function);
+
+      llvm::Value* llvm_null_bits = irb->CreateLoad(irb->CreateInBoundsGEP(
+          llvm_nullp, {codegen_utils->GetConstant(attrbind->null_byte)}));
+      irb->CreateCondBr(
+          irb->CreateICmpNE(
+              irb->CreateAnd(llvm_null_bits,
+                             codegen_utils->GetConstant<char>(
+                                 attrbind->null_mask)),
+              codegen_utils->GetConstant<char>(0)),
+          is_null_block /* true */,
+          is_not_null_block /* false */);
+
+      irb->SetInsertPoint(is_null_block);
+      irb->CreateStore(codegen_utils->GetConstant<Datum>(0), llvm_values_ptr);
+      irb->CreateStore(codegen_utils->GetConstant<bool>(true),
+                       llvm_isnull_ptr);
+      irb->CreateBr(next_attribute_block);
+
+      irb->SetInsertPoint(is_not_null_block);
+    }
+    // }}}
+
+    // memtuple_get_attr_ptr(start, attrbind, null_saves, nullp) {{{
+    llvm::Value* llvm_off = codegen_utils->GetConstant<int>(attrbind->offset);
+    if (nullptr != llvm_nullp) {
+      // off -= compute_null_save(null_saves, nullp, attrbind->null_byte,
+      //                          attrbind->null_mask);
+      // The null save of each null bitmap byte is the sum of the null saves
+      // of its two nibbles.
+      for (int b = 0; b <= attrbind->null_byte; ++b) {
+        llvm::Value* llvm_null_bits = irb->CreateLoad(irb->CreateInBoundsGEP(
+            llvm_nullp, {codegen_utils->GetConstant(b)}));
+        if (b == attrbind->null_byte) {
+          // Only the attributes that physically precede this one
+          llvm_null_bits = irb->CreateAnd(
+              llvm_null_bits,
+              codegen_utils->GetConstant<char>(attrbind->null_mask - 1));
+        }
+        llvm::Value* llvm_low = irb->CreateZExt(
+            irb->CreateAnd(llvm_null_bits,
+                           codegen_utils->GetConstant<char>(0xF)),
+            codegen_utils->GetType<int>());
+        llvm::Value* llvm_high = irb->CreateZExt(
+            irb->CreateLShr(llvm_null_bits,
+                            codegen_utils->GetConstant<char>(4)),
+            codegen_utils->GetType<int>());
+        llvm::Value* llvm_save_low = irb->CreateLoad(irb->CreateInBoundsGEP(
+            llvm_null_saves,
+            {irb->CreateAdd(llvm_low, codegen_utils->GetConstant(32 * b))}));
+        llvm::Value* llvm_save_high = irb->CreateLoad(irb->CreateInBoundsGEP(
+            llvm_null_saves,
+            {irb->CreateAdd(llvm_high,
+                            codegen_utils->GetConstant(32 * b + 16))}));
+        llvm_off = irb->CreateSub(
+            llvm_off,
+            irb->CreateAdd(
+                irb->CreateSExt(llvm_save_low, codegen_utils->GetType<int>()),
+                irb->CreateSExt(llvm_save_high,
+                                codegen_utils->GetType<int>())));
+      }
+    }
+    llvm::Value* llvm_attr_ptr = irb->CreateInBoundsGEP(llvm_start,
+                                                        {llvm_off});
+    // }}}
+
+    // memtuple_get_attr_data_ptr(start, attrbind, null_saves, nullp) {{{
+    // Varlen attributes store their offset from start in the binding.
+    llvm::Value* llvm_data_ptr = llvm_attr_ptr;
+    if (attrbind->flag == MTB_ByRef || attrbind->flag == MTB_ByRef_CStr) {
+      llvm::Value* llvm_varoffset = nullptr;
+      if (attrbind->len == sizeof(uint16)) {
+        llvm_varoffset = irb->CreateZExt(
+            irb->CreateLoad(irb->CreateBitCast(
+                llvm_attr_ptr, codegen_utils->GetType<int16*>())),
+            codegen_utils->GetType<uint32>());
+      } else {
+        assert(attrbind->len == sizeof(uint32));
+        llvm_varoffset = irb->CreateLoad(irb->CreateBitCast(
+            llvm_attr_ptr, codegen_utils->GetType<uint32*>()));
+      }
+      llvm_data_ptr = irb->CreateInBoundsGEP(llvm_start, {llvm_varoffset});
+    }
+    // }}}
+
+    // values[attnum] = fetchatt(thisatt, data_ptr); {{{
+    llvm::Value* llvm_colVal = nullptr;
+    if (thisatt->attbyval) {
+      switch (thisatt->attlen) {
+        case sizeof(char):
+          llvm_colVal = irb->CreateLoad(llvm_data_ptr);
+          break;
+        case sizeof(int16):
+          llvm_colVal = irb->CreateLoad(irb->CreateBitCast(
+              llvm_data_ptr, codegen_utils->GetType<int16*>()));
+          break;
+        case sizeof(int32):
+          llvm_colVal = irb->CreateLoad(irb->CreateBitCast(
+              llvm_data_ptr, codegen_utils->GetType<int32*>()));
+          break;
+        case sizeof(Datum):
+          llvm_colVal = irb->CreateLoad(irb->CreateBitCast(
+              llvm_data_ptr, codegen_utils->GetType<int64*>()));
+          break;
+        default:
+          elog(DEBUG1,
+               "We do not support other data type length, passed by value");
+          return false;
+      }
+      llvm_colVal = irb->CreateZExt(llvm_colVal,
+                                    codegen_utils->GetType<Datum>());
+    } else {
+      llvm_colVal = irb->CreatePtrToInt(llvm_data_ptr,
+                                        codegen_utils->GetType<Datum>());
+    }
+    irb->CreateStore(llvm_colVal, llvm_values_ptr);
+    irb->CreateStore(codegen_utils->GetConstant<bool>(false), llvm_isnull_ptr);
+    // }}}
+
+    if (nullptr != next_attribute_block) {
+      irb->CreateBr(next_attribute_block);
+      irb->SetInsertPoint(next_attribute_block);
+    }
+  }
+  return true;
+}
@@ -13,6 +13,7 @@
 //---------------------------------------------------------------------------
 
 #include <cassert>
+#include <chrono>  // NOLINT(build/c++11)
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
@@ -22,6 +23,7 @@
 #include <limits>
 #include <memory>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -57,12 +59,15 @@ extern "C" {
 #include "codegen/utils/codegen_utils.h"
 #include "codegen/utils/gp_codegen_utils.h"
 #include "codegen/utils/utility.h"
+#include "codegen/codegen_cache.h"
 #include "codegen/codegen_manager.h"
 #include "codegen/codegen_wrapper.h"
 #include "codegen/codegen_interface.h"
 #include "codegen/base_codegen.h"
 
 extern bool codegen_validate_functions;
+extern int codegen_cache_size;
+extern bool codegen_background_compile;
 using gpcodegen::GpCodegenUtils;
 namespace gpcodegen {
 
@@ -122,6 +127,50 @@ class SumCodeGenerator : public BaseCodegen<SumFunc> {
   static constexpr char kAddFuncNamePrefix[] = "SumFunc";
 };
 
+// Adds a plan specific offset, read through a rebindable constant, to the sum
+// of its arguments. Supports caching of the generated code.
+class OffsetSumCodeGenerator : public BaseCodegen<SumFunc> {
+ public:
+  explicit OffsetSumCodeGenerator(gpcodegen::CodegenManager* manager,
+                                  SumFunc regular_func_ptr,
+                                  SumFunc* ptr_to_regular_func_ptr,
+                                  int* offset) :
+                                  BaseCodegen(manager,
+                                              kOffsetSumFuncNamePrefix,
+                                              regular_func_ptr,
+                                              ptr_to_regular_func_ptr),
+                                  offset_(offset) {
+  }
+
+  virtual ~OffsetSumCodeGenerator() = default;
+
+  bool AppendFingerprint(std::string* fingerprint) const override {
+    fingerprint->append("offset_sum");
+    return true;
+  }
+
+ protected:
+  bool GenerateCodeInternal(gpcodegen::GpCodegenUtils* codegen_utils) final {
+    auto irb = codegen_utils->ir_builder();
+    llvm::Function* offset_sum_func
+       = CreateFunction<SumFunc>(codegen_utils, GetUniqueFuncName());
+    llvm::BasicBlock* body = codegen_utils->CreateBasicBlock("body",
+                                                             offset_sum_func);
+    irb->SetInsertPoint(body);
+    llvm::Value* llvm_offset = irb->CreateLoad(
+        codegen_utils->GetRebindableConstant(offset_));
+    llvm::Value* llvm_sum = irb->CreateAdd(
+       ArgumentByPosition(offset_sum_func, 0),
+       ArgumentByPosition(offset_sum_func, 1));
+    irb->CreateRet(irb->CreateAdd(llvm_sum, llvm_offset));
+    return true;
+  }
+
+ private:
+  int* offset_;
+  static constexpr char kOffsetSumFuncNamePrefix[] = "OffsetSumFunc";
+};
+
 class MulOverflowCodeGenerator : public BaseCodegen<MulFunc> {
  public:
   explicit MulOverflowCodeGenerator(gpcodegen::CodegenManager* manager,
@@ -313,6 +362,7 @@ class CppToDatumCastGenerator :
 
 constexpr char SumCodeGenerator::kAddFuncNamePrefix[];
 constexpr char FailingCodeGenerator::kFailingFuncNamePrefix[];
+constexpr char OffsetSumCodeGenerator::kOffsetSumFuncNamePrefix[];
 constexpr char MulOverflowCodeGenerator::kMulFuncNamePrefix[];
 template <typename dest_type>
 constexpr char
@@ -812,6 +862,180 @@ TEST_F(CodegenManagerTest, TestDatumFloatCast) {
                         values);
 }
 
+TEST_F(CodegenManagerTest, CacheHitRebindsConstantsTest) {
+  int saved_codegen_cache_size = codegen_cache_size;
+  codegen_cache_size = 1024;
+  CodegenCache* cache = CodegenCache::GetInstance();
+  size_t hits = cache->hits();
+  size_t misses = cache->misses();
+
+  int offset1 = 10;
+  sum_func_ptr = nullptr;
+  manager_->EnrollCodeGenerator(
+      CodegenFuncLifespan_Parameter_Invariant,
+      new OffsetSumCodeGenerator(manager_.get(), SumFuncRegular,
+                                 &sum_func_ptr, &offset1));
+  EXPECT_EQ(1, manager_->GenerateCode());
+  EXPECT_EQ(1, manager_->PrepareGeneratedFunctions());
+  EXPECT_EQ(misses + 1, cache->misses());
+  EXPECT_EQ(13, sum_func_ptr(1, 2));
+  SumFunc first_compiled_func_ptr = sum_func_ptr;
+
+  // While the first manager holds the module, a second identical one has to
+  // compile its own.
+  int offset2 = 20;
+  SumFunc second_sum_func_ptr = nullptr;
+  std::unique_ptr<CodegenManager> manager2(
+      new CodegenManager("CodegenManagerTest2"));
+  manager2->EnrollCodeGenerator(
+      CodegenFuncLifespan_Parameter_Invariant,
+      new OffsetSumCodeGenerator(manager2.get(), SumFuncRegular,
+                                 &second_sum_func_ptr, &offset2));
+  EXPECT_EQ(1, manager2->GenerateCode());
+  EXPECT_EQ(1, manager2->PrepareGeneratedFunctions());
+  EXPECT_EQ(misses + 2, cache->misses());
+  EXPECT_EQ(23, second_sum_func_ptr(1, 2));
+  manager2.reset(nullptr);
+
+  // Once released, the module is reused with the new offset
+  manager_.reset(new CodegenManager("CodegenManagerTest3"));
+  int offset3 = 30;
+  sum_func_ptr = nullptr;
+  manager_->EnrollCodeGenerator(
+      CodegenFuncLifespan_Parameter_Invariant,
+      new OffsetSumCodeGenerator(manager_.get(), SumFuncRegular,
+                                 &sum_func_ptr, &offset3));
+  EXPECT_EQ(1, manager_->GenerateCode());
+  EXPECT_EQ(1, manager_->PrepareGeneratedFunctions());
+  EXPECT_EQ(hits + 1, cache->hits());
+  EXPECT_EQ(first_compiled_func_ptr, sum_func_ptr);
+  EXPECT_EQ(33, sum_func_ptr(1, 2));
+
+  manager_.reset(nullptr);
+  ASSERT_TRUE(SumFuncRegular == sum_func_ptr);
+  cache->EvictTo(0);
+  EXPECT_EQ(0, cache->entry_count());
+  codegen_cache_size = saved_codegen_cache_size;
+}
+
+TEST_F(CodegenManagerTest, CacheReleaseAllTest) {
+  int saved_codegen_cache_size = codegen_cache_size;
+  codegen_cache_size = 1024;
+  CodegenCache* cache = CodegenCache::GetInstance();
+
+  int offset1 = 10;
+  sum_func_ptr = nullptr;
+  manager_->EnrollCodeGenerator(
+      CodegenFuncLifespan_Parameter_Invariant,
+      new OffsetSumCodeGenerator(manager_.get(), SumFuncRegular,
+                                 &sum_func_ptr, &offset1));
+  EXPECT_EQ(1, manager_->GenerateCode());
+  EXPECT_EQ(1, manager_->PrepareGeneratedFunctions());
+
+  // A manager that is never destroyed, as after a missed cleanup, keeps its
+  // lease. Its destructor would return a lease it no longer holds once
+  // ReleaseAll() has run, so it is deliberately leaked.
+  CodegenManager* leaked_manager = manager_.release();
+  (void) leaked_manager;
+
+  // ReleaseAll() makes the entry available to the next identical manager
+  EXPECT_EQ(1, cache->ReleaseAll());
+  size_t hits = cache->hits();
+  int offset2 = 20;
+  SumFunc second_sum_func_ptr = nullptr;
+  manager_.reset(new CodegenManager("CodegenManagerTest2"));
+  manager_->EnrollCodeGenerator(
+      CodegenFuncLifespan_Parameter_Invariant,
+      new OffsetSumCodeGenerator(manager_.get(), SumFuncRegular,
+                                 &second_sum_func_ptr, &offset2));
+  EXPECT_EQ(1, manager_->GenerateCode());
+  EXPECT_EQ(1, manager_->PrepareGeneratedFunctions());
+  EXPECT_EQ(hits + 1, cache->hits());
+  EXPECT_EQ(23, second_sum_func_ptr(1, 2));
+
+  manager_.reset(nullptr);
+  EXPECT_EQ(0, cache->ReleaseAll());
+  cache->EvictTo(0);
+  EXPECT_EQ(0, cache->entry_count());
+  codegen_cache_size = saved_codegen_cache_size;
+}
+
+TEST_F(CodegenManagerTest, BackgroundCompilationTest) {
+  codegen_background_compile = true;
+  sum_func_ptr = nullptr;
+  failed_func_ptr = nullptr;
+  EnrollCodegen<SumCodeGenerator, SumFunc>(SumFuncRegular, &sum_func_ptr);
+  EnrollCodegen<FailingCodeGenerator, SumFunc>(SumFuncRegular,
+                                               &failed_func_ptr);
+  EXPECT_EQ(1, manager_->GenerateCode());
+
+  // Nothing is swapped synchronously; the regular version stays usable
+  EXPECT_EQ(0, manager_->PrepareGeneratedFunctions());
+  EXPECT_EQ(3, sum_func_ptr(1, 2));
+
+  // Wait for the helper thread to swap in the generated function
+  for (int i = 0; i < 1000 && SumFuncRegular == sum_func_ptr; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_TRUE(SumFuncRegular != sum_func_ptr);
+  ASSERT_TRUE(SumFuncRegular == failed_func_ptr);
+  EXPECT_EQ(3, sum_func_ptr(1, 2));
+
+  manager_.reset(nullptr);
+  ASSERT_TRUE(SumFuncRegular == sum_func_ptr);
+  codegen_background_compile = false;
+}
+
+TEST_F(CodegenManagerTest, BackgroundCompilationCancelTest) {
+  codegen_background_compile = true;
+  sum_func_ptr = nullptr;
+  EnrollCodegen<SumCodeGenerator, SumFunc>(SumFuncRegular, &sum_func_ptr);
+  EXPECT_EQ(1, manager_->GenerateCode());
+  EXPECT_EQ(0, manager_->PrepareGeneratedFunctions());
+
+  // Destroying the manager right away must leave the regular version in
+  // place, whether or not the helper thread has finished.
+  manager_.reset(nullptr);
+  ASSERT_TRUE(SumFuncRegular == sum_func_ptr);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  ASSERT_TRUE(SumFuncRegular == sum_func_ptr);
+  codegen_background_compile = false;
+}
+
+TEST_F(CodegenManagerTest, CostBasedAdmissionTest) {
+  double saved_codegen_saving_per_row = codegen_saving_per_row;
+  double saved_codegen_compile_cost = codegen_compile_cost;
+  codegen_saving_per_row = 1;
+  codegen_compile_cost = 10;
+
+  // Too few rows to pay off compiling
+  sum_func_ptr = nullptr;
+  EnrollCodegen<SumCodeGenerator, SumFunc>(SumFuncRegular, &sum_func_ptr);
+  manager_->SetEstimatedRows(0);
+  EXPECT_EQ(0, manager_->GenerateCode());
+  EXPECT_EQ(0, manager_->PrepareGeneratedFunctions());
+  ASSERT_TRUE(SumFuncRegular == sum_func_ptr);
+  EXPECT_NE(std::string::npos,
+            manager_->GetStatisticsString().find("skipped"));
+
+  // Plenty of rows
+  manager_.reset(new CodegenManager("CodegenManagerTest2"));
+  sum_func_ptr = nullptr;
+  EnrollCodegen<SumCodeGenerator, SumFunc>(SumFuncRegular, &sum_func_ptr);
+  manager_->SetEstimatedRows(1e12);
+  EXPECT_EQ(1, manager_->GenerateCode());
+  EXPECT_EQ(1, manager_->PrepareGeneratedFunctions());
+  ASSERT_TRUE(SumFuncRegular != sum_func_ptr);
+  EXPECT_EQ(3, sum_func_ptr(1, 2));
+  EXPECT_NE(std::string::npos,
+            manager_->GetStatisticsString().find("generated"));
+  EXPECT_NE(std::string::npos,
+            manager_->GetStatisticsString().find(", used"));
+
+  codegen_saving_per_row = saved_codegen_saving_per_row;
+  codegen_compile_cost = saved_codegen_compile_cost;
+}
+
 TEST_F(CodegenManagerTest, TestDatumDoubleCast) {
   std::vector<double> values = {0.0, -0.0, 12.34, -12.34,
         std::numeric_limits<double>::min(),
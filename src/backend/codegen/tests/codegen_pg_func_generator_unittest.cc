@@ -17,6 +17,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <ctime>
 #include <initializer_list>
 #include <limits>
@@ -31,6 +32,8 @@
 extern "C" {
 #include "postgres.h"  // NOLINT(build/include)
 #undef newNode  // undef newNode so it doesn't have name collision with llvm
+#include "catalog/pg_type.h"
+#include "cdb/cdbhash.h"
 #include "utils/elog.h"
 #undef elog
 #define elog(...)
@@ -63,6 +66,8 @@ extern "C" {
 #include "codegen/base_codegen.h"
 #include "codegen/pg_func_generator.h"
 #include "codegen/pg_arith_func_generator.h"
+#include "codegen/pg_hash_func_generator.h"
+#include "codegen/pg_text_func_generator.h"
 
 
 namespace gpcodegen {
@@ -377,6 +382,258 @@ TEST_F(CodegenPGFuncGeneratorTest, PGGenericFuncGeneratorOneArgTest) {
   EXPECT_EQ(3, fn(2));
 }
 
+TEST_F(CodegenPGFuncGeneratorTest, WideningCastTest) {
+  using Int48Fn = int64_t (*) (Datum);
+
+  llvm::Function* int48_fn =
+      codegen_utils_->CreateFunction<Int48Fn>("int48_fn");
+
+  llvm::BasicBlock* main_block =
+      codegen_utils_->CreateBasicBlock("main", int48_fn);
+  llvm::BasicBlock* error_block =
+      codegen_utils_->CreateBasicBlock("error", int48_fn);
+
+  auto irb = codegen_utils_->ir_builder();
+
+  irb->SetInsertPoint(main_block);
+
+  auto generator = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<int64_t, int32_t>(
+          481,
+          "int48",
+          &PGArithUnaryFuncGenerator<int64_t, int32_t>::WideningCast,
+          nullptr,
+          true));
+
+  llvm::Value* result = nullptr;
+  llvm::Value* llvm_isNull = irb->CreateAlloca(
+        codegen_utils_->GetType<bool>(), nullptr, "isNull");
+  irb->CreateStore(codegen_utils_->GetConstant<bool>(false), llvm_isNull);
+  std::vector<llvm::Value*> args = {ArgumentByPosition(int48_fn, 0)};
+  std::vector<llvm::Value*> args_isNull = {codegen_utils_->
+      GetConstant<bool>(false)};  // dummy
+  PGFuncGeneratorInfo pg_gen_info(int48_fn, error_block, args,
+                                  args_isNull);
+
+  EXPECT_TRUE(generator->GenerateCode(codegen_utils_.get(),
+                                      pg_gen_info,
+                                      &result,
+                                      llvm_isNull));
+  irb->CreateRet(result);
+
+  irb->SetInsertPoint(error_block);
+  irb->CreateRet(codegen_utils_->GetConstant<int64_t>(0));
+
+  EXPECT_FALSE(llvm::verifyFunction(*int48_fn));
+  EXPECT_FALSE(llvm::verifyModule(*codegen_utils_->module()));
+
+  EXPECT_TRUE(codegen_utils_->PrepareForExecution(
+      CodegenUtils::OptimizationLevel::kNone,
+      true));
+
+  Int48Fn fn = codegen_utils_->GetFunctionPointer<Int48Fn>("int48_fn");
+
+  EXPECT_EQ(0, fn(Int32GetDatum(0)));
+  EXPECT_EQ(-5, fn(Int32GetDatum(-5)));
+  EXPECT_EQ(std::numeric_limits<int32_t>::max(),
+            fn(Int32GetDatum(std::numeric_limits<int32_t>::max())));
+}
+
+TEST_F(CodegenPGFuncGeneratorTest, TextCmpTest) {
+  using TextCmpFn = bool (*) (Datum, Datum);
+
+  // Build a text value with either a short or a regular 4-byte header
+  auto make_text = [](const std::string& str, bool is_short) {
+    std::vector<char> value(VARHDRSZ + str.size());
+    if (is_short) {
+      SET_VARSIZE_SHORT(value.data(), VARHDRSZ_SHORT + str.size());
+      memcpy(value.data() + VARHDRSZ_SHORT, str.data(), str.size());
+    } else {
+      SET_VARSIZE(value.data(), VARHDRSZ + str.size());
+      memcpy(value.data() + VARHDRSZ, str.data(), str.size());
+    }
+    return value;
+  };
+
+  struct TestCase {
+    unsigned int oid;
+    const char* name;
+    PGFuncGeneratorFn func_ptr;
+  };
+  std::vector<TestCase> test_cases = {
+      {67, "texteq", &PGTextFuncGenerator::TextEq<llvm::CmpInst::ICMP_EQ>},
+      {740, "text_lt", &PGTextFuncGenerator::TextCmp<llvm::CmpInst::ICMP_SLT>},
+      {1048, "bpchareq",
+          &PGTextFuncGenerator::BpcharEq<llvm::CmpInst::ICMP_EQ>},
+      {1049, "bpcharlt",
+          &PGTextFuncGenerator::BpcharCmp<llvm::CmpInst::ICMP_SLT>}};
+
+  for (const TestCase& test_case : test_cases) {
+    std::string func_name = std::string(test_case.name) + "_fn";
+    llvm::Function* cmp_fn =
+        codegen_utils_->CreateFunction<TextCmpFn>(func_name);
+    llvm::BasicBlock* main_block =
+        codegen_utils_->CreateBasicBlock("main", cmp_fn);
+    llvm::BasicBlock* error_block =
+        codegen_utils_->CreateBasicBlock("error", cmp_fn);
+
+    auto irb = codegen_utils_->ir_builder();
+    irb->SetInsertPoint(main_block);
+
+    auto generator = std::unique_ptr<PGFuncGeneratorInterface>(
+        new PGGenericFuncGenerator<bool, void*, void*>(
+            test_case.oid, test_case.name, test_case.func_ptr,
+            nullptr, true));
+
+    llvm::Value* result = nullptr;
+    llvm::Value* llvm_isNull = irb->CreateAlloca(
+          codegen_utils_->GetType<bool>(), nullptr, "isNull");
+    irb->CreateStore(codegen_utils_->GetConstant<bool>(false), llvm_isNull);
+    std::vector<llvm::Value*> args = {ArgumentByPosition(cmp_fn, 0),
+                                      ArgumentByPosition(cmp_fn, 1)};
+    std::vector<llvm::Value*> args_isNull = {
+        codegen_utils_->GetConstant<bool>(false),
+        codegen_utils_->GetConstant<bool>(false)};  // dummy
+    PGFuncGeneratorInfo pg_gen_info(cmp_fn, error_block, args, args_isNull);
+
+    EXPECT_TRUE(generator->GenerateCode(codegen_utils_.get(),
+                                        pg_gen_info,
+                                        &result,
+                                        llvm_isNull));
+    irb->CreateRet(result);
+
+    irb->SetInsertPoint(error_block);
+    irb->CreateRet(codegen_utils_->GetConstant<bool>(false));
+
+    EXPECT_FALSE(llvm::verifyFunction(*cmp_fn));
+  }
+  EXPECT_FALSE(llvm::verifyModule(*codegen_utils_->module()));
+
+  EXPECT_TRUE(codegen_utils_->PrepareForExecution(
+      CodegenUtils::OptimizationLevel::kNone,
+      true));
+
+  TextCmpFn texteq = codegen_utils_->GetFunctionPointer<TextCmpFn>(
+      "texteq_fn");
+  TextCmpFn text_lt = codegen_utils_->GetFunctionPointer<TextCmpFn>(
+      "text_lt_fn");
+  TextCmpFn bpchareq = codegen_utils_->GetFunctionPointer<TextCmpFn>(
+      "bpchareq_fn");
+  TextCmpFn bpcharlt = codegen_utils_->GetFunctionPointer<TextCmpFn>(
+      "bpcharlt_fn");
+
+  std::vector<char> abc_short = make_text("abc", true);
+  std::vector<char> abc_long = make_text("abc", false);
+  std::vector<char> abd_long = make_text("abd", false);
+  std::vector<char> ab_short = make_text("ab", true);
+  std::vector<char> abc_padded = make_text("abc  ", false);
+  std::vector<char> empty_short = make_text("", true);
+  Datum abc1 = PointerGetDatum(abc_short.data());
+  Datum abc2 = PointerGetDatum(abc_long.data());
+  Datum abd = PointerGetDatum(abd_long.data());
+  Datum ab = PointerGetDatum(ab_short.data());
+  Datum abc_pad = PointerGetDatum(abc_padded.data());
+  Datum empty = PointerGetDatum(empty_short.data());
+
+  // Same value with different headers
+  EXPECT_TRUE(texteq(abc1, abc2));
+  EXPECT_FALSE(texteq(abc1, abd));
+  EXPECT_FALSE(texteq(abc1, ab));
+  EXPECT_FALSE(texteq(abc1, abc_pad));
+  EXPECT_TRUE(texteq(empty, empty));
+
+  EXPECT_TRUE(text_lt(abc1, abd));
+  EXPECT_FALSE(text_lt(abd, abc2));
+  EXPECT_FALSE(text_lt(abc1, abc2));
+  // A prefix sorts first
+  EXPECT_TRUE(text_lt(ab, abc1));
+  EXPECT_FALSE(text_lt(abc1, ab));
+  EXPECT_TRUE(text_lt(empty, ab));
+
+  // Trailing spaces are insignificant for bpchar
+  EXPECT_TRUE(bpchareq(abc1, abc_pad));
+  EXPECT_FALSE(bpchareq(ab, abc_pad));
+  EXPECT_FALSE(bpcharlt(abc_pad, abc2));
+  EXPECT_FALSE(bpcharlt(abc2, abc_pad));
+  EXPECT_TRUE(bpcharlt(abc_pad, abd));
+}
+
+TEST_F(CodegenPGFuncGeneratorTest, CdbHashTest) {
+  using CdbHashFn = void (*) (Datum, CdbHash*);
+
+  struct TestCase {
+    Oid type;
+    const char* name;
+  };
+  std::vector<TestCase> test_cases = {
+      {INT2OID, "cdbhash_int2"},
+      {INT4OID, "cdbhash_int4"},
+      {INT8OID, "cdbhash_int8"},
+      {TEXTOID, "cdbhash_text"},
+      {BPCHAROID, "cdbhash_bpchar"}};
+
+  auto irb = codegen_utils_->ir_builder();
+  for (const TestCase& test_case : test_cases) {
+    llvm::Function* hash_fn =
+        codegen_utils_->CreateFunction<CdbHashFn>(test_case.name);
+    irb->SetInsertPoint(codegen_utils_->CreateBasicBlock("main", hash_fn));
+    PGHashFuncGenerator::GenerateCdbHash(codegen_utils_.get(),
+                                         test_case.type,
+                                         ArgumentByPosition(hash_fn, 0),
+                                         ArgumentByPosition(hash_fn, 1));
+    irb->CreateRetVoid();
+    EXPECT_FALSE(llvm::verifyFunction(*hash_fn));
+  }
+
+  llvm::Function* null_fn =
+      codegen_utils_->CreateFunction<CdbHashFn>("cdbhash_null");
+  irb->SetInsertPoint(codegen_utils_->CreateBasicBlock("main", null_fn));
+  PGHashFuncGenerator::GenerateCdbHashNull(codegen_utils_.get(),
+                                           ArgumentByPosition(null_fn, 1));
+  irb->CreateRetVoid();
+  EXPECT_FALSE(llvm::verifyFunction(*null_fn));
+
+  EXPECT_FALSE(llvm::verifyModule(*codegen_utils_->module()));
+  EXPECT_TRUE(codegen_utils_->PrepareForExecution(
+      CodegenUtils::OptimizationLevel::kNone,
+      true));
+
+  // The generated code must give the same hash value as cdbhash()
+  auto check_hash = [this](const char* name, Datum datum, Oid type) {
+    CdbHashFn fn = codegen_utils_->GetFunctionPointer<CdbHashFn>(name);
+    CdbHash expected_hash;
+    CdbHash actual_hash;
+    // Start from the FNV-1 initial value, as cdbhashinit() does
+    expected_hash.hash = actual_hash.hash = 0x811c9dc5;
+    cdbhash(&expected_hash, datum, type);
+    fn(datum, &actual_hash);
+    EXPECT_EQ(expected_hash.hash, actual_hash.hash) << name;
+  };
+
+  check_hash("cdbhash_int2", Int16GetDatum(-42), INT2OID);
+  check_hash("cdbhash_int4", Int32GetDatum(0), INT4OID);
+  check_hash("cdbhash_int4", Int32GetDatum(-123456), INT4OID);
+  check_hash("cdbhash_int8", Int64GetDatum(1LL << 40), INT8OID);
+
+  std::vector<char> abc(VARHDRSZ + 5);
+  SET_VARSIZE(abc.data(), VARHDRSZ + 5);
+  memcpy(abc.data() + VARHDRSZ, "abc  ", 5);
+  std::vector<char> blanks(VARHDRSZ_SHORT + 3);
+  SET_VARSIZE_SHORT(blanks.data(), VARHDRSZ_SHORT + 3);
+  memcpy(blanks.data() + VARHDRSZ_SHORT, "   ", 3);
+  check_hash("cdbhash_text", PointerGetDatum(abc.data()), TEXTOID);
+  check_hash("cdbhash_bpchar", PointerGetDatum(abc.data()), BPCHAROID);
+  check_hash("cdbhash_bpchar", PointerGetDatum(blanks.data()), BPCHAROID);
+
+  CdbHash expected_hash;
+  CdbHash actual_hash;
+  expected_hash.hash = actual_hash.hash = 0x811c9dc5;
+  cdbhashnull(&expected_hash);
+  codegen_utils_->GetFunctionPointer<CdbHashFn>("cdbhash_null")(
+      0, &actual_hash);
+  EXPECT_EQ(expected_hash.hash, actual_hash.hash);
+}
+
 }  // namespace gpcodegen
 
 
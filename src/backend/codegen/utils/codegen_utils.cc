@@ -31,6 +31,7 @@
 // DO NOT REMOVE: including the MCJIT.h header forces the MCJIT engine to be
 // linked in when using static libraries.
 #include "llvm/ExecutionEngine/MCJIT.h"
+#include "llvm/ExecutionEngine/SectionMemoryManager.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/GlobalValue.h"
@@ -76,6 +77,38 @@ inline llvm::CodeGenOpt::Level OptLevelCodegenToLLVM(
   }
 }
 
+// SectionMemoryManager that keeps a running total of the bytes it hands out
+// for code and data sections, so that callers can account for the memory used
+// by compiled code.
+class CountingSectionMemoryManager : public llvm::SectionMemoryManager {
+ public:
+  explicit CountingSectionMemoryManager(std::size_t* allocated_size)
+      : allocated_size_(allocated_size) {
+  }
+
+  std::uint8_t* allocateCodeSection(std::uintptr_t size,
+                                    unsigned alignment,
+                                    unsigned section_id,
+                                    llvm::StringRef section_name) override {
+    *allocated_size_ += size;
+    return llvm::SectionMemoryManager::allocateCodeSection(
+        size, alignment, section_id, section_name);
+  }
+
+  std::uint8_t* allocateDataSection(std::uintptr_t size,
+                                    unsigned alignment,
+                                    unsigned section_id,
+                                    llvm::StringRef section_name,
+                                    bool is_read_only) override {
+    *allocated_size_ += size;
+    return llvm::SectionMemoryManager::allocateDataSection(
+        size, alignment, section_id, section_name, is_read_only);
+  }
+
+ private:
+  std::size_t* allocated_size_;
+};
+
 }  // namespace
 
 constexpr char CodegenUtils::kExternalVariableNamePrefix[];
@@ -85,7 +118,8 @@ CodegenUtils::CodegenUtils(llvm::StringRef module_name)
     : ir_builder_(context_),
       module_(new llvm::Module(module_name, context_)),
       external_variable_counter_(0),
-      external_function_counter_(0) {
+      external_function_counter_(0),
+      compiled_code_size_(0) {
 }
 
 bool CodegenUtils::InitializeGlobal() {
@@ -97,6 +131,14 @@ bool CodegenUtils::InitializeGlobal() {
          && !llvm::InitializeNativeTargetAsmParser();
 }
 
+llvm::AllocaInst* CodegenUtils::CreateEntryBlockAlloca(
+    llvm::Type* type, const std::string& name) {
+  llvm::BasicBlock& entry_block =
+      ir_builder()->GetInsertBlock()->getParent()->getEntryBlock();
+  llvm::IRBuilder<> entry_builder(&entry_block, entry_block.begin());
+  return entry_builder.CreateAlloca(type, nullptr, name);
+}
+
 llvm::AllocaInst* CodegenUtils::CreateMakeTuple(
     const std::vector<llvm::Value*>& members, const std::string& name) {
   std::vector<llvm::Type*> argument_types(members.size(), nullptr);
@@ -243,6 +285,9 @@ bool CodegenUtils::PrepareForExecution(const OptimizationLevel cpu_opt_level,
   if (optimize_for_host_cpu) {
     builder.setMCPU(llvm::sys::getHostCPUName());
   }
+  builder.setMCJITMemoryManager(
+      std::unique_ptr<llvm::RTDyldMemoryManager>(
+          new CountingSectionMemoryManager(&compiled_code_size_)));
 
   engine_.reset(builder.create());
   if (engine_.get() == nullptr) {
@@ -18,6 +18,10 @@
 
 #include "codegen/utils/gp_codegen_utils.h"
 
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+}
+
 namespace gpcodegen {
 
 llvm::Value* GpCodegenUtils::CreateCppTypeToDatumCast(
@@ -87,6 +91,57 @@ llvm::Value* GpCodegenUtils::CreatePalloc(Size size,
           GetConstant(line)});
 }
 
+llvm::Value* GpCodegenUtils::CreateVarSizeAny(llvm::Value* llvm_varlena) {
+  assert(nullptr != llvm_varlena);
+  auto irb = ir_builder();
+  llvm::Function* current_function = irb->GetInsertBlock()->getParent();
+  llvm::BasicBlock* short_block = CreateBasicBlock(
+      "varsize_short_block", current_function);
+  llvm::BasicBlock* long_block = CreateBasicBlock(
+      "varsize_long_block", current_function);
+  llvm::BasicBlock* end_block = CreateBasicBlock(
+      "varsize_end_block", current_function);
+
+  llvm::Value* llvm_header = irb->CreateLoad(
+      irb->CreateBitCast(llvm_varlena, GetType<uint8*>()));
+  irb->CreateCondBr(
+      irb->CreateICmpEQ(irb->CreateAnd(llvm_header, GetConstant<uint8>(0x80)),
+                        GetConstant<uint8>(0x80)),
+      short_block /* VARATT_IS_1B */,
+      long_block);
+
+  // VARATT_IS_1B_E(PTR) ? VARSIZE_1B_E(PTR) : VARSIZE_1B(PTR)
+  irb->SetInsertPoint(short_block);
+  llvm::Value* llvm_short_size = irb->CreateSelect(
+      irb->CreateICmpEQ(llvm_header, GetConstant<uint8>(0x80)),
+      GetConstant<int32>(VARHDRSZ_EXTERNAL + sizeof(struct varatt_external)),
+      irb->CreateZExt(irb->CreateAnd(llvm_header, GetConstant<uint8>(0x7F)),
+                      GetType<int32>()));
+  irb->CreateBr(end_block);
+
+  // VARSIZE_4B(PTR); the length word is stored in network byte order, so we
+  // assemble it byte by byte.
+  irb->SetInsertPoint(long_block);
+  llvm::Value* llvm_long_size = nullptr;
+  for (int i = 0; i < 4; ++i) {
+    llvm::Value* llvm_byte = irb->CreateZExt(
+        irb->CreateLoad(irb->CreateInBoundsGEP(
+            irb->CreateBitCast(llvm_varlena, GetType<uint8*>()),
+            GetConstant<int32>(i))),
+        GetType<int32>());
+    llvm_long_size = (0 == i) ?
+        irb->CreateAnd(llvm_byte, GetConstant<int32>(0x3F)) :
+        irb->CreateOr(irb->CreateShl(llvm_long_size, 8), llvm_byte);
+  }
+  irb->CreateBr(end_block);
+
+  irb->SetInsertPoint(end_block);
+  llvm::PHINode* llvm_size = irb->CreatePHI(GetType<int32>(), 2);
+  llvm_size->addIncoming(llvm_short_size, short_block);
+  llvm_size->addIncoming(llvm_long_size, long_block);
+  return llvm_size;
+}
+
 }  // namespace gpcodegen
 
 // EOF
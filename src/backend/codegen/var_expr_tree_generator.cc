@@ -13,6 +13,7 @@
 #include <cstdint>
 #include <algorithm>
 #include <memory>
+#include <string>
 
 #include "codegen/expr_tree_generator.h"
 #include "codegen/utils/gp_codegen_utils.h"
@@ -57,6 +58,25 @@ VarExprTreeGenerator::VarExprTreeGenerator(const ExprState* expr_state) :
     ExprTreeGenerator(expr_state, ExprTreeNodeType::kVar) {
 }
 
+bool VarExprTreeGenerator::AppendFingerprint(std::string* fingerprint) const {
+  Var* var_expr = reinterpret_cast<Var*>(expr_state()->expr);
+  // Only the choice between inner, outer and scan tuple matters; the slot
+  // itself is read through a rebindable constant.
+  switch (var_expr->varno) {
+    case INNER:
+      fingerprint->append("Vi");
+      break;
+    case OUTER:
+      fingerprint->append("Vo");
+      break;
+    default:
+      fingerprint->append("Vs");
+      break;
+  }
+  fingerprint->append(std::to_string(var_expr->varattno));
+  return true;
+}
+
 bool VarExprTreeGenerator::GenerateCode(GpCodegenUtils* codegen_utils,
                                         const ExprTreeGeneratorInfo& gen_info,
                                         llvm::Value** llvm_out_value,
@@ -88,7 +108,7 @@ bool VarExprTreeGenerator::GenerateCode(GpCodegenUtils* codegen_utils,
   }
 
   llvm::Value *llvm_slot = irb->CreateLoad(
-      codegen_utils->GetConstant(ptr_to_slot_ptr));
+      codegen_utils->GetRebindableConstant(ptr_to_slot_ptr));
   //}}}
 
   llvm::Value *llvm_variable_varattno = codegen_utils->
@@ -91,6 +91,8 @@ static void ExplainDXL(Query *query, ExplainStmt *stmt,
 #endif
 #ifdef USE_CODEGEN
 static void ExplainCodegen(PlanState *planstate, TupOutputState *tstate);
+static void ExplainCodegenStatistics(PlanState *planstate,
+									 TupOutputState *tstate);
 #endif
 static double elapsed_time(instr_time *starttime);
 static ErrorData *explain_defer_error(ExplainState *es);
@@ -345,6 +347,33 @@ ExplainCodegen(PlanState *planstate, TupOutputState *tstate) {
 
 	ExplainCodegen(planstate->righttree, tstate);
 }
+
+/*
+ * ExplainCodegenStatistics -
+ * 		given an executed PlanState tree, print the time each node's
+ * 		CodegenManager spent generating and compiling code, and whether the
+ * 		generated functions were used
+ * 		NB: This method does not recurse into sub plans at this point.
+ */
+static void
+ExplainCodegenStatistics(PlanState *planstate, TupOutputState *tstate) {
+	if (NULL == planstate) {
+		return;
+	}
+
+	Assert(NULL != tstate);
+
+	ExplainCodegenStatistics(planstate->lefttree, tstate);
+
+	if (NULL != planstate->CodegenManager) {
+		char* str = CodeGeneratorManagerGetStatisticsString(
+				planstate->CodegenManager);
+		Assert(NULL != str);
+		do_text_output_multiline(tstate, str);
+	}
+
+	ExplainCodegenStatistics(planstate->righttree, tstate);
+}
 #endif
 
 /*
@@ -445,6 +474,7 @@ ExplainOnePlan(PlannedStmt *plannedstmt, ParamListInfo params,
 #ifdef USE_CODEGEN
 	if (stmt->codegen && codegen && Gp_segment == -1) {
 		ExplainCodegen(queryDesc->planstate, tstate);
+		do_text_output_oneline(tstate, CodeGeneratorCacheGetExplainString());
 	}
 #endif
 
@@ -500,6 +530,12 @@ ExplainOnePlan(PlannedStmt *plannedstmt, ParamListInfo params,
                                      estate->dispatcherState->primaryResults,
                                      LocallyExecutingSliceIndex(estate),
                                      es->showstatctx);
+
+#ifdef USE_CODEGEN
+		if (stmt->codegen && codegen && Gp_segment == -1) {
+			ExplainCodegenStatistics(queryDesc->planstate, tstate);
+		}
+#endif
 	}
 
 	es->printAnalyze = stmt->analyze;
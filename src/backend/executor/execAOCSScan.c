@@ -7,8 +7,12 @@
 #include "postgres.h"
 
 #include "executor/executor.h"
+#include "executor/execBatch.h"
+#include "executor/instrument.h"
+#include "lib/stringinfo.h"
 #include "nodes/execnodes.h"
 #include "cdb/cdbaocsam.h"
+#include "cdb/cdbvars.h"
 
 static void
 InitAOCSScanOpaque(ScanState *scanState)
@@ -44,6 +48,11 @@ InitAOCSScanOpaque(ScanState *scanState)
 	{
 		opaque->proj[0] = true;
 	}
+
+	opaque->batch = NULL;
+	opaque->batchNext = 0;
+	opaque->zoneMapNPreds = NULL;
+	opaque->zoneMapPreds = NULL;
 }
 
 static void
@@ -55,10 +64,202 @@ FreeAOCSScanOpaque(ScanState *scanState)
 	AOCSScanOpaqueData *opaque = (AOCSScanOpaqueData *)state->opaque;
 	Assert(opaque->proj != NULL);
 	pfree(opaque->proj);
+
+	if (opaque->batch != NULL)
+		aocs_batch_free(opaque->batch);
+	if (opaque->zoneMapPreds != NULL)
+		ExecFreeScanPredicates(opaque->ncol, opaque->zoneMapNPreds,
+							   opaque->zoneMapPreds);
 	pfree(state->opaque);
 	state->opaque = NULL;
 }
 
+/*
+ * AOCSScanSupportsBatch
+ *    Can the scan be read a batch at a time? All the columns it needs must
+ * be fixed-width and passed by value, and all its quals must be supported
+ * by ExecPushDownBatchQual().
+ */
+bool
+AOCSScanSupportsBatch(ScanState *scanState)
+{
+	Relation	currentRelation = scanState->ss_currentRelation;
+	TupleDesc	tupdesc = RelationGetDescr(currentRelation);
+	Plan	   *plan = scanState->ps.plan;
+	bool	   *proj;
+	bool		supported = true;
+	int			i;
+
+	Assert(scanState->tableType == TableTypeAOCS);
+
+	proj = palloc0(sizeof(bool) * tupdesc->natts);
+	GetNeededColumnsForScan((Node *) plan->targetlist, proj, tupdesc->natts);
+	GetNeededColumnsForScan((Node *) plan->qual, proj, tupdesc->natts);
+
+	for (i = 0; i < tupdesc->natts; i++)
+	{
+		Form_pg_attribute attr = tupdesc->attrs[i];
+
+		if (proj[i] && !(attr->attbyval && attr->attlen > 0))
+		{
+			supported = false;
+			break;
+		}
+	}
+	pfree(proj);
+
+	return supported &&
+		ExecSupportsBatchQual(plan->qual, ((Scan *) plan)->scanrelid, tupdesc);
+}
+
+/*
+ * AOCSScanSupportsLateMaterialization
+ *    Is it worth evaluating the scan quals before reading the columns that
+ * only the targetlist needs? There must be quals, and such columns.
+ */
+bool
+AOCSScanSupportsLateMaterialization(ScanState *scanState)
+{
+	Relation	currentRelation = scanState->ss_currentRelation;
+	int			natts = RelationGetDescr(currentRelation)->natts;
+	Plan	   *plan = scanState->ps.plan;
+	bool	   *proj;
+	bool	   *qualProj;
+	bool		supported = false;
+	int			i;
+
+	Assert(scanState->tableType == TableTypeAOCS);
+
+	if (plan->qual == NIL)
+		return false;
+
+	proj = palloc0(sizeof(bool) * natts);
+	qualProj = palloc0(sizeof(bool) * natts);
+	GetNeededColumnsForScan((Node *) plan->targetlist, proj, natts);
+	GetNeededColumnsForScan((Node *) plan->qual, qualProj, natts);
+
+	for (i = 0; i < natts; i++)
+	{
+		if (qualProj[i])
+			break;
+	}
+	if (i < natts)
+	{
+		/* The quals need some columns, so they can be read first */
+		for (i = 0; i < natts; i++)
+		{
+			if (proj[i] && !qualProj[i])
+			{
+				supported = true;
+				break;
+			}
+		}
+	}
+
+	pfree(proj);
+	pfree(qualProj);
+
+	return supported;
+}
+
+/*
+ * AOCSScanNextBatch
+ *    Read the next batch that has rows passing the scan quals. Returns false
+ * at the end of the scan.
+ */
+bool
+AOCSScanNextBatch(ScanState *scanState)
+{
+	AOCSScanState *node = (AOCSScanState *)scanState;
+	AOCSScanOpaqueData *opaque = node->opaque;
+
+	Assert(node->batchMode);
+	Assert(opaque != NULL && opaque->batch != NULL);
+
+	opaque->batchNext = 0;
+	return aocs_getnext_batch(opaque->scandesc,
+							  node->ss.ps.state->es_direction,
+							  opaque->batch);
+}
+
+/*
+ * Return the next selected row of the current batch, reading the next batch
+ * when the current one is used up. Columns without a vector are returned as
+ * nulls; nothing above the scan references them.
+ */
+static TupleTableSlot *
+AOCSScanNextFromBatch(AOCSScanState *node)
+{
+	AOCSScanOpaqueData *opaque = node->opaque;
+	AOCSBatch	batch = opaque->batch;
+	TupleTableSlot *slot = node->ss.ss_ScanTupleSlot;
+	Datum	   *values;
+	bool	   *isnull;
+	int			ncol;
+	int			row;
+	int			attno;
+
+	if (opaque->batchNext >= batch->nsel &&
+		!AOCSScanNextBatch((ScanState *) node))
+		return ExecClearTuple(slot);
+
+	row = batch->sel[opaque->batchNext++];
+
+	values = slot_get_values(slot);
+	isnull = slot_get_isnull(slot);
+	ncol = slot->tts_tupleDescriptor->natts;
+	Assert(ncol <= batch->ncol);
+
+	for (attno = 0; attno < ncol; attno++)
+	{
+		if (batch->values[attno] != NULL)
+		{
+			values[attno] = batch->values[attno][row];
+			isnull[attno] = batch->isnull[attno][row];
+		}
+		else
+		{
+			values[attno] = (Datum) 0;
+			isnull[attno] = true;
+		}
+	}
+
+	opaque->scandesc->cdb_fake_ctid = *((ItemPointer) &batch->tids[row]);
+
+	TupSetVirtualTupleNValid(slot, ncol);
+	slot_set_ctid(slot, &(opaque->scandesc->cdb_fake_ctid));
+	return slot;
+}
+
+/*
+ * Return the next row passing the scan quals. Only the columns the quals
+ * need are read for the rows that do not.
+ */
+static TupleTableSlot *
+AOCSScanNextLate(AOCSScanState *node)
+{
+	AOCSScanDesc scandesc = node->opaque->scandesc;
+	TupleTableSlot *slot = node->ss.ss_ScanTupleSlot;
+	ExprContext *econtext = node->ss.ps.ps_ExprContext;
+
+	for (;;)
+	{
+		aocs_getnext(scandesc, node->ss.ps.state->es_direction, slot);
+		if (TupIsNull(slot))
+			return slot;
+
+		econtext->ecxt_scantuple = slot;
+		if (ExecQual(node->lateQual, econtext, false))
+		{
+			aocs_fetch_late_columns(scandesc, slot);
+			return slot;
+		}
+
+		ResetExprContext(econtext);
+		CHECK_FOR_INTERRUPTS();
+	}
+}
+
 TupleTableSlot *
 AOCSScanNext(ScanState *scanState)
 {
@@ -68,10 +269,33 @@ AOCSScanNext(ScanState *scanState)
 	Assert(node->opaque != NULL &&
 		   node->opaque->scandesc != NULL);
 
+	if (node->batchMode)
+		return AOCSScanNextFromBatch(node);
+	if (node->lateQual != NIL)
+		return AOCSScanNextLate(node);
+
 	aocs_getnext(node->opaque->scandesc, node->ss.ps.state->es_direction, node->ss.ss_ScanTupleSlot);
 	return node->ss.ss_ScanTupleSlot;
 }
 
+/*
+ * AOCSScanExplainEnd
+ *    Report the blocks skipped thanks to zone maps to EXPLAIN ANALYZE.
+ */
+static void
+AOCSScanExplainEnd(PlanState *planstate, struct StringInfoData *buf)
+{
+	AOCSScanState *node = (AOCSScanState *) planstate;
+	int64		skipped = node->zoneMapSkippedBlocks;
+
+	if (node->opaque != NULL && node->opaque->scandesc != NULL)
+		skipped += node->opaque->scandesc->zonemap_skipped_blocks;
+
+	if (skipped > 0)
+		appendStringInfo(buf, "Zone maps skipped " INT64_FORMAT " blocks.\n",
+						 skipped);
+}
+
 void
 BeginScanAOCSRelation(ScanState *scanState)
 {
@@ -102,6 +326,52 @@ BeginScanAOCSRelation(ScanState *scanState)
 					   NULL /* relationTupleDesc */,
 					   node->opaque->proj);
 
+	if (node->batchMode)
+	{
+		node->opaque->batch = aocs_batch_create(node->opaque->scandesc);
+		ExecPushDownBatchQual(node->ss.ps.plan->qual,
+							  ((Scan *) node->ss.ps.plan)->scanrelid,
+							  RelationGetDescr(node->ss.ss_currentRelation),
+							  node->opaque->batch);
+	}
+	else if (node->lateQual != NIL)
+	{
+		/* Read the columns that only the targetlist needs late */
+		bool	   *late = palloc0(sizeof(bool) * node->opaque->ncol);
+		int			i;
+
+		GetNeededColumnsForScan((Node *) node->ss.ps.plan->qual, late,
+								node->opaque->ncol);
+		for (i = 0; i < node->opaque->ncol; i++)
+			late[i] = node->opaque->proj[i] && !late[i];
+
+		aocs_set_late_columns(node->opaque->scandesc, late);
+		pfree(late);
+	}
+
+	/*
+	 * Skip the blocks whose zone maps show that none of their rows can pass
+	 * the quals. In batch mode, the quals are all already predicates.
+	 */
+	if (gp_enable_aocs_zone_maps)
+	{
+		if (node->batchMode)
+			aocs_set_zone_map_predicates(node->opaque->scandesc,
+										 node->opaque->batch->npreds,
+										 node->opaque->batch->preds);
+		else if (ExecBuildScanPredicates(node->ss.ps.plan->qual,
+										 ((Scan *) node->ss.ps.plan)->scanrelid,
+										 RelationGetDescr(node->ss.ss_currentRelation),
+										 &node->opaque->zoneMapNPreds,
+										 &node->opaque->zoneMapPreds))
+			aocs_set_zone_map_predicates(node->opaque->scandesc,
+										 node->opaque->zoneMapNPreds,
+										 node->opaque->zoneMapPreds);
+
+		if (node->ss.ps.instrument)
+			node->ss.ps.cdbexplainfun = AOCSScanExplainEnd;
+	}
+
 	node->ss.scan_state = SCAN_SCAN;
 }
  
@@ -116,6 +386,7 @@ EndScanAOCSRelation(ScanState *scanState)
 	Assert(node->opaque != NULL &&
 		   node->opaque->scandesc != NULL);
 
+	node->zoneMapSkippedBlocks += node->opaque->scandesc->zonemap_skipped_blocks;
 	aocs_endscan(node->opaque->scandesc);
         
 	FreeAOCSScanOpaque(scanState);
@@ -133,4 +404,10 @@ ReScanAOCSRelation(ScanState *scanState)
 		   node->opaque->scandesc != NULL);
 
 	aocs_rescan(node->opaque->scandesc); 
+
+	if (node->opaque->batch != NULL)
+	{
+		node->opaque->batch->nsel = 0;
+		node->opaque->batchNext = 0;
+	}
 }
@@ -0,0 +1,1003 @@
+/*
+ * execBatch.c
+ *   Batch-at-a-time evaluation of scan quals and simple aggregates.
+ *
+ * When gp_enable_batch_execution is set, a scan of an AOCS relation whose
+ * needed columns are all fixed-width and passed by value reads its rows a
+ * batch at a time, see aocs_getnext_batch(). The routines in this file run
+ * over the column vectors of such a batch:
+ *
+ * - The scan quals, if they all are simple comparisons of a column with a
+ *   constant, BETWEEN or IN lists of constants, are pushed down into the
+ *   reads of the columns as DatumStreamPredicates. Only the rows passing
+ *   them are selected, and materialized in the other columns.
+ *
+ * - A plain Agg directly above the scan, whose aggregates all are count,
+ *   sum, min, max or avg of a column (or count(*)), accumulates the selected
+ *   rows of each batch without ever forming a tuple. The results are stored
+ *   in the regular transition values once the input is exhausted, so that
+ *   finalization, HAVING and projection work as in row mode.
+ *
+ * Anything else falls back to row mode: the scan then returns the rows of
+ * its batches one at a time, through AOCSScanNext().
+ *
+ * Copyright (c) 2016 - present, Pivotal Software, Inc.
+ */
+#include "postgres.h"
+
+#include <math.h>
+
+#include "catalog/pg_type.h"
+#include "executor/execBatch.h"
+#include "executor/nodeAgg.h"
+#include "optimizer/planmain.h"
+#include "parser/parsetree.h"
+#include "utils/array.h"
+#include "utils/fmgroids.h"
+#include "utils/numeric.h"
+
+/* The types of values the batch routines handle */
+typedef enum BatchValueType
+{
+	BATCH_TYPE_INT2,
+	BATCH_TYPE_INT4,			/* also date */
+	BATCH_TYPE_INT8,
+	BATCH_TYPE_FLOAT4,
+	BATCH_TYPE_FLOAT8
+} BatchValueType;
+
+typedef enum BatchAggKind
+{
+	BATCH_AGG_COUNT_STAR,
+	BATCH_AGG_COUNT,
+	BATCH_AGG_SUM,
+	BATCH_AGG_MIN,
+	BATCH_AGG_MAX,
+	BATCH_AGG_AVG
+} BatchAggKind;
+
+/* The accumulator of one aggregate */
+typedef struct BatchAgg
+{
+	BatchAggKind kind;
+	BatchValueType type;
+	int			attno;			/* column number, -1 for count(*) */
+
+	int64		count;			/* number of non-null inputs */
+	int64		isum;			/* sum of integer inputs */
+	float8		fsum;			/* sum of float inputs, or of any avg input */
+	int64		imin_max;		/* min/max of integer inputs */
+	float8		fmin_max;		/* min/max of float inputs */
+} BatchAgg;
+
+struct BatchAggState
+{
+	int			naggs;
+	BatchAgg   *aggs;
+};
+
+/*
+ * The comparison functions that can be pushed down into the reads of a
+ * column, by the type of both of their arguments.
+ */
+static const struct
+{
+	Oid			funcid;
+	DatumStreamPredicateType type;
+	DatumStreamPredicateOp op;
+}	batch_cmp_funcs[] =
+{
+	{F_INT2EQ, DatumStreamPredicateType_Int2, DatumStreamPredicateOp_Eq},
+	{F_INT2NE, DatumStreamPredicateType_Int2, DatumStreamPredicateOp_Ne},
+	{F_INT2LT, DatumStreamPredicateType_Int2, DatumStreamPredicateOp_Lt},
+	{F_INT2LE, DatumStreamPredicateType_Int2, DatumStreamPredicateOp_Le},
+	{F_INT2GT, DatumStreamPredicateType_Int2, DatumStreamPredicateOp_Gt},
+	{F_INT2GE, DatumStreamPredicateType_Int2, DatumStreamPredicateOp_Ge},
+	{F_INT4EQ, DatumStreamPredicateType_Int4, DatumStreamPredicateOp_Eq},
+	{F_INT4NE, DatumStreamPredicateType_Int4, DatumStreamPredicateOp_Ne},
+	{F_INT4LT, DatumStreamPredicateType_Int4, DatumStreamPredicateOp_Lt},
+	{F_INT4LE, DatumStreamPredicateType_Int4, DatumStreamPredicateOp_Le},
+	{F_INT4GT, DatumStreamPredicateType_Int4, DatumStreamPredicateOp_Gt},
+	{F_INT4GE, DatumStreamPredicateType_Int4, DatumStreamPredicateOp_Ge},
+	{F_DATE_EQ, DatumStreamPredicateType_Int4, DatumStreamPredicateOp_Eq},
+	{F_DATE_NE, DatumStreamPredicateType_Int4, DatumStreamPredicateOp_Ne},
+	{F_DATE_LT, DatumStreamPredicateType_Int4, DatumStreamPredicateOp_Lt},
+	{F_DATE_LE, DatumStreamPredicateType_Int4, DatumStreamPredicateOp_Le},
+	{F_DATE_GT, DatumStreamPredicateType_Int4, DatumStreamPredicateOp_Gt},
+	{F_DATE_GE, DatumStreamPredicateType_Int4, DatumStreamPredicateOp_Ge},
+	{F_INT8EQ, DatumStreamPredicateType_Int8, DatumStreamPredicateOp_Eq},
+	{F_INT8NE, DatumStreamPredicateType_Int8, DatumStreamPredicateOp_Ne},
+	{F_INT8LT, DatumStreamPredicateType_Int8, DatumStreamPredicateOp_Lt},
+	{F_INT8LE, DatumStreamPredicateType_Int8, DatumStreamPredicateOp_Le},
+	{F_INT8GT, DatumStreamPredicateType_Int8, DatumStreamPredicateOp_Gt},
+	{F_INT8GE, DatumStreamPredicateType_Int8, DatumStreamPredicateOp_Ge},
+	{F_FLOAT4EQ, DatumStreamPredicateType_Float4, DatumStreamPredicateOp_Eq},
+	{F_FLOAT4NE, DatumStreamPredicateType_Float4, DatumStreamPredicateOp_Ne},
+	{F_FLOAT4LT, DatumStreamPredicateType_Float4, DatumStreamPredicateOp_Lt},
+	{F_FLOAT4LE, DatumStreamPredicateType_Float4, DatumStreamPredicateOp_Le},
+	{F_FLOAT4GT, DatumStreamPredicateType_Float4, DatumStreamPredicateOp_Gt},
+	{F_FLOAT4GE, DatumStreamPredicateType_Float4, DatumStreamPredicateOp_Ge},
+	{F_FLOAT8EQ, DatumStreamPredicateType_Float8, DatumStreamPredicateOp_Eq},
+	{F_FLOAT8NE, DatumStreamPredicateType_Float8, DatumStreamPredicateOp_Ne},
+	{F_FLOAT8LT, DatumStreamPredicateType_Float8, DatumStreamPredicateOp_Lt},
+	{F_FLOAT8LE, DatumStreamPredicateType_Float8, DatumStreamPredicateOp_Le},
+	{F_FLOAT8GT, DatumStreamPredicateType_Float8, DatumStreamPredicateOp_Gt},
+	{F_FLOAT8GE, DatumStreamPredicateType_Float8, DatumStreamPredicateOp_Ge},
+};
+
+/*
+ * The transition functions a BatchAgg can replace, by the type of their
+ * input. InvalidOid accepts any type.
+ */
+static const struct
+{
+	Oid			funcid;
+	Oid			inputtype;
+	BatchAggKind kind;
+}	batch_agg_funcs[] =
+{
+	{F_INT8INC, InvalidOid, BATCH_AGG_COUNT_STAR},
+	{F_INT8INC_ANY, InvalidOid, BATCH_AGG_COUNT},
+	{F_INT2_SUM, INT2OID, BATCH_AGG_SUM},
+	{F_INT4_SUM, INT4OID, BATCH_AGG_SUM},
+	{F_FLOAT8PL, FLOAT8OID, BATCH_AGG_SUM},
+	{F_INT2SMALLER, INT2OID, BATCH_AGG_MIN},
+	{F_INT4SMALLER, INT4OID, BATCH_AGG_MIN},
+	{F_INT8SMALLER, INT8OID, BATCH_AGG_MIN},
+	{F_FLOAT4SMALLER, FLOAT4OID, BATCH_AGG_MIN},
+	{F_FLOAT8SMALLER, FLOAT8OID, BATCH_AGG_MIN},
+	{F_DATE_SMALLER, DATEOID, BATCH_AGG_MIN},
+	{F_INT2LARGER, INT2OID, BATCH_AGG_MAX},
+	{F_INT4LARGER, INT4OID, BATCH_AGG_MAX},
+	{F_INT8LARGER, INT8OID, BATCH_AGG_MAX},
+	{F_FLOAT4LARGER, FLOAT4OID, BATCH_AGG_MAX},
+	{F_FLOAT8LARGER, FLOAT8OID, BATCH_AGG_MAX},
+	{F_DATE_LARGER, DATEOID, BATCH_AGG_MAX},
+	{F_INT2_AVG_ACCUM, INT2OID, BATCH_AGG_AVG},
+	{F_INT4_AVG_ACCUM, INT4OID, BATCH_AGG_AVG},
+	{F_INT8_AVG_ACCUM, INT8OID, BATCH_AGG_AVG},
+	{F_FLOAT4_AVG_ACCUM, FLOAT4OID, BATCH_AGG_AVG},
+	{F_FLOAT8_AVG_ACCUM, FLOAT8OID, BATCH_AGG_AVG},
+};
+
+#define BATCH_INT_CMP(a, b) (((a) > (b)) - ((a) < (b)))
+
+/*
+ * Same as float8_cmp_internal(): NaNs are equal to each other, and greater
+ * than any non-NaN value.
+ */
+static inline int
+batch_float_cmp(float8 a, float8 b)
+{
+	if (isnan(a))
+		return isnan(b) ? 0 : 1;
+	if (isnan(b))
+		return -1;
+	return BATCH_INT_CMP(a, b);
+}
+
+static bool
+batch_value_type(Oid typid, BatchValueType *type)
+{
+	switch (typid)
+	{
+		case INT2OID:
+			*type = BATCH_TYPE_INT2;
+			return true;
+		case INT4OID:
+		case DATEOID:
+			*type = BATCH_TYPE_INT4;
+			return true;
+		case INT8OID:
+			*type = BATCH_TYPE_INT8;
+			return true;
+		case FLOAT4OID:
+			*type = BATCH_TYPE_FLOAT4;
+			return true;
+		case FLOAT8OID:
+			*type = BATCH_TYPE_FLOAT8;
+			return true;
+		default:
+			return false;
+	}
+}
+
+/*
+ * Can the column be read into a vector of a batch? See aocs_batch_create().
+ */
+static bool
+batch_column_supported(TupleDesc tupdesc, AttrNumber varattno)
+{
+	Form_pg_attribute attr;
+
+	if (varattno <= 0 || varattno > tupdesc->natts)
+		return false;
+
+	attr = tupdesc->attrs[varattno - 1];
+	return !attr->attisdropped && attr->attbyval && attr->attlen > 0;
+}
+
+/* The opposite of "const op column", as "column op const" */
+static DatumStreamPredicateOp
+batch_commute_op(DatumStreamPredicateOp op)
+{
+	switch (op)
+	{
+		case DatumStreamPredicateOp_Lt:
+			return DatumStreamPredicateOp_Gt;
+		case DatumStreamPredicateOp_Le:
+			return DatumStreamPredicateOp_Ge;
+		case DatumStreamPredicateOp_Gt:
+			return DatumStreamPredicateOp_Lt;
+		case DatumStreamPredicateOp_Ge:
+			return DatumStreamPredicateOp_Le;
+		default:
+			return op;
+	}
+}
+
+/*
+ * NaN constants are not pushed down; the predicates rely on a constant
+ * comparing the same way with the IEEE operators as in float8_cmp_internal().
+ */
+static bool
+batch_const_is_nan(DatumStreamPredicateType type, Datum value)
+{
+	if (type == DatumStreamPredicateType_Float4)
+		return isnan(DatumGetFloat4(value));
+	if (type == DatumStreamPredicateType_Float8)
+		return isnan(DatumGetFloat8(value));
+	return false;
+}
+
+/* Look up a supported comparison function */
+static bool
+batch_cmp_func(Oid funcid, DatumStreamPredicateType *type,
+			   DatumStreamPredicateOp *op)
+{
+	int			i;
+
+	for (i = 0; i < lengthof(batch_cmp_funcs); i++)
+	{
+		if (batch_cmp_funcs[i].funcid == funcid)
+		{
+			*type = batch_cmp_funcs[i].type;
+			*op = batch_cmp_funcs[i].op;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Split a binary operator expression into a column of the scan and a
+ * non-null constant. *commute is set if the constant comes first.
+ */
+static bool
+batch_var_and_const(List *args, Index scanrelid, TupleDesc tupdesc,
+					Var **var, Const **con, bool *commute)
+{
+	Node	   *leftop;
+	Node	   *rightop;
+
+	if (list_length(args) != 2)
+		return false;
+
+	leftop = (Node *) linitial(args);
+	rightop = (Node *) lsecond(args);
+
+	if (IsA(leftop, Var) && IsA(rightop, Const))
+	{
+		*var = (Var *) leftop;
+		*con = (Const *) rightop;
+		*commute = false;
+	}
+	else if (IsA(leftop, Const) && IsA(rightop, Var))
+	{
+		*var = (Var *) rightop;
+		*con = (Const *) leftop;
+		*commute = true;
+	}
+	else
+		return false;
+
+	return (*var)->varno == scanrelid &&
+		batch_column_supported(tupdesc, (*var)->varattno) &&
+		!(*con)->constisnull;
+}
+
+/*
+ * Turn "column = ANY (array constant)" into an IN predicate. Null elements
+ * can never be equal to the column, so they are left out.
+ */
+static bool
+batch_in_list_from_expr(ScalarArrayOpExpr *saop, Index scanrelid,
+						TupleDesc tupdesc, int *attno,
+						DatumStreamPredicate *result)
+{
+	Var		   *var;
+	Const	   *con;
+	bool		commute;
+	Form_pg_attribute attr;
+	ArrayType  *array;
+	Datum	   *elems;
+	bool	   *nulls;
+	int			nelems;
+	int			i;
+
+	if (!saop->useOr ||
+		!batch_var_and_const(saop->args, scanrelid, tupdesc, &var, &con,
+							 &commute) ||
+		commute)
+		return false;
+
+	set_sa_opfuncid(saop);
+	if (!batch_cmp_func(saop->opfuncid, &result->type, &result->op) ||
+		result->op != DatumStreamPredicateOp_Eq)
+		return false;
+
+	/* The elements are stored like the column */
+	attr = tupdesc->attrs[var->varattno - 1];
+	array = DatumGetArrayTypeP(con->constvalue);
+	if (ARR_ELEMTYPE(array) != attr->atttypid)
+		return false;
+
+	deconstruct_array(array, attr->atttypid, attr->attlen, attr->attbyval,
+					  attr->attalign, &elems, &nulls, &nelems);
+
+	result->op = DatumStreamPredicateOp_In;
+	result->value = (Datum) 0;
+	result->value2 = (Datum) 0;
+	result->nInValues = 0;
+	result->inValues = (Datum *) palloc(sizeof(Datum) * Max(nelems, 1));
+
+	for (i = 0; i < nelems; i++)
+	{
+		if (nulls[i])
+			continue;
+		if (batch_const_is_nan(result->type, elems[i]))
+		{
+			pfree(result->inValues);
+			result->inValues = NULL;
+			return false;
+		}
+		result->inValues[result->nInValues++] = elems[i];
+	}
+
+	*attno = var->varattno - 1;
+	return true;
+}
+
+/*
+ * Turn a qual into a predicate on a column of the scan, if it has the form
+ * "column op constant" or "constant op column" with a supported comparison
+ * function, or "column IN (constants)". Sets *attno to the column number,
+ * starting from 0.
+ */
+static bool
+batch_qual_from_expr(Expr *expr, Index scanrelid, TupleDesc tupdesc,
+					 int *attno, DatumStreamPredicate *result)
+{
+	OpExpr	   *opexpr;
+	Var		   *var;
+	Const	   *con;
+	bool		commute;
+
+	if (IsA(expr, ScalarArrayOpExpr))
+		return batch_in_list_from_expr((ScalarArrayOpExpr *) expr, scanrelid,
+									   tupdesc, attno, result);
+
+	if (!IsA(expr, OpExpr))
+		return false;
+
+	opexpr = (OpExpr *) expr;
+	if (!batch_var_and_const(opexpr->args, scanrelid, tupdesc, &var, &con,
+							 &commute))
+		return false;
+
+	set_opfuncid(opexpr);
+	if (!batch_cmp_func(opexpr->opfuncid, &result->type, &result->op) ||
+		batch_const_is_nan(result->type, con->constvalue))
+		return false;
+
+	if (commute)
+		result->op = batch_commute_op(result->op);
+	result->value = con->constvalue;
+	result->value2 = (Datum) 0;
+	result->nInValues = 0;
+	result->inValues = NULL;
+	*attno = var->varattno - 1;
+	return true;
+}
+
+/*
+ * ExecSupportsBatchQual
+ *    Can all the given scan quals be pushed down by ExecPushDownBatchQual()?
+ */
+bool
+ExecSupportsBatchQual(List *qual, Index scanrelid, TupleDesc tupdesc)
+{
+	ListCell   *lc;
+	DatumStreamPredicate pred;
+	int			attno;
+
+	foreach(lc, qual)
+	{
+		if (!batch_qual_from_expr((Expr *) lfirst(lc), scanrelid, tupdesc,
+								  &attno, &pred))
+			return false;
+		if (pred.inValues)
+			pfree(pred.inValues);
+	}
+
+	return true;
+}
+
+/*
+ * Turn the given scan quals into predicates, into *attnos and *preds, and
+ * return their number. Quals that cannot be turned into a predicate raise
+ * an error, unless 'partial', in which case they are left out.
+ *
+ * A ">=" and a "<=" on the same column, as the planner makes of BETWEEN,
+ * are merged into a single BETWEEN predicate.
+ */
+static int
+batch_preds_from_qual(List *qual, Index scanrelid, TupleDesc tupdesc,
+					  bool partial, int **attnos_p,
+					  DatumStreamPredicate **preds_p)
+{
+	int			npreds = 0;
+	DatumStreamPredicate *preds;
+	int		   *attnos;
+	bool	   *merged;
+	ListCell   *lc;
+	int			i;
+	int			j;
+
+	*attnos_p = NULL;
+	*preds_p = NULL;
+
+	if (qual == NIL)
+		return 0;
+
+	preds = (DatumStreamPredicate *) palloc(sizeof(DatumStreamPredicate) * list_length(qual));
+	attnos = (int *) palloc(sizeof(int) * list_length(qual));
+	merged = (bool *) palloc0(sizeof(bool) * list_length(qual));
+
+	foreach(lc, qual)
+	{
+		if (batch_qual_from_expr((Expr *) lfirst(lc), scanrelid, tupdesc,
+								 &attnos[npreds], &preds[npreds]))
+			npreds++;
+		else if (!partial)
+			elog(ERROR, "unsupported qual in batch mode scan");
+	}
+
+	for (i = 0; i < npreds; i++)
+	{
+		DatumStreamPredicateOp other;
+
+		if (merged[i])
+			continue;
+
+		if (preds[i].op == DatumStreamPredicateOp_Ge)
+			other = DatumStreamPredicateOp_Le;
+		else if (preds[i].op == DatumStreamPredicateOp_Le)
+			other = DatumStreamPredicateOp_Ge;
+		else
+			continue;
+
+		for (j = i + 1; j < npreds; j++)
+		{
+			if (merged[j] || attnos[j] != attnos[i] || preds[j].op != other ||
+				preds[j].type != preds[i].type)
+				continue;
+
+			if (other == DatumStreamPredicateOp_Le)
+				preds[i].value2 = preds[j].value;
+			else
+			{
+				preds[i].value2 = preds[i].value;
+				preds[i].value = preds[j].value;
+			}
+			preds[i].op = DatumStreamPredicateOp_Between;
+			merged[j] = true;
+			break;
+		}
+	}
+
+	/* Keep the predicates that were not merged into another */
+	j = 0;
+	for (i = 0; i < npreds; i++)
+	{
+		if (merged[i])
+			continue;
+		attnos[j] = attnos[i];
+		preds[j] = preds[i];
+		j++;
+	}
+	pfree(merged);
+
+	*attnos_p = attnos;
+	*preds_p = preds;
+	return j;
+}
+
+/*
+ * ExecPushDownBatchQual
+ *    Add the given scan quals to the batch, as predicates on its columns.
+ * The caller must have checked them with ExecSupportsBatchQual().
+ */
+void
+ExecPushDownBatchQual(List *qual, Index scanrelid, TupleDesc tupdesc,
+					  AOCSBatch batch)
+{
+	DatumStreamPredicate *preds;
+	int		   *attnos;
+	int			npreds;
+	int			i;
+
+	npreds = batch_preds_from_qual(qual, scanrelid, tupdesc, false,
+								   &attnos, &preds);
+	if (npreds == 0)
+		return;
+
+	for (i = 0; i < npreds; i++)
+		aocs_batch_add_predicate(batch, attnos[i], &preds[i]);
+
+	pfree(preds);
+	pfree(attnos);
+}
+
+/*
+ * ExecBuildScanPredicates
+ *    Turn the scan quals that can be into predicates for the zone maps of
+ * the columns, see aocs_set_zone_map_predicates(). The other quals are left
+ * out; all of them must still be evaluated on the rows.
+ *
+ * On success, *npreds_p and *preds_p are set to arrays indexed by column
+ * number, to be freed with ExecFreeScanPredicates(). Returns false if there
+ * is no predicate.
+ */
+bool
+ExecBuildScanPredicates(List *qual, Index scanrelid, TupleDesc tupdesc,
+						int **npreds_p, DatumStreamPredicate ***preds_p)
+{
+	DatumStreamPredicate *preds;
+	int		   *attnos;
+	int			n;
+	int			nkept = 0;
+	int		   *npreds;
+	DatumStreamPredicate **colpreds;
+	int			i;
+
+	*npreds_p = NULL;
+	*preds_p = NULL;
+
+	n = batch_preds_from_qual(qual, scanrelid, tupdesc, true, &attnos, &preds);
+	if (n == 0)
+		return false;
+
+	npreds = (int *) palloc0(sizeof(int) * tupdesc->natts);
+	colpreds = (DatumStreamPredicate **)
+		palloc0(sizeof(DatumStreamPredicate *) * tupdesc->natts);
+
+	for (i = 0; i < n; i++)
+	{
+		int			attno = attnos[i];
+		DatumStreamPredicateType summaryType;
+
+		/* The zone maps of a column are kept in the order of its own type */
+		if (!datumstream_summary_type(tupdesc->attrs[attno]->atttypid, &summaryType) ||
+			summaryType != preds[i].type)
+		{
+			if (preds[i].inValues)
+				pfree(preds[i].inValues);
+			continue;
+		}
+
+		if (colpreds[attno] == NULL)
+			colpreds[attno] = (DatumStreamPredicate *) palloc(sizeof(DatumStreamPredicate));
+		else
+			colpreds[attno] = (DatumStreamPredicate *)
+				repalloc(colpreds[attno],
+						 sizeof(DatumStreamPredicate) * (npreds[attno] + 1));
+		colpreds[attno][npreds[attno]++] = preds[i];
+		nkept++;
+	}
+
+	pfree(preds);
+	pfree(attnos);
+
+	if (nkept == 0)
+	{
+		ExecFreeScanPredicates(tupdesc->natts, npreds, colpreds);
+		return false;
+	}
+
+	*npreds_p = npreds;
+	*preds_p = colpreds;
+	return true;
+}
+
+/*
+ * ExecFreeScanPredicates
+ *    Free the predicates made by ExecBuildScanPredicates().
+ */
+void
+ExecFreeScanPredicates(int ncol, int *npreds, DatumStreamPredicate **preds)
+{
+	int			i;
+	int			j;
+
+	for (i = 0; i < ncol; i++)
+	{
+		for (j = 0; j < npreds[i]; j++)
+		{
+			if (preds[i][j].inValues)
+				pfree(preds[i][j].inValues);
+		}
+		if (preds[i])
+			pfree(preds[i]);
+	}
+
+	pfree(npreds);
+	pfree(preds);
+}
+
+/*
+ * ExecInitBatchAgg
+ *    Check whether the aggregates of the given Agg can be advanced a batch
+ * at a time, and if so, set up their accumulators.
+ *
+ * This requires a plain Agg directly above a batch mode scan, whose
+ * aggregates all are count(*), or count, sum, min, max or avg of a column
+ * of the scan. Returns NULL otherwise.
+ */
+BatchAggState *
+ExecInitBatchAgg(AggState *aggstate)
+{
+	Agg		   *node = (Agg *) aggstate->ss.ps.plan;
+	PlanState  *outerPlan = outerPlanState(aggstate);
+	TableScanState *scanState;
+	TupleDesc	tupdesc;
+	Index		scanrelid;
+	BatchAggState *state;
+	int			aggno;
+
+	if (node->aggstrategy != AGG_PLAIN || node->numCols > 0 ||
+		node->inputHasGrouping || aggstate->percs != NIL ||
+		aggstate->numaggs == 0)
+		return NULL;
+
+	if (outerPlan == NULL || !IsA(outerPlan, TableScanState))
+		return NULL;
+
+	scanState = (TableScanState *) outerPlan;
+	if (!scanState->batchMode)
+		return NULL;
+
+	Assert(scanState->ss.ss_currentRelation != NULL);
+	tupdesc = RelationGetDescr(scanState->ss.ss_currentRelation);
+	scanrelid = ((Scan *) scanState->ss.ps.plan)->scanrelid;
+
+	state = (BatchAggState *) palloc0(sizeof(BatchAggState));
+	state->naggs = aggstate->numaggs;
+	state->aggs = (BatchAgg *) palloc0(sizeof(BatchAgg) * state->naggs);
+
+	for (aggno = 0; aggno < aggstate->numaggs; aggno++)
+	{
+		AggStatePerAgg peraggstate = &aggstate->peragg[aggno];
+		Aggref	   *aggref = peraggstate->aggref;
+		BatchAgg   *agg = &state->aggs[aggno];
+		Oid			inputtype = InvalidOid;
+		int			i;
+
+		if (aggref == NULL || aggref->aggdistinct || aggref->aggorder != NULL ||
+			peraggstate->numSortCols > 0)
+			goto unsupported;
+
+		agg->attno = -1;
+		if (list_length(aggref->args) == 1)
+		{
+			Var		   *var = (Var *) linitial(aggref->args);
+			TargetEntry *tle;
+
+			/* The argument must be a column of the scan */
+			if (!IsA(var, Var) || var->varno != OUTER)
+				goto unsupported;
+
+			tle = get_tle_by_resno(scanState->ss.ps.plan->targetlist, var->varattno);
+			if (tle == NULL || !IsA(tle->expr, Var))
+				goto unsupported;
+
+			var = (Var *) tle->expr;
+			if (var->varno != scanrelid ||
+				!batch_column_supported(tupdesc, var->varattno))
+				goto unsupported;
+
+			agg->attno = var->varattno - 1;
+			inputtype = tupdesc->attrs[agg->attno]->atttypid;
+		}
+		else if (aggref->args != NIL)
+			goto unsupported;
+
+		for (i = 0; i < lengthof(batch_agg_funcs); i++)
+		{
+			if (batch_agg_funcs[i].funcid == peraggstate->transfn_oid)
+				break;
+		}
+		if (i == lengthof(batch_agg_funcs))
+			goto unsupported;
+
+		agg->kind = batch_agg_funcs[i].kind;
+		if ((agg->kind == BATCH_AGG_COUNT_STAR) != (agg->attno < 0))
+			goto unsupported;
+
+		if (batch_agg_funcs[i].inputtype != InvalidOid)
+		{
+			if (batch_agg_funcs[i].inputtype != inputtype ||
+				!batch_value_type(inputtype, &agg->type))
+				goto unsupported;
+		}
+	}
+
+	return state;
+
+unsupported:
+	pfree(state->aggs);
+	pfree(state);
+	return NULL;
+}
+
+/*
+ * ExecResetBatchAgg
+ *    Clear the accumulators, before the first batch of a group.
+ */
+void
+ExecResetBatchAgg(BatchAggState *state)
+{
+	int			aggno;
+
+	for (aggno = 0; aggno < state->naggs; aggno++)
+	{
+		BatchAgg   *agg = &state->aggs[aggno];
+
+		agg->count = 0;
+		agg->isum = 0;
+		agg->fsum = 0;
+		agg->imin_max = 0;
+		agg->fmin_max = 0;
+	}
+}
+
+/*
+ * Accumulate the selected non-null values of a column. The float variants
+ * follow float8pl(), float8smaller() and float8larger(), so that the results
+ * are the same as in row mode.
+ */
+#define BATCH_ADVANCE_LOOP(BODY) \
+	for (i = 0; i < nsel; i++) \
+	{ \
+		int			row = sel[i]; \
+		if (isnull[row]) \
+			continue; \
+		BODY; \
+		agg->count++; \
+	}
+
+#define BATCH_ADVANCE_INT(GET) \
+	switch (agg->kind) \
+	{ \
+		case BATCH_AGG_SUM: \
+			BATCH_ADVANCE_LOOP(agg->isum += GET(values[row])); \
+			break; \
+		case BATCH_AGG_MIN: \
+			BATCH_ADVANCE_LOOP( \
+				int64 v = GET(values[row]); \
+				if (agg->count == 0 || v < agg->imin_max) \
+					agg->imin_max = v); \
+			break; \
+		case BATCH_AGG_MAX: \
+			BATCH_ADVANCE_LOOP( \
+				int64 v = GET(values[row]); \
+				if (agg->count == 0 || v > agg->imin_max) \
+					agg->imin_max = v); \
+			break; \
+		case BATCH_AGG_AVG: \
+			BATCH_ADVANCE_LOOP(agg->fsum += (float8) GET(values[row])); \
+			break; \
+		default: \
+			Assert(false); \
+	}
+
+#define BATCH_ADVANCE_FLOAT(GET) \
+	switch (agg->kind) \
+	{ \
+		case BATCH_AGG_SUM: \
+			BATCH_ADVANCE_LOOP( \
+				float8 v = GET(values[row]); \
+				float8 result = agg->fsum + v; \
+				if (agg->count == 0) \
+					result = v; \
+				else if (isinf(result) && !isinf(agg->fsum) && !isinf(v)) \
+					ereport(ERROR, \
+							(errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE), \
+							 errmsg("value out of range: overflow"))); \
+				agg->fsum = result); \
+			break; \
+		case BATCH_AGG_MIN: \
+			BATCH_ADVANCE_LOOP( \
+				float8 v = GET(values[row]); \
+				if (agg->count == 0 || batch_float_cmp(agg->fmin_max, v) >= 0) \
+					agg->fmin_max = v); \
+			break; \
+		case BATCH_AGG_MAX: \
+			BATCH_ADVANCE_LOOP( \
+				float8 v = GET(values[row]); \
+				if (agg->count == 0 || batch_float_cmp(agg->fmin_max, v) <= 0) \
+					agg->fmin_max = v); \
+			break; \
+		case BATCH_AGG_AVG: \
+			BATCH_ADVANCE_LOOP(agg->fsum += GET(values[row])); \
+			break; \
+		default: \
+			Assert(false); \
+	}
+
+static void
+batch_advance_agg(BatchAgg *agg, AOCSBatch batch)
+{
+	int		   *sel = batch->sel;
+	int			nsel = batch->nsel;
+	Datum	   *values;
+	bool	   *isnull;
+	int			i;
+
+	if (agg->kind == BATCH_AGG_COUNT_STAR)
+	{
+		agg->count += nsel;
+		return;
+	}
+
+	Assert(batch->values[agg->attno] != NULL);
+	values = batch->values[agg->attno];
+	isnull = batch->isnull[agg->attno];
+
+	if (agg->kind == BATCH_AGG_COUNT)
+	{
+		for (i = 0; i < nsel; i++)
+			agg->count += !isnull[sel[i]];
+		return;
+	}
+
+	switch (agg->type)
+	{
+		case BATCH_TYPE_INT2:
+			BATCH_ADVANCE_INT(DatumGetInt16);
+			break;
+		case BATCH_TYPE_INT4:
+			BATCH_ADVANCE_INT(DatumGetInt32);
+			break;
+		case BATCH_TYPE_INT8:
+			BATCH_ADVANCE_INT(DatumGetInt64);
+			break;
+		case BATCH_TYPE_FLOAT4:
+			BATCH_ADVANCE_FLOAT(DatumGetFloat4);
+			break;
+		case BATCH_TYPE_FLOAT8:
+			BATCH_ADVANCE_FLOAT(DatumGetFloat8);
+			break;
+	}
+}
+
+/*
+ * ExecBatchAdvanceAggregates
+ *    Accumulate the selected rows of a batch into all the aggregates.
+ */
+void
+ExecBatchAdvanceAggregates(BatchAggState *state, AOCSBatch batch)
+{
+	int			aggno;
+
+	for (aggno = 0; aggno < state->naggs; aggno++)
+		batch_advance_agg(&state->aggs[aggno], batch);
+}
+
+/* The min/max of an aggregate, as a Datum of its input type */
+static Datum
+batch_min_max_datum(BatchAgg *agg)
+{
+	switch (agg->type)
+	{
+		case BATCH_TYPE_INT2:
+			return Int16GetDatum((int16) agg->imin_max);
+		case BATCH_TYPE_INT4:
+			return Int32GetDatum((int32) agg->imin_max);
+		case BATCH_TYPE_INT8:
+			return Int64GetDatum(agg->imin_max);
+		case BATCH_TYPE_FLOAT4:
+			return Float4GetDatum((float4) agg->fmin_max);
+		case BATCH_TYPE_FLOAT8:
+			return Float8GetDatum(agg->fmin_max);
+	}
+
+	Assert(false);
+	return (Datum) 0;
+}
+
+/*
+ * ExecBatchAggEnd
+ *    Store the accumulated results into the transition values of the group,
+ * as if its rows had been advanced one at a time. The transition values must
+ * have been initialized by initialize_aggregates().
+ */
+void
+ExecBatchAggEnd(BatchAggState *state, AggState *aggstate,
+				AggStatePerGroup pergroup)
+{
+	int			aggno;
+
+	for (aggno = 0; aggno < state->naggs; aggno++)
+	{
+		BatchAgg   *agg = &state->aggs[aggno];
+		AggStatePerAgg peraggstate = &aggstate->peragg[aggno];
+		AggStatePerGroup pergroupstate = &pergroup[aggno];
+		Datum		value;
+
+		switch (agg->kind)
+		{
+			case BATCH_AGG_COUNT_STAR:
+			case BATCH_AGG_COUNT:
+				Assert(!pergroupstate->transValueIsNull);
+				value = Int64GetDatum(DatumGetInt64(pergroupstate->transValue) +
+									  agg->count);
+				break;
+
+			case BATCH_AGG_SUM:
+				if (agg->count == 0)
+					continue;
+				if (agg->type == BATCH_TYPE_FLOAT8)
+					value = Float8GetDatum(agg->fsum);
+				else
+					value = Int64GetDatum(agg->isum);
+				break;
+
+			case BATCH_AGG_MIN:
+			case BATCH_AGG_MAX:
+				if (agg->count == 0)
+					continue;
+				value = batch_min_max_datum(agg);
+				break;
+
+			case BATCH_AGG_AVG:
+				{
+					IntFloatAvgTransdata *transdata;
+
+					if (agg->count == 0)
+						continue;
+					transdata = (IntFloatAvgTransdata *) palloc0(sizeof(IntFloatAvgTransdata));
+					SET_VARSIZE(transdata, sizeof(IntFloatAvgTransdata));
+					transdata->count = agg->count;
+					transdata->sum = agg->fsum;
+					value = PointerGetDatum(transdata);
+					break;
+				}
+
+			default:
+				elog(ERROR, "unrecognized batch aggregate kind: %d", agg->kind);
+				value = (Datum) 0;	/* keep compiler quiet */
+		}
+
+		pergroupstate->transValue =
+			datumCopyWithMemManager(pergroupstate->transValueIsNull ?
+									(Datum) 0 : pergroupstate->transValue,
+									value,
+									peraggstate->transtypeByVal,
+									peraggstate->transtypeLen,
+									&aggstate->mem_manager);
+		pergroupstate->transValueIsNull = false;
+		pergroupstate->noTransValue = false;
+	}
+}
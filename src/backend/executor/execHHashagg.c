@@ -17,6 +17,10 @@
  */
 #include "postgres.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include "miscadmin.h" /* work_mem */
 #include "executor/executor.h"
 #include "nodes/execnodes.h"
@@ -101,6 +105,22 @@ typedef enum InputRecordType
 
 #define LOG2(x) (ceil(log((x)) / log(2)))
 
+/*
+ * In open addressing mode, the slots are probed by groups of
+ * SLOT_GROUP_SIZE, whose tags are compared all at once. A tag keeps the
+ * high bits of the hash key, with the high bit set so that it is never 0,
+ * the tag of a free slot. The table is expanded, or else considered full,
+ * once MAX_FILLED_SLOTS are in use, so that a probe always meets a free
+ * slot.
+ */
+#define SLOT_GROUP_SIZE 16
+#define SLOT_TAG(hashkey) ((uint8) (0x80 | ((hashkey) >> 25)))
+#define MAX_FILLED_SLOTS(hashtable) \
+		((hashtable)->nbuckets - (hashtable)->nbuckets / 8)
+
+/* Slots needed for each entry to stay under MAX_FILLED_SLOTS */
+#define SLOTS_PER_ENTRY (1 / 0.875)
+
 /* Methods that handle batch files */
 static SpillSet *createSpillSet(unsigned branching_factor, unsigned parent_hash_bit);
 static int closeSpillFile(AggState *aggstate, SpillSet *spill_set, int file_no);
@@ -122,9 +142,15 @@ static void init_agg_hash_iter(HashAggTable* ht);
 static HashAggEntry *lookup_agg_hash_entry(AggState *aggstate, void *input_record,
 										   InputRecordType input_type, int32 input_size,
 										   uint32 hashkey, bool *p_isnew);
+static HashAggEntry *probe_agg_hash_slots(AggState *aggstate, void *input_record,
+										  InputRecordType input_type,
+										  uint32 hashkey, unsigned *p_free);
+static void insert_agg_hash_slot(HashAggTable *hashtable, HashAggEntry *entry);
 static void agg_hash_table_stat_upd(HashAggTable *ht);
 static void reset_agg_hash_table(AggState *aggstate, int64 nentries);
 static bool agg_hash_reload(AggState *aggstate);
+static void agg_hash_check_reduction(AggState *aggstate, uint64 pass_tuples);
+static bool agg_hash_passthrough(AggState *aggstate);
 static void reCalcNumberBatches(HashAggTable *hashtable, SpillFile *spill_file);
 static inline void *mpool_cxt_alloc(void *manager, Size len);
 
@@ -146,8 +172,6 @@ calc_hash_value(AggState* aggstate, TupleTableSlot *inputslot)
 	Agg *agg;
 	ExprContext *econtext;
 	MemoryContext oldContext;
-	int			i;
-	FmgrInfo* info = aggstate->hashfunctions;
 	HashAggTable *hashtable = aggstate->hhashtable;
 	
 	agg = (Agg*)aggstate->ss.ps.plan;
@@ -155,6 +179,26 @@ calc_hash_value(AggState* aggstate, TupleTableSlot *inputslot)
 
 	oldContext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
 
+	call_CalcHashKeys(aggstate, inputslot);
+
+	MemoryContextSwitchTo(oldContext);
+	return (uint32) hash_any((unsigned char *) hashtable->hashkey_buf, agg->numCols * sizeof(HashKey));
+}
+
+/* Function: calc_hash_keys
+ *
+ * Fill the hash key buffer of the hash table with the hash value of each
+ * grouping column of the given input tuple, which calc_hash_value combines.
+ * May be replaced by a generated version (see CalcHashKeysCodegen).
+ */
+void
+calc_hash_keys(AggState* aggstate, TupleTableSlot *inputslot)
+{
+	Agg *agg = (Agg*)aggstate->ss.ps.plan;
+	int			i;
+	FmgrInfo* info = aggstate->hashfunctions;
+	HashAggTable *hashtable = aggstate->hhashtable;
+
 	for (i = 0; i < agg->numCols; i++, info++)
 	{
 		AttrNumber	att = agg->grpColIdx[i];
@@ -169,9 +213,6 @@ calc_hash_value(AggState* aggstate, TupleTableSlot *inputslot)
 		else
 			hashtable->hashkey_buf[i] = 0xdeadbeef;
 	}
-
-	MemoryContextSwitchTo(oldContext);
-	return (uint32) hash_any((unsigned char *) hashtable->hashkey_buf, agg->numCols * sizeof(HashKey));
 }
 
 /* Function: adjustInputGroup
@@ -367,6 +408,178 @@ setGroupAggs(HashAggTable *hashtable, HashAggEntry *entry)
 	}
 }
 
+/*
+ * Function: agg_hash_entry_match
+ *
+ * Returns true if the grouping keys of the given entry are those of the
+ * input record (see lookup_agg_hash_entry).
+ */
+static inline bool
+agg_hash_entry_match(AggState *aggstate, HashAggEntry *entry,
+					 void *input_record, InputRecordType input_type)
+{
+	MemTupleBinding *mt_bind = aggstate->hashslot->tts_mt_bind;
+	Agg *agg = (Agg*)aggstate->ss.ps.plan;
+	MemTuple mtup = (MemTuple) entry->tuple_and_aggs;
+	int i;
+	bool match = true;
+
+	for (i = 0; match && i < agg->numCols; i++)
+	{
+		AttrNumber	att = agg->grpColIdx[i];
+		Datum input_datum = 0;
+		Datum entry_datum = 0;
+		bool input_isNull = false;
+		bool entry_isNull = false;
+
+		switch(input_type)
+		{
+			case INPUT_RECORD_TUPLE:
+				input_datum = slot_getattr((TupleTableSlot *)input_record, att, &input_isNull);
+				break;
+			case INPUT_RECORD_GROUP_AND_AGGS:
+				input_datum = memtuple_getattr((MemTuple)input_record, mt_bind, att, &input_isNull);
+				break;
+			default:
+				insist_log(false, "invalid record type %d", input_type);
+		}
+
+		entry_datum = memtuple_getattr(mtup, mt_bind, att, &entry_isNull);
+
+		if ( !input_isNull && !entry_isNull &&
+			 (DatumGetBool(FunctionCall2(&aggstate->eqfunctions[i],
+										 input_datum,
+										 entry_datum)) ) )
+			continue; /* Both non-NULL and equal. */
+		match = (input_isNull && entry_isNull);/* NULLs match in group keys. */
+	}
+
+	return match;
+}
+
+/*
+ * Function: match_slot_tags
+ *
+ * Returns a bitmask of the slots of the group starting at the given tag
+ * whose tag is the given one.
+ */
+static inline uint32
+match_slot_tags(const uint8 *tags, uint8 tag)
+{
+#ifdef __SSE2__
+	__m128i group = _mm_loadu_si128((const __m128i *) tags);
+
+	return (uint32) _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char) tag)));
+#else
+	uint32 mask = 0;
+	int i;
+
+	for (i = 0; i < SLOT_GROUP_SIZE; i++)
+	{
+		if (tags[i] == tag)
+			mask |= ((uint32) 1) << i;
+	}
+	return mask;
+#endif
+}
+
+/*
+ * Function: lowest_slot
+ *
+ * Returns the position of the lowest bit set in a non-zero bitmask
+ * returned by match_slot_tags.
+ */
+static inline int
+lowest_slot(uint32 mask)
+{
+	Assert(mask != 0);
+#ifdef __GNUC__
+	return __builtin_ctz(mask);
+#else
+	{
+		int i = 0;
+
+		while ((mask & 1) == 0)
+		{
+			mask >>= 1;
+			i++;
+		}
+		return i;
+	}
+#endif
+}
+
+/*
+ * Function: probe_agg_hash_slots
+ *
+ * In open addressing mode, returns the entry for the input record, or
+ * NULL if there is none, setting *p_free to the slot it should go to.
+ *
+ * The slots are probed a group at a time, starting with the group of the
+ * bucket of the hash key and wrapping around, and only the entries whose
+ * tag matches have their keys compared. Entries are never removed one at
+ * a time, so the first group with a free slot ends the search.
+ */
+static HashAggEntry *
+probe_agg_hash_slots(AggState *aggstate, void *input_record,
+					 InputRecordType input_type, uint32 hashkey,
+					 unsigned *p_free)
+{
+	HashAggTable *hashtable = aggstate->hhashtable;
+	uint8 tag = SLOT_TAG(hashkey);
+	unsigned mask = hashtable->nbuckets - 1;
+	unsigned group = BUCKET_IDX(hashtable, hashkey) & ~(SLOT_GROUP_SIZE - 1);
+
+	Assert(hashtable->open_addressing);
+
+	for (;;)
+	{
+		uint32 matches = match_slot_tags(&hashtable->tags[group], tag);
+		uint32 free_slots;
+
+		while (matches != 0)
+		{
+			HashAggEntry *entry = hashtable->buckets[group + lowest_slot(matches)];
+
+			if (entry->hashvalue == hashkey &&
+				agg_hash_entry_match(aggstate, entry, input_record, input_type))
+				return entry;
+
+			matches &= matches - 1;
+		}
+
+		free_slots = match_slot_tags(&hashtable->tags[group], 0);
+		if (free_slots != 0)
+		{
+			*p_free = group + lowest_slot(free_slots);
+			return NULL;
+		}
+
+		group = (group + SLOT_GROUP_SIZE) & mask;
+	}
+}
+
+/*
+ * Function: insert_agg_hash_slot
+ *
+ * In open addressing mode, put an entry that is not in the hash table yet
+ * in the first free slot of its probe sequence.
+ */
+static void
+insert_agg_hash_slot(HashAggTable *hashtable, HashAggEntry *entry)
+{
+	unsigned mask = hashtable->nbuckets - 1;
+	unsigned group = BUCKET_IDX(hashtable, entry->hashvalue) & ~(SLOT_GROUP_SIZE - 1);
+	uint32 free_slots;
+
+	while ((free_slots = match_slot_tags(&hashtable->tags[group], 0)) == 0)
+		group = (group + SLOT_GROUP_SIZE) & mask;
+
+	group += lowest_slot(free_slots);
+	hashtable->buckets[group] = entry;
+	hashtable->tags[group] = SLOT_TAG(entry->hashvalue);
+}
+
 /*
  * Function: lookup_agg_hash_entry
  *
@@ -392,14 +605,13 @@ lookup_agg_hash_entry(AggState *aggstate,
 {
 	HashAggEntry *entry;
 	HashAggTable *hashtable = aggstate->hhashtable;
-	MemTupleBinding *mt_bind = aggstate->hashslot->tts_mt_bind;
 	ExprContext *tmpcontext = aggstate->tmpcontext; /* per input tuple context */
-	Agg *agg = (Agg*)aggstate->ss.ps.plan;
 	MemoryContext oldcxt;
 	unsigned int bucket_idx;
 	uint64 bloomval;			/* bloom filter value */
+	unsigned free_slot = 0;
    
-	Assert(mt_bind != NULL);
+	Assert(aggstate->hashslot->tts_mt_bind != NULL);
 
 	if (p_isnew != NULL)
 		*p_isnew = false;
@@ -408,62 +620,53 @@ lookup_agg_hash_entry(AggState *aggstate,
 
 	bucket_idx = BUCKET_IDX(hashtable, hashkey);
 	bloomval = BLOOMVAL(hashkey);
-	entry = (0 == (hashtable->bloom[bucket_idx] & bloomval) ? NULL :
-			 hashtable->buckets[bucket_idx]);
 
-	/*
-	 * Search entry chain for the bucket. If such an entry found in the
-	 * chain, move it to the front of the chain. Otherwise, if there
-	 * are any space left, create a new entry, and insert it in
-	 * the front of the chain.
-	 */
-	while (entry != NULL)
+	if (hashtable->open_addressing)
 	{
-		MemTuple mtup = (MemTuple) entry->tuple_and_aggs;
-		int i;
-		bool match = true;
+		entry = probe_agg_hash_slots(aggstate, input_record, input_type,
+									 hashkey, &free_slot);
 
-		if (hashkey != entry->hashvalue)
-		{
-			entry = entry->next;
-			continue;
-		}
-		
-		for (i = 0; match && i < agg->numCols; i++)
+		/*
+		 * A new entry needs a free slot, which the table must keep to end
+		 * the probes. Without one, it is as full as if it ran out of memory.
+		 */
+		if (entry == NULL &&
+			hashtable->num_entries >= MAX_FILLED_SLOTS(hashtable))
 		{
-			AttrNumber	att = agg->grpColIdx[i];
-			Datum input_datum = 0;
-			Datum entry_datum = 0;
-			bool input_isNull = false;
-			bool entry_isNull = false;
-				
-			switch(input_type)
+			if (hashtable->expandable)
+				expand_hash_table(aggstate);
+
+			if (hashtable->num_entries >= MAX_FILLED_SLOTS(hashtable))
 			{
-				case INPUT_RECORD_TUPLE:
-					input_datum = slot_getattr((TupleTableSlot *)input_record, att, &input_isNull);
-					break;
-				case INPUT_RECORD_GROUP_AND_AGGS:
-					input_datum = memtuple_getattr((MemTuple)input_record, mt_bind, att, &input_isNull);
-					break;
-				default:
-					insist_log(false, "invalid record type %d", input_type);
+				(void) MemoryContextSwitchTo(oldcxt);
+				return NULL;
 			}
 
-			entry_datum = memtuple_getattr(mtup, mt_bind, att, &entry_isNull);
-
-			if ( !input_isNull && !entry_isNull &&
-				 (DatumGetBool(FunctionCall2(&aggstate->eqfunctions[i],
-											 input_datum,
-											 entry_datum)) ) )
-				continue; /* Both non-NULL and equal. */
-			match = (input_isNull && entry_isNull);/* NULLs match in group keys. */
+			/* The slots moved; find the new free one */
+			(void) probe_agg_hash_slots(aggstate, input_record, input_type,
+										hashkey, &free_slot);
 		}
-		
-		/* Break if found an existing matching entry. */
-		if (match)
-			break;
+	}
+	else
+	{
+		entry = (0 == (hashtable->bloom[bucket_idx] & bloomval) ? NULL :
+				 hashtable->buckets[bucket_idx]);
+
+		/*
+		 * Search entry chain for the bucket. If such an entry found in the
+		 * chain, move it to the front of the chain. Otherwise, if there
+		 * are any space left, create a new entry, and insert it in
+		 * the front of the chain.
+		 */
+		while (entry != NULL)
+		{
+			/* Break if found an existing matching entry. */
+			if (hashkey == entry->hashvalue &&
+				agg_hash_entry_match(aggstate, entry, input_record, input_type))
+				break;
 
-		entry = entry->next;
+			entry = entry->next;
+		}
 	}
 
 	if (entry == NULL)
@@ -481,7 +684,17 @@ lookup_agg_hash_entry(AggState *aggstate,
 				insist_log(false, "invalid record type %d", input_type);
 		}
 			
-		if (entry != NULL)
+		if (entry != NULL && hashtable->open_addressing)
+		{
+			hashtable->buckets[free_slot] = entry;
+			hashtable->tags[free_slot] = SLOT_TAG(hashkey);
+
+			++hashtable->num_ht_groups;
+			++hashtable->num_entries;
+
+			*p_isnew = true; /* created a new entry */
+		}
+		else if (entry != NULL)
 		{
 			if (hashtable->expandable &&
 					hashtable->num_entries >= (hashtable->nbuckets * gp_hashagg_groups_per_bucket))
@@ -547,8 +760,14 @@ calcHashAggTableSizes(double memquota,	/* Memory quota in bytes. */
 
 	Assert(ngroups >= 0);
 
-	/* Estimate the overhead per entry in the hash table */
-	entrysize = entrywidth + OVERHEAD_PER_BUCKET / (double) gp_hashagg_groups_per_bucket;
+	/*
+	 * Estimate the overhead per entry in the hash table. In open addressing
+	 * mode, every entry takes a slot of its own, and some are left free.
+	 */
+	if (gp_enable_hashagg_open_addressing)
+		entrysize = entrywidth + OVERHEAD_PER_BUCKET * SLOTS_PER_ENTRY;
+	else
+		entrysize = entrywidth + OVERHEAD_PER_BUCKET / (double) gp_hashagg_groups_per_bucket;
 
 	elog(HHA_MSG_LVL, "HashAgg: ngroups = %g, memquota = %g, entrysize = %g",
 		 ngroups, memquota, entrysize);
@@ -601,8 +820,11 @@ calcHashAggTableSizes(double memquota,	/* Memory quota in bytes. */
 
 	memquota -= entries_mem;
 
-	/* Determine the number of buckets */
-	nbuckets = ceil(nentries / gp_hashagg_groups_per_bucket);
+	/* Determine the number of buckets, or slots in open addressing mode */
+	if (gp_enable_hashagg_open_addressing)
+		nbuckets = ceil(nentries * SLOTS_PER_ENTRY);
+	else
+		nbuckets = ceil(nentries / gp_hashagg_groups_per_bucket);
 
 	/* Use only as many allowed by memory */
 	nbuckets = Min(nbuckets, floor(memquota / OVERHEAD_PER_BUCKET));
@@ -769,8 +991,16 @@ create_agg_hash_table(AggState *aggstate)
 
 	/* Initialize the hash buckets */
 	hashtable->nbuckets = hashtable->hats.nbuckets;
+	hashtable->open_addressing = gp_enable_hashagg_open_addressing;
+	if (hashtable->open_addressing)
+	{
+		/* Probes read whole groups of slots */
+		hashtable->nbuckets = Max(hashtable->nbuckets, SLOT_GROUP_SIZE);
+		hashtable->tags = (uint8 *) palloc0(hashtable->nbuckets * sizeof(uint8));
+	}
+	else
+		hashtable->bloom = (uint64 *) palloc0(hashtable->nbuckets * sizeof(uint64));
 	hashtable->buckets = (HashAggBucket *) palloc0(hashtable->nbuckets * sizeof(HashAggBucket));
-	hashtable->bloom = (uint64 *) palloc0(hashtable->nbuckets * sizeof(uint64));
 
 	hashtable->pshift = 0;
 	hashtable->expandable = true;
@@ -830,6 +1060,7 @@ agg_hash_initial_pass(AggState *aggstate)
 	TupleTableSlot *outerslot = NULL;
 	bool streaming = ((Agg *) aggstate->ss.ps.plan)->streaming;
 	bool tuple_remaining = true;
+	uint64 pass_start_tuples = hashtable->num_tuples;
 
 	Assert(hashtable);
 	AssertImply(!streaming, aggstate->hashaggstatus == HASHAGG_BEFORE_FIRST_PASS);
@@ -911,6 +1142,8 @@ agg_hash_initial_pass(AggState *aggstate)
 			{
 				Assert(tuple_remaining);
 				hashtable->prev_slot = outerslot;
+				agg_hash_check_reduction(aggstate,
+										 hashtable->num_tuples - pass_start_tuples);
 				/* Stream existing entries instead of spilling */
 				break;
 			}
@@ -950,6 +1183,8 @@ agg_hash_initial_pass(AggState *aggstate)
 		{
 			Assert(tuple_remaining);
 			ExecClearTuple(aggstate->hashslot);
+			agg_hash_check_reduction(aggstate,
+									 hashtable->num_tuples - pass_start_tuples);
 			/* Pause and stream entries before reading the next tuple */
 			break;
 		}
@@ -1317,6 +1552,10 @@ spill_hash_table(AggState *aggstate)
 			CheckSendPlanStateGpmonPkt(&aggstate->ss.ps);
 		}
 
+		/* In open addressing mode, the entries are all written below */
+		if (hashtable->open_addressing)
+			continue;
+
 		for (bucket_no = file_no; bucket_no < hashtable->nbuckets;
 			 bucket_no += spill_set->num_spill_files)
 		{
@@ -1348,6 +1587,35 @@ spill_hash_table(AggState *aggstate)
 		}
 	}
 
+	/*
+	 * In open addressing mode, an entry may not be in the slot of its bucket;
+	 * write it to the spill file of its bucket, as in chained mode.
+	 */
+	if (hashtable->open_addressing)
+	{
+		for (bucket_no = 0; bucket_no < hashtable->nbuckets; bucket_no++)
+		{
+			HashAggEntry *spill_entry = hashtable->buckets[bucket_no];
+			int32 written_bytes;
+
+			if (spill_entry == NULL)
+				continue;
+
+			file_no = BUCKET_IDX(hashtable, spill_entry->hashvalue) &
+				(spill_set->num_spill_files - 1);
+			spill_file = &spill_set->spill_files[file_no];
+
+			written_bytes = writeHashEntry(aggstate, spill_file->file_info, spill_entry);
+			spill_file->file_info->ntuples++;
+			spill_file->file_info->total_bytes += written_bytes;
+
+			hashtable->num_spill_groups++;
+		}
+
+		MemSet(hashtable->buckets, 0, hashtable->nbuckets * sizeof(HashAggBucket));
+		MemSet(hashtable->tags, 0, hashtable->nbuckets * sizeof(uint8));
+	}
+
 	/* Reset the buffer */
 	mpool_reset(hashtable->group_buf);
 
@@ -1400,6 +1668,38 @@ expand_hash_table(AggState *aggstate)
 
 	Assert(GET_TOTAL_USED_SIZE(hashtable) < hashtable->max_mem);
 
+	if (hashtable->open_addressing)
+	{
+		HashAggBucket *old_slots = hashtable->buckets;
+		uint8 *old_tags = hashtable->tags;
+
+		/* Allocate the new slots next to the old ones, then move the entries */
+		hashtable->buckets = (HashAggBucket *)
+			MemoryContextAllocZero(aggstate->aggcontext,
+								   hashtable->nbuckets * sizeof(HashAggBucket));
+		hashtable->tags = (uint8 *)
+			MemoryContextAllocZero(aggstate->aggcontext,
+								   hashtable->nbuckets * sizeof(uint8));
+
+		for (bucket_idx = 0; bucket_idx < old_nbuckets; ++bucket_idx)
+		{
+			if (old_tags[bucket_idx] == 0)
+				continue;
+
+			insert_agg_hash_slot(hashtable, old_slots[bucket_idx]);
+#ifdef USE_ASSERT_CHECKING
+			++nentries;
+#endif
+		}
+
+		pfree(old_slots);
+		pfree(old_tags);
+
+		hashtable->num_expansions++;
+		Assert(nentries == hashtable->num_entries);
+		return;
+	}
+
 	hashtable->buckets = (HashAggBucket *) repalloc(hashtable->buckets,
 		hashtable->nbuckets * sizeof(HashAggBucket));
 	hashtable->bloom =  (uint64 *) repalloc(hashtable->bloom,
@@ -1673,11 +1973,127 @@ agg_hash_stream(AggState *aggstate)
 	elog(HHA_MSG_LVL,
 		"HashAgg: streaming");
 
-	reset_agg_hash_table(aggstate, 0 /* don't reallocate buckets */);
-	
+	/* In pass-through mode, the table stays empty once it is reset */
+	if (!aggstate->hhashtable->passthrough ||
+		aggstate->hhashtable->num_entries > 0)
+		reset_agg_hash_table(aggstate, 0 /* don't reallocate buckets */);
+
+	if (aggstate->hhashtable->passthrough)
+		return agg_hash_passthrough(aggstate);
+
 	return agg_hash_initial_pass(aggstate);
 }
 
+/*
+ * Function: agg_hash_check_reduction
+ *
+ * Called when the hash table of a streaming lower phase is full, after
+ * pass_tuples input tuples went into it. If they were reduced to too
+ * many groups (see gp_hashagg_streambottom_min_reduction), aggregating
+ * them only costs hashing and memory, and the upper phase does the real
+ * work anyway; switch to pass-through mode, where each of the remaining
+ * input tuples is streamed as a group of its own.
+ */
+static void
+agg_hash_check_reduction(AggState *aggstate, uint64 pass_tuples)
+{
+	HashAggTable *hashtable = aggstate->hhashtable;
+
+	Assert(((Agg *) aggstate->ss.ps.plan)->streaming);
+
+	if (gp_hashagg_streambottom_min_reduction <= 0 ||
+		hashtable->passthrough ||
+		hashtable->num_ht_groups == 0)
+		return;
+
+	if ((double) pass_tuples <
+		gp_hashagg_streambottom_min_reduction * hashtable->num_ht_groups)
+	{
+		elog(HHA_MSG_LVL,
+			 "HashAgg: " UINT64_FORMAT " tuples made " UINT64_FORMAT
+			 " groups; streaming the rest without aggregating",
+			 pass_tuples, hashtable->num_ht_groups);
+		hashtable->passthrough = true;
+	}
+}
+
+/*
+ * Function: agg_hash_passthrough
+ *
+ * Read the next input tuple and make it a group of its own, which the
+ * hash table iterator returns next. The group is not put in the hash
+ * table, and its space in the group buffer is reused once the buffer is
+ * full.
+ *
+ * Return false when all input tuples have been consumed, else true.
+ */
+static bool
+agg_hash_passthrough(AggState *aggstate)
+{
+	HashAggTable *hashtable = aggstate->hhashtable;
+	ExprContext *tmpcontext = aggstate->tmpcontext; /* per input tuple context */
+	TupleTableSlot *outerslot;
+	HashAggEntry *entry;
+	MemoryContext oldcxt;
+	int tup_len;
+
+	Assert(hashtable->passthrough && hashtable->num_entries == 0);
+
+	if (hashtable->prev_slot != NULL)
+	{
+		outerslot = hashtable->prev_slot;
+		hashtable->prev_slot = NULL;
+	}
+	else
+		outerslot = ExecProcNode(outerPlanState(aggstate));
+
+	if (TupIsNull(outerslot))
+		return false;
+
+	Gpmon_Incr_Rows_In(GpmonPktFromAggState(aggstate));
+
+	tmpcontext->ecxt_outertuple = outerslot;
+
+	/*
+	 * The group returned by the previous call has been consumed, so the
+	 * group buffer can be emptied when it has no space left.
+	 */
+	oldcxt = CurrentMemoryContext;
+	entry = makeHashAggEntryForInput(aggstate, outerslot, 0 /* unused */);
+	if (entry == NULL)
+	{
+		MemoryContextSwitchTo(oldcxt);
+		mpool_reset(hashtable->group_buf);
+		entry = makeHashAggEntryForInput(aggstate, outerslot, 0 /* unused */);
+		if (entry == NULL)
+			ereport(ERROR,
+					(errcode(ERRCODE_GP_INTERNAL_ERROR),
+					 ERRMSG_GP_INSUFFICIENT_STATEMENT_MEMORY));
+	}
+	MemoryContextSwitchTo(oldcxt);
+
+	setGroupAggs(hashtable, entry);
+
+	tup_len = memtuple_get_size((MemTuple)entry->tuple_and_aggs);
+	MemSet((char *)entry->tuple_and_aggs + MAXALIGN(tup_len), 0,
+		   aggstate->numaggs * sizeof(AggStatePerGroupData));
+	initialize_aggregates(aggstate, aggstate->peragg, hashtable->groupaggs->aggs,
+						  &(aggstate->mem_manager));
+	call_AdvanceAggregates(aggstate, hashtable->groupaggs->aggs, &(aggstate->mem_manager));
+
+	hashtable->num_tuples++;
+	hashtable->num_passthrough_tuples++;
+
+	/* Reset per-input-tuple context after each tuple */
+	ResetExprContext(tmpcontext);
+
+	/* Make the group the only one left to iterate over */
+	hashtable->curr_bucket_idx = hashtable->nbuckets;
+	hashtable->next_entry = entry;
+
+	return true;
+}
+
 /*
  * Function: agg_hash_load
  *
@@ -2093,6 +2509,13 @@ agg_hash_explain(AggState *aggstate)
 		appendStringInfo(hbuf, ".\n");
 	}
 
+	if (hashtable->num_passthrough_tuples > 0)
+	{
+		appendStringInfo(hbuf,
+				"Poor reduction; streamed " UINT64_FORMAT " rows without aggregating.\n",
+				hashtable->num_passthrough_tuples);
+	}
+
 	/* Hash chain statistics */
 	if (hashtable->chainlength.vcnt > 0)
 	{
@@ -2131,7 +2554,7 @@ void reset_agg_hash_table(AggState *aggstate, int64 nentries)
 		"HashAgg: resetting " INT64_FORMAT "-entry hash table",
 		hashtable->num_ht_groups);
 
-	Assert(hashtable->buckets && hashtable->bloom);
+	Assert(hashtable->buckets && (hashtable->bloom || hashtable->tags));
 
 	/*
 	 * Determine whether to reallocate buckets. Especially avoid re-allocation if
@@ -2142,7 +2565,10 @@ void reset_agg_hash_table(AggState *aggstate, int64 nentries)
 			nentries,
 			hashtable->hats.hashentry_width,
 			true,
-			&hats) &&
+			&hats);
+	if (reallocate_buckets && hashtable->open_addressing)
+		hats.nbuckets = Max(hats.nbuckets, SLOT_GROUP_SIZE);
+	reallocate_buckets = reallocate_buckets &&
 		(hats.nbuckets != hashtable->nbuckets);
 
 	if (reallocate_buckets)
@@ -2163,10 +2589,18 @@ void reset_agg_hash_table(AggState *aggstate, int64 nentries)
 		hashtable->hats.nentries = hats.nentries;
 
 		pfree(hashtable->buckets);
-		pfree(hashtable->bloom);
-
 		hashtable->buckets = (HashAggBucket *) palloc0(hashtable->nbuckets * sizeof(HashAggBucket));
-		hashtable->bloom = (uint64 *) palloc0(hashtable->nbuckets * sizeof(uint64));
+
+		if (hashtable->open_addressing)
+		{
+			pfree(hashtable->tags);
+			hashtable->tags = (uint8 *) palloc0(hashtable->nbuckets * sizeof(uint8));
+		}
+		else
+		{
+			pfree(hashtable->bloom);
+			hashtable->bloom = (uint64 *) palloc0(hashtable->nbuckets * sizeof(uint64));
+		}
 
 		hashtable->expandable = true;
 
@@ -2180,7 +2614,10 @@ void reset_agg_hash_table(AggState *aggstate, int64 nentries)
 	{
 		/* No need to reallocated buckets. Reset to zero. */
 		MemSet(hashtable->buckets, 0, hashtable->nbuckets * sizeof(HashAggBucket));
-		MemSet(hashtable->bloom, 0, hashtable->nbuckets * sizeof(uint64));
+		if (hashtable->open_addressing)
+			MemSet(hashtable->tags, 0, hashtable->nbuckets * sizeof(uint8));
+		else
+			MemSet(hashtable->bloom, 0, hashtable->nbuckets * sizeof(uint64));
 	}
 
 	Assert(hashtable->mem_for_metadata > 0);
@@ -2218,7 +2655,10 @@ void destroy_agg_hash_table(AggState *aggstate)
 
 		/* destroy_batches(aggstate->hhashtable); */
 		pfree(aggstate->hhashtable->buckets);
-		pfree(aggstate->hhashtable->bloom);
+		if (aggstate->hhashtable->open_addressing)
+			pfree(aggstate->hhashtable->tags);
+		else
+			pfree(aggstate->hhashtable->bloom);
 		if (aggstate->hhashtable->hashkey_buf)
 			pfree(aggstate->hhashtable->hashkey_buf);
 
@@ -82,6 +82,7 @@
 #include "executor/executor.h"
 #include "executor/instrument.h"
 #include "executor/nodeAgg.h"
+#include "executor/execHHashagg.h"
 #include "executor/nodeAppend.h"
 #include "executor/nodeBitmapAnd.h"
 #include "executor/nodeBitmapHeapscan.h"
@@ -130,6 +131,7 @@
 #include "pg_trace.h"
 #include "tcop/tcopprot.h"
 #include "utils/debugbreak.h"
+#include "utils/tuplesort_mk_details.h"
 
 #include "codegen/codegen_wrapper.h"
 
@@ -166,6 +168,11 @@ static void
 static void
 			EnrollProjInfoTargetList(PlanState *result, ProjectionInfo *ProjInfo);
 
+#ifdef USE_CODEGEN
+static double
+			CodegenEstimatedRows(Plan *node);
+#endif
+
 /*
  * setSubplanSliceId
  *	 Set the slice id info for the given subplan.
@@ -374,7 +381,9 @@ ExecInitNode(Plan *node, EState *estate, int eflags)
 				ScanState *scanState = (ScanState *) result;
 				ProjectionInfo *projInfo = result->ps_ProjInfo;
 				if (NULL != scanState &&
-				    scanState->tableType == TableTypeHeap &&
+				    (scanState->tableType == TableTypeHeap ||
+				     scanState->tableType == TableTypeAppendOnly ||
+				     scanState->tableType == TableTypeAOCS) &&
 				    NULL != projInfo &&
 				    projInfo->pi_isVarList &&
 				    NULL != projInfo->pi_targetlist)
@@ -582,6 +591,19 @@ ExecInitNode(Plan *node, EState *estate, int eflags)
 			{
 			result = (PlanState *) ExecInitHashJoin((HashJoin *) node,
 													estate, eflags);
+			if (NULL != result)
+			{
+				/*
+				 * Enroll the hash key computation of the outer tuples, and of
+				 * the inner tuples in the Hash node below us.
+				 */
+				enroll_ExecHashGetHashKeys_codegen(ExecHashGetHashKeys,
+						&((HashState *) innerPlanState(result))->ExecHashGetOuterHashKeys_gen_info,
+						(HashJoinState *) result, true);
+				enroll_ExecHashGetHashKeys_codegen(ExecHashGetHashKeys,
+						&((HashState *) innerPlanState(result))->ExecHashGetInnerHashKeys_gen_info,
+						(HashJoinState *) result, false);
+			}
 			}
 			END_MEMORY_ACCOUNT();
 			break;
@@ -620,6 +642,13 @@ ExecInitNode(Plan *node, EState *estate, int eflags)
 			{
 			result = (PlanState *) ExecInitSort((Sort *) node,
 												estate, eflags);
+			if (NULL != result && gp_enable_mk_sort)
+			{
+				enroll_MKCompare_codegen(tupsort_compare_datum,
+						&((SortState *) result)->MKCompare_gen_info,
+						((Sort *) node)->numCols,
+						((Sort *) node)->sortOperators);
+			}
 			}
 			END_MEMORY_ACCOUNT();
 			break;
@@ -646,7 +675,14 @@ ExecInitNode(Plan *node, EState *estate, int eflags)
 			  }
 			  enroll_AdvanceAggregates_codegen(advance_aggregates,
 			        &aggstate->AdvanceAggregates_gen_info.AdvanceAggregates_fn,
-			        aggstate);			}
+			        aggstate);
+			  if (((Agg *) node)->aggstrategy == AGG_HASHED)
+			  {
+			    enroll_CalcHashKeys_codegen(calc_hash_keys,
+			          &aggstate->CalcHashKeys_gen_info.CalcHashKeys_fn,
+			          aggstate);
+			  }
+			}
 			}
 			END_MEMORY_ACCOUNT();
 			break;
@@ -713,6 +749,23 @@ ExecInitNode(Plan *node, EState *estate, int eflags)
 			{
 			result = (PlanState *) ExecInitMotion((Motion *) node,
 												  estate, eflags);
+			if (NULL != result &&
+				((MotionState *) result)->mstype == MOTIONSTATE_SEND &&
+				((Motion *) node)->motionType == MOTIONTYPE_HASH)
+			{
+				enroll_HashMotionKeys_codegen(hashMotionKeys,
+						&((MotionState *) result)->HashMotionKeys_gen_info.HashMotionKeys_fn,
+						(MotionState *) result);
+			}
+			if (NULL != result &&
+				((MotionState *) result)->mstype == MOTIONSTATE_RECV &&
+				((Motion *) node)->sendSorted && gp_enable_motion_mk_sort)
+			{
+				enroll_MKCompare_codegen(tupsort_compare_datum,
+						&((MotionState *) result)->MKCompare_gen_info,
+						((Motion *) node)->numSortCols,
+						((Motion *) node)->sortOperators);
+			}
 			}
 			END_MEMORY_ACCOUNT();
 			break;
@@ -833,6 +886,8 @@ ExecInitNode(Plan *node, EState *estate, int eflags)
 				isExplainAnalyzeCodegenOnMaster ||
 				isExplainCodegenOnMaster)
 		{
+			CodeGeneratorManagerSetEstimatedRows(CodegenManager,
+												 CodegenEstimatedRows(node));
 			(void) CodeGeneratorManagerGenerateCode(CodegenManager);
 			if (isExplainAnalyzeCodegenOnMaster ||
 					isExplainCodegenOnMaster)
@@ -851,6 +906,29 @@ ExecInitNode(Plan *node, EState *estate, int eflags)
 	return result;
 }
 
+/* ----------------------------------------------------------------
+ *	  CodegenEstimatedRows
+ *
+ *	  Estimate the number of rows the generated code of a node will
+ *	  process. Quals and aggregates run once per input row, so the
+ *	  estimates of the children count as well.
+ * ----------------------------------------------------------------
+ */
+#ifdef USE_CODEGEN
+static double
+CodegenEstimatedRows(Plan *node)
+{
+	double		rows = node->plan_rows;
+
+	if (NULL != node->lefttree)
+		rows = Max(rows, node->lefttree->plan_rows);
+	if (NULL != node->righttree)
+		rows = Max(rows, node->righttree->plan_rows);
+
+	return rows;
+}
+#endif
+
 /* ----------------------------------------------------------------
  *	  EnrollQualList
  *
@@ -17,6 +17,7 @@
 #include "codegen/codegen_wrapper.h"
 
 #include "executor/executor.h"
+#include "executor/nodeHash.h"
 #include "miscadmin.h"
 #include "utils/memutils.h"
 #include "utils/debugbreak.h"
@@ -95,10 +96,11 @@ ExecScan(ScanState *node,
 	projInfo = node->ps.ps_ProjInfo;
 
 	/*
-	 * If we have neither a qual to check nor a projection to do, just skip
-	 * all the overhead and return the raw scan tuple.
+	 * If we have neither a qual to check nor a projection to do, nor a
+	 * runtime filter, just skip all the overhead and return the raw scan
+	 * tuple.
 	 */
-	if (!qual && !projInfo)
+	if (!qual && !projInfo && !node->runtimeFilter)
 		return (*accessMtd) (node);
 
 	/*
@@ -151,6 +153,8 @@ ExecScan(ScanState *node,
 		 */
 		if (!qual || ExecQual(qual, econtext, false))
 		{
+			TupleTableSlot *result;
+
 			/*
 			 * Found a satisfactory scan tuple.
 			 */
@@ -160,15 +164,23 @@ ExecScan(ScanState *node,
 				 * Form a projection tuple, store it in the result tuple slot
 				 * and return it.
 				 */
-				return ExecProject(projInfo, NULL);
+				result = ExecProject(projInfo, NULL);
 			}
 			else
 			{
 				/*
 				 * Here, we aren't projecting, so just return scan tuple.
 				 */
-				return slot;
+				result = slot;
 			}
+
+			/*
+			 * The runtime filter of a hash join above is evaluated on the
+			 * tuple the join sees.
+			 */
+			if (!node->runtimeFilter ||
+				ExecRuntimeFilterPass(node->runtimeFilter, result))
+				return result;
 		}
 
 		/*
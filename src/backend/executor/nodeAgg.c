@@ -86,8 +86,10 @@
 #include "catalog/pg_proc.h"
 #include "catalog/pg_type.h"
 #include "executor/executor.h"
+#include "executor/execBatch.h"
 #include "executor/execHHashagg.h"
 #include "executor/nodeAgg.h"
+#include "executor/nodeTableScan.h"
 #include "lib/stringinfo.h"             /* StringInfo */
 #include "miscadmin.h"
 #include "nodes/makefuncs.h"
@@ -153,6 +155,7 @@ static Bitmapset *find_unaggregated_cols(AggState *aggstate);
 static bool find_unaggregated_cols_walker(Node *node, Bitmapset **colnos);
 static void clear_agg_object(AggState *aggstate);
 static TupleTableSlot *agg_retrieve_direct(AggState *aggstate);
+static TupleTableSlot *agg_retrieve_batch(AggState *aggstate);
 static TupleTableSlot *agg_retrieve_hash_table(AggState *aggstate);
 static void ExecAggExplainEnd(PlanState *planstate, struct StringInfoData *buf);
 static int count_extra_agg_slots(Node *node);
@@ -1080,6 +1083,8 @@ ExecAgg(AggState *node)
 			}
 		}
 	}
+	else if (node->batchAgg != NULL)
+		return agg_retrieve_batch(node);
 	else
 		return agg_retrieve_direct(node);
 }
@@ -1555,6 +1560,75 @@ agg_retrieve_direct(AggState *aggstate)
 	return NULL;
 }
 
+/*
+ * ExecAgg for a plain Agg whose input is read a batch at a time.
+ *
+ * The outer plan is a batch mode table scan, and the aggregates are advanced
+ * over each of its batches by ExecBatchAdvanceAggregates(), see
+ * ExecInitBatchAgg(). Produces the single result row of agg_retrieve_direct().
+ */
+static TupleTableSlot *
+agg_retrieve_batch(AggState *aggstate)
+{
+	Agg		   *node = (Agg *) aggstate->ss.ps.plan;
+	TableScanState *outerPlan;
+	ExprContext *econtext;
+	AggStatePerAgg peragg;
+	AggStatePerGroup pergroup;
+	AOCSBatch	batch;
+	int			aggno;
+
+	Assert(node->aggstrategy == AGG_PLAIN);
+
+	outerPlan = (TableScanState *) outerPlanState(aggstate);
+	econtext = aggstate->ss.ps.ps_ExprContext;
+	peragg = aggstate->peragg;
+	pergroup = aggstate->pergroup;
+
+	if (aggstate->agg_done)
+		return NULL;
+
+	ResetExprContext(econtext);
+	MemoryContextResetAndDeleteChildren(aggstate->aggcontext);
+	clear_agg_object(aggstate);
+	initialize_aggregates(aggstate, peragg, pergroup, &(aggstate->mem_manager));
+
+	ExecResetBatchAgg(aggstate->batchAgg);
+	while ((batch = ExecTableScanBatch(outerPlan)) != NULL)
+	{
+		CHECK_FOR_INTERRUPTS();
+
+		ExecBatchAdvanceAggregates(aggstate->batchAgg, batch);
+
+		GpmonPktFromAggState(aggstate)->u.qexec.rowsin += batch->nsel;
+		CheckSendPlanStateGpmonPkt(&aggstate->ss.ps);
+	}
+	aggstate->agg_done = true;
+
+	ExecBatchAggEnd(aggstate->batchAgg, aggstate, pergroup);
+
+	for (aggno = 0; aggno < aggstate->numaggs; aggno++)
+		finalize_aggregate(aggstate, &peragg[aggno], &pergroup[aggno],
+						   &econtext->ecxt_aggvalues[aggno],
+						   &econtext->ecxt_aggnulls[aggno]);
+
+	/* There are no non-aggregated input columns, see agg_retrieve_direct() */
+	econtext->ecxt_outertuple = aggstate->ss.ss_ScanTupleSlot;
+	econtext->group_id = node->rollupGSTimes;
+	econtext->grouping = node->grouping;
+
+	/* Check the qual (HAVING clause) */
+	if (ExecQual(aggstate->ss.ps.qual, econtext, false))
+	{
+		Gpmon_Incr_Rows_Out(GpmonPktFromAggState(aggstate));
+		CheckSendPlanStateGpmonPkt(&aggstate->ss.ps);
+
+		return ExecProject(aggstate->ss.ps.ps_ProjInfo, NULL);
+	}
+
+	return NULL;
+}
+
 /*
  * ExecAgg for hashed case: retrieve groups from hash table
  */
@@ -2414,6 +2488,10 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 	aggstate->mem_manager.manager = aggstate->aggcontext;
 	aggstate->mem_manager.realloc_ratio = 1;
 
+	/* Advance the aggregates a batch at a time, if the input allows it */
+	if (gp_enable_batch_execution)
+		aggstate->batchAgg = ExecInitBatchAgg(aggstate);
+
 	initGpmonPktForAgg((Plan *) node, &aggstate->ss.ps.gpmon_pkt, estate);
 
 	return aggstate;
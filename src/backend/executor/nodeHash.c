@@ -52,6 +52,16 @@ ExecHashTableExplainBatches(HashJoinTable   hashtable,
                             int             ibatch_end,
                             const char     *title);
 static void ExecHashTableReallocBatchData(HashJoinTable hashtable, int new_nbatch);
+static void ExecHashRadixAppend(HashJoinTable hashtable, uint32 hashvalue,
+					HashJoinTuple hashTuple);
+static void ExecHashRadixToChains(HashJoinTable hashtable);
+static void ExecHashRadixDumpOtherBatches(HashJoinTable hashtable, long *ninmemory,
+							  long *nfreed, Size *spaceFreed);
+static void ExecHashBuildSkewHash(HashJoinTable hashtable, Hash *node, int tupwidth);
+static void ExecHashSkewTableInsert(HashState *hashState, HashJoinTable hashtable,
+						TupleTableSlot *slot, uint32 hashvalue,
+						int bucketNumber);
+static void ExecHashRemoveNextSkewBucket(HashJoinTable hashtable);
 
 void ExecChooseHashTableSize(double ntuples, int tupwidth,
 						int *numbuckets,
@@ -61,6 +71,69 @@ void ExecChooseHashTableSize(double ntuples, int tupwidth,
 
 #define BLOOMVAL(hk)  (((uint64)1) << (((hk) >> 13) & 0x3f))
 
+/*
+ * Runtime filter sizing: bits per estimated inner row, bounds of the
+ * number of bits, and the fewest bits per actual inner row for the filter
+ * to be worth using. Each hash value sets RUNTIME_FILTER_NHASHES bits.
+ */
+#define RUNTIME_FILTER_BITS_PER_ROW		16
+#define RUNTIME_FILTER_MIN_BITS			(1 << 16)
+#define RUNTIME_FILTER_MAX_BITS			(1 << 26)
+#define RUNTIME_FILTER_MIN_BITS_PER_ROW	8
+#define RUNTIME_FILTER_NHASHES			3
+
+/* Largest share of the memory of the operator the runtime filter may take */
+#define RUNTIME_FILTER_SPACE_PERCENT	10
+
+/*
+ * After this many rows, the runtime filter stops being checked if it has
+ * removed less than 1 in RUNTIME_FILTER_MIN_REMOVED of them.
+ */
+#define RUNTIME_FILTER_SAMPLE_ROWS		4096
+#define RUNTIME_FILTER_MIN_REMOVED		16
+
+/*
+ * The bits of a hash value in the runtime filter, by double hashing. The
+ * second hash is odd, so that the bits differ.
+ */
+#define RUNTIME_FILTER_HASH2(hv) \
+	((((hv) >> 16) | ((hv) << 16)) * 0x9E3779B1U | 1)
+
+static inline void
+RuntimeFilterAdd(HashJoinTable hashtable, uint32 hashvalue)
+{
+	uint32		h = hashvalue;
+	uint32		h2 = RUNTIME_FILTER_HASH2(hashvalue);
+	int			i;
+
+	for (i = 0; i < RUNTIME_FILTER_NHASHES; i++)
+	{
+		uint32		bit = h & hashtable->runtimeFilterMask;
+
+		hashtable->runtimeFilter[bit >> 6] |= ((uint64) 1) << (bit & 0x3f);
+		h += h2;
+	}
+}
+
+static inline bool
+RuntimeFilterMayContain(HashJoinTable hashtable, uint32 hashvalue)
+{
+	uint32		h = hashvalue;
+	uint32		h2 = RUNTIME_FILTER_HASH2(hashvalue);
+	int			i;
+
+	for (i = 0; i < RUNTIME_FILTER_NHASHES; i++)
+	{
+		uint32		bit = h & hashtable->runtimeFilterMask;
+
+		if ((hashtable->runtimeFilter[bit >> 6] & (((uint64) 1) << (bit & 0x3f))) == 0)
+			return false;
+		h += h2;
+	}
+
+	return true;
+}
+
 /* Amount of metadata memory required per batch */
 #define MD_MEM_PER_BATCH 	(sizeof(HashJoinBatchData *) + sizeof(HashJoinBatchData))
 
@@ -96,6 +169,7 @@ MultiExecHash(HashState *node)
 	TupleTableSlot *slot;
 	ExprContext *econtext;
 	uint32		hashvalue = 0;
+	double		ninner = 0;
 
 	/* must provide our own instrumentation support */
 	if (node->ps.instrument)
@@ -133,7 +207,19 @@ MultiExecHash(HashState *node)
 		if (ExecHashGetHashValue(node, hashtable, econtext, hashkeys, false,
 								 node->hs_keepnull, &hashvalue, &hashkeys_null))
 		{
-			ExecHashTableInsert(node, hashtable, slot, hashvalue);
+			int			bucketNumber;
+
+			if (hashtable->runtimeFilter != NULL)
+				RuntimeFilterAdd(hashtable, hashvalue);
+			ninner++;
+
+			/* The tuples of the most common outer values go to the skew table */
+			bucketNumber = ExecHashGetSkewBucket(hashtable, hashvalue);
+			if (bucketNumber != INVALID_SKEW_BUCKET_NO)
+				ExecHashSkewTableInsert(node, hashtable, slot, hashvalue,
+										bucketNumber);
+			else
+				ExecHashTableInsert(node, hashtable, slot, hashvalue);
 		}
 
 		if (hashkeys_null)
@@ -150,6 +236,17 @@ MultiExecHash(HashState *node)
 	/* Now we have set up all the initial batches & primary overflow batches. */
 	hashtable->nbatch_outstart = hashtable->nbatch;
 
+	ExecHashTableFinalize(node, hashtable);
+
+	/*
+	 * The runtime filter is complete. It is not used if the estimate of the
+	 * inner rows was so far off that it would let most rows through.
+	 */
+	if (hashtable->runtimeFilter != NULL)
+		hashtable->runtimeFilterReady =
+			(ninner * RUNTIME_FILTER_MIN_BITS_PER_ROW <=
+			 (double) hashtable->runtimeFilterMask + 1);
+
 	/* must provide our own instrumentation support */
 	if (node->ps.instrument)
 		InstrStopNode(node->ps.instrument, hashtable->totalTuples);
@@ -326,6 +423,58 @@ ExecHashTableCreate(HashState *hashState, HashJoinState *hjstate, List *hashOper
 	hashtable->stats = NULL;
 	hashtable->eagerlyReleased = false;
 	hashtable->hjstate = hjstate;
+	hashtable->runtimeFilter = NULL;
+	hashtable->runtimeFilterMask = 0;
+	hashtable->runtimeFilterReady = false;
+
+	/*
+	 * Size the runtime filter from the inner rows expected on this segment.
+	 * Its bits come out of the memory of the operator, as the skew hash
+	 * table's do; the filter is given up if it does not fit in its share.
+	 */
+	if (hjstate->hj_RuntimeFilter != NULL)
+	{
+		double		nbits = outerNode->plan_rows * RUNTIME_FILTER_BITS_PER_ROW;
+		double		maxbits = (double) hashtable->spaceAllowed * 8 *
+			RUNTIME_FILTER_SPACE_PERCENT / 100;
+		long		filterbits;
+
+		if (Gp_role == GP_ROLE_EXECUTE)
+			nbits /= getgpsegmentCount();
+		nbits = Max(nbits, RUNTIME_FILTER_MIN_BITS);
+		nbits = Min(nbits, RUNTIME_FILTER_MAX_BITS);
+		filterbits = 1L << my_log2((long) nbits);
+		while (filterbits > maxbits && filterbits > RUNTIME_FILTER_MIN_BITS)
+			filterbits >>= 1;
+
+		if (filterbits <= maxbits)
+		{
+			hashtable->runtimeFilterMask = (uint32) (filterbits - 1);
+			hashtable->spaceAllowed -= filterbits / 8;
+		}
+	}
+
+	/*
+	 * Radix mode keeps the entries of a batch in a single array, which must
+	 * stay below MaxAllocSize. Every entry is accounted for with its tuple,
+	 * which is at least as large, so the array takes at most half of the
+	 * space allowed.
+	 */
+	hashtable->radix = gp_enable_radix_hashjoin &&
+		hashtable->spaceAllowed / 2 < MaxAllocSize;
+	hashtable->radixEntries = NULL;
+	hashtable->nradixEntries = 0;
+	hashtable->maxRadixEntries = 0;
+	hashtable->radixBuckets = NULL;
+	hashtable->skewEnabled = false;
+	hashtable->skewBucket = NULL;
+	hashtable->skewBucketLen = 0;
+	hashtable->nSkewBuckets = 0;
+	hashtable->skewBucketNums = NULL;
+	hashtable->spaceUsedSkew = 0;
+	hashtable->spaceAllowedSkew = 0;
+	hashtable->nSkewValues = 0;
+	hashtable->skewOuterTuples = 0;
 
 	/*
 	 * Get info about the hash functions to be used for each hash key. Also
@@ -414,19 +563,33 @@ ExecHashTableCreate(HashState *hashState, HashJoinState *hjstate, List *hashOper
 		hashtable->batches[i] =
 			(HashJoinBatchData *)palloc0(sizeof(HashJoinBatchData));
 
+	/*
+	 * The runtime filter lives as long as the hash table, as it covers the
+	 * inner tuples of all the batches.
+	 */
+	if (hashtable->runtimeFilterMask != 0)
+		hashtable->runtimeFilter = (uint64 *)
+			palloc0(((Size) hashtable->runtimeFilterMask + 1) / 8);
+
 	/*
 	 * Prepare context for the first-scan space allocations; allocate the
 	 * hashbucket array therein, and set each bucket "empty".
 	 */
 	MemoryContextSwitchTo(hashtable->batchCxt);
 
-	hashtable->buckets = (HashJoinTuple *)
-		palloc0(nbuckets * sizeof(HashJoinTuple));
+	/* In radix mode, the entries are allocated as tuples are inserted */
+	if (!hashtable->radix)
+	{
+		hashtable->buckets = (HashJoinTuple *)
+			palloc0(nbuckets * sizeof(HashJoinTuple));
 
-	if(gp_hashjoin_bloomfilter!=0)
-		hashtable->bloom = (uint64*) palloc0(nbuckets * sizeof(uint64));
+		if(gp_hashjoin_bloomfilter!=0)
+			hashtable->bloom = (uint64*) palloc0(nbuckets * sizeof(uint64));
+	}
 
 	MemoryContextSwitchTo(oldcxt);
+
+	ExecHashBuildSkewHash(hashtable, node, outerNode->plan_width);
 	}
 	END_MEMORY_ACCOUNT();
 
@@ -703,6 +866,8 @@ ExecHashTableDestroy(HashState *hashState, HashJoinTable hashtable)
 	/* Release working memory (batchCxt is a child, so it goes away too) */
 	MemoryContextDelete(hashtable->hashCxt);
 	hashtable->batches = NULL;
+	hashtable->runtimeFilter = NULL;
+	hashtable->runtimeFilterReady = false;
 	}
 	END_MEMORY_ACCOUNT();
 }
@@ -766,6 +931,9 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 	 */
 	ninmemory = nfreed = 0;
 
+	if (hashtable->radix)
+		ExecHashRadixDumpOtherBatches(hashtable, &ninmemory, &nfreed, &spaceFreed);
+	else
 	for (i = 0; i < hashtable->nbuckets; i++)
 	{
 		HashJoinTuple prevtuple;
@@ -949,6 +1117,8 @@ ExecHashTableInsert(HashState *hashState, HashJoinTable hashtable,
 	/* Update batch size. */
 	batch->innertuples++;
 	batch->innerspace += hashTupleSize;
+	if (hashtable->radix)
+		batch->innerspace += sizeof(HashJoinRadixEntry);
 
 	/*
 	 * decide whether to put the tuple in the hash table or a temp file
@@ -964,12 +1134,17 @@ ExecHashTableInsert(HashState *hashState, HashJoinTable hashtable,
 													   hashTupleSize);
 		hashTuple->hashvalue = hashvalue;
 		memcpy(HJTUPLE_MINTUPLE(hashTuple), tuple, memtuple_get_size(tuple));
-		hashTuple->next = hashtable->buckets[bucketno];
-		hashtable->buckets[bucketno] = hashTuple;
-		hashtable->totalTuples += 1;
+		if (hashtable->radix)
+			ExecHashRadixAppend(hashtable, hashvalue, hashTuple);
+		else
+		{
+			hashTuple->next = hashtable->buckets[bucketno];
+			hashtable->buckets[bucketno] = hashTuple;
 
-		if(gp_hashjoin_bloomfilter!=0)
-			hashtable->bloom[bucketno] |= BLOOMVAL(hashvalue);
+			if(gp_hashjoin_bloomfilter!=0)
+				hashtable->bloom[bucketno] |= BLOOMVAL(hashvalue);
+		}
+		hashtable->totalTuples += 1;
 
 		/* Double the number of batches when too much data in hash table. */
 		if (batch->innerspace > hashtable->spaceAllowed ||
@@ -1026,20 +1201,14 @@ ExecHashGetHashValue(HashState *hashState, HashJoinTable hashtable,
 					 uint32 *hashvalue,
 					 bool *hashkeys_null)
 {
-	uint32		hashkey = 0;
-	FmgrInfo   *hashfunctions;
-	ListCell   *hk;
-	int			i = 0;
 	MemoryContext oldContext;
-	bool		result = true;
+	bool		result;
 
 	START_MEMORY_ACCOUNT(hashState->ps.plan->memoryAccountId);
 	{
 
 	Assert(hashkeys_null);
 
-	(*hashkeys_null) = true;
-
 	/*
 	 * We reset the eval context each time to reclaim any memory leaked in the
 	 * hashkey expressions.
@@ -1048,6 +1217,41 @@ ExecHashGetHashValue(HashState *hashState, HashJoinTable hashtable,
 
 	oldContext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
 
+	result = call_ExecHashGetHashKeys(hashState, hashtable, econtext, hashkeys,
+									  outer_tuple, keep_nulls,
+									  hashvalue, hashkeys_null);
+
+	MemoryContextSwitchTo(oldContext);
+	}
+	END_MEMORY_ACCOUNT();
+	return result;
+}
+
+/*
+ * ExecHashGetHashKeys
+ *		Evaluate and hash the hashkeys of a tuple
+ *
+ * This is the part of ExecHashGetHashValue that runs in the per-tuple memory
+ * context, kept apart so that a generated version can be used instead (see
+ * ExecHashGetHashKeysCodegen).  The result has the same meaning.
+ */
+bool
+ExecHashGetHashKeys(HashJoinTable hashtable,
+					ExprContext *econtext,
+					List *hashkeys,
+					bool outer_tuple,
+					bool keep_nulls,
+					uint32 *hashvalue,
+					bool *hashkeys_null)
+{
+	uint32		hashkey = 0;
+	FmgrInfo   *hashfunctions;
+	ListCell   *hk;
+	int			i = 0;
+	bool		result = true;
+
+	(*hashkeys_null) = true;
+
 	if (outer_tuple)
 		hashfunctions = hashtable->outer_hashfunctions;
 	else
@@ -1105,11 +1309,7 @@ ExecHashGetHashValue(HashState *hashState, HashJoinTable hashtable,
 		i++;
 	}
 
-	MemoryContextSwitchTo(oldContext);
-
 	*hashvalue = hashkey;
-	}
-	END_MEMORY_ACCOUNT();
 	return result;
 }
 
@@ -1172,18 +1372,65 @@ ExecScanHashBucket(HashState *hashState, HashJoinState *hjstate,
 
 	START_MEMORY_ACCOUNT(hashState->ps.plan->memoryAccountId);
 	{
+	/*
+	 * In radix mode, scan the entries of the bucket, starting after that of
+	 * the last tuple returned if any, and only look at the tuples whose hash
+	 * value matches. Skew buckets are always chained.
+	 */
+	if (hashtable->radix && hjstate->hj_CurSkewBucketNo == INVALID_SKEW_BUCKET_NO)
+	{
+		uint32		entryno;
+		uint32		endno;
+
+		Assert(hashtable->radixBuckets != NULL);
+
+		if (hashTuple == NULL)
+			entryno = hashtable->radixBuckets[hjstate->hj_CurBucketNo];
+		else
+			entryno = hjstate->hj_CurRadixEntry + 1;
+		endno = hashtable->radixBuckets[hjstate->hj_CurBucketNo + 1];
+
+		for (; entryno < endno; entryno++)
+		{
+			TupleTableSlot *inntuple;
+
+			if (hashtable->radixEntries[entryno].hashvalue != hashvalue)
+				continue;
+
+			hashTuple = hashtable->radixEntries[entryno].tuple;
+			inntuple = ExecStoreMinimalTuple(HJTUPLE_MINTUPLE(hashTuple),
+											 hjstate->hj_HashTupleSlot,
+											 false);	/* do not pfree */
+			econtext->ecxt_innertuple = inntuple;
+
+			/* reset temp memory each time to avoid leaks from qual expr */
+			ResetExprContext(econtext);
+
+			if (ExecQual(hjclauses, econtext, false))
+			{
+				hjstate->hj_CurTuple = hashTuple;
+				hjstate->hj_CurRadixEntry = entryno;
+				return hashTuple;
+			}
+		}
+
+		return NULL;
+	}
+
 	/*
 	 * hj_CurTuple is NULL to start scanning a new bucket, or the address of
 	 * the last tuple returned from the current bucket.
 	 */
-	if (hashTuple == NULL)
+	if (hashTuple != NULL)
+		hashTuple = hashTuple->next;
+	else if (hjstate->hj_CurSkewBucketNo != INVALID_SKEW_BUCKET_NO)
+		hashTuple = hashtable->skewBucket[hjstate->hj_CurSkewBucketNo]->tuples;
+	else
 	{
 		/* if bloom filter fails, then no match - don't even bother to scan */
 		if (gp_hashjoin_bloomfilter == 0 || 0 != (hashtable->bloom[hjstate->hj_CurBucketNo] & BLOOMVAL(hashvalue)))
 			hashTuple = hashtable->buckets[hjstate->hj_CurBucketNo];
 	}
-	else
-		hashTuple = hashTuple->next;
 
 	while (hashTuple != NULL)
 	{
@@ -1240,12 +1487,23 @@ ExecHashTableReset(HashState *hashState, HashJoinTable hashtable)
 	MemoryContextReset(hashtable->batchCxt);
 	oldcxt = MemoryContextSwitchTo(hashtable->batchCxt);
 
-	/* Reallocate and reinitialize the hash bucket headers. */
-	hashtable->buckets = (HashJoinTuple *)
-		palloc0(nbuckets * sizeof(HashJoinTuple));
+	if (hashtable->radix)
+	{
+		/* The entries went away with the context */
+		hashtable->radixEntries = NULL;
+		hashtable->nradixEntries = 0;
+		hashtable->maxRadixEntries = 0;
+		hashtable->radixBuckets = NULL;
+	}
+	else
+	{
+		/* Reallocate and reinitialize the hash bucket headers. */
+		hashtable->buckets = (HashJoinTuple *)
+			palloc0(nbuckets * sizeof(HashJoinTuple));
 
-	if(gp_hashjoin_bloomfilter != 0)
-		hashtable->bloom = (uint64*) palloc0(nbuckets * sizeof(uint64));
+		if(gp_hashjoin_bloomfilter != 0)
+			hashtable->bloom = (uint64*) palloc0(nbuckets * sizeof(uint64));
+	}
 
 	hashtable->batches[hashtable->curbatch]->innerspace = 0;
 	hashtable->batches[hashtable->curbatch]->innertuples = 0;
@@ -1256,6 +1514,479 @@ ExecHashTableReset(HashState *hashState, HashJoinTable hashtable)
 	END_MEMORY_ACCOUNT();
 }
 
+/*
+ * ExecHashRadixAppend
+ *		add a tuple of the current batch to the entries, in radix mode
+ *
+ * If the array of entries cannot grow any more, the hash table goes back to
+ * chaining the tuples into buckets.
+ */
+static void
+ExecHashRadixAppend(HashJoinTable hashtable, uint32 hashvalue,
+					HashJoinTuple hashTuple)
+{
+	if (hashtable->nradixEntries == hashtable->maxRadixEntries)
+	{
+		Size		maxEntries = MaxAllocSize / sizeof(HashJoinRadixEntry);
+		Size		newMax = Max((Size) hashtable->maxRadixEntries * 2, 1024);
+
+		newMax = Min(newMax, maxEntries);
+		if (newMax <= hashtable->nradixEntries)
+		{
+			ExecHashRadixToChains(hashtable);
+			hashTuple->next = hashtable->buckets[hashvalue & (hashtable->nbuckets - 1)];
+			hashtable->buckets[hashvalue & (hashtable->nbuckets - 1)] = hashTuple;
+			if (gp_hashjoin_bloomfilter != 0)
+				hashtable->bloom[hashvalue & (hashtable->nbuckets - 1)] |= BLOOMVAL(hashvalue);
+			return;
+		}
+
+		if (hashtable->radixEntries == NULL)
+			hashtable->radixEntries = (HashJoinRadixEntry *)
+				MemoryContextAlloc(hashtable->batchCxt,
+								   newMax * sizeof(HashJoinRadixEntry));
+		else
+			hashtable->radixEntries = (HashJoinRadixEntry *)
+				repalloc(hashtable->radixEntries,
+						 newMax * sizeof(HashJoinRadixEntry));
+		hashtable->maxRadixEntries = (uint32) newMax;
+	}
+
+	hashtable->radixEntries[hashtable->nradixEntries].hashvalue = hashvalue;
+	hashtable->radixEntries[hashtable->nradixEntries].tuple = hashTuple;
+	hashtable->nradixEntries++;
+}
+
+/*
+ * ExecHashRadixToChains
+ *		leave radix mode, chaining the entries loaded so far into buckets
+ */
+static void
+ExecHashRadixToChains(HashJoinTable hashtable)
+{
+	MemoryContext oldcxt;
+	uint32		i;
+
+	Assert(hashtable->radix && hashtable->radixBuckets == NULL);
+
+	elog(DEBUG1, "HJ: too many tuples in batch %d for radix mode, using chained buckets",
+		 hashtable->curbatch);
+
+	oldcxt = MemoryContextSwitchTo(hashtable->batchCxt);
+	hashtable->buckets = (HashJoinTuple *)
+		palloc0(hashtable->nbuckets * sizeof(HashJoinTuple));
+	if (gp_hashjoin_bloomfilter != 0)
+		hashtable->bloom = (uint64 *) palloc0(hashtable->nbuckets * sizeof(uint64));
+	MemoryContextSwitchTo(oldcxt);
+
+	for (i = 0; i < hashtable->nradixEntries; i++)
+	{
+		HashJoinTuple tuple = hashtable->radixEntries[i].tuple;
+		int			bucketno = tuple->hashvalue & (hashtable->nbuckets - 1);
+
+		tuple->next = hashtable->buckets[bucketno];
+		hashtable->buckets[bucketno] = tuple;
+		if (gp_hashjoin_bloomfilter != 0)
+			hashtable->bloom[bucketno] |= BLOOMVAL(tuple->hashvalue);
+	}
+
+	pfree(hashtable->radixEntries);
+	hashtable->radixEntries = NULL;
+	hashtable->nradixEntries = 0;
+	hashtable->maxRadixEntries = 0;
+	hashtable->radix = false;
+}
+
+/*
+ * ExecHashRadixDumpOtherBatches
+ *		radix mode part of ExecHashIncreaseNumBatches: dump out the entries
+ *		that are no longer of the current batch, compacting the others
+ */
+static void
+ExecHashRadixDumpOtherBatches(HashJoinTable hashtable, long *ninmemory,
+							  long *nfreed, Size *spaceFreed)
+{
+	HashJoinTableStats *stats = hashtable->stats;
+	int			curbatch = hashtable->curbatch;
+	uint32		nkept = 0;
+	uint32		i;
+
+	for (i = 0; i < hashtable->nradixEntries; i++)
+	{
+		HashJoinTuple tuple = hashtable->radixEntries[i].tuple;
+		int			bucketno;
+		int			batchno;
+
+		(*ninmemory)++;
+		ExecHashGetBucketAndBatch(hashtable, tuple->hashvalue,
+								  &bucketno, &batchno);
+		if (batchno == curbatch)
+		{
+			/* keep tuple */
+			hashtable->radixEntries[nkept++] = hashtable->radixEntries[i];
+		}
+		else
+		{
+			Size		spaceTuple;
+
+			/* dump it out */
+			Assert(batchno > curbatch);
+			ExecHashJoinSaveTuple(NULL, HJTUPLE_MINTUPLE(tuple),
+								  tuple->hashvalue,
+								  hashtable,
+								  &hashtable->batches[batchno]->innerside,
+								  hashtable->bfCxt);
+
+			hashtable->totalTuples--;
+
+			spaceTuple = HJTUPLE_OVERHEAD + memtuple_get_size(HJTUPLE_MINTUPLE(tuple)) +
+				sizeof(HashJoinRadixEntry);
+			*spaceFreed += spaceTuple;
+			if (stats)
+				stats->batchstats[batchno].spillspace_in += spaceTuple;
+
+			pfree(tuple);
+			(*nfreed)++;
+		}
+	}
+
+	hashtable->nradixEntries = nkept;
+}
+
+/*
+ * ExecHashTableFinalize
+ *		called once all the inner tuples of the current batch are loaded
+ *
+ * In radix mode, partition the entries by bucket number. To keep the
+ * scattered writes within the cache, it takes two passes over the entries:
+ * the first partitions them on the high half of the bucket number bits,
+ * the second partitions each of those partitions on the low half.
+ */
+void
+ExecHashTableFinalize(HashState *hashState, HashJoinTable hashtable)
+{
+	HashJoinRadixEntry *entries;
+	HashJoinRadixEntry *tmp;
+	uint32	   *buckets;
+	uint32	   *cursor;
+	uint32		n = hashtable->nradixEntries;
+	int			nbuckets = hashtable->nbuckets;
+	int			lowbits;
+	int			nhigh;
+	int			nlow;
+	uint32		sum;
+	uint32		i;
+	int			p;
+	int			b;
+
+	if (!hashtable->radix)
+		return;
+
+	START_MEMORY_ACCOUNT(hashState->ps.plan->memoryAccountId);
+	{
+	entries = hashtable->radixEntries;
+	lowbits = (hashtable->log2_nbuckets + 1) / 2;
+	nlow = 1 << lowbits;
+	nhigh = nbuckets >> lowbits;
+
+	/* Count the entries of each bucket, and turn the counts into offsets */
+	buckets = (uint32 *) MemoryContextAllocZero(hashtable->batchCxt,
+												(nbuckets + 1) * sizeof(uint32));
+	for (i = 0; i < n; i++)
+		buckets[entries[i].hashvalue & (nbuckets - 1)]++;
+
+	sum = 0;
+	for (b = 0; b < nbuckets; b++)
+	{
+		uint32		count = buckets[b];
+
+		buckets[b] = sum;
+		sum += count;
+	}
+	buckets[nbuckets] = sum;
+	Assert(sum == n);
+
+	if (n > 1)
+	{
+		tmp = (HashJoinRadixEntry *)
+			MemoryContextAlloc(hashtable->batchCxt, n * sizeof(HashJoinRadixEntry));
+		cursor = (uint32 *)
+			MemoryContextAlloc(hashtable->batchCxt, Max(nhigh, nlow) * sizeof(uint32));
+
+		/* Pass 1: partition on the high bits, into tmp */
+		for (p = 0; p < nhigh; p++)
+			cursor[p] = buckets[p << lowbits];
+		for (i = 0; i < n; i++)
+		{
+			p = (entries[i].hashvalue & (nbuckets - 1)) >> lowbits;
+			tmp[cursor[p]++] = entries[i];
+		}
+
+		/* Pass 2: partition each partition on the low bits, back in place */
+		for (p = 0; p < nhigh; p++)
+		{
+			int			base = p << lowbits;
+
+			for (b = 0; b < nlow; b++)
+				cursor[b] = buckets[base + b];
+			for (i = buckets[base]; i < buckets[base + nlow]; i++)
+			{
+				b = tmp[i].hashvalue & (nlow - 1);
+				entries[cursor[b]++] = tmp[i];
+			}
+		}
+
+		pfree(tmp);
+		pfree(cursor);
+	}
+
+	hashtable->radixBuckets = buckets;
+	}
+	END_MEMORY_ACCOUNT();
+}
+
+/*
+ * ExecHashBuildSkewHash
+ *		set up the skew hash table of the first batch, for the most common
+ *		values of the outer join key that the planner found
+ *
+ * The skew hash table gets SKEW_WORK_MEM_PERCENT of the memory of the hash
+ * table, which limits the number of values used. Nothing spills with a
+ * single batch, so there is no point then.
+ */
+static void
+ExecHashBuildSkewHash(HashJoinTable hashtable, Hash *node, int tupwidth)
+{
+	Size		skewSpace;
+	int			mcvsToUse;
+	int			nbuckets;
+	int			i;
+	ListCell   *lc;
+
+	if (node->skewValues == NIL || hashtable->nbatch <= 1)
+		return;
+
+	skewSpace = hashtable->spaceAllowed * SKEW_WORK_MEM_PERCENT / 100;
+	mcvsToUse = skewSpace / (ExecHashRowSize(tupwidth) +
+							 8 * sizeof(HashSkewBucket *) +
+							 sizeof(int) +
+							 SKEW_BUCKET_OVERHEAD);
+	mcvsToUse = Min(mcvsToUse, list_length(node->skewValues));
+	if (mcvsToUse <= 0)
+		return;
+
+	/*
+	 * skewBucket is an open addressing hash table with a power of 2 size
+	 * greater than the number of values, so a search always ends on a free
+	 * slot; two more bits help avoid collisions.
+	 */
+	nbuckets = 2;
+	while (nbuckets <= mcvsToUse)
+		nbuckets <<= 1;
+	nbuckets <<= 2;
+
+	/* The skew hash table only lives for the first batch */
+	hashtable->skewEnabled = true;
+	hashtable->skewBucketLen = nbuckets;
+	hashtable->skewBucket = (HashSkewBucket **)
+		MemoryContextAllocZero(hashtable->batchCxt,
+							   nbuckets * sizeof(HashSkewBucket *));
+	hashtable->skewBucketNums = (int *)
+		MemoryContextAllocZero(hashtable->batchCxt, mcvsToUse * sizeof(int));
+	hashtable->spaceUsedSkew = nbuckets * sizeof(HashSkewBucket *) +
+		mcvsToUse * sizeof(int);
+	hashtable->spaceAllowedSkew = skewSpace;
+	hashtable->spaceAllowed -= skewSpace;
+
+	/*
+	 * Create a bucket per hash value, most common value first, as they are
+	 * removed in the reverse order (see ExecHashRemoveNextSkewBucket).
+	 */
+	i = 0;
+	foreach(lc, node->skewValues)
+	{
+		Const	   *mcv = (Const *) lfirst(lc);
+		uint32		hashvalue;
+		int			bucket;
+
+		if (i++ >= mcvsToUse)
+			break;
+
+		/* Must match ExecHashGetHashKeys with a single key */
+		hashvalue = DatumGetUInt32(FunctionCall1(&hashtable->outer_hashfunctions[0],
+												 mcv->constvalue));
+
+		/* Must match ExecHashGetSkewBucket */
+		bucket = hashvalue & (nbuckets - 1);
+		while (hashtable->skewBucket[bucket] != NULL &&
+			   hashtable->skewBucket[bucket]->hashvalue != hashvalue)
+			bucket = (bucket + 1) & (nbuckets - 1);
+
+		/* Two values may share a hash value, and then a bucket */
+		if (hashtable->skewBucket[bucket] != NULL)
+			continue;
+
+		hashtable->skewBucket[bucket] = (HashSkewBucket *)
+			MemoryContextAlloc(hashtable->batchCxt, sizeof(HashSkewBucket));
+		hashtable->skewBucket[bucket]->hashvalue = hashvalue;
+		hashtable->skewBucket[bucket]->tuples = NULL;
+		hashtable->skewBucketNums[hashtable->nSkewBuckets] = bucket;
+		hashtable->nSkewBuckets++;
+		hashtable->spaceUsedSkew += SKEW_BUCKET_OVERHEAD;
+	}
+}
+
+/*
+ * ExecHashGetSkewBucket
+ *		Returns the index of the skew bucket for this hash value,
+ *		or INVALID_SKEW_BUCKET_NO if the hash value is not
+ *		associated with any active skew bucket.
+ */
+int
+ExecHashGetSkewBucket(HashJoinTable hashtable, uint32 hashvalue)
+{
+	int			bucket;
+
+	if (!hashtable->skewEnabled)
+		return INVALID_SKEW_BUCKET_NO;
+
+	bucket = hashvalue & (hashtable->skewBucketLen - 1);
+	while (hashtable->skewBucket[bucket] != NULL &&
+		   hashtable->skewBucket[bucket]->hashvalue != hashvalue)
+		bucket = (bucket + 1) & (hashtable->skewBucketLen - 1);
+
+	if (hashtable->skewBucket[bucket] != NULL)
+		return bucket;
+
+	return INVALID_SKEW_BUCKET_NO;
+}
+
+/*
+ * ExecHashSkewTableInsert
+ *		insert a tuple into the skew hash table
+ *
+ * If the skew hash table runs out of space, the buckets of the least
+ * common values are moved to the main hash table or its batch files.
+ */
+static void
+ExecHashSkewTableInsert(HashState *hashState, HashJoinTable hashtable,
+						TupleTableSlot *slot, uint32 hashvalue,
+						int bucketNumber)
+{
+	MemTuple	tuple = ExecFetchSlotMemTuple(slot, false);
+	HashJoinTuple hashTuple;
+	int			hashTupleSize;
+
+	START_MEMORY_ACCOUNT(hashState->ps.plan->memoryAccountId);
+	{
+	hashTupleSize = HJTUPLE_OVERHEAD + memtuple_get_size(tuple);
+	hashTuple = (HashJoinTuple) MemoryContextAlloc(hashtable->batchCxt,
+												   hashTupleSize);
+	hashTuple->hashvalue = hashvalue;
+	memcpy(HJTUPLE_MINTUPLE(hashTuple), tuple, memtuple_get_size(tuple));
+
+	hashTuple->next = hashtable->skewBucket[bucketNumber]->tuples;
+	hashtable->skewBucket[bucketNumber]->tuples = hashTuple;
+	hashtable->totalTuples += 1;
+	hashtable->spaceUsedSkew += hashTupleSize;
+
+	while (hashtable->spaceUsedSkew > hashtable->spaceAllowedSkew)
+		ExecHashRemoveNextSkewBucket(hashtable);
+
+	/* The main hash table may have grown too large in the process */
+	if (hashtable->batches[hashtable->curbatch]->innerspace > hashtable->spaceAllowed)
+		ExecHashIncreaseNumBatches(hashtable);
+	}
+	END_MEMORY_ACCOUNT();
+}
+
+/*
+ * ExecHashRemoveNextSkewBucket
+ *		move the tuples of the skew bucket of the least common value to the
+ *		main hash table, or to a batch file
+ *
+ * The buckets are removed in the reverse order of their creation: removing
+ * the first of two colliding buckets would hide the second one from
+ * ExecHashGetSkewBucket.
+ */
+static void
+ExecHashRemoveNextSkewBucket(HashJoinTable hashtable)
+{
+	int			bucketToRemove;
+	HashSkewBucket *bucket;
+	HashJoinBatchData *batch;
+	HashJoinTuple hashTuple;
+	uint32		hashvalue;
+	int			bucketno;
+	int			batchno;
+
+	bucketToRemove = hashtable->skewBucketNums[hashtable->nSkewBuckets - 1];
+	bucket = hashtable->skewBucket[bucketToRemove];
+
+	/* All the tuples have the same hash value, so go to the same batch */
+	hashvalue = bucket->hashvalue;
+	ExecHashGetBucketAndBatch(hashtable, hashvalue, &bucketno, &batchno);
+	batch = hashtable->batches[batchno];
+
+	hashTuple = bucket->tuples;
+	while (hashTuple != NULL)
+	{
+		HashJoinTuple nextHashTuple = hashTuple->next;
+		MemTuple	tuple = HJTUPLE_MINTUPLE(hashTuple);
+		Size		tupleSize = HJTUPLE_OVERHEAD + memtuple_get_size(tuple);
+
+		batch->innertuples++;
+		batch->innerspace += tupleSize;
+		hashtable->spaceUsedSkew -= tupleSize;
+
+		if (batchno == hashtable->curbatch)
+		{
+			/* Move the tuple to the main hash table */
+			if (hashtable->radix)
+			{
+				batch->innerspace += sizeof(HashJoinRadixEntry);
+				ExecHashRadixAppend(hashtable, hashvalue, hashTuple);
+			}
+			else
+			{
+				hashTuple->next = hashtable->buckets[bucketno];
+				hashtable->buckets[bucketno] = hashTuple;
+				if (gp_hashjoin_bloomfilter != 0)
+					hashtable->bloom[bucketno] |= BLOOMVAL(hashvalue);
+			}
+		}
+		else
+		{
+			/* Put the tuple into a temp file for later batches */
+			Assert(batchno > hashtable->curbatch);
+			ExecHashJoinSaveTuple(NULL, tuple, hashvalue, hashtable,
+								  &batch->innerside, hashtable->bfCxt);
+			hashtable->totalTuples--;
+			pfree(hashTuple);
+		}
+
+		hashTuple = nextHashTuple;
+	}
+
+	hashtable->skewBucket[bucketToRemove] = NULL;
+	hashtable->nSkewBuckets--;
+	pfree(bucket);
+	hashtable->spaceUsedSkew -= SKEW_BUCKET_OVERHEAD;
+
+	/* Without any bucket left, give the space back to the main hash table */
+	if (hashtable->nSkewBuckets == 0)
+	{
+		hashtable->skewEnabled = false;
+		pfree(hashtable->skewBucket);
+		pfree(hashtable->skewBucketNums);
+		hashtable->skewBucket = NULL;
+		hashtable->skewBucketNums = NULL;
+		hashtable->spaceUsedSkew = 0;
+		hashtable->spaceAllowed += hashtable->spaceAllowedSkew;
+		hashtable->spaceAllowedSkew = 0;
+	}
+}
+
 void
 ExecReScanHash(HashState *node, ExprContext *exprCtxt)
 {
@@ -1268,6 +1999,105 @@ ExecReScanHash(HashState *node, ExprContext *exprCtxt)
 }
 
 
+/*
+ * ExecSupportsRuntimeFilter
+ *		Can the hash join set a runtime filter on its outer side?
+ *
+ * The outer rows without a match must be of no use to the join, and the
+ * outer side a scan, which checks the filter in ExecScan() on the rows it
+ * returns.
+ */
+bool
+ExecSupportsRuntimeFilter(HashJoinState *hjstate)
+{
+	PlanState  *outerNode = outerPlanState(hjstate);
+
+	if (hjstate->js.jointype != JOIN_INNER && hjstate->js.jointype != JOIN_IN)
+		return false;
+
+	switch (nodeTag(outerNode))
+	{
+		case T_SeqScanState:
+		case T_TableScanState:
+		case T_DynamicTableScanState:
+		case T_ExternalScanState:
+		case T_IndexScanState:
+		case T_DynamicIndexScanState:
+		case T_BitmapHeapScanState:
+		case T_BitmapAppendOnlyScanState:
+		case T_BitmapTableScanState:
+			return true;
+		default:
+			return false;
+	}
+}
+
+/*
+ * ExecRuntimeFilterPass
+ *		Can the given row of the outer scan of the join find a match in its
+ *		hash table?
+ *
+ * False only if the hash value of its join keys is not in the bloom filter
+ * of the hash table. Until the hash table is built, every row passes.
+ */
+bool
+ExecRuntimeFilterPass(RuntimeFilterState *rf, TupleTableSlot *slot)
+{
+	HashJoinState *hjstate = rf->hjstate;
+	HashJoinTable hashtable = hjstate->hj_HashTable;
+	ExprContext *econtext = rf->econtext;
+	uint32		hashvalue;
+	bool		hashkeys_null = false;
+	bool		pass;
+
+	if (rf->disabled || hashtable == NULL || hashtable->eagerlyReleased ||
+		!hashtable->runtimeFilterReady)
+		return true;
+
+	econtext->ecxt_outertuple = slot;
+
+	/* Rows with null keys never match, unless nulls are joined */
+	if (!ExecHashGetHashValue((HashState *) innerPlanState(hjstate), hashtable,
+							  econtext, hjstate->hj_OuterHashKeys,
+							  true,		/* outer tuple */
+							  hjstate->hj_nonequijoin,
+							  &hashvalue, &hashkeys_null))
+		pass = false;
+	else
+		pass = RuntimeFilterMayContain(hashtable, hashvalue);
+
+	rf->nchecked++;
+	rf->nsampled++;
+	if (!pass)
+	{
+		rf->nremoved++;
+		rf->nsampleRemoved++;
+	}
+
+	/* Not worth the cost of checking if it removes too few rows */
+	if (rf->nsampled == RUNTIME_FILTER_SAMPLE_ROWS &&
+		rf->nsampleRemoved < RUNTIME_FILTER_SAMPLE_ROWS / RUNTIME_FILTER_MIN_REMOVED)
+		rf->disabled = true;
+
+	return pass;
+}
+
+/*
+ * ExecResetRuntimeFilter
+ *		Start sampling the filter afresh for a rescan of the join.
+ *
+ * A rescan may rebuild the hash table from other inner rows, or meet other
+ * outer rows, so a filter disabled in an earlier scan gets another chance.
+ * The totals reported by EXPLAIN ANALYZE keep counting across scans.
+ */
+void
+ExecResetRuntimeFilter(RuntimeFilterState *rf)
+{
+	rf->nsampled = 0;
+	rf->nsampleRemoved = 0;
+	rf->disabled = false;
+}
+
 /*
  * ExecHashTableExplainInit
  *      Called after ExecHashTableCreate to set up EXPLAIN ANALYZE reporting.
@@ -1317,6 +2147,15 @@ ExecHashTableExplainEnd(PlanState *planstate, struct StringInfoData *buf)
     int                 total_buckets;
     int                 i;
 
+    /* Report on the runtime filter of the outer scan. */
+    if (hjstate->hj_RuntimeFilter && hjstate->hj_RuntimeFilter->nchecked > 0)
+        appendStringInfo(buf,
+                         "Runtime filter removed " INT64_FORMAT " of "
+                         INT64_FORMAT " outer rows%s.\n",
+                         hjstate->hj_RuntimeFilter->nremoved,
+                         hjstate->hj_RuntimeFilter->nchecked,
+                         hjstate->hj_RuntimeFilter->disabled ? ", then was disabled" : "");
+
     if (!hashtable ||
         !hashtable->stats ||
         hashtable->nbatch < 1 ||
@@ -1426,6 +2265,19 @@ ExecHashTableExplainEnd(PlanState *planstate, struct StringInfoData *buf)
                              hashtable->nbatch - stats->nonemptybatches);
         appendStringInfoChar(buf, '\n');
     }
+
+    /* Report whether the buckets were radix-partitioned arrays of entries. */
+    if (hashtable->radix)
+        appendStringInfo(buf, "Hash table radix-partitioned.\n");
+
+    /* Report on the skew hash table of the first batch. */
+    if (hashtable->skewEnabled || hashtable->nSkewValues > 0)
+        appendStringInfo(buf,
+                         "Skew optimization kept %d most common outer values in memory, "
+                         "for %.0f outer rows.\n",
+                         hashtable->skewEnabled ? hashtable->nSkewBuckets
+                                                : hashtable->nSkewValues,
+                         hashtable->skewOuterTuples);
 }                               /* ExecHashTableExplainEnd */
 
 
@@ -1637,9 +2489,23 @@ ExecHashTableExplainBatchEnd(HashState *hashState, HashJoinTable hashtable)
         stats->nonemptybatches++;
         for (i = 0; i < hashtable->nbuckets; i++)
         {
-            HashJoinTuple   hashtuple = hashtable->buckets[i];
+            HashJoinTuple   hashtuple;
             int             chainlength;
 
+            if (hashtable->radix)
+            {
+                /* the bucket's entries, if the batch was finalized */
+                if (!hashtable->radixBuckets)
+                    break;
+                chainlength = hashtable->radixBuckets[i + 1] -
+                    hashtable->radixBuckets[i];
+                if (chainlength > 0)
+                    cdbexplain_agg_upd(&stats->chainlength, chainlength, i);
+                continue;
+            }
+
+            hashtuple = hashtable->buckets[i];
+
             if (hashtuple)
             {
                 for (chainlength = 0; hashtuple; hashtuple = hashtuple->next)
@@ -27,6 +27,13 @@
 #include "cdb/cdbvars.h"
 #include "miscadmin.h"			/* work_mem */
 
+static TupleTableSlot *ExecHashJoinFetchOuter(PlanState *outerNode,
+					   HashJoinState *hjstate,
+					   uint32 *hashvalue);
+static TupleTableSlot *ExecHashJoinPrefetchOuter(PlanState *outerNode,
+						  HashJoinState *hjstate,
+						  uint32 *hashvalue);
+static void ExecHashJoinResetPrefetch(HashJoinState *hjstate);
 static TupleTableSlot *ExecHashJoinOuterGetTuple(PlanState *outerNode,
 						  HashJoinState *hjstate,
 						  uint32 *hashvalue);
@@ -302,12 +309,17 @@ ExecHashJoin(HashJoinState *node)
 			ExecHashGetBucketAndBatch(hashtable, hashvalue,
 									  &node->hj_CurBucketNo, &batchno);
 			node->hj_CurTuple = NULL;
+			node->hj_CurSkewBucketNo = ExecHashGetSkewBucket(hashtable, hashvalue);
+			if (node->hj_CurSkewBucketNo != INVALID_SKEW_BUCKET_NO)
+				hashtable->skewOuterTuples += 1;
 
 			/*
 			 * Now we've got an outer tuple and the corresponding hash bucket,
-			 * but this tuple may not belong to the current batch.
+			 * but this tuple may not belong to the current batch (where
+			 * "current batch" includes the skew buckets if any).
 			 */
-			if (batchno != hashtable->curbatch)
+			if (batchno != hashtable->curbatch &&
+				node->hj_CurSkewBucketNo == INVALID_SKEW_BUCKET_NO)
 			{
 				/*
 				 * Need to postpone this outer tuple to a later batch. Save it
@@ -525,7 +537,7 @@ ExecInitHashJoin(HashJoin *node, EState *estate, int eflags)
 
 	outerPlanState(hjstate) = ExecInitNode(outerNode, estate, eflags);
 
-#define HASHJOIN_NSLOTS 3
+#define HASHJOIN_NSLOTS (3 + HJ_PREFETCH_DISTANCE)
 
 	/*
 	 * tuple table initialization
@@ -573,6 +585,29 @@ ExecInitHashJoin(HashJoin *node, EState *estate, int eflags)
 	ExecSetSlotDescriptor(hjstate->hj_OuterTupleSlot,
 						  ExecGetResultType(outerPlanState(hjstate)));
 
+	/*
+	 * In radix mode, outer tuples are read ahead of the probe into a queue
+	 * of their own slots, as the outer plan reuses its result slot.
+	 */
+	hjstate->hj_PrefetchSlots = NULL;
+	hjstate->hj_PrefetchHashValues = NULL;
+	if (gp_enable_radix_hashjoin)
+	{
+		int			i;
+
+		hjstate->hj_PrefetchSlots = (TupleTableSlot **)
+			palloc(HJ_PREFETCH_DISTANCE * sizeof(TupleTableSlot *));
+		hjstate->hj_PrefetchHashValues = (uint32 *)
+			palloc(HJ_PREFETCH_DISTANCE * sizeof(uint32));
+		for (i = 0; i < HJ_PREFETCH_DISTANCE; i++)
+		{
+			hjstate->hj_PrefetchSlots[i] = ExecInitExtraTupleSlot(estate);
+			ExecSetSlotDescriptor(hjstate->hj_PrefetchSlots[i],
+								  ExecGetResultType(outerPlanState(hjstate)));
+		}
+	}
+	ExecHashJoinResetPrefetch(hjstate);
+
 	/*
 	 * initialize hash-specific info
 	 */
@@ -582,6 +617,7 @@ ExecInitHashJoin(HashJoin *node, EState *estate, int eflags)
 	hjstate->hj_CurHashValue = 0;
 	hjstate->hj_CurBucketNo = 0;
 	hjstate->hj_CurTuple = NULL;
+	hjstate->hj_CurSkewBucketNo = INVALID_SKEW_BUCKET_NO;
 
 	/*
 	 * Deconstruct the hash clauses into outer and inner argument values, so
@@ -610,6 +646,21 @@ ExecInitHashJoin(HashJoin *node, EState *estate, int eflags)
 	/* child Hash node needs to evaluate inner hash keys, too */
 	((HashState *) innerPlanState(hjstate))->hashkeys = rclauses;
 
+	/*
+	 * Have the outer scan drop the rows whose join keys are not in a bloom
+	 * filter of the inner ones, built along with the hash table.
+	 */
+	hjstate->hj_RuntimeFilter = NULL;
+	if (gp_enable_runtime_filter && ExecSupportsRuntimeFilter(hjstate))
+	{
+		RuntimeFilterState *rf = (RuntimeFilterState *) palloc0(sizeof(RuntimeFilterState));
+
+		rf->hjstate = hjstate;
+		rf->econtext = CreateExprContext(estate);
+		hjstate->hj_RuntimeFilter = rf;
+		((ScanState *) outerPlanState(hjstate))->runtimeFilter = rf;
+	}
+
 	hjstate->js.ps.ps_OuterTupleSlot = NULL;
 	hjstate->hj_NeedNewOuter = true;
 	hjstate->hj_MatchedOuter = false;
@@ -673,6 +724,167 @@ ExecEndHashJoin(HashJoinState *node)
 	EndPlanStateGpmonPkt(&node->js.ps);
 }
 
+/*
+ * ExecHashJoinFetchOuter
+ *
+ *		get the next outer tuple from the outer plan, in the first pass,
+ *		skipping those that cannot match because of a NULL join key.
+ *
+ * Returns a null slot at the end of the outer plan.
+ */
+static TupleTableSlot *
+ExecHashJoinFetchOuter(PlanState *outerNode,
+					   HashJoinState *hjstate,
+					   uint32 *hashvalue)
+{
+	HashJoinTable hashtable = hjstate->hj_HashTable;
+	TupleTableSlot *slot;
+	ExprContext *econtext;
+	HashState  *hashState = (HashState *) innerPlanState(hjstate);
+
+	for (;;)
+	{
+		/*
+		 * Check to see if first outer tuple was already fetched by
+		 * ExecHashJoin() and not used yet.
+		 */
+		slot = hjstate->hj_FirstOuterTupleSlot;
+		if (!TupIsNull(slot))
+			hjstate->hj_FirstOuterTupleSlot = NULL;
+		else
+		{
+			slot = ExecProcNode(outerNode);
+		}
+
+		if (TupIsNull(slot))
+			return NULL;
+
+		/*
+		 * We have to compute the tuple's hash value.
+		 */
+		econtext = hjstate->js.ps.ps_ExprContext;
+		econtext->ecxt_outertuple = slot;
+
+		bool hashkeys_null = false;
+		bool keep_nulls = (hjstate->js.jointype == JOIN_LEFT) ||
+				(hjstate->js.jointype == JOIN_LASJ) ||
+				(hjstate->js.jointype == JOIN_LASJ_NOTIN) ||
+				hjstate->hj_nonequijoin;
+		if (ExecHashGetHashValue(hashState, hashtable, econtext,
+								 hjstate->hj_OuterHashKeys,
+								 true,		/* outer tuple */
+								 keep_nulls,
+								 hashvalue,
+								 &hashkeys_null))
+		{
+			/* remember outer relation is not empty for possible rescan */
+			hjstate->hj_OuterNotEmpty = true;
+
+			return slot;
+		}
+
+		/*
+		 * That tuple couldn't match because of a NULL, so discard it and
+		 * continue with the next one.
+		 */
+	}
+}
+
+/*
+ * ExecHashJoinPrefetchOuter
+ *
+ *		like ExecHashJoinFetchOuter, but keeps HJ_PREFETCH_DISTANCE outer
+ *		tuples queued ahead of the one returned, for a radix-partitioned
+ *		hash table.
+ *
+ * Probing a bucket takes a chain of dependent loads: the bucket's offset,
+ * then its entries, then the tuples. As tuples are queued, the offset of
+ * their bucket is prefetched. Half way down the queue, that offset is in
+ * cache and the entries it points to are prefetched in turn. By the time a
+ * tuple is returned, both should be in cache.
+ *
+ * The queue never crosses into a later batch: it is only used while
+ * reading the outer plan, and drains before the caller moves on.
+ */
+static TupleTableSlot *
+ExecHashJoinPrefetchOuter(PlanState *outerNode,
+						  HashJoinState *hjstate,
+						  uint32 *hashvalue)
+{
+	HashJoinTable hashtable = hjstate->hj_HashTable;
+	TupleTableSlot *slot;
+	uint32		hv;
+	int			bucketno;
+	int			batchno;
+	int			idx;
+
+	while (!hjstate->hj_PrefetchDone &&
+		   hjstate->hj_PrefetchCount < HJ_PREFETCH_DISTANCE)
+	{
+		slot = ExecHashJoinFetchOuter(outerNode, hjstate, &hv);
+		if (TupIsNull(slot))
+		{
+			hjstate->hj_PrefetchDone = true;
+			break;
+		}
+
+		idx = (hjstate->hj_PrefetchHead + hjstate->hj_PrefetchCount) % HJ_PREFETCH_DISTANCE;
+		ExecCopySlot(hjstate->hj_PrefetchSlots[idx], slot);
+		hjstate->hj_PrefetchHashValues[idx] = hv;
+		hjstate->hj_PrefetchCount++;
+
+		if (hashtable->radixBuckets != NULL)
+		{
+			ExecHashGetBucketAndBatch(hashtable, hv, &bucketno, &batchno);
+			HJ_PREFETCH(&hashtable->radixBuckets[bucketno]);
+		}
+	}
+
+	if (hjstate->hj_PrefetchCount == 0)
+		return NULL;
+
+	if (hashtable->radixBuckets != NULL &&
+		hjstate->hj_PrefetchCount > HJ_PREFETCH_DISTANCE / 2)
+	{
+		idx = (hjstate->hj_PrefetchHead + HJ_PREFETCH_DISTANCE / 2) % HJ_PREFETCH_DISTANCE;
+		ExecHashGetBucketAndBatch(hashtable, hjstate->hj_PrefetchHashValues[idx],
+								  &bucketno, &batchno);
+		HJ_PREFETCH(&hashtable->radixEntries[hashtable->radixBuckets[bucketno]]);
+	}
+
+	/*
+	 * The slot stays valid until the next call, which is when the caller
+	 * asks for another outer tuple.
+	 */
+	idx = hjstate->hj_PrefetchHead;
+	hjstate->hj_PrefetchHead = (idx + 1) % HJ_PREFETCH_DISTANCE;
+	hjstate->hj_PrefetchCount--;
+	*hashvalue = hjstate->hj_PrefetchHashValues[idx];
+
+	return hjstate->hj_PrefetchSlots[idx];
+}
+
+/*
+ * ExecHashJoinResetPrefetch
+ *
+ *		empty the queue of outer tuples read ahead
+ */
+static void
+ExecHashJoinResetPrefetch(HashJoinState *hjstate)
+{
+	int			i;
+
+	hjstate->hj_PrefetchHead = 0;
+	hjstate->hj_PrefetchCount = 0;
+	hjstate->hj_PrefetchDone = false;
+
+	if (hjstate->hj_PrefetchSlots != NULL)
+	{
+		for (i = 0; i < HJ_PREFETCH_DISTANCE; i++)
+			ExecClearTuple(hjstate->hj_PrefetchSlots[i]);
+	}
+}
+
 /*
  * ExecHashJoinOuterGetTuple
  *
@@ -692,58 +904,17 @@ ExecHashJoinOuterGetTuple(PlanState *outerNode,
 	HashJoinTable hashtable = hjstate->hj_HashTable;
 	int			curbatch = hashtable->curbatch;
 	TupleTableSlot *slot;
-	ExprContext *econtext;
-	HashState  *hashState = (HashState *) innerPlanState(hjstate);
 
 	/* Read tuples from outer relation only if it's the first batch */
 	if (curbatch == 0)
 	{
-		for (;;)
-		{
-			/*
-			 * Check to see if first outer tuple was already fetched by
-			 * ExecHashJoin() and not used yet.
-			 */
-			slot = hjstate->hj_FirstOuterTupleSlot;
-			if (!TupIsNull(slot))
-				hjstate->hj_FirstOuterTupleSlot = NULL;
-			else
-			{
-				slot = ExecProcNode(outerNode);
-			}
-
-			if (TupIsNull(slot))
-				break;
-
-			/*
-			 * We have to compute the tuple's hash value.
-			 */
-			econtext = hjstate->js.ps.ps_ExprContext;
-			econtext->ecxt_outertuple = slot;
-
-			bool hashkeys_null = false;
-			bool keep_nulls = (hjstate->js.jointype == JOIN_LEFT) ||
-					(hjstate->js.jointype == JOIN_LASJ) ||
-					(hjstate->js.jointype == JOIN_LASJ_NOTIN) ||
-					hjstate->hj_nonequijoin;
-			if (ExecHashGetHashValue(hashState, hashtable, econtext,
-									 hjstate->hj_OuterHashKeys,
-									 true,		/* outer tuple */
-									 keep_nulls,
-									 hashvalue,
-									 &hashkeys_null))
-			{
-				/* remember outer relation is not empty for possible rescan */
-				hjstate->hj_OuterNotEmpty = true;
-
-				return slot;
-			}
+		if (hashtable->radix && hjstate->hj_PrefetchSlots != NULL)
+			slot = ExecHashJoinPrefetchOuter(outerNode, hjstate, hashvalue);
+		else
+			slot = ExecHashJoinFetchOuter(outerNode, hjstate, hashvalue);
 
-			/*
-			 * That tuple couldn't match because of a NULL, so discard it and
-			 * continue with the next one.
-			 */
-		}
+		if (!TupIsNull(slot))
+			return slot;
 
 		/*
 		 * We have just reached the end of the first pass. Try to switch to a
@@ -843,6 +1014,22 @@ start_over:
 		}
 		batch->outerside.workfile = NULL;
 	}
+	else if (curbatch == 0 && hashtable->skewEnabled)
+	{
+		/*
+		 * The skew hash table is only used for the first batch, and goes
+		 * away with the batch context when the hash table is reset below.
+		 * Later batches can use its space.
+		 */
+		hashtable->nSkewValues = hashtable->nSkewBuckets;
+		hashtable->skewEnabled = false;
+		hashtable->skewBucket = NULL;
+		hashtable->skewBucketNums = NULL;
+		hashtable->nSkewBuckets = 0;
+		hashtable->spaceUsedSkew = 0;
+		hashtable->spaceAllowed += hashtable->spaceAllowedSkew;
+		hashtable->spaceAllowedSkew = 0;
+	}
 
 	/*
 	 * We can always skip over any batches that are completely empty on both
@@ -959,6 +1146,8 @@ start_over:
 		batch->innerside.workfile = NULL;
 	}
 
+	ExecHashTableFinalize(hashState, hashtable);
+
 	/*
 	 * If there's no outer batch file, advance to next batch.
 	 */
@@ -1159,12 +1348,17 @@ ExecReScanHashJoin(HashJoinState *node, ExprContext *exprCtxt)
 	/* Always reset intra-tuple state */
 	node->hj_CurHashValue = 0;
 	node->hj_CurBucketNo = 0;
+	node->hj_CurSkewBucketNo = INVALID_SKEW_BUCKET_NO;
 	node->hj_CurTuple = NULL;
 
 	node->js.ps.ps_OuterTupleSlot = NULL;
 	node->hj_NeedNewOuter = true;
 	node->hj_MatchedOuter = false;
 	node->hj_FirstOuterTupleSlot = NULL;
+	ExecHashJoinResetPrefetch(node);
+
+	if (node->hj_RuntimeFilter != NULL)
+		ExecResetRuntimeFilter(node->hj_RuntimeFilter);
 
 	/*
 	 * if chgParam of subnode is not null then plan will be re-scanned by
@@ -1201,6 +1395,7 @@ ReleaseHashTable(HashJoinState *node)
 	/* Always reset intra-tuple state */
 	node->hj_CurHashValue = 0;
 	node->hj_CurBucketNo = 0;
+	node->hj_CurSkewBucketNo = INVALID_SKEW_BUCKET_NO;
 	node->hj_CurTuple = NULL;
 
 	node->js.ps.ps_OuterTupleSlot = NULL;
@@ -114,7 +114,7 @@ static void execMotionSortedReceiverFirstTime(MotionState * node);
 
 static int
 CdbMergeComparator(void *lhs, void *rhs, void *context);
-static uint32 evalHashKey(ExprContext *econtext, List *hashkeys, List *hashtypes, CdbHash * h);
+static uint32 evalHashKey(MotionState *node, ExprContext *econtext, List *hashkeys, List *hashtypes, CdbHash * h);
 
 static void doSendEndOfStream(Motion * motion, MotionState * node);
 static void doSendTuple(Motion * motion, MotionState * node, TupleTableSlot *outerTupleSlot);
@@ -374,7 +374,6 @@ execMotionUnsortedReceiver(MotionState * node)
 {
 	/* RECEIVER LOGIC */
 	TupleTableSlot *slot;
-	HeapTuple	tuple;
 	Motion	   *motion = (Motion *) node->ps.plan;
 	ReceiveReturnCode recvRC;
 
@@ -393,9 +392,10 @@ execMotionUnsortedReceiver(MotionState * node)
 		return NULL;
 	}
 
-	recvRC = RecvTupleFrom(node->ps.state->motionlayer_context,
+	slot = node->ps.ps_ResultTupleSlot;
+	recvRC = RecvTupleSlot(node->ps.state->motionlayer_context,
 						   node->ps.state->interconnect_context,
-						   motion->motionID, &tuple, ANY_ROUTE);
+						   motion->motionID, slot);
 
 	if (recvRC == END_OF_STREAM)
 	{
@@ -412,10 +412,6 @@ execMotionUnsortedReceiver(MotionState * node)
     node->numTuplesFromAMS++;
     node->numTuplesToParent++;
 
-    /* store it in our result slot and return this. */
-    slot = node->ps.ps_ResultTupleSlot;
-    slot = ExecStoreGenericTuple(tuple, slot, true /* shouldFree */);
-
 #ifdef CDB_MOTION_DEBUG
     if (node->numTuplesToParent <= 20)
     {
@@ -425,7 +421,7 @@ execMotionUnsortedReceiver(MotionState * node)
         appendStringInfo(&buf, "   motion%-3d rcv      %5d.",
                          motion->motionID,
                          node->numTuplesToParent);
-        formatTuple(&buf, tuple, ExecGetResultType(&node->ps),
+        formatTuple(&buf, ExecFetchSlotHeapTuple(slot), ExecGetResultType(&node->ps),
                     node->outputFunArray);
         elog(DEBUG3, buf.data);
         pfree(buf.data);
@@ -621,6 +617,8 @@ execMotionSortedReceiver_mk(MotionState * node)
     {
         Assert(ctxt->readers); 
         Assert(!ctxt->heap);
+        /* Use the comparator generated for our sort keys, if any */
+        ctxt->mkctxt.compare = get_MKCompare_fn(&node->MKCompare_gen_info);
         ctxt->heap = mkheap_from_reader(ctxt->readers, node->numInputSegs, &ctxt->mkctxt);
         node->tupleheapReady = true;
     }
@@ -1330,10 +1328,8 @@ CdbMergeComparator_DestroyContext(CdbMergeComparatorContext *ctx)
  * Experimental code that will be replaced later with new hashing mechanism
  */
 uint32
-evalHashKey(ExprContext *econtext, List *hashkeys, List *hashtypes, CdbHash * h)
+evalHashKey(MotionState *node, ExprContext *econtext, List *hashkeys, List *hashtypes, CdbHash * h)
 {
-	ListCell   *hk;
-	ListCell   *ht;
 	MemoryContext oldContext;
 
 	ResetExprContext(econtext);
@@ -1350,26 +1346,8 @@ evalHashKey(ExprContext *econtext, List *hashkeys, List *hashtypes, CdbHash * h)
 	 * to assign a hash value for us.
 	 */
 	if (list_length(hashkeys) > 0)
-	{	
-		forboth(hk, hashkeys, ht, hashtypes)
-		{
-			ExprState  *keyexpr = (ExprState *) lfirst(hk);
-			Datum		keyval;
-			bool		isNull;
-			
-			/*
-			 * Get the attribute value of the tuple
-			 */
-			keyval = ExecEvalExpr(keyexpr, econtext, &isNull, NULL);
-			
-			/*
-			 * Compute the hash function
-			 */
-			if (!isNull)			/* treat nulls as having hash key 0 */
-				cdbhash(h, keyval, lfirst_oid(ht));
-			else
-				cdbhashnull(h);
-		}
+	{
+		call_HashMotionKeys(node, econtext, hashkeys, hashtypes, h);
 	}
 	else
 	{
@@ -1381,6 +1359,41 @@ evalHashKey(ExprContext *econtext, List *hashkeys, List *hashtypes, CdbHash * h)
 	return cdbhashreduce(h);
 }
 
+/*
+ * hashMotionKeys
+ *		Add the values of the hash keys of the tuple in econtext to the
+ *		CdbHash.
+ *
+ * The key loop of evalHashKey, kept apart so that a generated version can
+ * be used instead (see HashMotionKeysCodegen).
+ */
+void
+hashMotionKeys(ExprContext *econtext, List *hashkeys, List *hashtypes, CdbHash *h)
+{
+	ListCell   *hk;
+	ListCell   *ht;
+
+	forboth(hk, hashkeys, ht, hashtypes)
+	{
+		ExprState  *keyexpr = (ExprState *) lfirst(hk);
+		Datum		keyval;
+		bool		isNull;
+
+		/*
+		 * Get the attribute value of the tuple
+		 */
+		keyval = ExecEvalExpr(keyexpr, econtext, &isNull, NULL);
+
+		/*
+		 * Compute the hash function
+		 */
+		if (!isNull)			/* treat nulls as having hash key 0 */
+			cdbhash(h, keyval, lfirst_oid(ht));
+		else
+			cdbhashnull(h);
+	}
+}
+
 
 void
 doSendEndOfStream(Motion * motion, MotionState * node)
@@ -1462,7 +1475,7 @@ doSendTuple(Motion * motion, MotionState * node, TupleTableSlot *outerTupleSlot)
 
 		Assert(node->cdbhash->numsegs == motion->numOutputSegs);
 		
-		hval = evalHashKey(econtext, node->hashExpr,
+		hval = evalHashKey(node, econtext, node->hashExpr,
 				motion->hashDataTypes, node->cdbhash);
 
 		Assert(hval < getgpsegmentCount() && "redistribute destination outside segment array");
@@ -1491,19 +1504,30 @@ doSendTuple(Motion * motion, MotionState * node, TupleTableSlot *outerTupleSlot)
 		Assert(!is_null);
 	}
 
-	tuple = ExecFetchSlotGenericTuple(outerTupleSlot, true);
-
 	CheckAndSendRecordCache(node->ps.state->motionlayer_context,
 							node->ps.state->interconnect_context,
 							motion->motionID,
 							targetRoute);
 
 	/* send the tuple out. */
-	sendRC = SendTuple(node->ps.state->motionlayer_context,
-			node->ps.state->interconnect_context,
-			motion->motionID,
-			tuple,
-			targetRoute);
+	if (motion->motionType == MOTIONTYPE_HASH && gp_interconnect_batch_tuples)
+	{
+		tuple = NULL;
+		sendRC = SendTupleBatched(node->ps.state->motionlayer_context,
+				node->ps.state->interconnect_context,
+				motion->motionID,
+				outerTupleSlot,
+				targetRoute);
+	}
+	else
+	{
+		tuple = ExecFetchSlotGenericTuple(outerTupleSlot, true);
+		sendRC = SendTuple(node->ps.state->motionlayer_context,
+				node->ps.state->interconnect_context,
+				motion->motionID,
+				tuple,
+				targetRoute);
+	}
 
 	Assert(sendRC == SEND_COMPLETE || sendRC == STOP_SENDING);
 	if (sendRC == SEND_COMPLETE)
@@ -1514,7 +1538,7 @@ doSendTuple(Motion * motion, MotionState * node, TupleTableSlot *outerTupleSlot)
 
 
 #ifdef CDB_MOTION_DEBUG
-	if (sendRC == SEND_COMPLETE && node->numTuplesToAMS <= 20)
+	if (sendRC == SEND_COMPLETE && tuple != NULL && node->numTuplesToAMS <= 20)
 	{
 		StringInfoData  buf;
 
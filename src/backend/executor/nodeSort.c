@@ -22,6 +22,7 @@
 #include "miscadmin.h"
 #include "utils/tuplesort.h"
 #include "utils/tuplesort_mk.h"
+#include "utils/tuplesort_mk_details.h"
 #include "cdb/cdbvars.h" /* CDB *//* gp_sort_flags */
 #include "utils/workfile_mgr.h"
 #include "executor/instrument.h"
@@ -168,6 +169,9 @@ ExecSort(SortState *node)
 
 		if(gp_enable_mk_sort)
 		{
+			/* Use the comparator generated for our sort keys, if any */
+			tuplesort_set_compare_mk(tuplesortstate_mk,
+									 get_MKCompare_fn(&node->MKCompare_gen_info));
 			if (node->bounded)
 				tuplesort_set_bound_mk(tuplesortstate_mk, node->bound);
 			node->tuplesortstate->sortstore_mk = tuplesortstate_mk;
@@ -8,10 +8,12 @@
 #include "postgres.h"
 
 #include "executor/executor.h"
+#include "executor/instrument.h"
 #include "nodes/execnodes.h"
 #include "executor/nodeTableScan.h"
 #include "utils/elog.h"
 #include "parser/parsetree.h"
+#include "cdb/cdbvars.h"
 
 #define TABLE_SCAN_NSLOTS 2
 
@@ -22,6 +24,30 @@ ExecInitTableScan(TableScan *node, EState *estate, int eflags)
 	state->ss.scan_state = SCAN_INIT;
 
 	InitScanStateInternal((ScanState *)state, (Plan *)node, estate, eflags, true /* initCurrentRelation */);
+
+	/*
+	 * Read AOCS relations a batch at a time if we can. The quals are then
+	 * pushed down into the column reads of each batch, not run by ExecScan.
+	 */
+	if (gp_enable_batch_execution &&
+		state->ss.tableType == TableTypeAOCS &&
+		AOCSScanSupportsBatch((ScanState *)state))
+	{
+		state->batchMode = true;
+		state->ss.ps.qual = NIL;
+	}
+
+	/*
+	 * Otherwise, an AOCS scan can evaluate the quals itself, and only read
+	 * the other columns for the rows that pass them.
+	 */
+	else if (gp_enable_aocs_late_materialization &&
+			 state->ss.tableType == TableTypeAOCS &&
+			 AOCSScanSupportsLateMaterialization((ScanState *)state))
+	{
+		state->lateQual = state->ss.ps.qual;
+		state->ss.ps.qual = NIL;
+	}
 	
 	initGpmonPktForTableScan((Plan *)node, &state->ss.ps.gpmon_pkt, estate);
 
@@ -55,6 +81,48 @@ ExecTableScan(TableScanState *node)
 	return slot;
 }
 
+/*
+ * ExecTableScanBatch
+ *    Batch mode counterpart of ExecTableScan, used by a parent node that
+ * consumes whole batches. Returns the next batch with rows passing the scan
+ * quals, or NULL at the end of the scan.
+ */
+AOCSBatch
+ExecTableScanBatch(TableScanState *node)
+{
+	ScanState *scanState = (ScanState *)node;
+	AOCSBatch batch = NULL;
+
+	Assert(node->batchMode);
+
+	if (scanState->ps.instrument)
+		InstrStartNode(scanState->ps.instrument);
+
+	if (scanState->scan_state == SCAN_INIT ||
+		scanState->scan_state == SCAN_DONE)
+	{
+		BeginTableScanRelation(scanState);
+	}
+
+	if (AOCSScanNextBatch(scanState))
+	{
+		batch = ((AOCSScanState *)node)->opaque->batch;
+
+		GpmonPktFromTableScanState(node)->u.qexec.rowsout += batch->nsel;
+		CheckSendPlanStateGpmonPkt(&scanState->ps);
+	}
+
+	else if (!scanState->ps.delayEagerFree)
+	{
+		EndTableScanRelation(scanState);
+	}
+
+	if (scanState->ps.instrument)
+		InstrStopNode(scanState->ps.instrument, batch ? batch->nsel : 0);
+
+	return batch;
+}
+
 void
 ExecEndTableScan(TableScanState *node)
 {
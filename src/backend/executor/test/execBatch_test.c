@@ -0,0 +1,276 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include "cmockery.h"
+
+#include "c.h"
+#include "postgres.h"
+
+#include <float.h>
+
+#include "../execBatch.c"
+#include "nodes/makefuncs.h"
+#include "utils/array.h"
+#include "utils/builtins.h"
+#include "utils/memutils.h"
+
+#define TEST_NROWS 8
+
+/*
+ * Make a batch with one int4 column (attno 0) and one float8 column
+ * (attno 1), all rows selected. Rows whose position is a multiple of 3
+ * are null.
+ */
+static AOCSBatch
+make_test_batch(void)
+{
+	AOCSBatch batch = (AOCSBatch) palloc0(sizeof(AOCSBatchData));
+
+	batch->ncol = 2;
+	batch->nrows = TEST_NROWS;
+	batch->values = (Datum **) palloc0(sizeof(Datum *) * batch->ncol);
+	batch->isnull = (bool **) palloc0(sizeof(bool *) * batch->ncol);
+	for (int attno = 0; attno < batch->ncol; attno++)
+	{
+		batch->values[attno] = (Datum *) palloc0(sizeof(Datum) * TEST_NROWS);
+		batch->isnull[attno] = (bool *) palloc0(sizeof(bool) * TEST_NROWS);
+	}
+	batch->sel = (int *) palloc(sizeof(int) * TEST_NROWS);
+	batch->npreds = (int *) palloc0(sizeof(int) * batch->ncol);
+	batch->preds = (DatumStreamPredicate **) palloc0(sizeof(DatumStreamPredicate *) * batch->ncol);
+
+	for (int row = 0; row < TEST_NROWS; row++)
+	{
+		batch->values[0][row] = Int32GetDatum(row * 10);
+		batch->values[1][row] = Float8GetDatum(row * 0.5);
+		batch->isnull[0][row] = (row % 3 == 0);
+		batch->isnull[1][row] = (row % 3 == 0);
+		batch->sel[row] = row;
+	}
+	batch->nsel = TEST_NROWS;
+
+	return batch;
+}
+
+/* ==================== batch_qual_from_expr ==================== */
+/*
+ * Make a tuple descriptor with a single int4 column.
+ */
+static TupleDesc
+make_test_tupdesc(void)
+{
+	TupleDesc tupdesc = CreateTemplateTupleDesc(1, false);
+
+	tupdesc->attrs[0]->atttypid = INT4OID;
+	tupdesc->attrs[0]->attlen = sizeof(int32);
+	tupdesc->attrs[0]->attbyval = true;
+	tupdesc->attrs[0]->attalign = 'i';
+
+	return tupdesc;
+}
+
+static OpExpr *
+make_test_opexpr(Oid opfuncid, Node *leftop, Node *rightop)
+{
+	OpExpr *opexpr = makeNode(OpExpr);
+
+	opexpr->opfuncid = opfuncid;
+	opexpr->args = list_make2(leftop, rightop);
+
+	return opexpr;
+}
+
+/*
+ * Test that "const < col" is turned into "col > const".
+ */
+void
+test__batch_qual_from_expr__commute(void **state)
+{
+	TupleDesc tupdesc = make_test_tupdesc();
+	Var *var = makeVar(1, 1, INT4OID, -1, 0);
+	Const *con = makeConst(INT4OID, -1, sizeof(int32), Int32GetDatum(7),
+						   false, true);
+	OpExpr *opexpr = make_test_opexpr(F_INT4LT, (Node *) con, (Node *) var);
+	DatumStreamPredicate pred;
+	int attno;
+
+	assert_true(batch_qual_from_expr((Expr *) opexpr, 1, tupdesc, &attno, &pred));
+	assert_int_equal(attno, 0);
+	assert_int_equal(pred.type, DatumStreamPredicateType_Int4);
+	assert_int_equal(pred.op, DatumStreamPredicateOp_Gt);
+	assert_int_equal(DatumGetInt32(pred.value), 7);
+
+	/* a column of another range table entry is not supported */
+	assert_false(batch_qual_from_expr((Expr *) opexpr, 2, tupdesc, &attno, &pred));
+}
+
+/*
+ * Test that a comparison with a NaN constant is not pushed down.
+ */
+void
+test__batch_qual_from_expr__float8_nan(void **state)
+{
+	TupleDesc tupdesc = make_test_tupdesc();
+	Var *var = makeVar(1, 1, FLOAT8OID, -1, 0);
+	Const *con = makeConst(FLOAT8OID, -1, sizeof(float8),
+						   Float8GetDatum(get_float8_nan()), false, FLOAT8PASSBYVAL);
+	OpExpr *opexpr = make_test_opexpr(F_FLOAT8GT, (Node *) var, (Node *) con);
+	DatumStreamPredicate pred;
+	int attno;
+
+	tupdesc->attrs[0]->atttypid = FLOAT8OID;
+	tupdesc->attrs[0]->attlen = sizeof(float8);
+	tupdesc->attrs[0]->attbyval = FLOAT8PASSBYVAL;
+	tupdesc->attrs[0]->attalign = 'd';
+
+	assert_false(batch_qual_from_expr((Expr *) opexpr, 1, tupdesc, &attno, &pred));
+
+	con->constvalue = Float8GetDatum(1.5);
+	assert_true(batch_qual_from_expr((Expr *) opexpr, 1, tupdesc, &attno, &pred));
+	assert_int_equal(pred.type, DatumStreamPredicateType_Float8);
+	assert_int_equal(pred.op, DatumStreamPredicateOp_Gt);
+}
+
+/*
+ * Test that "col = ANY ('{3, NULL, 5}')" becomes an IN predicate without the
+ * null element.
+ */
+void
+test__batch_qual_from_expr__in_list(void **state)
+{
+	TupleDesc tupdesc = make_test_tupdesc();
+	Datum elems[3] = {Int32GetDatum(3), (Datum) 0, Int32GetDatum(5)};
+	bool nulls[3] = {false, true, false};
+	int dims[1] = {3};
+	int lbs[1] = {1};
+	ArrayType *array = construct_md_array(elems, nulls, 1, dims, lbs, INT4OID,
+										  sizeof(int32), true, 'i');
+	Var *var = makeVar(1, 1, INT4OID, -1, 0);
+	Const *con = makeConst(INT4ARRAYOID, -1, -1, PointerGetDatum(array),
+						   false, false);
+	ScalarArrayOpExpr *saop = makeNode(ScalarArrayOpExpr);
+	DatumStreamPredicate pred;
+	int attno;
+
+	saop->opfuncid = F_INT4EQ;
+	saop->useOr = true;
+	saop->args = list_make2(var, con);
+
+	assert_true(batch_qual_from_expr((Expr *) saop, 1, tupdesc, &attno, &pred));
+	assert_int_equal(attno, 0);
+	assert_int_equal(pred.op, DatumStreamPredicateOp_In);
+	assert_int_equal(pred.nInValues, 2);
+	assert_int_equal(DatumGetInt32(pred.inValues[0]), 3);
+	assert_int_equal(DatumGetInt32(pred.inValues[1]), 5);
+
+	/* "col <> ALL (...)" is not supported */
+	saop->useOr = false;
+	assert_false(batch_qual_from_expr((Expr *) saop, 1, tupdesc, &attno, &pred));
+}
+
+/* ==================== ExecPushDownBatchQual ==================== */
+/*
+ * Test that "col >= 10 AND 20 >= col" is pushed down as a single BETWEEN
+ * predicate.
+ */
+void
+test__ExecPushDownBatchQual__between(void **state)
+{
+	TupleDesc tupdesc = make_test_tupdesc();
+	AOCSBatch batch = make_test_batch();
+	Var *var = makeVar(1, 1, INT4OID, -1, 0);
+	Const *lo = makeConst(INT4OID, -1, sizeof(int32), Int32GetDatum(10),
+						  false, true);
+	Const *hi = makeConst(INT4OID, -1, sizeof(int32), Int32GetDatum(20),
+						  false, true);
+	List *qual = list_make2(make_test_opexpr(F_INT4GE, (Node *) var, (Node *) lo),
+							make_test_opexpr(F_INT4GE, (Node *) hi, (Node *) var));
+
+	assert_true(ExecSupportsBatchQual(qual, 1, tupdesc));
+
+	ExecPushDownBatchQual(qual, 1, tupdesc, batch);
+
+	assert_int_equal(batch->npreds[0], 1);
+	assert_int_equal(batch->npreds[1], 0);
+	assert_int_equal(batch->preds[0][0].op, DatumStreamPredicateOp_Between);
+	assert_int_equal(DatumGetInt32(batch->preds[0][0].value), 10);
+	assert_int_equal(DatumGetInt32(batch->preds[0][0].value2), 20);
+}
+
+/* ==================== batch_advance_agg ==================== */
+/*
+ * Test the accumulators over the non-null selected rows: 1, 2, 4, 5 and 7.
+ */
+void
+test__batch_advance_agg__accumulators(void **state)
+{
+	AOCSBatch batch = make_test_batch();
+	BatchAgg count_star = {BATCH_AGG_COUNT_STAR, BATCH_TYPE_INT4, -1};
+	BatchAgg count = {BATCH_AGG_COUNT, BATCH_TYPE_INT4, 0};
+	BatchAgg sum = {BATCH_AGG_SUM, BATCH_TYPE_INT4, 0};
+	BatchAgg min = {BATCH_AGG_MIN, BATCH_TYPE_INT4, 0};
+	BatchAgg max = {BATCH_AGG_MAX, BATCH_TYPE_FLOAT8, 1};
+	BatchAgg avg = {BATCH_AGG_AVG, BATCH_TYPE_FLOAT8, 1};
+
+	batch_advance_agg(&count_star, batch);
+	batch_advance_agg(&count, batch);
+	batch_advance_agg(&sum, batch);
+	batch_advance_agg(&min, batch);
+	batch_advance_agg(&max, batch);
+	batch_advance_agg(&avg, batch);
+
+	assert_int_equal(count_star.count, TEST_NROWS);
+	assert_int_equal(count.count, 5);
+	assert_int_equal(sum.isum, 190);
+	assert_int_equal(min.imin_max, 10);
+	assert_true(max.fmin_max == 3.5);
+	assert_int_equal(avg.count, 5);
+	assert_true(avg.fsum == 9.5);
+}
+
+/*
+ * Test that a float8 sum that overflows raises an error, like float8pl().
+ */
+void
+test__batch_advance_agg__float8_sum_overflow(void **state)
+{
+	AOCSBatch batch = make_test_batch();
+	BatchAgg sum = {BATCH_AGG_SUM, BATCH_TYPE_FLOAT8, 1};
+
+	batch->values[1][1] = Float8GetDatum(DBL_MAX);
+	batch->values[1][2] = Float8GetDatum(DBL_MAX);
+
+	PG_TRY();
+	{
+		batch_advance_agg(&sum, batch);
+	}
+	PG_CATCH();
+	{
+		FlushErrorState();
+		return;
+	}
+	PG_END_TRY();
+
+	/* We shouldn't get here, the sum should have overflowed */
+	assert_true(false);
+}
+
+/* ==================== main ==================== */
+int
+main(int argc, char* argv[])
+{
+	cmockery_parse_arguments(argc, argv);
+
+	const UnitTest tests[] = {
+		unit_test(test__batch_qual_from_expr__commute),
+		unit_test(test__batch_qual_from_expr__float8_nan),
+		unit_test(test__batch_qual_from_expr__in_list),
+		unit_test(test__ExecPushDownBatchQual__between),
+		unit_test(test__batch_advance_agg__accumulators),
+		unit_test(test__batch_advance_agg__float8_sum_overflow)
+	};
+
+	MemoryContextInit();
+
+	return run_tests(tests);
+}
@@ -0,0 +1,235 @@
+/*
+ * execHHashagg_bench.c
+ *
+ * Microbenchmark of the lookups in the hash aggregate table, comparing the
+ * chained hash table with the open addressing one
+ * (gp_enable_hashagg_open_addressing).
+ *
+ * Each run groups the same input, one int4 grouping column without
+ * aggregates, starting from a small table that has to grow. It is not
+ * part of the unit tests; run it with the bench target, e.g.
+ * make bench BENCH_ARGS="--rows 10000000 --groups 100000"
+ */
+#include "postgres.h"
+
+#include <sys/time.h>
+
+/* Ignore elog */
+#include "utils/elog.h"
+#undef elog
+#define elog
+
+#include "../execHHashagg.c"
+
+#include "catalog/pg_type.h"
+#include "utils/builtins.h"
+#include "utils/fmgroids.h"
+
+#define BENCH_INITIAL_NBUCKETS 1024
+
+static const unsigned default_groups[] = {1000, 100000, 1000000};
+
+/*
+ * Set up the parts of the AggState used by lookup_agg_hash_entry.
+ */
+static void
+init_bench_aggstate(AggState *aggstate)
+{
+	Agg *agg = palloc0(sizeof(Agg));
+	TupleDesc tupdesc;
+
+	agg->aggstrategy = AGG_HASHED;
+	agg->numCols = 1;
+	agg->grpColIdx = palloc(sizeof(AttrNumber));
+	agg->grpColIdx[0] = 1;
+	aggstate->ss.ps.plan = (Plan *) agg;
+
+	tupdesc = CreateTemplateTupleDesc(1, false);
+	TupleDescInitEntry(tupdesc, 1, "a", INT4OID, -1, 0);
+	aggstate->hashslot = palloc0(sizeof(TupleTableSlot));
+	aggstate->hashslot->tts_mt_bind = create_memtuple_binding(tupdesc);
+	aggstate->hash_needed = list_make1_int(1);
+	aggstate->numaggs = 0;
+
+	/* fmgrtab is not linked in; set up the equality function by hand */
+	aggstate->eqfunctions = palloc0(sizeof(FmgrInfo));
+	aggstate->eqfunctions[0].fn_addr = int4eq;
+	aggstate->eqfunctions[0].fn_oid = F_INT4EQ;
+	aggstate->eqfunctions[0].fn_nargs = 2;
+	aggstate->eqfunctions[0].fn_strict = true;
+	aggstate->eqfunctions[0].fn_mcxt = CurrentMemoryContext;
+
+	aggstate->tmpcontext = palloc0(sizeof(ExprContext));
+	aggstate->tmpcontext->ecxt_per_tuple_memory =
+		AllocSetContextCreate(TopMemoryContext,
+							  "BenchPerTupleContext",
+							  ALLOCSET_DEFAULT_MINSIZE,
+							  ALLOCSET_DEFAULT_INITSIZE,
+							  ALLOCSET_DEFAULT_MAXSIZE);
+}
+
+/*
+ * Create an empty table of BENCH_INITIAL_NBUCKETS buckets in the given mode.
+ */
+static void
+init_bench_hashtable(AggState *aggstate, bool open_addressing)
+{
+	HashAggTable *hashtable;
+
+	aggstate->aggcontext =
+		AllocSetContextCreate(TopMemoryContext,
+							  "BenchAggContext",
+							  ALLOCSET_DEFAULT_MINSIZE,
+							  ALLOCSET_DEFAULT_INITSIZE,
+							  ALLOCSET_DEFAULT_MAXSIZE);
+
+	hashtable = MemoryContextAllocZero(aggstate->aggcontext, sizeof(HashAggTable));
+	hashtable->entry_cxt = aggstate->aggcontext;
+	hashtable->group_buf = mpool_create(hashtable->entry_cxt, "BenchGroupsContext");
+	hashtable->max_mem = 4.0 * 1024 * 1024 * 1024;
+	hashtable->expandable = true;
+	hashtable->open_addressing = open_addressing;
+	hashtable->nbuckets = BENCH_INITIAL_NBUCKETS;
+	hashtable->mem_for_metadata = hashtable->nbuckets * OVERHEAD_PER_BUCKET;
+	hashtable->buckets = MemoryContextAllocZero(aggstate->aggcontext,
+												hashtable->nbuckets * sizeof(HashAggBucket));
+	if (open_addressing)
+		hashtable->tags = MemoryContextAllocZero(aggstate->aggcontext,
+												 hashtable->nbuckets * sizeof(uint8));
+	else
+		hashtable->bloom = MemoryContextAllocZero(aggstate->aggcontext,
+												  hashtable->nbuckets * sizeof(uint64));
+
+	aggstate->hhashtable = hashtable;
+}
+
+static double
+elapsed_ms(struct timeval *start, struct timeval *end)
+{
+	return (end->tv_sec - start->tv_sec) * 1000.0 +
+		(end->tv_usec - start->tv_usec) / 1000.0;
+}
+
+/*
+ * Look up rows input records, cycling over ngroups distinct keys, and
+ * print the time it took.
+ */
+static void
+run_bench(AggState *aggstate, bool open_addressing, unsigned ngroups,
+		  unsigned rows, MemTuple *inputs, int32 *input_sizes, uint32 *hashkeys)
+{
+	struct timeval start;
+	struct timeval end;
+	uint64 nnew = 0;
+	unsigned i;
+
+	init_bench_hashtable(aggstate, open_addressing);
+
+	gettimeofday(&start, NULL);
+	for (i = 0; i < rows; i++)
+	{
+		/* Scatter the keys so that consecutive rows hit different groups */
+		unsigned k = (unsigned) (((uint64) i * 2654435761U) % ngroups);
+		bool isnew;
+		HashAggEntry *entry;
+
+		entry = lookup_agg_hash_entry(aggstate, inputs[k],
+									  INPUT_RECORD_GROUP_AND_AGGS,
+									  input_sizes[k], hashkeys[k], &isnew);
+		if (entry == NULL)
+		{
+			fprintf(stderr, "hash table ran out of memory\n");
+			exit(1);
+		}
+		if (isnew)
+			nnew++;
+	}
+	gettimeofday(&end, NULL);
+
+	printf("%-16s groups %9u  rows %10u  buckets %9u  expansions %2u  %9.1f ms  %6.1f ns/row\n",
+		   open_addressing ? "open addressing" : "chained",
+		   ngroups, rows, aggstate->hhashtable->nbuckets,
+		   aggstate->hhashtable->num_expansions,
+		   elapsed_ms(&start, &end),
+		   elapsed_ms(&start, &end) * 1000000.0 / rows);
+
+	if (nnew != Min(ngroups, rows))
+	{
+		fprintf(stderr, "found " UINT64_FORMAT " groups, expected %u\n",
+				nnew, Min(ngroups, rows));
+		exit(1);
+	}
+
+	MemoryContextDelete(aggstate->aggcontext);
+	aggstate->hhashtable = NULL;
+}
+
+static void
+bench_groups(AggState *aggstate, unsigned ngroups, unsigned rows)
+{
+	MemTupleBinding *mt_bind = aggstate->hashslot->tts_mt_bind;
+	MemTuple *inputs = palloc(ngroups * sizeof(MemTuple));
+	int32 *input_sizes = palloc(ngroups * sizeof(int32));
+	uint32 *hashkeys = palloc(ngroups * sizeof(uint32));
+	unsigned k;
+
+	/* The input records, in the format written to the spill files */
+	for (k = 0; k < ngroups; k++)
+	{
+		Datum value = Int32GetDatum((int32) k);
+		bool isnull = false;
+		uint32 len = 0;
+
+		(void) memtuple_form_to(mt_bind, &value, &isnull, NULL, &len, false);
+		inputs[k] = palloc0(MAXALIGN(len));
+		(void) memtuple_form_to(mt_bind, &value, &isnull, inputs[k], &len, false);
+		input_sizes[k] = MAXALIGN(len);
+		hashkeys[k] = DatumGetUInt32(hash_uint32((uint32) k));
+	}
+
+	run_bench(aggstate, false, ngroups, rows, inputs, input_sizes, hashkeys);
+	run_bench(aggstate, true, ngroups, rows, inputs, input_sizes, hashkeys);
+
+	for (k = 0; k < ngroups; k++)
+		pfree(inputs[k]);
+	pfree(inputs);
+	pfree(input_sizes);
+	pfree(hashkeys);
+}
+
+int
+main(int argc, char *argv[])
+{
+	AggState aggstate;
+	unsigned rows = 10000000;
+	unsigned ngroups = 0;
+	int i;
+
+	for (i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--rows") == 0 && i + 1 < argc)
+			rows = (unsigned) strtoul(argv[++i], NULL, 10);
+		else if (strcmp(argv[i], "--groups") == 0 && i + 1 < argc)
+			ngroups = (unsigned) strtoul(argv[++i], NULL, 10);
+		else
+		{
+			fprintf(stderr, "usage: %s [--rows N] [--groups N]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	MemoryContextInit();
+
+	MemSet(&aggstate, 0, sizeof(aggstate));
+	init_bench_aggstate(&aggstate);
+
+	if (ngroups > 0)
+		bench_groups(&aggstate, ngroups, rows);
+	else
+	{
+		for (i = 0; i < lengthof(default_groups); i++)
+			bench_groups(&aggstate, default_groups[i], rows);
+	}
+
+	return 0;
+}
@@ -200,6 +200,115 @@ test__destroy_agg_hash_table__check_for_leaks(void **state)
 	assert_true(aggState.hhashtable == NULL);
 }
 
+/* ==================== expand_hash_table ==================== */
+/*
+ * Test that expanding an open addressing hash table keeps every entry,
+ * each in a slot of its probe sequence with the tag of its hash key.
+ */
+void
+test__expand_hash_table__open_addressing(void **state)
+{
+#define NUM_SLOTS 32
+#define NUM_ENTRIES 28
+	AggState aggState;
+	HashAggTable *ht;
+	HashAggEntry entries[NUM_ENTRIES];
+	int i;
+	int j;
+	int nfilled = 0;
+
+	aggState.aggcontext =
+		AllocSetContextCreate(TopMemoryContext,
+							  "AggContext",
+							  ALLOCSET_DEFAULT_MINSIZE,
+							  ALLOCSET_DEFAULT_INITSIZE,
+							  ALLOCSET_DEFAULT_MAXSIZE);
+
+	ht = MemoryContextAllocZero(aggState.aggcontext, sizeof(HashAggTable));
+	aggState.hhashtable = ht;
+	ht->entry_cxt = aggState.aggcontext;
+	ht->group_buf = mpool_create(ht->entry_cxt, "GroupsAndAggs Context");
+	ht->max_mem = 1024 * 1024;
+	ht->mem_for_metadata = NUM_SLOTS * OVERHEAD_PER_BUCKET;
+	ht->expandable = true;
+	ht->open_addressing = true;
+	ht->nbuckets = NUM_SLOTS;
+	ht->buckets = MemoryContextAllocZero(aggState.aggcontext, NUM_SLOTS * sizeof(HashAggBucket));
+	ht->tags = MemoryContextAllocZero(aggState.aggcontext, NUM_SLOTS * sizeof(uint8));
+
+	/* Half of the entries share a bucket, so that they fill several groups */
+	for (i = 0; i < NUM_ENTRIES; i++)
+	{
+		entries[i].next = NULL;
+		entries[i].hashvalue = (i % 2 == 0) ? (uint32) (i << 25) | 3 : (uint32) (i * 0x9e3779b9);
+		insert_agg_hash_slot(ht, &entries[i]);
+		ht->num_entries++;
+	}
+	assert_true(ht->num_entries >= MAX_FILLED_SLOTS(ht));
+
+	expand_hash_table(&aggState);
+
+	assert_int_equal(ht->nbuckets, 2 * NUM_SLOTS);
+	assert_int_equal(ht->num_expansions, 1);
+
+	for (i = 0; i < ht->nbuckets; i++)
+	{
+		if (ht->tags[i] == 0)
+			continue;
+
+		nfilled++;
+		assert_true(ht->tags[i] == SLOT_TAG(ht->buckets[i]->hashvalue));
+	}
+	assert_int_equal(nfilled, NUM_ENTRIES);
+
+	for (i = 0; i < NUM_ENTRIES; i++)
+	{
+		bool found = false;
+
+		for (j = 0; j < ht->nbuckets; j++)
+			found = found || (ht->buckets[j] == &entries[i]);
+		assert_true(found);
+	}
+
+	MemoryContextDelete(aggState.aggcontext);
+}
+
+/* ==================== agg_hash_check_reduction ==================== */
+/*
+ * Test that a streaming lower phase switches to pass-through mode only
+ * when its input rows make too many groups.
+ */
+void
+test__agg_hash_check_reduction__passthrough(void **state)
+{
+	AggState aggState;
+	Agg agg;
+	HashAggTable ht;
+
+	MemSet(&agg, 0, sizeof(agg));
+	MemSet(&ht, 0, sizeof(ht));
+	agg.streaming = true;
+	aggState.ss.ps.plan = (Plan *) &agg;
+	aggState.hhashtable = &ht;
+	ht.num_ht_groups = 1000;
+
+	/* Disabled by default */
+	gp_hashagg_streambottom_min_reduction = 0;
+	agg_hash_check_reduction(&aggState, 1100);
+	assert_false(ht.passthrough);
+
+	/* 10 rows per group is a good enough reduction */
+	gp_hashagg_streambottom_min_reduction = 2;
+	agg_hash_check_reduction(&aggState, 10000);
+	assert_false(ht.passthrough);
+
+	/* 1.1 rows per group is not */
+	agg_hash_check_reduction(&aggState, 1100);
+	assert_true(ht.passthrough);
+
+	gp_hashagg_streambottom_min_reduction = 0;
+}
+
 /* ==================== main ==================== */
 int
 main(int argc, char* argv[])
@@ -209,7 +318,9 @@ main(int argc, char* argv[])
 	const UnitTest tests[] = {
 		unit_test(test__getSpillFile__Initialize_wfile_success),
 		unit_test(test__getSpillFile__Initialize_wfile_exception),
-		unit_test(test__destroy_agg_hash_table__check_for_leaks)
+		unit_test(test__destroy_agg_hash_table__check_for_leaks),
+		unit_test(test__expand_hash_table__open_addressing),
+		unit_test(test__agg_hash_check_reduction__passthrough)
 	};
 
 	MemoryContextInit();
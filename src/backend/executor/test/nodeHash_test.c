@@ -0,0 +1,203 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include "cmockery.h"
+
+#include "c.h"
+#include "postgres.h"
+
+#include "../nodeHash.c"
+
+#define TEST_FILTER_BITS (1 << 16)
+
+static HashJoinTable
+make_test_hashtable(void)
+{
+	HashJoinTable hashtable = (HashJoinTable) palloc0(sizeof(HashJoinTableData));
+
+	hashtable->runtimeFilter = (uint64 *) palloc0(TEST_FILTER_BITS / 8);
+	hashtable->runtimeFilterMask = TEST_FILTER_BITS - 1;
+
+	return hashtable;
+}
+
+/* ==================== RuntimeFilterMayContain ==================== */
+/*
+ * Test that every hash value added is found, and that most of the others
+ * are not.
+ */
+void
+test__RuntimeFilterMayContain__no_false_negatives(void **state)
+{
+	HashJoinTable hashtable = make_test_hashtable();
+	int nfound = 0;
+	uint32 hv;
+
+	for (hv = 0; hv < 1000; hv++)
+		RuntimeFilterAdd(hashtable, hv * 2654435761U);
+
+	for (hv = 0; hv < 1000; hv++)
+		assert_true(RuntimeFilterMayContain(hashtable, hv * 2654435761U));
+
+	for (hv = 1000; hv < 11000; hv++)
+		nfound += RuntimeFilterMayContain(hashtable, hv * 2654435761U);
+
+	/* 1000 values in 64k bits with 3 hashes: well under 1% false positives */
+	assert_true(nfound < 100);
+}
+
+/* ==================== ExecSupportsRuntimeFilter ==================== */
+/*
+ * Test that only inner and IN joins over a scan get a runtime filter.
+ */
+void
+test__ExecSupportsRuntimeFilter__join_types(void **state)
+{
+	HashJoinState *hjstate = makeNode(HashJoinState);
+
+	outerPlanState(hjstate) = (PlanState *) makeNode(TableScanState);
+
+	hjstate->js.jointype = JOIN_INNER;
+	assert_true(ExecSupportsRuntimeFilter(hjstate));
+
+	hjstate->js.jointype = JOIN_IN;
+	assert_true(ExecSupportsRuntimeFilter(hjstate));
+
+	/* unmatched outer rows are returned */
+	hjstate->js.jointype = JOIN_LEFT;
+	assert_false(ExecSupportsRuntimeFilter(hjstate));
+	hjstate->js.jointype = JOIN_LASJ;
+	assert_false(ExecSupportsRuntimeFilter(hjstate));
+
+	/* the outer side is not a scan */
+	hjstate->js.jointype = JOIN_INNER;
+	outerPlanState(hjstate) = (PlanState *) makeNode(MotionState);
+	assert_false(ExecSupportsRuntimeFilter(hjstate));
+}
+
+/* ==================== ExecResetRuntimeFilter ==================== */
+/*
+ * Test that a filter disabled for removing too few rows is sampled again
+ * after a rescan, while the totals keep counting.
+ */
+void
+test__ExecResetRuntimeFilter__resample(void **state)
+{
+	RuntimeFilterState *rf = (RuntimeFilterState *) palloc0(sizeof(RuntimeFilterState));
+
+	/* as left by a scan that sampled the filter and gave up on it */
+	rf->nchecked = rf->nsampled = RUNTIME_FILTER_SAMPLE_ROWS;
+	rf->nremoved = rf->nsampleRemoved = 1;
+	rf->disabled = true;
+
+	ExecResetRuntimeFilter(rf);
+
+	assert_false(rf->disabled);
+	assert_int_equal(rf->nsampled, 0);
+	assert_int_equal(rf->nsampleRemoved, 0);
+	assert_int_equal(rf->nchecked, RUNTIME_FILTER_SAMPLE_ROWS);
+	assert_int_equal(rf->nremoved, 1);
+}
+
+/* ==================== ExecHashTableFinalize ==================== */
+/*
+ * Test that the entries of a radix-mode hash table end up grouped by
+ * bucket, each bucket keeping its entries in insertion order.
+ */
+void
+test__ExecHashTableFinalize__radix_partition(void **state)
+{
+	HashState *hashState = makeNode(HashState);
+	HashJoinTable hashtable = (HashJoinTable) palloc0(sizeof(HashJoinTableData));
+	HashJoinTupleData tuples[100];
+	uint32 entryno;
+	int bucketno;
+
+	hashState->ps.plan = (Plan *) makeNode(Hash);
+
+	hashtable->radix = true;
+	hashtable->nbuckets = 32;
+	hashtable->log2_nbuckets = 5;
+	hashtable->batchCxt = CurrentMemoryContext;
+
+	for (entryno = 0; entryno < 100; entryno++)
+	{
+		tuples[entryno].hashvalue = (entryno * 2654435761U) ^ (entryno << 8);
+		ExecHashRadixAppend(hashtable, tuples[entryno].hashvalue, &tuples[entryno]);
+	}
+
+	ExecHashTableFinalize(hashState, hashtable);
+
+	assert_true(hashtable->radixBuckets != NULL);
+	assert_int_equal(hashtable->radixBuckets[0], 0);
+	assert_int_equal(hashtable->radixBuckets[32], 100);
+
+	for (bucketno = 0; bucketno < 32; bucketno++)
+	{
+		HashJoinTuple prev = NULL;
+
+		for (entryno = hashtable->radixBuckets[bucketno];
+			 entryno < hashtable->radixBuckets[bucketno + 1]; entryno++)
+		{
+			HashJoinRadixEntry *entry = &hashtable->radixEntries[entryno];
+
+			assert_int_equal(entry->hashvalue & 31, bucketno);
+			assert_true(entry->tuple->hashvalue == entry->hashvalue);
+			assert_true(prev == NULL || prev < entry->tuple);
+			prev = entry->tuple;
+		}
+	}
+}
+
+/* ==================== ExecHashGetSkewBucket ==================== */
+/*
+ * Test that colliding hash values get their own skew buckets, and that
+ * removing the last one created leaves the others reachable.
+ */
+void
+test__ExecHashGetSkewBucket__collisions(void **state)
+{
+	HashJoinTable hashtable = (HashJoinTable) palloc0(sizeof(HashJoinTableData));
+	HashSkewBucket buckets[3] = {{1, NULL}, {9, NULL}, {4, NULL}};
+
+	hashtable->skewBucketLen = 8;
+	hashtable->skewBucket = (HashSkewBucket **) palloc0(8 * sizeof(HashSkewBucket *));
+
+	/* not enabled */
+	assert_int_equal(ExecHashGetSkewBucket(hashtable, 1), INVALID_SKEW_BUCKET_NO);
+
+	/* 9 collides with 1, and goes to the next free slot */
+	hashtable->skewEnabled = true;
+	hashtable->skewBucket[1] = &buckets[0];
+	hashtable->skewBucket[2] = &buckets[1];
+	hashtable->skewBucket[4] = &buckets[2];
+
+	assert_int_equal(ExecHashGetSkewBucket(hashtable, 1), 1);
+	assert_int_equal(ExecHashGetSkewBucket(hashtable, 9), 2);
+	assert_int_equal(ExecHashGetSkewBucket(hashtable, 4), 4);
+	assert_int_equal(ExecHashGetSkewBucket(hashtable, 17), INVALID_SKEW_BUCKET_NO);
+	assert_int_equal(ExecHashGetSkewBucket(hashtable, 5), INVALID_SKEW_BUCKET_NO);
+
+	hashtable->skewBucket[2] = NULL;
+	assert_int_equal(ExecHashGetSkewBucket(hashtable, 1), 1);
+	assert_int_equal(ExecHashGetSkewBucket(hashtable, 9), INVALID_SKEW_BUCKET_NO);
+}
+
+/* ==================== main ==================== */
+int
+main(int argc, char* argv[])
+{
+	cmockery_parse_arguments(argc, argv);
+
+	const UnitTest tests[] = {
+		unit_test(test__RuntimeFilterMayContain__no_false_negatives),
+		unit_test(test__ExecSupportsRuntimeFilter__join_types),
+		unit_test(test__ExecResetRuntimeFilter__resample),
+		unit_test(test__ExecHashTableFinalize__radix_partition),
+		unit_test(test__ExecHashGetSkewBucket__collisions)
+	};
+
+	MemoryContextInit();
+
+	return run_tests(tests);
+}
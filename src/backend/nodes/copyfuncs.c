@@ -1074,6 +1074,7 @@ _copyHash(Hash *from)
 	/*
 	 * copy remainder of node
 	 */
+	COPY_NODE_FIELD(skewValues);
 
 	return newnode;
 }
@@ -957,6 +957,7 @@ _outHash(StringInfo str, Hash *node)
 
 	_outPlanInfo(str, (Plan *) node);
 	WRITE_BOOL_FIELD(rescannable);          /*CDB*/
+	WRITE_NODE_FIELD(skewValues);           /*CDB*/
 }
 
 #ifndef COMPILING_BINARY_FUNCS
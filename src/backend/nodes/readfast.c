@@ -2145,6 +2145,7 @@ _readHash(void)
 
 	readPlanInfo((Plan *)local_node);
     READ_BOOL_FIELD(rescannable);           /*CDB*/
+    READ_NODE_FIELD(skewValues);            /*CDB*/
 
 	READ_DONE();
 }
@@ -20,9 +20,11 @@
 #include <limits.h>
 
 #include "catalog/pg_type.h"	/* INT8OID */
+#include "catalog/pg_statistic.h"
 #include "access/skey.h"
 #include "nodes/makefuncs.h"
 #include "executor/execHHashagg.h"
+#include "executor/hashjoin.h"	/* SKEW_MIN_OUTER_FRACTION */
 #include "optimizer/clauses.h"
 #include "optimizer/cost.h"
 #include "optimizer/pathnode.h"
@@ -37,7 +39,10 @@
 #include "parser/parse_expr.h"
 #include "parser/parsetree.h"
 #include "parser/parse_oper.h"	/* ordering_oper_opid */
+#include "utils/datum.h"
 #include "utils/lsyscache.h"
+#include "utils/selfuncs.h"
+#include "utils/syscache.h"
 #include "utils/uri.h"
 
 #include "cdb/cdbllize.h"		/* pull_up_Flow() */
@@ -101,6 +106,7 @@ static MergeJoin *create_mergejoin_plan(PlannerInfo *root, MergePath *best_path,
 					  Plan *outer_plan, Plan *inner_plan);
 static HashJoin *create_hashjoin_plan(PlannerInfo *root, HashPath *best_path,
 					 Plan *outer_plan, Plan *inner_plan);
+static List *get_hash_skew_values(PlannerInfo *root, List *hashclauses);
 static void fix_indexqual_references(List *indexquals, IndexPath *index_path,
 						 List **fixed_indexquals,
 						 List **nonlossy_indexquals,
@@ -3349,6 +3355,7 @@ create_hashjoin_plan(PlannerInfo *root,
 	 * Build the hash node and hash join node.
 	 */
 	hash_plan = make_hash(inner_plan);
+	hash_plan->skewValues = get_hash_skew_values(root, hashclauses);
 	join_plan = make_hashjoin(tlist,
 							  joinclauses,
 							  otherclauses,
@@ -4353,6 +4360,70 @@ make_hashjoin(List *tlist,
 	return node;
 }
 
+/*
+ * get_hash_skew_values
+ *	  Get the most common values of the outer key of a hash join, most common
+ *	  first, for the skew optimization of the join (see nodeHash.c).
+ *
+ * They are looked up here because the segments have no statistics. This
+ * needs a single hash clause whose outer key is a plain column, as we have
+ * no statistics about the common combinations of several columns. Returns
+ * NIL if the values are not common enough to be worth it.
+ */
+static List *
+get_hash_skew_values(PlannerInfo *root, List *hashclauses)
+{
+	Node	   *outerkey;
+	VariableStatData vardata;
+	Datum	   *values;
+	int			nvalues;
+	float4	   *numbers;
+	int			nnumbers;
+	List	   *result = NIL;
+
+	if (!gp_enable_skew_hashjoin || list_length(hashclauses) != 1)
+		return NIL;
+
+	outerkey = (Node *) linitial(((OpExpr *) linitial(hashclauses))->args);
+	if (!IsA(outerkey, Var))
+		return NIL;
+
+	examine_variable(root, outerkey, 0, &vardata);
+
+	if (HeapTupleIsValid(vardata.statsTuple) &&
+		get_attstatsslot(vardata.statsTuple,
+						 vardata.atttype, vardata.atttypmod,
+						 STATISTIC_KIND_MCV, InvalidOid,
+						 &values, &nvalues,
+						 &numbers, &nnumbers))
+	{
+		double		frac = 0;
+		int16		typlen;
+		bool		typbyval;
+		int			i;
+
+		for (i = 0; i < nnumbers; i++)
+			frac += numbers[i];
+
+		if (frac >= SKEW_MIN_OUTER_FRACTION)
+		{
+			get_typlenbyval(vardata.atttype, &typlen, &typbyval);
+			for (i = 0; i < nvalues; i++)
+				result = lappend(result,
+								 makeConst(vardata.atttype, vardata.atttypmod,
+										   typlen,
+										   datumCopy(values[i], typbyval, typlen),
+										   false, typbyval));
+		}
+
+		free_attstatsslot(vardata.atttype, values, nvalues, numbers, nnumbers);
+	}
+
+	ReleaseVariableStats(vardata);
+
+	return result;
+}
+
 Hash *
 make_hash(Plan *lefttree)
 {
@@ -4372,6 +4443,7 @@ make_hash(Plan *lefttree)
 	plan->righttree = NULL;
 
 	node->rescannable = false;	/* CDB (unused for now) */
+	node->skewValues = NIL;
 
 	return node;
 }
@@ -145,6 +145,7 @@
 #include "cdb/cdbgang.h"                /* cdbgang_parse_gpqeid_params */
 #include "cdb/cdbtm.h"
 #include "cdb/cdbvars.h"
+#include "cdb/ml_ipc.h"
 
 #include "cdb/cdbfilerep.h"
 
@@ -1287,6 +1288,7 @@ PostmasterMain(int argc, char *argv[])
 	 * Postgres processes running in this directory, so this should be safe.
 	 */
 	RemovePgTempFiles();
+	RemoveStaleInterconnectShm();
 
 	/*
 	 * Establish input sockets.
@@ -2196,6 +2198,7 @@ BeginResetOfPostmasterAfterChildrenAreShutDown(void)
 	 * Postgres processes running in this directory, so this should be safe.
 	 */
 	RemovePgTempFiles();
+	RemoveStaleInterconnectShm();
 
 	if (primaryMirrorPostmasterResetShouldRestartPeer())
 	{
@@ -11,6 +11,7 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <math.h>
 
 #include "access/tupmacs.h"
 #include "access/tuptoaster.h"
@@ -21,6 +22,7 @@
 #include "cdb/cdbappendonlystorageread.h"
 #include "cdb/cdbappendonlystoragewrite.h"
 #include "cdb/cdbpersistentfilesysobj.h"
+#include "cdb/cdbvars.h"
 #include "utils/datumstream.h"
 #include "utils/guc.h"
 #include "catalog/pg_compression.h"
@@ -294,7 +296,28 @@ datumstreamwrite_put(
 					 bool null,
 					 void **toFree)
 {
-	return DatumStreamBlockWrite_Put(&acc->blockWrite, d, null, toFree);
+	int			result;
+
+	result = DatumStreamBlockWrite_Put(&acc->blockWrite, d, null, toFree);
+
+	/* Keep the zone map of the block up to date */
+	if (result >= 0 && acc->summarize && !null)
+	{
+		int64		key = datumstream_order_key(acc->summaryType, d);
+
+		if (!acc->blockHasValues)
+		{
+			acc->blockMinKey = key;
+			acc->blockMaxKey = key;
+			acc->blockHasValues = true;
+		}
+		else if (key < acc->blockMinKey)
+			acc->blockMinKey = key;
+		else if (key > acc->blockMaxKey)
+			acc->blockMaxKey = key;
+	}
+
+	return result;
 }
 
 int
@@ -510,6 +533,14 @@ create_datumstreamwrite(
 						  maxsz,
 						  attr);
 
+	/*
+	 * Zone maps are only written when asked for: the version 1 minipages
+	 * that carry them overrun the minipage buffer of releases that predate
+	 * them.
+	 */
+	acc->summarize = gp_enable_aocs_zone_maps &&
+		datumstream_summary_type(attr->atttypid, &acc->summaryType);
+
 	compressionFunctions = NULL;
 	compressionState = NULL;
 	verifyBlockCompressionState = NULL;
@@ -870,6 +901,14 @@ datumstreamread_open_file(DatumStreamRead * ds, char *fn, int64 eof, int64 eofUn
 	if (ds->need_close_file)
 		datumstreamread_close_file(ds);
 
+	/*
+	 * No block of the new file has been read yet. The row number of its
+	 * first block carries on from the previous file, for the blocks that do
+	 * not store it.
+	 */
+	ds->blockFirstRowNum += ds->blockRowCount;
+	ds->blockRowCount = 0;
+
 	AppendOnlyStorageRead_OpenFile(&ds->ao_read, fn, version, ds->eof);
 
 	ds->need_close_file = true;
@@ -1029,14 +1068,38 @@ datumstreamwrite_block(DatumStreamWrite *acc,
 			/* Never reaches here. */
 	}
 
-	/* Insert an entry to the block directory */
-	AppendOnlyBlockDirectory_InsertEntry(
-		blockDirectory,
-		columnGroupNo,
-		acc->blockFirstRowNum,
-		AppendOnlyStorageWrite_LogicalBlockStartOffset(&acc->ao_write),
-		itemCount,
-		addColAction);
+	/* Insert an entry to the block directory, with the block's zone map */
+	if (acc->summarize)
+	{
+		MinipageEntrySummary summary;
+
+		MemSet(&summary, 0, sizeof(summary));
+		summary.flags = MINIPAGE_SUMMARY_VALID;
+		if (acc->blockHasValues)
+		{
+			summary.flags |= MINIPAGE_SUMMARY_HASVALUES;
+			summary.minKey = acc->blockMinKey;
+			summary.maxKey = acc->blockMaxKey;
+		}
+		acc->blockHasValues = false;
+
+		AppendOnlyBlockDirectory_InsertEntryWithSummary(
+			blockDirectory,
+			columnGroupNo,
+			acc->blockFirstRowNum,
+			AppendOnlyStorageWrite_LogicalBlockStartOffset(&acc->ao_write),
+			itemCount,
+			addColAction,
+			&summary);
+	}
+	else
+		AppendOnlyBlockDirectory_InsertEntry(
+			blockDirectory,
+			columnGroupNo,
+			acc->blockFirstRowNum,
+			AppendOnlyStorageWrite_LogicalBlockStartOffset(&acc->ao_write),
+			itemCount,
+			addColAction);
 
 	return writesz;
 }
@@ -1321,10 +1384,12 @@ datumstreamread_block_content(DatumStreamRead * acc)
 }
 
 
-int
-datumstreamread_block(DatumStreamRead * acc,
-					  AppendOnlyBlockDirectory *blockDirectory,
-					  int colGroupNo)
+/*
+ * Read the header of the next block, without its content. Returns false at
+ * the end of the file.
+ */
+static bool
+datumstreamread_next_block_info(DatumStreamRead * acc)
 {
 	bool		readOK = false;
 
@@ -1340,7 +1405,7 @@ datumstreamread_block(DatumStreamRead * acc,
 												&acc->getBlockInfo.isLarge,
 											&acc->getBlockInfo.isCompressed);
 	if (!readOK)
-		return -1;
+		return false;
 
 	if (Debug_appendonly_print_datumstream)
 		elog(LOG,
@@ -1382,6 +1447,17 @@ datumstreamread_block(DatumStreamRead * acc,
 			 acc->blockFileOffset,
 			 acc->blockRowCount);
 
+	return true;
+}
+
+int
+datumstreamread_block(DatumStreamRead * acc,
+					  AppendOnlyBlockDirectory *blockDirectory,
+					  int colGroupNo)
+{
+	if (!datumstreamread_next_block_info(acc))
+		return -1;
+
 	datumstreamread_block_content(acc);
 
 	if (blockDirectory)
@@ -1397,6 +1473,97 @@ datumstreamread_block(DatumStreamRead * acc,
 	return 0;
 }
 
+/*
+ * Position the stream on the given row number, which must not come before
+ * the current row. Blocks that end before the row are skipped over without
+ * reading their content, unless they must go into the block directory.
+ *
+ * Returns false if the file ends before the row.
+ */
+bool
+datumstreamread_seek_row(DatumStreamRead * acc,
+						 AppendOnlyBlockDirectory *blockDirectory,
+						 int colGroupNo,
+						 int64 rowNum)
+{
+	Assert(acc);
+
+	while (acc->blockRowCount == 0 ||
+		   rowNum >= acc->blockFirstRowNum + acc->blockRowCount)
+	{
+		if (!datumstreamread_next_block_info(acc))
+			return false;
+
+		/* The row count of pre-4.0 blocks is only known from their content */
+		if (blockDirectory == NULL &&
+			acc->getBlockInfo.firstRow >= 0 &&
+			rowNum >= acc->blockFirstRowNum + acc->blockRowCount)
+		{
+			AppendOnlyStorageRead_SkipCurrentBlock(&acc->ao_read);
+			continue;
+		}
+
+		datumstreamread_block_content(acc);
+
+		if (blockDirectory)
+		{
+			AppendOnlyBlockDirectory_InsertEntry(blockDirectory,
+												 colGroupNo,
+												 acc->blockFirstRowNum,
+												 acc->blockFileOffset,
+												 acc->blockRowCount,
+												 false);
+		}
+	}
+
+	Assert(rowNum >= acc->blockFirstRowNum);
+	datumstreamread_find(acc, rowNum - acc->blockFirstRowNum);
+
+	return true;
+}
+
+/*
+ * Skip the rows that come before the given row number: the next advance
+ * moves to the first row at or after it. Blocks that end before the row are
+ * skipped over without reading their content; *skippedBlocks is incremented
+ * by their number.
+ *
+ * Returns false if the file ends before the row.
+ */
+bool
+datumstreamread_skip_to_row(DatumStreamRead * acc,
+							int64 rowNum,
+							int64 *skippedBlocks)
+{
+	Assert(acc);
+
+	while (acc->blockRowCount == 0 ||
+		   rowNum >= acc->blockFirstRowNum + acc->blockRowCount)
+	{
+		if (!datumstreamread_next_block_info(acc))
+			return false;
+
+		if (acc->getBlockInfo.firstRow >= 0 &&
+			rowNum >= acc->blockFirstRowNum + acc->blockRowCount)
+		{
+			AppendOnlyStorageRead_SkipCurrentBlock(&acc->ao_read);
+			(*skippedBlocks)++;
+			continue;
+		}
+
+		datumstreamread_block_content(acc);
+	}
+
+	/*
+	 * Row numbers are not dense, the row may come before the block. Never
+	 * move back: the stream may already be past the row.
+	 */
+	if (rowNum - acc->blockFirstRowNum - 1 > datumstreamread_nth(acc))
+		datumstreamread_find(acc, rowNum - acc->blockFirstRowNum - 1);
+
+	return true;
+}
+
 void
 datumstreamread_rewind_block(DatumStreamRead * datumStream)
 {
@@ -1626,3 +1793,434 @@ datumstreamread_find_block(DatumStreamRead * datumStream,
 
 	return true;
 }
+
+/*
+ * Batch reads.
+ *
+ * datumstreamread_batch and datumstreamread_batch_filter read the next rows
+ * of a stream into arrays. Values can only be returned for fixed-length,
+ * pass-by-value datums. Runs of items stored as a plain array (see
+ * DatumStreamBlockRead_PlainRemaining) are copied and filtered with tight
+ * loops over the block buffer, that the compiler vectorizes; the other items
+ * are read one at a time.
+ */
+
+/* Load the i'th item of a plain array; the items need not be aligned. */
+#define DATUMSTREAM_LOAD(CTYPE, datap, i, x) \
+	memcpy(&(x), (datap) + (i) * sizeof(CTYPE), sizeof(CTYPE))
+
+#define DATUMSTREAM_INT_ISNAN(x)	false
+#define DATUMSTREAM_FLOAT_ISNAN(x)	isnan(x)
+
+/* AND the outcome of a condition on each item into match[] */
+#define DATUMSTREAM_PRED_LOOP(CTYPE, COND) \
+	for (i = 0; i < n; i++) \
+	{ \
+		CTYPE		x; \
+		DATUMSTREAM_LOAD(CTYPE, datap, i, x); \
+		match[i] &= (COND); \
+	}
+
+#define DATUMSTREAM_PRED_EVAL(CTYPE, GET, ISNAN) \
+	do { \
+		CTYPE		c = GET(pred->value); \
+		CTYPE		c2 = GET(pred->value2); \
+		switch (pred->op) \
+		{ \
+			case DatumStreamPredicateOp_Eq: \
+				DATUMSTREAM_PRED_LOOP(CTYPE, x == c); \
+				break; \
+			case DatumStreamPredicateOp_Ne: \
+				DATUMSTREAM_PRED_LOOP(CTYPE, x != c); \
+				break; \
+			case DatumStreamPredicateOp_Lt: \
+				DATUMSTREAM_PRED_LOOP(CTYPE, x < c); \
+				break; \
+			case DatumStreamPredicateOp_Le: \
+				DATUMSTREAM_PRED_LOOP(CTYPE, x <= c); \
+				break; \
+			case DatumStreamPredicateOp_Gt: \
+				DATUMSTREAM_PRED_LOOP(CTYPE, x > c || ISNAN(x)); \
+				break; \
+			case DatumStreamPredicateOp_Ge: \
+				DATUMSTREAM_PRED_LOOP(CTYPE, x >= c || ISNAN(x)); \
+				break; \
+			case DatumStreamPredicateOp_Between: \
+				DATUMSTREAM_PRED_LOOP(CTYPE, x >= c && x <= c2); \
+				break; \
+			case DatumStreamPredicateOp_In: \
+				for (i = 0; i < n; i++) \
+				{ \
+					CTYPE		x; \
+					bool		found = false; \
+					int			j; \
+					DATUMSTREAM_LOAD(CTYPE, datap, i, x); \
+					for (j = 0; j < pred->nInValues; j++) \
+						found |= (x == GET(pred->inValues[j])); \
+					match[i] &= found; \
+				} \
+				break; \
+		} \
+	} while (0)
+
+/*
+ * AND the outcome of a predicate on n consecutive items of a plain array
+ * into match[0 .. n - 1].
+ */
+static void
+datumstream_predicate_eval(DatumStreamPredicate *pred, const uint8 *datap,
+						   int n, bool *match)
+{
+	int			i;
+
+	switch (pred->type)
+	{
+		case DatumStreamPredicateType_Int2:
+			DATUMSTREAM_PRED_EVAL(int16, DatumGetInt16, DATUMSTREAM_INT_ISNAN);
+			break;
+		case DatumStreamPredicateType_Int4:
+			DATUMSTREAM_PRED_EVAL(int32, DatumGetInt32, DATUMSTREAM_INT_ISNAN);
+			break;
+		case DatumStreamPredicateType_Int8:
+			DATUMSTREAM_PRED_EVAL(int64, DatumGetInt64, DATUMSTREAM_INT_ISNAN);
+			break;
+		case DatumStreamPredicateType_Float4:
+			DATUMSTREAM_PRED_EVAL(float4, DatumGetFloat4, DATUMSTREAM_FLOAT_ISNAN);
+			break;
+		case DatumStreamPredicateType_Float8:
+			DATUMSTREAM_PRED_EVAL(float8, DatumGetFloat8, DATUMSTREAM_FLOAT_ISNAN);
+			break;
+	}
+}
+
+/*
+ * Does a non-NULL value pass the predicate?
+ */
+bool
+datumstream_predicate_match(DatumStreamPredicate *pred, Datum d)
+{
+	union
+	{
+		int16		i2;
+		int32		i4;
+		int64		i8;
+		float4		f4;
+		float8		f8;
+	}			v;
+	bool		match = true;
+
+	switch (pred->type)
+	{
+		case DatumStreamPredicateType_Int2:
+			v.i2 = DatumGetInt16(d);
+			break;
+		case DatumStreamPredicateType_Int4:
+			v.i4 = DatumGetInt32(d);
+			break;
+		case DatumStreamPredicateType_Int8:
+			v.i8 = DatumGetInt64(d);
+			break;
+		case DatumStreamPredicateType_Float4:
+			v.f4 = DatumGetFloat4(d);
+			break;
+		case DatumStreamPredicateType_Float8:
+			v.f8 = DatumGetFloat8(d);
+			break;
+	}
+
+	datumstream_predicate_eval(pred, (uint8 *) &v, 1, &match);
+	return match;
+}
+
+/*
+ * Find the predicate type whose order keys summarize a column of the given
+ * type in zone maps. Returns false if there is none.
+ */
+bool
+datumstream_summary_type(Oid typid, DatumStreamPredicateType *type)
+{
+	switch (typid)
+	{
+		case INT2OID:
+			*type = DatumStreamPredicateType_Int2;
+			return true;
+		case INT4OID:
+		case DATEOID:
+			*type = DatumStreamPredicateType_Int4;
+			return true;
+		case INT8OID:
+			*type = DatumStreamPredicateType_Int8;
+			return true;
+		case FLOAT4OID:
+			*type = DatumStreamPredicateType_Float4;
+			return true;
+		case FLOAT8OID:
+			*type = DatumStreamPredicateType_Float8;
+			return true;
+		default:
+			return false;
+	}
+}
+
+/*
+ * Map a value to an int64 that compares with the keys of the other values of
+ * the type like the value does with them: the order key of the value.
+ *
+ * The bits of a float are ordered like an integer once the other bits of
+ * the negative ones are flipped. -0 is equal to 0, and NaN greater than any
+ * other value, as in float8_cmp_internal.
+ */
+int64
+datumstream_order_key(DatumStreamPredicateType type, Datum d)
+{
+	float8		f;
+	int64		bits;
+
+	switch (type)
+	{
+		case DatumStreamPredicateType_Int2:
+			return DatumGetInt16(d);
+		case DatumStreamPredicateType_Int4:
+			return DatumGetInt32(d);
+		case DatumStreamPredicateType_Int8:
+			return DatumGetInt64(d);
+		case DatumStreamPredicateType_Float4:
+			f = DatumGetFloat4(d);
+			break;
+		case DatumStreamPredicateType_Float8:
+			f = DatumGetFloat8(d);
+			break;
+		default:
+			elog(ERROR, "unexpected datum stream predicate type %d", type);
+			return 0;
+	}
+
+	if (isnan(f))
+		return PG_INT64_MAX;
+	if (f == 0)
+		f = 0;
+
+	memcpy(&bits, &f, sizeof(bits));
+	if (bits < 0)
+		bits ^= PG_INT64_MAX;
+
+	return bits;
+}
+
+/*
+ * Could some value whose order key is between minKey and maxKey pass the
+ * predicate?
+ */
+bool
+datumstream_predicate_range_match(DatumStreamPredicate *pred,
+								  int64 minKey, int64 maxKey)
+{
+	int64		key = datumstream_order_key(pred->type, pred->value);
+	int			i;
+
+	switch (pred->op)
+	{
+		case DatumStreamPredicateOp_Eq:
+			return minKey <= key && key <= maxKey;
+		case DatumStreamPredicateOp_Ne:
+			return minKey != key || maxKey != key;
+		case DatumStreamPredicateOp_Lt:
+			return minKey < key;
+		case DatumStreamPredicateOp_Le:
+			return minKey <= key;
+		case DatumStreamPredicateOp_Gt:
+			return maxKey > key;
+		case DatumStreamPredicateOp_Ge:
+			return maxKey >= key;
+		case DatumStreamPredicateOp_Between:
+			return maxKey >= key &&
+				minKey <= datumstream_order_key(pred->type, pred->value2);
+		case DatumStreamPredicateOp_In:
+			for (i = 0; i < pred->nInValues; i++)
+			{
+				key = datumstream_order_key(pred->type, pred->inValues[i]);
+				if (minKey <= key && key <= maxKey)
+					return true;
+			}
+			return false;
+	}
+
+	return true;
+}
+
+/* Copy n consecutive items of a plain array into values[] */
+static void
+datumstream_copy_plain(const uint8 *datap, int32 datumlen, int n,
+					   const bool *wanted, Datum *values)
+{
+	int			i;
+
+	/*
+	 * Zero-extend, the same as DatumStreamBlockRead_Get. Rows that are not
+	 * wanted are left alone.
+	 */
+#define DATUMSTREAM_COPY_LOOP(CTYPE) \
+	for (i = 0; i < n; i++) \
+	{ \
+		CTYPE		x; \
+		DATUMSTREAM_LOAD(CTYPE, datap, i, x); \
+		if (wanted == NULL || wanted[i]) \
+			values[i] = (Datum) x; \
+	}
+
+	switch (datumlen)
+	{
+		case 1:
+			DATUMSTREAM_COPY_LOOP(uint8);
+			break;
+		case 2:
+			DATUMSTREAM_COPY_LOOP(uint16);
+			break;
+		case 4:
+			DATUMSTREAM_COPY_LOOP(uint32);
+			break;
+		case 8:
+			DATUMSTREAM_COPY_LOOP(Datum);
+			break;
+		default:
+			elog(ERROR, "unexpected datum length %d in batch read", datumlen);
+	}
+
+#undef DATUMSTREAM_COPY_LOOP
+}
+
+static int
+datumstreamread_batch_internal(DatumStreamRead * acc,
+							   AppendOnlyBlockDirectory *blockDirectory,
+							   int colGroupNo,
+							   int maxRows,
+							   DatumStreamPredicate *preds,
+							   int npreds,
+							   bool *match,
+							   const bool *wanted,
+							   Datum *values,
+							   bool *nulls,
+							   int64 *rowNums)
+{
+	int			n = 0;
+	int			err;
+	int			i;
+
+	Assert(values == NULL ||
+		   (acc->typeInfo.byval && acc->typeInfo.datumlen > 0));
+
+	while (n < maxRows)
+	{
+		uint8	   *datap;
+		int32		run = 0;
+
+		if (acc->largeObjectState == DatumStreamLargeObjectState_None)
+			run = DatumStreamBlockRead_PlainRemaining(&acc->blockRead, &datap);
+
+		if (run > 0)
+		{
+			int32		firstNth = acc->blockRead.nth + 1;
+
+			run = Min(run, maxRows - n);
+
+			if (values != NULL)
+			{
+				datumstream_copy_plain(datap, acc->typeInfo.datumlen, run,
+									   wanted ? &wanted[n] : NULL, &values[n]);
+				memset(&nulls[n], 0, run * sizeof(bool));
+			}
+
+			for (i = 0; i < npreds; i++)
+				datumstream_predicate_eval(&preds[i], datap, run, &match[n]);
+
+			if (rowNums != NULL)
+			{
+				for (i = 0; i < run; i++)
+					rowNums[n + i] = (acc->blockFirstRowNum == INT64CONST(-1)) ?
+						INT64CONST(-1) : acc->blockFirstRowNum + firstNth + i;
+			}
+
+			DatumStreamBlockRead_SkipPlain(&acc->blockRead, run);
+			n += run;
+			continue;
+		}
+
+		err = datumstreamread_advance(acc);
+		Assert(err >= 0);
+		if (err == 0)
+		{
+			if (datumstreamread_block(acc, blockDirectory, colGroupNo) < 0)
+				break;
+
+			/* Look for a plain array at the start of the new block. */
+			continue;
+		}
+
+		if (values != NULL && (wanted == NULL || wanted[n]))
+		{
+			datumstreamread_get(acc, &values[n], &nulls[n]);
+
+			for (i = 0; i < npreds && match[n]; i++)
+				match[n] = !nulls[n] &&
+					datumstream_predicate_match(&preds[i], values[n]);
+		}
+
+		if (rowNums != NULL)
+			rowNums[n] = (acc->blockFirstRowNum == INT64CONST(-1)) ?
+				INT64CONST(-1) : acc->blockFirstRowNum + datumstreamread_nth(acc);
+
+		n++;
+	}
+
+	return n;
+}
+
+/*
+ * datumstreamread_batch
+ *
+ * Read up to maxRows items, returning the number read; fewer only at the end
+ * of the stream. If values is given, the items whose wanted[] entry is set
+ * (all if wanted is NULL) are stored in values/nulls; the others are skipped
+ * without being decoded. If rowNums is given, the row number of each item is
+ * stored there, or -1 for blocks that do not record their first row number.
+ */
+int
+datumstreamread_batch(DatumStreamRead * acc,
+					  AppendOnlyBlockDirectory *blockDirectory,
+					  int colGroupNo,
+					  int maxRows,
+					  const bool *wanted,
+					  Datum *values,
+					  bool *nulls,
+					  int64 *rowNums)
+{
+	return datumstreamread_batch_internal(acc, blockDirectory, colGroupNo,
+										  maxRows, NULL, 0, NULL,
+										  wanted, values, nulls, rowNums);
+}
+
+/*
+ * datumstreamread_batch_filter
+ *
+ * Same as datumstreamread_batch with all items wanted, and also ANDs the
+ * outcome of the predicates on each item into match[]. match[] must be
+ * initialized by the caller.
+ */
+int
+datumstreamread_batch_filter(DatumStreamRead * acc,
+							 AppendOnlyBlockDirectory *blockDirectory,
+							 int colGroupNo,
+							 int maxRows,
+							 DatumStreamPredicate *preds,
+							 int npreds,
+							 bool *match,
+							 Datum *values,
+							 bool *nulls,
+							 int64 *rowNums)
+{
+	Assert(values != NULL);
+
+	return datumstreamread_batch_internal(acc, blockDirectory, colGroupNo,
+										  maxRows, preds, npreds, match,
+										  NULL, values, nulls, rowNums);
+}
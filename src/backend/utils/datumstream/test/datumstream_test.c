@@ -0,0 +1,215 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include "cmockery.h"
+
+#include "../datumstream.c"
+#include "utils/builtins.h"
+
+#define TEST_NITEMS 8
+
+/* ==================== datumstream_predicate_eval ==================== */
+/*
+ * Test the comparisons on a plain array of int4 items, ANDed into match[].
+ */
+void
+test__datumstream_predicate_eval__int4(void **state)
+{
+	int32 items[TEST_NITEMS] = {-3, 0, 5, 7, 7, 10, 12, 100};
+	bool match[TEST_NITEMS];
+	DatumStreamPredicate lt = {DatumStreamPredicateType_Int4,
+							   DatumStreamPredicateOp_Lt, Int32GetDatum(10)};
+	DatumStreamPredicate ne = {DatumStreamPredicateType_Int4,
+							   DatumStreamPredicateOp_Ne, Int32GetDatum(7)};
+
+	memset(match, true, sizeof(match));
+	datumstream_predicate_eval(&lt, (uint8 *) items, TEST_NITEMS, match);
+	datumstream_predicate_eval(&ne, (uint8 *) items, TEST_NITEMS, match);
+
+	assert_true(match[0]);
+	assert_true(match[1]);
+	assert_true(match[2]);
+	assert_false(match[3]);
+	assert_false(match[4]);
+	assert_false(match[5]);
+	assert_false(match[6]);
+	assert_false(match[7]);
+}
+
+/*
+ * Test BETWEEN and IN on int8 items, read from an unaligned buffer.
+ */
+void
+test__datumstream_predicate_eval__int8_between_in(void **state)
+{
+	int64 items[TEST_NITEMS] = {1, 2, 3, 4, 5, 6, 7, 8};
+	uint8 buffer[sizeof(items) + 4];
+	bool match[TEST_NITEMS];
+	Datum inValues[3] = {Int64GetDatum(2), Int64GetDatum(4), Int64GetDatum(8)};
+	DatumStreamPredicate between = {DatumStreamPredicateType_Int8,
+									DatumStreamPredicateOp_Between,
+									Int64GetDatum(2), Int64GetDatum(6)};
+	DatumStreamPredicate in = {DatumStreamPredicateType_Int8,
+							   DatumStreamPredicateOp_In,
+							   (Datum) 0, (Datum) 0, 3, inValues};
+
+	memcpy(buffer + 4, items, sizeof(items));
+
+	memset(match, true, sizeof(match));
+	datumstream_predicate_eval(&between, buffer + 4, TEST_NITEMS, match);
+	datumstream_predicate_eval(&in, buffer + 4, TEST_NITEMS, match);
+
+	for (int i = 0; i < TEST_NITEMS; i++)
+		assert_int_equal(match[i], (items[i] == 2 || items[i] == 4));
+}
+
+/*
+ * Test that a NaN item is greater than any other value, as in
+ * float8_cmp_internal().
+ */
+void
+test__datumstream_predicate_match__float8_nan(void **state)
+{
+	Datum nan = Float8GetDatum(get_float8_nan());
+	DatumStreamPredicate pred = {DatumStreamPredicateType_Float8,
+								 DatumStreamPredicateOp_Gt, Float8GetDatum(1.0)};
+
+	assert_true(datumstream_predicate_match(&pred, nan));
+	assert_false(datumstream_predicate_match(&pred, Float8GetDatum(0.5)));
+
+	pred.op = DatumStreamPredicateOp_Ge;
+	assert_true(datumstream_predicate_match(&pred, nan));
+
+	pred.op = DatumStreamPredicateOp_Lt;
+	assert_false(datumstream_predicate_match(&pred, nan));
+
+	pred.op = DatumStreamPredicateOp_Eq;
+	assert_false(datumstream_predicate_match(&pred, nan));
+}
+
+/* ==================== datumstream_order_key ==================== */
+/*
+ * Test that the order keys of floats compare like the floats do in
+ * float8_cmp_internal(): -0 is equal to 0, and NaN greater than infinity.
+ */
+void
+test__datumstream_order_key__float8(void **state)
+{
+	float8 values[] = {-get_float8_infinity(), -1.5, -0.0, 0.0, 1e-300, 1.5,
+					   get_float8_infinity(), get_float8_nan()};
+	int64 keys[lengthof(values)];
+
+	for (int i = 0; i < lengthof(values); i++)
+		keys[i] = datumstream_order_key(DatumStreamPredicateType_Float8,
+										Float8GetDatum(values[i]));
+
+	for (int i = 1; i < lengthof(values); i++)
+	{
+		if (i == 3)
+			assert_true(keys[i - 1] == keys[i]);
+		else
+			assert_true(keys[i - 1] < keys[i]);
+	}
+
+	assert_true(datumstream_order_key(DatumStreamPredicateType_Float4, Float4GetDatum(-2.5f)) ==
+				datumstream_order_key(DatumStreamPredicateType_Float8, Float8GetDatum(-2.5)));
+}
+
+/* ==================== datumstream_predicate_range_match ==================== */
+/*
+ * Test the predicates over the int4 values of a block between 10 and 20.
+ */
+void
+test__datumstream_predicate_range_match__int4(void **state)
+{
+	Datum inValues[2] = {Int32GetDatum(5), Int32GetDatum(25)};
+	DatumStreamPredicate pred = {DatumStreamPredicateType_Int4,
+								 DatumStreamPredicateOp_Between,
+								 Int32GetDatum(21), Int32GetDatum(30)};
+
+	assert_false(datumstream_predicate_range_match(&pred, 10, 20));
+	pred.value = Int32GetDatum(20);
+	assert_true(datumstream_predicate_range_match(&pred, 10, 20));
+
+	pred.op = DatumStreamPredicateOp_In;
+	pred.nInValues = 2;
+	pred.inValues = inValues;
+	assert_false(datumstream_predicate_range_match(&pred, 10, 20));
+	inValues[1] = Int32GetDatum(15);
+	assert_true(datumstream_predicate_range_match(&pred, 10, 20));
+
+	/* "<>" only excludes a block whose values are all equal to it */
+	pred.op = DatumStreamPredicateOp_Ne;
+	pred.value = Int32GetDatum(10);
+	assert_true(datumstream_predicate_range_match(&pred, 10, 20));
+	assert_false(datumstream_predicate_range_match(&pred, 10, 10));
+
+	pred.op = DatumStreamPredicateOp_Lt;
+	assert_false(datumstream_predicate_range_match(&pred, 10, 20));
+	pred.op = DatumStreamPredicateOp_Ge;
+	assert_true(datumstream_predicate_range_match(&pred, 10, 20));
+}
+
+/* ==================== DatumStreamBlockRead_PlainRemaining ==================== */
+/*
+ * Test that skipping over a plain array leaves the block read positioned as
+ * if it had advanced item by item.
+ */
+void
+test__DatumStreamBlockRead_PlainRemaining__skip(void **state)
+{
+	int32 items[TEST_NITEMS] = {10, 11, 12, 13, 14, 15, 16, 17};
+	DatumStreamBlockRead dsr;
+	uint8 *datap;
+	Datum d;
+	bool isnull;
+
+	memset(&dsr, 0, sizeof(dsr));
+	strncpy(dsr.eyecatcher, DatumStreamBlockRead_Eyecatcher, DatumStreamBlockRead_EyecatcherLen);
+	dsr.typeInfo.datumlen = sizeof(int32);
+	dsr.typeInfo.byval = true;
+	dsr.datumStreamVersion = DatumStreamVersion_Dense;
+	dsr.logical_row_count = TEST_NITEMS;
+	dsr.nth = -1;
+	dsr.physical_datum_index = -1;
+	dsr.datum_beginp = (uint8 *) items;
+	dsr.datum_afterp = (uint8 *) (items + TEST_NITEMS);
+	dsr.datump = dsr.datum_beginp;
+
+	assert_int_equal(DatumStreamBlockRead_PlainRemaining(&dsr, &datap), TEST_NITEMS);
+	assert_true(datap == (uint8 *) &items[0]);
+
+	DatumStreamBlockRead_SkipPlain(&dsr, 3);
+	assert_int_equal(dsr.nth, 2);
+	DatumStreamBlockRead_Get(&dsr, &d, &isnull);
+	assert_int_equal(DatumGetInt32(d), 12);
+
+	assert_int_equal(DatumStreamBlockRead_PlainRemaining(&dsr, &datap), TEST_NITEMS - 3);
+	assert_true(datap == (uint8 *) &items[3]);
+
+	DatumStreamBlockRead_SkipPlain(&dsr, 2);
+	DatumStreamBlockRead_Get(&dsr, &d, &isnull);
+	assert_int_equal(DatumGetInt32(d), 14);
+
+	/* RLE_TYPE compressed blocks must be read item by item */
+	dsr.rle_block_was_compressed = true;
+	assert_int_equal(DatumStreamBlockRead_PlainRemaining(&dsr, &datap), 0);
+}
+
+/* ==================== main ==================== */
+int
+main(int argc, char* argv[])
+{
+	cmockery_parse_arguments(argc, argv);
+
+	const UnitTest tests[] = {
+		unit_test(test__datumstream_predicate_eval__int4),
+		unit_test(test__datumstream_predicate_eval__int8_between_in),
+		unit_test(test__datumstream_predicate_match__float8_nan),
+		unit_test(test__datumstream_order_key__float8),
+		unit_test(test__datumstream_predicate_range_match__int4),
+		unit_test(test__DatumStreamBlockRead_PlainRemaining__skip)
+	};
+
+	return run_tests(tests);
+}
@@ -451,6 +451,7 @@ bool		gp_enable_preunique = TRUE;
 bool		gp_eager_preunique = FALSE;
 bool		gp_enable_sequential_window_plans = FALSE;
 bool		gp_hashagg_streambottom = true;
+double		gp_hashagg_streambottom_min_reduction = 0;
 bool		gp_enable_agg_distinct = true;
 bool		gp_enable_dqa_pruning = true;
 bool		gp_eager_dqa_pruning = FALSE;
@@ -463,6 +464,16 @@ bool		gp_log_dynamic_partition_pruning = false;
 bool		gp_cte_sharing = false;
 bool		gp_enable_relsize_collection = false;
 
+/* Executor gucs */
+bool		gp_enable_batch_execution = false;
+bool		gp_enable_aocs_late_materialization = false;
+bool		gp_enable_aocs_zone_maps = false;
+bool		gp_enable_runtime_filter = false;
+bool		gp_enable_radix_hashjoin = false;
+bool		gp_enable_skew_hashjoin = false;
+bool		gp_enable_hashagg_open_addressing = false;
+int			gp_mk_sort_helper_threads = 0;
+
 /* Optimizer related gucs */
 bool		optimizer;
 bool		optimizer_log;
@@ -580,8 +591,14 @@ bool		codegen_exec_variable_list;
 bool		codegen_slot_getattr;
 bool		codegen_exec_eval_expr;
 bool		codegen_advance_aggregate;
-int		codegen_varlen_tolerance;
+bool		codegen_hash_keys;
+bool		codegen_sort_compare;
+bool		codegen_background_compile;
 int		codegen_optimization_level;
+int		codegen_cache_size;
+static int	codegen_varlen_tolerance;	/* defunct */
+double		codegen_saving_per_row;
+double		codegen_compile_cost;
 static char 	*codegen_optimization_level_str = NULL;
 
 /* System Information */
@@ -990,6 +1007,89 @@ struct config_bool ConfigureNamesBool_gp[] =
 		true, NULL, NULL
 	},
 
+	{
+		{"gp_enable_batch_execution", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enable batch-at-a-time execution of column-oriented table scans and their aggregates."),
+			gettext_noop("Scans of column-oriented tables whose columns are all fixed-width "
+						 "read a batch of rows at a time, and evaluate simple quals and "
+						 "aggregates over column vectors."),
+			GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_enable_batch_execution,
+		false, NULL, NULL
+	},
+
+	{
+		{"gp_enable_aocs_late_materialization", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enable late materialization in column-oriented table scans."),
+			gettext_noop("Scans of column-oriented tables evaluate their quals first, "
+						 "and only read the other columns for the rows that pass them."),
+			GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_enable_aocs_late_materialization,
+		false, NULL, NULL
+	},
+
+	{
+		{"gp_enable_aocs_zone_maps", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enable skipping blocks of column-oriented tables using their zone maps."),
+			gettext_noop("Scans of column-oriented tables skip the blocks whose minimum and "
+						 "maximum values show that none of their rows can pass the quals. "
+						 "Zone maps are written along with the blocks while this is on, and "
+						 "kept in the block directory, which a table only has once it has an "
+						 "index. A table written with zone maps cannot be read by releases "
+						 "that predate them."),
+			GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_enable_aocs_zone_maps,
+		false, NULL, NULL
+	},
+
+	{
+		{"gp_enable_runtime_filter", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enable runtime filters of hash joins on their outer scans."),
+			gettext_noop("An inner hash join over a scan in its own slice builds a bloom "
+						 "filter of its inner join keys, which the scan uses to drop the rows "
+						 "that cannot join. Scans below a motion are not filtered."),
+			GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_enable_runtime_filter,
+		false, NULL, NULL
+	},
+
+	{
+		{"gp_enable_radix_hashjoin", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enable radix-partitioned hash tables for hash joins."),
+			gettext_noop("The inner tuples of a batch are kept in one array partitioned "
+						 "by bucket instead of in chains, which makes probes cache friendlier."),
+			GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_enable_radix_hashjoin,
+		false, NULL, NULL
+	},
+
+	{
+		{"gp_enable_skew_hashjoin", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enable the skew optimization of multi-batch hash joins."),
+			gettext_noop("The inner tuples matching the most common values of the outer join key "
+						 "are kept in memory, so that neither they nor their outer matches spill."),
+			GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_enable_skew_hashjoin,
+		false, NULL, NULL
+	},
+
+	{
+		{"gp_enable_hashagg_open_addressing", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Use an open addressing hash table for hash aggregation."),
+			gettext_noop("The groups are kept in one array of slots, probed 16 slots at a time, "
+						 "instead of in bucket chains."),
+			GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_enable_hashagg_open_addressing,
+		false, NULL, NULL
+	},
+
 	{
 		{"gp_enable_motion_deadlock_sanity", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Enable verbose check at planning time."),
@@ -1323,6 +1423,39 @@ struct config_bool ConfigureNamesBool_gp[] =
 		true, NULL, NULL
 	},
 
+	{
+		{"gp_interconnect_batch_io", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Send and receive UDP-IC packets in batches."),
+			gettext_noop("Uses sendmmsg() and recvmmsg() to move several packets "
+						 "per system call. Ignored where they are not available."),
+			GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_interconnect_batch_io,
+		false, NULL, NULL
+	},
+
+	{
+		{"gp_interconnect_compression", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Compress the tuples sent by motion nodes."),
+			gettext_noop("Larger tuples are compressed with pglz; a motion node "
+						 "stops compressing if the data does not shrink enough."),
+			GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_interconnect_compression,
+		false, NULL, NULL
+	},
+
+	{
+		{"gp_interconnect_batch_tuples", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Send the tuples of redistribute motions in batches."),
+			gettext_noop("Tuples for the same segment are collected and sent "
+						 "many to a chunk, fixed-width columns stored column by column."),
+			GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_interconnect_batch_tuples,
+		false, NULL, NULL
+	},
+
 	{
 		{"resource_scheduler", PGC_POSTMASTER, RESOURCES_MGM,
 			gettext_noop("Enable resource scheduling."),
@@ -3281,6 +3414,44 @@ struct config_bool ConfigureNamesBool_gp[] =
 #endif
 		assign_codegen, NULL
 	},
+	{
+		{"codegen_hash_keys", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Enable codegen for hash key computation of hash aggregates, hash joins and redistribute motions"),
+			NULL,
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&codegen_hash_keys,
+#ifdef USE_CODEGEN
+		true,
+#else
+		false,
+#endif
+		assign_codegen, NULL
+	},
+	{
+		{"codegen_sort_compare", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Enable codegen for the key comparator of multi-key sorts and merge receive motions"),
+			NULL,
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&codegen_sort_compare,
+#ifdef USE_CODEGEN
+		true,
+#else
+		false,
+#endif
+		assign_codegen, NULL
+	},
+	{
+		{"codegen_background_compile", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Compile generated code in a background thread while the regular functions are used."),
+			NULL,
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&codegen_background_compile,
+		false,
+		assign_codegen, NULL
+	},
 	{
 		{"vmem_process_interrupt", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Checks for interrupts before reserving VMEM"),
@@ -4185,6 +4356,19 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL
 	},
 
+	{
+		{"gp_mk_sort_helper_threads", PGC_SUSET, QUERY_TUNING_METHOD,
+			gettext_noop("Sets the maximum number of helper threads of an in-memory multi-key sort."),
+			gettext_noop("Large sorts on keys that can be compared off the main thread sort parts "
+						 "of their input in helper threads, then merge them. A cancel is only "
+						 "serviced once the parts are sorted, which takes about as long as "
+						 "sorting one part. 0 disables this."),
+			GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_mk_sort_helper_threads,
+		0, 0, 8, NULL, NULL
+	},
+
 	{
 		{"gp_hashjoin_bloomfilter", PGC_USERSET, GP_ARRAY_TUNING,
 			gettext_noop("Use bloomfilter in hash join"),
@@ -4694,18 +4878,28 @@ struct config_int ConfigureNamesInt_gp[] =
 	},
 
 	{
-		{"codegen_varlen_tolerance", PGC_USERSET, DEVELOPER_OPTIONS,
-			gettext_noop("Minimum number of initial fixed length attributes in the table to generate code for deforming tuples."),
+		{"codegen_varlen_tolerance", PGC_USERSET, DEFUNCT_OPTIONS,
+			gettext_noop("Unused. Generated tuple deforming handles variable length attributes."),
 			NULL,
-			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE
 		},
 		&codegen_varlen_tolerance,
+		0, 0, INT_MAX, NULL, NULL
+	},
+
+	{
+		{"codegen_cache_size", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Sets the maximum amount of compiled code kept for reuse by later queries."),
+			gettext_noop("Zero disables reuse of compiled code."),
+			GUC_UNIT_KB | GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&codegen_cache_size,
 #ifdef USE_CODEGEN
-		5,
+		16384,
 #else
 		0,
 #endif
-		0, INT_MAX, NULL, NULL
+		0, MAX_KILOBYTES, NULL, NULL
 	},
 
 	{
@@ -4797,6 +4991,17 @@ struct config_real ConfigureNamesReal_gp[] =
 		1.0, 1.0, DBL_MAX, NULL, NULL
 	},
 
+	{
+		{"gp_hashagg_streambottom_min_reduction", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Sets the least reduction of its input rows for the streaming bottom stage of two stage hashagg to keep aggregating."),
+			gettext_noop("When its hash table fills up having aggregated fewer than this many rows per group, "
+						 "the bottom stage passes the rest of its input rows up unaggregated. 0 disables this."),
+			GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_hashagg_streambottom_min_reduction,
+		0, 0, DBL_MAX, NULL, NULL
+	},
+
 	{
 		{"gp_statistics_ndistinct_scaling_ratio_threshold", PGC_USERSET, STATS_ANALYZE,
 			gettext_noop("If the ratio of number of distinct values of an attribute to the number of rows is greater than this value, it is assumed that ndistinct will scale with table size."),
@@ -4913,6 +5118,27 @@ struct config_real ConfigureNamesReal_gp[] =
 		1.0, 0.0, DBL_MAX, NULL, NULL
 	},
 
+	{
+		{"codegen_saving_per_row", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Sets the estimated time in microseconds saved per row by a generated function."),
+			gettext_noop("Code is generated only for nodes expected to process enough rows to pay off its compilation. "
+						 "Zero disables this check."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&codegen_saving_per_row,
+		0.05, 0.0, DBL_MAX, NULL, NULL
+	},
+
+	{
+		{"codegen_compile_cost", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Sets the initial estimate in milliseconds of the time to generate and compile a function."),
+			gettext_noop("The estimate is refined with the compilation times measured by each backend."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&codegen_compile_cost,
+		10.0, 0.0, DBL_MAX, NULL, NULL
+	},
+
 	/* End-of-list marker */
 	{
 		{NULL, 0, 0, NULL, NULL}, NULL, 0.0, 0.0, 0.0, NULL, NULL
@@ -5155,7 +5381,8 @@ struct config_string ConfigureNamesString_gp[] =
 	{
 		{"gp_interconnect_type", PGC_BACKEND, GP_ARRAY_TUNING,
 			gettext_noop("Sets the protocol used for inter-node communication."),
-			gettext_noop("Valid values are \"tcp\" and \"udpifc\"."),
+			gettext_noop("Valid values are \"tcp\", \"udpifc\" and \"shm\"; \"shm\" is "
+						 "\"udpifc\" using shared memory between segments on the same host."),
 			GUC_GPDB_ADDOPT
 		},
 		&gp_interconnect_type_str,
@@ -5165,7 +5392,7 @@ struct config_string ConfigureNamesString_gp[] =
 	{
 		{"gp_interconnect_fc_method", PGC_USERSET, GP_ARRAY_TUNING,
 			gettext_noop("Sets the flow control method used for UDP interconnect."),
-			gettext_noop("Valid values are \"capacity\" and \"loss\"."),
+			gettext_noop("Valid values are \"capacity\", \"loss\" and \"delay\"."),
 			GUC_GPDB_ADDOPT
 		},
 		&gp_interconnect_fc_method_str,
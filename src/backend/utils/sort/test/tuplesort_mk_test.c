@@ -0,0 +1,127 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+
+#include "cmockery.h"
+
+#include "postgres.h"
+
+#include "../tuplesort_mk.c"
+
+#define NUM_ENTRIES (4 * MKSORT_MIN_ENTRIES_PER_PART)
+
+/*
+ * Make an in-memory sort of NUM_ENTRIES distinct int4 datums, in an order
+ * far from sorted.
+ */
+static Tuplesortstate_mk *
+make_int4_sortstate(void)
+{
+	Tuplesortstate_mk *sortstate = palloc0(sizeof(Tuplesortstate_mk));
+	MKLvContext *lvctxt;
+	int			i;
+
+	sortstate->sortcontext = AllocSetContextCreate(TopMemoryContext,
+												   "TupleSort",
+												   ALLOCSET_DEFAULT_MINSIZE,
+												   ALLOCSET_DEFAULT_INITSIZE,
+												   ALLOCSET_DEFAULT_MAXSIZE);
+	sortstate->memAllowed = 1024L * 1024L * 1024L;
+	sortstate->status = TSS_INITIAL;
+
+	lvctxt = palloc0(sizeof(MKLvContext));
+	lvctxt->typByVal = true;
+	lvctxt->typLen = sizeof(int32);
+	lvctxt->lvtype = MKLV_TYPE_INT32;
+	lvctxt->mkctxt = &sortstate->mkctxt;
+
+	sortstate->mkctxt.total_lv = 1;
+	sortstate->mkctxt.lvctxt = lvctxt;
+	sortstate->mkctxt.compare = tupsort_compare_datum;
+	sortstate->mkctxt.cpfr = tupsort_cpfr;
+	sortstate->mkctxt.freeTup = freetup_noop;
+
+	sortstate->entries = MemoryContextAlloc(sortstate->sortcontext,
+											NUM_ENTRIES * sizeof(MKEntry));
+	sortstate->entry_allocsize = NUM_ENTRIES;
+	sortstate->entry_count = NUM_ENTRIES;
+
+	for (i = 0; i < NUM_ENTRIES; i++)
+	{
+		MKEntry    *e = sortstate->entries + i;
+
+		mke_blank(e);
+		mke_set_not_null(e);
+		e->d = Int32GetDatum((int32) (((int64) i * 7919) % NUM_ENTRIES));
+		e->ptr = NULL;
+	}
+
+	return sortstate;
+}
+
+/*
+ * Test that the parts sorted by the helper threads are merged into one
+ * sorted array.
+ */
+void
+test__mk_qsort_parallel__sorts_all_entries(void **state)
+{
+	Tuplesortstate_mk *sortstate = make_int4_sortstate();
+	MemoryContext oldcontext = MemoryContextSwitchTo(sortstate->sortcontext);
+	int			i;
+
+	gp_mk_sort_helper_threads = 3;
+	assert_true(mk_qsort_parallel(sortstate));
+	gp_mk_sort_helper_threads = 0;
+
+	assert_int_equal(sortstate->entry_count, NUM_ENTRIES);
+	for (i = 0; i < NUM_ENTRIES; i++)
+		assert_int_equal(DatumGetInt32(sortstate->entries[i].d), i);
+
+	MemoryContextSwitchTo(oldcontext);
+	MemoryContextDelete(sortstate->sortcontext);
+}
+
+/*
+ * Test that the sort stays on the main thread when helpers are disabled,
+ * when the merged array would not fit, or when a level cannot be compared
+ * off the main thread.
+ */
+void
+test__mk_qsort_parallel__falls_back(void **state)
+{
+	Tuplesortstate_mk *sortstate = make_int4_sortstate();
+	MemoryContext oldcontext = MemoryContextSwitchTo(sortstate->sortcontext);
+
+	gp_mk_sort_helper_threads = 0;
+	assert_false(mk_qsort_parallel(sortstate));
+
+	gp_mk_sort_helper_threads = 3;
+	sortstate->memAllowed = NUM_ENTRIES * sizeof(MKEntry);
+	assert_false(mk_qsort_parallel(sortstate));
+
+	sortstate->memAllowed = 1024L * 1024L * 1024L;
+	sortstate->mkctxt.lvctxt[0].lvtype = MKLV_TYPE_TEXT;
+	sortstate->mkctxt.lvctxt[0].typByVal = false;
+	assert_false(mk_qsort_parallel(sortstate));
+
+	gp_mk_sort_helper_threads = 0;
+
+	MemoryContextSwitchTo(oldcontext);
+	MemoryContextDelete(sortstate->sortcontext);
+}
+
+int
+main(int argc, char* argv[])
+{
+	cmockery_parse_arguments(argc, argv);
+
+	const UnitTest tests[] = {
+		unit_test(test__mk_qsort_parallel__sorts_all_entries),
+		unit_test(test__mk_qsort_parallel__falls_back)
+	};
+
+	MemoryContextInit();
+
+	return run_tests(tests);
+}
@@ -119,11 +119,14 @@
 #include "utils/tuplesort.h"
 #include "utils/pg_locale.h"
 #include "utils/builtins.h"
+#include "utils/date.h"
+#include "utils/timestamp.h"
 #include "utils/tuplesort_mk.h"
 #include "utils/tuplesort_mk_details.h"
 #include "utils/string_wrapper.h"
 #include "utils/faultinjector.h"
 
+#include "cdb/cdbgang.h"		/* gp_pthread_create */
 #include "cdb/cdbvars.h"
 
 /*
@@ -197,6 +200,49 @@ typedef struct TupsortMergeReadCtxt
 	int64		mem_used;
 } TupsortMergeReadCtxt;
 
+/*
+ * A part of the unsorted array, sorted by a helper thread and then read
+ * back by the merge, see mk_qsort_parallel().
+ */
+typedef struct MKSortPart
+{
+	MKEntry    *entries;
+	int			left;			/* first entry of the part */
+	int			right;			/* last entry of the part, inclusive */
+	int			cur;			/* next entry to merge */
+	MKContext  *mkctxt;
+} MKSortPart;
+
+/* Do not hand a part of fewer entries than this to a helper thread */
+#define MKSORT_MIN_ENTRIES_PER_PART		65536
+
+/* Upper limit of gp_mk_sort_helper_threads */
+#define MKSORT_MAX_HELPER_THREADS		8
+
+/*
+ * The helper threads of a backend. They are started on the first parallel
+ * sort that needs them and then wait for parts to sort until the backend
+ * exits, so a sort does not pay for creating and joining threads.
+ */
+typedef struct MKSortHelperPool
+{
+	pthread_mutex_t mutex;
+	pthread_cond_t workCond;	/* signalled when parts are queued */
+	pthread_cond_t doneCond;	/* signalled when npending drops to 0 */
+	int			nthreads;		/* helper threads started */
+	MKSortPart *queue[MKSORT_MAX_HELPER_THREADS];
+	int			nqueued;		/* parts waiting in queue */
+	int			npending;		/* parts queued or being sorted */
+} MKSortHelperPool;
+
+static MKSortHelperPool mksort_helper_pool = {
+	PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER,
+	0, {NULL}, 0, 0
+};
+
+/* How many entries ahead the merge prefetches the tuples of a part */
+#define MKSORT_PREFETCH_DISTANCE		8
+
 /*
  * Private state of a Tuplesort operation.
  */
@@ -511,6 +557,7 @@ static void tuplesort_inmem_limit_insert(Tuplesortstate_mk *state, MKEntry *e);
 static void tuplesort_inmem_nolimit_insert(Tuplesortstate_mk *state, MKEntry *e);
 static void tuplesort_heap_insert(Tuplesortstate_mk *state, MKEntry *e);
 static void tuplesort_limit_sort(Tuplesortstate_mk *state);
+static bool mk_qsort_parallel(Tuplesortstate_mk *state);
 
 static void tupsort_refcnt(void *vp, int ref);
 
@@ -675,9 +722,11 @@ create_mksort_context(
 	if (tupdesc)
 		mkctxt->mt_bind = create_memtuple_binding(tupdesc);
 
+	mkctxt->compare = tupsort_compare_datum;
 	mkctxt->cpfr = tupsort_cpfr;
 	mkctxt->freeTup = freeTupleFn;
 	mkctxt->estimatedExtraForPrep = 0;
+	mkctxt->parallelSort = false;
 
 	lc_guess_strxfrm_scaling_factor(&mkctxt->strxfrmScaleFactor, &mkctxt->strxfrmConstantFactor);
 
@@ -997,6 +1046,19 @@ tuplesort_set_bound_mk(Tuplesortstate_mk *state, int64 bound)
 	state->mkctxt.limitmask = -1;
 }
 
+/*
+ * tuplesort_set_compare_mk
+ *
+ *	Replace the comparator of prepared datums, e.g. by one generated for
+ *	the sort keys of the caller.  Must be called before any tuple is added.
+ */
+void
+tuplesort_set_compare_mk(Tuplesortstate_mk *state, MKCompareFn compare)
+{
+	Assert(compare != NULL);
+	state->mkctxt.compare = compare;
+}
+
 /*
  * tuplesort_end
  *
@@ -1347,10 +1409,10 @@ tuplesort_performsort_mk(Tuplesortstate_mk *state)
 			 * We were able to accumulate all the tuples within the allowed
 			 * amount of memory.  Just qsort 'em and we're done.
 			 */
-			if (!state->mkctxt.bounded)
-				mk_qsort(state->entries, state->entry_count, &state->mkctxt);
-			else
+			if (state->mkctxt.bounded)
 				tuplesort_limit_sort(state);
+			else if (!mk_qsort_parallel(state))
+				mk_qsort(state->entries, state->entry_count, &state->mkctxt);
 
 			state->pos.current = 0;
 			state->pos.eof_reached = false;
@@ -3634,6 +3696,270 @@ tuplesort_heap_insert(Tuplesortstate_mk *state, MKEntry *e)
 	}
 }
 
+/*
+ * Can the array be sorted by helper threads?  They must not palloc,
+ * elog or process interrupts, so every level must be a pass-by-value
+ * type compared by the default comparator with one of a few builtin
+ * comparison functions, and duplicates must not need to be freed or
+ * reported.
+ */
+static bool
+mk_qsort_parallel_safe(MKContext *mkctxt)
+{
+	int			lv;
+
+	if (mkctxt->bounded || mkctxt->unique || mkctxt->enforceUnique ||
+		mkctxt->compare != tupsort_compare_datum)
+		return false;
+
+	for (lv = 0; lv < mkctxt->total_lv; lv++)
+	{
+		MKLvContext *lvctxt = mkctxt->lvctxt + lv;
+		PGFunction	cmp = lvctxt->scanKey.sk_func.fn_addr;
+
+		if (!lvctxt->typByVal)
+			return false;
+
+		if (lvctxt->lvtype == MKLV_TYPE_INT32)
+			continue;
+
+		if (lvctxt->lvtype != MKLV_TYPE_NONE)
+			return false;
+
+		if (cmp != btint2cmp && cmp != btint8cmp &&
+			cmp != btint24cmp && cmp != btint42cmp &&
+			cmp != btint48cmp && cmp != btint84cmp &&
+			cmp != btfloat4cmp && cmp != btfloat8cmp &&
+			cmp != btoidcmp && cmp != date_cmp && cmp != timestamp_cmp)
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Sort one part of the array.  This runs in a helper thread, or in the
+ * main thread if no helper got to the part first.
+ */
+static void
+mk_qsort_part(MKSortPart *part)
+{
+	mk_qsort_impl(part->entries, part->left, part->right, 0, true,
+				  part->mkctxt, false);
+}
+
+/*
+ * Take a queued part and sort it.  Called, and returns, with the pool's
+ * mutex held.  Returns false if there was no part to take.
+ */
+static bool
+mk_qsort_take_part(MKSortHelperPool *pool)
+{
+	MKSortPart *part;
+
+	if (pool->nqueued == 0)
+		return false;
+
+	part = pool->queue[--pool->nqueued];
+
+	pthread_mutex_unlock(&pool->mutex);
+	mk_qsort_part(part);
+	pthread_mutex_lock(&pool->mutex);
+
+	if (--pool->npending == 0)
+		pthread_cond_signal(&pool->doneCond);
+
+	return true;
+}
+
+/*
+ * Body of a helper thread: sort the parts queued by mk_qsort_parallel(),
+ * forever.
+ */
+static void *
+mk_qsort_helper(void *arg)
+{
+	MKSortHelperPool *pool = (MKSortHelperPool *) arg;
+
+	/* Signals are handled by the main thread only */
+	gp_set_thread_sigmasks();
+
+	pthread_mutex_lock(&pool->mutex);
+	for (;;)
+	{
+		if (!mk_qsort_take_part(pool))
+			pthread_cond_wait(&pool->workCond, &pool->mutex);
+	}
+
+	return NULL;
+}
+
+/*
+ * Make sure that up to nhelpers helper threads are running.  Returns how
+ * many are.
+ */
+static int
+mk_qsort_start_helpers(MKSortHelperPool *pool, int nhelpers)
+{
+	while (pool->nthreads < nhelpers)
+	{
+		pthread_t	thread;
+
+		if (gp_pthread_create(&thread, mk_qsort_helper, pool,
+							  "mk_qsort_start_helpers") != 0)
+			break;
+		pthread_detach(thread);
+		pool->nthreads++;
+	}
+
+	return pool->nthreads;
+}
+
+/*
+ * MKHeap reader over a sorted part.  Like an entry read back from a run,
+ * the entry is handed over with no prepared levels; the prefetch brings in
+ * the tuple the heap will prepare a few reads later.
+ */
+static bool
+mk_qsort_part_read(void *pvctxt, MKEntry *e)
+{
+	MKSortPart *part = (MKSortPart *) pvctxt;
+
+	if (part->cur > part->right)
+		return false;
+
+	if (part->cur + MKSORT_PREFETCH_DISTANCE <= part->right)
+		__builtin_prefetch(part->entries[part->cur + MKSORT_PREFETCH_DISTANCE].ptr);
+
+	*e = part->entries[part->cur++];
+	e->compflags &= MKE_CF_NULLBITS;
+	e->flags = 0;
+
+	return true;
+}
+
+/*
+ * Sort the in-memory array with up to gp_mk_sort_helper_threads helper
+ * threads.  The array is cut into parts, the main thread and the helpers
+ * of mksort_helper_pool quicksort them, and the main thread merges the
+ * sorted parts into a new array, using an MKHeap with a reader per part.
+ *
+ * The merged array is allocated in the sort context, like the rest of
+ * the sort's memory, and only if it fits in memAllowed.  The threads only
+ * touch the entries of their own part and the tuples they point to.
+ *
+ * Returns false, having done nothing, if the sort should be done by
+ * mk_qsort() instead.
+ */
+static bool
+mk_qsort_parallel(Tuplesortstate_mk *state)
+{
+	MKContext  *mkctxt = &state->mkctxt;
+	MKSortPart *parts;
+	MKHeapReader *readers;
+	MKHeap	   *mkheap;
+	MKEntry    *merged;
+	MKEntry		e;
+	int64		mergedSize;
+	int			nparts;
+	int			i;
+	int			n;
+
+	nparts = Min(Min(gp_mk_sort_helper_threads, MKSORT_MAX_HELPER_THREADS) + 1,
+				 state->entry_count / MKSORT_MIN_ENTRIES_PER_PART);
+	if (nparts < 2 || !mk_qsort_parallel_safe(mkctxt))
+		return false;
+
+	mergedSize = (int64) state->entry_allocsize * sizeof(MKEntry);
+	if (MemoryContextGetCurrentSpace(state->sortcontext) + mergedSize > state->memAllowed)
+		return false;
+
+	parts = (MKSortPart *) palloc0(nparts * sizeof(MKSortPart));
+	readers = (MKHeapReader *) palloc(nparts * sizeof(MKHeapReader));
+	merged = (MKEntry *) palloc(mergedSize);
+
+	for (i = 0; i < nparts; i++)
+	{
+		parts[i].entries = state->entries;
+		parts[i].left = (int) ((int64) state->entry_count * i / nparts);
+		parts[i].right = (int) ((int64) state->entry_count * (i + 1) / nparts) - 1;
+		parts[i].cur = parts[i].left;
+		parts[i].mkctxt = mkctxt;
+	}
+
+	/*
+	 * From here until all the parts are sorted, mk_qsort_impl() skips
+	 * CHECK_FOR_INTERRUPTS(): servicing a cancel would longjmp out of the
+	 * main thread while the helpers still sort the array. Interrupts that
+	 * arrive meanwhile stay pending and are serviced as soon as the helpers
+	 * are done, below, so a cancel waits for at most the sort of one part
+	 * per thread. A QueryFinishPending request still stops every thread
+	 * early.
+	 */
+	mkctxt->parallelSort = true;
+
+	/*
+	 * Queue all parts but the first for the helpers. The main thread sorts
+	 * the first, then takes queued parts too until none are left, so it
+	 * does not matter if fewer helpers could be started.
+	 */
+	pthread_mutex_lock(&mksort_helper_pool.mutex);
+	mk_qsort_start_helpers(&mksort_helper_pool, nparts - 1);
+	Assert(mksort_helper_pool.npending == 0);
+	for (i = 1; i < nparts; i++)
+		mksort_helper_pool.queue[mksort_helper_pool.nqueued++] = &parts[i];
+	mksort_helper_pool.npending = nparts - 1;
+	pthread_cond_broadcast(&mksort_helper_pool.workCond);
+	pthread_mutex_unlock(&mksort_helper_pool.mutex);
+
+	mk_qsort_part(&parts[0]);
+
+	pthread_mutex_lock(&mksort_helper_pool.mutex);
+	while (mk_qsort_take_part(&mksort_helper_pool))
+		;
+	while (mksort_helper_pool.npending > 0)
+		pthread_cond_wait(&mksort_helper_pool.doneCond, &mksort_helper_pool.mutex);
+	pthread_mutex_unlock(&mksort_helper_pool.mutex);
+
+	mkctxt->parallelSort = false;
+
+	/* Service a cancel that came in while the parts were sorted */
+	CHECK_FOR_INTERRUPTS();
+
+	/* Merge the parts */
+	for (i = 0; i < nparts; i++)
+	{
+		readers[i].reader = mk_qsort_part_read;
+		readers[i].mkhr_ctxt = &parts[i];
+	}
+
+	mkheap = mkheap_from_reader(readers, nparts, mkctxt);
+
+	n = 0;
+	while (mkheap_putAndGet(mkheap, &e) >= 0)
+	{
+		Assert(n < state->entry_count);
+		merged[n++] = e;
+
+		if ((n & 0xFFFF) == 0)
+			CHECK_FOR_INTERRUPTS();
+	}
+	Assert(QueryFinishPending || n == state->entry_count);
+
+	mkheap_destroy(mkheap);
+
+	for (i = n; i < state->entry_allocsize; i++)
+		mke_blank(merged + i);
+
+	pfree(state->entries);
+	state->entries = merged;
+
+	pfree(readers);
+	pfree(parts);
+
+	return true;
+}
+
 static void
 tuplesort_limit_sort(Tuplesortstate_mk *state)
 {
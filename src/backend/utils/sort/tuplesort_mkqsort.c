@@ -43,7 +43,7 @@ static inline int32 mkqs_comp(MKEntry *a, MKEntry *b, MKLvContext *ctxt, MKConte
 	int ret = a->compflags - b->compflags;
 
 	if (ret == 0 && !mke_is_null(a))
-		ret = tupsort_compare_datum(a, b, ctxt, mkctxt);
+		ret = mkctxt->compare(a, b, ctxt, mkctxt);
 
 	return ret;
 }
@@ -261,7 +261,12 @@ void mk_qsort_impl(MKEntry *a, int left, int right, int lv, bool lvdown, MKConte
 	Assert(ctxt);
 	Assert(lv < ctxt->total_lv);
 
-	CHECK_FOR_INTERRUPTS();
+	/*
+	 * Helper threads cannot service interrupts, and the main thread must
+	 * not while they run; mk_qsort_parallel() does once they are done.
+	 */
+	if (!ctxt->parallelSort)
+		CHECK_FOR_INTERRUPTS();
 
 	if (QueryFinishPending)
 		return;
@@ -67,6 +67,15 @@ typedef struct AOCSInsertDescData
 
 typedef AOCSInsertDescData *AOCSInsertDesc;
 
+/*
+ * A range of row numbers, both ends included.
+ */
+typedef struct AOCSRowRange
+{
+	int64		first;
+	int64		last;
+} AOCSRowRange;
+
 /*
  * used for scan of append only relations using BufferedRead and VarBlocks
  */
@@ -106,11 +115,42 @@ typedef struct AOCSScanDescData
 	int		   *proj_atts;
 	int			num_proj_atts;
 
+	/*
+	 * The last num_late_atts columns of proj_atts are not read by
+	 * aocs_getnext(), but by aocs_fetch_late_columns(), only for the rows
+	 * the caller wants. See aocs_set_late_columns().
+	 */
+	int			num_late_atts;
+
+	/* Row number of the row last returned by aocs_getnext() */
+	int64		cur_row_num;
+
 	/* synthetic system attributes */
 	ItemPointerData cdb_fake_ctid;
 	int64 total_row;
 	int64 cur_seg_row;
 
+	/*
+	 * Set by aocs_getnext_batch() when it has read the last rows of the
+	 * current segment file; the segment is closed on the next call.
+	 */
+	bool		need_next_seg;
+
+	/*
+	 * Zone map predicates, indexed by column number, set with
+	 * aocs_set_zone_map_predicates(). The zone maps of the block directory
+	 * give, for each segment file, the sorted ranges of rows that cannot
+	 * pass them; the blocks of those rows are skipped without being read.
+	 * zonemap_next_row is the row number the next row read is at least at.
+	 */
+	int		   *zonemap_npreds;
+	DatumStreamPredicate **zonemap_preds;
+	AOCSRowRange *zonemap_ranges;
+	int			zonemap_nranges;
+	int			zonemap_next;
+	int64		zonemap_next_row;
+	int64		zonemap_skipped_blocks;
+
 	/*
 	 * The block directory info.
 	 *
@@ -126,6 +166,40 @@ typedef struct AOCSScanDescData
 
 typedef AOCSScanDescData *AOCSScanDesc;
 
+/*
+ * Maximum number of rows aocs_getnext_batch() reads at a time.
+ */
+#define AOCS_BATCH_SIZE 1024
+
+/*
+ * A batch of rows of an AOCS relation, stored column by column.
+ *
+ * Only the projected columns that are fixed-width and passed by value get
+ * a vector; values[attno] and isnull[attno] are NULL for all the others.
+ * sel[0 .. nsel - 1] are the positions of the rows that are visible and
+ * pass the predicates added with aocs_batch_add_predicate().
+ *
+ * The columns with predicates are read first. The values of the other
+ * columns are only stored for the selected rows.
+ */
+typedef struct AOCSBatchData
+{
+	int			ncol;			/* number of attributes of the relation */
+	int			nrows;			/* number of rows read into the vectors */
+	Datum	  **values;			/* values[attno][row], or NULL */
+	bool	  **isnull;			/* isnull[attno][row], or NULL */
+	AOTupleId  *tids;			/* tid of each row */
+	int			nsel;			/* number of selected rows */
+	int		   *sel;			/* positions of the selected rows */
+
+	int		   *npreds;			/* number of predicates of each column */
+	DatumStreamPredicate **preds;	/* preds[attno][i], or NULL */
+	bool	   *match;			/* does the row pass the predicates? */
+	int64	   *rownums;		/* row numbers returned by the datum stream */
+} AOCSBatchData;
+
+typedef AOCSBatchData *AOCSBatch;
+
 /*
  * Used for fetch individual tuples from specified by TID of append only relations
  * using the AO Block Directory.
@@ -208,6 +282,15 @@ extern void aocs_rescan(AOCSScanDesc scan);
 extern void aocs_endscan(AOCSScanDesc scan);
 
 extern void aocs_getnext(AOCSScanDesc scan, ScanDirection direction, TupleTableSlot *slot);
+extern void aocs_set_late_columns(AOCSScanDesc scan, bool *late);
+extern void aocs_fetch_late_columns(AOCSScanDesc scan, TupleTableSlot *slot);
+extern void aocs_set_zone_map_predicates(AOCSScanDesc scan, int *npreds,
+							 DatumStreamPredicate **preds);
+extern AOCSBatch aocs_batch_create(AOCSScanDesc scan);
+extern void aocs_batch_free(AOCSBatch batch);
+extern void aocs_batch_add_predicate(AOCSBatch batch, int attno,
+						 DatumStreamPredicate *pred);
+extern bool aocs_getnext_batch(AOCSScanDesc scan, ScanDirection direction, AOCSBatch batch);
 extern AOCSInsertDesc aocs_insert_init(Relation rel, int segno, bool update_mode);
 extern Oid aocs_insert_values(AOCSInsertDesc idesc, Datum *d, bool *null, AOTupleId *aoTupleId);
 static inline Oid aocs_insert(AOCSInsertDesc idesc, TupleTableSlot *slot)
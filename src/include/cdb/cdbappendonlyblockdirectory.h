@@ -43,6 +43,30 @@ typedef struct MinipageEntry
 	int64 rowCount;
 } MinipageEntry;
 
+/*
+ * The zone map of a minipage entry: the smallest and the largest non-null
+ * value of the column in the rows of the entry, as order keys (see
+ * datumstream_order_key). Only kept for the columns of some fixed-length
+ * types, and only valid if every block of the entry was summarized when it
+ * was written.
+ */
+typedef struct MinipageEntrySummary
+{
+	int64 minKey;
+	int64 maxKey;
+	int32 flags;
+} MinipageEntrySummary;
+
+#define MINIPAGE_SUMMARY_VALID		0x1	/* minKey and maxKey can be used */
+#define MINIPAGE_SUMMARY_HASVALUES	0x2	/* some value is not null */
+
+/*
+ * Minipage versions. In a MINIPAGE_VERSION_SUMMARY minipage, the entries
+ * are followed by an array of nEntry MinipageEntrySummary.
+ */
+#define MINIPAGE_VERSION_ORIGINAL	0
+#define MINIPAGE_VERSION_SUMMARY	1
+
 /*
  * Define a varlena type for a minipage.
  */
@@ -64,10 +88,21 @@ typedef struct Minipage
 typedef struct MinipagePerColumnGroup
 {
 	Minipage *minipage;
+	MinipageEntrySummary *summary;	/* zone map of each entry */
 	uint32 numMinipageEntries;
 	ItemPointerData tupleTid;
 } MinipagePerColumnGroup;
 
+/*
+ * A minipage entry with its zone map, as returned by
+ * AppendOnlyBlockDirectory_GetSummaries.
+ */
+typedef struct AppendOnlyBlockDirectorySummary
+{
+	MinipageEntry entry;
+	MinipageEntrySummary summary;
+} AppendOnlyBlockDirectorySummary;
+
 /*
  * I don't know the ideal value here. But let us put approximate
  * 8 minipages per heap page.
@@ -194,6 +229,14 @@ extern bool AppendOnlyBlockDirectory_InsertEntry(
 	int64 fileOffset,
 	int64 rowCount,
 	bool addColAction);
+extern bool AppendOnlyBlockDirectory_InsertEntryWithSummary(
+	AppendOnlyBlockDirectory *blockDirectory,
+	int columnGroupNo,
+	int64 firstRowNum,
+	int64 fileOffset,
+	int64 rowCount,
+	bool addColAction,
+	MinipageEntrySummary *summary);
 extern bool AppendOnlyBlockDirectory_addCol_InsertEntry(
 	AppendOnlyBlockDirectory *blockDirectory,
 	int columnGroupNo,
@@ -213,6 +256,13 @@ extern void AppendOnlyBlockDirectory_End_forSearch(
 	AppendOnlyBlockDirectory *blockDirectory);
 extern void AppendOnlyBlockDirectory_End_addCol(
 	AppendOnlyBlockDirectory *blockDirectory);
+extern int AppendOnlyBlockDirectory_GetSummaries(
+	Relation aoRel,
+	Snapshot appendOnlyMetaDataSnapshot,
+	int segno,
+	int columnGroupNo,
+	int64 eof,
+	AppendOnlyBlockDirectorySummary **summaries);
 extern void AppendOnlyBlockDirectory_DeleteSegmentFile(
 	Relation aoRel,
 		Snapshot snapshot,
@@ -207,6 +207,12 @@ struct MotionConn
 	uint64 dev;
 	uint64 deadlockCheckBeginTime;
 
+	/* send window and pacing for the delay-based flow control */
+	float cwnd;
+	float ssthresh;
+	uint64 minRtt;
+	uint64 nextSendTime;
+
 
 	ICBuffer *curBuff;
 
@@ -285,6 +291,15 @@ struct MotionConn
 	 * all the remap information.
 	 */
 	TupleRemapper	*remapper;
+
+	/*
+	 * UDPIFC only: the shared-memory ring that replaces the socket when the
+	 * peer is on the same host (gp_interconnect_type "shm"), or NULL, and
+	 * its number of packet slots and slot size.
+	 */
+	struct ICShmRing *shmRing;
+	uint32		shmNumSlots;
+	uint32		shmSlotSize;
 };
 
 /*
@@ -326,6 +341,9 @@ typedef struct ChunkTransportStateEntry
 
 	bool		sendingEos;
 
+	/* number of connections using a shared-memory ring (UDPIFC only) */
+	int			numShmConns;
+
 	/* Statistics info for this motion on the interconnect level */
 	uint64 stat_total_ack_time;
 	uint64 stat_count_acks;
@@ -432,6 +450,28 @@ typedef struct MotionNodeEntry
 	bool            moreNetWork;
 	bool            stopped;
 
+	/*
+	 * Whether tuples sent by this motion node are compressed; see
+	 * gp_interconnect_compression.  Switched off if it doesn't pay.
+	 */
+	bool            compress_tuples;
+
+	/*
+	 * Tuples waiting to be sent in batches, one batch per route; see
+	 * gp_interconnect_batch_tuples.  batch_tuples is false if the tuple
+	 * description doesn't allow batches.
+	 */
+	bool            batch_tuples;
+	int             num_send_batches;
+	TupleBatch     *send_batches;
+
+	/*
+	 * Received batches whose tuples have not all been consumed yet, oldest
+	 * first.  Only used if preserve_order is false.
+	 */
+	RecvTupleBatch *recv_batches;
+	RecvTupleBatch *recv_batches_tail;
+
 	/*
 	 * PER-MOTION-NODE STATISTICS
 	 */
@@ -440,6 +480,9 @@ typedef struct MotionNodeEntry
 	uint64          stat_total_bytes_sent;  /* Bytes sent, including headers. */
 	uint64          stat_tuple_bytes_sent;  /* Bytes of pure tuple-data sent. */
 
+	uint64          stat_compress_raw_bytes;        /* Tuple-data bytes given to compression. */
+	uint64          stat_compress_bytes;    /* ... and the bytes they were sent as. */
+
 	uint64          stat_total_chunks_recvd;                /* Tuple-chunks received. */
 	uint64          stat_total_bytes_recvd; /* Bytes received, including headers. */
 	uint64          stat_tuple_bytes_recvd; /* Bytes of pure tuple-data received. */
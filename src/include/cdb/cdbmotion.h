@@ -12,6 +12,7 @@
 #define CDBMOTION_H
 
 #include "access/htup.h"
+#include "executor/tuptable.h"
 #include "cdb/cdbselect.h"
 #include "cdb/cdbinterconnect.h"
 #include "cdb/ml_ipc.h"
@@ -106,6 +107,16 @@ extern SendReturnCode SendTuple(MotionLayerState *mlStates,
 								int16 targetRoute);
 
 
+/* Like SendTuple(), but the tuple may be held back, to be sent with other
+ * tuples for the same route in one chunk.  The tuples held back are sent
+ * before the end-of-stream token.
+ */
+extern SendReturnCode SendTupleBatched(MotionLayerState *mlStates,
+									   ChunkTransportState *transportStates,
+									   int16 motNodeID,
+									   TupleTableSlot *slot,
+									   int16 targetRoute);
+
 /* Send or broadcast an END_OF_STREAM token to the corresponding motion-node
  * on other segments.
  */
@@ -134,6 +145,11 @@ extern ReceiveReturnCode RecvTupleFrom(MotionLayerState *mlStates,
 									   HeapTuple *tup_i,
 									   int16 srcRoute);
 
+extern ReceiveReturnCode RecvTupleSlot(MotionLayerState *mlStates,
+									   ChunkTransportState *transportStates,
+									   int16 motNodeID,
+									   TupleTableSlot *slot);
+
 extern void SendStopMessage(MotionLayerState *mlStates,
 							ChunkTransportState *transportStates,
 							int16 motNodeID);
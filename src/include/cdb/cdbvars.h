@@ -397,14 +397,23 @@ extern int	Gp_max_packet_size;	/* GUC var */
 
 #define INTERCONNECT_TYPE_TCP    (0)
 #define INTERCONNECT_TYPE_UDPIFC (1)
+#define INTERCONNECT_TYPE_SHM    (2)	/* UDPIFC, with shared memory between
+										 * segments on the same host */
 
 extern int Gp_interconnect_type;
 
+/* True if the UDPIFC code is in use; it also implements the "shm" type. */
+#define INTERCONNECT_IS_UDPIFC() \
+	(Gp_interconnect_type == INTERCONNECT_TYPE_UDPIFC || \
+	 Gp_interconnect_type == INTERCONNECT_TYPE_SHM)
+
 extern const char *gpvars_assign_gp_interconnect_type(const char *newval, bool doit, GucSource source __attribute__((unused)) );
 extern const char *gpvars_show_gp_interconnect_type(void);
 
 #define INTERCONNECT_FC_METHOD_CAPACITY (0)
 #define INTERCONNECT_FC_METHOD_LOSS     (2)
+#define INTERCONNECT_FC_METHOD_DELAY    (3)	/* LOSS, with a per-connection
+											 * delay-based window and pacing */
 
 extern int Gp_interconnect_fc_method;
 
@@ -480,6 +489,29 @@ extern bool gp_interconnect_log_stats;
 
 extern bool gp_interconnect_cache_future_packets;
 
+/*
+ * Parameter gp_interconnect_batch_io
+ *
+ * Send and receive the UDP-IC packets in batches, with sendmmsg() and
+ * recvmmsg(), where the platform has them.
+ */
+extern bool gp_interconnect_batch_io;
+
+/*
+ * Parameter gp_interconnect_compression
+ *
+ * Compress the larger tuples sent by motion nodes, for as long as it pays.
+ */
+extern bool gp_interconnect_compression;
+
+/*
+ * Parameter gp_interconnect_batch_tuples
+ *
+ * Send the tuples of redistribute motions in batches, many tuples per chunk,
+ * with the fixed-width columns stored column by column.
+ */
+extern bool gp_interconnect_batch_tuples;
+
 /*
  * Parameter gp_segment
  *
@@ -810,6 +842,9 @@ extern bool gp_enable_sort_distinct;
 extern bool gp_enable_mk_sort;
 extern bool gp_enable_motion_mk_sort;
 
+/* Maximum number of helper threads of an in-memory MK sort (0 = none) */
+extern int gp_mk_sort_helper_threads;
+
 #ifdef USE_ASSERT_CHECKING
 extern bool gp_mk_sort_check;
 #endif
@@ -867,6 +902,33 @@ extern double gp_hashagg_rewrite_limit;
 /* If we use two stage hashagg, we can stream the bottom half */
 extern bool gp_hashagg_streambottom;
 
+/*
+ * The streaming bottom stage of two stage hashagg stops aggregating if it
+ * reduces its input rows by less than this factor (0 = never).
+ */
+extern double gp_hashagg_streambottom_min_reduction;
+
+/* Read AOCS scans a batch at a time, and aggregate over the batches */
+extern bool gp_enable_batch_execution;
+
+/* Read the columns of AOCS scans that the quals do not need late */
+extern bool gp_enable_aocs_late_materialization;
+
+/* Skip the blocks of AOCS scans that the zone maps show cannot pass the quals */
+extern bool gp_enable_aocs_zone_maps;
+
+/* Let hash joins filter the rows of their outer scans with a bloom filter */
+extern bool gp_enable_runtime_filter;
+
+/* Keep the hash tables of hash joins as radix-partitioned arrays */
+extern bool gp_enable_radix_hashjoin;
+
+/* Keep the hash join tuples of the most common outer values in memory */
+extern bool gp_enable_skew_hashjoin;
+
+/* Keep the groups of hash aggregates in an open addressing hash table */
+extern bool gp_enable_hashagg_open_addressing;
+
 /* The default number of batches to use when the hybrid hashed aggregation
  * algorithm (re-)spills in-memory groups to disk.
  */
@@ -317,6 +317,7 @@ extern void markUDPConnInactiveIFC(MotionConn *conn);
 extern void CleanupMotionTCP(void);
 extern void CleanupMotionUDPIFC(void);
 extern void WaitInterconnectQuitUDPIFC(void);
+extern void RemoveStaleInterconnectShm(void);
 extern void SetupTCPInterconnect(struct EState *estate);
 extern void SetupUDPIFCInterconnect(struct EState *estate);
 extern void TeardownTCPInterconnect(ChunkTransportState *transportStates,
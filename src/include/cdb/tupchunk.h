@@ -21,6 +21,7 @@ typedef enum TupleChunkType
 	TC_PARTIAL_END,				/* Contains the final portion of a tuple. */
 	TC_END_OF_STREAM,			/* Indicates "end of tuples" from this source. */
 	TC_EMPTY,					/* Empty tuple */
+	TC_BATCH,					/* Contains a batch of whole tuples. */
 	TC_MAXVAL					/* For range checks on type values. */
 } TupleChunkType;
 
@@ -43,6 +44,12 @@ typedef enum TupleChunkType
 
 #define TUPLE_CHUNK_HEADER_SIZE 4
 
+/* The type field of the first chunk of a tuple has this bit set if the
+ * serialized tuple was compressed (see CompressTupleChunks()). The other
+ * chunks of the tuple, and GetChunkType(), don't see it.
+ */
+#define TC_COMPRESSED_FLAG		0x8000
+
 /* see MPP-2099, let's not run into this one again! NOTE: the
  * definition of BROADCAST_SEGIDX is *key*.
  *
@@ -70,7 +77,10 @@ typedef enum TupleChunkType
 	do { uint16 sizeid; memcpy(&sizeid, (GetChunkDataPtr(tcItem)), sizeof(uint16)); *(sizep) = sizeid; } while (0)
 
 #define GetChunkType(/* uint 8 * */tcItem, /* TupleChunkType * */typep) \
-	do { uint16 typeid; memcpy(&typeid, (GetChunkDataPtr(tcItem) + 2), sizeof(uint16)); *(typep) = typeid; } while (0)
+	do { uint16 typeid; memcpy(&typeid, (GetChunkDataPtr(tcItem) + 2), sizeof(uint16)); *(typep) = typeid & ~TC_COMPRESSED_FLAG; } while (0)
+
+#define GetChunkCompressed(/* uint 8 * */tcItem, /* bool * */compressedp) \
+	do { uint16 typeid; memcpy(&typeid, (GetChunkDataPtr(tcItem) + 2), sizeof(uint16)); *(compressedp) = (typeid & TC_COMPRESSED_FLAG) != 0; } while (0)
 
 #define SetChunkDataSize(/* uint8 * */tc_data, /* uint16 */value) \
 	do { uint16 val = (value); memcpy((tc_data), &val, sizeof(uint16)); } while (0)
@@ -78,4 +88,7 @@ typedef enum TupleChunkType
 #define SetChunkType(/* uint8 * */tc_data, /* TupleChunkType */value) \
 	do { uint16 val = (value); memcpy(((tc_data)+2), &val, sizeof(uint16)); } while (0)
 
+#define SetChunkCompressed(/* uint8 * */tc_data) \
+	do { uint16 val; memcpy(&val, ((tc_data)+2), sizeof(uint16)); val |= TC_COMPRESSED_FLAG; memcpy(((tc_data)+2), &val, sizeof(uint16)); } while (0)
+
 #endif   /* TUPCHUNK_H */
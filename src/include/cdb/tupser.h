@@ -84,6 +84,37 @@ typedef struct SerTupInfo
 	bool		has_record_types;
 }	SerTupInfo;
 
+/*
+ * A batch of tuples collected for one route, to be sent column-major in a
+ * single TC_BATCH chunk (see gp_interconnect_batch_tuples).
+ */
+typedef struct TupleBatch
+{
+	MemoryContext mcxt;			/* where the buffers below are allocated */
+	int			ntuples;
+	int			datalen;		/* total length of cols[] */
+	StringInfoData *cols;		/* values of each attribute, NULL until used */
+	bits8	   *nullbits;		/* null bitmap of each attribute */
+	bool	   *hasnulls;		/* does the attribute have nulls? */
+}	TupleBatch;
+
+/*
+ * A TC_BATCH chunk as received, decoded into values/nulls arrays.  The
+ * by-reference values point into buf, so the tuples can be handed out as
+ * virtual tuples without forming them.
+ */
+typedef struct RecvTupleBatch
+{
+	int			ntuples;
+	int			next;			/* index of the next tuple to hand out */
+	char	   *buf;			/* copy of the chunk data */
+	Datum	   *values;			/* ntuples * natts, one tuple after another */
+	bool	   *nulls;
+	struct RecvTupleBatch *next_batch;
+}	RecvTupleBatch;
+
+#define TUPLE_BATCH_MAX_TUPLES 1024
+
 /*
  * forward declaration to avoid #including cdbmotion.h here, which would create a circular
  * dependency
@@ -106,9 +137,29 @@ extern void SerializeRecordCacheIntoChunks(SerTupInfo *pSerInfo,
 /* Convert a HeapTuple into chunks ready to send out, in one pass */
 extern void SerializeTupleIntoChunks(HeapTuple tuple, SerTupInfo *pSerInfo, TupleChunkList tcList);
 
+/* Replace the tuple in a chunk list with its compressed form, if smaller */
+extern bool CompressTupleChunks(SerTupInfo *pSerInfo, TupleChunkList tcList);
+
 /* Convert a HeapTuple into chunks directly in a set of transport buffers */
 extern int SerializeTupleDirect(HeapTuple tuple, SerTupInfo *pSerInfo, struct directTransportBuffer *b);
 
+/* Can tuples of this description be sent in batches? */
+extern bool TupleBatchSupported(SerTupInfo *pSerInfo);
+
+/* Set up an empty tuple batch, or empty an existing one */
+extern void InitTupleBatch(SerTupInfo *pSerInfo, TupleBatch *batch, MemoryContext mcxt);
+extern void ResetTupleBatch(SerTupInfo *pSerInfo, TupleBatch *batch);
+
+/* Add a deformed tuple to a batch, if it fits */
+extern bool AddTupleToBatch(SerTupInfo *pSerInfo, TupleBatch *batch, Datum *values, bool *nulls);
+
+/* Write the batch into the data of a TC_BATCH chunk, and return its length */
+extern int SerializeTupleBatch(SerTupInfo *pSerInfo, TupleBatch *batch, char *dest);
+
+/* Decode a TC_BATCH chunk, and free a decoded batch */
+extern RecvTupleBatch *DeserializeTupleBatch(SerTupInfo *pSerInfo, TupleChunkListItem tcItem);
+extern void FreeRecvTupleBatch(RecvTupleBatch *batch);
+
 /* Deserialize a HeapTuple's data from a byte-array. */
 extern HeapTuple DeserializeTuple(SerTupInfo * pSerInfo, StringInfo serialTup);
 
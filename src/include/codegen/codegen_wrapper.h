@@ -32,8 +32,16 @@ struct ExprContext;
 struct ExprState;
 struct PlanState;
 struct AggState;
+struct MotionState;
+struct HashJoinState;
 struct MemoryManagerContainer;
 struct AggStatePerGroupData;
+struct List;
+struct CdbHash;
+struct HashJoinTableData;
+struct MKEntry;
+struct MKLvContext;
+struct MKContext;
 /*
  * Enum used to mimic ExprDoneCond in ExecEvalExpr function pointer.
  */
@@ -45,16 +53,23 @@ typedef void (*AdvanceAggregatesFn) (struct AggState *aggstate, /*struct AggStat
 typedef void (*ExecVariableListFn) (struct ProjectionInfo *projInfo, Datum *values, bool *isnull);
 typedef Datum (*ExecEvalExprFn) (struct ExprState *expression, struct ExprContext *econtext, bool *isNull, /*ExprDoneCond*/ tmp_enum *isDone);
 typedef Datum (*SlotGetAttrFn) (struct TupleTableSlot *slot, int attnum, bool *isnull);
+typedef void (*HashMotionKeysFn) (struct ExprContext *econtext, struct List *hashkeys, struct List *hashtypes, struct CdbHash *h);
+typedef void (*CalcHashKeysFn) (struct AggState *aggstate, struct TupleTableSlot *inputslot);
+typedef bool (*ExecHashGetHashKeysFn) (struct HashJoinTableData *hashtable, struct ExprContext *econtext, struct List *hashkeys, bool outer_tuple, bool keep_nulls, uint32 *hashvalue, bool *hashkeys_null);
+typedef int32 (*MKCompareFn) (struct MKEntry *v1, struct MKEntry *v2, struct MKLvContext *lvctxt, struct MKContext *mkctxt);
 
 #ifndef USE_CODEGEN
 
 #define InitCodegen() ((void) 1)
 #define CodeGeneratorManagerCreate(module_name) ((void *) NULL)
+#define CodeGeneratorManagerSetEstimatedRows(manager, estimated_rows) ((void) 1)
 #define CodeGeneratorManagerGenerateCode(manager) ((unsigned int) 1)
 #define CodeGeneratorManagerPrepareGeneratedFunctions(manager) ((unsigned int) 1)
 #define CodeGeneratorManagerNotifyParameterChange(manager) ((unsigned int) 1)
 #define CodeGeneratorManagerAccumulateExplainString(manager) ((void) 1)
 #define CodeGeneratorManagerGetExplainString(manager) ((char *) NULL)
+#define CodeGeneratorManagerGetStatisticsString(manager) ((char *) NULL)
+#define CodeGeneratorCacheGetExplainString() ((char *) NULL)
 #define CodeGeneratorManagerDestroy(manager) ((void) 1)
 #define GetActiveCodeGeneratorManager() ((void *) NULL)
 #define SetActiveCodeGeneratorManager(manager) ((void) 1)
@@ -67,6 +82,15 @@ typedef Datum (*SlotGetAttrFn) (struct TupleTableSlot *slot, int attnum, bool *i
 #define enroll_ExecVariableList_codegen(regular_func, ptr_to_chosen_func, proj_info, slot)
 #define call_AdvanceAggregates(aggstate, pergroup, mem_manager) advance_aggregates(aggstate, pergroup, mem_manager)
 #define enroll_AdvanceAggregates_codegen(regular_func, ptr_to_chosen_func, aggstate)
+#define call_HashMotionKeys(motionstate, econtext, hashkeys, hashtypes, h) hashMotionKeys(econtext, hashkeys, hashtypes, h)
+#define enroll_HashMotionKeys_codegen(regular_func, ptr_to_chosen_func, motionstate)
+#define call_CalcHashKeys(aggstate, inputslot) calc_hash_keys(aggstate, inputslot)
+#define enroll_CalcHashKeys_codegen(regular_func, ptr_to_chosen_func, aggstate)
+#define call_ExecHashGetHashKeys(hashState, hashtable, econtext, hashkeys, outer_tuple, keep_nulls, hashvalue, hashkeys_null) \
+		ExecHashGetHashKeys(hashtable, econtext, hashkeys, outer_tuple, keep_nulls, hashvalue, hashkeys_null)
+#define enroll_ExecHashGetHashKeys_codegen(regular_func, gen_info, hjstate, outer_tuple)
+#define get_MKCompare_fn(gen_info) tupsort_compare_datum
+#define enroll_MKCompare_codegen(regular_func, gen_info, num_keys, sort_operators)
 #else
 
 /*
@@ -111,6 +135,13 @@ InitCodegen();
 void*
 CodeGeneratorManagerCreate(const char* module_name);
 
+/*
+ * Sets the number of rows the operator is expected to process, used to skip
+ * code generation that would not pay off
+ */
+void
+CodeGeneratorManagerSetEstimatedRows(void* manager, double estimated_rows);
+
 /*
  * Calls all the registered CodegenInterface to generate code
  */
@@ -149,6 +180,20 @@ CodeGeneratorManagerAccumulateExplainString(void* manager);
 char*
 CodeGeneratorManagerGetExplainString(void* manager);
 
+/*
+ * Return a copy in CurrentMemoryContext of the time spent generating and
+ * compiling code, and of whether each generated function was used
+ */
+char*
+CodeGeneratorManagerGetStatisticsString(void* manager);
+
+/*
+ * Return a summary in CurrentMemoryContext of the statistics of the
+ * backend-local cache of compiled code
+ */
+char*
+CodeGeneratorCacheGetExplainString();
+
 /*
  * Get the active code generator manager
  */
@@ -212,6 +257,42 @@ AdvanceAggregatesCodegenEnroll(AdvanceAggregatesFn regular_func_ptr,
 		AdvanceAggregatesFn* ptr_to_regular_func_ptr,
 		struct AggState *aggstate);
 
+/*
+ * Enroll and returns the pointer to HashMotionKeysGenerator
+ */
+void*
+HashMotionKeysCodegenEnroll(HashMotionKeysFn regular_func_ptr,
+                            HashMotionKeysFn* ptr_to_regular_func_ptr,
+                            struct MotionState *motionstate);
+
+/*
+ * Enroll and returns the pointer to CalcHashKeysGenerator
+ */
+void*
+CalcHashKeysCodegenEnroll(CalcHashKeysFn regular_func_ptr,
+                          CalcHashKeysFn* ptr_to_regular_func_ptr,
+                          struct AggState *aggstate);
+
+/*
+ * Enroll and returns the pointer to ExecHashGetHashKeysGenerator, for the
+ * outer or the inner hash keys of a hash join
+ */
+void*
+ExecHashGetHashKeysCodegenEnroll(ExecHashGetHashKeysFn regular_func_ptr,
+                                 ExecHashGetHashKeysFn* ptr_to_regular_func_ptr,
+                                 struct HashJoinState *hjstate,
+                                 bool outer_tuple);
+
+/*
+ * Enroll and returns the pointer to MKCompareGenerator, for the sort keys
+ * given by their ordering operators
+ */
+void*
+MKCompareCodegenEnroll(MKCompareFn regular_func_ptr,
+                       MKCompareFn* ptr_to_regular_func_ptr,
+                       int num_keys,
+                       Oid *sort_operators);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -269,6 +350,37 @@ AdvanceAggregatesCodegenEnroll(AdvanceAggregatesFn regular_func_ptr,
 #define call_AdvanceAggregates(aggstate, pergroup, mem_manager) \
 		aggstate->AdvanceAggregates_gen_info.AdvanceAggregates_fn(aggstate, pergroup, mem_manager)
 
+/*
+ * Call hashMotionKeys using function pointer HashMotionKeys_fn.
+ * Function pointer may point to regular version or generated function
+ */
+#define call_HashMotionKeys(motionstate, econtext, hashkeys, hashtypes, h) \
+		(motionstate)->HashMotionKeys_gen_info.HashMotionKeys_fn(econtext, hashkeys, hashtypes, h)
+
+/*
+ * Call calc_hash_keys using function pointer CalcHashKeys_fn.
+ * Function pointer may point to regular version or generated function
+ */
+#define call_CalcHashKeys(aggstate, inputslot) \
+		(aggstate)->CalcHashKeys_gen_info.CalcHashKeys_fn(aggstate, inputslot)
+
+/*
+ * Call ExecHashGetHashKeys using the function pointer of the outer or the
+ * inner hash keys. Function pointer may point to regular version or
+ * generated function
+ */
+#define call_ExecHashGetHashKeys(hashState, hashtable, econtext, hashkeys, outer_tuple, keep_nulls, hashvalue, hashkeys_null) \
+		((outer_tuple) ? \
+		 (hashState)->ExecHashGetOuterHashKeys_gen_info.ExecHashGetHashKeys_fn : \
+		 (hashState)->ExecHashGetInnerHashKeys_gen_info.ExecHashGetHashKeys_fn)( \
+				hashtable, econtext, hashkeys, outer_tuple, keep_nulls, hashvalue, hashkeys_null)
+
+/*
+ * Function pointer of the comparator of prepared datums for a multi-key sort
+ * or merge; it may point to regular version or generated function
+ */
+#define get_MKCompare_fn(gen_info) ((gen_info)->MKCompare_fn)
+
 /*
  * Enrollment macros
  * The enrollment process also ensures that the generated function pointer
@@ -289,6 +401,26 @@ AdvanceAggregatesCodegenEnroll(AdvanceAggregatesFn regular_func_ptr,
 				regular_func, ptr_to_regular_func_ptr, aggstate); \
 				Assert(aggstate->AdvanceAggregates_gen_info.AdvanceAggregates_fn == regular_func); \
 
+#define enroll_HashMotionKeys_codegen(regular_func, ptr_to_regular_func_ptr, motionstate) \
+		(motionstate)->HashMotionKeys_gen_info.code_generator = HashMotionKeysCodegenEnroll( \
+				regular_func, ptr_to_regular_func_ptr, motionstate); \
+				Assert((motionstate)->HashMotionKeys_gen_info.HashMotionKeys_fn == regular_func); \
+
+#define enroll_CalcHashKeys_codegen(regular_func, ptr_to_regular_func_ptr, aggstate) \
+		(aggstate)->CalcHashKeys_gen_info.code_generator = CalcHashKeysCodegenEnroll( \
+				regular_func, ptr_to_regular_func_ptr, aggstate); \
+				Assert((aggstate)->CalcHashKeys_gen_info.CalcHashKeys_fn == regular_func); \
+
+#define enroll_ExecHashGetHashKeys_codegen(regular_func, gen_info, hjstate, outer_tuple) \
+		(gen_info)->code_generator = ExecHashGetHashKeysCodegenEnroll( \
+				regular_func, &(gen_info)->ExecHashGetHashKeys_fn, hjstate, outer_tuple); \
+				Assert((gen_info)->ExecHashGetHashKeys_fn == regular_func); \
+
+#define enroll_MKCompare_codegen(regular_func, gen_info, num_keys, sort_operators) \
+		(gen_info)->code_generator = MKCompareCodegenEnroll( \
+				regular_func, &(gen_info)->MKCompare_fn, num_keys, sort_operators); \
+				Assert((gen_info)->MKCompare_fn == regular_func); \
+
 #endif //USE_CODEGEN
 
 #endif  // CODEGEN_WRAPPER_H_
@@ -0,0 +1,28 @@
+/*
+ * execBatch.h
+ *   Batch-at-a-time evaluation of scan quals and simple aggregates.
+ *
+ * Copyright (c) 2016 - present, Pivotal Software, Inc.
+ */
+#ifndef EXECBATCH_H
+#define EXECBATCH_H
+
+#include "cdb/cdbaocsam.h"
+#include "nodes/execnodes.h"
+
+typedef struct BatchAggState BatchAggState;
+
+extern bool ExecSupportsBatchQual(List *qual, Index scanrelid, TupleDesc tupdesc);
+extern void ExecPushDownBatchQual(List *qual, Index scanrelid, TupleDesc tupdesc,
+								  AOCSBatch batch);
+extern bool ExecBuildScanPredicates(List *qual, Index scanrelid, TupleDesc tupdesc,
+									int **npreds, DatumStreamPredicate ***preds);
+extern void ExecFreeScanPredicates(int ncol, int *npreds, DatumStreamPredicate **preds);
+
+extern BatchAggState *ExecInitBatchAgg(AggState *aggstate);
+extern void ExecResetBatchAgg(BatchAggState *state);
+extern void ExecBatchAdvanceAggregates(BatchAggState *state, AOCSBatch batch);
+extern void ExecBatchAggEnd(BatchAggState *state, AggState *aggstate,
+							AggStatePerGroup pergroup);
+
+#endif   /* EXECBATCH_H */
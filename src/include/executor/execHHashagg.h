@@ -156,6 +156,14 @@ typedef struct HashAggTable
 	HashAggBucket  *buckets;
 	uint64 *bloom;
 
+	/*
+	 * In open addressing mode, there are no chains: buckets[i] is the entry
+	 * in slot i, if any, and tags[i] is 0 if the slot is free, else a tag of
+	 * the hash key of its entry. bloom is not used.
+	 */
+	bool open_addressing;
+	uint8 *tags;
+
 	/* hashkey bitshift amount to determine bucket - used when spilling */
 	unsigned pshift;
 
@@ -207,6 +215,8 @@ typedef struct HashAggTable
 
 	bool is_spilling; /* indicate that spilling happened for this batch. */
 	bool expandable;  /* hash table buckets still have space to grow */
+	bool passthrough; /* streaming input rows without aggregating them */
+	uint64 num_passthrough_tuples; /* number of rows streamed as their own groups */
 	struct TupleTableSlot *prev_slot; /* a slot that is read previously. */
 
 	/* Statistics used for EXPLAIN ANALYZE */
@@ -215,6 +225,7 @@ typedef struct HashAggTable
 } HashAggTable;
 
 extern HashAggTable *create_agg_hash_table(AggState *aggstate);
+extern void calc_hash_keys(AggState *aggstate, TupleTableSlot *inputslot);
 extern bool agg_hash_initial_pass(AggState *aggstate);
 extern bool agg_hash_stream(AggState *aggstate);
 extern bool agg_hash_next_pass(AggState *aggstate);
@@ -345,6 +345,9 @@ extern void ReScanAppendOnlyRelation(ScanState *scanState);
  * prototypes from functions in execAOCSScan.c
  */
 extern TupleTableSlot *AOCSScanNext(ScanState *scanState);
+extern bool AOCSScanSupportsBatch(ScanState *scanState);
+extern bool AOCSScanSupportsLateMaterialization(ScanState *scanState);
+extern bool AOCSScanNextBatch(ScanState *scanState);
 extern void BeginScanAOCSRelation(ScanState *scanState);
 extern void EndScanAOCSRelation(ScanState *scanState);
 extern void ReScanAOCSRelation(ScanState *scanState);
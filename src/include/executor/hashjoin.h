@@ -141,6 +141,61 @@ typedef struct HashJoinBatchData
 } HashJoinBatchData;
 
 
+/*
+ * HashJoinRadixEntry
+ *
+ * In radix mode, the tuples of the current batch are not chained into
+ * buckets, but listed in an array of compact entries that keep the hash
+ * value of the tuple inline. Once the batch is loaded, the array is radix
+ * partitioned by bucket number (see ExecHashTableFinalize), so that a probe
+ * reads the entries of its bucket one after the other, and only touches the
+ * tuples whose hash value matches.
+ */
+typedef struct HashJoinRadixEntry
+{
+	uint32		hashvalue;
+	struct HashJoinTupleData *tuple;
+} HashJoinRadixEntry;
+
+/*
+ * HashSkewBucket
+ *
+ * During the first batch, the inner tuples whose hash value is that of one
+ * of the most common values (MCVs) of the outer join key are kept in a
+ * separate skew hash table rather than in the main one, so that they never
+ * go to a batch file, and neither do the outer tuples that match them. The
+ * skew hash table is an open addressing table of skewBucketLen pointers,
+ * with one HashSkewBucket per MCV hash value, which chains its tuples like a
+ * bucket of the main table.
+ *
+ * SKEW_WORK_MEM_PERCENT is the share of the memory of the hash table that
+ * goes to the skew hash table, and the skew optimization is only used if
+ * the MCVs that fit cover at least SKEW_MIN_OUTER_FRACTION of the outer
+ * relation.
+ */
+typedef struct HashSkewBucket
+{
+	uint32		hashvalue;		/* common hash value */
+	struct HashJoinTupleData *tuples;	/* linked list of inner tuples */
+} HashSkewBucket;
+
+#define SKEW_BUCKET_OVERHEAD  MAXALIGN(sizeof(HashSkewBucket))
+#define INVALID_SKEW_BUCKET_NO  (-1)
+#define SKEW_WORK_MEM_PERCENT  2
+#define SKEW_MIN_OUTER_FRACTION  0.01
+
+/*
+ * Number of outer tuples read ahead when probing a radix-partitioned hash
+ * table.
+ */
+#define HJ_PREFETCH_DISTANCE	8
+
+#if defined(__GNUC__)
+#define HJ_PREFETCH(addr)	__builtin_prefetch(addr)
+#else
+#define HJ_PREFETCH(addr)	((void) 0)
+#endif
+
 /*
  * HashJoinTableData
  */
@@ -154,6 +209,32 @@ typedef struct HashJoinTableData
 	uint64     				  *bloom; /* bloom[i] is bloomfilter for buckets[i] */
 	/* buckets array is per-batch storage, as are all the tuples */
 
+	/*
+	 * In radix mode, buckets is NULL, and the entries of bucket i are
+	 * radixEntries[radixBuckets[i] .. radixBuckets[i + 1] - 1]. radixBuckets
+	 * is NULL until the batch is finalized. Per-batch storage too.
+	 */
+	bool		radix;
+	HashJoinRadixEntry *radixEntries;
+	uint32		nradixEntries;
+	uint32		maxRadixEntries;	/* allocated size of radixEntries */
+	uint32	   *radixBuckets;
+
+	/*
+	 * Skew hash table, only used during the first batch (see HashSkewBucket).
+	 * skewBucketNums lists the buckets in use, most common value first, so
+	 * they can be dumped least common first if it runs out of space.
+	 */
+	bool		skewEnabled;
+	HashSkewBucket **skewBucket;
+	int			skewBucketLen;	/* size of skewBucket (a power of 2) */
+	int			nSkewBuckets;	/* number of buckets in use */
+	int		   *skewBucketNums;
+	Size		spaceUsedSkew;	/* space used by the skew hash table */
+	Size		spaceAllowedSkew;	/* upper limit for spaceUsedSkew */
+	int			nSkewValues;	/* skew buckets kept through the first batch */
+	double		skewOuterTuples;	/* outer tuples probing a skew bucket */
+
 	int			nbatch;			/* number of batches */
 	int			curbatch;		/* current batch #; 0 during 1st pass */
 
@@ -191,6 +272,16 @@ typedef struct HashJoinTableData
 
     HashJoinState * hjstate; /* reference to the enclosing HashJoinState */
 
+	/*
+	 * Bloom filter of the hash values of all the inner tuples, including
+	 * those of later batches, for the runtime filter of the join (NULL if it
+	 * has none). Only used once runtimeFilterReady is set, when the whole
+	 * inner side has been read.
+	 */
+	uint64	   *runtimeFilter;
+	uint32		runtimeFilterMask;	/* number of bits - 1 */
+	bool		runtimeFilterReady;
+
 } HashJoinTableData;
 
 #endif   /* HASHJOIN_H */
@@ -38,6 +38,13 @@ extern bool ExecHashGetHashValue(HashState *hashState, HashJoinTable hashtable,
 					 bool keep_nulls,
 					 uint32 *hashvalue,
 					 bool *hashkeys_null);
+extern bool ExecHashGetHashKeys(HashJoinTable hashtable,
+					ExprContext *econtext,
+					List *hashkeys,
+					bool outer_tuple,
+					bool keep_nulls,
+					uint32 *hashvalue,
+					bool *hashkeys_null);
 extern void ExecHashGetBucketAndBatch(HashJoinTable hashtable,
 						  uint32 hashvalue,
 						  int *bucketno,
@@ -45,6 +52,11 @@ extern void ExecHashGetBucketAndBatch(HashJoinTable hashtable,
 extern HashJoinTuple ExecScanHashBucket(HashState *hashState, HashJoinState *hjstate,
 				   ExprContext *econtext);
 extern void ExecHashTableReset(HashState *hashState, HashJoinTable hashtable);
+extern void ExecHashTableFinalize(HashState *hashState, HashJoinTable hashtable);
+extern int	ExecHashGetSkewBucket(HashJoinTable hashtable, uint32 hashvalue);
+extern bool ExecSupportsRuntimeFilter(HashJoinState *hjstate);
+extern bool ExecRuntimeFilterPass(RuntimeFilterState *rf, TupleTableSlot *slot);
+extern void ExecResetRuntimeFilter(RuntimeFilterState *rf);
 extern void ExecHashTableExplainInit(HashState *hashState, HashJoinState *hjstate,
                                      HashJoinTable  hashtable);
 extern void ExecHashTableExplainBatchEnd(HashState *hashState, HashJoinTable hashtable);
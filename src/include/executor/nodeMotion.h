@@ -24,6 +24,8 @@ extern void ExecStopMotion(MotionState *node);
 
 extern bool isMotionGather(const Motion *m);
 
+extern void hashMotionKeys(ExprContext *econtext, List *hashkeys, List *hashtypes, struct CdbHash *h);
+
 static inline gpmon_packet_t * GpmonPktFromMotionState(MotionState *node)
 {
 	return &node->ps.gpmon_pkt;
@@ -7,10 +7,12 @@
 #define NODETABLESCAN_H
 
 #include "nodes/execnodes.h"
+#include "cdb/cdbaocsam.h"
 
 extern int	ExecCountSlotsTableScan(TableScan *node);
 extern TableScanState *ExecInitTableScan(TableScan *node, EState *estate, int eflags);
 extern TupleTableSlot *ExecTableScan(TableScanState *node);
+extern AOCSBatch ExecTableScanBatch(TableScanState *node);
 extern void ExecEndTableScan(TableScanState *node);
 extern void ExecTableMarkPos(TableScanState *node);
 extern void ExecTableRestrPos(TableScanState *node);
@@ -1617,6 +1617,26 @@ typedef enum
  *		tableType		   the table type of the target relation
  * ----------------
  */
+/*
+ * RuntimeFilterState
+ *    A filter a hash join sets on the scan under its outer side: a bloom
+ * filter of the hash values of the inner join keys, so that the scan drops
+ * the rows that cannot find a match before they go up to the join. See
+ * ExecRuntimeFilterPass().
+ */
+typedef struct RuntimeFilterState
+{
+	struct HashJoinState *hjstate;	/* the join, whose hash table has the
+									 * bloom filter */
+	ExprContext *econtext;		/* to evaluate the outer hash keys in */
+	int64		nchecked;		/* # rows checked */
+	int64		nremoved;		/* # rows removed */
+	int64		nsampled;		/* # rows checked in this scan */
+	int64		nsampleRemoved;	/* # rows removed in this scan */
+	bool		disabled;		/* stopped checking in this scan, too few
+								 * were removed */
+} RuntimeFilterState;
+
 typedef struct ScanState
 {
 	PlanState	ps;				/* its first field is NodeTag */
@@ -1627,6 +1647,9 @@ typedef struct ScanState
 
 	/* The type of the table that is being scanned */
 	TableType	tableType;
+
+	/* Set by a hash join above, to drop the rows that cannot join */
+	RuntimeFilterState *runtimeFilter;
 } ScanState;
 
 /*
@@ -2024,16 +2047,36 @@ typedef struct AOCSScanOpaqueData
 	int			ncol;
 
 	struct AOCSScanDescData *scandesc;
+
+	/*
+	 * Used in batch mode: the current batch, with the scan quals pushed
+	 * down into it, and the position in sel of the next row AOCSScanNext()
+	 * returns.
+	 */
+	struct AOCSBatchData *batch;
+	int			batchNext;
+
+	/*
+	 * Predicates for the zone maps of the columns, built from the scan quals
+	 * when not in batch mode; see ExecBuildScanPredicates().
+	 */
+	int		   *zoneMapNPreds;
+	struct DatumStreamPredicate **zoneMapPreds;
 } AOCSScanOpaqueData;
 
 /* -----------------------------------------------
  *      AOCSScanState
+ *
+ * Must have the same layout as TableScanState.
  * -----------------------------------------------
  */
 typedef struct AOCSScanState
 {
 	ScanState ss;
 	AOCSScanOpaqueData *opaque;
+	bool		batchMode;
+	List	   *lateQual;
+	int64		zoneMapSkippedBlocks;
 } AOCSScanState;
 
 /*
@@ -2051,6 +2094,24 @@ typedef struct TableScanState
 	 * Opaque data that is associated with different table type.
 	 */
 	void	   *opaque;
+
+	/*
+	 * Is the scan read a batch at a time? Only AOCS scans with
+	 * gp_enable_batch_execution set, see ExecInitTableScan. The scan quals
+	 * are then evaluated while the columns of each batch are read, instead
+	 * of by ExecScan.
+	 */
+	bool		batchMode;
+
+	/*
+	 * The scan quals, if they are evaluated by the AOCS scan itself before
+	 * it reads the columns that only the targetlist needs; see
+	 * AOCSScanSupportsLateMaterialization. ss.ps.qual is then NIL.
+	 */
+	List	   *lateQual;
+
+	/* Blocks skipped thanks to zone maps by the AOCS scans ended so far */
+	int64		zoneMapSkippedBlocks;
 } TableScanState;
 
 /*
@@ -2205,6 +2266,8 @@ typedef struct MergeJoinState
  *								(NULL if table not built yet)
  *		hj_CurHashValue			hash value for current outer tuple
  *		hj_CurBucketNo			bucket# for current outer tuple
+ *		hj_CurSkewBucketNo		skew bucket# for current outer tuple, or
+ *								INVALID_SKEW_BUCKET_NO
  *		hj_CurTuple				last inner tuple matched to current outer
  *								tuple, or NULL if starting search
  *								(CurHashValue, CurBucketNo and CurTuple are
@@ -2236,6 +2299,8 @@ typedef struct HashJoinState
 	uint32		hj_CurHashValue;
 	int			hj_CurBucketNo;
 	HashJoinTuple hj_CurTuple;
+	uint32		hj_CurRadixEntry;	/* entry of hj_CurTuple, in radix mode */
+	int			hj_CurSkewBucketNo;	/* skew bucket# for current outer tuple */
 	List	   *hj_OuterHashKeys;		/* list of ExprState nodes */
 	List	   *hj_InnerHashKeys;		/* list of ExprState nodes */
 	List	   *hj_HashOperators;		/* list of operator OIDs */
@@ -2252,6 +2317,19 @@ typedef struct HashJoinState
 
 	/* set if the operator created workfiles */
 	bool workfiles_created;
+
+	/* the filter set on the outer scan, or NULL */
+	RuntimeFilterState *hj_RuntimeFilter;
+
+	/*
+	 * Outer tuples read ahead in radix mode, so that their buckets can be
+	 * prefetched before they are probed; see ExecHashJoinPrefetchOuter.
+	 */
+	TupleTableSlot **hj_PrefetchSlots;	/* NULL if not reading ahead */
+	uint32	   *hj_PrefetchHashValues;
+	int			hj_PrefetchHead;	/* index of the next tuple to return */
+	int			hj_PrefetchCount;	/* number of tuples queued */
+	bool		hj_PrefetchDone;	/* outer plan is exhausted */
 } HashJoinState;
 
 
@@ -2328,6 +2406,14 @@ extern void shareinput_create_bufname_prefix(char* p, int size, int share_id);
  *	 SortState information
  * ----------------
  */
+typedef struct MKCompareCodegenInfo
+{
+	/* Pointer to store MKCompareCodegen from Codegen */
+	void* code_generator;
+	/* Function pointer that points to either regular or generated tupsort_compare_datum */
+	MKCompareFn MKCompare_fn;
+} MKCompareCodegenInfo;
+
 typedef struct SortState
 {
 	ScanState	ss;				/* its first field is NodeTag */
@@ -2342,6 +2428,9 @@ typedef struct SortState
 
 	void	   *share_lk_ctxt;
 
+#ifdef USE_CODEGEN
+	MKCompareCodegenInfo MKCompare_gen_info;
+#endif
 } SortState;
 
 /* ---------------------
@@ -2365,6 +2454,14 @@ typedef struct AdvanceAggregatesCodegenInfo
 	AdvanceAggregatesFn AdvanceAggregates_fn;
 } AdvanceAggregatesCodegenInfo;
 
+typedef struct CalcHashKeysCodegenInfo
+{
+	/* Pointer to store CalcHashKeysCodegen from Codegen */
+	void* code_generator;
+	/* Function pointer that points to either regular or generated calc_hash_keys */
+	CalcHashKeysFn CalcHashKeys_fn;
+} CalcHashKeysCodegenInfo;
+
 /* these structs are private in nodeAgg.c: */
 typedef struct AggStatePerAggData *AggStatePerAgg;
 typedef struct AggStatePerGroupData *AggStatePerGroup;
@@ -2423,8 +2520,12 @@ typedef struct AggState
 	/* set if the operator created workfiles */
 	bool		workfiles_created;
 
+	/* set if the aggregates are advanced a batch at a time, see execBatch.c */
+	struct BatchAggState *batchAgg;
+
 #ifdef USE_CODEGEN
 	AdvanceAggregatesCodegenInfo AdvanceAggregates_gen_info;
+	CalcHashKeysCodegenInfo CalcHashKeys_gen_info;
 #endif
 } AggState;
 
@@ -2511,6 +2612,14 @@ typedef struct UniqueState
  *	 HashState information
  * ----------------
  */
+typedef struct ExecHashGetHashKeysCodegenInfo
+{
+	/* Pointer to store ExecHashGetHashKeysCodegen from Codegen */
+	void* code_generator;
+	/* Function pointer that points to either regular or generated ExecHashGetHashKeys */
+	ExecHashGetHashKeysFn ExecHashGetHashKeys_fn;
+} ExecHashGetHashKeysCodegenInfo;
+
 typedef struct HashState
 {
 	PlanState	ps;				/* its first field is NodeTag */
@@ -2520,6 +2629,12 @@ typedef struct HashState
 	bool		hs_quit_if_hashkeys_null;	/* quit building hash table if hashkeys are all null */
 	bool		hs_hashkeys_null;	/* found an instance wherein hashkeys are all null */
 	/* hashkeys is same as parent's hj_InnerHashKeys */
+
+#ifdef USE_CODEGEN
+	/* Hash key computation of the parent's outer and of our tuples */
+	ExecHashGetHashKeysCodegenInfo ExecHashGetOuterHashKeys_gen_info;
+	ExecHashGetHashKeysCodegenInfo ExecHashGetInnerHashKeys_gen_info;
+#endif
 } HashState;
 
 /* ----------------
@@ -2650,6 +2765,14 @@ typedef enum MotionStateType
  *         MotionState information
  * ----------------
  */
+typedef struct HashMotionKeysCodegenInfo
+{
+	/* Pointer to store HashMotionKeysCodegen from Codegen */
+	void* code_generator;
+	/* Function pointer that points to either regular or generated hashMotionKeys */
+	HashMotionKeysFn HashMotionKeys_fn;
+} HashMotionKeysCodegenInfo;
+
 typedef struct MotionState
 {
 	PlanState	ps;				/* its first field is NodeTag */
@@ -2687,6 +2810,11 @@ typedef struct MotionState
 	Oid		   *outputFunArray;	/* output functions for each column (debug only) */
 
 	int			numInputSegs;	/* the number of segments on the sending slice */
+
+#ifdef USE_CODEGEN
+	HashMotionKeysCodegenInfo HashMotionKeys_gen_info;
+	MKCompareCodegenInfo MKCompare_gen_info;
+#endif
 } MotionState;
 
 /*
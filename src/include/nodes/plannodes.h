@@ -1038,6 +1038,11 @@ typedef struct Hash
 {
 	Plan		plan;
 	bool		rescannable;            /* CDB: true => save rows for rescan */
+	/*
+	 * CDB: most common values of the outer join key, most common first, as
+	 * Consts, for the skew optimization of the join; NIL if not used.
+	 */
+	List	   *skewValues;
 	/* all other info is in the parent HashJoin node */
 } Hash;
 
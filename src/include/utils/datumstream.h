@@ -30,6 +30,45 @@
 /*	UNDONE: For now, just do Small Content */
 #define MAXDATUM_PER_AOCS_DENSE_BLOCK AONonBulkDenseContentHeader_MaxLargeRowCount
 
+/*
+ * A simple predicate on a fixed-length, pass-by-value column, evaluated by
+ * datumstreamread_batch_filter while the values are read. NULL values never
+ * pass.
+ *
+ * Float constants must not be NaN. A NaN column value is greater than any
+ * other value, as in float8_cmp_internal.
+ */
+typedef enum DatumStreamPredicateType
+{
+	DatumStreamPredicateType_Int2,
+	DatumStreamPredicateType_Int4,
+	DatumStreamPredicateType_Int8,
+	DatumStreamPredicateType_Float4,
+	DatumStreamPredicateType_Float8
+}	DatumStreamPredicateType;
+
+typedef enum DatumStreamPredicateOp
+{
+	DatumStreamPredicateOp_Eq,
+	DatumStreamPredicateOp_Ne,
+	DatumStreamPredicateOp_Lt,
+	DatumStreamPredicateOp_Le,
+	DatumStreamPredicateOp_Gt,
+	DatumStreamPredicateOp_Ge,
+	DatumStreamPredicateOp_Between,	/* value <= column <= value2 */
+	DatumStreamPredicateOp_In	/* column is one of inValues */
+}	DatumStreamPredicateOp;
+
+typedef struct DatumStreamPredicate
+{
+	DatumStreamPredicateType type;
+	DatumStreamPredicateOp op;
+	Datum		value;
+	Datum		value2;
+	int			nInValues;
+	Datum	   *inValues;
+}	DatumStreamPredicate;
+
 typedef struct DatumStreamWrite
 {
 	DatumStreamTypeInfo typeInfo;
@@ -56,6 +95,16 @@ typedef struct DatumStreamWrite
 
 	DatumStreamBlockWrite blockWrite;
 
+	/*
+	 * Zone map of the current block, as order keys of summaryType, if the
+	 * type of the column has one. See datumstream_order_key.
+	 */
+	bool		summarize;
+	DatumStreamPredicateType summaryType;
+	bool		blockHasValues;
+	int64		blockMinKey;
+	int64		blockMaxKey;
+
 	/*
 	 * EOFs of current segment file.
 	 */
@@ -287,11 +336,45 @@ extern int	datumstreamread_block(DatumStreamRead * ds,
 								  int colGroupNo);
 extern void datumstreamread_find(DatumStreamRead * datumStream,
 					 int32 rowNumInBlock);
+extern bool datumstreamread_seek_row(DatumStreamRead * ds,
+						 AppendOnlyBlockDirectory *blockDirectory,
+						 int colGroupNo,
+						 int64 rowNum);
 extern void datumstreamread_rewind_block(DatumStreamRead * datumStream);
 extern bool datumstreamread_find_block(DatumStreamRead * datumStream,
 						   DatumStreamFetchDesc datumStreamFetchDesc,
 						   int64 rowNum);
 
+/* Batch read op */
+extern int datumstreamread_batch(DatumStreamRead * ds,
+					  AppendOnlyBlockDirectory *blockDirectory,
+					  int colGroupNo,
+					  int maxRows,
+					  const bool *wanted,
+					  Datum *values,
+					  bool *nulls,
+					  int64 *rowNums);
+extern int datumstreamread_batch_filter(DatumStreamRead * ds,
+							 AppendOnlyBlockDirectory *blockDirectory,
+							 int colGroupNo,
+							 int maxRows,
+							 DatumStreamPredicate *preds,
+							 int npreds,
+							 bool *match,
+							 Datum *values,
+							 bool *nulls,
+							 int64 *rowNums);
+extern bool datumstream_predicate_match(DatumStreamPredicate *pred, Datum d);
+
+/* Zone maps */
+extern bool datumstream_summary_type(Oid typid, DatumStreamPredicateType *type);
+extern int64 datumstream_order_key(DatumStreamPredicateType type, Datum d);
+extern bool datumstream_predicate_range_match(DatumStreamPredicate *pred,
+								  int64 minKey, int64 maxKey);
+extern bool datumstreamread_skip_to_row(DatumStreamRead * ds,
+							int64 rowNum,
+							int64 *skippedBlocks);
+
 /*
  * MPP-17061: make sure datumstream_read_block_info was called first for the CO block
  * before calling datumstreamread_block_content.
@@ -2053,6 +2053,56 @@ DatumStreamBlockRead_Nth(DatumStreamBlockRead * dsr)
 	return dsr->nth;
 }
 
+/*
+ * Number of items after the current one that are stored as a plain array of
+ * fixed-length, pass-by-value datums: the block has no NULLs and is neither
+ * RLE_TYPE nor delta compressed. Sets *datap to the first of them.
+ *
+ * Returns 0 when the items must be read one at a time with
+ * DatumStreamBlockRead_Advance.
+ */
+inline static int32
+DatumStreamBlockRead_PlainRemaining(DatumStreamBlockRead * dsr, uint8 **datap)
+{
+	if (dsr->has_null || !dsr->typeInfo.byval || dsr->typeInfo.datumlen <= 0)
+		return 0;
+
+	if (dsr->datumStreamVersion != DatumStreamVersion_Original &&
+		(dsr->rle_block_was_compressed || dsr->delta_block_was_compressed))
+		return 0;
+
+	/* Without NULLs or compression, each item is a physical datum. */
+	Assert(dsr->physical_datum_index == dsr->nth);
+
+	/* Pre-positioned by block read to first item? */
+	if (dsr->physical_datum_index < 0)
+		*datap = dsr->datump;
+	else
+		*datap = dsr->datump + dsr->typeInfo.datumlen;
+
+	return dsr->logical_row_count - (dsr->nth + 1);
+}
+
+/*
+ * Skip over n items of a plain array found by
+ * DatumStreamBlockRead_PlainRemaining, leaving the last of them current as
+ * if DatumStreamBlockRead_Advance had been called n times.
+ */
+inline static void
+DatumStreamBlockRead_SkipPlain(DatumStreamBlockRead * dsr, int32 n)
+{
+	Assert(n > 0);
+	Assert(dsr->nth + n < dsr->logical_row_count);
+
+	if (dsr->physical_datum_index < 0)
+		dsr->datump += (n - 1) * dsr->typeInfo.datumlen;
+	else
+		dsr->datump += n * dsr->typeInfo.datumlen;
+
+	dsr->nth += n;
+	dsr->physical_datum_index += n;
+}
+
 extern void DatumStreamBlockRead_GetReadyOrig(
 								  DatumStreamBlockRead * dsr,
 								  uint8 * buffer,
@@ -503,8 +503,11 @@ extern bool optimizer_analyze_midlevel_partition;
 extern bool init_codegen;
 extern bool codegen;
 extern bool codegen_validate_functions;
-extern int codegen_varlen_tolerance;
+extern bool codegen_background_compile;
 extern int codegen_optimization_level;
+extern int codegen_cache_size;
+extern double codegen_saving_per_row;
+extern double codegen_compile_cost;
 
 /**
  * Enable logging of DPE match in optimizer.
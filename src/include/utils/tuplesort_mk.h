@@ -49,6 +49,8 @@ extern void cdb_tuplesort_init_mk(Tuplesortstate_mk *state, int unique,
 
 extern void tuplesort_set_bound_mk(Tuplesortstate_mk *state, int64 bound);
 
+extern void tuplesort_set_compare_mk(Tuplesortstate_mk *state, MKCompareFn compare);
+
 extern void tuplesort_puttupleslot_mk(Tuplesortstate_mk *state, TupleTableSlot *slot);
 extern void tuplesort_putindextuple_mk(Tuplesortstate_mk *state, IndexTuple tuple);
 extern void tuplesort_putdatum_mk(Tuplesortstate_mk *state, Datum val, bool isNull);
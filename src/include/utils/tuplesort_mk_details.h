@@ -245,6 +245,11 @@ typedef struct MKContext {
     /* callback capable of fetching a datum from the MKEntry data */
     MKFetchDatumForPrepare fetchForPrep;
 
+    /* Compares the prepared datums of a level.  This is tupsort_compare_datum,
+     *   unless the caller plugs in a comparator generated for its sort keys
+     */
+    MKCompare compare;
+
     /* Callback capable of copying prepared data from one MKEntry to another (freeing the dest MKEntry).
      * It can also be called with a NULL src so that the dst is simply freed.
      */
@@ -289,6 +294,13 @@ typedef struct MKContext {
 
 	/* Name of the index we're building, if any. Used for error messages. */
 	char	   *indexname;
+
+    /* Parts of the array are being sorted by helper threads, see
+     *   mk_qsort_parallel().  mk_qsort_impl() then skips
+     *   CHECK_FOR_INTERRUPTS() in every thread, the main one included, and
+     *   pending interrupts are serviced once all the parts are sorted.
+     */
+    bool parallelSort;
 } MKContext;
 
 /**
@@ -2496,7 +2496,7 @@ PG_FUNCTION_INFO_V1(numActiveMotionConns);
 Datum numActiveMotionConns(PG_FUNCTION_ARGS)
 {
 	uint32 num = 0;
-	if (Gp_interconnect_type == INTERCONNECT_TYPE_UDPIFC)
+	if (INTERCONNECT_IS_UDPIFC())
 		num = getActiveMotionConns();
 	PG_RETURN_UINT32(num);
 }
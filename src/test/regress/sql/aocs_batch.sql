@@ -0,0 +1,152 @@
+--
+-- Batch mode, predicate pushdown and late materialization of scans of
+-- column-oriented tables. The results must be the same with each of them on
+-- and off, and the same as over a row-oriented append-only table holding the
+-- same rows, with NULLs, a dropped column and deleted rows.
+--
+create schema aocs_batch;
+set search_path to aocs_batch;
+
+-- Count the rows that the query returns over only one of the tables: the
+-- placeholder TBL is replaced by co, then by ao.
+create or replace function rows_differ(query text) returns bigint as
+$$
+declare
+  co_query text := replace(query, 'TBL', 'co');
+  ao_query text := replace(query, 'TBL', 'ao');
+  n bigint;
+  m bigint;
+begin
+  execute 'select count(*) from ((' || co_query || ') except all (' || ao_query || ')) d' into n;
+  execute 'select count(*) from ((' || ao_query || ') except all (' || co_query || ')) d' into m;
+  return n + m;
+end;
+$$ language plpgsql;
+
+create table ao (k int, a int, b int8, c float8, d date, s smallint, x int, t text)
+  with (appendonly=true) distributed by (k);
+create table co (k int, a int, b int8, c float8, d date, s smallint, x int, t text)
+  with (appendonly=true, orientation=column) distributed by (k);
+insert into ao select i, case when i % 10 = 0 then null else i end, i % 100, i / 4.0,
+    date '2000-01-01' + i % 365, i % 7, i, case when i % 13 = 0 then null else 'row ' || i end
+  from generate_series(1, 10000) i;
+insert into co select * from ao;
+
+-- Deleted rows are only hidden by the visibility map.
+delete from ao where k % 17 = 0;
+delete from co where k % 17 = 0;
+
+-- The rows inserted before the drop still store the dropped column.
+alter table ao drop column x;
+alter table co drop column x;
+insert into ao select i, case when i % 10 = 0 then null else i end, i % 100, i / 4.0,
+    date '2000-01-01' + i % 365, i % 7, case when i % 13 = 0 then null else 'row ' || i end
+  from generate_series(10001, 12000) i;
+insert into co select * from ao where k > 10000;
+
+-- Pushed down quals are evaluated in place over the blocks that store plain
+-- arrays of values, and value by value over the others: those with NULLs,
+-- and all the blocks of a run-length encoded table.
+create table co_rle (k int, a int, b int8, c float8, d date, s smallint, t text)
+  with (appendonly=true, orientation=column, compresstype=rle_type) distributed by (k);
+insert into co_rle select * from ao;
+
+-- Row at a time, no late materialization.
+set gp_enable_batch_execution = off;
+set gp_enable_aocs_late_materialization = off;
+select count(*) from co;
+select count(*), count(a), sum(a), min(a), max(a) from co where a between 100 and 5000;
+select count(*), sum(b), min(d) - date '2000-01-01' as first_day, max(d) - date '2000-01-01' as last_day from co where b in (1, 5, 42);
+select count(*), sum(s), min(c), max(c) from co where c > 1000.5 and s <> 3;
+select count(*) from co where d = date '2000-03-01';
+select count(*) from co_rle;
+select count(*), count(a), sum(a), min(a), max(a) from co_rle where a between 100 and 5000;
+select count(*), sum(b), min(d) - date '2000-01-01' as first_day, max(d) - date '2000-01-01' as last_day from co_rle where b in (1, 5, 42);
+select count(*), sum(s), min(c), max(c) from co_rle where c > 1000.5 and s <> 3;
+select count(*) from co_rle where d = date '2000-03-01';
+select k, t from co where a between 2990 and 3010 order by k;
+select k, t, c from co where b = 7 and k < 800 order by k;
+select k, t from co_rle where a between 2990 and 3010 order by k;
+select k, t, c from co_rle where b = 7 and k < 800 order by k;
+select rows_differ('select count(a), avg(a), avg(b), sum(c) from TBL where s >= 2 and a < 9000');
+select rows_differ('select s, count(*), min(a), max(b) from TBL where a >= 500 group by s');
+select rows_differ('select k from TBL where a is null and s = 1');
+select rows_differ('select k, a, b, c, d, s, t from TBL where k between 4000 and 4100');
+select rows_differ('select k, t from TBL where b <= 3 and t is not null');
+
+-- Batch mode, with the quals pushed down into the column reads.
+set gp_enable_batch_execution = on;
+set gp_enable_aocs_late_materialization = off;
+select count(*) from co;
+select count(*), count(a), sum(a), min(a), max(a) from co where a between 100 and 5000;
+select count(*), sum(b), min(d) - date '2000-01-01' as first_day, max(d) - date '2000-01-01' as last_day from co where b in (1, 5, 42);
+select count(*), sum(s), min(c), max(c) from co where c > 1000.5 and s <> 3;
+select count(*) from co where d = date '2000-03-01';
+select count(*) from co_rle;
+select count(*), count(a), sum(a), min(a), max(a) from co_rle where a between 100 and 5000;
+select count(*), sum(b), min(d) - date '2000-01-01' as first_day, max(d) - date '2000-01-01' as last_day from co_rle where b in (1, 5, 42);
+select count(*), sum(s), min(c), max(c) from co_rle where c > 1000.5 and s <> 3;
+select count(*) from co_rle where d = date '2000-03-01';
+select k, t from co where a between 2990 and 3010 order by k;
+select k, t, c from co where b = 7 and k < 800 order by k;
+select k, t from co_rle where a between 2990 and 3010 order by k;
+select k, t, c from co_rle where b = 7 and k < 800 order by k;
+select rows_differ('select count(a), avg(a), avg(b), sum(c) from TBL where s >= 2 and a < 9000');
+select rows_differ('select s, count(*), min(a), max(b) from TBL where a >= 500 group by s');
+select rows_differ('select k from TBL where a is null and s = 1');
+select rows_differ('select k, a, b, c, d, s, t from TBL where k between 4000 and 4100');
+select rows_differ('select k, t from TBL where b <= 3 and t is not null');
+
+-- Late materialization.
+set gp_enable_batch_execution = off;
+set gp_enable_aocs_late_materialization = on;
+select count(*) from co;
+select count(*), count(a), sum(a), min(a), max(a) from co where a between 100 and 5000;
+select count(*), sum(b), min(d) - date '2000-01-01' as first_day, max(d) - date '2000-01-01' as last_day from co where b in (1, 5, 42);
+select count(*), sum(s), min(c), max(c) from co where c > 1000.5 and s <> 3;
+select count(*) from co where d = date '2000-03-01';
+select count(*) from co_rle;
+select count(*), count(a), sum(a), min(a), max(a) from co_rle where a between 100 and 5000;
+select count(*), sum(b), min(d) - date '2000-01-01' as first_day, max(d) - date '2000-01-01' as last_day from co_rle where b in (1, 5, 42);
+select count(*), sum(s), min(c), max(c) from co_rle where c > 1000.5 and s <> 3;
+select count(*) from co_rle where d = date '2000-03-01';
+select k, t from co where a between 2990 and 3010 order by k;
+select k, t, c from co where b = 7 and k < 800 order by k;
+select k, t from co_rle where a between 2990 and 3010 order by k;
+select k, t, c from co_rle where b = 7 and k < 800 order by k;
+select rows_differ('select count(a), avg(a), avg(b), sum(c) from TBL where s >= 2 and a < 9000');
+select rows_differ('select s, count(*), min(a), max(b) from TBL where a >= 500 group by s');
+select rows_differ('select k from TBL where a is null and s = 1');
+select rows_differ('select k, a, b, c, d, s, t from TBL where k between 4000 and 4100');
+select rows_differ('select k, t from TBL where b <= 3 and t is not null');
+
+-- Both on: batch mode takes precedence where the scan supports it.
+set gp_enable_batch_execution = on;
+set gp_enable_aocs_late_materialization = on;
+select count(*) from co;
+select count(*), count(a), sum(a), min(a), max(a) from co where a between 100 and 5000;
+select count(*), sum(b), min(d) - date '2000-01-01' as first_day, max(d) - date '2000-01-01' as last_day from co where b in (1, 5, 42);
+select count(*), sum(s), min(c), max(c) from co where c > 1000.5 and s <> 3;
+select count(*) from co where d = date '2000-03-01';
+select count(*) from co_rle;
+select count(*), count(a), sum(a), min(a), max(a) from co_rle where a between 100 and 5000;
+select count(*), sum(b), min(d) - date '2000-01-01' as first_day, max(d) - date '2000-01-01' as last_day from co_rle where b in (1, 5, 42);
+select count(*), sum(s), min(c), max(c) from co_rle where c > 1000.5 and s <> 3;
+select count(*) from co_rle where d = date '2000-03-01';
+select k, t from co where a between 2990 and 3010 order by k;
+select k, t, c from co where b = 7 and k < 800 order by k;
+select k, t from co_rle where a between 2990 and 3010 order by k;
+select k, t, c from co_rle where b = 7 and k < 800 order by k;
+select rows_differ('select count(a), avg(a), avg(b), sum(c) from TBL where s >= 2 and a < 9000');
+select rows_differ('select s, count(*), min(a), max(b) from TBL where a >= 500 group by s');
+select rows_differ('select k from TBL where a is null and s = 1');
+select rows_differ('select k, a, b, c, d, s, t from TBL where k between 4000 and 4100');
+select rows_differ('select k, t from TBL where b <= 3 and t is not null');
+
+reset gp_enable_batch_execution;
+reset gp_enable_aocs_late_materialization;
+drop table ao;
+drop table co;
+drop table co_rle;
+drop function rows_differ(text);
+drop schema aocs_batch;
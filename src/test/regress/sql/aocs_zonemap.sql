@@ -0,0 +1,93 @@
+--
+-- Zone maps of column-oriented tables. They are kept in the block directory,
+-- so a table only has them once it has an index.
+--
+create schema aocs_zonemap;
+set search_path to aocs_zonemap;
+
+-- Does EXPLAIN ANALYZE of the query report blocks skipped by zone maps?
+create or replace function zone_maps_skipped(query text) returns bool as
+$$
+declare
+  explainrow text;
+begin
+  for explainrow in execute 'EXPLAIN ANALYZE ' || query
+  loop
+    if explainrow like '%Zone maps skipped%' then
+      return true;
+    end if;
+  end loop;
+  return false;
+end;
+$$ language plpgsql;
+
+-- All the rows go to one segment, in blocks of about 2000 values.
+create table zm (a int, b int, c float8, t text)
+  with (appendonly=true, orientation=column, blocksize=8192) distributed by (b);
+insert into zm select i, 1, i / 2.0, 'row ' || i from generate_series(1, 20000) i;
+
+set gp_enable_aocs_zone_maps = on;
+
+-- No block directory, so no zone maps: nothing is skipped.
+select zone_maps_skipped('select count(*) from zm where a > 19990');
+select count(*) from zm where a > 19990;
+
+-- Creating the index builds the block directory of the existing blocks,
+-- without zone maps: its minipages are written as version 0.
+create index zm_b on zm (b);
+select zone_maps_skipped('select count(*) from zm where a > 19990');
+select count(*) from zm where a > 19990;
+
+-- The blocks inserted from now on have zone maps. They are added to the
+-- version 0 minipages, which are written back as version 1 with the older
+-- entries left without one.
+insert into zm select i, 1, i / 2.0, 'row ' || i from generate_series(20001, 40000) i;
+insert into zm select null, 1, null, 'null ' || i from generate_series(1, 5000) i;
+
+select zone_maps_skipped('select count(*) from zm where a between 30000 and 30010');
+select zone_maps_skipped('select count(*) from zm where c >= 19000');
+select zone_maps_skipped('select count(*) from zm where a is null');
+
+-- The results are the same whether blocks are skipped or not, in batch and
+-- row mode alike.
+set gp_enable_batch_execution = on;
+select count(*), min(a), max(a) from zm where a between 30000 and 30010;
+select count(*) from zm where a < 5;
+select count(*) from zm where a > 19990 and a <= 20010;
+select count(*) from zm where c >= 19000;
+select count(*) from zm where a is null;
+set gp_enable_batch_execution = off;
+select count(*), min(a), max(a) from zm where a between 30000 and 30010;
+select count(*) from zm where a < 5;
+select count(*) from zm where a > 19990 and a <= 20010;
+select count(*) from zm where c >= 19000;
+select count(*) from zm where a is null;
+select a, t from zm where a between 39998 and 40002 order by a;
+
+set gp_enable_aocs_zone_maps = off;
+select zone_maps_skipped('select count(*) from zm where a between 30000 and 30010');
+select count(*), min(a), max(a) from zm where a between 30000 and 30010;
+select count(*) from zm where a < 5;
+select count(*) from zm where a > 19990 and a <= 20010;
+select count(*) from zm where c >= 19000;
+select count(*) from zm where a is null;
+select a, t from zm where a between 39998 and 40002 order by a;
+
+-- Zone maps are only written while gp_enable_aocs_zone_maps is on, so that
+-- the tables written with it off keep the minipage format of older releases.
+create table zm2 (a int, b int)
+  with (appendonly=true, orientation=column, blocksize=8192) distributed by (b);
+create index zm2_b on zm2 (b);
+insert into zm2 select i, 1 from generate_series(1, 20000) i;
+set gp_enable_aocs_zone_maps = on;
+select zone_maps_skipped('select count(*) from zm2 where a > 19990');
+insert into zm2 select i, 1 from generate_series(20001, 40000) i;
+select zone_maps_skipped('select count(*) from zm2 where a > 39990');
+select count(*) from zm2 where a > 19990;
+
+reset gp_enable_aocs_zone_maps;
+reset gp_enable_batch_execution;
+drop table zm;
+drop table zm2;
+drop function zone_maps_skipped(text);
+drop schema aocs_zonemap;
@@ -0,0 +1,42 @@
+--
+-- Motions over the UDP interconnect with gp_interconnect_batch_io, which
+-- moves several packets per sendmmsg()/recvmmsg() call where those exist.
+--
+CREATE SCHEMA ic_batch_io_test;
+SET search_path = ic_batch_io_test;
+
+CREATE TABLE small_table(dkey INT, jkey INT, rval REAL, tval TEXT default 'abcdefghijklmnopqrstuvwxyz') DISTRIBUTED BY (dkey);
+INSERT INTO small_table VALUES(generate_series(1, 500), generate_series(501, 1000), sqrt(generate_series(501, 1000)));
+
+SET gp_interconnect_batch_io TO on;
+SHOW gp_interconnect_batch_io;
+
+-- Redistribute many small tuples
+SELECT COUNT(*) AS count, SUM(a.dkey) AS sum_dkey
+  FROM small_table a JOIN small_table b ON a.jkey = b.dkey + 500;
+
+-- Huge tuples, several packets each
+SELECT SUM(length(long_tval)) AS sum_len_tval
+  FROM (SELECT jkey, repeat(tval, 20000) AS long_tval
+          FROM small_table ORDER BY dkey LIMIT 20) foo
+            JOIN (SELECT * FROM small_table ORDER BY dkey LIMIT 100) bar USING(jkey);
+
+-- Order-preserving gather
+SELECT dkey FROM small_table ORDER BY dkey LIMIT 3;
+
+-- The receiver stops the senders early
+SELECT COUNT(*) AS count
+  FROM (SELECT * FROM small_table a JOIN small_table b ON a.jkey = b.jkey LIMIT 10) foo;
+
+-- An error in the middle of a motion, then another query
+SELECT COUNT(*) FROM small_table a JOIN small_table b ON a.jkey = b.dkey + 500
+  WHERE a.dkey / (a.dkey - b.dkey) > 0;
+SELECT COUNT(*) AS count, SUM(a.dkey) AS sum_dkey
+  FROM small_table a JOIN small_table b ON a.jkey = b.dkey + 500;
+
+RESET gp_interconnect_batch_io;
+
+-- Cleanup
+DROP TABLE small_table;
+RESET search_path;
+DROP SCHEMA ic_batch_io_test CASCADE;
@@ -0,0 +1,49 @@
+--
+-- Motions over the UDP interconnect with the delay-based flow control
+-- method, which keeps a send window per connection.
+--
+CREATE SCHEMA ic_fc_delay_test;
+SET search_path = ic_fc_delay_test;
+
+CREATE TABLE small_table(dkey INT, jkey INT, rval REAL, tval TEXT default 'abcdefghijklmnopqrstuvwxyz') DISTRIBUTED BY (dkey);
+INSERT INTO small_table VALUES(generate_series(1, 500), generate_series(501, 1000), sqrt(generate_series(501, 1000)));
+CREATE TABLE big_table(a int, b int, c text) DISTRIBUTED BY (a);
+INSERT INTO big_table SELECT i, i % 100, repeat('x', i % 50) FROM generate_series(1, 100000) i;
+
+SET gp_interconnect_fc_method TO delay;
+SHOW gp_interconnect_fc_method;
+
+-- Redistribute many small tuples
+SELECT COUNT(*) AS count, SUM(length(x.c)) AS sum_len_c
+  FROM big_table x JOIN big_table y ON x.b = y.a;
+
+-- Huge tuples, several packets each
+SELECT SUM(length(long_tval)) AS sum_len_tval
+  FROM (SELECT jkey, repeat(tval, 20000) AS long_tval
+          FROM small_table ORDER BY dkey LIMIT 20) foo
+            JOIN (SELECT * FROM small_table ORDER BY dkey LIMIT 100) bar USING(jkey);
+
+-- The smallest send queue, so that the window is all that is in flight
+SET gp_interconnect_snd_queue_depth TO 1;
+SELECT COUNT(*) AS count, SUM(length(x.c)) AS sum_len_c
+  FROM big_table x JOIN big_table y ON x.b = y.a;
+RESET gp_interconnect_snd_queue_depth;
+
+-- Order-preserving gather, and a receiver that stops the senders early
+SELECT a FROM big_table ORDER BY a LIMIT 3;
+SELECT COUNT(*) AS count
+  FROM (SELECT * FROM big_table x JOIN big_table y ON x.b = y.b LIMIT 10) foo;
+
+-- An error in the middle of a motion, then another query
+SELECT COUNT(*) FROM big_table x JOIN big_table y ON x.b = y.a
+  WHERE x.a / (x.b - y.a) > 0;
+SELECT COUNT(*) AS count, SUM(length(x.c)) AS sum_len_c
+  FROM big_table x JOIN big_table y ON x.b = y.a;
+
+RESET gp_interconnect_fc_method;
+
+-- Cleanup
+DROP TABLE big_table;
+DROP TABLE small_table;
+RESET search_path;
+DROP SCHEMA ic_fc_delay_test CASCADE;
@@ -0,0 +1,53 @@
+--
+-- Motion-heavy queries over the "shm" interconnect type.  This test runs
+-- from shm_schedule, with PGOPTIONS='-c gp_interconnect_type=shm'; see the
+-- installcheck-icshm target.  Segments on the same host then exchange
+-- tuples through shared-memory rings, the QD still through UDP.
+--
+SHOW gp_interconnect_type;
+
+CREATE SCHEMA ic_shm_test;
+SET search_path = ic_shm_test;
+
+CREATE TABLE shm_t1(a int, b int, c text) DISTRIBUTED BY (a);
+CREATE TABLE shm_t2(a int, b int) DISTRIBUTED BY (a);
+CREATE TABLE shm_wide(a int, t text) DISTRIBUTED BY (a);
+
+INSERT INTO shm_t1 SELECT i, i % 100, repeat('x', i % 50) FROM generate_series(1, 100000) i;
+INSERT INTO shm_t2 SELECT i, i % 7 FROM generate_series(1, 1000) i;
+INSERT INTO shm_wide SELECT i, repeat('y', 10000 + i) FROM generate_series(1, 200) i;
+
+-- Redistribute on a join key that isn't the distribution key
+SELECT count(*) FROM shm_t1 JOIN shm_t2 ON shm_t1.b = shm_t2.a;
+
+-- Many more packets than a ring has slots
+SELECT sum(length(x.c)) FROM shm_t1 x JOIN shm_t1 y ON x.b = y.a;
+
+-- Two-stage aggregate, and an order-preserving gather
+SELECT b, count(*) FROM shm_t1 GROUP BY b ORDER BY b LIMIT 5;
+SELECT sum(n), count(*) FROM (SELECT c, count(*) AS n FROM shm_t1 GROUP BY c) s;
+SELECT a FROM shm_t1 ORDER BY a LIMIT 3;
+
+-- Broadcast, or redistribute on both sides
+SELECT count(*) FROM shm_t2 x JOIN shm_t2 y ON x.b = y.b;
+
+-- Tuples that span several packets
+SELECT count(*), sum(length(t)) FROM (SELECT DISTINCT t FROM shm_wide) s;
+
+-- Multiple slices
+SELECT count(*) FROM shm_t2 WHERE b IN (SELECT b FROM shm_t1 WHERE a < 10);
+
+-- The receiver stops the senders early
+SELECT count(*) FROM (SELECT * FROM shm_t1 x JOIN shm_t1 y ON x.b = y.b LIMIT 10) s;
+
+-- An error tears the rings down, and the next queries set up new ones
+SELECT count(*) FROM shm_t1 x JOIN shm_t2 y ON x.b = y.a WHERE x.a / (x.b - y.a) > 0;
+SELECT count(*) FROM shm_t1 JOIN shm_t2 ON shm_t1.b = shm_t2.a;
+SELECT count(*) FROM shm_t2 x JOIN shm_t2 y ON x.b = y.b;
+
+-- Cleanup
+DROP TABLE shm_wide;
+DROP TABLE shm_t2;
+DROP TABLE shm_t1;
+RESET search_path;
+DROP SCHEMA ic_shm_test CASCADE;
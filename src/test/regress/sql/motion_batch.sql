@@ -0,0 +1,77 @@
+--
+-- Redistribute motions sending their tuples in column-major batches, with
+-- gp_interconnect_batch_tuples.
+--
+CREATE SCHEMA motion_batch_test;
+SET search_path = motion_batch_test;
+
+-- 3200 bytes of md5 digits, which don't compress, and so get toasted out
+-- of line
+CREATE FUNCTION batch_long_text(i int) RETURNS text AS $$
+DECLARE
+  s text := '';
+BEGIN
+  FOR j IN 1..100 LOOP
+    s := s || md5((i * 100 + j)::text);
+  END LOOP;
+  RETURN s;
+END
+$$ LANGUAGE plpgsql IMMUTABLE;
+
+-- Fixed-width columns by value and by reference, and varlena ones, each
+-- with its own nulls. Some of the text values are compressed in line, and
+-- some toasted out of line, which go the regular way between the batches.
+CREATE TABLE batch_src (k int, i2 int2, i4 int4, i8 int8, f8 float8, n numeric,
+                        t text, d date, nm name, b bool, c char(5)) DISTRIBUTED BY (k);
+CREATE TABLE batch_dest (k int, i2 int2, i4 int4, i8 int8, f8 float8, n numeric,
+                         t text, d date, nm name, b bool, c char(5)) DISTRIBUTED BY (i4);
+
+INSERT INTO batch_src
+  SELECT i,
+         CASE WHEN i % 7 = 0 THEN NULL ELSE i::int2 END,
+         CASE WHEN i % 11 = 3 THEN NULL ELSE i * 3 END,
+         CASE WHEN i % 13 = 5 THEN NULL ELSE i::int8 * 1000000000 END,
+         CASE WHEN i % 17 = 2 THEN NULL ELSE i / 4.0 END,
+         CASE WHEN i % 19 = 4 THEN NULL ELSE i::numeric / 8 END,
+         CASE WHEN i % 3 = 1 THEN NULL
+              WHEN i % 1000 = 0 THEN batch_long_text(i)
+              WHEN i % 500 = 250 THEN repeat('x', 3000)
+              ELSE 'row ' || i END,
+         CASE WHEN i % 23 = 7 THEN NULL ELSE date '2000-01-01' + i % 365 END,
+         CASE WHEN i % 29 = 11 THEN NULL ELSE ('name ' || i)::name END,
+         CASE WHEN i % 31 = 0 THEN NULL ELSE i % 2 = 0 END,
+         CASE WHEN i % 37 = 1 THEN NULL ELSE 'c' || (i % 1000) END
+    FROM generate_series(1, 20000) i;
+
+-- Thousands of rows for each segment, many batches each
+SET gp_interconnect_batch_tuples TO on;
+INSERT INTO batch_dest SELECT * FROM batch_src;
+RESET gp_interconnect_batch_tuples;
+
+SELECT COUNT(*) AS count, COUNT(i2) AS i2, COUNT(i4) AS i4, COUNT(i8) AS i8,
+       COUNT(f8) AS f8, COUNT(n) AS n, COUNT(t) AS t, COUNT(d) AS d,
+       COUNT(nm) AS nm, COUNT(b) AS b, COUNT(c) AS c
+  FROM batch_dest;
+SELECT SUM(i2) AS sum_i2, SUM(i4) AS sum_i4, SUM(i8) AS sum_i8,
+       SUM(length(t)) AS sum_len_t
+  FROM batch_dest;
+
+-- Every row arrived as it was sent
+SELECT COUNT(*) AS differences
+  FROM ((SELECT * FROM batch_dest EXCEPT ALL SELECT * FROM batch_src)
+        UNION ALL
+        (SELECT * FROM batch_src EXCEPT ALL SELECT * FROM batch_dest)) s;
+
+-- Redistribute both sides of a join
+SET gp_interconnect_batch_tuples TO on;
+SELECT COUNT(*) AS count, SUM(a.k) AS sum_k, SUM(length(b.t)) AS sum_len_t,
+       COUNT(b.nm) AS count_nm
+  FROM batch_src a JOIN batch_src b ON a.i4 = b.i4 + 3;
+RESET gp_interconnect_batch_tuples;
+
+-- Cleanup
+DROP TABLE batch_dest;
+DROP TABLE batch_src;
+DROP FUNCTION batch_long_text(int);
+RESET search_path;
+DROP SCHEMA motion_batch_test CASCADE;
@@ -0,0 +1,77 @@
+--
+-- Motion nodes compressing the tuples they send, with
+-- gp_interconnect_compression.
+--
+-- All the rows are on one segment, so that a single motion sender decides
+-- whether compression pays off. The debug message when it gives up is the
+-- only one kept from the interconnect's debug output.
+--
+-- start_matchsubs
+-- m/^DEBUG:  Motion node \d+: compressed \d+ tuple bytes into \d+ bytes/
+-- s/Motion node \d+: compressed \d+ tuple bytes into \d+ bytes/Motion node N: compressed N tuple bytes into N bytes/
+-- end_matchsubs
+-- start_matchignore
+-- m/^(?:DEBUG|LOG):  (?!Motion node \d+: compressed)/
+-- m/^(?:DETAIL|CONTEXT|HINT|STATEMENT):  /
+-- end_matchignore
+CREATE SCHEMA motion_compress_test;
+SET search_path = motion_compress_test;
+
+-- 320 bytes of text: 'x's, which compress well, or md5 digits, which don't
+CREATE FUNCTION compress_text(i int, compressible bool) RETURNS text AS $$
+  SELECT CASE WHEN $2 THEN repeat('x', 320)
+    ELSE md5($1::text) || md5(($1 + 1)::text) || md5(($1 + 2)::text) || md5(($1 + 3)::text) ||
+         md5(($1 + 4)::text) || md5(($1 + 5)::text) || md5(($1 + 6)::text) || md5(($1 + 7)::text) ||
+         md5(($1 + 8)::text) || md5(($1 + 9)::text) END
+$$ LANGUAGE SQL IMMUTABLE;
+
+CREATE TABLE compress_src(k int, id int, t text) DISTRIBUTED BY (k);
+CREATE TABLE compress_dest(id int, t text) DISTRIBUTED BY (id);
+
+-- Every row compresses well, so compression stays on all the way
+INSERT INTO compress_src SELECT 1, i, compress_text(i, true) FROM generate_series(1, 6000) i;
+
+SET gp_interconnect_compression TO on;
+SET gp_log_interconnect TO debug;
+SET client_min_messages TO debug1;
+INSERT INTO compress_dest SELECT id, t FROM compress_src;
+RESET client_min_messages;
+RESET gp_log_interconnect;
+RESET gp_interconnect_compression;
+
+SELECT COUNT(*) AS count, SUM(length(t)) AS sum_len_t,
+       SUM(CASE WHEN t = compress_text(id, true) THEN 1 ELSE 0 END) AS intact
+  FROM compress_dest;
+
+-- Only one row in six compresses, which is not enough. Compression is
+-- switched off after the first 1MB, and the rest go as they are, so the
+-- receivers get a mix of compressed and plain tuples.
+TRUNCATE compress_src;
+TRUNCATE compress_dest;
+INSERT INTO compress_src SELECT 1, i, compress_text(i, i % 6 = 0) FROM generate_series(1, 6000) i;
+
+SET gp_interconnect_compression TO on;
+SET gp_log_interconnect TO debug;
+SET client_min_messages TO debug1;
+INSERT INTO compress_dest SELECT id, t FROM compress_src;
+RESET client_min_messages;
+RESET gp_log_interconnect;
+RESET gp_interconnect_compression;
+
+SELECT COUNT(*) AS count, SUM(length(t)) AS sum_len_t,
+       SUM(CASE WHEN t = compress_text(id, id % 6 = 0) THEN 1 ELSE 0 END) AS intact
+  FROM compress_dest;
+
+-- Huge tuples, compressed into fewer chunks than they would take as they are
+SET gp_interconnect_compression TO on;
+SELECT COUNT(*) AS count, SUM(length(long_t)) AS sum_len_long_t
+  FROM (SELECT id, repeat(t, 1000) AS long_t FROM compress_src WHERE id <= 20) a
+    JOIN compress_dest b USING (id);
+RESET gp_interconnect_compression;
+
+-- Cleanup
+DROP TABLE compress_dest;
+DROP TABLE compress_src;
+DROP FUNCTION compress_text(int, bool);
+RESET search_path;
+DROP SCHEMA motion_compress_test CASCADE;
@@ -19,6 +19,13 @@ CodeGeneratorManagerCreate(const char* module_name)
 	return NULL;
 }
 
+// sets the number of rows the operator is expected to process
+void
+CodeGeneratorManagerSetEstimatedRows(void* manager, double estimated_rows)
+{
+	elog(ERROR, "mock implementation of CodeGeneratorManager_SetEstimatedRows called");
+}
+
 // calls all the registered CodegenInterface to generate code
 unsigned int
 CodeGeneratorManagerGenerateCode(void* manager)
@@ -70,6 +77,28 @@ CodeGeneratorManagerGetExplainString(void* manager)
 	return NULL;
 }
 
+/*
+ * Return a copy in CurrentMemoryContext of the time spent generating and
+ * compiling code, and of whether each generated function was used
+ */
+char*
+CodeGeneratorManagerGetStatisticsString(void* manager)
+{
+	elog(ERROR, "mock implementation of CodeGeneratorManager_GetStatisticsString called");
+	return NULL;
+}
+
+/*
+ * Return a summary in CurrentMemoryContext of the statistics of the
+ * backend-local cache of compiled code
+ */
+char*
+CodeGeneratorCacheGetExplainString()
+{
+	elog(ERROR, "mock implementation of CodeGeneratorCache_GetExplainString called");
+	return NULL;
+}
+
 // get the active code generator manager
 void*
 GetActiveCodeGeneratorManager()
@@ -120,3 +149,44 @@ AdvanceAggregatesCodegenEnroll(AdvanceAggregatesFn regular_func_ptr,
 	return NULL;
 }
 
+// Enroll and returns the pointer to HashMotionKeysGenerator
+void*
+HashMotionKeysCodegenEnroll(HashMotionKeysFn regular_func_ptr,
+		HashMotionKeysFn* ptr_to_regular_func_ptr,
+		struct MotionState *motionstate) {
+	*ptr_to_regular_func_ptr = regular_func_ptr;
+	elog(ERROR, "mock implementation of HashMotionKeysCodegenEnroll called");
+	return NULL;
+}
+
+// Enroll and returns the pointer to CalcHashKeysGenerator
+void*
+CalcHashKeysCodegenEnroll(CalcHashKeysFn regular_func_ptr,
+		CalcHashKeysFn* ptr_to_regular_func_ptr,
+		struct AggState *aggstate) {
+	*ptr_to_regular_func_ptr = regular_func_ptr;
+	elog(ERROR, "mock implementation of CalcHashKeysCodegenEnroll called");
+	return NULL;
+}
+
+// Enroll and returns the pointer to ExecHashGetHashKeysGenerator
+void*
+ExecHashGetHashKeysCodegenEnroll(ExecHashGetHashKeysFn regular_func_ptr,
+		ExecHashGetHashKeysFn* ptr_to_regular_func_ptr,
+		struct HashJoinState *hjstate,
+		bool outer_tuple) {
+	*ptr_to_regular_func_ptr = regular_func_ptr;
+	elog(ERROR, "mock implementation of ExecHashGetHashKeysCodegenEnroll called");
+	return NULL;
+}
+
+// Enroll and returns the pointer to MKCompareGenerator
+void*
+MKCompareCodegenEnroll(MKCompareFn regular_func_ptr,
+		MKCompareFn* ptr_to_regular_func_ptr,
+		int num_keys,
+		Oid *sort_operators) {
+	*ptr_to_regular_func_ptr = regular_func_ptr;
+	elog(ERROR, "mock implementation of MKCompareCodegenEnroll called");
+	return NULL;
+}